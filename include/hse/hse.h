@@ -124,6 +124,7 @@ struct hse_kvdb_opspec {
 #define HSE_KVDB_KOP_FLAG_BIND_TXN 0x02    /**< cursor bound to transaction */
 #define HSE_KVDB_KOP_FLAG_STATIC_VIEW 0x04 /**< bound cursor's view is static */
 #define HSE_KVDB_KOP_FLAG_PRIORITY 0x08    /**< op won't be throttled @see, hse_kvs_put */
+#define HSE_KVDB_KOP_FLAG_SYNC 0x10        /**< op is durable on return @see, hse_kvs_put */
 
 /**@}*/
 
@@ -386,6 +387,12 @@ hse_kvdb_kvs_close(struct hse_kvs *kvs);
  * second marked as PRIORITY is likely an issue. On the other hand, doing 1K small puts
  * per second marked as PRIORITY is almost certainly fine.
  *
+ * By default a put becomes durable within the KVDB's durability interval. If the caller
+ * sets the HSE_KVDB_KOP_FLAG_SYNC flag then hse_kvs_put() returns only once the put is
+ * durable. Concurrent sync requests share a single journal write, so the cost per put
+ * drops as the number of concurrent writers grows. Within a transaction the flag instead
+ * makes the subsequent hse_kvdb_txn_commit() durable on return.
+ *
  * @param kvs:     KVS handle from hse_kvdb_kvs_open()
  * @param opspec:  Specification for put operation
  * @param key:     Key to put into kvs
@@ -435,12 +442,48 @@ hse_kvs_get(
     size_t                  buf_len,
     size_t *                val_len);
 
+/**
+ * Retrieve the values for a batch of keys from KVS
+ *
+ * Semantically equivalent to calling hse_kvs_get() once for each of the "count" keys,
+ * except that all keys are looked up against the same view of the KVS and the cN tree
+ * is descended once per batch rather than once per key. The i'th key is described by
+ * keyv[i] and key_lenv[i], and its result is returned in foundv[i], valbufv[i] and
+ * val_lenv[i] following the same rules as hse_kvs_get(). A NULL valbufv[i] with a
+ * zero valbuf_szv[i] probes for the existence and value length of the i'th key. This
+ * function is thread safe.
+ *
+ * @param kvs:        KVS handle from hse_kvdb_kvs_open()
+ * @param opspec:     Specification for get operation
+ * @param count:      Number of keys in the batch
+ * @param keyv:       Vector of keys to get from kvs
+ * @param key_lenv:   Vector of key lengths
+ * @param foundv:     [out] Vector of found indicators
+ * @param valbufv:    Vector of buffers into which values will be copied
+ * @param valbuf_szv: Vector of buffer lengths
+ * @param val_lenv:   [out] Vector of actual value lengths for found keys
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_get_batch(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    unsigned int            count,
+    const void **           keyv,
+    const size_t *          key_lenv,
+    bool *                  foundv,
+    void **                 valbufv,
+    const size_t *          valbuf_szv,
+    size_t *                val_lenv);
+
 /**
  * Delete the key and its associated value from KVS
  *
  * It is not an error if the key does not exist within the KVS. See the section on
- * transactions for information on how deletes within transactions are handled. This
- * function is thread safe.
+ * transactions for information on how deletes within transactions are handled. The
+ * HSE_KVDB_KOP_FLAG_SYNC flag is honored as for hse_kvs_put(). This function is thread
+ * safe.
  *
  * @param kvs:     KVS handle from hse_kvdb_kvs_open()
  * @param opspec:  Specification for delete operation
@@ -487,6 +530,34 @@ hse_kvs_prefix_delete(
     size_t                  filt_len,
     size_t *                kvs_pfx_len);
 
+/**
+ * Delete all KV pairs whose keys lie within a range of keys from a KVS
+ *
+ * This interface deletes every key k such that start <= k < end, where keys are
+ * compared lexicographically as with cursors. The end key itself is not deleted.
+ * It is not an error if no keys exist within the range, nor if start is not less
+ * than end (in which case nothing is deleted). Keys put after the call returns are
+ * not affected. Range deletes are not supported within transactions. This function
+ * is thread safe.
+ *
+ * @param kvs:       KVS handle from hse_kvdb_kvs_open()
+ * @param opspec:    KVDB op struct
+ * @param start:     First key of the range to delete
+ * @param start_len: Length of start
+ * @param end:       Key following the last key of the range to delete
+ * @param end_len:   Length of end
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_range_delete(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    const void *            start,
+    size_t                  start_len,
+    const void *            end,
+    size_t                  end_len);
+
 /**@}*/
 
 
@@ -591,8 +662,10 @@ hse_kvdb_txn_begin(struct hse_kvdb *kvdb, struct hse_kvdb_txn *txn);
 /**
  * Commit all the mutations of the referenced transaction
  *
- * The call fails if the referenced transaction is not in the ACTIVE state. This
- * function is thread safe with different transactions.
+ * The call fails if the referenced transaction is not in the ACTIVE state. If any put
+ * or delete in the transaction specified HSE_KVDB_KOP_FLAG_SYNC then the call returns
+ * only once the transaction is durable. This function is thread safe with different
+ * transactions.
  *
  * @param kvdb: KVDB handle from hse_kvdb_open()
  * @param txn:  KVDB transaction handle from hse_kvdb_txn_alloc()
@@ -814,6 +887,73 @@ hse_kvs_cursor_read(
     size_t *                val_len,
     bool *                  eof);
 
+/* Flags for hse_kvs_cursor_read_batch() */
+#define HSE_KVS_CURSOR_READ_KEYS_ONLY 0x01 /**< omit values, report zero value lengths */
+#define HSE_KVS_CURSOR_READ_VLEN_ONLY 0x02 /**< omit values, report value lengths */
+
+/**
+ * struct hse_kvs_cursor_rec - header of a record from hse_kvs_cursor_read_batch()
+ *
+ * The header is followed by "kcr_klen" bytes of key and, unless values were omitted,
+ * "kcr_vlen" bytes of value.  The next record starts at the following multiple of
+ * HSE_KVS_CURSOR_REC_ALIGN bytes, see HSE_KVS_CURSOR_REC_NEXT().
+ */
+struct hse_kvs_cursor_rec {
+    uint32_t kcr_klen; /**< length of key */
+    uint32_t kcr_vlen; /**< length of value */
+};
+
+#define HSE_KVS_CURSOR_REC_ALIGN 8
+
+#define HSE_KVS_CURSOR_REC_KEY(rec) ((const void *)((rec) + 1))
+#define HSE_KVS_CURSOR_REC_VAL(rec) ((const void *)((const char *)((rec) + 1) + (rec)->kcr_klen))
+
+/* Size of a record whose value occupies "vsz" bytes (zero if values were omitted) */
+#define HSE_KVS_CURSOR_REC_SIZE(klen, vsz)                                                   \
+    ((sizeof(struct hse_kvs_cursor_rec) + (klen) + (vsz) + HSE_KVS_CURSOR_REC_ALIGN - 1) & \
+     ~((size_t)HSE_KVS_CURSOR_REC_ALIGN - 1))
+
+#define HSE_KVS_CURSOR_REC_NEXT(rec, vsz)   \
+    ((const struct hse_kvs_cursor_rec *)((const char *)(rec) + \
+                                         HSE_KVS_CURSOR_REC_SIZE((rec)->kcr_klen, (vsz))))
+
+/**
+ * Read many key/value pairs from the cursor in a single call
+ *
+ * Semantically equivalent to calling hse_kvs_cursor_read() until either EOF is reached
+ * or the next key/value pair does not fit in the remaining space of "buf", with each
+ * pair copied into "buf" as a struct hse_kvs_cursor_rec header followed by the key and
+ * value. The pair that did not fit is returned by the next read. If not even the first
+ * pair fits, then no pairs are returned and "buf_used" is set to the size required for
+ * it, which is larger than "buf_sz".
+ *
+ * With HSE_KVS_CURSOR_READ_KEYS_ONLY or HSE_KVS_CURSOR_READ_VLEN_ONLY in "flags" the
+ * value bytes are not copied, so each record holds only its header and key. The
+ * "buf" must be aligned to HSE_KVS_CURSOR_REC_ALIGN bytes. This function is thread
+ * safe across disparate cursors.
+ *
+ * @param cursor:   Cursor handle from hse_kvs_cursor_create()
+ * @param opspec:   Ignored; may be zero
+ * @param flags:    Zero or one of the HSE_KVS_CURSOR_READ_* flags
+ * @param buf:      Buffer into which records are packed
+ * @param buf_sz:   Size of buffer
+ * @param count:    [out] Number of records packed into buf
+ * @param buf_used: [out] Number of bytes of buf used
+ * @param eof:      [out] If true, no more key/value pairs in sequence
+ * @return The function's error status
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_cursor_read_batch(
+    struct hse_kvs_cursor * cursor,
+    struct hse_kvdb_opspec *opspec,
+    unsigned int            flags,
+    void *                  buf,
+    size_t                  buf_sz,
+    unsigned int *          count,
+    size_t *                buf_used,
+    bool *                  eof);
+
 /**
  * Destroy cursor
  *
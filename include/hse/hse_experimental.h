@@ -100,6 +100,72 @@ hse_kvs_prefix_probe_exp(
     size_t                      valbuf_sz,
     size_t *                    val_len);
 
+/**
+ * Create cursors over disjoint ranges of a KVS for a parallel scan
+ *
+ * Divides the keys of a KVS (or those matching the given prefix) into at most
+ * "cursormax" contiguous ranges of similar size, and creates a forward cursor
+ * for each, positioned at the start of its range and limited to it as if by
+ * hse_kvs_cursor_seek_range().  The nth range immediately follows the (n-1)th,
+ * so reading each cursor to EOF in order yields the same keys as a single
+ * cursor.  All the cursors share one view of the KVS, either a new one or
+ * that of the transaction given by the opspec.
+ *
+ * The range boundaries are chosen from kblock metadata, hence fewer than
+ * "cursormax" cursors are created if the KVS is small or recently ingested.
+ * Each cursor must be destroyed with hse_kvs_cursor_destroy(), and may be
+ * driven from a different thread.  Seeking a cursor with hse_kvs_cursor_seek()
+ * removes its range limit, and updating it gives it a view of its own.
+ *
+ * Reverse cursors and transaction bound cursors are not supported.
+ *
+ * @param kvs:       KVS handle from hse_kvdb_kvs_open()
+ * @param opspec:    Optional transaction whose view the cursors use
+ * @param prefix:    Optional: prefix for the cursors
+ * @param pfx_len:   Length of @prefix
+ * @param cursormax: Max number of cursors, at most HSE_KVS_CURSOR_PARTS_MAX
+ * @param cursorv:   [out] Vector of at least @cursormax cursor handles
+ * @param cursorc:   [out] Number of cursors created
+ * @return The function's error status
+ */
+hse_err_t
+hse_kvs_cursor_partition_exp(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    const void *            prefix,
+    size_t                  pfx_len,
+    unsigned int            cursormax,
+    struct hse_kvs_cursor **cursorv,
+    unsigned int *          cursorc);
+
+/**
+ * Put a KV pair into KVS with a time-to-live
+ *
+ * Behaves as hse_kvs_put() except that the value expires @ttl_secs seconds after
+ * the put.  Once expired the value reads as if the key had been deleted: gets and
+ * cursors do not see it (nor any older value of the key), and compaction reclaims
+ * its space.  Expiry is based on the system wall clock, with one second resolution.
+ * This function is thread safe.
+ *
+ * @param kvs:      KVS handle from hse_kvdb_kvs_open()
+ * @param opspec:   Specification for put operation
+ * @param key:      Key to put into kvs
+ * @param key_len:  Length of key
+ * @param val:      Value associated with key
+ * @param val_len:  Length of value
+ * @param ttl_secs: Time-to-live of the value in seconds, must be non-zero
+ * @return The function's error status
+ */
+hse_err_t
+hse_kvs_put_ttl_exp(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    const void *            key,
+    size_t                  key_len,
+    const void *            val,
+    size_t                  val_len,
+    unsigned int            ttl_secs);
+
 /**
  * Retrieve the last error message
  *
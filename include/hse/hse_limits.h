@@ -34,4 +34,7 @@
 /* Max KVS name lengths */
 #define HSE_KVS_NAME_LEN_MAX 32
 
+/* Max number of cursors created by hse_kvs_cursor_partition_exp() */
+#define HSE_KVS_CURSOR_PARTS_MAX 64
+
 #endif
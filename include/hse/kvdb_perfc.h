@@ -14,8 +14,10 @@ enum kvdb_perfc_sidx_kvdbop {
 
     PERFC_RA_KVDBOP_KVS_GET,
     PERFC_BA_KVDBOP_KVS_GETB,
+    PERFC_RA_KVDBOP_KVS_GET_BATCH,
 
     PERFC_RA_KVDBOP_KVS_CURSOR_READ,
+    PERFC_RA_KVDBOP_KVS_CURSOR_READ_BATCH,
 
     PERFC_RA_KVDBOP_KVS_PUT,
     PERFC_BA_KVDBOP_KVS_PUTB,
@@ -40,6 +42,9 @@ enum kvdb_perfc_sidx_kvdbop {
     PERFC_RA_KVDBOP_KVS_PFX_DEL,
     PERFC_BA_KVDBOP_KVS_PFX_DELB,
 
+    PERFC_RA_KVDBOP_KVS_RANGE_DEL,
+    PERFC_BA_KVDBOP_KVS_RANGE_DELB,
+
     PERFC_RA_KVDBOP_KVS_PFXPROBE,
 
     PERFC_RA_KVDBOP_KVDB_FLUSH,
@@ -63,6 +68,8 @@ enum kvdb_perfc_sidx_c0skop {
     PERFC_LT_C0SKOP_PUT,
     PERFC_RA_C0SKOP_DEL,
     PERFC_LT_C0SKOP_DEL,
+    PERFC_RA_C0SKOP_GET_SKIP,
+    PERFC_RA_C0SKOP_PROBE_SKIP,
     PERFC_EN_C0SKOP
 };
 
@@ -74,6 +81,7 @@ enum kvdb_perfc_sidx_c0sking {
     PERFC_DI_C0SKING_FIN,
     PERFC_DI_C0SKING_THRSR,
     PERFC_DI_C0SKING_MEM,
+    PERFC_DI_C0SKING_KVSBLD,
     PERFC_EN_C0SKING
 };
 
@@ -101,6 +109,8 @@ enum kvdb_perfc_sidx_sp3 {
     PERFC_BA_SP3_LSIZE_TARG,
     PERFC_BA_SP3_RSIZE_CURR,
     PERFC_BA_SP3_RSIZE_TARG,
+    PERFC_BA_SP3_IOBUDGET,
+    PERFC_BA_SP3_IODEBT,
     PERFC_EN_SP3
 };
 
@@ -117,9 +127,11 @@ enum kvdb_perfc_sidx_cnget {
     PERFC_LT_CNGET_PROBEPFX,
     PERFC_DI_CNGET_DEPTH,
     PERFC_DI_CNGET_NKVSET,
+    PERFC_DI_CNGET_NKBLK,
     PERFC_RA_CNGET_MISS,
     PERFC_LT_CNGET_MISS,
     PERFC_RA_CNGET_TOMB,
+    PERFC_LT_CNGET_GET_BATCH,
     PERFC_EN_CNGET
 };
 
@@ -199,6 +211,16 @@ enum kvdb_perfc_cnmclass {
     PERFC_EN_CNMCLASS,
 };
 
+enum kvdb_perfc_cnvcache {
+    PERFC_RA_CNVCACHE_HIT,
+    PERFC_RA_CNVCACHE_MISS,
+    PERFC_RA_CNVCACHE_HITB,
+    PERFC_RA_CNVCACHE_INSERT,
+    PERFC_RA_CNVCACHE_EVICT,
+    PERFC_BA_CNVCACHE_SIZE,
+    PERFC_EN_CNVCACHE,
+};
+
 enum kvdb_perfc_sidx_cursorcache {
     PERFC_BA_CC_RETIRE_C0,
     PERFC_BA_CC_RETIRE_CN,
@@ -256,21 +278,36 @@ enum kvdb_perfc_sidx_cursordist {
 enum kvdb_perfc_sidx_pkvsl {
     PERFC_LT_PKVSL_KVS_PUT,
     PERFC_LT_PKVSL_KVS_GET,
+    PERFC_LT_PKVSL_KVS_GET_BATCH,
     PERFC_LT_PKVSL_KVS_DEL,
 
     PERFC_LT_PKVSL_KVS_PFX_PROBE,
     PERFC_LT_PKVSL_KVS_PFX_DEL,
+    PERFC_LT_PKVSL_KVS_RANGE_DEL,
 
     PERFC_LT_PKVSL_KVS_CURSOR_CREATE,
     PERFC_LT_PKVSL_KVS_CURSOR_UPDATE,
     PERFC_LT_PKVSL_KVS_CURSOR_SEEK,
     PERFC_LT_PKVSL_KVS_CURSOR_READFWD,
     PERFC_LT_PKVSL_KVS_CURSOR_READREV,
+    PERFC_LT_PKVSL_KVS_CURSOR_READ_BATCH,
     PERFC_LT_PKVSL_KVS_CURSOR_DESTROY,
 
     PERFC_EN_PKVSL,
 };
 
+enum kvdb_perfc_kvsgcache {
+    PERFC_RA_KVSGCACHE_HIT,
+    PERFC_RA_KVSGCACHE_NHIT,
+    PERFC_RA_KVSGCACHE_MISS,
+    PERFC_RA_KVSGCACHE_INSERT,
+    PERFC_RA_KVSGCACHE_RACE,
+    PERFC_RA_KVSGCACHE_INVAL,
+    PERFC_RA_KVSGCACHE_EVICT,
+    PERFC_BA_KVSGCACHE_SIZE,
+    PERFC_EN_KVSGCACHE,
+};
+
 /* "PKVDBL" stands for Public KVDB interface Latencies" */
 enum kvdb_perfc_sidx_pkvdbl {
     PERFC_LT_PKVDBL_KVDB_TXN_BEGIN,
@@ -306,6 +343,9 @@ enum kvdb_perfc_sidx_c0skmop {
     PERFC_DI_C0SKM_INGEST,
     PERFC_LT_C0SKM_KVMSI,
     PERFC_DI_C0SKM_VBLDRT,
+    PERFC_RA_C0SKM_OPSYNC,
+    PERFC_LT_C0SKM_OPSYNC,
+    PERFC_DI_C0SKM_SYNCW,
     PERFC_EN_C0SKMOP,
 };
 
@@ -173,6 +173,79 @@ hse_kvs_prefix_probe_exp(
     return 0UL;
 }
 
+uint64_t
+hse_kvs_cursor_partition_exp(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    const void *            prefix,
+    size_t                  pfx_len,
+    unsigned int            cursormax,
+    struct hse_kvs_cursor **cursorv,
+    unsigned int *          cursorc)
+{
+    merr_t err;
+
+    if (ev(!handle || !cursorv || !cursorc || (pfx_len && !prefix)))
+        return merr(EINVAL);
+
+    if (os && ev(((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)))
+        return merr(EINVAL);
+
+    err = ikvdb_kvs_cursor_partition(handle, os, prefix, pfx_len, cursormax, cursorv, cursorc);
+    if (ev(err))
+        return err;
+
+    perfc_add(&kvdb_pc, PERFC_RA_KVDBOP_KVS_CURSOR_CREATE, *cursorc);
+
+    return 0UL;
+}
+
+uint64_t
+hse_kvs_put_ttl_exp(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    const void *            key,
+    size_t                  key_len,
+    const void *            val,
+    size_t                  val_len,
+    unsigned int            ttl_secs)
+{
+    struct kvs_ktuple kt;
+    struct kvs_vtuple vt;
+    merr_t            err;
+    u64               expiry;
+
+    if (ev(!handle || !key || (val_len > 0 && !val) || !ttl_secs))
+        return merr(EINVAL);
+
+    if (os && ev(((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)))
+        return merr(EINVAL);
+
+    if (ev(key_len > HSE_KVS_KLEN_MAX))
+        return merr(ENAMETOOLONG);
+
+    if (ev(key_len == 0))
+        return merr(ENOENT);
+
+    if (ev(val_len > HSE_KVS_VLEN_MAX))
+        return merr(EMSGSIZE);
+
+    expiry = ktime_get_real() / USEC_PER_SEC + ttl_secs;
+
+    kvs_ktuple_init_nohash(&kt, key, key_len);
+    kvs_vtuple_init(&vt, (void *)val, val_len);
+    vt.vt_expiry = min_t(u64, expiry, U32_MAX);
+
+    err = ikvdb_kvs_put(handle, os, &kt, &vt);
+    if (ev(err))
+        return err;
+
+    PERFC_INCADD_RU(
+        &kvdb_pc, PERFC_RA_KVDBOP_KVS_PUT, PERFC_BA_KVDBOP_KVS_PUTB, key_len + val_len, 128);
+
+    return 0UL;
+}
+
 #if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
 #include "hse_experimental_ut_impl.i"
 #endif /* HSE_UNIT_TEST_MODE */
@@ -497,6 +497,96 @@ hse_kvs_get(
     return 0;
 }
 
+hse_err_t
+hse_kvs_get_batch(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    unsigned int            count,
+    const void **           keyv,
+    const size_t *          key_lenv,
+    bool *                  foundv,
+    void **                 valbufv,
+    const size_t *          valbuf_szv,
+    size_t *                val_lenv)
+{
+    struct kvs_ktuple *  ktv;
+    struct kvs_buf *     vbufv;
+    enum key_lookup_res *resv;
+    size_t               sz;
+    u64                  sum;
+    merr_t               err;
+    uint                 i;
+
+    if (unlikely(!handle || !keyv || !key_lenv || !foundv || !val_lenv))
+        return merr_to_hse_err(merr(EINVAL));
+
+    if (os && unlikely(((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)))
+        return merr_to_hse_err(merr(EINVAL));
+
+    if (unlikely(count > 0 && (!valbufv || !valbuf_szv)))
+        return merr_to_hse_err(merr(EINVAL));
+
+    for (i = 0; i < count; ++i) {
+        if (unlikely(!keyv[i] || (!valbufv[i] && valbuf_szv[i] > 0)))
+            return merr_to_hse_err(merr(EINVAL));
+
+        if (unlikely(key_lenv[i] > HSE_KVS_KLEN_MAX))
+            return merr_to_hse_err(merr(ENAMETOOLONG));
+
+        if (unlikely(key_lenv[i] == 0))
+            return merr_to_hse_err(merr(ENOENT));
+    }
+
+    if (count == 0)
+        return 0;
+
+    sz = count * (sizeof(*ktv) + sizeof(*vbufv) + sizeof(*resv));
+
+    ktv = malloc(sz);
+    if (ev(!ktv))
+        return merr_to_hse_err(merr(ENOMEM));
+
+    vbufv = (void *)(ktv + count);
+    resv = (void *)(vbufv + count);
+
+    for (i = 0; i < count; ++i) {
+        void *valbuf = valbufv[i];
+
+        /* See hse_kvs_get() for why a NULL valbuf is replaced here. */
+        if (!valbuf && valbuf_szv[i] == 0)
+            valbuf = (void *)-1;
+
+        kvs_ktuple_init_nohash(ktv + i, keyv[i], key_lenv[i]);
+        kvs_buf_init(vbufv + i, valbuf, valbuf_szv[i]);
+    }
+
+    err = ikvdb_kvs_get_batch(handle, os, count, ktv, resv, vbufv);
+    if (ev(err))
+        goto out;
+
+    sum = 0;
+
+    for (i = 0; i < count; ++i) {
+        foundv[i] = (resv[i] == FOUND_VAL);
+        val_lenv[i] = vbufv[i].b_len;
+
+        if (ev(resv[i] == FOUND_MULTIPLE)) {
+            err = merr(EPROTO);
+            goto out;
+        }
+
+        if (foundv[i])
+            sum += val_lenv[i];
+    }
+
+    PERFC_INCADD_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVS_GET_BATCH, PERFC_BA_KVDBOP_KVS_GETB, sum, 128);
+
+out:
+    free(ktv);
+
+    return merr_to_hse_err(err);
+}
+
 /**
  * hse_kvs_delete() - remove the supplied key and associated value from the KVS
  */
@@ -561,6 +651,47 @@ hse_kvs_prefix_delete(
     return merr_to_hse_err(err);
 }
 
+hse_err_t
+hse_kvs_range_delete(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    const void *            start,
+    size_t                  start_len,
+    const void *            end,
+    size_t                  end_len)
+{
+    merr_t            err;
+    struct kvs_ktuple kt_start, kt_end;
+
+    if (unlikely(!handle || !start || !end))
+        return merr_to_hse_err(merr(EINVAL));
+
+    if (os && (((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)))
+        return merr_to_hse_err(merr(EINVAL));
+
+    if (unlikely(start_len > HSE_KVS_KLEN_MAX || end_len > HSE_KVS_KLEN_MAX))
+        return merr_to_hse_err(merr(ENAMETOOLONG));
+
+    if (unlikely(start_len == 0 || end_len == 0))
+        return merr_to_hse_err(merr(ENOENT));
+
+    kvs_ktuple_init_nohash(&kt_start, start, start_len);
+    kvs_ktuple_init_nohash(&kt_end, end, end_len);
+
+    err = ikvdb_kvs_range_delete(handle, os, &kt_start, &kt_end);
+    ev(err);
+
+    if (!err)
+        PERFC_INCADD_RU(
+            &kvdb_pc,
+            PERFC_RA_KVDBOP_KVS_RANGE_DEL,
+            PERFC_BA_KVDBOP_KVS_RANGE_DELB,
+            start_len + end_len,
+            128);
+
+    return merr_to_hse_err(err);
+}
+
 hse_err_t
 hse_kvdb_sync(struct hse_kvdb *handle)
 {
@@ -845,6 +976,46 @@ hse_kvs_cursor_read(
     return merr_to_hse_err(err);
 }
 
+hse_err_t
+hse_kvs_cursor_read_batch(
+    struct hse_kvs_cursor * cursor,
+    struct hse_kvdb_opspec *os,
+    unsigned int            flags,
+    void *                  buf,
+    size_t                  buf_sz,
+    unsigned int *          count,
+    size_t *                buf_used,
+    bool *                  eof)
+{
+    merr_t err;
+
+    if (unlikely(!cursor || !buf || !count || !buf_used || !eof))
+        return merr_to_hse_err(merr(EINVAL));
+
+    if (os && unlikely(((os->kop_opaque >> 16) != 0xb0de) || ((os->kop_opaque & 0x0000ffff) != 1)))
+        return merr_to_hse_err(merr(EINVAL));
+
+    if (unlikely(flags & ~(HSE_KVS_CURSOR_READ_KEYS_ONLY | HSE_KVS_CURSOR_READ_VLEN_ONLY)))
+        return merr_to_hse_err(merr(EINVAL));
+
+    if (unlikely((uintptr_t)buf & (HSE_KVS_CURSOR_REC_ALIGN - 1)))
+        return merr_to_hse_err(merr(EINVAL));
+
+    err = ikvdb_kvs_cursor_read_batch(cursor, os, flags, buf, buf_sz, count, buf_used, eof);
+    ev(err);
+
+    if (!err && *count > 0) {
+        PERFC_INCADD_RU(
+            &kvdb_pc,
+            PERFC_RA_KVDBOP_KVS_CURSOR_READ_BATCH,
+            PERFC_BA_KVDBOP_KVS_GETB,
+            *buf_used,
+            128);
+    }
+
+    return merr_to_hse_err(err);
+}
+
 hse_err_t
 hse_kvs_cursor_destroy(struct hse_kvs_cursor *cursor)
 {
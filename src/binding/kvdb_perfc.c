@@ -15,9 +15,11 @@
 struct perfc_name kvdb_perfc_op[] = {
     NE(PERFC_RA_KVDBOP_KVS_PUT, 1, "Count of kvs_put", "c_kvs_put(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_GET, 1, "Count of kvs_get", "c_kvs_get(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_GET_BATCH, 1, "Count of kvs_get_batch", "c_kvs_get_batch(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_DEL, 1, "Count of kvs_delete", "c_kvs_delete(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_PFXPROBE, 1, "Count of kvs_prefix_probe", "c_kvs_prefix_probe(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_PFX_DEL, 1, "Count of kvs_prefix_delete", "c_kvs_prefix_delete(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_RANGE_DEL, 1, "Count of kvs_range_delete", "c_kvs_range_delete(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_SYNC, 1, "Count of kvdb_sync", "c_kvdb_sync(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_TXN_ALLOC, 1, "Count of kvdb_txn_alloc", "c_kvdb_txn_alloc(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_TXN_FREE, 1, "Count of kvdb_txn_free", "c_kvdb_txn_free(/s)"),
@@ -34,6 +36,10 @@ struct perfc_name kvdb_perfc_op[] = {
        "c_kvs_cursor_update(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_CURSOR_SEEK, 1, "Count of kvs_cursor_seek", "c_kvs_cursor_seek(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_CURSOR_READ, 1, "Count of kvs_cursor_read", "c_kvs_cursor_read(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_CURSOR_READ_BATCH,
+       1,
+       "Count of kvs_cursor_read_batch",
+       "c_kvs_cursor_read_batch(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_CURSOR_DESTROY,
        1,
        "Count of kvs_cursor_destroy",
@@ -43,6 +49,7 @@ struct perfc_name kvdb_perfc_op[] = {
     NE(PERFC_BA_KVDBOP_KVS_GETB, 1, "kvs_get klen+vlen", "c_kvs_get_bytes"),
     NE(PERFC_BA_KVDBOP_KVS_DELB, 1, "kvs_del klen", "c_kvs_del_bytes"),
     NE(PERFC_BA_KVDBOP_KVS_PFX_DELB, 1, "kvs_pfxdel klen", "c_kvs_pfxdel_bytes"),
+    NE(PERFC_BA_KVDBOP_KVS_RANGE_DELB, 1, "kvs_rangedel klen", "c_kvs_rangedel_bytes"),
 
     NE(PERFC_RA_KVDBOP_KVDB_MAKE, 3, "Count of kvdb_make", "c_kvdb_make(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_OPEN, 3, "Count of kvdb_open", "c_kvdb_open(/s)"),
@@ -105,6 +112,9 @@ struct perfc_name csched_sp3_perfc[] = {
     NE(PERFC_BA_SP3_LSIZE_TARG, 3, "target leaf size ", "t_lsize"),
     NE(PERFC_BA_SP3_RSIZE_CURR, 3, "currrent non-leaf size ", "c_rsize"),
     NE(PERFC_BA_SP3_RSIZE_TARG, 3, "target non-leaf size ", "t_rsize"),
+
+    NE(PERFC_BA_SP3_IOBUDGET, 2, "compaction io budget (bytes/sec)", "c_iobudget"),
+    NE(PERFC_BA_SP3_IODEBT, 2, "compaction io debt (bytes)", "c_iodebt"),
 };
 NE_CHECK(csched_sp3_perfc, PERFC_EN_SP3, "csched_sp3_perfc table/enum mismatch");
 
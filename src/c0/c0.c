@@ -121,6 +121,15 @@ c0_prefix_del(struct c0 *handle, struct kvs_ktuple *kt, u64 seqno)
     return c0sk_prefix_del(self->c0_c0sk, self->c0_index, kt, seqno);
 }
 
+merr_t
+c0_range_del(struct c0 *handle, struct kvs_ktuple *start, struct kvs_ktuple *end, u64 seqno)
+{
+    struct c0_impl *self = c0_h2r(handle);
+
+    assert(self->c0_index < HSE_KVS_COUNT_MAX);
+    return c0sk_range_del(self->c0_c0sk, self->c0_index, start, end, seqno);
+}
+
 /*
  * Tombstone indicated by:
  *     return value == 0 && res == FOUND_TOMB
@@ -313,6 +322,12 @@ c0_cursor_read(struct c0_cursor *c0cur, struct kvs_kvtuple *kvt, bool *eof)
     return ev(err);
 }
 
+bool
+c0_cursor_rtomb_covers(struct c0_cursor *c0cur, const void *key, u32 klen)
+{
+    return c0sk_cursor_rtomb_covers(c0cur, key, klen);
+}
+
 merr_t
 c0_cursor_save(struct c0_cursor *c0cur)
 {
@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_CORE_C0_FILTER_H
+#define HSE_CORE_C0_FILTER_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/compiler.h>
+
+/**
+ * struct c0_filter - per c0_kvmultiset key membership filter
+ * @cf_bitmap:  filter words
+ * @cf_shift:   64 - log2(number of words in cf_bitmap)
+ *
+ * A one-word blocked bloom filter over key hashes (i.e., kt_hash) with two
+ * probe bits per key, both of which reside in the same 64-bit word.  Keys
+ * are added by c0kvs_putdel() prior to being inserted into the bonsai tree,
+ * without locking (bits are only ever set, via an atomic OR).  Readers that
+ * find a clear bit are guaranteed that the key was not in the kvms when the
+ * filter was checked, and hence may skip the bonsai tree lookup.
+ *
+ * The filter is cleared only when its kvms is reset for reuse.
+ */
+struct c0_filter {
+    u64 *cf_bitmap;
+    u32  cf_shift;
+};
+
+static __always_inline u64 *
+c0_filter_word(const struct c0_filter *cf, u64 hash, u64 *maskp)
+{
+    *maskp = (1ul << (hash & 63)) | (1ul << ((hash >> 6) & 63));
+
+    return cf->cf_bitmap + ((hash * 0x9e3779b97f4a7c15ul) >> cf->cf_shift);
+}
+
+static __always_inline void
+c0_filter_insert(struct c0_filter *cf, u64 hash)
+{
+    u64 *word, mask;
+
+    word = c0_filter_word(cf, hash, &mask);
+
+    /* Avoid dirtying the cache line if the bits are already set. */
+    if ((__atomic_load_n(word, __ATOMIC_RELAXED) & mask) != mask)
+        __atomic_fetch_or(word, mask, __ATOMIC_RELEASE);
+}
+
+static __always_inline bool
+c0_filter_lookup(const struct c0_filter *cf, u64 hash)
+{
+    u64 *word, mask;
+
+    word = c0_filter_word(cf, hash, &mask);
+
+    return (__atomic_load_n(word, __ATOMIC_ACQUIRE) & mask) == mask;
+}
+
+#endif
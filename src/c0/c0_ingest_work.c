@@ -11,8 +11,8 @@
 merr_t
 c0_ingest_work_init(struct c0_ingest_work *c0iw)
 {
-    struct bin_heap2 *minheap;
-    merr_t            err;
+    struct loser_tree *lt;
+    merr_t             err;
 
     assert(c0iw);
 
@@ -20,11 +20,11 @@ c0_ingest_work_init(struct c0_ingest_work *c0iw)
     c0iw->c0iw_magic = (uintptr_t)c0iw;
     c0iw->c0iw_tailp = &c0iw->c0iw_next;
 
-    err = bin_heap2_create(HSE_C0_KVSET_ITER_MAX, bn_kv_cmp, &minheap);
+    err = loser_tree_create(HSE_C0_KVSET_ITER_MAX, bn_kv_cmp, bn_kv_head, &lt);
     if (ev(err))
         return err;
 
-    c0iw->c0iw_minheap = minheap;
+    c0iw->c0iw_lt = lt;
 
     return 0;
 }
@@ -34,7 +34,6 @@ c0_ingest_work_reset(struct c0_ingest_work *c0iw)
 {
     assert(c0iw->c0iw_magic == (uintptr_t)c0iw);
 
-    bin_heap2_reset(c0iw->c0iw_minheap);
     c0iw->c0iw_tailp = &c0iw->c0iw_next;
     *c0iw->c0iw_tailp = NULL;
     c0iw->c0iw_iterc = 0;
@@ -94,5 +93,5 @@ c0_ingest_work_fini(struct c0_ingest_work *w)
 
     BullseyeCoverageRestore
 
-        bin_heap2_destroy(w->c0iw_minheap);
+        loser_tree_destroy(w->c0iw_lt);
 }
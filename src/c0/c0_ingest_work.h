@@ -9,6 +9,7 @@
 #include <hse/hse_limits.h>
 
 #include <hse_util/platform.h>
+#include <hse_util/loser_tree.h>
 
 #include <hse_ikvdb/c0_kvset.h>
 #include <hse_ikvdb/limits.h>
@@ -20,7 +21,7 @@
 /**
  * struct c0_ingest_work - description of ingest work to be performed
  * @c0iw_c0:            struct c0 in whose context the ingest is occuring
- * @c0iw_minheap:
+ * @c0iw_lt:            loser tree merging c0iw_sourcev[]
  * @c0iw_sources:
  * @c0iw_iterv:
  * @c0iw_coalscedkvms:
@@ -40,7 +41,7 @@
 struct c0_ingest_work {
     struct work_struct          c0iw_work;
     void                       *c0iw_c0;
-    struct bin_heap2           *c0iw_minheap;
+    struct loser_tree          *c0iw_lt;
     struct element_source      *c0iw_sourcev[HSE_C0_KVSET_ITER_MAX];
     struct c0_kvset_iterator    c0iw_iterv[HSE_C0_KVSET_ITER_MAX];
     struct c0_kvmultiset       *c0iw_coalscedkvms[HSE_C0_KVSET_ITER_MAX];
@@ -6,6 +6,8 @@
 #define MTF_MOCK_IMPL_c0kvms
 
 #include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/log2.h>
 #include <hse_util/slab.h>
 #include <hse_util/condvar.h>
 #include <hse_util/perfc.h>
@@ -19,6 +21,7 @@
 
 #include "c0_cursor.h"
 #include "c0_ingest_work.h"
+#include "c0_filter.h"
 
 #include <hse_util/bonsai_tree.h>
 
@@ -95,9 +98,13 @@ struct c0_kvmultiset_impl {
 
     __aligned(SMP_CACHE_BYTES) u32 c0ms_num_sets;
     u32              c0ms_resetsz;
+    struct c0_filter c0ms_filter;
+    size_t           c0ms_filter_sz;
     struct c0_kvset *c0ms_sets[HSE_C0_INGEST_WIDTH_MAX];
 };
 
+#define C0KVMS_FILTER_SZ_MAX (8ul << 20)
+
 static atomic64_t         c0kvms_gen = ATOMIC_INIT(0);
 static struct kmem_cache *c0kvms_cache;
 static atomic_t           c0kvms_init_ref;
@@ -131,6 +138,17 @@ c0kvms_get_hashed_c0kvset(struct c0_kvmultiset *handle, u64 hash)
     return self->c0ms_sets[set_idx];
 }
 
+bool
+c0kvms_may_contain(struct c0_kvmultiset *handle, u64 hash)
+{
+    struct c0_kvmultiset_impl *self = c0_kvmultiset_h2r(handle);
+
+    if (unlikely(!self->c0ms_filter.cf_bitmap))
+        return true;
+
+    return c0_filter_lookup(&self->c0ms_filter, hash);
+}
+
 struct c0_kvset *
 c0kvms_get_c0kvset(struct c0_kvmultiset *handle, u32 index)
 {
@@ -876,6 +894,28 @@ c0kvms_seqno_set(struct c0_kvmultiset *handle, uint64_t kvdb_seq)
     atomic64_set(&self->c0ms_seqno, kvdb_seq);
 }
 
+/* Size the kvms filter at roughly one bit per 16 bytes of c0kvs capacity,
+ * which yields at least several bits per key for all but the smallest of
+ * keys and values.  Failure to allocate the filter is not fatal, it merely
+ * disables the filter for this kvms.
+ */
+static void
+c0kvms_filter_create(struct c0_kvmultiset_impl *kvms, size_t capacity)
+{
+    size_t sz;
+
+    sz = roundup_pow_of_two(max_t(size_t, capacity / 128, PAGE_SIZE));
+    sz = min_t(size_t, sz, C0KVMS_FILTER_SZ_MAX);
+
+    kvms->c0ms_filter.cf_bitmap = alloc_page_aligned(sz);
+    if (ev(!kvms->c0ms_filter.cf_bitmap))
+        return;
+
+    memset(kvms->c0ms_filter.cf_bitmap, 0, sz);
+    kvms->c0ms_filter.cf_shift = 64 - ilog2(sz / sizeof(u64));
+    kvms->c0ms_filter_sz = sz;
+}
+
 merr_t
 c0kvms_create(
     u32                    num_sets,
@@ -963,6 +1003,14 @@ c0kvms_create(
 
     /* define thresholds for transactions to merge/flush */
     kvms_sz = (kvms->c0ms_num_sets - 1) * alloc_sz;
+
+    /* The ptomb c0kvset (c0ms_sets[0]) is not filtered.
+     */
+    c0kvms_filter_create(kvms, kvms_sz);
+
+    for (i = 1; i < kvms->c0ms_num_sets; ++i)
+        c0kvs_filter_init(kvms->c0ms_sets[i], &kvms->c0ms_filter);
+
     kvms->c0ms_txn_thresh_lo = kvms_sz >> 4; /* 1/16th of kvms size */
     kvms->c0ms_txn_thresh_hi = kvms_sz >> 2; /* 1/4th  of kvms size */
 
@@ -1027,6 +1075,8 @@ c0kvms_destroy(struct c0_kvmultiset_impl *mset)
     mutex_destroy(&mset->c0ms_priv_lock);
     cv_destroy(&mset->c0ms_priv_cv);
 
+    free_aligned(mset->c0ms_filter.cf_bitmap);
+
     kmem_cache_free(c0kvms_cache, mset);
 
     perfc_dec(&c0_metrics_pc, PERFC_BA_C0METRICS_KVMS_CNT);
@@ -1063,6 +1113,9 @@ c0kvms_reset(struct c0_kvmultiset *handle)
 
     resetsz = self->c0ms_resetsz;
 
+    if (self->c0ms_filter.cf_bitmap)
+        memset(self->c0ms_filter.cf_bitmap, 0, self->c0ms_filter_sz);
+
     for (i = 0; i < self->c0ms_num_sets; ++i) {
         struct c0_kvset *c0kvs = self->c0ms_sets[i];
 
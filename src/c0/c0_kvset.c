@@ -8,7 +8,7 @@
 #include <hse_util/slab.h>
 #include <hse_util/log2.h>
 #include <hse_util/fmt.h>
-#include <hse_util/compression_lz4.h>
+#include <hse_util/compression.h>
 
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/c0_kvset.h>
@@ -17,6 +17,7 @@
 #include "c0_kvset_internal.h"
 #include "c0_cursor.h"
 #include "c0_kvsetm.h"
+#include "c0_filter.h"
 
 /* The minimum c0 cheap size should be at least 2MB and large enough to accomodate
  * at least one max-sized kvs value plus associated overhead.
@@ -164,40 +165,42 @@ c0kvs_ior_stats(
     const void *          new_value,
     u32                   new_value_len)
 {
+    /* Stats are updated atomically as replacements of existing keys
+     * are not serialized by the c0kvs lock (see c0kvs_putdel()).
+     */
     if (IS_IOR_INS(code)) {
         /* first insert for this key ... */
-        ++c0kvs->c0s_num_keys;
+        atomic_inc(&c0kvs->c0s_num_keys);
         if (!HSE_CORE_IS_TOMB(new_value))
-            ++c0kvs->c0s_num_entries;
+            atomic_inc(&c0kvs->c0s_num_entries);
         else
-            ++c0kvs->c0s_num_tombstones;
-        c0kvs->c0s_total_key_bytes += new_key_len;
-        c0kvs->c0s_total_value_bytes += new_value_len;
+            atomic_inc(&c0kvs->c0s_num_tombstones);
+        atomic64_add(new_key_len, &c0kvs->c0s_total_key_bytes);
+        atomic64_add(new_value_len, &c0kvs->c0s_total_value_bytes);
 
     } else if (IS_IOR_REP(code)) {
         /* replaced existing value for this key ... */
 
         if (!HSE_CORE_IS_TOMB(old_value)) {
             if (HSE_CORE_IS_TOMB(new_value)) {
-                --c0kvs->c0s_num_entries;
-                ++c0kvs->c0s_num_tombstones;
+                atomic_dec(&c0kvs->c0s_num_entries);
+                atomic_inc(&c0kvs->c0s_num_tombstones);
             }
-            c0kvs->c0s_total_value_bytes -= old_value_len;
-            c0kvs->c0s_total_value_bytes += new_value_len;
+            atomic64_add((long)new_value_len - old_value_len, &c0kvs->c0s_total_value_bytes);
         } else {
             if (!HSE_CORE_IS_TOMB(new_value)) {
-                ++c0kvs->c0s_num_entries;
-                --c0kvs->c0s_num_tombstones;
+                atomic_inc(&c0kvs->c0s_num_entries);
+                atomic_dec(&c0kvs->c0s_num_tombstones);
             }
-            c0kvs->c0s_total_value_bytes += new_value_len;
+            atomic64_add(new_value_len, &c0kvs->c0s_total_value_bytes);
         }
     } else {
         assert(IS_IOR_ADD(code));
         if (!HSE_CORE_IS_TOMB(new_value))
-            ++c0kvs->c0s_num_entries;
+            atomic_inc(&c0kvs->c0s_num_entries);
         else
-            ++c0kvs->c0s_num_tombstones;
-        c0kvs->c0s_total_value_bytes += new_value_len;
+            atomic_inc(&c0kvs->c0s_num_tombstones);
+        atomic64_add(new_value_len, &c0kvs->c0s_total_value_bytes);
     }
 }
 
@@ -221,10 +224,27 @@ c0kvs_ior_stats(
  *     use s
  */
 static u64
-c0kvs_seqno_set(struct c0_kvset_impl *c0kvs, struct bonsai_val *bv)
+c0kvs_seqno_get(struct c0_kvset_impl *c0kvs, bool incr)
 {
-    u64         seq;
     atomic64_t *sref = c0kvs->c0s_kvdb_seqno;
+    u64         seq;
+
+    seq = incr ? atomic64_add_return(1, sref) : atomic64_read(sref);
+
+    /* If KVMS seqno is valid, use it. */
+    if (unlikely(atomic64_read(c0kvs->c0s_kvms_seqno) != HSE_SQNREF_INVALID)) {
+        sref = c0kvs->c0s_kvms_seqno;
+
+        seq = incr ? atomic64_add_return(1, sref) : atomic64_read(sref);
+    }
+
+    return seq;
+}
+
+static u64
+c0kvs_seqno_set(struct c0_kvset_impl *c0kvs, struct bonsai_val *bv)
+{
+    u64 seq;
 
     /* [HSE_REVISIT]
      * If an operation (such as txBegin or cursorCreate) obtains a view
@@ -241,15 +261,7 @@ c0kvs_seqno_set(struct c0_kvset_impl *c0kvs, struct bonsai_val *bv)
      * different values for the same key. In other words, the view will
      * have changed.
      */
-    seq = bv->bv_valuep == HSE_CORE_TOMB_PFX ? atomic64_add_return(1, sref) : atomic64_read(sref);
-
-    /* If KVMS seqno is valid, use it. */
-    if (unlikely(atomic64_read(c0kvs->c0s_kvms_seqno) != HSE_SQNREF_INVALID)) {
-        sref = c0kvs->c0s_kvms_seqno;
-
-        seq =
-            bv->bv_valuep == HSE_CORE_TOMB_PFX ? atomic64_add_return(1, sref) : atomic64_read(sref);
-    }
+    seq = c0kvs_seqno_get(c0kvs, bv->bv_valuep == HSE_CORE_TOMB_PFX);
 
     bv->bv_seqnoref = HSE_ORDNL_TO_SQNREF(seq);
 
@@ -354,6 +366,32 @@ c0kvsm_insert_bkv(
     mutex_unlock(&c0kvs->c0s_mlock);
 }
 
+/* Add a range tombstone to the current non-tx mutation list.  It counts
+ * as one key and one value so that the c1 space estimates and the "has
+ * mutations" checks need not know about rtombs.
+ */
+static void
+c0kvsm_insert_rtomb(struct c0_kvset *handle, struct rtomb *rt)
+{
+    struct c0_kvset_impl *c0kvs;
+    struct c0_kvsetm *    ckm;
+
+    c0kvs = c0_kvset_h2r(handle);
+
+    mutex_lock(&c0kvs->c0s_mlock);
+    ckm = &c0kvs->c0s_m[c0kvsm_get_mindex(handle)];
+
+    rt->rt_mnext = ckm->c0m_rtombs;
+    ckm->c0m_rtombs = rt;
+
+    c0kvsm_update_seqno(ckm, rt->rt_seq);
+    ckm->c0m_ksize += rt->rt_slen;
+    ckm->c0m_vsize += rt->rt_elen;
+    ++ckm->c0m_kcnt;
+    ++ckm->c0m_vcnt;
+    mutex_unlock(&c0kvs->c0s_mlock);
+}
+
 /**
  * c0kvs_ior_cb() - Callback method to update stats on insert/replace and
  *                  attach a value element to the values list.
@@ -365,7 +403,9 @@ c0kvsm_insert_bkv(
  * @old_val:   old value element to be freed, if replaced (output)
  *
  * Called by the Bonsai tree code to insert a new value in an appropriate
- * position in the bkv_values list and update stats.
+ * position in the bkv_values list and update stats.  The callback for a
+ * new key is serialized by the c0kvs lock, whereas the callback for an
+ * existing key is serialized only by the key's bkv_lock.
  */
 void
 c0kvs_ior_cb(
@@ -633,6 +673,7 @@ c0kvsm_reset(struct c0_kvsetm *ckm)
 
     INIT_S_LIST_HEAD(&ckm->c0m_head);
     ckm->c0m_tail = &ckm->c0m_head;
+    ckm->c0m_rtombs = NULL;
     ckm->c0m_minseqno = U64_MAX;
     ckm->c0m_maxseqno = 0;
     ckm->c0m_ksize = 0;
@@ -709,6 +750,8 @@ c0kvs_create(
     set->c0s_reset_sz = cheap_used(cheap);
 
 created:
+    set->c0s_filter = NULL;
+    set->c0s_rtombs = NULL;
     set->c0s_kvdb_seqno = kvdb_seqno;
     set->c0s_kvms_seqno = kvms_seqno;
     set->c0s_mut_tracked = tracked;
@@ -777,11 +820,12 @@ c0kvs_reset(struct c0_kvset *handle, size_t sz)
 
     atomic_set(&set->c0s_finalized, 0);
     set->c0s_ingesting = &c0kvs_ingesting;
-    set->c0s_num_entries = 0;
-    set->c0s_num_tombstones = 0;
-    set->c0s_total_key_bytes = 0;
-    set->c0s_total_value_bytes = 0;
-    set->c0s_num_keys = 0;
+    atomic_set(&set->c0s_num_entries, 0);
+    atomic_set(&set->c0s_num_tombstones, 0);
+    atomic64_set(&set->c0s_total_key_bytes, 0);
+    atomic64_set(&set->c0s_total_value_bytes, 0);
+    atomic_set(&set->c0s_num_keys, 0);
+    set->c0s_rtombs = NULL;
 
     c0kvsm_init(handle);
 }
@@ -794,6 +838,14 @@ c0kvs_ingesting_init(struct c0_kvset *handle, atomic_t *ingesting)
     self->c0s_ingesting = ingesting;
 }
 
+void
+c0kvs_filter_init(struct c0_kvset *handle, struct c0_filter *filter)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+
+    self->c0s_filter = filter;
+}
+
 static __always_inline void
 c0kvs_lock(struct c0_kvset_impl *self)
 {
@@ -813,7 +865,7 @@ c0kvs_alloc(struct c0_kvset *handle, size_t align, size_t sz)
     void *                mem;
 
     c0kvs_lock(impl);
-    mem = cheap_memalign(impl->c0s_cheap, align, sz);
+    mem = cheap_memalign_concurrent(impl->c0s_cheap, align, sz);
     c0kvs_unlock(impl);
 
     return mem;
@@ -824,6 +876,7 @@ c0kvs_putdel(
     struct c0_kvset_impl *self,
     struct bonsai_skey *  skey,
     struct bonsai_sval *  sval,
+    u64                   hash,
     size_t                sz,
     bool                  tomb)
 {
@@ -832,14 +885,42 @@ c0kvs_putdel(
 
     sz += HSE_C0_BNODE_SLAB_SZ + PAGE_SIZE;
 
-    c0kvs_lock(self);
+    /* The key must be visible in the filter before it's visible
+     * in the tree (see c0kvms_may_contain()).
+     */
+    if (self->c0s_filter)
+        c0_filter_insert(self->c0s_filter, hash);
+
+    /* Adding a value to a key that is already in the tree requires
+     * only the key's lock, so concurrent updates of different keys
+     * proceed in parallel.  New keys change the shape of the tree,
+     * which the bonsai tree rebuilds by path copy up to the root,
+     * so their inserts must be serialized by the c0kvs lock.  The
+     * key and value are copied before acquiring the lock such that
+     * the critical section is limited to linking and rebalancing.
+     */
+    err = merr(ENOENT);
     avail = c0kvs_avail(&self->c0s_handle);
 
     if (likely(sz < avail))
-        err = bn_insert_or_replace(self->c0s_broot, skey, sval, tomb);
-    else
+        err = bn_update(self->c0s_broot, skey, sval, tomb);
+
+    if (merr_errno(err) == ENOENT) {
+        struct bonsai_kv *kv = NULL;
+
         err = (sz > self->c0s_alloc_sz) ? merr(EFBIG) : merr(ENOMEM);
-    c0kvs_unlock(self);
+
+        if (likely(sz < avail) && !bn_kv_alloc(self->c0s_broot, skey, sval, &kv)) {
+            c0kvs_lock(self);
+            avail = c0kvs_avail(&self->c0s_handle);
+
+            /* Leave room for the nodes copied by rebalancing.
+             */
+            if (likely(HSE_C0_BNODE_SLAB_SZ + PAGE_SIZE < avail))
+                err = bn_insert_kv(self->c0s_broot, kv, tomb);
+            c0kvs_unlock(self);
+        }
+    }
 
     /* Callers putting keys into the active kvms must hold the
      * RCU read lock.  As such, a c0kvset undergoing ingest will
@@ -866,8 +947,10 @@ c0kvs_put(
 
     bn_skey_init(key->kt_data, key->kt_len, skidx, &skey);
     bn_sval_init(value->vt_data, value->vt_xlen, seqnoref, &sval);
+    sval.bsv_expiry = value->vt_expiry;
 
-    return c0kvs_putdel(self, &skey, &sval, key->kt_len + kvs_vtuple_vlen(value), false);
+    return c0kvs_putdel(
+        self, &skey, &sval, key->kt_hash, key->kt_len + kvs_vtuple_vlen(value), false);
 }
 
 merr_t
@@ -880,7 +963,7 @@ c0kvs_del(struct c0_kvset *handle, u16 skidx, const struct kvs_ktuple *key, uint
     bn_skey_init(key->kt_data, key->kt_len, skidx, &skey);
     bn_sval_init(HSE_CORE_TOMB_REG, 0, seqnoref, &sval);
 
-    return c0kvs_putdel(self, &skey, &sval, key->kt_len, true);
+    return c0kvs_putdel(self, &skey, &sval, key->kt_hash, key->kt_len, true);
 }
 
 merr_t
@@ -897,7 +980,71 @@ c0kvs_prefix_del(
     bn_skey_init(key->kt_data, key->kt_len, skidx, &skey);
     bn_sval_init(HSE_CORE_TOMB_PFX, 0, seqnoref, &sval);
 
-    return c0kvs_putdel(self, &skey, &sval, key->kt_len, false);
+    return c0kvs_putdel(self, &skey, &sval, key->kt_hash, key->kt_len, false);
+}
+
+merr_t
+c0kvs_range_del(
+    struct c0_kvset *        handle,
+    u16                      skidx,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end,
+    uintptr_t                seqnoref)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+    struct rtomb *        rt;
+    size_t                sz;
+
+    sz = rtomb_size(start->kt_len, end->kt_len);
+
+    c0kvs_lock(self);
+    if (sz + PAGE_SIZE >= c0kvs_avail(handle)) {
+        c0kvs_unlock(self);
+        return merr(ENOMEM);
+    }
+
+    rt = cheap_memalign_concurrent(self->c0s_cheap, __alignof(*rt), sz);
+    if (ev(!rt)) {
+        c0kvs_unlock(self);
+        return merr(ENOMEM);
+    }
+
+    rt->rt_skidx = skidx;
+    rt->rt_slen = start->kt_len;
+    rt->rt_elen = end->kt_len;
+    memcpy(rt->rt_data, start->kt_data, start->kt_len);
+    memcpy(rt->rt_data + start->kt_len, end->kt_data, end->kt_len);
+
+    /* As with ptombs, a range delete always consumes a seqno so that
+     * it hides only those keys that were put before it.
+     */
+    if (HSE_SQNREF_SINGLE_P(seqnoref))
+        rt->rt_seq = c0kvs_seqno_get(self, true);
+    else
+        rt->rt_seq = HSE_SQNREF_TO_ORDNL(seqnoref);
+
+    rt->rt_next = self->c0s_rtombs;
+    rt->rt_mnext = NULL;
+    rcu_assign_pointer(self->c0s_rtombs, rt);
+
+    if (self->c0s_mut_tracked)
+        c0kvsm_insert_rtomb(handle, rt);
+
+    atomic64_add(start->kt_len + end->kt_len, &self->c0s_total_key_bytes);
+    atomic_inc(&self->c0s_num_tombstones);
+    c0kvs_unlock(self);
+
+    assert(atomic_read(&self->c0s_finalized) == 0);
+
+    return 0;
+}
+
+struct rtomb *
+c0kvs_rtombs(struct c0_kvset *handle)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+
+    return rcu_dereference(self->c0s_rtombs);
 }
 
 void
@@ -910,10 +1057,10 @@ c0kvs_get_content_metrics(
 {
     struct c0_kvset_impl *self = c0_kvset_h2r(handle);
 
-    *num_entries = self->c0s_num_entries;
-    *num_tombstones = self->c0s_num_tombstones;
-    *total_key_bytes = self->c0s_total_key_bytes;
-    *total_value_bytes = self->c0s_total_value_bytes;
+    *num_entries = atomic_read(&self->c0s_num_entries);
+    *num_tombstones = atomic_read(&self->c0s_num_tombstones);
+    *total_key_bytes = atomic64_read(&self->c0s_total_key_bytes);
+    *total_value_bytes = atomic64_read(&self->c0s_total_value_bytes);
 }
 
 u64
@@ -921,7 +1068,7 @@ c0kvs_get_element_count(struct c0_kvset *handle)
 {
     struct c0_kvset_impl *self = c0_kvset_h2r(handle);
 
-    return self->c0s_num_entries + self->c0s_num_tombstones;
+    return atomic_read(&self->c0s_num_entries) + atomic_read(&self->c0s_num_tombstones);
 }
 
 void
@@ -937,10 +1084,10 @@ c0kvs_usage(struct c0_kvset *handle, struct c0_usage *usage)
     usage->u_free = free;
     usage->u_used_min = self->c0s_alloc_sz - free;
     usage->u_used_max = self->c0s_alloc_sz - free;
-    usage->u_keys = self->c0s_num_entries;
-    usage->u_tombs = self->c0s_num_tombstones;
-    usage->u_keyb = self->c0s_total_key_bytes;
-    usage->u_valb = self->c0s_total_value_bytes;
+    usage->u_keys = atomic_read(&self->c0s_num_entries);
+    usage->u_tombs = atomic_read(&self->c0s_num_tombstones);
+    usage->u_keyb = atomic64_read(&self->c0s_total_key_bytes);
+    usage->u_valb = atomic64_read(&self->c0s_total_value_bytes);
     usage->u_count = 1;
 }
 
@@ -989,12 +1136,13 @@ c0kvs_get_excl(
 
     *oseqnoref = val->bv_seqnoref;
 
-    if (HSE_CORE_IS_TOMB(val->bv_valuep)) {
+    if (HSE_CORE_IS_TOMB(val->bv_valuep) || kvs_expired(val->bv_expiry)) {
         *res = FOUND_TMB;
         return 0;
     }
 
     vbuf->b_len = bonsai_val_vlen(val);
+    vbuf->b_expiry = val->bv_expiry;
     copylen = vbuf->b_len;
 
     if (copylen > vbuf->b_buf_sz)
@@ -1005,15 +1153,18 @@ c0kvs_get_excl(
         ulen = bonsai_val_ulen(val);
 
         if (clen > 0) {
-            err = compress_lz4_ops.cop_decompress(
-                val->bv_value, clen, vbuf->b_buf, vbuf->b_buf_sz, &outlen);
+            err = compress_codec_decompress(
+                bonsai_val_codec(val), val->bv_value, clen, vbuf->b_buf, vbuf->b_buf_sz, &outlen);
             if (ev(err))
                 return err;
 
             if (ev(outlen != min_t(uint, ulen, vbuf->b_buf_sz)))
                 return merr(EBUG);
 
-            vbuf->b_len = outlen;
+            /* Report the full length even if the value was truncated,
+             * as does cn_get().
+             */
+            vbuf->b_len = ulen;
         } else {
             memcpy(vbuf->b_buf, val->bv_value, copylen);
         }
@@ -1102,8 +1253,8 @@ c0kvs_pfx_probe_excl(
         if (!val)
             continue;
 
-        /* add to tomblist if a tombstone was encountered */
-        if (HSE_CORE_IS_TOMB(val->bv_valuep)) {
+        /* add to tomblist if a tombstone or expired value was encountered */
+        if (HSE_CORE_IS_TOMB(val->bv_valuep) || kvs_expired(val->bv_expiry)) {
             err = qctx_tomb_insert(qctx, kv->bkv_key + klen - sfx_len, sfx_len);
             if (ev(err))
                 break;
@@ -1119,6 +1270,10 @@ c0kvs_pfx_probe_excl(
         } else {
             if (val_seq < pt_seq)
                 continue;
+
+            /* Skip the key if hidden by an rtomb in this or a newer kvms. */
+            if (qctx_rtomb_seq(qctx, kv->bkv_key, klen) > val_seq)
+                continue;
         }
 
         if (++qctx->seen == 1) {
@@ -1140,8 +1295,9 @@ c0kvs_pfx_probe_excl(
                 ulen = bonsai_val_ulen(val);
 
                 if (clen > 0) {
-                    err = compress_lz4_ops.cop_decompress(
-                        val->bv_value, clen, vbuf->b_buf, vbuf->b_buf_sz, &outlen);
+                    err = compress_codec_decompress(
+                        bonsai_val_codec(val), val->bv_value, clen,
+                        vbuf->b_buf, vbuf->b_buf_sz, &outlen);
                     if (ev(err))
                         return err;
 
@@ -1259,7 +1415,11 @@ c0kvs_debug(struct c0_kvset *handle, void *key, int klen)
     char   disp[256];
     size_t max = sizeof(disp);
 
-    printf("%p nkey %d ntomb %d\n", self, self->c0s_num_keys, self->c0s_num_tombstones);
+    printf(
+        "%p nkey %d ntomb %d\n",
+        self,
+        atomic_read(&self->c0s_num_keys),
+        atomic_read(&self->c0s_num_tombstones));
 
     rcu_read_lock();
     end = &self->c0s_broot->br_kv;
@@ -1404,6 +1564,7 @@ c0kvsm_switch(struct c0_kvset *handle)
     idx = c0kvsm_get_mindex(handle) ^ 1;
 
     assert(s_list_empty(&self->c0s_m[idx].c0m_head));
+    assert(!self->c0s_m[idx].c0m_rtombs);
     assert(s_list_empty(&self->c0s_txm[idx].c0m_head));
 
     mutex_lock(&self->c0s_mlock);
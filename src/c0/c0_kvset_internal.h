@@ -18,6 +18,7 @@
  * @c0s_broot:             bonsai tree instance
  * @c0s_alloc_sz:          client requested cursor heap size
  * @c0s_ingesting:         kvset ready-for or currently-is ingesting
+ * @c0s_filter:            kvms key membership filter (may be nil)
  * @c0s_finalized:         kvset is frozen and undergoing c0 ingest
  * @c0s_reset_sz:          size of cheap used by fully setup c0kkvs
  * @c0s_next:              cheap cache linkage
@@ -28,13 +29,14 @@
  * @c0s_num_entries:       how many entries (doesn't include tombstones)
  * @c0s_num_keys:          how many keys (includes tombstones)
  * @c0s_num_tombstones:    how many tombstones
- * @c0s_mutex:             mutex for bonsai tree updates
+ * @c0s_mutex:             mutex for bonsai tree inserts of new keys
  * @c0s_mlock:             lock protecting the mutation list
  * @c0s_m:                 pair of non-tx mutation list
  * @c0s_txm:               pair of tx mutation list
  * @c0s_txpend:            tx pending list
  * @c0s_mut_tracked:       whether mutations tracked or not
  * @c0s_mindex:            mutation index
+ * @c0s_rtombs:            list of range tombstones (newest first)
  *
  * Note:  To improve performance in the face of heavy contention, %c0s_mutex
  * is laid out so that it straddles two cache lines:  The lock word and other
@@ -51,6 +53,7 @@ struct c0_kvset_impl {
     struct bonsai_root *  c0s_broot;
     size_t                c0s_alloc_sz;
     atomic_t *            c0s_ingesting;
+    struct c0_filter *    c0s_filter;
     atomic_t              c0s_finalized;
     u32                   c0s_reset_sz;
     struct c0_kvset_impl *c0s_next;
@@ -59,11 +62,11 @@ struct c0_kvset_impl {
     atomic64_t *c0s_kvdb_seqno;
     atomic64_t *c0s_kvms_seqno;
 
-    __aligned(SMP_CACHE_BYTES) u64 c0s_total_key_bytes;
-    u64          c0s_total_value_bytes;
-    u32          c0s_num_entries;
-    u32          c0s_num_keys;
-    u32          c0s_num_tombstones;
+    __aligned(SMP_CACHE_BYTES) atomic64_t c0s_total_key_bytes;
+    atomic64_t   c0s_total_value_bytes;
+    atomic_t     c0s_num_entries;
+    atomic_t     c0s_num_keys;
+    atomic_t     c0s_num_tombstones;
     u64          c0s_pad;
     struct mutex c0s_mutex;
 
@@ -75,6 +78,8 @@ struct c0_kvset_impl {
 
     __aligned(SMP_CACHE_BYTES) bool c0s_mut_tracked;
     u8 c0s_mindex;
+
+    struct rtomb *c0s_rtombs;
 };
 
 #endif
@@ -134,10 +134,17 @@ c0kvsm_copy_bkv(struct c0_kvset *c0kvs, struct c0kvsm_info *info, u8 mindex, boo
         bkvs[nkv++] = bkv;
         INIT_S_LIST_HEAD(&bkv->bkv_mnext[mindex]);
     }
+
+    /* Only the ptomb c0kvset has range tombstones, and it is never
+     * combined with another c0kvset in an iter.
+     */
+    assert(!ckm->c0m_rtombs || !info->c0s_rtombs);
+    if (ckm->c0m_rtombs)
+        info->c0s_rtombs = ckm->c0m_rtombs;
     c0kvsm_reset(ckm);
 
-    /* Due to duplicates, nkv can be less than the aggregated value
-     * obtained earlier for this kvset.
+    /* Due to duplicates and range tombstones, nkv can be less than
+     * the aggregated value obtained earlier for this kvset.
      */
     assert(nkv <= info->c0s_nbkv[kidx]);
     if (nkv < info->c0s_nbkv[kidx])
@@ -18,6 +18,7 @@
 struct bonsai_kv;
 struct c0sk_mutation;
 struct c0_kvmultiset;
+struct rtomb;
 
 /* struct c0_kvsetm - tracks mutations in a kvset.
  * @c0m_head:     head of the mutation list
@@ -26,12 +27,14 @@ struct c0_kvmultiset;
  * @c0m_maxseqno: max sequence number
  * @c0m_ksize:    total key bytes in the mutation list
  * @c0m_vsize:    total value bytes in the mutation list
- * @c0m_kcnt:     number of keys mutated
- * @c0m_vcnt:     number of values mutated
+ * @c0m_kcnt:     number of keys mutated (includes range tombstones)
+ * @c0m_vcnt:     number of values mutated (includes range tombstones)
+ * @c0m_rtombs:   range tombstones in the mutation list (newest first)
  */
 struct c0_kvsetm {
     struct s_list_head  c0m_head;
     struct s_list_head *c0m_tail;
+    struct rtomb *      c0m_rtombs;
     uintptr_t           c0m_minseqno;
     uintptr_t           c0m_maxseqno;
     u64                 c0m_ksize;
@@ -52,6 +55,7 @@ struct c0_kvsetm {
  * @c0s_bkvidx:   current bonsai_kv index being processed
  * @c0s_cbkv:     current index processed in a c0kvset
  * @c0s_tbkv:     current index processed in an iter
+ * @c0s_rtombs:   range tombstones to be logged by this iter
  * @c0s_txn:      txn or non-txn mutation info.
  * @c0s_ptomb:    true, if it's a ptomb c0kvset.
  * @c0s_nkiter:   no. of c0kvsets in an iter
@@ -66,6 +70,7 @@ struct c0kvsm_info {
     u32                 c0s_bkvidx;
     u32                 c0s_cbkv;
     u32                 c0s_tbkv;
+    struct rtomb *      c0s_rtombs;
     bool                c0s_txn;
     bool                c0s_ptomb;
     u16                 c0s_nkiter;
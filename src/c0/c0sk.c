@@ -14,7 +14,7 @@
 #include <hse_util/table.h>
 #include <hse_util/string.h>
 #include <hse_util/fmt.h>
-#include <hse_util/compression_lz4.h>
+#include <hse_util/compression.h>
 
 #include <hse_util/rcu.h>
 #include <hse_util/cds_list.h>
@@ -33,6 +33,7 @@
 #include <hse_ikvdb/c0_kvset_iterator.h>
 #include <hse_ikvdb/kvdb_ctxn.h>
 #include <hse_ikvdb/cursor.h>
+#include <hse_ikvdb/query_ctx.h>
 #include <hse_ikvdb/kvdb_rparams.h>
 #include <hse_ikvdb/rparam_debug_flags.h>
 
@@ -299,6 +300,23 @@ c0sk_prefix_del(struct c0sk *handle, u16 skidx, const struct kvs_ktuple *kt, u64
     return c0sk_putdel(self, skidx, C0SK_OP_PREFIX_DEL, kt, NULL, seqno);
 }
 
+merr_t
+c0sk_range_del(
+    struct c0sk *            handle,
+    u16                      skidx,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end,
+    u64                      seqno)
+{
+    struct c0sk_impl *self = c0sk_h2r(handle);
+    struct kvs_ktuple ktv[2];
+
+    ktv[0] = *start;
+    ktv[1] = *end;
+
+    return c0sk_putdel(self, skidx, C0SK_OP_RANGE_DEL, ktv, NULL, seqno);
+}
+
 /*
  * Tombstone indicated by:
  *     return value == 0 && res == FOUND_TOMB
@@ -318,8 +336,9 @@ c0sk_get(
     struct c0sk_impl *    self;
     uintptr_t             key_seqref = 0, ptomb_seqref = 0;
     u64                   start;
-    u64                   pfx_seq = 0, val_seq = 0;
+    u64                   pfx_seq = 0, val_seq = 0, rt_seq = 0;
     u64                   seq;
+    uint                  skips = 0;
     merr_t                err = 0;
 
     self = c0sk_h2r(handle);
@@ -351,6 +370,19 @@ c0sk_get(
                 pfx_seq = seq;
         }
 
+        /* Search for the newest range tombstone covering the key.
+         */
+        c0kvs = c0kvms_ptomb_c0kvset_get(c0kvms);
+        seq = rtomb_list_seq(c0kvs_rtombs(c0kvs), skidx, kt->kt_data, kt->kt_len, view_seq);
+        if (seq > rt_seq)
+            rt_seq = seq;
+
+        /* Skip the bonsai tree search if the key is not in this kvms. */
+        if (!c0kvms_may_contain(c0kvms, kt->kt_hash)) {
+            ++skips;
+            continue;
+        }
+
         /* Search for latest value of key w/ seqno <= iseqno. */
         c0kvs = c0kvms_get_hashed_c0kvset(c0kvms, kt->kt_hash);
         err = c0kvs_get_rcu(c0kvs, skidx, kt, view_seq, seqref, res, vbuf, &key_seqref);
@@ -367,6 +399,9 @@ c0sk_get(
     if (pfx_seq > val_seq) {
         *res = FOUND_PTMB;
         vbuf->b_len = 0;
+    } else if (rt_seq > val_seq) {
+        *res = FOUND_TMB;
+        vbuf->b_len = 0;
     }
 
     if (start > 0) {
@@ -374,6 +409,9 @@ c0sk_get(
         perfc_inc(&self->c0sk_pc_op, PERFC_RA_C0SKOP_GET);
     }
 
+    if (skips > 0)
+        perfc_add(&self->c0sk_pc_op, PERFC_RA_C0SKOP_GET_SKIP, skips);
+
     return err;
 }
 
@@ -395,6 +433,7 @@ c0sk_pfx_probe(
     struct c0sk_impl *    self;
     uintptr_t             ptomb_seqref = 0;
     u64                   pfx_seq = 0;
+    uint                  skips = 0;
     merr_t                err = 0;
 
     self = c0sk_h2r(handle);
@@ -421,6 +460,19 @@ c0sk_pfx_probe(
             pfx_seq = HSE_SQNREF_TO_ORDNL(ptomb_seqref);
         }
 
+        /* Remember the range tombstones that overlap the prefix so that
+         * this and all older kvms and kvsets can apply them.
+         */
+        c0kvs = c0kvms_ptomb_c0kvset_get(c0kvms);
+        err = qctx_rtombs_add(qctx, c0kvs_rtombs(c0kvs), skidx, kt->kt_data, kt->kt_len, view_seq);
+        if (ev(err))
+            break;
+
+        if (!pfx_seq && !c0kvms_may_contain(c0kvms, kt->kt_hash)) {
+            ++skips;
+            continue;
+        }
+
         err = c0kvms_pfx_probe_rcu(c0kvms, skidx, kt, sfx_len, view_seq, seqref, res, qctx, kbuf, vbuf, pfx_seq);
         if (ev(err))
             break;
@@ -434,6 +486,9 @@ c0sk_pfx_probe(
     }
     rcu_read_unlock();
 
+    if (skips > 0)
+        perfc_add(&self->c0sk_pc_op, PERFC_RA_C0SKOP_PROBE_SKIP, skips);
+
     return err;
 }
 
@@ -517,6 +572,22 @@ c0sk_open(
         goto errout;
     }
 
+    /* Each ingest thread merges one kvs itself and farms out the rest
+     * to the per-kvs ingest workqueue.
+     */
+    tdmax = min_t(u64, kvdb_rp->c0_ingest_kvs_threads, HSE_C0_INGEST_KVS_THREADS_MAX);
+    tdmax = max_t(int, tdmax, 1);
+
+    c0sk->c0sk_ingest_kvs_threads = tdmax;
+
+    if (tdmax > 1) {
+        c0sk->c0sk_wq_ingest_kvs = alloc_workqueue("c0sk_ingkvs", WQ_SHARDED, tdmax - 1);
+        if (!c0sk->c0sk_wq_ingest_kvs) {
+            err = merr(ev(ENOMEM));
+            goto errout;
+        }
+    }
+
     tdmax = min_t(u64, kvdb_rp->c0_maint_threads, HSE_C0_MAINT_THREADS_MAX);
     tdmax = max_t(int, tdmax, 1);
 
@@ -559,6 +630,7 @@ errout:
 
         if (c0sk) {
             destroy_workqueue(c0sk->c0sk_wq_ingest);
+            destroy_workqueue(c0sk->c0sk_wq_ingest_kvs);
             destroy_workqueue(c0sk->c0sk_wq_maint);
             c0sk_free_concurrency_control(c0sk);
             free_aligned(c0sk);
@@ -611,6 +683,7 @@ c0sk_close(struct c0sk *handle)
     }
 
     destroy_workqueue(self->c0sk_wq_ingest);
+    destroy_workqueue(self->c0sk_wq_ingest_kvs);
     destroy_workqueue(self->c0sk_wq_maint);
     c0sk_free_concurrency_control(self);
     c0sk_perfc_free(self);
@@ -1489,6 +1562,13 @@ copy_kv(void *buf, size_t bufsz, struct kvs_kvtuple *kvt, struct bonsai_kv *bkv,
         return 0;
     }
 
+    /* An expired value must hide older values of the key in cN.
+     */
+    if (kvs_expired(val->bv_expiry)) {
+        kvs_vtuple_init(&kvt->kvt_value, HSE_CORE_TOMB_REG, 0);
+        return 0;
+    }
+
     bufsz -= roundup(klen, 8);
     buf += roundup(klen, 8);
 
@@ -1496,7 +1576,8 @@ copy_kv(void *buf, size_t bufsz, struct kvs_kvtuple *kvt, struct bonsai_kv *bkv,
     ulen = bonsai_val_ulen(val);
 
     if (clen > 0) {
-        err = compress_lz4_ops.cop_decompress(val->bv_value, clen, buf, bufsz, &outlen);
+        err = compress_codec_decompress(
+            bonsai_val_codec(val), val->bv_value, clen, buf, bufsz, &outlen);
 
         if (!err && outlen != ulen)
             err = merr(EBUG);
@@ -1525,6 +1606,33 @@ c0sk_cursor_skip_pfx(struct c0_cursor *cur, struct bonsai_kv *bkv)
     return 0;
 }
 
+/* Return the seqno of the newest range tombstone visible to the cursor
+ * which covers the given key, or zero if there is none.
+ */
+static u64
+c0sk_cursor_rtomb_seq(struct c0_cursor *cur, const void *key, u32 klen)
+{
+    struct c0_kvmultiset_cursor *this;
+    u64                          seq = 0;
+
+    for (this = cur->c0cur_active; this; this = MSCUR_NEXT(this)) {
+        struct c0_kvset *c0kvs = c0kvms_ptomb_c0kvset_get(this->c0mc_kvms);
+        u64              rt_seq;
+
+        rt_seq = rtomb_list_seq(c0kvs_rtombs(c0kvs), cur->c0cur_skidx, key, klen, cur->c0cur_seqno);
+        if (rt_seq > seq)
+            seq = rt_seq;
+    }
+
+    return seq;
+}
+
+bool
+c0sk_cursor_rtomb_covers(struct c0_cursor *cur, const void *key, u32 klen)
+{
+    return c0sk_cursor_rtomb_seq(cur, key, klen) > 0;
+}
+
 /*
  * When a cursor sees a ptomb, it is either from a txn kvms, or a regular kvms.
  * 1. TXN KVMS (seqnoref && seqnoref == val->bv_seqnoref):
@@ -1622,6 +1730,14 @@ c0sk_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof)
             }
         }
 
+        /* Hide keys (other than those from the txn kvms) which were
+         * put before a range tombstone that covers them.
+         */
+        if (!is_ptomb && (!seqnoref || seqnoref != val->bv_seqnoref) &&
+            c0sk_cursor_rtomb_seq(cur, bkv->bkv_key, klen) >
+                HSE_SQNREF_TO_ORDNL(val->bv_seqnoref))
+            continue;
+
         /* If ptomb, move iterators past prefix for all KVMS older than
          * current.
          */
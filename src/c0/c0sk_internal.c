@@ -387,7 +387,9 @@ c0sk_builder_add(
             seqno,
             bonsai_val_vlen(val) ? val->bv_value : val->bv_valuep,
             bonsai_val_ulen(val),
-            bonsai_val_clen(val));
+            bonsai_val_clen(val),
+            bonsai_val_codec(val),
+            val->bv_expiry);
 
         if (ev(err))
             return err;
@@ -414,98 +416,113 @@ c0sk_ingest_rec_perfc(struct perfc_set *perfc, u32 sidx, u64 cycles)
     perfc_rec_sample(perfc, sidx, cycles);
 }
 
-void
-c0sk_ingest_worker(struct work_struct *work)
+/* Get the ingest work's kvset builder for skidx, creating it if need be.
+ */
+static merr_t
+c0sk_ingest_bldr_get(
+    struct c0sk_impl *     c0sk,
+    struct kvset_builder **bldrs,
+    u16                    skidx,
+    struct kvset_builder **bldrp)
 {
-    struct bin_heap2 *minheap __aligned(64);
-    struct bonsai_kv *        bkv_prev;
-    struct bonsai_kv *        bkv;
-    struct kvset_builder *    bldr;
-    struct kvset_builder **   bldrs;
-    const void *              last_key = NULL;
-    u16                       last_klen = 0;
-    struct bonsai_val *       val_head;
-    struct bonsai_val **      val_tailp;
-    struct bonsai_val **      val_prevp;
-    struct bonsai_val *       val;
-    u64                       seqno;
-    u64                       last_skidx = 0;
-    u16                       unsorted;
-    s16                       debug;
-    u16                       skidx_prev;
-    u16                       skidx;
-    merr_t                    err;
-    struct cn *               cn;
-    u64                       go = 0;
-
-    /* Maintain separate ptomb seqno prev to distinguish b/w a key and a
-     * ptomb from different KVMSes that have the same seqno.
-     */
-    u64 seqno_prev, pt_seqno_prev;
-
-    struct c0_ingest_work *ingest;
-    struct kvset_mblocks * mblocks;
-    struct c0_kvmultiset * kvms;
-    struct c0sk_impl *     c0sk;
-    u32                    iterc;
-    int                    i;
-    int *                  mbc;
-    struct kvset_mblocks **mbv;
-    u32 *                  cmtv;
-    bool                   do_cn_ingest = false;
-    u64                    ingestid;
+    struct kvset_builder *bldr = bldrs[skidx];
+    struct cn *           cn;
+    merr_t                err;
 
-    ingest = container_of(work, struct c0_ingest_work, c0iw_work);
+    if (!bldr) {
+        cn = c0sk->c0sk_cnv[skidx];
+        assert(cn);
+        err = kvset_builder_create(
+            &bldr, cn, cn_get_ingest_perfc(cn), get_time_ns(), KVSET_BUILDER_FLAGS_INGEST);
+        if (ev(err))
+            return err;
 
-    minheap = ingest->c0iw_minheap;
-    bldrs = ingest->c0iw_bldrs;
-    mblocks = ingest->c0iw_mblocks;
-    iterc = ingest->c0iw_iterc;
-    kvms = ingest->c0iw_c0kvms;
-    mbc = ingest->c0iw_mbc;
-    mbv = ingest->c0iw_mbv;
-    cmtv = ingest->c0iw_cmtv;
+        kvset_builder_set_agegroup(bldr, HSE_MPOLICY_AGE_ROOT);
 
-    val_tailp = &val_head;
-    val_prevp = NULL;
-    val_head = NULL;
+        bldrs[skidx] = bldr;
+    }
 
-    c0sk = c0sk_h2r(ingest->c0iw_c0);
-    debug = c0sk->c0sk_kvdb_rp->c0_debug & C0_DEBUG_INGSPILL;
-    ingestid = CNDB_DFLT_INGESTID;
-    err = 0;
+    *bldrp = bldr;
 
-    assert(c0sk->c0sk_kvdb_health);
+    return 0;
+}
 
-    if (debug)
-        ingest->t0 = get_time_ns();
+/**
+ * c0sk_ingest_rtombs() - add the range tombstones of a kvs to its builder
+ * @c0sk:    ptr to c0sk
+ * @ingest:  ingest work
+ * @skidx:   index of the kvs
+ *
+ * Range tombstones are not kept in the c0 kvsets' bonsai trees and hence
+ * are not seen by the merge, so they are added to the kvs' builder
+ * separately (creating the builder if the kvs has no other mutations).
+ */
+static merr_t
+c0sk_ingest_rtombs(struct c0sk_impl *c0sk, struct c0_ingest_work *ingest, u16 skidx)
+{
+    struct kvset_builder *bldr;
+    struct rtomb *        rt;
+    merr_t                err;
 
-    c0kvms_priv_wait(kvms);
+    rt = c0kvs_rtombs(c0kvms_ptomb_c0kvset_get(ingest->c0iw_c0kvms));
 
-    if (ev(iterc == 0))
-        goto exit_err;
+    for (; rt; rt = rt->rt_next) {
+        if (rt->rt_skidx != skidx)
+            continue;
 
-    if (c0sk->c0sk_kvdb_rp->c0_diag_mode)
-        goto exit_err;
+        err = c0sk_ingest_bldr_get(c0sk, ingest->c0iw_bldrs, skidx, &bldr);
+        if (ev(err))
+            return err;
 
-    while (unlikely((c0sk->c0sk_kvdb_rp->c0_debug & C0_DEBUG_ACCUMULATE) && !c0sk->c0sk_syncing))
-        cpu_relax();
+        err = kvset_builder_add_rtomb(bldr, rt);
+        if (ev(err))
+            return err;
+    }
 
-    /* ingests do not stop on block deletion failures. */
-    err = kvdb_health_check(
-        c0sk->c0sk_kvdb_health, KVDB_HEALTH_FLAG_ALL & ~KVDB_HEALTH_FLAG_DELBLKFAIL);
-    if (ev(err))
-        goto exit_err;
+    return 0;
+}
 
-    go = perfc_lat_start(&c0sk->c0sk_pc_ingest);
+/**
+ * c0sk_ingest_merge() - merge keys from a min heap into kvset builders
+ * @c0sk:    ptr to c0sk
+ * @ingest:  ingest work
+ * @lt:      prepared loser tree of c0 kvset iterators
+ * @lastp:   (output) last key popped from the min heap
+ *
+ * Keys are added to the ingest work's per-skidx kvset builders, which are
+ * created on demand.  Callers that merge concurrently must partition the
+ * keys by skidx such that no two callers add to the same builder.
+ */
+static merr_t
+c0sk_ingest_merge(
+    struct c0sk_impl *     c0sk,
+    struct c0_ingest_work *ingest,
+    struct loser_tree *    lt,
+    struct bonsai_kv **    lastp)
+{
+    struct kvset_builder **bldrs = ingest->c0iw_bldrs;
+    struct c0_kvmultiset * kvms = ingest->c0iw_c0kvms;
+    struct kvset_builder * bldr;
+    struct bonsai_kv *     bkv_prev;
+    struct bonsai_kv *     bkv;
+    struct bonsai_val *    val_head;
+    struct bonsai_val **   val_tailp;
+    struct bonsai_val **   val_prevp;
+    struct bonsai_val *    val;
+    u64                    seqno;
+    u16                    unsorted;
+    u16                    skidx_prev;
+    u16                    skidx;
+    merr_t                 err;
 
-    /* this logic error cannot result in WA, not kvdb_health recordable */
-    err = bin_heap2_prepare(minheap, iterc, ingest->c0iw_sourcev + HSE_C0_KVSET_ITER_MAX - iterc);
-    if (ev(err))
-        goto exit_err;
+    /* Maintain separate ptomb seqno prev to distinguish b/w a key and a
+     * ptomb from different KVMSes that have the same seqno.
+     */
+    u64 seqno_prev, pt_seqno_prev;
 
-    if (debug)
-        ingest->t3 = get_time_ns();
+    val_tailp = &val_head;
+    val_prevp = NULL;
+    val_head = NULL;
 
     seqno_prev = U64_MAX;
     pt_seqno_prev = U64_MAX;
@@ -514,13 +531,7 @@ c0sk_ingest_worker(struct work_struct *work)
     unsorted = 0;
     bldr = NULL;
     seqno = 0;
-
-    ingestid = c0kvms_rsvd_sn_get(kvms);
-
-    /*
-     */
-    if (ingestid == HSE_SQNREF_INVALID)
-        ingestid = CNDB_DFLT_INGESTID;
+    err = 0;
 
     /* Due to how sourcev[] is constructed by c0sk_coalesce(), the bin
      * heap returns identicals keys in order of youngest to oldest
@@ -538,17 +549,17 @@ c0sk_ingest_worker(struct work_struct *work)
      *   value from the older group (i.e., the one with the largest
      *   sequence number).
      */
-    while (bin_heap2_pop(minheap, (void **)&bkv)) {
+    while (loser_tree_pop(lt, (void **)&bkv)) {
         bool have_val = false;
 
-        last_skidx = skidx = key_immediate_index(&bkv->bkv_key_imm);
+        skidx = key_immediate_index(&bkv->bkv_key_imm);
 
         if (val_head && (bn_kv_cmp(bkv, bkv_prev) || skidx != skidx_prev)) {
             *val_tailp = NULL;
 
             err = c0sk_builder_add(bldr, kvms, bkv_prev, val_head, unsorted);
             if (ev(err))
-                goto health_err;
+                goto errout;
 
             seqno_prev = U64_MAX;
             pt_seqno_prev = U64_MAX;
@@ -559,8 +570,6 @@ c0sk_ingest_worker(struct work_struct *work)
         }
 
         bkv_prev = bkv;
-        last_klen = key_imm_klen(&bkv->bkv_key_imm);
-        last_key = bkv->bkv_key;
 
         /* Append values from the current key to the list of values
          * from previous identical keys.  Swap adjacent values that
@@ -618,23 +627,9 @@ c0sk_ingest_worker(struct work_struct *work)
 
         if (have_val && skidx != skidx_prev) {
             skidx_prev = skidx;
-            bldr = bldrs[skidx];
-            if (!bldr) {
-                cn = c0sk->c0sk_cnv[skidx];
-                assert(cn);
-                err = kvset_builder_create(
-                    &bldr,
-                    cn,
-                    cn_get_ingest_perfc(c0sk->c0sk_cnv[skidx]),
-                    get_time_ns(),
-                    KVSET_BUILDER_FLAGS_INGEST);
-                if (ev(err))
-                    goto health_err;
-
-                kvset_builder_set_agegroup(bldr, HSE_MPOLICY_AGE_ROOT);
-
-                bldrs[skidx] = bldr;
-            }
+            err = c0sk_ingest_bldr_get(c0sk, bldrs, skidx, &bldr);
+            if (ev(err))
+                goto errout;
         }
     }
 
@@ -643,23 +638,431 @@ c0sk_ingest_worker(struct work_struct *work)
 
         err = c0sk_builder_add(bldr, kvms, bkv_prev, val_head, unsorted);
         if (ev(err))
-            goto health_err;
+            goto errout;
 
         val_head = NULL;
     }
 
-    if (debug)
-        ingest->t4 = get_time_ns();
+errout:
+    if (err) {
+        *val_tailp = NULL;
 
-    for (i = 0; i < HSE_KVS_COUNT_MAX; ++i) {
-        if (bldrs[i] == 0)
+        while ((val = val_head)) {
+            val_head = val->bv_free;
+            val->bv_free = NULL;
+        }
+    }
+
+    *lastp = bkv_prev;
+
+    return err;
+}
+
+/**
+ * struct c0sk_ingest_kvs_ctl - shared state of a parallel per-kvs ingest
+ * @ic_c0sk:    ptr to c0sk
+ * @ic_ingest:  ingest work being processed
+ * @ic_sourcev: element sources (c0 kvset iterators) of the ingest
+ * @ic_sourcec: number of elements in ic_sourcev[]
+ * @ic_next:    index of the next skidx in ic_skidxv[] to be merged
+ * @ic_skidxc:  number of elements in ic_skidxv[]
+ * @ic_skidxv:  skidx of each open kvs
+ * @ic_lock:    protects ic_active and ic_err
+ * @ic_cv:      signaled when ic_active drops to zero
+ * @ic_active:  number of workers still running
+ * @ic_err:     first error encountered by any worker
+ */
+struct c0sk_ingest_kvs_ctl {
+    struct c0sk_impl *      ic_c0sk;
+    struct c0_ingest_work * ic_ingest;
+    struct element_source **ic_sourcev;
+    u32                     ic_sourcec;
+    atomic_t                ic_next;
+    uint                    ic_skidxc;
+    u16                     ic_skidxv[HSE_KVS_COUNT_MAX];
+    struct mutex            ic_lock;
+    struct cv               ic_cv;
+    uint                    ic_active;
+    merr_t                  ic_err;
+};
+
+/**
+ * struct c0sk_ingest_kvs - per-worker state of a parallel per-kvs ingest
+ * @ik_work:    work struct
+ * @ik_ctl:     shared state
+ * @ik_lt:      loser tree over ik_sourcev[]
+ * @ik_last:    last key merged by this worker in its largest skidx
+ * @ik_sourcev: element sources for the skidx being merged
+ * @ik_iterv:   c0 kvset iterators restricted to the skidx being merged
+ */
+struct c0sk_ingest_kvs {
+    struct work_struct          ik_work;
+    struct c0sk_ingest_kvs_ctl *ik_ctl;
+    struct loser_tree *         ik_lt;
+    struct bonsai_kv *          ik_last;
+    struct element_source *     ik_sourcev[HSE_C0_KVSET_ITER_MAX];
+    struct c0_kvset_iterator    ik_iterv[HSE_C0_KVSET_ITER_MAX];
+};
+
+/* Restrict each of the ingest's c0 kvset iterators to the given skidx,
+ * preserving their relative order (which the min heap relies upon to
+ * order identical keys from youngest to oldest).
+ */
+static u32
+c0sk_ingest_kvs_prepare(struct c0sk_ingest_kvs *ik, u16 skidx)
+{
+    struct c0sk_ingest_kvs_ctl *ctl = ik->ik_ctl;
+    u32                         i, n;
+
+    for (i = n = 0; i < ctl->ic_sourcec; ++i) {
+        struct c0_kvset_iterator *iter = ik->ik_iterv + n;
+
+        *iter = *container_of(ctl->ic_sourcev[i], struct c0_kvset_iterator, c0it_handle);
+        iter->c0it_flags |= C0_KVSET_ITER_FLAG_INDEX;
+        iter->c0it_index = skidx;
+
+        c0_kvset_iterator_seek(iter, "", 0, NULL);
+        if (c0_kvset_iterator_empty(iter))
             continue;
 
-        mbc[i] = 1;
-        mbv[i] = &mblocks[i];
-        err = kvset_builder_get_mblocks(bldrs[i], &mblocks[i]);
+        ik->ik_sourcev[n++] = c0_kvset_iterator_get_es(iter);
+    }
+
+    return n;
+}
+
+static void
+c0sk_ingest_kvs_worker(struct work_struct *work)
+{
+    struct c0sk_ingest_kvs *    ik = container_of(work, struct c0sk_ingest_kvs, ik_work);
+    struct c0sk_ingest_kvs_ctl *ctl = ik->ik_ctl;
+    struct c0_ingest_work *     ingest = ctl->ic_ingest;
+    struct c0sk_impl *          c0sk = ctl->ic_c0sk;
+    merr_t                      err = 0;
+    uint                        i;
+
+    while ((i = atomic_inc_return(&ctl->ic_next) - 1) < ctl->ic_skidxc) {
+        struct bonsai_kv *last;
+        u16               skidx;
+        u64               tstart;
+        u32               n;
+
+        skidx = ctl->ic_skidxv[i];
+        tstart = get_time_ns();
+
+        n = c0sk_ingest_kvs_prepare(ik, skidx);
+        if (n > 0) {
+            err = loser_tree_prepare(ik->ik_lt, n, ik->ik_sourcev);
+            if (ev(err))
+                break;
+
+            err = c0sk_ingest_merge(c0sk, ingest, ik->ik_lt, &last);
+            if (ev(err))
+                break;
+
+            if (last)
+                ik->ik_last = last;
+        }
+
+        err = c0sk_ingest_rtombs(c0sk, ingest, skidx);
+        if (ev(err))
+            break;
+
+        if (ingest->c0iw_bldrs[skidx]) {
+            ingest->c0iw_mbc[skidx] = 1;
+            ingest->c0iw_mbv[skidx] = &ingest->c0iw_mblocks[skidx];
+
+            err = kvset_builder_get_mblocks(
+                ingest->c0iw_bldrs[skidx], &ingest->c0iw_mblocks[skidx]);
+            if (ev(err))
+                break;
+        }
+
+        if (PERFC_ISON(&c0sk->c0sk_pc_ingest))
+            perfc_rec_sample(
+                &c0sk->c0sk_pc_ingest, PERFC_DI_C0SKING_KVSBLD, (get_time_ns() - tstart) / 1000);
+    }
+
+    /* Stop the other workers from starting on any more kvses.
+     */
+    if (err)
+        atomic_set(&ctl->ic_next, ctl->ic_skidxc);
+
+    mutex_lock(&ctl->ic_lock);
+    if (err && !ctl->ic_err)
+        ctl->ic_err = err;
+    if (--ctl->ic_active == 0)
+        cv_signal(&ctl->ic_cv);
+    mutex_unlock(&ctl->ic_lock);
+}
+
+static void
+c0sk_ingest_kvs_free(struct c0sk_ingest_kvs *ikv, uint width)
+{
+    uint i;
+
+    if (!ikv)
+        return;
+
+    for (i = 0; i < width; ++i)
+        loser_tree_destroy(ikv[i].ik_lt);
+
+    free(ikv);
+}
+
+/**
+ * c0sk_ingest_kvs_alloc() - allocate per-worker state for a parallel ingest
+ * @c0sk:   ptr to c0sk
+ * @widthp: (output) number of workers
+ *
+ * Return: NULL if the per-worker state cannot be allocated, in which
+ * case the caller should merge all kvses serially.
+ */
+static struct c0sk_ingest_kvs *
+c0sk_ingest_kvs_alloc(struct c0sk_impl *c0sk, uint *widthp)
+{
+    struct c0sk_ingest_kvs *ikv;
+    uint                    width, kvsc, i;
+    merr_t                  err;
+
+    for (i = kvsc = 0; i < HSE_KVS_COUNT_MAX; ++i)
+        kvsc += !!c0sk->c0sk_cnv[i];
+
+    width = 1;
+    if (c0sk->c0sk_wq_ingest_kvs)
+        width = max_t(uint, min_t(uint, c0sk->c0sk_ingest_kvs_threads, kvsc), 1);
+
+    ikv = calloc(width, sizeof(*ikv));
+    if (ev(!ikv))
+        return NULL;
+
+    for (i = 0; i < width; ++i) {
+        err = loser_tree_create(HSE_C0_KVSET_ITER_MAX, bn_kv_cmp, bn_kv_head, &ikv[i].ik_lt);
+        if (ev(err)) {
+            c0sk_ingest_kvs_free(ikv, i);
+            return NULL;
+        }
+
+        INIT_WORK(&ikv[i].ik_work, c0sk_ingest_kvs_worker);
+    }
+
+    *widthp = width;
+
+    return ikv;
+}
+
+/**
+ * c0sk_ingest_kvs_run() - merge and build each kvs of an ingest in parallel
+ * @c0sk:   ptr to c0sk
+ * @ingest: ingest work
+ * @ikv:    per-worker state from c0sk_ingest_kvs_alloc()
+ * @width:  number of elements in ikv[]
+ * @lastp:  (output) last key merged (i.e., the largest key of the largest
+ *          skidx)
+ *
+ * The keys of a kvms are ordered first by skidx, so the ingest can be
+ * partitioned by skidx into independent merges, each of which produces
+ * the mblocks for one kvs.  The calling thread merges kvses itself, while
+ * (width - 1) helpers from c0sk_wq_ingest_kvs merge the others.  All kvses
+ * are built before this function returns, such that the caller can commit
+ * them via a single cn_ingestv().
+ *
+ * Return: the first merge/build error encountered by any worker.
+ */
+static merr_t
+c0sk_ingest_kvs_run(
+    struct c0sk_impl *      c0sk,
+    struct c0_ingest_work * ingest,
+    struct c0sk_ingest_kvs *ikv,
+    uint                    width,
+    struct bonsai_kv **     lastp)
+{
+    struct c0sk_ingest_kvs_ctl ctl;
+    merr_t                     err;
+    uint                       i;
+
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.ic_c0sk = c0sk;
+    ctl.ic_ingest = ingest;
+    ctl.ic_sourcec = ingest->c0iw_iterc;
+    ctl.ic_sourcev = ingest->c0iw_sourcev + HSE_C0_KVSET_ITER_MAX - ingest->c0iw_iterc;
+
+    for (i = 0; i < HSE_KVS_COUNT_MAX; ++i) {
+        if (c0sk->c0sk_cnv[i])
+            ctl.ic_skidxv[ctl.ic_skidxc++] = i;
+    }
+
+    atomic_set(&ctl.ic_next, 0);
+    mutex_init(&ctl.ic_lock);
+    cv_init(&ctl.ic_cv, "c0sk_ingest_kvs");
+    ctl.ic_active = width;
+
+    for (i = 0; i < width; ++i) {
+        ikv[i].ik_ctl = &ctl;
+        ikv[i].ik_last = NULL;
+    }
+
+    for (i = 1; i < width; ++i)
+        queue_work(c0sk->c0sk_wq_ingest_kvs, &ikv[i].ik_work);
+
+    c0sk_ingest_kvs_worker(&ikv[0].ik_work);
+
+    mutex_lock(&ctl.ic_lock);
+    while (ctl.ic_active > 0)
+        cv_wait(&ctl.ic_cv, &ctl.ic_lock);
+    err = ctl.ic_err;
+    mutex_unlock(&ctl.ic_lock);
+
+    /* Skidxs are merged in ascending order by each worker, so the last
+     * key of the whole ingest is the last key of the largest skidx.
+     */
+    *lastp = NULL;
+
+    for (i = 0; i < width; ++i) {
+        struct bonsai_kv *last = ikv[i].ik_last;
+
+        if (last && (!*lastp || key_immediate_index(&last->bkv_key_imm) >
+                                    key_immediate_index(&(*lastp)->bkv_key_imm)))
+            *lastp = last;
+    }
+
+    cv_destroy(&ctl.ic_cv);
+    mutex_destroy(&ctl.ic_lock);
+
+    return err;
+}
+
+void
+c0sk_ingest_worker(struct work_struct *work)
+{
+    struct loser_tree *lt __aligned(64);
+    struct bonsai_kv *        last_bkv = NULL;
+    struct kvset_builder **   bldrs;
+    const void *              last_key = NULL;
+    u16                       last_klen = 0;
+    u64                       last_skidx = 0;
+    s16                       debug;
+    merr_t                    err;
+    u64                       go = 0;
+
+    struct c0_ingest_work *ingest;
+    struct kvset_mblocks * mblocks;
+    struct c0_kvmultiset * kvms;
+    struct c0sk_impl *     c0sk;
+    u32                    iterc;
+    int                    i;
+    int *                  mbc;
+    struct kvset_mblocks **mbv;
+    u32 *                  cmtv;
+    bool                   do_cn_ingest = false;
+    u64                    ingestid;
+    struct c0sk_ingest_kvs *ikv;
+    uint                    width;
+
+    ingest = container_of(work, struct c0_ingest_work, c0iw_work);
+
+    lt = ingest->c0iw_lt;
+    bldrs = ingest->c0iw_bldrs;
+    mblocks = ingest->c0iw_mblocks;
+    iterc = ingest->c0iw_iterc;
+    kvms = ingest->c0iw_c0kvms;
+    mbc = ingest->c0iw_mbc;
+    mbv = ingest->c0iw_mbv;
+    cmtv = ingest->c0iw_cmtv;
+
+    c0sk = c0sk_h2r(ingest->c0iw_c0);
+    debug = c0sk->c0sk_kvdb_rp->c0_debug & C0_DEBUG_INGSPILL;
+    ingestid = CNDB_DFLT_INGESTID;
+    err = 0;
+
+    assert(c0sk->c0sk_kvdb_health);
+
+    if (debug)
+        ingest->t0 = get_time_ns();
+
+    c0kvms_priv_wait(kvms);
+
+    if (ev(iterc == 0))
+        goto exit_err;
+
+    if (c0sk->c0sk_kvdb_rp->c0_diag_mode)
+        goto exit_err;
+
+    while (unlikely((c0sk->c0sk_kvdb_rp->c0_debug & C0_DEBUG_ACCUMULATE) && !c0sk->c0sk_syncing))
+        cpu_relax();
+
+    /* ingests do not stop on block deletion failures. */
+    err = kvdb_health_check(
+        c0sk->c0sk_kvdb_health, KVDB_HEALTH_FLAG_ALL & ~KVDB_HEALTH_FLAG_DELBLKFAIL);
+    if (ev(err))
+        goto exit_err;
+
+    go = perfc_lat_start(&c0sk->c0sk_pc_ingest);
+
+    ingestid = c0kvms_rsvd_sn_get(kvms);
+
+    /*
+     */
+    if (ingestid == HSE_SQNREF_INVALID)
+        ingestid = CNDB_DFLT_INGESTID;
+
+    /* Merge and build each kvs independently, in parallel if possible.
+     * Fall back to a single merge over all kvses if we can't allocate
+     * the per-worker state.
+     */
+    ikv = c0sk_ingest_kvs_alloc(c0sk, &width);
+    if (ikv) {
+        if (debug)
+            ingest->t3 = get_time_ns();
+
+        err = c0sk_ingest_kvs_run(c0sk, ingest, ikv, width, &last_bkv);
+
+        c0sk_ingest_kvs_free(ikv, width);
+
+        if (debug)
+            ingest->t4 = get_time_ns();
+
+        if (ev(err))
+            goto health_err;
+    } else {
+        /* this logic error cannot result in WA, not kvdb_health recordable */
+        err = loser_tree_prepare(
+            lt, iterc, ingest->c0iw_sourcev + HSE_C0_KVSET_ITER_MAX - iterc);
+        if (ev(err))
+            goto exit_err;
+
+        if (debug)
+            ingest->t3 = get_time_ns();
+
+        err = c0sk_ingest_merge(c0sk, ingest, lt, &last_bkv);
         if (ev(err))
             goto health_err;
+
+        if (debug)
+            ingest->t4 = get_time_ns();
+
+        for (i = 0; i < HSE_KVS_COUNT_MAX; ++i) {
+            if (c0sk->c0sk_cnv[i]) {
+                err = c0sk_ingest_rtombs(c0sk, ingest, i);
+                if (ev(err))
+                    goto health_err;
+            }
+
+            if (bldrs[i] == 0)
+                continue;
+
+            mbc[i] = 1;
+            mbv[i] = &mblocks[i];
+            err = kvset_builder_get_mblocks(bldrs[i], &mblocks[i]);
+            if (ev(err))
+                goto health_err;
+        }
+    }
+
+    if (last_bkv) {
+        last_skidx = key_immediate_index(&last_bkv->bkv_key_imm);
+        last_klen = key_imm_klen(&last_bkv->bkv_key_imm);
+        last_key = last_bkv->bkv_key;
     }
 
     if (debug)
@@ -672,15 +1075,6 @@ health_err:
         kvdb_health_error(c0sk->c0sk_kvdb_health, err);
 
 exit_err:
-    if (err) {
-        *val_tailp = NULL;
-
-        while ((val = val_head)) {
-            val_head = val->bv_free;
-            val->bv_free = NULL;
-        }
-    }
-
     mutex_lock(&c0sk->c0sk_kvms_mutex);
     while (1) {
         if (kvms == c0sk_get_last_c0kvms(&c0sk->c0sk_handle))
@@ -1367,6 +1761,7 @@ c0sk_merge_bkv(
             struct kvs_vtuple vt;
 
             kvs_vtuple_init(&vt, bv->bv_value, bv->bv_xlen);
+            vt.vt_expiry = bv->bv_expiry;
             err = c0kvs_put(c0kvs, skidx, &kt, &vt, seqnoref);
         } else if (bv->bv_valuep == HSE_CORE_TOMB_REG) {
             err = c0kvs_del(c0kvs, skidx, &kt, seqnoref);
@@ -1569,12 +1964,16 @@ c0sk_putdel(
             err = c0kvs_put(kvs, skidx, kt, vt, seqnoref);
         } else if (op == C0SK_OP_DEL) {
             err = c0kvs_del(kvs, skidx, kt, seqnoref);
-        } else {
-            assert(op == C0SK_OP_PREFIX_DEL);
-
+        } else if (op == C0SK_OP_PREFIX_DEL) {
             /* Ignore hashed kvset. Use ptomb kvset. */
             kvs = c0kvms_ptomb_c0kvset_get(dst);
             err = c0kvs_prefix_del(kvs, skidx, kt, seqnoref);
+        } else {
+            assert(op == C0SK_OP_RANGE_DEL);
+
+            /* Range tombstones live alongside the ptombs. */
+            kvs = c0kvms_ptomb_c0kvset_get(dst);
+            err = c0kvs_range_del(kvs, skidx, &kt[0], &kt[1], seqnoref);
         }
 
         assert(!c0kvms_is_finalized(dst)); /* See c0kvs_putdel() */
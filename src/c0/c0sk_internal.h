@@ -32,6 +32,8 @@ struct c0sk {
  * @c0sk_ds:              mpool dataset
  * @c0sk_wq_ingest        workqueue for ingest processing (one thread)
  * @c0sk_wq_maint         workqueue for concurrent maintenance tasks
+ * @c0sk_wq_ingest_kvs:   workqueue for parallel per-kvs ingest merges
+ * @c0sk_ingest_kvs_threads: max threads that may work on a single ingest
  * @c0sk_mtx_pool:        mutex/condvar pool for ingest synchronization
  * @c0sk_kvms_mutex:      mutex protecting the list of c0_kvmultisets
  * @c0sk_kvmultisets_cnt: how many struct c0_kvmultiset's does this c0sk have
@@ -68,6 +70,8 @@ struct c0sk_impl {
     struct mpool *           c0sk_ds;      /* not owned by c0sk */
     struct workqueue_struct *c0sk_wq_ingest;
     struct workqueue_struct *c0sk_wq_maint;
+    struct workqueue_struct *c0sk_wq_ingest_kvs;
+    uint                     c0sk_ingest_kvs_threads;
     struct mtx_pool *        c0sk_mtx_pool;
     struct kvdb_health *     c0sk_kvdb_health;
     struct kvdb_callback *   c0sk_callback; /* not owned by c0sk */
@@ -204,6 +208,7 @@ enum c0sk_op {
     C0SK_OP_PUT,
     C0SK_OP_DEL,
     C0SK_OP_PREFIX_DEL,
+    C0SK_OP_RANGE_DEL,
 };
 
 /**
@@ -211,7 +216,7 @@ enum c0sk_op {
  * @self:        struct c0sk_impl in which to put
  * @skidx:       which kvs is the insert targeted to
  * @op:
- * @kt:          key tuple
+ * @kt:          key tuple (start and end keys for C0SK_OP_RANGE_DEL)
  * @vt:          value tuple
  * @seqnoref:    seqnoref of kvtuple
  *
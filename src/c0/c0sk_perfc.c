@@ -23,6 +23,8 @@ struct perfc_name c0sk_perfc_op[] = {
     NE(PERFC_LT_C0SKOP_PUT, 3, "Latency of c0sk puts", "l_put(/s)"),
     NE(PERFC_RA_C0SKOP_DEL, 3, "Count of c0sk dels", "c_del(/s)"),
     NE(PERFC_LT_C0SKOP_DEL, 3, "Latency of c0sk dels", "l_del(/s)"),
+    NE(PERFC_RA_C0SKOP_GET_SKIP, 3, "kvms skipped by filter on get", "c_gskip(/s)"),
+    NE(PERFC_RA_C0SKOP_PROBE_SKIP, 3, "kvms skipped by filter on probe", "c_pskip(/s)"),
 };
 
 struct perfc_name c0sk_perfc_ingest[] = {
@@ -34,6 +36,7 @@ struct perfc_name c0sk_perfc_ingest[] = {
     NE(PERFC_BA_C0SKING_WIDTH, 3, "Ingest width", "d_width"),
     NE(PERFC_DI_C0SKING_THRSR, 3, "Throttle sensor", "c_thrsr", 10),
     NE(PERFC_DI_C0SKING_MEM, 3, "Ingest memory limit", "c_ingmem"),
+    NE(PERFC_DI_C0SKING_KVSBLD, 3, "Per-kvs ingest build time", "l_ingkvs(us)"),
 };
 
 NE_CHECK(c0sk_perfc_op, PERFC_EN_C0SKOP, "c0sk_perfc_op table/enum mismatch");
@@ -65,6 +68,7 @@ c0sk_perfc_init(void)
     c0sk_perfc_ingest[PERFC_DI_C0SKING_THRSR].pcn_ivl = ivl;
     c0sk_perfc_ingest[PERFC_DI_C0SKING_MEM].pcn_ivl = ivl;
     c0sk_perfc_ingest[PERFC_DI_C0SKING_KVMSDSIZE].pcn_ivl = ivl;
+    c0sk_perfc_ingest[PERFC_DI_C0SKING_KVSBLD].pcn_ivl = ivl;
 
     c0sk_perfc_op[PERFC_LT_C0SKOP_GET].pcn_samplepct = 3;
     c0sk_perfc_op[PERFC_LT_C0SKOP_PUT].pcn_samplepct = 3;
@@ -101,6 +105,9 @@ struct perfc_name c0skm_perfc_op[] = {
     NE(PERFC_BA_C0SKM_KVMSF, 3, "Count of c0skm kvms final", "c_kvmsf"),
     NE(PERFC_LT_C0SKM_KVMSI, 3, "Latency of c0skm kvms ing.", "l_kvmsi(ns)"),
     NE(PERFC_DI_C0SKM_VBLDRT, 3, "Ratio of values from c0/c1", "d_vbldrt(b)"),
+    NE(PERFC_RA_C0SKM_OPSYNC, 3, "Rate of c0skm per-op sync", "c_opsync(/s)"),
+    NE(PERFC_LT_C0SKM_OPSYNC, 3, "Latency of c0skm per-op sync", "l_opsync(ns)"),
+    NE(PERFC_DI_C0SKM_SYNCW, 3, "Sync waiters per c1 ingest", "d_syncw"),
 };
 
 NE_CHECK(c0skm_perfc_op, PERFC_EN_C0SKMOP, "c0skm perfc ops table/enum mismatch");
@@ -155,6 +162,7 @@ c0skm_perfc_init(void)
     c0skm_perfc_kv[PERFC_DI_C0SKM_KVKSK].pcn_ivl = ivl;
     c0skm_perfc_op[PERFC_DI_C0SKM_TSYNCD].pcn_ivl = ivl;
     c0skm_perfc_op[PERFC_DI_C0SKM_INGEST].pcn_ivl = ivl;
+    c0skm_perfc_op[PERFC_DI_C0SKM_SYNCW].pcn_ivl = ivl;
     c0skm_perfc_kv[PERFC_DI_C0SKM_DSIZE].pcn_ivl = ivl;
     c0skm_perfc_kv[PERFC_DI_C0SKM_DTIME].pcn_ivl = ivl;
 
@@ -163,9 +163,13 @@ c0skm_close(struct c0sk *handle)
     self->c0sk_mhandle = NULL;
 }
 
-/* Implements external sync request (hse_kvdb_sync) */
-merr_t
-c0skm_sync(struct c0sk *handle)
+/* Wait for all mutations issued before the call to be persisted in c1.
+ * Concurrent callers are coalesced: callers that arrive while a sync
+ * work is in flight set c0skm_syncpend and are all satisfied by the
+ * single c1 ingest (log append plus flush) of the next sync work.
+ */
+static merr_t
+c0skm_sync_impl(struct c0sk *handle, u32 ra_cidx, u32 lt_cidx)
 {
     struct c0sk_waiter    waiter = {};
     struct c0sk_impl *    self;
@@ -217,12 +221,26 @@ c0skm_sync(struct c0sk *handle)
 
     cv_destroy(&waiter.c0skw_cv);
 
-    perfc_rec_lat(&c0skm->c0skm_pcset_op, PERFC_LT_C0SKM_SYNC, start);
-    perfc_inc(&c0skm->c0skm_pcset_op, PERFC_RA_C0SKM_SYNC);
+    perfc_rec_lat(&c0skm->c0skm_pcset_op, lt_cidx, start);
+    perfc_inc(&c0skm->c0skm_pcset_op, ra_cidx);
 
     return waiter.c0skw_err;
 }
 
+/* Implements external sync request (hse_kvdb_sync) */
+merr_t
+c0skm_sync(struct c0sk *handle)
+{
+    return c0skm_sync_impl(handle, PERFC_RA_C0SKM_SYNC, PERFC_LT_C0SKM_SYNC);
+}
+
+/* Implements per-operation sync requests (HSE_KVDB_KOP_FLAG_SYNC) */
+merr_t
+c0skm_sync_op(struct c0sk *handle)
+{
+    return c0skm_sync_impl(handle, PERFC_RA_C0SKM_OPSYNC, PERFC_LT_C0SKM_OPSYNC);
+}
+
 /* Implements external flush request (hse_kvdb_flush) */
 merr_t
 c0skm_flush(struct c0sk *handle)
@@ -402,14 +420,19 @@ static void
 c0skm_signal_waiters(struct c0sk_mutation *c0skm, u64 gen, merr_t err)
 {
     struct c0sk_waiter *p;
+    u64                 nwaiters = 0;
 
     /* Awaken all threads waiting on the given mutation generation. */
     list_for_each_entry (p, &c0skm->c0skm_sync_waiters, c0skw_link) {
         if (gen >= p->c0skw_gen) {
             p->c0skw_err = err;
             cv_broadcast(&p->c0skw_cv);
+            ++nwaiters;
         }
     }
+
+    if (nwaiters > 0)
+        perfc_dis_record(&c0skm->c0skm_pcset_op, PERFC_DI_C0SKM_SYNCW, nwaiters);
 }
 
 static merr_t
@@ -14,6 +14,7 @@
 #include <hse_ikvdb/kvb_builder.h>
 #include <hse_ikvdb/kvdb_perfc.h>
 #include <hse_ikvdb/c1.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include "c0skm_internal.h"
 #include "c0_kvmsm.h"
@@ -159,7 +160,7 @@ kvb_builder_get_next(struct kvb_builder_iter *iter, struct c1_kvbundle **ckvb)
 #endif
 
     /* No more bundles to consume */
-    if (tbkv >= nbkv) {
+    if (tbkv >= nbkv && !info->c0s_rtombs) {
         perfc_rec_sample(set, PERFC_DI_C0SKM_KVBPI, iter->kvbi_kvbc);
         return 0;
     }
@@ -191,6 +192,17 @@ kvb_builder_get_next(struct kvb_builder_iter *iter, struct c1_kvbundle **ckvb)
     kskip = 0;
     tail = NULL;
 
+    /* Range tombstones are few, so all of them go into the first
+     * bundle, ahead of the keys.
+     */
+    if (info->c0s_rtombs) {
+        err = kvb_builder_rtombs_add(iter, info->c0s_rtombs, kvb, &kvlen, &tail);
+        if (ev(err))
+            return err;
+
+        info->c0s_rtombs = NULL;
+    }
+
     /* Fill a stripsz worth of data in this kvb */
     while (kvlen <= stripsz && tbkv < nbkv) {
         struct bonsai_kv **bkvs;
@@ -262,6 +274,57 @@ kvb_builder_get_next(struct kvb_builder_iter *iter, struct c1_kvbundle **ckvb)
     return 0;
 }
 
+merr_t
+kvb_builder_rtombs_add(
+    struct kvb_builder_iter *iter,
+    struct rtomb *           rtombs,
+    struct c1_kvbundle *     kvb,
+    u64 *                    kvlen,
+    struct s_list_head **    tail)
+{
+    struct c1_kvcache *kvc;
+    struct rtomb *     rt;
+
+    kvc = iter->kvbi_kvcache;
+
+    /* Each rtomb is logged as its start key with a single value of
+     * type C1_VTYPE_RTOMB that holds the end key.
+     */
+    for (rt = rtombs; rt; rt = rt->rt_mnext) {
+        struct s_list_head *vtail = NULL;
+        struct c1_kvtuple * kvt;
+        struct c1_vtuple *  cvt;
+        merr_t              err;
+        u64                 cnid;
+
+        cnid = c0skm_get_cnid(iter->kvbi_c0skm, rt->rt_skidx);
+        if (ev(cnid == 0)) {
+            hse_log(HSE_ERR "%s: invalid cnid %lu for skidx %u", __func__, cnid, rt->rt_skidx);
+            return merr(ENOENT);
+        }
+
+        err = c1_kvtuple_alloc(kvc, &kvt);
+        if (ev(err))
+            return err;
+
+        err = c1_vtuple_alloc(kvc, &cvt);
+        if (ev(err))
+            return err;
+
+        c1_vtuple_init(cvt, rt->rt_elen, rt->rt_seq, (void *)rtomb_end(rt), C1_VTYPE_RTOMB, 0);
+        c1_kvtuple_addval(kvt, cvt, &vtail);
+
+        c1_kvtuple_init(kvt, rt->rt_slen, (void *)rtomb_start(rt), cnid, rt->rt_skidx, NULL);
+
+        c1_kvbundle_set_seqno(kvb, rt->rt_seq, rt->rt_seq);
+        c1_kvbundle_add_kvt(kvb, kvt, tail);
+
+        *kvlen += rt->rt_slen + rt->rt_elen;
+    }
+
+    return 0;
+}
+
 merr_t
 kvb_builder_kvtuple_add(
     struct kvb_builder_iter *iter,
@@ -465,7 +528,13 @@ kvb_builder_vtuple_add(
         if (*maxseqno < seqno)
             *maxseqno = seqno;
 
-        c1_vtuple_init(cvt, len, seqno, data, tomb);
+        c1_vtuple_init(
+            cvt,
+            len,
+            seqno,
+            data,
+            tomb ? C1_VTYPE_TOMB : C1_VTYPE_VAL,
+            tomb ? 0 : val->bv_expiry);
 
         c1_kvtuple_addval(ckvt, cvt, &tail);
     }
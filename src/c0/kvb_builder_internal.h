@@ -9,6 +9,16 @@
 merr_t
 kvb_builder_get_next(struct kvb_builder_iter *iter, struct c1_kvbundle **ckvb);
 
+struct rtomb;
+
+merr_t
+kvb_builder_rtombs_add(
+    struct kvb_builder_iter *iter,
+    struct rtomb *           rtombs,
+    struct c1_kvbundle *     kvb,
+    u64 *                    kvlen,
+    struct s_list_head **    tail);
+
 merr_t
 kvb_builder_kvtuple_add(
     struct kvb_builder_iter *iter,
@@ -213,6 +213,62 @@ MTF_DEFINE_UTEST_PREPOST(c0_kvmultiset_test, create_insert_check, no_fail_pre, n
     c0kvms_putref(kvms);
 }
 
+MTF_DEFINE_UTEST_PREPOST(c0_kvmultiset_test, key_filter, no_fail_pre, no_fail_post)
+{
+    struct c0_kvmultiset *kvms = 0;
+    struct c0_kvset *     p;
+    merr_t                err;
+    int                   i, fp;
+
+    const int WIDTH = 8;
+    const int NKEYS = 10000;
+
+    err = c0kvms_create(WIDTH, HSE_C0_CHEAP_SZ_DFLT, 0, 0, true, &kvms);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < NKEYS; i += 2) {
+        struct kvs_ktuple kt;
+        struct kvs_vtuple vt;
+
+        kvs_ktuple_init(&kt, &i, sizeof(i));
+        kvs_vtuple_init(&vt, &i, sizeof(i));
+
+        p = c0kvms_get_hashed_c0kvset(kvms, kt.kt_hash);
+        if (i % 4)
+            err = c0kvs_del(p, 0, &kt, HSE_ORDNL_TO_SQNREF(0));
+        else
+            err = c0kvs_put(p, 0, &kt, &vt, HSE_ORDNL_TO_SQNREF(0));
+        ASSERT_EQ(0, err);
+    }
+
+    /* No false negatives, and few false positives. */
+    for (i = fp = 0; i < NKEYS; ++i) {
+        struct kvs_ktuple kt;
+
+        kvs_ktuple_init(&kt, &i, sizeof(i));
+
+        if (i % 2 == 0)
+            ASSERT_TRUE(c0kvms_may_contain(kvms, kt.kt_hash));
+        else
+            fp += c0kvms_may_contain(kvms, kt.kt_hash);
+    }
+
+    ASSERT_LT(fp, NKEYS / 2 / 20);
+
+    c0kvms_reset(kvms);
+
+    for (i = fp = 0; i < NKEYS; i += 2) {
+        struct kvs_ktuple kt;
+
+        kvs_ktuple_init(&kt, &i, sizeof(i));
+        fp += c0kvms_may_contain(kvms, kt.kt_hash);
+    }
+
+    ASSERT_EQ(0, fp);
+
+    c0kvms_putref(kvms);
+}
+
 MTF_DEFINE_UTEST_PREPOST(c0_kvmultiset_test, ingest_sk, no_fail_pre, no_fail_post)
 {
     struct c0_kvmultiset *kvms = 0;
@@ -390,7 +446,7 @@ MTF_DEFINE_UTEST_PREPOST(c0_kvmultiset_test, ingest_work_create_fail, no_fail_pr
     struct c0_ingest_work ingest;
     merr_t                err;
 
-    /* c0_ingest_work_init() calls bin_heap2_create(), so make
+    /* c0_ingest_work_init() calls loser_tree_create(), so make
      * that allocation fail...
      */
     mapi_inject_once_ptr(mapi_idx_malloc, 1, 0);
@@ -19,10 +19,15 @@
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/c0_kvset.h>
 #include <hse_ikvdb/c0_kvset_iterator.h>
+#include <hse_ikvdb/rtomb.h>
+#include <hse_ikvdb/query_ctx.h>
+
+#include "../c0_kvsetm.h"
 
 #include <assert.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <pthread.h>
 
 int
 test_collection_setup(struct mtf_test_info *info)
@@ -1021,4 +1026,304 @@ MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, iterator, no_fail_pre, no_fail_post)
     c0kvs_destroy(kvs);
 }
 
+struct put_scaling_arg {
+    struct c0_kvset *  kvs;
+    pthread_barrier_t *barrier;
+    bool               insert;
+    u64                first;
+    u32                nkeys;
+    u32                nputs;
+    merr_t             err;
+    u64                ns;
+};
+
+static void *
+put_scaling_main(void *rock)
+{
+    struct put_scaling_arg *arg = rock;
+    struct kvs_ktuple       kt;
+    struct kvs_vtuple       vt;
+    u64                     key, val, rnd;
+    u32                     i;
+
+    rnd = arg->first + 1;
+    kvs_vtuple_init(&vt, &val, sizeof(val));
+
+    pthread_barrier_wait(arg->barrier);
+    arg->ns = get_time_ns();
+
+    for (i = 0; i < arg->nputs && !arg->err; ++i) {
+        if (arg->insert) {
+            key = arg->first + i;
+        } else {
+            rnd = rnd * 6364136223846793005ul + 1442695040888963407ul;
+            key = (rnd >> 33) % arg->nkeys;
+        }
+
+        val = i;
+        kvs_ktuple_init(&kt, &key, sizeof(key));
+
+        arg->err = c0kvs_put(arg->kvs, 0, &kt, &vt, HSE_ORDNL_TO_SQNREF(1));
+    }
+
+    arg->ns = get_time_ns() - arg->ns;
+
+    return NULL;
+}
+
+/* Measure put throughput into a single c0kvset versus the number of
+ * writer threads, both for updates of existing keys (which need only
+ * the per-key lock) and for inserts of new keys (which serialize on
+ * the c0kvs lock).
+ */
+MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, put_scaling, no_fail_pre, no_fail_post)
+{
+    const u32              nkeys = 64 * 1024;
+    const u32              nputs = 128 * 1024;
+    struct put_scaling_arg argv[64];
+    pthread_t              tidv[64];
+    pthread_barrier_t      barrier;
+    struct c0_kvset *      kvs;
+    struct kvs_ktuple      kt;
+    struct kvs_vtuple      vt;
+    u64                    key, num_entries, num_tombs, kbytes, vbytes, ns;
+    u32                    nthreads, maxthreads, i;
+    merr_t                 err;
+    int                    mode, rc;
+
+    maxthreads = clamp_t(long, sysconf(_SC_NPROCESSORS_ONLN) * 2, 2, NELEM(argv));
+
+    for (mode = 0; mode < 2; ++mode) {
+        for (nthreads = 1; nthreads <= maxthreads; nthreads *= 2) {
+            err = c0kvs_create(HSE_C0_CHEAP_SZ_MAX, 0, 0, false, &kvs);
+            ASSERT_EQ(0, err);
+
+            kvs_vtuple_init(&vt, &key, sizeof(key));
+
+            for (key = 0; key < nkeys; ++key) {
+                kvs_ktuple_init(&kt, &key, sizeof(key));
+
+                err = c0kvs_put(kvs, 0, &kt, &vt, HSE_ORDNL_TO_SQNREF(1));
+                ASSERT_EQ(0, err);
+            }
+
+            rc = pthread_barrier_init(&barrier, NULL, nthreads);
+            ASSERT_EQ(0, rc);
+
+            for (i = 0; i < nthreads; ++i) {
+                argv[i].kvs = kvs;
+                argv[i].barrier = &barrier;
+                argv[i].insert = (mode == 1);
+                argv[i].first = nkeys + (u64)i * nputs;
+                argv[i].nkeys = nkeys;
+                argv[i].nputs = nputs / nthreads;
+                argv[i].err = 0;
+
+                rc = pthread_create(tidv + i, NULL, put_scaling_main, argv + i);
+                ASSERT_EQ(0, rc);
+            }
+
+            for (i = ns = 0; i < nthreads; ++i) {
+                rc = pthread_join(tidv[i], NULL);
+                ASSERT_EQ(0, rc);
+                ASSERT_EQ(0, argv[i].err);
+
+                ns = max_t(u64, ns, argv[i].ns);
+            }
+
+            pthread_barrier_destroy(&barrier);
+
+            c0kvs_get_content_metrics(kvs, &num_entries, &num_tombs, &kbytes, &vbytes);
+            ASSERT_EQ(0, num_tombs);
+            ASSERT_EQ(nkeys + (mode ? (nputs / nthreads) * nthreads : 0), num_entries);
+            ASSERT_EQ(num_entries * sizeof(key), kbytes);
+            ASSERT_EQ(num_entries * sizeof(key), vbytes);
+
+            for (key = 0; key < nkeys; ++key) {
+                enum key_lookup_res res;
+                struct kvs_buf      vb;
+                uintptr_t           oseqnoref;
+                u64                 val;
+
+                kvs_ktuple_init(&kt, &key, sizeof(key));
+                kvs_buf_init(&vb, &val, sizeof(val));
+
+                err = c0kvs_get_excl(kvs, 0, &kt, 1, 0, &res, &vb, &oseqnoref);
+                ASSERT_EQ(0, err);
+                ASSERT_EQ(FOUND_VAL, res);
+            }
+
+            hse_log(HSE_NOTICE "%s: %s, %2u threads: %6lu puts/ms",
+                    __func__, mode ? "insert" : "update", nthreads,
+                    ((nputs / nthreads) * nthreads * 1000000ul) / max_t(u64, ns, 1));
+
+            synchronize_rcu();
+            rcu_barrier();
+
+            c0kvs_destroy(kvs);
+        }
+    }
+}
+
+MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, rtomb_mutation, no_fail_pre, no_fail_post)
+{
+    struct c0kvsm_info *info;
+    struct c0_kvsetm *  ckm;
+    struct c0_kvset *   kvs;
+    struct kvs_ktuple   kt, start, end;
+    struct kvs_vtuple   vt;
+    struct rtomb *      rt;
+    merr_t              err;
+    u8                  mindex;
+
+    err = c0kvs_create(HSE_C0_CHEAP_SZ_DFLT, 0, 0, true, &kvs);
+    ASSERT_EQ(0, err);
+
+    kvs_ktuple_init(&kt, "a", 1);
+    kvs_vtuple_init(&vt, "val", 3);
+    err = c0kvs_put(kvs, 0, &kt, &vt, HSE_ORDNL_TO_SQNREF(5));
+    ASSERT_EQ(0, err);
+
+    kvs_ktuple_init(&start, "b", 1);
+    kvs_ktuple_init(&end, "dd", 2);
+    err = c0kvs_range_del(kvs, 0, &start, &end, HSE_ORDNL_TO_SQNREF(6));
+    ASSERT_EQ(0, err);
+
+    rcu_read_lock();
+    rt = c0kvs_rtombs(kvs);
+    rcu_read_unlock();
+    ASSERT_NE(NULL, rt);
+
+    /* The rtomb is on the non-tx mutation list and counts as one key.
+     */
+    mindex = c0kvsm_get_mindex(kvs);
+    ckm = c0kvsm_get(kvs, mindex);
+    ASSERT_EQ(rt, ckm->c0m_rtombs);
+    ASSERT_EQ(NULL, rt->rt_mnext);
+    ASSERT_EQ(2, c0kvsm_get_kcnt(kvs, mindex, C0KVSM_TYPE_NONTX));
+    ASSERT_EQ(5, ckm->c0m_minseqno);
+    ASSERT_EQ(6, ckm->c0m_maxseqno);
+    ASSERT_EQ(2, ckm->c0m_ksize);
+    ASSERT_EQ(5, ckm->c0m_vsize);
+
+    c0kvsm_switch(kvs);
+
+    info = calloc(1, sizeof(*info) + sizeof(info->c0s_bkvs[0]) + sizeof(u32));
+    ASSERT_NE(NULL, info);
+
+    c0kvsm_info_init(info, 1, 1, false);
+    err = c0kvsm_info_set(info, 5, 6, c0kvsm_get_kcnt(kvs, mindex, C0KVSM_TYPE_NONTX), 0);
+    ASSERT_EQ(0, err);
+
+    c0kvsm_copy_bkv(kvs, info, mindex, false, 0);
+
+    /* Only the put is a bonsai_kv, the rtomb is handed over separately.
+     */
+    ASSERT_EQ(1, info->c0s_kcnt);
+    ASSERT_EQ(1, info->c0s_nbkv[0]);
+    ASSERT_EQ(rt, info->c0s_rtombs);
+    ASSERT_FALSE(c0kvsm_has_kvmut(kvs, mindex, C0KVSM_TYPE_NONTX));
+    ASSERT_EQ(NULL, c0kvsm_get(kvs, mindex)->c0m_rtombs);
+
+    free(info->c0s_bkvs[0]);
+    free(info);
+
+    synchronize_rcu();
+    rcu_barrier();
+
+    c0kvs_destroy(kvs);
+}
+
+MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, rtomb_pfx_probe, no_fail_pre, no_fail_post)
+{
+    struct c0_kvset *   kvs;
+    struct kvs_ktuple   kt, start, end;
+    struct kvs_vtuple   vt;
+    struct query_ctx    qctx;
+    struct kvs_buf      kbuf, vbuf;
+    enum key_lookup_res res;
+    char                kdata[8], vdata[8];
+    const char *        keyv[] = { "ab01", "ab02", "ab03" };
+    merr_t              err;
+    int                 i, pass;
+
+    err = qctx_te_mem_init();
+    ASSERT_EQ(0, err);
+
+    err = c0kvs_create(HSE_C0_CHEAP_SZ_DFLT, 0, 0, false, &kvs);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < NELEM(keyv); ++i) {
+        kvs_ktuple_init(&kt, keyv[i], 4);
+        kvs_vtuple_init(&vt, "val", 3);
+        err = c0kvs_put(kvs, 0, &kt, &vt, HSE_ORDNL_TO_SQNREF(i + 1));
+        ASSERT_EQ(0, err);
+    }
+
+    kvs_ktuple_init(&start, "ab01", 4);
+    kvs_ktuple_init(&end, "ab03", 4);
+    err = c0kvs_range_del(kvs, 0, &start, &end, HSE_ORDNL_TO_SQNREF(4));
+    ASSERT_EQ(0, err);
+
+    /* Pass 0 probes without the rtombs and sees all three keys, pass 1
+     * remembers them first and sees only the key past the range.
+     */
+    for (pass = 0; pass < 2; ++pass) {
+        memset(&qctx, 0, sizeof(qctx));
+        qctx.qtype = QUERY_PROBE_PFX;
+        for (i = 0; i < TT_WIDTH; i++)
+            qctx.tomb_tree[i] = RB_ROOT;
+
+        kvs_ktuple_init(&kt, "ab", 2);
+        kvs_buf_init(&kbuf, kdata, sizeof(kdata));
+        kvs_buf_init(&vbuf, vdata, sizeof(vdata));
+
+        rcu_read_lock();
+        if (pass > 0) {
+            err = qctx_rtombs_add(&qctx, c0kvs_rtombs(kvs), 0, kt.kt_data, kt.kt_len, 10);
+            ASSERT_EQ(0, err);
+            ASSERT_NE(NULL, qctx.rtombs);
+        }
+
+        err = c0kvs_pfx_probe_rcu(kvs, 0, &kt, 2, 10, 0, &res, &qctx, &kbuf, &vbuf, 0);
+        rcu_read_unlock();
+        ASSERT_EQ(0, err);
+
+        if (pass == 0) {
+            ASSERT_EQ(3, qctx.seen);
+        } else {
+            ASSERT_EQ(1, qctx.seen);
+            ASSERT_EQ(4, kbuf.b_len);
+            ASSERT_EQ(0, memcmp(kdata, "ab03", 4));
+            ASSERT_EQ(4, qctx_rtomb_seq(&qctx, "ab02", 4));
+            ASSERT_EQ(0, qctx_rtomb_seq(&qctx, "ab03", 4));
+        }
+
+        qctx_te_mem_reset();
+    }
+
+    /* Only rtombs that may hide a key with the prefix are remembered. */
+    rcu_read_lock();
+    for (i = 0; i < 4; ++i) {
+        const char *pfxv[] = { "ab00", "ab02", "ab03", "a" };
+
+        memset(&qctx, 0, sizeof(qctx));
+        err = qctx_rtombs_add(&qctx, c0kvs_rtombs(kvs), 0, pfxv[i], strlen(pfxv[i]), 10);
+        ASSERT_EQ(0, err);
+
+        if (i == 1 || i == 3)
+            ASSERT_NE(NULL, qctx.rtombs);
+        else
+            ASSERT_EQ(NULL, qctx.rtombs);
+
+        qctx_te_mem_reset();
+    }
+    rcu_read_unlock();
+
+    synchronize_rcu();
+    rcu_barrier();
+
+    c0kvs_destroy(kvs);
+}
+
 MTF_END_UTEST_COLLECTION(c0_kvset_test)
@@ -101,6 +101,7 @@ mocks_set(struct mtf_test_info *info)
     mapi_inject(mapi_idx_kvset_builder_add_key, 0);
     mapi_inject(mapi_idx_kvset_builder_add_val, 0);
     mapi_inject(mapi_idx_kvset_builder_add_nonval, 0);
+    mapi_inject(mapi_idx_kvset_builder_add_rtomb, 0);
     mapi_inject(mapi_idx_kvset_builder_add_vref, 0);
     mapi_inject(mapi_idx_kvset_builder_destroy, 0);
     mapi_inject(mapi_idx_kvset_mblocks_destroy, 0);
@@ -412,6 +413,78 @@ MTF_DEFINE_UTEST_PREPOST(c0sk_test, t_sync, no_fail_pre, no_fail_post)
     destroy_mock_cn(mock_cn);
 }
 
+MTF_DEFINE_UTEST_PREPOST(c0sk_test, ingest_kvs_parallel, no_fail_pre, no_fail_post)
+{
+    struct kvdb_rparams   kvdb_rp;
+    struct kvs_rparams    kvs_rp;
+    struct c0_kvmultiset *kvms;
+    struct kvs_ktuple     kt;
+    struct kvs_vtuple     vt;
+    merr_t                err;
+    struct mock_kvdb      mkvdb;
+    struct cn *           mock_cnv[5];
+    struct c0sk_impl *    self;
+    atomic64_t            seqno;
+    u16                   skidxv[5];
+    char                  kbuf[32];
+    int                   i, j;
+
+    kvdb_rp = kvdb_rparams_defaults();
+    kvs_rp = kvs_rparams_defaults();
+
+    kvdb_rp.c0_ingest_width = 2;
+    kvdb_rp.c0_ingest_kvs_threads = 3;
+
+    atomic64_set(&seqno, 0);
+    err = c0sk_open(&kvdb_rp, 0, "mock_mp", &mock_health, csched, &seqno, &mkvdb.ikdb_c0sk);
+    ASSERT_EQ(0, err);
+
+    self = c0sk_h2r(mkvdb.ikdb_c0sk);
+    ASSERT_NE(NULL, self->c0sk_wq_ingest_kvs);
+
+    for (i = 0; i < NELEM(mock_cnv); ++i) {
+        err = create_mock_cn(&mock_cnv[i], false, false, &kvs_rp, 0);
+        ASSERT_EQ(0, err);
+
+        err = c0sk_c0_register(mkvdb.ikdb_c0sk, mock_cnv[i], &skidxv[i]);
+        ASSERT_EQ(0, err);
+    }
+
+    err = c0kvms_create(1, 0, 0, &seqno, false, &kvms);
+    ASSERT_EQ(0, err);
+
+    err = c0sk_install_c0kvms(self, NULL, kvms);
+    ASSERT_EQ(0, err);
+
+    /* Leave the last kvs empty, it must not get a kvset.
+     */
+    for (i = 0; i < NELEM(mock_cnv) - 1; ++i) {
+        for (j = 0; j < 100; ++j) {
+            snprintf(kbuf, sizeof(kbuf), "key.%d.%03d", i, j);
+            kvs_ktuple_init(&kt, kbuf, strlen(kbuf));
+            kvs_vtuple_init(&vt, kbuf, strlen(kbuf));
+
+            err = c0sk_put(mkvdb.ikdb_c0sk, skidxv[i], &kt, &vt, HSE_SQNREF_SINGLE);
+            ASSERT_EQ(0, err);
+        }
+    }
+
+    mapi_calls_clear(mapi_idx_kvset_builder_get_mblocks);
+
+    err = c0sk_sync(mkvdb.ikdb_c0sk);
+    ASSERT_EQ(0, err);
+
+    ASSERT_EQ(NELEM(mock_cnv) - 1, mapi_calls(mapi_idx_kvset_builder_get_mblocks));
+
+    c0kvms_putref(kvms);
+
+    err = c0sk_close(mkvdb.ikdb_c0sk);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < NELEM(mock_cnv); ++i)
+        destroy_mock_cn(mock_cnv[i]);
+}
+
 MTF_DEFINE_UTEST_PREPOST(c0sk_test, various, no_fail_pre, no_fail_post)
 {
     struct kvdb_rparams kvdb_rp;
@@ -1467,6 +1540,102 @@ MTF_DEFINE_UTEST_PREPOST(c0sk_test, c0sk_get_test, no_fail_pre, no_fail_post)
     destroy_mock_cn(mock_cn);
 }
 
+MTF_DEFINE_UTEST_PREPOST(c0sk_test, c0sk_range_del_test, no_fail_pre, no_fail_post)
+{
+    struct kvdb_rparams   kvdb_rp;
+    struct kvs_rparams    kvs_rp;
+    struct c0_kvmultiset *kvms = 0;
+    merr_t                err;
+    struct kvs_ktuple     kt = { 0 }, start, end;
+    struct kvs_vtuple     vt = { 0 };
+    char                  buf[100];
+    struct kvs_buf        vbuf;
+    enum key_lookup_res   res;
+    struct mock_kvdb      mkvdb;
+    struct cn *           mock_cn;
+    struct c0sk_impl *    self;
+    atomic64_t            seqno;
+    u64                   view;
+    u16                   skidx = 0;
+    const u32             pfx_len = 0;
+    int                   i;
+
+    const char *keyv[] = { "a1", "b", "b1", "b2", "c", "c1" };
+    const bool  delv[] = { false, true, true, true, false, false };
+
+    kvdb_rp = kvdb_rparams_defaults();
+    kvs_rp = kvs_rparams_defaults();
+
+    atomic64_set(&seqno, 0);
+    err = c0sk_open(&kvdb_rp, 0, "mock_mp", &mock_health, csched, &seqno, &mkvdb.ikdb_c0sk);
+    ASSERT_EQ(0, err);
+
+    err = create_mock_cn(&mock_cn, false, false, &kvs_rp, pfx_len);
+    ASSERT_EQ(0, err);
+
+    err = c0sk_c0_register(mkvdb.ikdb_c0sk, mock_cn, &skidx);
+    ASSERT_EQ(0, err);
+
+    self = c0sk_h2r(mkvdb.ikdb_c0sk);
+
+    err = c0kvms_create(1, 0, 0, &seqno, false, &kvms);
+    ASSERT_EQ(0, err);
+
+    err = c0sk_install_c0kvms(self, NULL, kvms);
+    ASSERT_EQ(0, err);
+
+    kvs_vtuple_init(&vt, "value", 5);
+
+    for (i = 0; i < NELEM(keyv); ++i) {
+        kvs_ktuple_init(&kt, keyv[i], strlen(keyv[i]));
+        err = c0sk_put(mkvdb.ikdb_c0sk, skidx, &kt, &vt, HSE_SQNREF_SINGLE);
+        ASSERT_EQ(0, err);
+    }
+
+    view = atomic64_read(&seqno);
+
+    /* Delete [b, c), which must not affect "a1" nor "c".
+     */
+    kvs_ktuple_init(&start, "b", 1);
+    kvs_ktuple_init(&end, "c", 1);
+    err = c0sk_range_del(mkvdb.ikdb_c0sk, skidx, &start, &end, HSE_SQNREF_SINGLE);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < NELEM(keyv); ++i) {
+        kvs_ktuple_init(&kt, keyv[i], strlen(keyv[i]));
+
+        kvs_buf_init(&vbuf, buf, sizeof(buf));
+        err = c0sk_get(mkvdb.ikdb_c0sk, skidx, pfx_len, &kt, atomic64_read(&seqno), 0, &res, &vbuf);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(delv[i] ? FOUND_TMB : FOUND_VAL, res);
+
+        /* The range delete is not visible to an older view.
+         */
+        kvs_buf_init(&vbuf, buf, sizeof(buf));
+        err = c0sk_get(mkvdb.ikdb_c0sk, skidx, pfx_len, &kt, view, 0, &res, &vbuf);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(FOUND_VAL, res);
+    }
+
+    /* A newer put is not hidden by the range delete.
+     */
+    kvs_ktuple_init(&kt, "b1", 2);
+    err = c0sk_put(mkvdb.ikdb_c0sk, skidx, &kt, &vt, HSE_SQNREF_SINGLE);
+    ASSERT_EQ(0, err);
+
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
+    err = c0sk_get(mkvdb.ikdb_c0sk, skidx, pfx_len, &kt, atomic64_read(&seqno), 0, &res, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_VAL, res);
+
+    c0kvms_putref(kvms);
+
+    err = c0sk_close(mkvdb.ikdb_c0sk);
+    ASSERT_EQ(0, err);
+
+    destroy_mock_cn(mock_cn);
+}
+
 static struct c0_kvmultiset *deferred_release[HSE_C0_KVSET_CURSOR_MAX + 2];
 
 static void
@@ -69,6 +69,7 @@ MTF_BEGIN_UTEST_COLLECTION_PREPOST(c0skm_test, test_collection_setup, test_colle
 MTF_DEFINE_UTEST_PREPOST(c0skm_test, misc, test_pre, test_post)
 {
     c0skm_sync(NULL);
+    c0skm_sync_op(NULL);
     c0skm_flush(NULL);
     c0skm_get_cnid(NULL, 1);
 }
@@ -280,12 +280,14 @@ c1_vtuple_init(
     u64                      xlen,
     u64                      seqno,
     void *                   data,
-    bool                     tomb)
+    u32                      vtype,
+    u32                      expiry)
 {
     cvt->c1vt_xlen = xlen;
     cvt->c1vt_seqno = seqno;
     cvt->c1vt_data = data;
-    cvt->c1vt_tomb = tomb;
+    cvt->c1vt_vtype = vtype;
+    cvt->c1vt_expiry = expiry;
 }
 
 void
@@ -485,7 +485,9 @@ c1_log_issue_kvb(
             omf_set_c1vt_sign(&vt[j], C1_VAL_MAGIC);
             omf_set_c1vt_seqno(&vt[j], nextvt->c1vt_seqno);
             omf_set_c1vt_xlen(&vt[j], nextvt->c1vt_xlen);
-            omf_set_c1vt_tomb(&vt[j], nextvt->c1vt_tomb ? 1 : 0);
+            omf_set_c1vt_tomb(&vt[j], nextvt->c1vt_vtype);
+            omf_set_c1vt_expiry(&vt[j], nextvt->c1vt_expiry);
+            vt[j].c1vt_filler = 0;
 
             assert(i < numiov);
 
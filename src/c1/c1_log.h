@@ -78,7 +78,8 @@ struct c1_vtuple {
     u64                      c1vt_xlen;
     u64                      c1vt_seqno;
     void *                   c1vt_data;
-    bool                     c1vt_tomb;
+    u32                      c1vt_vtype;
+    u32                      c1vt_expiry;
 };
 
 struct c1_vtuple_array {
@@ -110,7 +111,7 @@ struct c1_kvbundle {
 static __always_inline uint
 c1_vtuple_vlen(const struct c1_vtuple *vt)
 {
-    uint clen = vt->c1vt_xlen >> 32;
+    uint clen = (vt->c1vt_xlen >> 32) & 0xfffffful;
     uint vlen = vt->c1vt_xlen & 0xfffffffful;
 
     return clen ?: vlen;
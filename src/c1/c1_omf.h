@@ -21,7 +21,8 @@ enum {
     C1_INITIAL_SEQNO = 1,
     C1_VERSION1 = 1,
     C1_VERSION2 = 2,
-    C1_VERSION = C1_VERSION2,
+    C1_VERSION3 = 3,
+    C1_VERSION = C1_VERSION3,
     C1_TYPE_BASE = 10,
     C1_TYPE_VERSION = C1_TYPE_BASE,
     C1_TYPE_INFO = 11,
@@ -182,7 +183,23 @@ _Static_assert(
     sizeof(struct c1_treetxn_omf) == sizeof(struct c1_kvbundle_omf),
     "c1_treetxn_omf and c1_kvbundle_omf size mismatch");
 
+/*
+ * c1vt_tomb holds an enum c1_vtype.  c1vt_expiry is the value's expiry
+ * time (see kvs_expired()), zero if none.
+ */
 struct c1_vtuple_omf {
+    __le64 c1vt_sign;
+    __le64 c1vt_seqno;
+    __le64 c1vt_xlen;
+    __le32 c1vt_tomb;
+    __le32 c1vt_logtype;
+    __le32 c1vt_expiry;
+    __le32 c1vt_filler;
+    u8     c1vt_data[0];
+} __packed;
+
+/* Value record of c1 versions 1 and 2, which had no expiry. */
+struct c1_vtuple_omf_v2 {
     __le64 c1vt_sign;
     __le64 c1vt_seqno;
     __le64 c1vt_xlen;
@@ -266,6 +283,13 @@ OMF_SETGET(struct c1_vtuple_omf, c1vt_seqno, 64)
 OMF_SETGET(struct c1_vtuple_omf, c1vt_xlen, 64)
 OMF_SETGET(struct c1_vtuple_omf, c1vt_tomb, 32)
 OMF_SETGET(struct c1_vtuple_omf, c1vt_logtype, 32)
+OMF_SETGET(struct c1_vtuple_omf, c1vt_expiry, 32)
+
+OMF_GET_VER(struct c1_vtuple_omf_v2, c1vt_sign, 64, v2);
+OMF_GET_VER(struct c1_vtuple_omf_v2, c1vt_seqno, 64, v2);
+OMF_GET_VER(struct c1_vtuple_omf_v2, c1vt_xlen, 64, v2);
+OMF_GET_VER(struct c1_vtuple_omf_v2, c1vt_tomb, 32, v2);
+OMF_GET_VER(struct c1_vtuple_omf_v2, c1vt_logtype, 32, v2);
 
 OMF_SETGET(struct c1_mblk_omf, c1mblk_id, 64)
 OMF_SETGET(struct c1_mblk_omf, c1mblk_off, 32)
@@ -173,6 +173,9 @@ omf_c1_treetxn_unpack(char *omf, union c1_record *rec, u32 *omf_len);
 merr_t
 omf_c1_vtuple_unpack(char *omf, union c1_record *rec, u32 *omf_len);
 
+merr_t
+omf_c1_vtuple_unpack_v2(char *omf, union c1_record *rec, u32 *omf_len);
+
 /* C1_TYPE_MBLK */
 merr_t
 omf_c1_mblk_unpack(char *omf, union c1_record *rec, u32 *omf_len);
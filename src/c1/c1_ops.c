@@ -99,6 +99,7 @@ c1_create(const char *mpname)
 
     memset(c1, 0, sizeof(*c1));
     c1->c1_replay_hdl = NULL;
+    c1->c1_replay_wq = NULL;
     c1->c1_jrnl = NULL;
     c1->c1_io = NULL;
     c1->c1_ikvdb = NULL;
@@ -501,9 +502,18 @@ c1_replay_on_ikvdb(
     u64                seqno,
     struct kvs_ktuple *kt,
     struct kvs_vtuple *vt,
-    bool               tomb)
+    u32                vtype)
 {
-    if (tomb) {
+    if (vtype == C1_VTYPE_RTOMB) {
+        struct kvs_ktuple end;
+
+        kvs_ktuple_init(&end, vt->vt_data, kvs_vtuple_vlen(vt));
+
+        perfc_inc(&c1->c1_pcset_kv, PERFC_BA_C1_DELR);
+        return ikvdb_c1_replay_range_del(ikvdb, c1->c1_replay_hdl, seqno, cnid, NULL, kt, &end);
+    }
+
+    if (vtype == C1_VTYPE_TOMB) {
         perfc_inc(&c1->c1_pcset_kv, PERFC_BA_C1_DELR);
         return ikvdb_c1_replay_del(ikvdb, c1->c1_replay_hdl, seqno, cnid, NULL, kt, vt);
     }
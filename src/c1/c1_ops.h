@@ -37,6 +37,7 @@ struct c1 {
     struct c1_journal      *c1_jrnl;
     struct ikvdb           *c1_ikvdb;
     struct ikvdb_c1_replay *c1_replay_hdl;
+    struct workqueue_struct*c1_replay_wq;
     struct c1_kvcache       c1_kvc[HSE_C1_DEFAULT_STRIPE_WIDTH];
 
     /* Perf counters */
@@ -113,7 +114,7 @@ c1_replay_on_ikvdb(
     u64                seqno,
     struct kvs_ktuple *kt,
     struct kvs_vtuple *vt,
-    bool               tomb);
+    u32                vtype);
 
 /* MTF_MOCK */
 bool
@@ -97,6 +97,7 @@
 #define HSE_C1_TREE_CNT_LB 0
 #define HSE_C1_TREE_CNT_UB 16
 #define HSE_C1_DEFAULT_THREAD_CNT HSE_C1_DEFAULT_STRIPE_WIDTH
+#define HSE_C1_REPLAY_THREAD_CNT HSE_C1_DEFAULT_STRIPE_WIDTH
 #define HSE_C1_DEFAULT_STRIP_SIZE (32 * 1024)
 #define HSE_C1_MIN_DTIME 50          /* 50 ms */
 #define HSE_C1_DEFAULT_DTIME 500     /* 500 ms */
@@ -3,6 +3,8 @@
  * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
  */
 
+#include <hse_util/workqueue.h>
+
 #include <hse_ikvdb/cndb.h>
 
 #include "c1_omf_internal.h"
@@ -142,51 +144,152 @@ c1_tree_replay_merge(
     } while (cur);
 }
 
-merr_t
-c1_tree_replay_process_txn(struct c1 *c1, struct c1_tree *tree)
+/**
+ * struct c1_tree_replay_work - replay of one log of a c1 tree
+ * @rw_work:   work struct for the replay workqueue
+ * @rw_c1:     c1 handle
+ * @rw_log:    log to open and replay
+ * @rw_type:   C1_REPLAY_METADATA or C1_REPLAY_DATA
+ * @rw_opened: true if @rw_log was successfully opened for replay
+ * @rw_err:    replay status
+ */
+struct c1_tree_replay_work {
+    struct work_struct rw_work;
+    struct c1 *        rw_c1;
+    struct c1_log *    rw_log;
+    int                rw_type;
+    bool               rw_opened;
+    merr_t             rw_err;
+};
+
+static void
+c1_tree_replay_log(struct work_struct *work)
 {
-    struct list_head **src;
-    merr_t             err;
-    int                numlogs;
-    int                i, j;
-    bool               final;
+    struct c1_tree_replay_work *rw;
+    struct c1 *                 c1;
+    merr_t                      err;
+
+    rw = container_of(work, struct c1_tree_replay_work, rw_work);
+    c1 = rw->rw_c1;
+
+    err = c1_log_replay_open(rw->rw_log, rw->rw_type, c1->c1_version);
+    if (ev(err)) {
+        rw->rw_err = err;
+        return;
+    }
+
+    rw->rw_opened = true;
+
+    err = c1_log_replay(rw->rw_log, c1_cningestid(c1), c1->c1_version);
+    if (err && merr_errno(err) == ENOENT)
+        err = 0;
+
+    rw->rw_err = ev(err);
+}
 
-    final = true;
+/*
+ * Open and read all the logs of the given tree.  Each log is read
+ * independently of the others into its own txn/kvb list, so when a
+ * replay workqueue is available the logs are read concurrently.
+ * The per-log lists are subsequently merged in txnid (or mutation)
+ * order by the caller, hence the order in which the logs are read
+ * has no bearing on the order in which their contents are replayed.
+ */
+static merr_t
+c1_tree_replay_logs(struct c1 *c1, struct c1_tree *tree, int type, struct list_head **src)
+{
+    struct c1_tree_replay_work *workv;
+    merr_t                      err;
+    int                         numlogs;
+    int                         i;
 
     numlogs = tree->c1t_stripe_width;
     assert(numlogs > 0);
 
-    src = malloc_array(numlogs, sizeof(*src));
-    if (!src)
+    workv = malloc_array(numlogs, sizeof(*workv));
+    if (!workv)
         return merr(ev(ENOMEM));
 
+    for (i = 0; i < numlogs; i++) {
+        struct c1_tree_replay_work *rw = workv + i;
+
+        INIT_WORK(&rw->rw_work, c1_tree_replay_log);
+        rw->rw_c1 = c1;
+        rw->rw_log = tree->c1t_log[i];
+        rw->rw_type = type;
+        rw->rw_opened = false;
+        rw->rw_err = 0;
+
+        if (c1->c1_replay_wq && numlogs > 1)
+            queue_work(c1->c1_replay_wq, &rw->rw_work);
+        else
+            c1_tree_replay_log(&rw->rw_work);
+    }
+
+    if (c1->c1_replay_wq && numlogs > 1)
+        flush_workqueue(c1->c1_replay_wq);
+
     err = 0;
 
     for (i = 0; i < numlogs; i++) {
-        err = c1_log_replay_open(tree->c1t_log[i], C1_REPLAY_METADATA, c1->c1_version);
-        if (ev(err))
-            goto err_exit;
+        if (workv[i].rw_err && !err)
+            err = workv[i].rw_err;
+
+        if (type == C1_REPLAY_METADATA)
+            src[i] = &tree->c1t_log[i]->c1l_txn_list;
+        else
+            src[i] = &tree->c1t_log[i]->c1l_kvb_list;
     }
 
-    for (j = 0; j < numlogs; j++) {
-        err = c1_log_replay(tree->c1t_log[j], c1_cningestid(c1), c1->c1_version);
-        if (ev(err))
-            if (ev(merr_errno(err) != ENOENT))
-                goto err_exit;
-        src[j] = &tree->c1t_log[j]->c1l_txn_list;
+    /* On success the caller closes the logs once their lists
+     * have been merged.  On failure close (and destroy) every
+     * log that was opened here.
+     */
+    if (err) {
+        for (i = 0; i < numlogs; i++)
+            if (workv[i].rw_opened)
+                c1_log_replay_close(tree->c1t_log[i], true);
     }
 
-    err = 0;
+    free(workv);
+
+    return err;
+}
+
+static void
+c1_tree_replay_close_logs(struct c1_tree *tree)
+{
+    int i;
+
+    for (i = 0; i < tree->c1t_stripe_width; i++)
+        c1_log_replay_close(tree->c1t_log[i], false);
+}
+
+merr_t
+c1_tree_replay_process_txn(struct c1 *c1, struct c1_tree *tree)
+{
+    struct list_head **src;
+    merr_t             err;
+    int                numlogs;
+
+    numlogs = tree->c1t_stripe_width;
+    assert(numlogs > 0);
+
+    src = malloc_array(numlogs, sizeof(*src));
+    if (!src)
+        return merr(ev(ENOMEM));
+
+    err = c1_tree_replay_logs(c1, tree, C1_REPLAY_METADATA, src);
+    if (ev(err))
+        goto err_exit;
 
     c1_tree_replay_merge(
         src, &tree->c1t_txn_list, numlogs, c1_tree_txn_next, c1_tree_txn_cmp, c1_tree_merge_txn);
 
-    final = false;
+    c1_tree_replay_close_logs(tree);
 
 err_exit:
     free(src);
-    while (--i >= 0)
-        c1_log_replay_close(tree->c1t_log[i], final);
 
     return err;
 }
@@ -197,10 +300,6 @@ c1_tree_replay_process_kvb(struct c1 *c1, struct c1_tree *tree)
     struct list_head **src;
     merr_t             err;
     int                numlogs;
-    int                i, j;
-    bool               final;
-
-    final = true;
 
     numlogs = tree->c1t_stripe_width;
     assert(numlogs > 0);
@@ -209,32 +308,17 @@ c1_tree_replay_process_kvb(struct c1 *c1, struct c1_tree *tree)
     if (!src)
         return merr(ev(ENOMEM));
 
-    err = 0;
-
-    for (i = 0; i < numlogs; i++) {
-        err = c1_log_replay_open(tree->c1t_log[i], C1_REPLAY_DATA, c1->c1_version);
-        if (ev(err))
-            goto err_exit;
-    }
-
-    for (j = 0; j < numlogs; j++) {
-        err = c1_log_replay(tree->c1t_log[j], c1_cningestid(c1), c1->c1_version);
-        if (ev(err))
-            if (merr_errno(err) != ENOENT)
-                goto err_exit;
-        err = 0;
-        src[j] = &tree->c1t_log[j]->c1l_kvb_list;
-    }
+    err = c1_tree_replay_logs(c1, tree, C1_REPLAY_DATA, src);
+    if (ev(err))
+        goto err_exit;
 
     c1_tree_replay_merge(
         src, &tree->c1t_kvb_list, numlogs, c1_tree_kvb_next, c1_tree_kvb_cmp, c1_tree_merge_kvb);
 
-    final = false;
+    c1_tree_replay_close_logs(tree);
 
 err_exit:
     free(src);
-    while (--i >= 0)
-        c1_log_replay_close(tree->c1t_log[i], final);
 
     return err;
 }
@@ -266,7 +350,7 @@ c1_tree_replay_exec(
     u64                seqno,
     struct kvs_ktuple *kt,
     struct kvs_vtuple *vt,
-    bool               tomb)
+    u32                vtype)
 {
     struct ikvdb *ikvdb;
 
@@ -279,7 +363,7 @@ c1_tree_replay_exec(
 
     ikvdb = c1_ikvdb(c1);
 
-    return c1_replay_on_ikvdb(c1, ikvdb, cnid, seqno, kt, vt, tomb);
+    return c1_replay_on_ikvdb(c1, ikvdb, cnid, seqno, kt, vt, vtype);
 }
 
 #ifdef HSE_BUILD_DEBUG
@@ -367,7 +451,7 @@ c1_tree_replay_nextkey(
     void *                 value;
     void *                 vdata;
     merr_t                 err;
-    bool                   tomb;
+    u32                    vtype;
     u32                    len;
 
     kvtomf = *nextkey;
@@ -437,13 +521,15 @@ c1_tree_replay_nextkey(
         vdata = vtm.c1vm_data;
         vlen = vtm.c1vm_xlen;
 
-        tomb = (vtm.c1vm_tomb == 1) ? true : false;
-        if (tomb)
+        /* The value of a range tombstone is its end key. */
+        vtype = vtm.c1vm_tomb;
+        if (vtype == C1_VTYPE_TOMB)
             vlen = 0;
 
         kvs_vtuple_init(&vt, vdata, vlen);
+        vt.vt_expiry = vtm.c1vm_expiry;
 
-        err = c1_tree_replay_exec(c1, cnid, seqno, &kt, &vt, tomb);
+        err = c1_tree_replay_exec(c1, cnid, seqno, &kt, &vt, vtype);
 
         if (!i) {
             atomic64_inc(&tree->c1t_numkeys);
@@ -605,6 +691,7 @@ c1_tree_replay(struct c1 *c1, struct c1_tree *tree)
     merr_t err;
     u64    ingestedkeys;
     u64    replayedkeys;
+    u64    tstart, tread;
 
     if (c1_is_clean(c1)) {
         hse_log(
@@ -625,6 +712,8 @@ c1_tree_replay(struct c1 *c1, struct c1_tree *tree)
 
     perfc_inc(&c1->c1_pcset_tree, PERFC_BA_C1_TREPL);
 
+    tstart = get_time_ns();
+
     /*
      * Gather all transaction information from the logs
      * of the given tree. Sort the transactions based on
@@ -666,6 +755,8 @@ c1_tree_replay(struct c1 *c1, struct c1_tree *tree)
 
     c1_tree_replay_verify_keycount(c1, tree, replayedkeys);
 
+    tread = get_time_ns();
+
     /*
      * If there is no key/value then the tree is empty, mark
      * it so and return.
@@ -692,13 +783,15 @@ c1_tree_replay(struct c1 *c1, struct c1_tree *tree)
     hse_log(
         HSE_WARNING "c1 replay summary - tree: %p, ver: %lu-%lu, "
                     "Logged keys: %lu, Found in replay: %lu, "
-                    "Keys replayed: %ld",
+                    "Keys replayed: %ld, read %lu us, apply %lu us",
         tree,
         (unsigned long)tree->c1t_seqno,
         (unsigned long)tree->c1t_gen,
         (unsigned long)ingestedkeys,
         (unsigned long)replayedkeys,
-        (long)atomic64_read(&tree->c1t_numkeys));
+        (long)atomic64_read(&tree->c1t_numkeys),
+        (unsigned long)((tread - tstart) / 1000),
+        (unsigned long)((get_time_ns() - tread) / 1000));
 
     assert(list_empty(&tree->c1t_txn_list));
     assert(list_empty(&tree->c1t_kvb_list));
@@ -23,6 +23,7 @@ struct c1_vtuple_meta {
     u64   c1vm_xlen;
     u32   c1vm_tomb;
     u32   c1vm_logtype;
+    u32   c1vm_expiry;
     char *c1vm_data;
 };
 
@@ -34,7 +35,7 @@ struct c1_mblk_meta {
 static __always_inline uint
 c1_kvtuple_meta_vlen(const struct c1_kvtuple_meta *kvtm)
 {
-    uint clen = kvtm->c1kvm_xlen >> 32;
+    uint clen = (kvtm->c1kvm_xlen >> 32) & 0xfffffful;
     uint vlen = kvtm->c1kvm_xlen & 0xfffffffful;
 
     return clen ?: vlen;
@@ -43,7 +44,7 @@ c1_kvtuple_meta_vlen(const struct c1_kvtuple_meta *kvtm)
 static __always_inline uint
 c1_vtuple_meta_vlen(const struct c1_vtuple_meta *vtm)
 {
-    uint clen = vtm->c1vm_xlen >> 32;
+    uint clen = (vtm->c1vm_xlen >> 32) & 0xfffffful;
     uint vlen = vtm->c1vm_xlen & 0xfffffffful;
 
     return clen ?: vlen;
@@ -5,6 +5,8 @@
 
 #include "c1_omf_internal.h"
 
+#include <hse_util/workqueue.h>
+
 #include <mpool/mpool.h>
 
 static void
@@ -406,6 +408,8 @@ static merr_t
 c1_replay_trees(struct mpool *mp, u64 oid1, u64 oid2, struct c1 *c1)
 {
     struct c1_tree *tree, *tree_tmp;
+    u64             tstart;
+    int             ntrees;
     merr_t          err;
 
     err = c1_replay_build_trees(mp, oid1, oid2, c1);
@@ -418,6 +422,17 @@ c1_replay_trees(struct mpool *mp, u64 oid1, u64 oid2, struct c1 *c1)
 
     c1_replay_sort_trees(c1);
 
+    /* The logs of each tree are read concurrently by the replay
+     * workqueue.  If it cannot be created the logs are read serially.
+     */
+    if (!c1_is_clean(c1)) {
+        c1->c1_replay_wq = alloc_workqueue("c1_replay", 0, HSE_C1_REPLAY_THREAD_CNT);
+        ev(!c1->c1_replay_wq);
+    }
+
+    tstart = get_time_ns();
+    ntrees = 0;
+
     mutex_lock(&c1->c1_active_mtx);
     list_for_each_entry_safe (tree, tree_tmp, &c1->c1_tree_inuse, c1t_list) {
 
@@ -433,12 +448,24 @@ c1_replay_trees(struct mpool *mp, u64 oid1, u64 oid2, struct c1 *c1)
 
         list_del(&tree->c1t_list);
         list_add_tail(&tree->c1t_list, &c1->c1_tree_clean);
+        ++ntrees;
     }
 
     assert(err || list_empty(&c1->c1_tree_inuse));
 
     mutex_unlock(&c1->c1_active_mtx);
 
+    if (c1->c1_replay_wq) {
+        destroy_workqueue(c1->c1_replay_wq);
+        c1->c1_replay_wq = NULL;
+    }
+
+    if (!err && !c1_is_clean(c1))
+        hse_log(
+            HSE_NOTICE "c1 replayed %d trees in %lu ms",
+            ntrees,
+            (ulong)((get_time_ns() - tstart) / 1000000));
+
     if (!err && c1_ikvdb(c1))
         ikvdb_c1_set_seqno(c1_ikvdb(c1), c1_get_kvdb_seqno(c1));
 
@@ -160,6 +160,8 @@ MTF_DEFINE_UTEST_PREPOST(c1_test, basic, no_fail_pre, no_fail_post)
     struct kvdb_rparams kvdb_rp;
     struct mock_kvdb    mkvdb;
     atomic64_t          seqno;
+    struct kvs_ktuple   kt;
+    struct kvs_vtuple   vt;
     struct c1 *         c1;
 
     kvdb_rp = kvdb_rparams_defaults();
@@ -175,10 +177,15 @@ MTF_DEFINE_UTEST_PREPOST(c1_test, basic, no_fail_pre, no_fail_post)
      * now we rely ikvdb_c1_replay_del() and ikvdb_c1_replay_del()
      * to quietly fail because ikvdb is NULL.
      */
-    err = c1_replay_on_ikvdb(c1, NULL, 0, 0, NULL, NULL, true);
+    err = c1_replay_on_ikvdb(c1, NULL, 0, 0, NULL, NULL, C1_VTYPE_TOMB);
     ASSERT_EQ(0, err);
 
-    err = c1_replay_on_ikvdb(c1, NULL, 0, 0, NULL, NULL, false);
+    err = c1_replay_on_ikvdb(c1, NULL, 0, 0, NULL, NULL, C1_VTYPE_VAL);
+    ASSERT_EQ(0, err);
+
+    kvs_ktuple_init(&kt, "a", 1);
+    kvs_vtuple_init(&vt, "b", 1);
+    err = c1_replay_on_ikvdb(c1, NULL, 0, 0, &kt, &vt, C1_VTYPE_RTOMB);
     ASSERT_EQ(0, err);
 
     c1_destroy(c1);
@@ -1618,6 +1625,7 @@ MTF_DEFINE_UTEST_PREPOST(c1_test, upgrade2, no_fail_pre, no_fail_post)
 
     merr_t err;
     char * omf;
+    u32    len;
 
     /* C1_TYPE_INFO */
     omf = (char *)&info_omf;
@@ -1707,9 +1715,21 @@ MTF_DEFINE_UTEST_PREPOST(c1_test, upgrade2, no_fail_pre, no_fail_post)
     upgrade_test_bytype(omf, C1_TYPE_VT, sizeof(vt_omf), lcl_ti);
 
     omf_set_c1vt_xlen(&vt_omf, 1000);
+    omf_set_c1vt_expiry(&vt_omf, 1100);
     err = c1_record_unpack_bytype(omf, C1_TYPE_VT, C1_VERSION, &rec);
     ASSERT_EQ(0, err);
     ASSERT_EQ(c1_vtuple_meta_vlen(&rec.v), 1000);
+    ASSERT_EQ(rec.v.c1vm_expiry, 1100);
+
+    /* Version 2 value records are shorter and carry no expiry. */
+    err = c1_record_type2len(C1_TYPE_VT, C1_VERSION2, &len);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(len, sizeof(struct c1_vtuple_omf_v2));
+
+    err = c1_record_unpack_bytype(omf, C1_TYPE_VT, C1_VERSION2, &rec);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(c1_vtuple_meta_vlen(&rec.v), 1000);
+    ASSERT_EQ(rec.v.c1vm_expiry, 0);
 
     /* C1_TYPE_MBLK */
     omf = (char *)&mblk_omf;
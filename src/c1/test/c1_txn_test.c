@@ -11,6 +11,7 @@
 #include <hse_util/slab.h>
 #include <hse_util/page.h>
 #include <hse_util/seqno.h>
+#include <hse_util/timing.h>
 
 #include <hse_ikvdb/c0.h>
 #include <hse_ikvdb/c1.h>
@@ -789,6 +790,109 @@ MTF_DEFINE_UTEST_PREPOST(c1_txn_test, commit_replay5, test_pre, test_post)
     hse_params_destroy(params);
 }
 
+/* Measure the time to replay a journal of many small transactions,
+ * the bulk of which is spent reading the logs of each c1 tree.
+ */
+MTF_DEFINE_UTEST_PREPOST(c1_txn_test, commit_replay_perf, test_pre, test_post)
+{
+    struct kvdb_cparams    cp = kvdb_cparams_defaults();
+    struct kvs_rparams     rp = kvs_rparams_defaults();
+    struct mpool *         ds = NULL;
+    struct ikvdb *         hdl = NULL;
+    const char *           mpool = "mpool_alpha";
+    const char *           kvs = "kvs-0";
+    struct hse_kvs *       kvs_h = NULL;
+    struct hse_kvdb_opspec os;
+    struct kvs_ktuple      kt;
+    struct kvs_vtuple      vt;
+    const int              txnc = 1000, keyc = 8;
+    char                   key[32], val[128];
+    merr_t                 err;
+    struct cn *            mock_cn;
+    u64                    tstart;
+    int                    i, j;
+
+    err = create_mock_cn(&mock_cn, false, false, &rp, 0);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_make(ds, 0, 0, &cp, 0);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_open(mpool, ds, NULL, &hdl);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_make(hdl, kvs, NULL);
+    ASSERT_EQ(0, err);
+
+    mapi_inject_unset(mapi_idx_ikvdb_kvs_put);
+    mapi_inject_unset(mapi_idx_ikvdb_kvs_del);
+    mapi_inject_unset(mapi_idx_ikvdb_kvs_prefix_delete);
+
+    err = ikvdb_kvs_open(hdl, kvs, 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvs_h);
+
+    memset(val, 0xa5, sizeof(val));
+
+    os.kop_txn = ikvdb_txn_alloc(hdl);
+    ASSERT_NE(0, os.kop_txn);
+
+    for (i = 0; i < txnc; i++) {
+        err = ikvdb_txn_begin(hdl, os.kop_txn);
+        ASSERT_EQ(0, err);
+
+        for (j = 0; j < keyc; j++) {
+            snprintf(key, sizeof(key), "key.%08d.%02d", i, j);
+            kvs_ktuple_init(&kt, key, strlen(key));
+            kvs_vtuple_init(&vt, val, sizeof(val));
+
+            err = ikvdb_kvs_put(kvs_h, &os, &kt, &vt);
+            ASSERT_EQ(0, err);
+        }
+
+        err = ikvdb_txn_commit(hdl, os.kop_txn);
+        ASSERT_EQ(0, err);
+    }
+
+    ikvdb_txn_free(hdl, os.kop_txn);
+
+    err = ikvdb_sync(hdl);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(hdl);
+    ASSERT_EQ(0, err);
+
+    mapi_inject(mapi_idx_c1_is_clean, 0);
+    mapi_inject(mapi_idx_c1_should_replay, true);
+    mapi_inject(mapi_idx_c1_ingest_seqno, false);
+    mapi_inject(mapi_idx_c1_cningestid, 0);
+
+    tstart = get_time_ns();
+
+    err = ikvdb_open(mpool, ds, NULL, &hdl);
+    ASSERT_EQ(0, err);
+
+    hse_log(
+        HSE_NOTICE "%s: replayed %d txns of %d keys in %lu us",
+        __func__,
+        txnc,
+        keyc,
+        (ulong)((get_time_ns() - tstart) / 1000));
+
+    mapi_inject_unset(mapi_idx_c1_is_clean);
+    mapi_inject_unset(mapi_idx_c1_should_replay);
+    mapi_inject_unset(mapi_idx_c1_ingest_seqno);
+    mapi_inject_unset(mapi_idx_c1_cningestid);
+
+    err = ikvdb_close(hdl);
+    ASSERT_EQ(0, err);
+
+    destroy_mock_cn(mock_cn);
+}
+
 #if 0
 MTF_DEFINE_UTEST_PREPOST(c1_txn_test, fail,
              test_pre, test_post)
@@ -9,6 +9,7 @@
 #include <hse_util/alloc.h>
 #include <hse_util/slab.h>
 #include <hse_util/bloom_filter.h>
+#include <hse_util/fuse_filter.h>
 #include <hse_util/bitmap.h>
 
 #include <hse_ikvdb/tuple.h>
@@ -18,6 +19,7 @@
 
 #include "bloom_reader.h"
 #include "kvs_mblk_desc.h"
+#include "omf.h"
 
 /* [HSE_REVISIT] bloom_filter.[ch] provides an abstracted data type for a bloom
  * filter, but does not provide for creation of a self-managed bloom filter
@@ -50,6 +52,28 @@ bloom_reader_mcache_lookup(
     if (!kt->kt_hash)
         kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len);
 
+    /* A fuse lookup may touch any three slots in the filter, so (as does
+     * kbr_read_blm_pages()) we rely upon the mcache map of the filter
+     * being contiguous in virtual memory and fetch only its first page.
+     */
+    if (desc->bd_type == BLOOM_OMF_TYPE_FUSE) {
+        offsetv[0] = desc->bd_first_page;
+
+        err = mpool_mcache_getpages(kbd->map, 1, kbd->map_idx, offsetv, pagev);
+        if (ev(err))
+            return err;
+
+        *hit = ff_lookup(
+            pagev[0],
+            desc->bd_seed,
+            desc->bd_seglen,
+            desc->bd_segcnt,
+            desc->bd_fpbits,
+            kt->kt_hash);
+
+        return 0;
+    }
+
     bkt = bf_hash2bkt(kt->kt_hash, desc->bd_modulus, desc->bd_bktshift);
     offsetv[0] = desc->bd_first_page + bkt / PAGE_SIZE;
 
@@ -70,11 +94,65 @@ bloom_reader_buffer_lookup(const struct bloom_desc *desc, const u8 *bitmap, stru
     if (!kt->kt_hash)
         kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len);
 
+    if (desc->bd_type == BLOOM_OMF_TYPE_FUSE)
+        return ff_lookup(
+            bitmap, desc->bd_seed, desc->bd_seglen, desc->bd_segcnt, desc->bd_fpbits, kt->kt_hash);
+
     bitmap += bf_hash2bkt(kt->kt_hash, desc->bd_modulus, desc->bd_bktshift);
 
     return bf_lookup(kt->kt_hash, bitmap, desc->bd_n_hashes, desc->bd_rotl, desc->bd_bktmask);
 }
 
+void
+bloom_reader_buffer_lookupv(
+    const struct bloom_desc *desc,
+    const u8 *               bitmap,
+    uint                     ktc,
+    struct kvs_ktuple **     ktv,
+    bool *                   hitv)
+{
+    struct fuse_filter ff = {};
+    u64                hashv[32];
+    uint               i, j, cnt;
+
+    if (desc->bd_type == BLOOM_OMF_TYPE_FUSE) {
+        ff.ff_data = (u8 *)bitmap;
+        ff.ff_seed = desc->bd_seed;
+        ff.ff_seglen = desc->bd_seglen;
+        ff.ff_segcnt = desc->bd_segcnt;
+        ff.ff_fpbits = desc->bd_fpbits;
+    }
+
+    for (i = 0; i < ktc; i += cnt) {
+        cnt = min_t(uint, ktc - i, NELEM(hashv));
+
+        for (j = 0; j < cnt; ++j) {
+            struct kvs_ktuple *kt = ktv[i + j];
+
+            if (!kt->kt_hash)
+                kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len);
+
+            hashv[j] = kt->kt_hash;
+        }
+
+        if (desc->bd_type == BLOOM_OMF_TYPE_FUSE) {
+            ff_lookupv(&ff, cnt, hashv, hitv + i);
+            continue;
+        }
+
+        bf_lookupv(
+            bitmap,
+            desc->bd_modulus,
+            desc->bd_bktshift,
+            desc->bd_n_hashes,
+            desc->bd_rotl,
+            desc->bd_bktmask,
+            cnt,
+            hashv,
+            hitv + i);
+    }
+}
+
 merr_t
 bloom_reader_filter_info(struct bloom_desc *desc, u32 *hash_cnt, u32 *modulus)
 {
@@ -22,6 +22,12 @@ struct kvs_mblk_desc;
  * @bd_n_pages:     size of data region in pages
  * @bd_n_hashes:
  * @bd_n_bits:      size of bloom filter in bits
+ * @bd_type:        filter type (BLOOM_OMF_TYPE_BLOCK or BLOOM_OMF_TYPE_FUSE)
+ * @bd_fpbits:      fingerprint width in bits (fuse only)
+ * @bd_seglen:      segment length (fuse only)
+ * @bd_segcnt:      segment count (fuse only)
+ * @bd_seed:        hash seed (fuse only)
+ * @bd_pfx_len:     length of key prefixes in the filter (0: none)
  *
  * When a kblock is opened for reading, the @bloom_hdr_omf struct is read from
  * media and the relevant information is stored in a @bloom_desc struct.
@@ -41,6 +47,12 @@ struct bloom_desc {
     u32 bd_first_page;
     u32 bd_n_pages;
     u32 bd_bktsz;
+    u32 bd_type;
+    u32 bd_fpbits;
+    u32 bd_seglen;
+    u32 bd_segcnt;
+    u32 bd_pfx_len;
+    u64 bd_seed;
 };
 
 #define BLOOM_LOOKUP_NONE (0)
@@ -60,6 +72,22 @@ struct bloom_desc {
 bool
 bloom_reader_buffer_lookup(const struct bloom_desc *desc, const u8 *buffer, struct kvs_ktuple *kt);
 
+/**
+ * bloom_reader_buffer_lookupv() - batched bloom_reader_buffer_lookup()
+ * @desc:       bloom descriptor
+ * @buffer:     base address of bloom bitmap
+ * @ktc:        number of keys in @ktv
+ * @ktv:        vector of ptrs to keys (kt_hash computed if zero)
+ * @hitv:       (output) hitv[i] is set to the result for ktv[i]
+ */
+void
+bloom_reader_buffer_lookupv(
+    const struct bloom_desc *desc,
+    const u8 *               buffer,
+    uint                     ktc,
+    struct kvs_ktuple **     ktv,
+    bool *                   hitv);
+
 merr_t
 bloom_reader_mcache_lookup(
     const struct bloom_desc *   desc,
@@ -19,11 +19,13 @@
 #include <hse_util/string.h>
 
 #include <hse_util/perfc.h>
+#include <hse_util/keycmp.h>
 
 #include <hse/hse_limits.h>
 
 #include <hse_ikvdb/cn.h>
 #include <hse_ikvdb/cn_cursor.h>
+#include <hse_ikvdb/cn_tree_view.h>
 #include <hse_ikvdb/cndb.h>
 #include <hse_ikvdb/cursor.h>
 #include <hse_ikvdb/kvset_builder.h>
@@ -159,12 +161,6 @@ cn_get_seqno_horizon(struct cn *cn)
     return ikvdb_horizon(cn->ikvdb);
 }
 
-struct workqueue_struct *
-cn_get_io_wq(struct cn *cn)
-{
-    return cn->cn_io_wq;
-}
-
 struct workqueue_struct *
 cn_get_maint_wq(struct cn *cn)
 {
@@ -183,6 +179,12 @@ cn_get_cancel(struct cn *cn)
     return &cn->cn_maint_cancel;
 }
 
+struct tbkt *
+cn_get_tbkt_maint(struct cn *cn)
+{
+    return cn->cn_tbkt_maint;
+}
+
 struct perfc_set *
 cn_get_perfc(struct cn *cn, enum cn_action action)
 {
@@ -217,6 +219,12 @@ cn_pc_mclass_get(struct cn *cn)
     return &cn->cn_pc_mclass;
 }
 
+struct perfc_set *
+cn_pc_lookup_get(struct cn *cn)
+{
+    return &cn->cn_pc_get;
+}
+
 /**
  * cn_get_ref() - increment a cn reference counter
  *
@@ -282,6 +290,8 @@ cn_cp2cflags(struct kvs_cparams *cp)
 
     if (cp->cp_kvs_ext01)
         flags |= CN_CFLAG_CAPPED;
+    if (cp->cp_kblk_filter)
+        flags |= CN_CFLAG_FUSE;
 
     return flags;
 }
@@ -335,6 +345,34 @@ cn_get(
     return cn_tree_lookup(cn->cn_tree, &cn->cn_pc_get, kt, seq, res, &qctx, 0, vbuf);
 }
 
+merr_t
+cn_get_batch(
+    struct cn *          cn,
+    u32                  cnt,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv)
+{
+    merr_t err;
+    u32    n;
+
+    while (cnt > 0) {
+        n = min_t(u32, cnt, CN_LOOKUP_BATCH_MAX);
+
+        err = cn_tree_lookup_batch(cn->cn_tree, &cn->cn_pc_get, n, ktv, seq, resv, vbufv);
+        if (ev(err))
+            return err;
+
+        ktv += n;
+        resv += n;
+        vbufv += n;
+        cnt -= n;
+    }
+
+    return 0;
+}
+
 merr_t
 cn_pfx_probe(
     struct cn *          cn,
@@ -1007,31 +1045,85 @@ cn_tstate_destroy(struct cn_tstate *tstate)
     free_aligned(impl);
 }
 
+/**
+ * struct cn_kvsetmk_ent - a kvset to be instantiated at cn open
+ * @kme_work:   work struct for parallel kvset creation
+ * @kme_tree:   cn tree in which the kvset will be inserted
+ * @kme_km:     kvset metadata (with private copies of the blk lists)
+ * @kme_tag:    cndb tag
+ * @kme_kvset:  the kvset, once created
+ * @kme_err:    result of kvset_create()
+ */
+struct cn_kvsetmk_ent {
+    struct work_struct kme_work;
+    struct cn_tree *   kme_tree;
+    struct kvset_meta  kme_km;
+    u64                kme_tag;
+    struct kvset *     kme_kvset;
+    merr_t             kme_err;
+};
+
+/**
+ * struct cn_kvsetmk_ctx - cn open kvset instantiation context
+ *
+ * Kvsets are instantiated in three phases: The metadata of all the
+ * kvsets is gathered from cndb (under the cndb lock), the kvsets are
+ * then created in parallel (which reads each kvset's kblock headers
+ * and region descriptors), and finally inserted into the tree in
+ * dgen order.
+ */
 struct cn_kvsetmk_ctx {
-    struct cn *ckmk_cn;
-    u64 *      ckmk_dgen;
-    uint       ckmk_node_level_max;
-    uint       ckmk_kvsets;
+    struct cn *            ckmk_cn;
+    u64 *                  ckmk_dgen;
+    uint                   ckmk_node_level_max;
+    uint                   ckmk_kvsets;
+    uint                   ckmk_threads;
+    uint                   ckmk_entc;
+    uint                   ckmk_entmax;
+    struct cn_kvsetmk_ent *ckmk_entv;
 };
 
 static merr_t
 cn_kvset_mk(struct cn_kvsetmk_ctx *ctx, struct kvset_meta *km, u64 tag)
 {
-    struct kvset *kvset;
-    struct cn *   cn = ctx->ckmk_cn;
-    merr_t        err;
+    struct cn_kvsetmk_ent *ent;
+    merr_t                 err = 0;
+    uint                   i;
 
-    err = kvset_create(cn->cn_tree, tag, km, &kvset);
-    if (ev(err))
-        return err;
+    if (ctx->ckmk_entc >= ctx->ckmk_entmax) {
+        uint entmax = ctx->ckmk_entmax ? ctx->ckmk_entmax * 2 : 1024;
 
-    err = cn_tree_insert_kvset(cn->cn_tree, kvset, km->km_node_level, km->km_node_offset);
-    if (ev(err)) {
-        kvset_put_ref(kvset);
-        return err;
+        ent = realloc(ctx->ckmk_entv, entmax * sizeof(*ent));
+        if (ev(!ent))
+            return merr(ENOMEM);
+
+        ctx->ckmk_entv = ent;
+        ctx->ckmk_entmax = entmax;
     }
 
-    ctx->ckmk_kvsets++;
+    /* The caller reuses the blk lists in km for each kvset, so we must
+     * make private copies of them.
+     */
+    ent = ctx->ckmk_entv + ctx->ckmk_entc;
+    memset(ent, 0, sizeof(*ent));
+
+    ent->kme_km = *km;
+    ent->kme_tree = ctx->ckmk_cn->cn_tree;
+    ent->kme_tag = tag;
+
+    blk_list_init(&ent->kme_km.km_kblk_list);
+    blk_list_init(&ent->kme_km.km_vblk_list);
+
+    ctx->ckmk_entc++;
+
+    for (i = 0; i < km->km_kblk_list.n_blks && !err; i++)
+        err = blk_list_append(&ent->kme_km.km_kblk_list, km->km_kblk_list.blks[i].bk_blkid);
+
+    for (i = 0; i < km->km_vblk_list.n_blks && !err; i++)
+        err = blk_list_append(&ent->kme_km.km_vblk_list, km->km_vblk_list.blks[i].bk_blkid);
+
+    if (ev(err))
+        return err;
 
     if (km->km_dgen > *(ctx->ckmk_dgen))
         *(ctx->ckmk_dgen) = km->km_dgen;
@@ -1042,6 +1134,115 @@ cn_kvset_mk(struct cn_kvsetmk_ctx *ctx, struct kvset_meta *km, u64 tag)
     return 0;
 }
 
+static void
+cn_kvset_mk_worker(struct work_struct *work)
+{
+    struct cn_kvsetmk_ent *ent = container_of(work, struct cn_kvsetmk_ent, kme_work);
+
+    ent->kme_err = kvset_create(ent->kme_tree, ent->kme_tag, &ent->kme_km, &ent->kme_kvset);
+}
+
+static int
+cn_kvset_mk_cmp(const void *lhs, const void *rhs)
+{
+    const struct cn_kvsetmk_ent *l = lhs;
+    const struct cn_kvsetmk_ent *r = rhs;
+
+    if (l->kme_km.km_dgen != r->kme_km.km_dgen)
+        return l->kme_km.km_dgen < r->kme_km.km_dgen ? -1 : 1;
+
+    return 0;
+}
+
+/* Create the kvsets gathered by cn_kvset_mk() using up to cn_open_threads
+ * threads.
+ */
+static void
+cn_kvset_mk_create(struct cn_kvsetmk_ctx *ctx)
+{
+    struct workqueue_struct *wq = NULL;
+    struct cn *              cn = ctx->ckmk_cn;
+    uint                     i, width;
+
+    width = min_t(uint, cn->rp->cn_open_threads, ctx->ckmk_entc);
+
+    /* kvset verification uses the tree's shared khashmap.
+     */
+    if (cn->rp->cn_verify)
+        width = 1;
+
+    if (width > 1) {
+        wq = alloc_workqueue("cn_open", 0, width);
+        if (ev(!wq))
+            width = 1;
+    }
+
+    ctx->ckmk_threads = max_t(uint, width, 1);
+
+    for (i = 0; i < ctx->ckmk_entc; i++) {
+        struct cn_kvsetmk_ent *ent = ctx->ckmk_entv + i;
+
+        INIT_WORK(&ent->kme_work, cn_kvset_mk_worker);
+
+        if (wq)
+            queue_work(wq, &ent->kme_work);
+        else
+            cn_kvset_mk_worker(&ent->kme_work);
+    }
+
+    destroy_workqueue(wq);
+}
+
+/* Insert the kvsets into the tree oldest first, such that each kvset
+ * goes to the head of its node's kvset list.
+ */
+static merr_t
+cn_kvset_mk_insert(struct cn_kvsetmk_ctx *ctx)
+{
+    struct cn *cn = ctx->ckmk_cn;
+    merr_t     err = 0;
+    uint       i;
+
+    qsort(ctx->ckmk_entv, ctx->ckmk_entc, sizeof(*ctx->ckmk_entv), cn_kvset_mk_cmp);
+
+    for (i = 0; i < ctx->ckmk_entc; i++) {
+        struct cn_kvsetmk_ent *ent = ctx->ckmk_entv + i;
+        struct kvset_meta *    km = &ent->kme_km;
+
+        if (!ent->kme_kvset) {
+            if (!err)
+                err = ent->kme_err;
+            continue;
+        }
+
+        if (!err) {
+            err = cn_tree_insert_kvset(cn->cn_tree, ent->kme_kvset, km->km_node_level,
+                                       km->km_node_offset);
+            if (!err) {
+                ctx->ckmk_kvsets++;
+                continue;
+            }
+        }
+
+        kvset_put_ref(ent->kme_kvset);
+    }
+
+    return err;
+}
+
+static void
+cn_kvset_mk_fini(struct cn_kvsetmk_ctx *ctx)
+{
+    uint i;
+
+    for (i = 0; i < ctx->ckmk_entc; i++) {
+        blk_list_free(&ctx->ckmk_entv[i].kme_km.km_kblk_list);
+        blk_list_free(&ctx->ckmk_entv[i].kme_km.km_vblk_list);
+    }
+
+    free(ctx->ckmk_entv);
+}
+
 /*----------------------------------------------------------------
  * SECTION: perf counter initialization
  *
@@ -1153,6 +1354,7 @@ cn_open(
     struct cn * cn;
     size_t      sz;
     u64         dgen = 0;
+    u64         tstart, tgather, tcreate, tinsert;
     bool        maint;
     uint64_t    mperr, staging_absent;
 
@@ -1244,6 +1446,10 @@ cn_open(
     cn->cn_replay = flags & IKVS_OFLAG_REPLAY;
     maint = cn->csched && !cn->cn_replay && !rp->cn_diag_mode && !rp->rdonly;
 
+    /* Compaction I/O is charged to the scheduler's token bucket, if any.
+     */
+    cn->cn_tbkt_maint = maint ? csched_tbkt_maint_get(cn->csched) : NULL;
+
     /* no perf counters in replay mode */
     if (!cn->cn_replay)
         cn_perfc_alloc(cn);
@@ -1272,10 +1478,28 @@ cn_open(
         vcnt = atomic64_read(&cn_kvdb->cnd_vblk_cnt);
     }
 
+    tstart = get_time_ns();
+
     err = cndb_cn_instantiate(cndb, cnid, &ctx, (void *)cn_kvset_mk);
+    if (!err) {
+        tgather = get_time_ns();
+        cn_kvset_mk_create(&ctx);
+        tcreate = get_time_ns();
+        err = cn_kvset_mk_insert(&ctx);
+        tinsert = get_time_ns();
+    }
+
+    cn_kvset_mk_fini(&ctx);
+
     if (ev(err))
         goto err_exit;
 
+    hse_log(HSE_NOTICE "cn_open %s/%s kvsets %u threads %u gather %lu ms create %lu ms insert %lu ms",
+            cn->cn_mpname, cn->cn_kvsname, ctx.ckmk_kvsets, ctx.ckmk_threads,
+            (ulong)(tgather - tstart) / 1000000,
+            (ulong)(tcreate - tgather) / 1000000,
+            (ulong)(tinsert - tcreate) / 1000000);
+
     if (cn_kvdb) {
         /* [HSE_REVISIT]: This approach is not thread-safe */
         ksz = atomic64_read(&cn_kvdb->cnd_kblk_size) - ksz;
@@ -1320,20 +1544,11 @@ cn_open(
     if (!maint)
         goto done;
 
-    /* [HSE_REVISIT]: move the io_wq to csched so we have one set of
-     * shared io workers per kvdb instead of one set per cn tree.
-     */
-    cn->cn_io_wq = alloc_workqueue("cn_io", 0, cn->rp->cn_io_threads ?: 4);
-    if (!cn->cn_io_wq) {
-        err = merr(ev(ENOMEM));
-        goto err_exit;
-    }
-
     /* Work queue for other work such as managing "capped" trees,
      * offloading kvset destroy from client queries, and running
      * vblock readahead operations.
      */
-    cn->cn_maint_wq = alloc_workqueue("cn_maint", 0, 32);
+    cn->cn_maint_wq = alloc_workqueue("cn_maint", WQ_SHARDED, 32);
     if (ev(!cn->cn_maint_wq)) {
         err = merr(ENOMEM);
         goto err_exit;
@@ -1365,7 +1580,6 @@ done:
 
 err_exit:
     destroy_workqueue(cn->cn_maint_wq);
-    destroy_workqueue(cn->cn_io_wq);
     cn_tree_destroy(cn->cn_tree);
     cn_tstate_destroy(cn->cn_tstate);
     if (!cn->cn_replay)
@@ -1380,7 +1594,6 @@ cn_close(struct cn *cn)
 {
     u64   report_ns = 5 * NSEC_PER_SEC;
     void *maint_wq = cn->cn_maint_wq;
-    void *io_wq = cn->cn_io_wq;
     u64   next_report;
     useconds_t dlymax, dly;
     bool  cancel;
@@ -1425,12 +1638,10 @@ cn_close(struct cn *cn)
         dlymax = 10000;
     }
 
-    /* The maint and I/O workqueues should be idle at this point...
+    /* The maint workqueue should be idle at this point...
      */
     flush_workqueue(maint_wq);
-    flush_workqueue(io_wq);
     cn->cn_maint_wq = NULL;
-    cn->cn_io_wq = NULL;
 
     cndb_cn_close(cn->cn_cndb, cn->cn_cnid);
     cndb_putref(cn->cn_cndb);
@@ -1439,7 +1650,6 @@ cn_close(struct cn *cn)
     cn_tstate_destroy(cn->cn_tstate);
 
     destroy_workqueue(maint_wq);
-    destroy_workqueue(io_wq);
     cn_perfc_free(cn);
 
     free_aligned(cn);
@@ -1692,6 +1902,131 @@ cn_cursor_active_kvsets(void *cursor, u32 *active, u32 *total)
     return cn_tree_cursor_active_kvsets(cursor, active, total);
 }
 
+struct cn_fence {
+    const void *cf_key;
+    u16         cf_klen;
+    u32         cf_nkeys;
+};
+
+static int
+cn_fence_cmp(const void *lhs, const void *rhs)
+{
+    const struct cn_fence *l = lhs;
+    const struct cn_fence *r = rhs;
+
+    return keycmp(l->cf_key, l->cf_klen, r->cf_key, r->cf_klen);
+}
+
+merr_t
+cn_cursor_split(
+    struct cn * cn,
+    const void *prefix,
+    u32         pfx_len,
+    uint        splitmax,
+    void *      keybuf,
+    u32 *       klenv,
+    uint *      splitcp)
+{
+    struct cn_fence *fencev;
+    struct table *   view;
+    const void *     prev;
+    u32              prevlen;
+    u64              total, cum;
+    uint             fencec, splitc;
+    int              attempts = 5;
+    int              i;
+    u32              j;
+    merr_t           err;
+
+    *splitcp = 0;
+
+    if (splitmax == 0)
+        return 0;
+
+    /* As with cursor create, a concurrent spill may perturb the view. */
+    do {
+        err = cn_tree_view_create(cn, &view);
+    } while (merr_errno(err) == EAGAIN && --attempts > 0);
+
+    if (ev(err))
+        return err;
+
+    fencec = 0;
+    for (i = 0; i < table_len(view); i++) {
+        struct kvset_view *v = table_at(view, i);
+
+        if (v->kvset)
+            fencec += kvset_get_num_kblocks(v->kvset);
+    }
+
+    if (fencec == 0)
+        goto out;
+
+    fencev = malloc_array(fencec, sizeof(*fencev));
+    if (ev(!fencev)) {
+        err = merr(ENOMEM);
+        goto out;
+    }
+
+    /* Collect the smallest key of each kblock along with its key count.
+     * The fence keys remain valid until the view is destroyed.
+     */
+    fencec = 0;
+    total = 0;
+
+    for (i = 0; i < table_len(view); i++) {
+        struct kvset_view *v = table_at(view, i);
+
+        if (!v->kvset)
+            continue;
+
+        for (j = 0; j < kvset_get_num_kblocks(v->kvset); j++) {
+            struct cn_fence *f = fencev + fencec;
+
+            kvset_get_nth_kblock_fence(v->kvset, j, &f->cf_key, &f->cf_klen, &f->cf_nkeys);
+
+            if (pfx_len > 0 && keycmp_prefix(prefix, pfx_len, f->cf_key, f->cf_klen))
+                continue;
+
+            total += f->cf_nkeys;
+            ++fencec;
+        }
+    }
+
+    qsort(fencev, fencec, sizeof(*fencev), cn_fence_cmp);
+
+    /* Choose as the nth split key the first fence key at which the
+     * fences preceding it hold at least n/(splitmax + 1) of the keys.
+     * Split keys must strictly increase, and must be greater than the
+     * prefix, which is where the first range begins.
+     */
+    prev = pfx_len > 0 ? prefix : "";
+    prevlen = pfx_len;
+    splitc = 0;
+    cum = 0;
+
+    for (i = 0; i < fencec && splitc < splitmax; i++) {
+        const struct cn_fence *f = fencev + i;
+
+        if (cum * (splitmax + 1) >= total * (splitc + 1) &&
+            keycmp(f->cf_key, f->cf_klen, prev, prevlen) > 0) {
+            prev = memcpy(keybuf + splitc * HSE_KVS_KLEN_MAX, f->cf_key, f->cf_klen);
+            prevlen = klenv[splitc++] = f->cf_klen;
+        }
+
+        cum += f->cf_nkeys;
+    }
+
+    *splitcp = splitc;
+
+    free(fencev);
+
+out:
+    cn_tree_view_destroy(view);
+
+    return err;
+}
+
 merr_t
 cn_make(struct mpool *ds, struct kvs_cparams *cp, struct kvdb_health *health)
 {
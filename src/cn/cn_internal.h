@@ -40,9 +40,6 @@ struct cn {
     bool     cn_closing;
     bool     cn_replay;
 
-    /* for asynchronous mblock I/O */
-    struct workqueue_struct *cn_io_wq;
-
     /* perf counters */
     struct perfc_set cn_pc_ingest;
     struct perfc_set cn_pc_spill;
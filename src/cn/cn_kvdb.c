@@ -12,6 +12,9 @@
 #include <hse_util/event_counter.h>
 
 #include <hse_ikvdb/cn_kvdb.h>
+#include <hse_ikvdb/kvdb_rparams.h>
+
+#include "cn_vcache.h"
 
 /* handle to impl converter */
 #define h2i(_H) container_of((_H), struct cn_kvdb_impl, h)
@@ -22,9 +25,10 @@ struct cn_kvdb_impl {
 
 /* MTF_MOCK */
 merr_t
-cn_kvdb_create(struct cn_kvdb **out)
+cn_kvdb_create(const char *mpname, const struct kvdb_rparams *rp, struct cn_kvdb **out)
 {
     struct cn_kvdb_impl *self;
+    merr_t               err;
 
     self = calloc(1, sizeof(*self));
     if (ev(!self))
@@ -35,6 +39,12 @@ cn_kvdb_create(struct cn_kvdb **out)
     atomic64_set(&self->h.cnd_kblk_size, 0);
     atomic64_set(&self->h.cnd_vblk_size, 0);
 
+    err = cn_vcache_create(mpname, rp->cn_vcache_sz, &self->h.cnd_vcache);
+    if (ev(err)) {
+        free(self);
+        return err;
+    }
+
     *out = &self->h;
 
     return 0;
@@ -43,8 +53,11 @@ cn_kvdb_create(struct cn_kvdb **out)
 void
 cn_kvdb_destroy(struct cn_kvdb *h)
 {
-    if (h)
-        free(h2i(h));
+    if (!h)
+        return;
+
+    cn_vcache_destroy(h->cnd_vcache);
+    free(h2i(h));
 }
 
 #if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
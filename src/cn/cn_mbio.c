@@ -0,0 +1,575 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#define MTF_MOCK_IMPL_cn_mbio
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/logging.h>
+#include <hse_util/minmax.h>
+
+#include <mpool/mpool.h>
+
+#include "cn_mbio.h"
+#include "kvs_mblk_desc.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define CN_MBIO_URING 1
+#endif
+
+#define CN_MBIO_QDEPTH_MAX (4096)
+
+#ifdef CN_MBIO_URING
+
+/* Minimal io_uring plumbing (we don't depend on liburing).  Only the
+ * submitting thread touches the SQ tail and the CQ head, the kernel
+ * owns the SQ head and the CQ tail.
+ */
+struct cn_mbio_ring {
+    int                  ur_fd;
+    uint                 ur_entries;
+    unsigned int *       ur_sq_tail;
+    unsigned int *       ur_sq_mask;
+    unsigned int *       ur_sq_array;
+    unsigned int *       ur_cq_head;
+    unsigned int *       ur_cq_tail;
+    unsigned int *       ur_cq_mask;
+    struct io_uring_sqe *ur_sqes;
+    struct io_uring_cqe *ur_cqes;
+    void *               ur_sq_ring;
+    size_t               ur_sq_ringsz;
+    void *               ur_cq_ring;
+    size_t               ur_cq_ringsz;
+    size_t               ur_sqesz;
+};
+
+#endif
+
+/* An engine without a resolver keeps its mcache reads in flight on the
+ * mbio_head list, oldest first.  An engine with a resolver uses io_uring
+ * if it can (mbio_uring), and is synchronous otherwise.
+ */
+struct cn_mbio {
+    cn_mbio_map_fn *     mbio_map;
+    void *               mbio_maprock;
+    uint                 mbio_qdepth;
+    uint                 mbio_inflight;
+    uint                 mbio_pending;
+    bool                 mbio_async;
+    bool                 mbio_uring;
+    struct cn_mbio_req * mbio_head;
+    struct cn_mbio_req **mbio_tailp;
+    char *               mbio_regbuf;
+    size_t               mbio_reglen;
+#ifdef CN_MBIO_URING
+    struct cn_mbio_ring mbio_ring;
+#endif
+};
+
+static void
+cn_mbio_complete(struct cn_mbio_req *req, merr_t err)
+{
+    req->mbr_err = err;
+    if (req->mbr_cb)
+        req->mbr_cb(req);
+}
+
+static merr_t
+cn_mbio_read_sync(struct cn_mbio *mbio, struct cn_mbio_req *req)
+{
+    const struct kvs_mblk_desc *mbd = req->mbr_mbd;
+
+    ssize_t cc;
+    off_t   base;
+    merr_t  err;
+    int     fd;
+
+    if (!mbio->mbio_map)
+        return mpool_mblock_read(mbd->ds, mbd->mb_id, &req->mbr_iov, 1, req->mbr_off);
+
+    err = mbio->mbio_map(mbio->mbio_maprock, mbd->mb_id, &fd, &base);
+    if (ev(err))
+        return err;
+
+    cc = preadv(fd, &req->mbr_iov, 1, base + req->mbr_off);
+    if (ev(cc == -1))
+        return merr(errno);
+
+    return (size_t)cc == req->mbr_iov.iov_len ? 0 : merr(ev(EIO));
+}
+
+#ifdef CN_MBIO_URING
+
+static int
+cn_mbio_uring_setup(uint entries, struct io_uring_params *p)
+{
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int
+cn_mbio_uring_enter(int fd, uint tosubmit, uint min, uint flags)
+{
+    return syscall(__NR_io_uring_enter, fd, tosubmit, min, flags, NULL, 0);
+}
+
+static int
+cn_mbio_uring_register(int fd, uint opcode, const void *arg, uint nargs)
+{
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nargs);
+}
+
+static void
+cn_mbio_ring_fini(struct cn_mbio_ring *ur)
+{
+    if (ur->ur_sqes)
+        munmap(ur->ur_sqes, ur->ur_sqesz);
+    if (ur->ur_cq_ring && ur->ur_cq_ring != ur->ur_sq_ring)
+        munmap(ur->ur_cq_ring, ur->ur_cq_ringsz);
+    if (ur->ur_sq_ring)
+        munmap(ur->ur_sq_ring, ur->ur_sq_ringsz);
+    if (ur->ur_fd != -1)
+        close(ur->ur_fd);
+
+    memset(ur, 0, sizeof(*ur));
+    ur->ur_fd = -1;
+}
+
+static merr_t
+cn_mbio_ring_init(struct cn_mbio_ring *ur, uint entries)
+{
+    struct io_uring_params p;
+    void *                 ptr;
+    int                    rc;
+
+    memset(ur, 0, sizeof(*ur));
+    memset(&p, 0, sizeof(p));
+
+    ur->ur_fd = cn_mbio_uring_setup(entries, &p);
+    if (ur->ur_fd == -1)
+        return merr(errno);
+
+    ur->ur_entries = p.sq_entries;
+    ur->ur_sq_ringsz = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+    ur->ur_cq_ringsz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    ur->ur_sqesz = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        ur->ur_sq_ringsz = ur->ur_cq_ringsz = max(ur->ur_sq_ringsz, ur->ur_cq_ringsz);
+
+    ptr = mmap(NULL, ur->ur_sq_ringsz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+               ur->ur_fd, IORING_OFF_SQ_RING);
+    if (ptr == MAP_FAILED)
+        goto errout;
+
+    ur->ur_sq_ring = ptr;
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        ur->ur_cq_ring = ur->ur_sq_ring;
+    } else {
+        ptr = mmap(NULL, ur->ur_cq_ringsz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ur->ur_fd, IORING_OFF_CQ_RING);
+        if (ptr == MAP_FAILED)
+            goto errout;
+
+        ur->ur_cq_ring = ptr;
+    }
+
+    ptr = mmap(NULL, ur->ur_sqesz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+               ur->ur_fd, IORING_OFF_SQES);
+    if (ptr == MAP_FAILED)
+        goto errout;
+
+    ur->ur_sqes = ptr;
+
+    ur->ur_sq_tail = ur->ur_sq_ring + p.sq_off.tail;
+    ur->ur_sq_mask = ur->ur_sq_ring + p.sq_off.ring_mask;
+    ur->ur_sq_array = ur->ur_sq_ring + p.sq_off.array;
+    ur->ur_cq_head = ur->ur_cq_ring + p.cq_off.head;
+    ur->ur_cq_tail = ur->ur_cq_ring + p.cq_off.tail;
+    ur->ur_cq_mask = ur->ur_cq_ring + p.cq_off.ring_mask;
+    ur->ur_cqes = ur->ur_cq_ring + p.cq_off.cqes;
+
+    return 0;
+
+errout:
+    rc = errno;
+    cn_mbio_ring_fini(ur);
+
+    return merr(rc);
+}
+
+/* Process all available completions.  The CQ head is advanced before the
+ * callbacks are invoked so that callbacks may submit new requests.
+ */
+static uint
+cn_mbio_ring_drain(struct cn_mbio *mbio)
+{
+    struct cn_mbio_ring *ur = &mbio->mbio_ring;
+    struct cn_mbio_req * donev[32];
+    merr_t               errv[32];
+    unsigned int         head, tail;
+    uint                 n = 0, i;
+
+    head = *ur->ur_cq_head;
+    tail = __atomic_load_n(ur->ur_cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail && n < NELEM(donev)) {
+        struct io_uring_cqe *cqe = ur->ur_cqes + (head & *ur->ur_cq_mask);
+        struct cn_mbio_req * req = (void *)(uintptr_t)cqe->user_data;
+
+        if (cqe->res < 0)
+            errv[n] = merr(-cqe->res);
+        else if ((size_t)cqe->res != req->mbr_iov.iov_len)
+            errv[n] = merr(EIO);
+        else
+            errv[n] = 0;
+
+        donev[n++] = req;
+        ++head;
+    }
+
+    __atomic_store_n(ur->ur_cq_head, head, __ATOMIC_RELEASE);
+    mbio->mbio_inflight -= n;
+
+    for (i = 0; i < n; ++i)
+        cn_mbio_complete(donev[i], ev(errv[i]));
+
+    return n;
+}
+
+/* Push all prepared SQEs to the kernel.
+ */
+static merr_t
+cn_mbio_ring_flush(struct cn_mbio *mbio)
+{
+    struct cn_mbio_ring *ur = &mbio->mbio_ring;
+    int                  rc;
+
+    while (mbio->mbio_pending > 0) {
+        rc = cn_mbio_uring_enter(ur->ur_fd, mbio->mbio_pending, 0, 0);
+        if (rc == -1) {
+            if (errno == EINTR)
+                continue;
+            if ((errno == EAGAIN || errno == EBUSY) && mbio->mbio_inflight > mbio->mbio_pending) {
+                if (cn_mbio_ring_drain(mbio) == 0)
+                    cn_mbio_uring_enter(ur->ur_fd, 0, 1, IORING_ENTER_GETEVENTS);
+                continue;
+            }
+
+            return merr(ev(errno));
+        }
+
+        mbio->mbio_pending -= rc;
+    }
+
+    return 0;
+}
+
+static merr_t
+cn_mbio_ring_prep(struct cn_mbio *mbio, struct cn_mbio_req *req)
+{
+    struct cn_mbio_ring *ur = &mbio->mbio_ring;
+    struct io_uring_sqe *sqe;
+    unsigned int         tail, idx;
+    const char *         buf;
+    off_t                base;
+    merr_t               err;
+    int                  fd;
+
+    err = mbio->mbio_map(mbio->mbio_maprock, req->mbr_mbd->mb_id, &fd, &base);
+    if (ev(err))
+        return err;
+
+    tail = *ur->ur_sq_tail;
+    idx = tail & *ur->ur_sq_mask;
+    sqe = ur->ur_sqes + idx;
+    buf = req->mbr_iov.iov_base;
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = fd;
+    sqe->off = base + req->mbr_off;
+    sqe->user_data = (uintptr_t)req;
+
+    if (mbio->mbio_regbuf && buf >= mbio->mbio_regbuf &&
+        buf + req->mbr_iov.iov_len <= mbio->mbio_regbuf + mbio->mbio_reglen) {
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->addr = (uintptr_t)buf;
+        sqe->len = req->mbr_iov.iov_len;
+        sqe->buf_index = 0;
+    } else {
+        sqe->opcode = IORING_OP_READV;
+        sqe->addr = (uintptr_t)&req->mbr_iov;
+        sqe->len = 1;
+    }
+
+    ur->ur_sq_array[idx] = idx;
+    __atomic_store_n(ur->ur_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    mbio->mbio_pending++;
+    mbio->mbio_inflight++;
+
+    return 0;
+}
+
+#endif /* CN_MBIO_URING */
+
+/* Queue an mcache read.  The kernel starts reading the range into the
+ * page cache in the background, the data is copied out of the map when
+ * the request is reaped.
+ */
+static void
+cn_mbio_mcache_prep(struct cn_mbio *mbio, struct cn_mbio_req *req)
+{
+    const struct kvs_mblk_desc *mbd = req->mbr_mbd;
+    merr_t                      err;
+
+    err = mpool_mcache_madvise(
+        mbd->map, mbd->map_idx, req->mbr_off, req->mbr_iov.iov_len, MADV_WILLNEED);
+    ev(err); /* readahead is advisory */
+
+    req->mbr_next = NULL;
+    *mbio->mbio_tailp = req;
+    mbio->mbio_tailp = &req->mbr_next;
+
+    mbio->mbio_inflight++;
+}
+
+/* Complete the oldest @min mcache reads.  Copying from the map waits for
+ * whatever part of the range the readahead hasn't yet brought in.  Each
+ * request is dequeued before its callback is invoked so that callbacks
+ * may submit new requests.
+ */
+static uint
+cn_mbio_mcache_reap(struct cn_mbio *mbio, uint min)
+{
+    uint n;
+
+    for (n = 0; n < min && mbio->mbio_head; ++n) {
+        struct cn_mbio_req *req = mbio->mbio_head;
+        const char *        src;
+
+        mbio->mbio_head = req->mbr_next;
+        if (!mbio->mbio_head)
+            mbio->mbio_tailp = &mbio->mbio_head;
+
+        mbio->mbio_inflight--;
+
+        src = req->mbr_mbd->map_base;
+        memcpy(req->mbr_iov.iov_base, src + req->mbr_off, req->mbr_iov.iov_len);
+
+        cn_mbio_complete(req, 0);
+    }
+
+    return n;
+}
+
+merr_t
+cn_mbio_submit(struct cn_mbio *mbio, struct cn_mbio_req **reqv, uint reqc)
+{
+    merr_t err = 0;
+    uint   i;
+
+    if (!mbio->mbio_uring) {
+        for (i = 0; i < reqc; ++i) {
+            struct cn_mbio_req *req = reqv[i];
+
+            if (!mbio->mbio_async || !req->mbr_mbd->map) {
+                cn_mbio_complete(req, cn_mbio_read_sync(mbio, req));
+                continue;
+            }
+
+            /* Completions may submit reads of their own. */
+            while (mbio->mbio_inflight >= mbio->mbio_qdepth)
+                cn_mbio_mcache_reap(mbio, 1);
+
+            cn_mbio_mcache_prep(mbio, req);
+        }
+
+        return 0;
+    }
+
+#ifdef CN_MBIO_URING
+    for (i = 0; i < reqc; ++i) {
+        while (mbio->mbio_inflight >= mbio->mbio_qdepth) {
+            err = cn_mbio_ring_flush(mbio);
+            if (ev(err))
+                break;
+
+            if (ev(cn_mbio_reap(mbio, 1) == 0)) {
+                err = merr(EIO);
+                break;
+            }
+        }
+
+        if (err)
+            break;
+
+        err = cn_mbio_ring_prep(mbio, reqv[i]);
+        if (ev(err)) {
+            cn_mbio_complete(reqv[i], err);
+            err = 0;
+        }
+    }
+
+    if (!err)
+        err = cn_mbio_ring_flush(mbio);
+#endif
+
+    return err;
+}
+
+uint
+cn_mbio_reap(struct cn_mbio *mbio, uint min)
+{
+    uint n = 0;
+
+    if (!mbio->mbio_async)
+        return 0;
+
+    if (!mbio->mbio_uring)
+        return cn_mbio_mcache_reap(mbio, min);
+
+#ifdef CN_MBIO_URING
+    min = min_t(uint, min, mbio->mbio_inflight);
+
+    while (1) {
+        int rc;
+
+        n += cn_mbio_ring_drain(mbio);
+        if (n >= min || mbio->mbio_inflight == 0)
+            break;
+
+        rc = cn_mbio_uring_enter(
+            mbio->mbio_ring.ur_fd, 0, min_t(uint, min - n, mbio->mbio_inflight),
+            IORING_ENTER_GETEVENTS);
+        if (rc == -1 && errno != EINTR) {
+            ev(1);
+            break;
+        }
+    }
+#endif
+
+    return n;
+}
+
+uint
+cn_mbio_inflight(const struct cn_mbio *mbio)
+{
+    return mbio->mbio_inflight;
+}
+
+bool
+cn_mbio_async(const struct cn_mbio *mbio)
+{
+    return mbio->mbio_async;
+}
+
+merr_t
+cn_mbio_register(struct cn_mbio *mbio, void *buf, size_t len)
+{
+    if (ev(mbio->mbio_inflight > 0))
+        return merr(EBUSY);
+
+    if (!mbio->mbio_uring)
+        return 0;
+
+#ifdef CN_MBIO_URING
+    {
+        struct cn_mbio_ring *ur = &mbio->mbio_ring;
+        struct iovec         iov = {.iov_base = buf, .iov_len = len };
+
+        if (mbio->mbio_regbuf) {
+            cn_mbio_uring_register(ur->ur_fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+            mbio->mbio_regbuf = NULL;
+            mbio->mbio_reglen = 0;
+        }
+
+        if (!buf || !len)
+            return 0;
+
+        if (cn_mbio_uring_register(ur->ur_fd, IORING_REGISTER_BUFFERS, &iov, 1))
+            return merr(ev(errno));
+
+        mbio->mbio_regbuf = buf;
+        mbio->mbio_reglen = len;
+    }
+#endif
+
+    return 0;
+}
+
+merr_t
+cn_mbio_create(uint qdepth, cn_mbio_map_fn *map, void *maprock, struct cn_mbio **mbiop)
+{
+    struct cn_mbio *mbio;
+
+    if (ev(!mbiop || qdepth == 0))
+        return merr(EINVAL);
+
+    mbio = calloc(1, sizeof(*mbio));
+    if (ev(!mbio))
+        return merr(ENOMEM);
+
+    mbio->mbio_map = map;
+    mbio->mbio_maprock = maprock;
+    mbio->mbio_qdepth = min_t(uint, qdepth, CN_MBIO_QDEPTH_MAX);
+    mbio->mbio_tailp = &mbio->mbio_head;
+    mbio->mbio_async = !map;
+
+#ifdef CN_MBIO_URING
+    mbio->mbio_ring.ur_fd = -1;
+
+    if (map) {
+        merr_t err;
+
+        err = cn_mbio_ring_init(&mbio->mbio_ring, mbio->mbio_qdepth);
+        if (err) {
+            hse_elog(HSE_NOTICE "%s: io_uring unavailable, using synchronous reads: @@e",
+                     err, __func__);
+        } else {
+            mbio->mbio_qdepth = min_t(uint, mbio->mbio_qdepth, mbio->mbio_ring.ur_entries);
+            mbio->mbio_async = true;
+            mbio->mbio_uring = true;
+        }
+    }
+#endif
+
+    *mbiop = mbio;
+
+    return 0;
+}
+
+void
+cn_mbio_destroy(struct cn_mbio *mbio)
+{
+    if (!mbio)
+        return;
+
+    if (!mbio->mbio_uring)
+        cn_mbio_mcache_reap(mbio, UINT_MAX);
+
+#ifdef CN_MBIO_URING
+    if (mbio->mbio_uring) {
+        cn_mbio_ring_flush(mbio);
+
+        while (mbio->mbio_inflight > 0)
+            if (ev(cn_mbio_reap(mbio, mbio->mbio_inflight) == 0))
+                break;
+    }
+
+    cn_mbio_ring_fini(&mbio->mbio_ring);
+#endif
+
+    free(mbio);
+}
+
+#if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
+#include "cn_mbio_ut_impl.i"
+#endif /* HSE_UNIT_TEST_MODE */
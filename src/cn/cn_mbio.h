@@ -0,0 +1,161 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVDB_CN_MBIO_H
+#define HSE_KVDB_CN_MBIO_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/* MTF_MOCK_DECL(cn_mbio) */
+
+struct kvs_mblk_desc;
+struct cn_mbio;
+struct cn_mbio_req;
+
+/**
+ * cn_mbio_cb - mblock read completion callback
+ * @req: the completed request, req->mbr_err holds the read status
+ *
+ * Callbacks are invoked by the thread that calls cn_mbio_submit() or
+ * cn_mbio_reap(), and may submit new requests to the same engine.
+ */
+typedef void cn_mbio_cb(struct cn_mbio_req *req);
+
+/**
+ * cn_mbio_map_fn - resolve an mblock to a file descriptor and base offset
+ * @rock:  caller's context, as given to cn_mbio_create()
+ * @mbid:  mblock id
+ * @fdp:   (output) file descriptor from which the mblock may be read
+ * @basep: (output) file offset of the first byte of the mblock
+ */
+typedef merr_t cn_mbio_map_fn(void *rock, u64 mbid, int *fdp, off_t *basep);
+
+/**
+ * struct cn_mbio_req - an mblock read request
+ * @mbr_mbd:  mblock to read (id, mpool and mcache map)
+ * @mbr_off:  byte offset within the mblock
+ * @mbr_iov:  destination buffer
+ * @mbr_err:  (output) read status
+ * @mbr_cb:   completion callback
+ * @mbr_rock: caller's context
+ * @mbr_next: private to the engine
+ *
+ * A request (and the memory described by mbr_iov) must remain valid
+ * until its completion callback has been invoked.
+ */
+struct cn_mbio_req {
+    const struct kvs_mblk_desc *mbr_mbd;
+    off_t                       mbr_off;
+    struct iovec                mbr_iov;
+    merr_t                      mbr_err;
+    cn_mbio_cb *                mbr_cb;
+    void *                      mbr_rock;
+    struct cn_mbio_req *        mbr_next;
+};
+
+/**
+ * cn_mbio_create() - create an mblock read engine
+ * @qdepth:  maximum number of reads in flight
+ * @map:     mblock to file resolver (may be NULL)
+ * @maprock: context for @map
+ * @mbiop:   (output) engine handle
+ *
+ * If @map is given and the kernel supports io_uring, reads are issued
+ * asynchronously through an io_uring instance of @qdepth entries.  If
+ * @map is given but io_uring is unavailable, each read is performed
+ * synchronously at submission time via preadv().
+ *
+ * mpool doesn't expose a file descriptor per mblock, so mblocks that live
+ * in an mpool are read by an engine created without @map.  Such an engine
+ * starts kernel readahead of each request's range through the mblock's
+ * mcache map at submission time, and copies the range out of the map
+ * when the request is reaped (waiting only on the pages that have not
+ * yet arrived).  Requests for mblocks without an mcache map are read
+ * synchronously via mpool_mblock_read() at submission time.
+ *
+ * An engine is not thread safe, it is meant to be owned by a single
+ * reader (e.g., a compaction iterator).
+ */
+/* MTF_MOCK */
+merr_t
+cn_mbio_create(uint qdepth, cn_mbio_map_fn *map, void *maprock, struct cn_mbio **mbiop);
+
+/**
+ * cn_mbio_destroy() - wait for all reads in flight and destroy the engine
+ * @mbio: engine handle (may be NULL)
+ */
+/* MTF_MOCK */
+void
+cn_mbio_destroy(struct cn_mbio *mbio);
+
+/**
+ * cn_mbio_async() - return true if the engine can keep reads in flight
+ * @mbio: engine handle
+ */
+bool
+cn_mbio_async(const struct cn_mbio *mbio);
+
+/**
+ * cn_mbio_register() - register a buffer with the engine
+ * @mbio: engine handle
+ * @buf:  base of the buffer
+ * @len:  length of the buffer
+ *
+ * Reads whose destination lies entirely within a registered buffer avoid
+ * the per-read cost of pinning the destination pages.  Only one buffer
+ * may be registered at a time, and only while no reads are in flight.
+ * Registration is advisory; it is a no-op for engines not backed by
+ * io_uring.
+ */
+merr_t
+cn_mbio_register(struct cn_mbio *mbio, void *buf, size_t len);
+
+/**
+ * cn_mbio_submit() - submit a batch of read requests
+ * @mbio: engine handle
+ * @reqv: vector of requests
+ * @reqc: number of requests in reqv[]
+ *
+ * Requests are queued and issued with as few system calls as possible.
+ * If the queue is full, cn_mbio_submit() reaps completions to make room.
+ * Completion callbacks may therefore be invoked from either
+ * cn_mbio_submit() or cn_mbio_reap().
+ *
+ * Return: 0 if all requests were submitted, otherwise an error code for
+ * a failure of the engine itself (individual read errors are reported
+ * via each request's mbr_err).
+ */
+/* MTF_MOCK */
+merr_t
+cn_mbio_submit(struct cn_mbio *mbio, struct cn_mbio_req **reqv, uint reqc);
+
+/**
+ * cn_mbio_reap() - wait for and process read completions
+ * @mbio: engine handle
+ * @min:  minimum number of completions to wait for (limited to the
+ *        number of reads in flight)
+ *
+ * Return: the number of completions processed.
+ */
+/* MTF_MOCK */
+uint
+cn_mbio_reap(struct cn_mbio *mbio, uint min);
+
+/**
+ * cn_mbio_inflight() - return the number of reads in flight
+ * @mbio: engine handle
+ */
+uint
+cn_mbio_inflight(const struct cn_mbio *mbio);
+
+#if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
+#include "cn_mbio_ut.h"
+#endif /* HSE_UNIT_TEST_MODE */
+
+#endif
@@ -23,6 +23,7 @@ struct perfc_name cn_perfc_get[] = {
 
     NE(PERFC_DI_CNGET_DEPTH, 3, "cN levels examined", "d_lvl", 7),
     NE(PERFC_DI_CNGET_NKVSET, 3, "cN kvsets examined", "d_kvs", 7),
+    NE(PERFC_DI_CNGET_NKBLK, 3, "cN kblocks probed", "d_kblk", 7),
 
     NE(PERFC_LT_CNGET_GET, 3, "Latency of cN get", "l_get(ns)", 7),
     NE(PERFC_LT_CNGET_GET_L0, 3, "Latency of cN get in L0", "l_get_l0(ns)"),
@@ -33,7 +34,8 @@ struct perfc_name cn_perfc_get[] = {
     NE(PERFC_LT_CNGET_GET_L5, 3, "Latency of cN get in L5", "l_get_l5(ns)"),
     NE(PERFC_LT_CNGET_PROBEPFX, 3, "Latency of cN pfx probe", "l_pprobe(ns)"),
     NE(PERFC_LT_CNGET_MISS, 3, "Latency of cN misses", "l_mis(ns)"),
-    NE(PERFC_RA_CNGET_TOMB, 3, "Count of cN tombs", "c_tmb(/s)")
+    NE(PERFC_RA_CNGET_TOMB, 3, "Count of cN tombs", "c_tmb(/s)"),
+    NE(PERFC_LT_CNGET_GET_BATCH, 3, "Latency of cN batched get", "l_getb(ns)"),
 };
 
 struct perfc_name cn_perfc_compact[] = {
@@ -101,6 +103,17 @@ cn_perfc_mclass_get_idx(uint agegroup, uint dtype, uint mclass)
            dtype * HSE_MPOLICY_DTYPE_CNT + ((mclass == MP_MED_CAPACITY) ? 1 : 0);
 }
 
+struct perfc_name cn_perfc_vcache[] = {
+    NE(PERFC_RA_CNVCACHE_HIT, 2, "value cache hits", "c_hit(/s)"),
+    NE(PERFC_RA_CNVCACHE_MISS, 2, "value cache misses", "c_mis(/s)"),
+    NE(PERFC_RA_CNVCACHE_HITB, 2, "media read bytes saved by hits", "c_hitb(b/s)"),
+    NE(PERFC_RA_CNVCACHE_INSERT, 3, "value cache inserts", "c_ins(/s)"),
+    NE(PERFC_RA_CNVCACHE_EVICT, 3, "value cache evictions", "c_evict(/s)"),
+    NE(PERFC_BA_CNVCACHE_SIZE, 3, "value cache size", "size(b)"),
+};
+
+NE_CHECK(cn_perfc_vcache, PERFC_EN_CNVCACHE, "cn_perfc_vcache table/enum mismatch");
+
 NE_CHECK(cn_perfc_get, PERFC_EN_CNGET, "cn_perfc_get table/enum mismatch");
 
 NE_CHECK(cn_perfc_compact, PERFC_EN_CNCOMP, "cn_perfc_compact table/enum mismatch");
@@ -159,6 +172,12 @@ cn_perfc_init(void)
         cnget_kvset_bkts,
         sample_pct);
 
+    cn_perfc_bkts_create(
+        &cn_perfc_get[PERFC_DI_CNGET_NKBLK],
+        NELEM(cnget_kvset_bkts),
+        cnget_kvset_bkts,
+        sample_pct);
+
     cn_perfc_bkts_create(
         &cn_perfc_compact[PERFC_DI_CNCOMP_VBUTIL],
         NELEM(cncmp_pct_bkts),
@@ -194,6 +213,7 @@ cn_perfc_fini(void)
 {
     cn_perfc_bkts_destroy(&cn_perfc_get[PERFC_DI_CNGET_DEPTH]);
     cn_perfc_bkts_destroy(&cn_perfc_get[PERFC_DI_CNGET_NKVSET]);
+    cn_perfc_bkts_destroy(&cn_perfc_get[PERFC_DI_CNGET_NKBLK]);
     cn_perfc_bkts_destroy(&cn_perfc_compact[PERFC_DI_CNCOMP_VBUTIL]);
     cn_perfc_bkts_destroy(&cn_perfc_compact[PERFC_DI_CNCOMP_VBDEAD]);
     cn_perfc_bkts_destroy(&cn_perfc_compact[PERFC_DI_CNCOMP_VBCNT]);
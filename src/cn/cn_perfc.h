@@ -22,6 +22,7 @@ extern struct perfc_name cn_perfc_compact[];
 extern struct perfc_name cn_perfc_shape[];
 extern struct perfc_name cn_perfc_capped[];
 extern struct perfc_name cn_perfc_mclass[];
+extern struct perfc_name cn_perfc_vcache[];
 
 uint
 cn_perfc_mclass_get_idx(uint agegroup, uint dtype, uint mclass);
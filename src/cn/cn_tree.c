@@ -29,10 +29,11 @@
 #include <hse_util/darray.h>
 #include <hse_util/table.h>
 #include <hse_util/keycmp.h>
-#include <hse_util/bin_heap.h>
+#include <hse_util/loser_tree.h>
 #include <hse_util/log2.h>
 #include <hse_util/workqueue.h>
-#include <hse_util/compression_lz4.h>
+#include <hse_util/compression.h>
+#include <hse_util/token_bucket.h>
 
 #include <mpool/mpool.h>
 
@@ -49,6 +50,8 @@
 #include <hse_ikvdb/sched_sts.h>
 #include <hse_ikvdb/csched.h>
 #include <hse_ikvdb/kvs_rparams.h>
+#include <hse_ikvdb/rtomb.h>
+#include <hse_ikvdb/kvset_builder.h>
 
 #include "cn_tree.h"
 #include "cn_tree_compact.h"
@@ -1269,7 +1272,7 @@ cn_tree_lookup(
     merr_t                   err;
     u32                      child;
     u32                      shift;
-    uint                     pc_nkvset;
+    uint                     pc_nkvset, pc_nkblk;
     u64                      pc_start;
     u64                      spill_hash = 0;
     u16                      pc_lvl, pc_lvl_start, pc_depth;
@@ -1281,7 +1284,7 @@ cn_tree_lookup(
     err = 0;
     *res = NOT_FOUND;
 
-    pc_depth = pc_nkvset = 0;
+    pc_depth = pc_nkvset = pc_nkblk = 0;
     pc_lvl = CNGET_LMAX;
     pc_lvl_start = 0;
 
@@ -1331,7 +1334,7 @@ cn_tree_lookup(
 
             switch (qctx->qtype) {
                 case QUERY_GET:
-                    err = kvset_lookup(kvset, kt, &kdisc, seq, res, vbuf);
+                    err = kvset_lookup(kvset, kt, &kdisc, seq, res, vbuf, &pc_nkblk);
                     if (err || *res != NOT_FOUND) {
                         rmlock_runlock(lock);
                         if (pc_lvl < CNGET_LMAX)
@@ -1415,6 +1418,7 @@ done:
         perfc_inc(pc, PERFC_RA_CNGET_GET);
         perfc_rec_sample(pc, PERFC_DI_CNGET_DEPTH, pc_depth);
         perfc_rec_sample(pc, PERFC_DI_CNGET_NKVSET, pc_nkvset);
+        perfc_rec_sample(pc, PERFC_DI_CNGET_NKBLK, pc_nkblk);
     }
 
     if (wbti) {
@@ -1426,6 +1430,250 @@ done:
     return err;
 }
 
+/**
+ * struct cn_lookup_batch_ent - per-key descent state for a batched lookup
+ * @node:        node at which the key is to be searched next
+ * @spill_hash:  hash used to route the key to a child node
+ * @idx:         index of the key in the caller's vectors
+ * @first:       true until the key has been routed out of the root
+ * @pfx_hashing: true while the key is routed by its prefix hash
+ * @kdisc:       key discriminator
+ */
+struct cn_lookup_batch_ent {
+    struct cn_tree_node *node;
+    u64                  spill_hash;
+    u32                  idx;
+    bool                 first;
+    bool                 pfx_hashing;
+    struct key_disc      kdisc;
+};
+
+/* Sort pending batch entries by node so that keys routed to the same
+ * node are adjacent.  Batches are small, so insertion sort suffices.
+ */
+static void
+cn_lookup_batch_sort(struct cn_lookup_batch_ent **entv, uint entc)
+{
+    uint i, j;
+
+    for (i = 1; i < entc; ++i) {
+        struct cn_lookup_batch_ent *ent = entv[i];
+
+        for (j = i; j > 0 && entv[j - 1]->node > ent->node; --j)
+            entv[j] = entv[j - 1];
+
+        entv[j] = ent;
+    }
+}
+
+/**
+ * cn_tree_lookup_batch() - search cn tree for a batch of keys
+ * @tree: cn tree
+ * @pc:   perf counters
+ * @cnt:  number of keys in @ktv (at most %CN_LOOKUP_BATCH_MAX)
+ * @ktv:  vector of keys to search for
+ * @seq:  view sequence number
+ * @resv: (in/out) vector of results
+ * @vbufv: (output) vector of values
+ *
+ * Only keys whose result is %NOT_FOUND on entry are searched.  The tree
+ * is descended level by level for all keys at once: keys are grouped by
+ * the node to which they are routed, and each node's kvset list is walked
+ * once per group, probing all the keys of the group against a kvset in a
+ * single kvset_lookupv() call before moving on to the next (older) kvset.
+ * Each key thus still sees kvsets in newest to oldest order, but the tree
+ * lock is acquired once and kvset metadata (blooms in particular) is
+ * touched back to back for all keys.
+ *
+ * Routing follows the same rules as cn_tree_lookup().
+ */
+merr_t
+cn_tree_lookup_batch(
+    struct cn_tree *     tree,
+    struct perfc_set *   pc,
+    u32                  cnt,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv)
+{
+    struct cn_lookup_batch_ent  entv[CN_LOOKUP_BATCH_MAX];
+    struct cn_lookup_batch_ent *pendv[CN_LOOKUP_BATCH_MAX];
+    struct cn_lookup_batch_ent *grpv[CN_LOOKUP_BATCH_MAX];
+    struct kvset_lookup_req     reqv[CN_LOOKUP_BATCH_MAX];
+    struct cn_khashmap *        khashmap;
+    void *                      lock;
+    uint                        entc, pendc, depth, nkvset, nkblk;
+    uint                        i, j, k;
+    u32                         shift;
+    u64                         pc_start;
+
+    if (ev(cnt > CN_LOOKUP_BATCH_MAX))
+        return merr(EINVAL);
+
+    pc_start = perfc_lat_start(pc);
+    if (pc_start == 0)
+        pc = NULL;
+
+    shift = tree->ct_fanout_bits;
+    khashmap = tree->ct_khashmap;
+    if (khashmap) {
+        shift = CN_KHASHMAP_SHIFT;
+        __builtin_prefetch(khashmap);
+    }
+
+    pendc = 0;
+
+    for (i = 0; i < cnt; ++i) {
+        struct cn_lookup_batch_ent *ent;
+        struct kvs_ktuple *         kt = ktv + i;
+
+        if (resv[i] != NOT_FOUND)
+            continue;
+
+        ent = entv + pendc;
+        pendv[pendc++] = ent;
+
+        ent->node = tree->ct_root;
+        ent->spill_hash = 0;
+        ent->idx = i;
+        ent->first = true;
+        ent->pfx_hashing = kt->kt_len > tree->ct_pfx_len && ent->node->tn_pfx_spill;
+
+        key_disc_init(kt->kt_data, kt->kt_len, &ent->kdisc);
+    }
+
+    entc = pendc;
+    depth = nkvset = nkblk = 0;
+
+    rmlock_rlock(&tree->ct_lock, &lock);
+    while (pendc > 0) {
+        struct cn_tree_node *node;
+
+        cn_lookup_batch_sort(pendv, pendc);
+
+        /* Walk each node's kvsets once for all the keys routed to it.
+         * Keys are removed from the group as soon as they are resolved.
+         */
+        for (i = 0; i < pendc; i = j) {
+            struct kvset_list_entry *le;
+            uint                     live;
+
+            node = pendv[i]->node;
+            live = 0;
+
+            for (j = i; j < pendc && pendv[j]->node == node; ++j) {
+                struct cn_lookup_batch_ent *ent = pendv[j];
+                u32                         idx = ent->idx;
+
+                reqv[live].kt = ktv + idx;
+                reqv[live].kdisc = &ent->kdisc;
+                reqv[live].res = resv + idx;
+                reqv[live].vbuf = vbufv + idx;
+                grpv[live++] = ent;
+            }
+
+            list_for_each_entry (le, &node->tn_kvset_list, le_link) {
+                struct kvset *kvset = le->le_kvset;
+                merr_t        err;
+                uint          n;
+
+                if (le->le_link.next != &node->tn_kvset_list)
+                    __builtin_prefetch(list_next_entry(le, le_link)->le_kvset);
+
+                ++nkvset;
+
+                err = kvset_lookupv(kvset, live, reqv, seq, &nkblk);
+                if (ev(err)) {
+                    rmlock_runlock(lock);
+                    return err;
+                }
+
+                /* Drop the keys resolved by this kvset from the group.
+                 */
+                for (k = n = 0; k < live; ++k) {
+                    if (*reqv[k].res != NOT_FOUND) {
+                        grpv[k]->node = NULL;
+                        continue;
+                    }
+
+                    reqv[n] = reqv[k];
+                    grpv[n++] = grpv[k];
+                }
+
+                live = n;
+                if (live == 0)
+                    break;
+            }
+        }
+
+        if (depth > 0)
+            rmlock_yield(&tree->ct_lock, &lock);
+
+        /* Route each unresolved key to its child, see cn_tree_lookup().
+         */
+        for (i = j = 0; i < pendc; ++i) {
+            struct cn_lookup_batch_ent *ent = pendv[i];
+            struct kvs_ktuple *         kt = ktv + ent->idx;
+            u32                         child;
+
+            node = ent->node;
+            if (!node)
+                continue;
+
+            if (ent->first && ent->pfx_hashing) {
+                ent->spill_hash = key_hash64(kt->kt_data, tree->ct_pfx_len);
+                ent->first = false;
+            } else if (ent->first || (ent->pfx_hashing && !node->tn_pfx_spill)) {
+                ent->pfx_hashing = false;
+                ent->first = false;
+
+                if (!tree->ct_sfx_len) {
+                    if (!kt->kt_hash)
+                        kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len);
+
+                    ent->spill_hash = kt->kt_hash;
+                } else {
+                    ent->spill_hash = key_hash64(kt->kt_data, kt->kt_len - tree->ct_sfx_len);
+                }
+            }
+
+            child = khashmap2child(khashmap, ent->spill_hash, shift, depth);
+            child &= tree->ct_fanout_mask;
+
+            ent->node = node->tn_childv[child];
+            if (ent->node) {
+                __builtin_prefetch(ent->node);
+                pendv[j++] = ent;
+            }
+        }
+
+        pendc = j;
+        ++depth;
+    }
+    rmlock_runlock(lock);
+
+    if (pc) {
+        perfc_lat_record(pc, PERFC_LT_CNGET_GET_BATCH, pc_start);
+        perfc_rec_sample(pc, PERFC_DI_CNGET_DEPTH, depth);
+        perfc_rec_sample(pc, PERFC_DI_CNGET_NKVSET, nkvset);
+        perfc_rec_sample(pc, PERFC_DI_CNGET_NKBLK, nkblk);
+
+        for (i = 0; i < entc; ++i) {
+            enum key_lookup_res res = resv[entv[i].idx];
+
+            perfc_inc(pc, PERFC_RA_CNGET_GET);
+
+            if (res == NOT_FOUND)
+                perfc_inc(pc, PERFC_RA_CNGET_MISS);
+            else if (res == FOUND_TMB)
+                perfc_inc(pc, PERFC_RA_CNGET_TOMB);
+        }
+    }
+
+    return 0;
+}
+
 u64
 cn_tree_initial_dgen(const struct cn_tree *tree)
 {
@@ -1687,6 +1935,77 @@ cn_tree_capped_compact(struct cn_tree *tree)
     }
 }
 
+u64
+cn_compact_rtomb_seq(struct cn_compaction_work *w, const struct key_obj *kobj)
+{
+    u8   kdata[HSE_KVS_KLEN_MAX];
+    uint klen, i;
+    u64  seq = 0;
+
+    if (!w->cw_rtombv)
+        return 0;
+
+    key_obj_copy(kdata, sizeof(kdata), &klen, kobj);
+
+    for (i = 0; i < w->cw_kvset_cnt; ++i) {
+        u64 rt_seq = rtomb_list_seq(w->cw_rtombv[i], -1, kdata, klen, w->cw_horizon);
+
+        seq = max_t(u64, seq, rt_seq);
+    }
+
+    return seq;
+}
+
+/* Compaction I/O is charged to the maintenance token bucket in chunks of
+ * at least this many bytes to keep the bucket's lock off the merge loop.
+ */
+#define CN_COMPACT_IO_CHUNK (1ul << 20)
+
+void
+cn_compact_io_charge(struct cn_compaction_work *w, bool final)
+{
+    const struct cn_merge_stats *ms = &w->cw_stats;
+    u64                          total, delta;
+
+    if (!w->cw_tbkt)
+        return;
+
+    total = ms->ms_kblk_read.op_size + ms->ms_vblk_read1.op_size + ms->ms_vblk_read2.op_size +
+            ms->ms_kblk_write.op_size + ms->ms_vblk_write.op_size;
+
+    delta = total - w->cw_io_charged;
+    if (delta < CN_COMPACT_IO_CHUNK && !final)
+        return;
+
+    w->cw_io_charged = total;
+
+    tbkt_delay(tbkt_request(w->cw_tbkt, delta));
+}
+
+merr_t
+cn_compact_rtombs_add(struct cn_compaction_work *w, struct kvset_builder *bld, bool drop)
+{
+    const struct rtomb *rt;
+    merr_t              err;
+    uint                i;
+
+    if (!w->cw_rtombv)
+        return 0;
+
+    for (i = 0; i < w->cw_kvset_cnt; ++i) {
+        for (rt = w->cw_rtombv[i]; rt; rt = rt->rt_next) {
+            if (drop && rt->rt_seq <= w->cw_horizon)
+                continue;
+
+            err = kvset_builder_add_rtomb(bld, rt);
+            if (ev(err))
+                return err;
+        }
+    }
+
+    return 0;
+}
+
 merr_t
 cn_tree_prepare_compaction(struct cn_compaction_work *w)
 {
@@ -1698,6 +2017,8 @@ cn_tree_prepare_compaction(struct cn_compaction_work *w)
     u32                      n_outs;
     u32                      fanout;
     bool *                   drop_tombs = 0;
+    const struct rtomb **    rtombv = 0;
+    bool                     have_rtombs = false;
     struct kvset_mblocks *   outs = 0;
     struct kvset_vblk_map    vbm = {};
     bool                     oldest;
@@ -1713,8 +2034,9 @@ cn_tree_prepare_compaction(struct cn_compaction_work *w)
     ins = calloc(w->cw_kvset_cnt, sizeof(*ins));
     outs = calloc(n_outs, sizeof(*outs));
     drop_tombs = calloc(n_outs, sizeof(*drop_tombs));
+    rtombv = calloc(w->cw_kvset_cnt, sizeof(*rtombv));
 
-    if (ev(!ins || !drop_tombs || !outs)) {
+    if (ev(!ins || !drop_tombs || !outs || !rtombv)) {
         err = merr(ENOMEM);
         goto err_exit;
     }
@@ -1745,13 +2067,23 @@ cn_tree_prepare_compaction(struct cn_compaction_work *w)
          */
         kvset_get_ref(le->le_kvset);
 
-        err = kvset_iter_create(
-            le->le_kvset, w->cw_io_workq, vra_wq, w->cw_pc, w->cw_iter_flags, iter);
+        err = kvset_iter_create(le->le_kvset, vra_wq, w->cw_pc, w->cw_iter_flags, iter);
         if (ev(err)) {
             kvset_put_ref(le->le_kvset);
             goto err_exit;
         }
         kvset_iter_set_stats(*iter, &w->cw_stats);
+
+        /* The iterator's kvset reference keeps the rtombs valid.
+         */
+        rtombv[w->cw_kvset_cnt - 1 - i] = kvset_rtombs(le->le_kvset);
+        if (rtombv[w->cw_kvset_cnt - 1 - i])
+            have_rtombs = true;
+    }
+
+    if (!have_rtombs) {
+        free(rtombv);
+        rtombv = NULL;
     }
 
     /* k-compaction keeps all the vblocks from the source kvsets
@@ -1792,6 +2124,7 @@ cn_tree_prepare_compaction(struct cn_compaction_work *w)
     w->cw_outv = outs;
     w->cw_vbmap = vbm;
     w->cw_drop_tombv = drop_tombs;
+    w->cw_rtombv = rtombv;
     w->cw_hash_shift = 0;
 
     if (n_outs > 1) {
@@ -1814,6 +2147,7 @@ err_exit:
         free(vbm.vbm_blkv);
     }
     free(drop_tombs);
+    free(rtombv);
     free(outs);
 
     return err;
@@ -1845,6 +2179,17 @@ cn_kv_cmp(const void *a_blob, const void *b_blob)
     return key_obj_cmp(&a->kobj, &b->kobj);
 }
 
+/* Key head for the forward merge.  The reverse comparator orders ptombs
+ * ahead of the keys they cover, which a head cannot express.
+ */
+static u64
+cn_kv_head(const void *blob)
+{
+    const struct cn_kv_item *item = blob;
+
+    return key_obj_head64(&item->kobj);
+}
+
 /*
  * Max heap comparator with a caveat: A ptomb sorts before all keys w/ matching
  * prefix.
@@ -1895,11 +2240,63 @@ kvstart_put_ref(void *arg)
 merr_t
 cn_tree_cursor_active_kvsets(struct pscan *cur, u32 *active, u32 *total)
 {
-    *active = bin_heap2_width(cur->bh);
+    *active = loser_tree_width(cur->lt);
     *total = cur->iterc;
     return 0;
 }
 
+/* Remember (and hold a reference on) a kvset whose range tombstones
+ * must be applied to the keys read by the cursor.
+ */
+static merr_t
+cn_tree_cursor_rtks_add(struct pscan *cur, struct kvset *ks)
+{
+    if (cur->rtksc >= cur->rtksmax) {
+        struct kvset **rtksv;
+        u32            rtksmax = cur->rtksmax ? cur->rtksmax * 2 : 8;
+
+        rtksv = realloc(cur->rtksv, rtksmax * sizeof(*rtksv));
+        if (ev(!rtksv))
+            return merr(ENOMEM);
+
+        cur->rtksv = rtksv;
+        cur->rtksmax = rtksmax;
+    }
+
+    kvset_get_ref(ks);
+    cur->rtksv[cur->rtksc++] = ks;
+
+    return 0;
+}
+
+static void
+cn_tree_cursor_rtks_release(struct pscan *cur)
+{
+    while (cur->rtksc > 0)
+        kvset_put_ref(cur->rtksv[--cur->rtksc]);
+}
+
+/* Return the seqno of the newest visible range tombstone that covers
+ * the given key, or zero if there is none.
+ */
+static u64
+cn_tree_cursor_rtomb_seq(struct pscan *cur, const struct key_obj *kobj)
+{
+    u8   kdata[HSE_KVS_KLEN_MAX];
+    uint klen, i;
+    u64  seq = 0;
+
+    key_obj_copy(kdata, sizeof(kdata), &klen, kobj);
+
+    for (i = 0; i < cur->rtksc; ++i) {
+        u64 rt_seq = rtomb_list_seq(kvset_rtombs(cur->rtksv[i]), -1, kdata, klen, cur->seqno);
+
+        seq = max_t(u64, seq, rt_seq);
+    }
+
+    return seq;
+}
+
 merr_t
 cn_tree_cursor_create(struct pscan *cur, struct cn_tree *tree)
 {
@@ -1956,7 +2353,7 @@ cn_tree_cursor_create(struct pscan *cur, struct cn_tree *tree)
      *
      * We must collect these pointers first, since we
      * need to police the set prior to creating iterators
-     * and bin_heap_create requires a vector + len.
+     * and loser_tree_create requires a vector + len.
      *
      * The logic for descending the tree is similar to the logic
      * cn_tree_lookup().
@@ -1997,8 +2394,23 @@ cn_tree_cursor_create(struct pscan *cur, struct cn_tree *tree)
              */
             pt_start = kvset_pt_start(kvset);
 
+            /* Range tombstones apply to keys in all older kvsets,
+             * even if this kvset doesn't otherwise participate.
+             */
+            if (kvset_rtombs(kvset)) {
+                err = cn_tree_cursor_rtks_add(cur, kvset);
+                if (ev(err))
+                    break;
+            }
+
             /* check if key lies within this kvset's range */
             start = kvset_kblk_start(kvset, cur->pfx, -cur->pfx_len, cur->reverse);
+
+            /* and if so, whether the blooms rule out the prefix */
+            if (start >= 0 && cur->pfx_len > 0 &&
+                !kvset_pfx_plausible(kvset, cur->pfx, cur->pfx_len))
+                start = KVSET_MISS_KEY_TOO_SMALL;
+
             if (start < 0 && pt_start < 0)
                 continue;
 
@@ -2102,7 +2514,7 @@ cn_tree_cursor_create(struct pscan *cur, struct cn_tree *tree)
         struct kv_iterator *p;
         struct kvset *      ks = s->view.kvset;
 
-        err = kvset_iter_create(ks, NULL, vra_wq, NULL, flags, &p);
+        err = kvset_iter_create(ks, vra_wq, NULL, flags, &p);
         if (ev(err))
             goto errout;
 
@@ -2129,11 +2541,14 @@ cn_tree_cursor_create(struct pscan *cur, struct cn_tree *tree)
         ++cur->iterc;
     }
 
-    err = bin_heap2_create(cur->iterc, cur->reverse ? cn_kv_cmp_rev : cn_kv_cmp, &cur->bh);
+    if (cur->reverse)
+        err = loser_tree_create(cur->iterc, cn_kv_cmp_rev, NULL, &cur->lt);
+    else
+        err = loser_tree_create(cur->iterc, cn_kv_cmp, cn_kv_head, &cur->lt);
     if (ev(err))
         goto errout;
 
-    err = bin_heap2_prepare(cur->bh, cur->iterc, cur->esrcv);
+    err = loser_tree_prepare(cur->lt, cur->iterc, cur->esrcv);
     if (ev(err))
         goto errout;
 
@@ -2175,8 +2590,8 @@ cn_tree_capped_cursor_update(struct pscan *cur, struct cn_tree *tree)
         return 0;
     }
 
-    bin_heap2_destroy(cur->bh);
-    cur->bh = NULL;
+    loser_tree_destroy(cur->lt);
+    cur->lt = NULL;
     cur->eof = 0;
 
     old_cnt = new_cnt = 0;
@@ -2291,7 +2706,7 @@ cn_tree_capped_cursor_update(struct pscan *cur, struct cn_tree *tree)
         struct kv_iterator *iter;
         struct kvset *      ks = s->view.kvset;
 
-        err = kvset_iter_create(ks, NULL, vra_wq, NULL, flags, &iter);
+        err = kvset_iter_create(ks, vra_wq, NULL, flags, &iter);
         if (ev(err))
             break;
 
@@ -2329,11 +2744,11 @@ cn_tree_capped_cursor_update(struct pscan *cur, struct cn_tree *tree)
 
 done:
     cur->iterc = iterc;
-    err = bin_heap2_create(cur->iterc, cn_kv_cmp, &cur->bh);
+    err = loser_tree_create(cur->iterc, cn_kv_cmp, cn_kv_head, &cur->lt);
     if (ev(err))
         goto errout;
 
-    err = bin_heap2_prepare(cur->bh, cur->iterc, cur->esrcv);
+    err = loser_tree_prepare(cur->lt, cur->iterc, cur->esrcv);
     if (ev(err))
         goto errout;
 
@@ -2369,13 +2784,14 @@ cn_tree_cursor_update(struct pscan *cur, struct cn_tree *tree)
         return cn_tree_capped_cursor_update(cur, tree);
 
     kvset_iterv_release(cur->iterc, cur->iterv, cn_get_maint_wq(cur->cn));
-    bin_heap2_destroy(cur->bh);
+    loser_tree_destroy(cur->lt);
+    cn_tree_cursor_rtks_release(cur);
 
     /* Note that we intentionally preserve the iterv and esrcv
      * buffers for reuse by cn_tree_cursor_create().
      */
     cur->iterc = 0;
-    cur->bh = NULL;
+    cur->lt = NULL;
     cur->eof = 0;
 
     return cn_tree_cursor_create(cur, tree);
@@ -2388,8 +2804,13 @@ void
 cn_tree_cursor_destroy(struct pscan *cur)
 {
     kvset_iterv_release(cur->iterc, cur->iterv, cn_get_maint_wq(cur->cn));
-    bin_heap2_destroy(cur->bh);
-    cur->bh = 0;
+    loser_tree_destroy(cur->lt);
+    cur->lt = 0;
+
+    cn_tree_cursor_rtks_release(cur);
+    free(cur->rtksv);
+    cur->rtksv = 0;
+    cur->rtksmax = 0;
 
     free(cur->iterv);
     free(cur->esrcv);
@@ -2407,7 +2828,7 @@ drop_dups(struct pscan *cur, struct cn_kv_item *item)
 {
     struct cn_kv_item *dup;
 
-    while (bin_heap2_peek(cur->bh, (void **)&dup)) {
+    while (loser_tree_peek(cur->lt, (void **)&dup)) {
 
         if (key_obj_cmp(&dup->kobj, &item->kobj))
             return;
@@ -2418,7 +2839,7 @@ drop_dups(struct pscan *cur, struct cn_kv_item *item)
         if (dup->vctx.is_ptomb)
             return;
 
-        bin_heap2_pop(cur->bh, (void **)&dup);
+        loser_tree_pop(cur->lt, (void **)&dup);
     }
 }
 
@@ -2473,6 +2894,7 @@ cn_tree_cursor_read(struct pscan *cur, struct kvs_kvtuple *kvt, bool *eof)
     const void *        vdata;
     uint                vlen;
     uint                complen;
+    uint                codec;
     uint                klen;
     int                 rc;
     struct kv_iterator *kv_iter = 0;
@@ -2491,18 +2913,18 @@ cn_tree_cursor_read(struct pscan *cur, struct kvs_kvtuple *kvt, bool *eof)
 
     do {
 
-        if (!bin_heap2_peek(cur->bh, (void **)&popme)) {
+        if (!loser_tree_peek(cur->lt, (void **)&popme)) {
             *eof = (cur->eof = 1);
             return 0;
         }
 
-        /* copy out bh item before bin_heap2_pop() overwrites its
+        /* copy out bh item before loser_tree_pop() overwrites its
          * element (*popme).
          */
         item = *popme;
         is_tomb = item.vctx.is_ptomb;
 
-        bin_heap2_pop(cur->bh, (void **)&popme);
+        loser_tree_pop(cur->lt, (void **)&popme);
 
         rc = cur_item_cmp(cur, &item);
         if (rc > 0) {
@@ -2530,7 +2952,7 @@ cn_tree_cursor_read(struct pscan *cur, struct kvs_kvtuple *kvt, bool *eof)
 
             if (!kvset_iter_next_vref(
                     kv_iter, &item.vctx, &seq, &vtype, &vbidx,
-                    &vboff, &vdata, &vlen, &complen)) {
+                    &vboff, &vdata, &vlen, &complen, &codec)) {
                 end = true;
                 break;
             }
@@ -2579,6 +3001,14 @@ cn_tree_cursor_read(struct pscan *cur, struct kvs_kvtuple *kvt, bool *eof)
             }
         }
 
+        /* Older versions of a key hidden by a range tombstone are
+         * also hidden, hence there's no need to drop dups here.
+         */
+        if (!end && !is_tomb && cur->rtksc > 0 && !HSE_CORE_IS_PTOMB(vdata)) {
+            if (cn_tree_cursor_rtomb_seq(cur, &item.kobj) > seq)
+                end = true;
+        }
+
     } while (end || is_tomb);
 
     assert(!HSE_CORE_IS_TOMB(vdata));
@@ -2591,10 +3021,9 @@ cn_tree_cursor_read(struct pscan *cur, struct kvs_kvtuple *kvt, bool *eof)
     kvs_vtuple_init(&kvt->kvt_value, cur->buf + kvt->kvt_key.kt_len, vlen);
 
     if (complen) {
-        extern struct compress_ops compress_lz4_ops;
         uint len_check;
 
-        cur->merr = compress_lz4_ops.cop_decompress(vdata, complen,
+        cur->merr = compress_codec_decompress(codec, vdata, complen,
             kvt->kvt_value.vt_data, vlen, &len_check);
         if (ev(cur->merr))
             return cur->merr;
@@ -2694,8 +3123,8 @@ cn_tree_cursor_seek(
      * If we have a problem here, the cursor becomes invalid,
      * and cannot be reused.  Only recovery is to destroy it.
      */
-    cur->merr = bin_heap2_prepare(cur->bh, cur->iterc, cur->esrcv);
-    perfc_set(pc, PERFC_BA_CNCAPPED_ACTIVE, (10000 * bin_heap2_width(cur->bh)) / cur->iterc);
+    cur->merr = loser_tree_prepare(cur->lt, cur->iterc, cur->esrcv);
+    perfc_set(pc, PERFC_BA_CNCAPPED_ACTIVE, (10000 * loser_tree_width(cur->lt)) / cur->iterc);
 
     /*
      * If asked for what we found, return the key here.
@@ -2708,7 +3137,7 @@ cn_tree_cursor_seek(
         struct cn_kv_item *i = &item;
 
         kt->kt_len = 0;
-        if (bin_heap2_peek(cur->bh, (void **)&i)) {
+        if (loser_tree_peek(cur->lt, (void **)&i)) {
             uint len;
 
             kt->kt_data = key_obj_copy(cur->buf, cur->bufsz, &len, &i->kobj);
@@ -3107,6 +3536,21 @@ cn_comp_commit(struct cn_compaction_work *w)
             goto done;
     }
 
+    /* A compacted kvset inherits the heat of its inputs so that it
+     * is not mistaken for cold data before it has been read.
+     */
+    if (!spill && kvsets[0]) {
+        struct kvset_list_entry *le = w->cw_mark;
+        u64                      heat = 0;
+
+        for (i = 0; i < w->cw_kvset_cnt; i++) {
+            heat += kvset_get_heat(le->le_kvset);
+            le = list_prev_entry(le, le_link);
+        }
+
+        kvset_set_heat(kvsets[0], heat);
+    }
+
     if (spill)
         w->cw_err = cn_comp_commit_spill(w, kvsets);
     else
@@ -3242,6 +3686,8 @@ cn_comp_compact(struct cn_compaction_work *w)
 
     w->cw_horizon = cn_get_seqno_horizon(w->cw_tree->cn);
     w->cw_cancel_request = cn_get_cancel(w->cw_tree->cn);
+    w->cw_tbkt = cn_get_tbkt_maint(w->cw_tree->cn);
+    w->cw_io_charged = 0;
 
     perfc_inc(w->cw_pc, PERFC_BA_CNCOMP_START);
 
@@ -3290,6 +3736,11 @@ cn_comp_compact(struct cn_compaction_work *w)
         ingestsz += w->cw_stats.ms_val_bytes_out;
     }
 
+    /* Charge the I/O not yet accounted for by the merge loop,
+     * notably the builders' final kblock and vblock writes.
+     */
+    cn_compact_io_charge(w, true);
+
     if (merr_errno(err) == ESHUTDOWN && atomic_read(w->cw_cancel_request))
         w->cw_canceled = true;
 
@@ -3299,6 +3750,7 @@ cn_comp_compact(struct cn_compaction_work *w)
             w->cw_inputv[i]->kvi_ops->kvi_release(w->cw_inputv[i]);
     free(w->cw_inputv);
     free(w->cw_drop_tombv);
+    free(w->cw_rtombv);
     if (ev(err)) {
         if (!w->cw_canceled)
             kvdb_health_error(hp, err);
@@ -59,6 +59,20 @@ cn_tree_lookup(
     struct kvs_buf *     kbuf,
     struct kvs_buf *     vbuf);
 
+/* Max number of keys searched by one call to cn_tree_lookup_batch() */
+#define CN_LOOKUP_BATCH_MAX 64
+
+/* MTF_MOCK */
+merr_t
+cn_tree_lookup_batch(
+    struct cn_tree *     tree,
+    struct perfc_set *   pc,
+    u32                  cnt,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv);
+
 /**
  * cn_tree_initial_dgen() - return most current dgen in tree
  * @tree: tree to query
@@ -25,6 +25,10 @@ struct kv_iterator;
 struct kvset_list_entry;
 struct kvset_mblocks;
 struct kvset;
+struct kvset_builder;
+struct rtomb;
+struct key_obj;
+struct tbkt;
 
 enum cn_action {
     CN_ACTION_NONE = 0,
@@ -48,6 +52,8 @@ enum cn_comp_rule {
     CN_CR_LSHORT_IDLE,    /* short leaf, idle */
     CN_CR_LSHORT_IDLE_VG, /* short leaf, idle, vblk groups */
     CN_CR_LSCATTER,       /* leaf vblk scatter */
+    CN_CR_LHEAT,          /* leaf vblks on the wrong media for their heat */
+    CN_CR_LEXPIRED,       /* leaf with many expired values */
     CN_CR_END,
 };
 
@@ -104,6 +110,10 @@ cn_comp_rule2str(enum cn_comp_rule rule)
             return "idle_vg";
         case CN_CR_LSCATTER:
             return "scatter";
+        case CN_CR_LHEAT:
+            return "heat";
+        case CN_CR_LEXPIRED:
+            return "expired";
     }
 
     return "unknown_rule";
@@ -142,8 +152,12 @@ struct cn_work_est {
  *                       tree is being updated with this work
  * @cw_dgen_hi:      the dgen of the newest kvset to be compacted
  * @cw_dgen_lo:      the dgen of the oldest kvset to be compacted
+ * @cw_tempv:        read heat of each output (see hse_mclass_policy_temp),
+ *                       which steers its media class placement
  * @cw_active_count: for tracking the number of active "root" or "other" threads
  * @cw_horizon:      sequence number horizon to use while compacting
+ * @cw_tbkt:         token bucket charged with the work's mblock I/O (or NULL)
+ * @cw_io_charged:   bytes of mblock I/O charged to cw_tbkt so far
  * @cw_debug:        enables debug stats
  * @cw_outc:         number of output kvsets
  * @cw_outv:         outputs (mblock ids used to make output kvsets)
@@ -152,6 +166,7 @@ struct cn_work_est {
  *                       kvsets during k-compaction
  * @cw_hash_shift:   used to determine output child when spilling
  * @cw_drop_tombv:   if true, then tombstones can be dropped in the merge loop
+ * @cw_rtombv:       range tombstones of each input kvset (NULL if none)
  * @cw_work_txid:    the cndb transaction id
  * @cw_commitc:      keeps track of how many output mblocks have been committed
  * @cw_keep_vblks:   indicates whether or not vblocks should be deleted or
@@ -175,9 +190,10 @@ struct cn_compaction_work {
     uint                     cw_debug;
     bool                     cw_canceled;
     merr_t                   cw_err;
-    struct workqueue_struct *cw_io_workq;
     struct perfc_set *       cw_pc;
     atomic_t *               cw_cancel_request;
+    struct tbkt *            cw_tbkt;
+    u64                      cw_io_charged;
     struct mpool *           cw_ds;
     struct kvs_rparams *     cw_rp;
     struct kvs_cparams *     cw_cp;
@@ -202,6 +218,7 @@ struct cn_compaction_work {
     u64                      cw_dgen_hi;
     u64                      cw_dgen_lo;
     atomic_t *               cw_bonus;
+    u8                       cw_tempv[CN_FANOUT_MAX];
 
     /* For scheduler */
     struct sts_job        cw_job;
@@ -225,6 +242,7 @@ struct cn_compaction_work {
     struct kvset_vblk_map cw_vbmap;
     u32                   cw_hash_shift;
     bool *                cw_drop_tombv;
+    const struct rtomb ** cw_rtombv;
 
     /* initialized in cn_compaction_worker() */
     u64                   cw_work_txid;
@@ -255,6 +273,40 @@ cn_tree_ingest_update(
 void
 cn_tree_capped_compact(struct cn_tree *tree);
 
+/**
+ * cn_compact_rtomb_seq() - find the newest input rtomb that covers a key
+ * @w:    compaction work
+ * @kobj: key
+ *
+ * Only rtombs at or below the horizon are considered, as only they may
+ * be used to discard the keys they cover.
+ *
+ * Return: the seqno of the rtomb, or zero if there is none.
+ */
+u64
+cn_compact_rtomb_seq(struct cn_compaction_work *w, const struct key_obj *kobj);
+
+/**
+ * cn_compact_io_charge() - charge compaction I/O to the maintenance token bucket
+ * @w:     compaction work
+ * @final: if true, charge any remaining I/O regardless of its size
+ *
+ * Charges the mblock bytes read and written by @w since the previous call
+ * (as recorded in w->cw_stats) and delays the caller as needed to respect
+ * the bucket's rate.  Small amounts are accumulated and charged in chunks.
+ */
+void
+cn_compact_io_charge(struct cn_compaction_work *w, bool final);
+
+/**
+ * cn_compact_rtombs_add() - add the input rtombs to an output kvset
+ * @w:    compaction work
+ * @bld:  output kvset builder
+ * @drop: if true, drop the rtombs at or below the horizon
+ */
+merr_t
+cn_compact_rtombs_add(struct cn_compaction_work *w, struct kvset_builder *bld, bool drop);
+
 /* MTF_MOCK */
 bool
 cn_node_comp_token_get(struct cn_tree_node *tn);
@@ -0,0 +1,478 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#define MTF_MOCK_IMPL_cn_vcache
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/atomic.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/list.h>
+#include <hse_util/log2.h>
+#include <hse_util/minmax.h>
+#include <hse_util/perfc.h>
+#include <hse_util/spinlock.h>
+
+#include <hse/kvdb_perfc.h>
+
+#include "cn_vcache.h"
+#include "cn_perfc.h"
+
+/*
+ * The value cache is split into a fixed number of shards, each with its
+ * own lock, hash table, byte budget, and CLOCK ring.  The shard and hash
+ * bucket are both derived from a single 64-bit hash of (mbid, off).
+ *
+ * Eviction is CLOCK (second chance): entries are appended to the tail of
+ * the shard's ring and a lookup hit merely sets the entry's reference
+ * bit.  When room is needed the hand sweeps from the head of the ring,
+ * recycling referenced entries to the tail (clearing their bit) and
+ * evicting the first unreferenced entry it finds.
+ *
+ * Values may be large (up to HSE_KVS_VLEN_MAX), so they are copied out
+ * without holding the shard lock.  Each entry is reference counted: the
+ * cache holds one reference while the entry is linked and each reader
+ * holds one for the duration of its copy.
+ *
+ * Each shard also indexes its entries by vblock id, via a second hash
+ * table of per-vblock entry lists, so that retiring a vblock visits only
+ * that vblock's entries rather than sweeping the whole cache.
+ */
+
+#define CN_VCACHE_SHARDS_SHIFT  (4)
+#define CN_VCACHE_SHARDS        (1u << CN_VCACHE_SHARDS_SHIFT)
+#define CN_VCACHE_SHARD_SZ_MIN  (1024 * 1024)
+#define CN_VCACHE_AVG_VLEN      (4096)
+
+struct cn_vcache_vblk {
+    struct cn_vcache_vblk *cvb_hnext;
+    u64                    cvb_mbid;
+    struct list_head       cvb_ents;
+};
+
+struct cn_vcache_ent {
+    struct cn_vcache_ent * cve_hnext;
+    struct list_head       cve_clink;
+    struct list_head       cve_vlink;
+    struct cn_vcache_vblk *cve_vblk;
+    u64                    cve_mbid;
+    u64                    cve_off;
+    atomic_t               cve_refcnt;
+    uint                   cve_len;
+    bool                   cve_ref;
+    char                   cve_data[];
+};
+
+struct cn_vcache_shard {
+    spinlock_t             cvs_lock;
+    size_t                 cvs_size;
+    size_t                 cvs_size_max;
+    struct list_head        cvs_clock;
+    u64                     cvs_bktmask;
+    struct cn_vcache_ent ** cvs_bktv;
+    u64                     cvs_vbktmask;
+    struct cn_vcache_vblk **cvs_vbktv;
+} __aligned(SMP_CACHE_BYTES);
+
+/* Entries and vblock records retired under a shard lock, to be freed
+ * after it is dropped.
+ */
+struct cn_vcache_reap {
+    struct list_head cvr_ents;
+    struct list_head cvr_vblks;
+};
+
+struct cn_vcache {
+    size_t                 cvc_ent_max;
+    struct perfc_set       cvc_pc;
+    struct cn_vcache_shard cvc_shardv[CN_VCACHE_SHARDS];
+};
+
+static __always_inline u64
+cn_vcache_hash(u64 mbid, u64 off)
+{
+    u64 h = (mbid * 0x9e3779b97f4a7c15ul) ^ (off + 0x632be59bd9b4e019ul);
+
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ul;
+    h ^= h >> 32;
+
+    return h;
+}
+
+static __always_inline struct cn_vcache_shard *
+cn_vcache_hash2shard(struct cn_vcache *vc, u64 hash)
+{
+    return vc->cvc_shardv + (hash >> (64 - CN_VCACHE_SHARDS_SHIFT));
+}
+
+static __always_inline struct cn_vcache_vblk **
+cn_vcache_vblk_bkt(struct cn_vcache_shard *shard, u64 mbid)
+{
+    return shard->cvs_vbktv + (cn_vcache_hash(mbid, 0) & shard->cvs_vbktmask);
+}
+
+static struct cn_vcache_vblk *
+cn_vcache_vblk_find(struct cn_vcache_shard *shard, u64 mbid)
+{
+    struct cn_vcache_vblk *vb;
+
+    for (vb = *cn_vcache_vblk_bkt(shard, mbid); vb; vb = vb->cvb_hnext) {
+        if (vb->cvb_mbid == mbid)
+            break;
+    }
+
+    return vb;
+}
+
+static __always_inline size_t
+cn_vcache_ent_size(const struct cn_vcache_ent *ent)
+{
+    return sizeof(*ent) + ent->cve_len;
+}
+
+static void
+cn_vcache_ent_put(struct cn_vcache_ent *ent)
+{
+    if (atomic_dec_return(&ent->cve_refcnt) == 0)
+        free(ent);
+}
+
+/* Unlink the given entry from its hash chain, clock ring, and vblock list,
+ * and move it onto the given reap list.  The vblock's record is reaped too
+ * once its last entry is gone.  Caller must hold the shard lock.
+ */
+static void
+cn_vcache_unlink(
+    struct cn_vcache *      vc,
+    struct cn_vcache_shard *shard,
+    struct cn_vcache_ent *  ent,
+    struct cn_vcache_reap * reap)
+{
+    struct cn_vcache_vblk * vb = ent->cve_vblk;
+    struct cn_vcache_ent ** pp;
+    struct cn_vcache_vblk **vpp;
+
+    pp = shard->cvs_bktv + (cn_vcache_hash(ent->cve_mbid, ent->cve_off) & shard->cvs_bktmask);
+
+    while (*pp != ent)
+        pp = &(*pp)->cve_hnext;
+
+    *pp = ent->cve_hnext;
+    list_del(&ent->cve_clink);
+    list_del(&ent->cve_vlink);
+    list_add_tail(&ent->cve_clink, &reap->cvr_ents);
+
+    if (list_empty(&vb->cvb_ents)) {
+        vpp = cn_vcache_vblk_bkt(shard, vb->cvb_mbid);
+
+        while (*vpp != vb)
+            vpp = &(*vpp)->cvb_hnext;
+
+        *vpp = vb->cvb_hnext;
+        list_add_tail(&vb->cvb_ents, &reap->cvr_vblks);
+    }
+
+    shard->cvs_size -= cn_vcache_ent_size(ent);
+    perfc_sub(&vc->cvc_pc, PERFC_BA_CNVCACHE_SIZE, cn_vcache_ent_size(ent));
+}
+
+/* Advance the clock hand until an unreferenced entry is found and evict it
+ * onto the given reap list.  Caller must hold the shard lock.
+ */
+static void
+cn_vcache_evict(struct cn_vcache *vc, struct cn_vcache_shard *shard, struct cn_vcache_reap *reap)
+{
+    struct cn_vcache_ent *ent;
+
+    while ((ent = list_first_entry_or_null(&shard->cvs_clock, typeof(*ent), cve_clink))) {
+        if (ent->cve_ref) {
+            ent->cve_ref = false;
+            list_del(&ent->cve_clink);
+            list_add_tail(&ent->cve_clink, &shard->cvs_clock);
+            continue;
+        }
+
+        cn_vcache_unlink(vc, shard, ent, reap);
+        perfc_inc(&vc->cvc_pc, PERFC_RA_CNVCACHE_EVICT);
+        break;
+    }
+}
+
+static void
+cn_vcache_reap_init(struct cn_vcache_reap *reap)
+{
+    INIT_LIST_HEAD(&reap->cvr_ents);
+    INIT_LIST_HEAD(&reap->cvr_vblks);
+}
+
+static void
+cn_vcache_reap(struct cn_vcache_reap *reap)
+{
+    struct cn_vcache_ent * ent, *next;
+    struct cn_vcache_vblk *vb, *vbnext;
+
+    list_for_each_entry_safe(ent, next, &reap->cvr_ents, cve_clink)
+        cn_vcache_ent_put(ent);
+
+    list_for_each_entry_safe(vb, vbnext, &reap->cvr_vblks, cvb_ents)
+        free(vb);
+
+    cn_vcache_reap_init(reap);
+}
+
+bool
+cn_vcache_lookup(struct cn_vcache *vc, u64 mbid, u64 off, void *buf, uint buflen)
+{
+    struct cn_vcache_shard *shard;
+    struct cn_vcache_ent *  ent;
+    u64                     hash;
+
+    if (!vc)
+        return false;
+
+    hash = cn_vcache_hash(mbid, off);
+    shard = cn_vcache_hash2shard(vc, hash);
+
+    spin_lock(&shard->cvs_lock);
+    for (ent = shard->cvs_bktv[hash & shard->cvs_bktmask]; ent; ent = ent->cve_hnext) {
+        if (ent->cve_mbid == mbid && ent->cve_off == off) {
+            ent->cve_ref = true;
+            atomic_inc(&ent->cve_refcnt);
+            break;
+        }
+    }
+    spin_unlock(&shard->cvs_lock);
+
+    if (!ent) {
+        perfc_inc(&vc->cvc_pc, PERFC_RA_CNVCACHE_MISS);
+        return false;
+    }
+
+    buflen = min_t(uint, buflen, ent->cve_len);
+    memcpy(buf, ent->cve_data, buflen);
+
+    cn_vcache_ent_put(ent);
+
+    perfc_inc(&vc->cvc_pc, PERFC_RA_CNVCACHE_HIT);
+    perfc_add(&vc->cvc_pc, PERFC_RA_CNVCACHE_HITB, buflen);
+
+    return true;
+}
+
+void
+cn_vcache_insert(struct cn_vcache *vc, u64 mbid, u64 off, const void *data, uint len)
+{
+    struct cn_vcache_shard *shard;
+    struct cn_vcache_ent *  ent, *dup, **pp;
+    struct cn_vcache_vblk * vb, *newvb;
+    struct cn_vcache_reap   reap;
+    u64                     hash;
+
+    if (!vc || len > vc->cvc_ent_max)
+        return;
+
+    ent = malloc(sizeof(*ent) + len);
+    if (ev(!ent))
+        return;
+
+    /* Allocate a vblock record in case this is the vblock's first
+     * cached value, so as not to call malloc with the lock held.
+     */
+    newvb = malloc(sizeof(*newvb));
+    if (ev(!newvb)) {
+        free(ent);
+        return;
+    }
+
+    ent->cve_hnext = NULL;
+    ent->cve_mbid = mbid;
+    ent->cve_off = off;
+    ent->cve_len = len;
+    ent->cve_ref = false;
+    atomic_set(&ent->cve_refcnt, 1);
+    memcpy(ent->cve_data, data, len);
+
+    hash = cn_vcache_hash(mbid, off);
+    shard = cn_vcache_hash2shard(vc, hash);
+    pp = shard->cvs_bktv + (hash & shard->cvs_bktmask);
+
+    cn_vcache_reap_init(&reap);
+
+    spin_lock(&shard->cvs_lock);
+    for (dup = *pp; dup; dup = dup->cve_hnext) {
+        if (dup->cve_mbid == mbid && dup->cve_off == off)
+            break;
+    }
+
+    if (!dup) {
+        while (shard->cvs_size + cn_vcache_ent_size(ent) > shard->cvs_size_max &&
+               !list_empty(&shard->cvs_clock))
+            cn_vcache_evict(vc, shard, &reap);
+
+        vb = cn_vcache_vblk_find(shard, mbid);
+        if (!vb) {
+            struct cn_vcache_vblk **vpp = cn_vcache_vblk_bkt(shard, mbid);
+
+            vb = newvb;
+            newvb = NULL;
+
+            vb->cvb_mbid = mbid;
+            INIT_LIST_HEAD(&vb->cvb_ents);
+            vb->cvb_hnext = *vpp;
+            *vpp = vb;
+        }
+
+        ent->cve_vblk = vb;
+        list_add_tail(&ent->cve_vlink, &vb->cvb_ents);
+
+        ent->cve_hnext = *pp;
+        *pp = ent;
+        list_add_tail(&ent->cve_clink, &shard->cvs_clock);
+
+        shard->cvs_size += cn_vcache_ent_size(ent);
+        perfc_add(&vc->cvc_pc, PERFC_BA_CNVCACHE_SIZE, cn_vcache_ent_size(ent));
+        perfc_inc(&vc->cvc_pc, PERFC_RA_CNVCACHE_INSERT);
+        ent = NULL;
+    }
+    spin_unlock(&shard->cvs_lock);
+
+    cn_vcache_reap(&reap);
+    free(newvb);
+    free(ent);
+}
+
+void
+cn_vcache_invalidate(struct cn_vcache *vc, const u64 *mbidv, uint mbidc)
+{
+    struct cn_vcache_ent * ent, *next;
+    struct cn_vcache_vblk *vb;
+    struct cn_vcache_reap  reap;
+    uint                   i, j;
+
+    if (!vc || mbidc == 0)
+        return;
+
+    cn_vcache_reap_init(&reap);
+
+    /* A reader that fetched a value from a vblock being retired may
+     * insert it after we've visited its shard.  Such an entry can never
+     * be hit again (vblock ids are never reused), so it's harmless and
+     * will be reclaimed by the clock like any other cold entry.
+     */
+    for (i = 0; i < CN_VCACHE_SHARDS; i++) {
+        struct cn_vcache_shard *shard = vc->cvc_shardv + i;
+
+        spin_lock(&shard->cvs_lock);
+        for (j = 0; j < mbidc; j++) {
+            vb = cn_vcache_vblk_find(shard, mbidv[j]);
+            if (!vb)
+                continue;
+
+            /* The vblock's record is reaped with its last entry.
+             */
+            list_for_each_entry_safe(ent, next, &vb->cvb_ents, cve_vlink)
+                cn_vcache_unlink(vc, shard, ent, &reap);
+        }
+        spin_unlock(&shard->cvs_lock);
+
+        cn_vcache_reap(&reap);
+    }
+}
+
+merr_t
+cn_vcache_create(const char *mpname, size_t size, struct cn_vcache **vcp)
+{
+    struct cn_vcache *vc;
+    size_t            shardsz, bktc, vbktc;
+    uint              i;
+
+    *vcp = NULL;
+
+    if (size == 0)
+        return 0;
+
+    shardsz = max_t(size_t, size / CN_VCACHE_SHARDS, CN_VCACHE_SHARD_SZ_MIN);
+    bktc = roundup_pow_of_two(max_t(size_t, shardsz / CN_VCACHE_AVG_VLEN, 64));
+    vbktc = bktc / 8;
+
+    vc = alloc_aligned(sizeof(*vc), SMP_CACHE_BYTES);
+    if (ev(!vc))
+        return merr(ENOMEM);
+
+    memset(vc, 0, sizeof(*vc));
+
+    /* Don't let a single value consume more than a fraction of a shard.
+     */
+    vc->cvc_ent_max = shardsz / 8;
+
+    for (i = 0; i < CN_VCACHE_SHARDS; i++) {
+        struct cn_vcache_shard *shard = vc->cvc_shardv + i;
+
+        spin_lock_init(&shard->cvs_lock);
+        INIT_LIST_HEAD(&shard->cvs_clock);
+
+        shard->cvs_bktv = calloc(bktc, sizeof(*shard->cvs_bktv));
+        shard->cvs_vbktv = calloc(vbktc, sizeof(*shard->cvs_vbktv));
+        if (ev(!shard->cvs_bktv || !shard->cvs_vbktv)) {
+            cn_vcache_destroy(vc);
+            return merr(ENOMEM);
+        }
+
+        shard->cvs_size_max = shardsz;
+        shard->cvs_bktmask = bktc - 1;
+        shard->cvs_vbktmask = vbktc - 1;
+    }
+
+    /* Not considered fatal if perfc fails */
+    perfc_ctrseti_alloc(
+        COMPNAME, mpname, cn_perfc_vcache, PERFC_EN_CNVCACHE, "vcache", &vc->cvc_pc);
+
+    *vcp = vc;
+
+    return 0;
+}
+
+void
+cn_vcache_destroy(struct cn_vcache *vc)
+{
+    struct cn_vcache_ent * ent, *next;
+    struct cn_vcache_vblk *vb;
+    uint                   i, j;
+
+    if (!vc)
+        return;
+
+    for (i = 0; i < CN_VCACHE_SHARDS; i++) {
+        struct cn_vcache_shard *shard = vc->cvc_shardv + i;
+
+        if (!shard->cvs_bktv && !shard->cvs_vbktv)
+            continue;
+
+        list_for_each_entry_safe(ent, next, &shard->cvs_clock, cve_clink) {
+            assert(atomic_read(&ent->cve_refcnt) == 1);
+            free(ent);
+        }
+
+        if (shard->cvs_vbktv) {
+            for (j = 0; j <= shard->cvs_vbktmask; j++) {
+                while ((vb = shard->cvs_vbktv[j])) {
+                    shard->cvs_vbktv[j] = vb->cvb_hnext;
+                    free(vb);
+                }
+            }
+        }
+
+        free(shard->cvs_vbktv);
+        free(shard->cvs_bktv);
+    }
+
+    perfc_ctrseti_free(&vc->cvc_pc);
+    free_aligned(vc);
+}
+
+#if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
+#include "cn_vcache_ut_impl.i"
+#endif /* HSE_UNIT_TEST_MODE */
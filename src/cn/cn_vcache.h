@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVDB_CN_VCACHE_H
+#define HSE_KVDB_CN_VCACHE_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+
+/* MTF_MOCK_DECL(cn_vcache) */
+
+struct cn_vcache;
+
+/**
+ * cn_vcache_create() - create a per-kvdb cN value cache
+ * @mpname: mpool name (used to name the perf counter set)
+ * @size:   maximum number of bytes to cache (0 disables the cache)
+ * @vcp:    (output) value cache handle, or NULL if disabled
+ *
+ * The value cache retains copies of values that kvset_lookup_val() had
+ * to read directly from media (i.e., values not served by the mcache
+ * mapping).  Entries are keyed by (vblock id, vblock offset), which
+ * uniquely identify an immutable value, so entries never need to be
+ * updated, only retired when their vblock is deleted.
+ */
+merr_t
+cn_vcache_create(const char *mpname, size_t size, struct cn_vcache **vcp);
+
+void
+cn_vcache_destroy(struct cn_vcache *vc);
+
+/**
+ * cn_vcache_lookup() - copy a cached value into the caller's buffer
+ * @vc:     value cache handle (may be NULL)
+ * @mbid:   vblock id
+ * @off:    byte offset of the value within the vblock
+ * @buf:    output buffer
+ * @buflen: number of bytes to copy out
+ *
+ * Return: true if the value was found (and copied), false otherwise.
+ */
+/* MTF_MOCK */
+bool
+cn_vcache_lookup(struct cn_vcache *vc, u64 mbid, u64 off, void *buf, uint buflen);
+
+/**
+ * cn_vcache_insert() - insert a complete value into the cache
+ * @vc:   value cache handle (may be NULL)
+ * @mbid: vblock id
+ * @off:  byte offset of the value within the vblock
+ * @data: value (uncompressed)
+ * @len:  value length
+ *
+ * Insertion is best effort; it silently fails if the value is too
+ * large or memory cannot be allocated.
+ */
+/* MTF_MOCK */
+void
+cn_vcache_insert(struct cn_vcache *vc, u64 mbid, u64 off, const void *data, uint len);
+
+/**
+ * cn_vcache_invalidate() - discard all entries for the given vblocks
+ * @vc:    value cache handle (may be NULL)
+ * @mbidv: vector of vblock ids
+ * @mbidc: number of elements in mbidv[]
+ *
+ * Visits only the entries of the given vblocks, not the whole cache.
+ */
+/* MTF_MOCK */
+void
+cn_vcache_invalidate(struct cn_vcache *vc, const u64 *mbidv, uint mbidc);
+
+#if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
+#include "cn_vcache_ut.h"
+#endif /* HSE_UNIT_TEST_MODE */
+
+#endif
@@ -810,6 +810,7 @@ cndb_import_md(struct cndb *cndb, struct cndb_hdr_omf *buf, union cndb_mtu **mtu
             .cp_pfx_len = mti->mti_prefix_len,
             .cp_sfx_len = mti->mti_sfx_len,
             .cp_pfx_pivot = mti->mti_prefix_pivot,
+            .cp_kblk_filter = (mti->mti_flags & CN_CFLAG_FUSE) ? 1 : 0,
         };
 
         err = cndb_cnv_add(
@@ -2987,6 +2988,8 @@ cndb_cn_make2(struct cndb *cndb, struct kvs_cparams *cparams, u64 *cnid_out, con
 
     if (cparams->cp_kvs_ext01)
         flags |= CN_CFLAG_CAPPED;
+    if (cparams->cp_kblk_filter)
+        flags |= CN_CFLAG_FUSE;
 
     omf_set_cninfo_flags(&info, flags);
 
@@ -14,6 +14,7 @@ struct csched_ops;
 struct cn_tree;
 struct throttle_sensor;
 struct hse_kvdb_compact_status;
+struct tbkt;
 
 struct csched_ops {
 
@@ -29,6 +30,8 @@ struct csched_ops {
 
     void (*cs_compact_status_get)(struct csched_ops *, struct hse_kvdb_compact_status *);
 
+    struct tbkt *(*cs_tbkt_maint_get)(struct csched_ops *);
+
     void (*cs_destroy)(struct csched_ops *);
 };
 
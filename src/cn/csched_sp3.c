@@ -8,6 +8,7 @@
 #include <hse_util/platform.h>
 #include <hse_util/slab.h>
 #include <hse_util/string.h>
+#include <hse_util/token_bucket.h>
 
 #include <hse_ikvdb/cn.h>
 #include <hse_ikvdb/ikvdb.h>
@@ -146,6 +147,7 @@ struct mpool;
 #define RBT_L_GARB  2 /* leaf nodes sorted by garbage */
 #define RBT_LI_LEN  3 /* internal and leaf nodes, sorted by #kvsets */
 #define RBT_L_SCAT  4 /* leaf nodes sorted by vblock scatter */
+#define RBT_L_EXP   5 /* leaf nodes sorted by pct expired */
 
 #define CSCHED_SAMP_MAX_MIN  100
 #define CSCHED_SAMP_MAX_MAX  999
@@ -157,7 +159,7 @@ struct mpool;
 #define CSCHED_LEAF_PCT_MAX  99
 
 static const char *const rbt_name[] = {
-    "ri_size", "l_size", "l_garb", "li_len", "l_scat",
+    "ri_size", "l_size", "l_garb", "li_len", "l_scat", "l_exp",
 };
 
 struct sp3_qinfo {
@@ -247,6 +249,12 @@ struct sp3 {
 
     u64 qos_prv_log;
 
+    /* Compaction I/O governor: current budget (0: unlimited), and
+     * cumulative cN get latency hits as of the previous check.
+     */
+    u64 gov_rate;
+    u64 gov_hitv[PERFC_IVL_MAX + 1];
+
     /* Tree shape report */
     u64  tree_shape_last_report;
     bool tree_shape_bad;
@@ -270,6 +278,9 @@ struct sp3 {
     struct mutex work_list_lock __aligned(SMP_CACHE_BYTES);
     struct list_head            work_list;
 
+    /* Charged by job threads with their mblock I/O */
+    struct tbkt tbkt;
+
     u64 ucomp_prev_report_ns __aligned(SMP_CACHE_BYTES);
     bool                     ucomp_active;
     bool                     ucomp_canceled;
@@ -284,6 +295,11 @@ struct sp3 {
 /* Scale of kvdb rparms */
 #define EXT_SCALE 100
 
+/* Min number of sampled cN gets per interval for the I/O governor
+ * to act on their latency.
+ */
+#define SP3_IOGOV_SAMPLES_MIN 64
+
 /* Internal scale, to get better precision with scalar math.
  * ONE is defined simply for readability in
  * expressions such as '(1 + r) / r'.
@@ -815,6 +831,14 @@ sp3_refresh_thresholds(struct sp3 *sp)
     v = sp->rp->csched_vb_scatter_pct;
     thresh.lscatter_pct = clamp_t(u64, v, 0, 100);
 
+    /* read heat settings (zero disables) */
+    thresh.heat_hot = sp->rp->csched_heat_hot;
+    thresh.heat_cold = sp->rp->csched_heat_cold;
+
+    /* expired value settings (100 disables) */
+    v = sp->rp->csched_expired_pct;
+    thresh.lexp_pct = clamp_t(u64, v, 1, 100);
+
     if (!memcmp(&thresh, &sp->thresh, sizeof(thresh)))
         return;
 
@@ -829,7 +853,9 @@ sp3_refresh_thresholds(struct sp3 *sp)
                    " kvcompc: %u,"
                    " idlec: %u,"
                    " idlem: %u,"
-                   " lscatter_pct: %u%%",
+                   " lscatter_pct: %u%%,"
+                   " heat: hot/cold %lu/%lu,"
+                   " lexp_pct: %u%%",
         thresh.rspill_kvsets_min,
         thresh.rspill_kvsets_max,
 
@@ -847,7 +873,12 @@ sp3_refresh_thresholds(struct sp3 *sp)
         thresh.llen_idlec,
         thresh.llen_idlem,
 
-        thresh.lscatter_pct);
+        thresh.lscatter_pct,
+
+        thresh.heat_hot,
+        thresh.heat_cold,
+
+        thresh.lexp_pct);
 }
 
 static void
@@ -1045,6 +1076,25 @@ sp3_unlink_all_nodes(struct sp3 *sp, struct cn_tree *tree)
         sp3_node_unlink(sp, tn2spn(tn));
 }
 
+/* Percentage of a leaf node's data that has expired, as estimated from
+ * the expiry summaries in its kvsets' kblock headers.
+ */
+static uint
+sp3_node_expired_pct(struct cn_tree_node *tn, u32 now)
+{
+    struct kvset_list_entry *le;
+    u64                      alen = cn_ns_alen(&tn->tn_ns);
+    u64                      expired = 0;
+
+    if (!alen)
+        return 0;
+
+    list_for_each_entry (le, &tn->tn_kvset_list, le_link)
+        expired += kvset_get_expired(le->le_kvset, now);
+
+    return min_t(u64, 100, expired * 100 / alen);
+}
+
 static void
 sp3_dirty_node(struct sp3 *sp, struct cn_tree_node *tn)
 {
@@ -1081,6 +1131,13 @@ sp3_dirty_node(struct sp3 *sp, struct cn_tree_node *tn)
             scatter = sp3_node_scatter_score_compute(spn);
             sp3_node_insert(sp, spn, RBT_L_SCAT, scatter);
         }
+
+        /* RBT_L_EXP: leaf nodes sorted by pct expired */
+        if (sp->thresh.lexp_pct < 100) {
+            u32 now = ktime_get_real() / USEC_PER_SEC;
+
+            sp3_node_insert(sp, spn, RBT_L_EXP, sp3_node_expired_pct(tn, now));
+        }
     } else {
         /* RBT_RI_ALEN: root and internal nodes sorted by alen */
         sp3_node_insert(sp, spn, RBT_RI_ALEN, alen);
@@ -1435,6 +1492,12 @@ sp3_comp_thread_name(
         case CN_CR_LSCATTER:
             r = "sc";
             break;
+        case CN_CR_LHEAT:
+            r = "ht";
+            break;
+        case CN_CR_LEXPIRED:
+            r = "ex";
+            break;
     }
 
     if (loc->node_level == 0)
@@ -1462,7 +1525,6 @@ sp3_submit(struct sp3 *sp, struct cn_compaction_work *w, uint qnum, uint rbt_idx
         cn_node_isleaf(w->cw_node));
 
     w->cw_iter_flags = kvset_iter_flag_fullscan;
-    w->cw_io_workq = NULL;
 
     switch (csched_rp_kvset_iter(sp->rp)) {
         case csched_rp_kvset_iter_sync:
@@ -1477,7 +1539,7 @@ sp3_submit(struct sp3 *sp, struct cn_compaction_work *w, uint qnum, uint rbt_idx
         case csched_rp_kvset_iter_async:
         default:
             /* async mblock read */
-            w->cw_io_workq = cn_get_io_wq(w->cw_tree->cn);
+            w->cw_iter_flags |= kvset_iter_flag_asyncio;
             break;
     }
 
@@ -1910,6 +1972,7 @@ sp3_schedule(struct sp3 *sp)
         jtype_leaf_garbage,
         jtype_leaf_size,
         jtype_leaf_scatter,
+        jtype_leaf_expired,
         jtype_MAX,
     };
 
@@ -2025,6 +2088,19 @@ sp3_schedule(struct sp3 *sp)
                     break;
                 job = sp3_check_rb_tree(sp, RBT_L_SCAT, SP3_LSCAT_THRESH_MIN, wtype_leaf_scatter);
                 break;
+
+            case jtype_leaf_expired:
+                /* Service RBT_L_EXP red-black tree.
+                 * Implements:
+                 *   - Leaf node expired values rule
+                 */
+                if (sp->thresh.lexp_pct >= 100)
+                    break;
+                qi = sp->qinfo + SP3_QNUM_LEAF;
+                if (qfull(qi))
+                    break;
+                job = sp3_check_rb_tree(sp, RBT_L_EXP, sp->thresh.lexp_pct, wtype_leaf_expired);
+                break;
         }
     }
 }
@@ -2096,6 +2172,181 @@ sp3_compact(struct sp3 *sp)
         sp3_schedule(sp);
 }
 
+/* Age the read heat of every kvset such that heat reflects recent reads
+ * (each decay halves the heat accumulated before it).
+ */
+static void
+sp3_heat_decay(struct sp3 *sp)
+{
+    struct cn_tree *tree;
+
+    list_for_each_entry (tree, &sp->mon_tlist, ct_sched.sp3t.spt_tlink) {
+        struct cn_tree_node *    tn;
+        struct kvset_list_entry *le;
+        struct tree_iter         iter;
+        void *                   lock;
+
+        rmlock_rlock(&tree->ct_lock, &lock);
+        tree_iter_init(tree, &iter, TRAVERSE_TOPDOWN);
+
+        while (NULL != (tn = tree_iter_next(tree, &iter))) {
+            list_for_each_entry (le, &tn->tn_kvset_list, le_link)
+                kvset_heat_decay(le->le_kvset);
+        }
+
+        rmlock_runlock(lock);
+    }
+}
+
+/*
+ * sp3_expired_check() - refresh the expired pct of all leaf nodes
+ *
+ * Values expire with the passage of time rather than as a result of
+ * ingests or compactions, so leaves must be reweighed periodically.
+ */
+static void
+sp3_expired_check(struct sp3 *sp)
+{
+    struct cn_tree *tree;
+    u32             now;
+
+    if (sp->thresh.lexp_pct >= 100)
+        return;
+
+    now = ktime_get_real() / USEC_PER_SEC;
+
+    list_for_each_entry (tree, &sp->mon_tlist, ct_sched.sp3t.spt_tlink) {
+        struct cn_tree_node *tn;
+        struct tree_iter     iter;
+        void *               lock;
+
+        rmlock_rlock(&tree->ct_lock, &lock);
+        tree_iter_init(tree, &iter, TRAVERSE_TOPDOWN);
+
+        while (NULL != (tn = tree_iter_next(tree, &iter))) {
+            struct sp3_node *spn = tn2spn(tn);
+
+            if (!spn->spn_initialized || !cn_node_isleaf(tn))
+                continue;
+
+            sp3_rb_erase(sp->rbt + RBT_L_EXP, spn->spn_rbe + RBT_L_EXP);
+            sp3_node_insert(sp, spn, RBT_L_EXP, sp3_node_expired_pct(tn, now));
+        }
+
+        rmlock_runlock(lock);
+    }
+}
+
+/*
+ * sp3_iogov_check() - adjust the compaction I/O budget
+ *
+ * Compaction jobs charge the mblock bytes they read and write to sp->tbkt
+ * (see cn_compact_io_charge()).  While csched_gov_lat_ns is set, the
+ * budget is adjusted to keep the p99 latency of cN gets (as sampled by
+ * PERFC_LT_CNGET_GET) under that target: it is cut by a quarter when the
+ * target is missed and grows by 1/16th of csched_gov_rate_max otherwise,
+ * within [csched_gov_rate_min, csched_gov_rate_max].  Space amp trumps
+ * latency: the budget is not cut while space amp is being reduced, and
+ * it is maxed out once space amp reaches csched_samp_max.
+ */
+static void
+sp3_iogov_check(struct sp3 *sp)
+{
+    u64             hitv[PERFC_IVL_MAX + 1], boundv[PERFC_IVL_MAX];
+    u64             sumv[PERFC_IVL_MAX + 1] = {};
+    u64             rate_min, rate_max, rate, target;
+    u64             samples, lat, cum;
+    struct cn_tree *tree;
+    bool            resync;
+    u32             bktc = 0;
+    u32             i, n;
+
+    target = sp->rp->csched_gov_lat_ns;
+    rate_max = sp->rp->csched_gov_rate_max;
+    rate_min = min_t(u64, sp->rp->csched_gov_rate_min, rate_max);
+
+    if (!target || !rate_max) {
+        rate = 0;
+        goto update;
+    }
+
+    list_for_each_entry (tree, &sp->mon_tlist, ct_sched.sp3t.spt_tlink) {
+        if (!tree->cn)
+            continue;
+
+        n = perfc_dis_hits(cn_pc_lookup_get(tree->cn), PERFC_LT_CNGET_GET, hitv, boundv);
+
+        for (i = 0; i < n; ++i)
+            sumv[i] += hitv[i];
+
+        bktc = max_t(u32, bktc, n);
+    }
+
+    /* Hits go backward when a tree is closed or a counter is cleared,
+     * in which case skip an interval to resync.  Likewise when the
+     * governor was disabled, as the previous hits are stale.
+     */
+    resync = !sp->gov_rate;
+
+    for (i = samples = 0; i < bktc; ++i) {
+        resync |= sumv[i] < sp->gov_hitv[i];
+        hitv[i] = sumv[i] - sp->gov_hitv[i];
+        samples += hitv[i];
+    }
+
+    memcpy(sp->gov_hitv, sumv, sizeof(sp->gov_hitv));
+
+    /* Estimate the p99 latency by the upper bound of the bucket that
+     * contains it (or the lower bound of the last, unbounded bucket).
+     * Too few samples (e.g., the counter is disabled) means there is
+     * no foreground load to protect.
+     */
+    lat = 0;
+
+    if (!resync && bktc > 1 && samples >= SP3_IOGOV_SAMPLES_MIN) {
+        for (i = cum = 0; i < bktc - 1; ++i) {
+            cum += hitv[i];
+            if (cum >= samples - samples / 100)
+                break;
+        }
+
+        lat = boundv[min_t(u32, i, bktc - 2)];
+    }
+
+    rate = clamp_t(u64, sp->gov_rate ?: rate_max, rate_min, rate_max);
+
+    if (!resync) {
+        if (sp->samp_curr >= sp->samp_max)
+            rate = rate_max;
+        else if (lat > target && !sp->samp_reduce)
+            rate = max_t(u64, rate - rate / 4, rate_min);
+        else if (lat <= target)
+            rate = min_t(u64, rate + rate_max / 16, rate_max);
+    }
+
+    if (debug_qos(sp) && rate != sp->gov_rate) {
+        hse_slog(
+            HSE_NOTICE,
+            HSE_SLOG_START("cn_iogov"),
+            HSE_SLOG_FIELD("rate", "%lu", (ulong)rate),
+            HSE_SLOG_FIELD("prev", "%lu", (ulong)sp->gov_rate),
+            HSE_SLOG_FIELD("lat_p99", "%lu", (ulong)lat),
+            HSE_SLOG_FIELD("lat_targ", "%lu", (ulong)target),
+            HSE_SLOG_FIELD("samples", "%lu", (ulong)samples),
+            HSE_SLOG_FIELD("samp_curr", "%.3f", scale2dbl(sp->samp_curr)),
+            HSE_SLOG_END);
+    }
+
+update:
+    if (rate != sp->gov_rate) {
+        sp->gov_rate = rate;
+        tbkt_adjust(&sp->tbkt, rate, rate);
+    }
+
+    perfc_set(&sp->sched_pc, PERFC_BA_SP3_IOBUDGET, rate);
+    perfc_set(&sp->sched_pc, PERFC_BA_SP3_IODEBT, tbkt_debt_get(&sp->tbkt));
+}
+
 struct periodic_check {
     u64 interval;
     u64 next;
@@ -2113,6 +2364,9 @@ sp3_monitor(struct work_struct *work)
     struct periodic_check chk_qos;
     struct periodic_check chk_refresh;
     struct periodic_check chk_shape;
+    struct periodic_check chk_heat;
+    struct periodic_check chk_expired;
+    struct periodic_check chk_iogov;
 
     u64 now, last_activity;
 
@@ -2122,10 +2376,16 @@ sp3_monitor(struct work_struct *work)
     chk_qos.interval = NSEC_PER_SEC / 5;
     chk_refresh.interval = 10 * NSEC_PER_SEC;
     chk_shape.interval = 15 * NSEC_PER_SEC;
+    chk_heat.interval = 10 * NSEC_PER_SEC;
+    chk_expired.interval = 30 * NSEC_PER_SEC;
+    chk_iogov.interval = NSEC_PER_SEC;
 
     chk_qos.next = now + chk_qos.interval;
     chk_refresh.next = now + chk_refresh.interval;
     chk_shape.next = now + chk_shape.interval;
+    chk_heat.next = now + chk_heat.interval;
+    chk_expired.next = now + chk_expired.interval;
+    chk_iogov.next = now + chk_iogov.interval;
 
     sp3_refresh_settings(sp);
 
@@ -2179,6 +2439,21 @@ sp3_monitor(struct work_struct *work)
             chk_shape.next = now + chk_shape.interval;
         }
 
+        if (now > chk_heat.next) {
+            sp3_heat_decay(sp);
+            chk_heat.next = now + chk_heat.interval;
+        }
+
+        if (now > chk_expired.next) {
+            sp3_expired_check(sp);
+            chk_expired.next = now + chk_expired.interval;
+        }
+
+        if (now > chk_iogov.next) {
+            sp3_iogov_check(sp);
+            chk_iogov.next = now + chk_iogov.interval;
+        }
+
         if (sp->activity)
             last_activity = get_time_ns();
 
@@ -2231,6 +2506,14 @@ sp3_op_compact_status_get(struct csched_ops *handle, struct hse_kvdb_compact_sta
     status->kvcs_samp_hwm = sp->samp_hwm * 100 / SCALE;
 }
 
+static struct tbkt *
+sp3_op_tbkt_maint_get(struct csched_ops *handle)
+{
+    struct sp3 *sp = h2sp(handle);
+
+    return &sp->tbkt;
+}
+
 /**
  * sp3_op_notify_ingest() - External API: notify ingest job has completed
  */
@@ -2382,7 +2665,7 @@ sp3_create(
     /* Allocate cache aligned space for struct csched + sp->name */
     name_sz = strlen(mp) + 1;
     alloc_sz = sizeof(*sp) + name_sz;
-    sp = alloc_aligned(alloc_sz, SMP_CACHE_BYTES);
+    sp = alloc_aligned(alloc_sz, __alignof__(*sp));
     if (ev(!sp))
         return merr(ENOMEM);
 
@@ -2409,6 +2692,9 @@ sp3_create(
 
     atomic_set(&sp->destruct, 0);
 
+    /* Compaction I/O is unlimited until the governor engages */
+    tbkt_init(&sp->tbkt, 0, 0);
+
     err = sts_create(sp->rp, sp->name, SP3_NUM_QUEUES, &sp->sts);
     if (ev(err))
         goto err_exit;
@@ -2429,6 +2715,7 @@ sp3_create(
     sp->ops.cs_throttle_sensor = sp3_op_throttle_sensor;
     sp->ops.cs_compact_request = sp3_op_compact_request;
     sp->ops.cs_compact_status_get = sp3_op_compact_status_get;
+    sp->ops.cs_tbkt_maint_get = sp3_op_tbkt_maint_get;
     sp->ops.cs_tree_add = sp3_op_tree_add;
     sp->ops.cs_tree_remove = sp3_op_tree_remove;
 
@@ -12,6 +12,7 @@
 #include <hse_ikvdb/cn.h>
 #include <hse_ikvdb/kvdb_rparams.h>
 #include <hse_ikvdb/kvs_rparams.h>
+#include <hse_ikvdb/mclass_policy.h>
 
 #include "csched_sp3_work.h"
 
@@ -354,6 +355,31 @@ sp3_work_leaf_garbage(
     return min_t(uint, kvsets, cnt_max);
 }
 
+/* Compact the oldest kvsets of a leaf whose expired values exceed the
+ * threshold.  Unlike the garbage rule this applies to a leaf with a
+ * single kvset, since expired values are reclaimed by rewriting it.
+ */
+static uint
+sp3_work_leaf_expired(
+    struct sp3_node *         spn,
+    struct sp3_thresholds *   thresh,
+    struct kvset_list_entry **mark,
+    enum cn_action *          action,
+    enum cn_comp_rule *       rule)
+{
+    struct cn_tree_node *tn = spn2tn(spn);
+    uint                 kvsets = cn_ns_kvsets(&tn->tn_ns);
+
+    *mark = list_last_entry_or_null(&tn->tn_kvset_list, struct kvset_list_entry, le_link);
+    if (!*mark)
+        return 0;
+
+    *action = CN_ACTION_COMPACT_KV;
+    *rule = CN_CR_LEXPIRED;
+
+    return min_t(uint, kvsets, thresh->lcomp_kvsets_max);
+}
+
 static bool
 sp3_work_leaf_is_idle(struct cn_tree_node *tn, uint idlem)
 {
@@ -620,6 +646,32 @@ sp3_work_leaf_scatter(
     return 0;
 }
 
+static enum hse_mclass_policy_temp
+sp3_work_temp(struct sp3_thresholds *thresh, u64 heat, bool root)
+{
+    if (thresh->heat_hot && heat >= thresh->heat_hot)
+        return HSE_MPOLICY_TEMP_HOT;
+
+    /* Root kvsets are short lived, don't bother demoting them.
+     */
+    if (thresh->heat_cold && heat < thresh->heat_cold && !root)
+        return HSE_MPOLICY_TEMP_COLD;
+
+    return HSE_MPOLICY_TEMP_NONE;
+}
+
+static u64
+sp3_work_node_heat(struct cn_tree_node *tn)
+{
+    struct kvset_list_entry *le;
+    u64                      heat = 0;
+
+    list_for_each_entry (le, &tn->tn_kvset_list, le_link)
+        heat += kvset_get_heat(le->le_kvset);
+
+    return heat;
+}
+
 /**
  * sp3_work() - determine if a given node needs maintenance
  * @tn: the cn tree node to check
@@ -645,6 +697,8 @@ sp3_work(
     uint                       i;
     uint                       ichildc;
     uint                       lchildc;
+    uint                       nstaging;
+    u64                        heat;
     bool                       use_token;
 
     uint                     n_kvsets = 0;
@@ -704,6 +758,11 @@ sp3_work(
                 *qnum_out = SP3_QNUM_LEAFBIG;
                 break;
 
+            case wtype_leaf_expired:
+                n_kvsets = sp3_work_leaf_expired(spn, thresh, &mark, &action, &rule);
+                *qnum_out = SP3_QNUM_LEAF;
+                break;
+
             default:
                 ev(1, HSE_WARNING);
                 break;
@@ -759,6 +818,8 @@ sp3_work(
     /* mark the kvsets with dgen_lo */
     w->cw_dgen_lo = kvset_get_dgen(mark->le_kvset);
     le = mark;
+    heat = 0;
+    nstaging = 0;
     for (i = 0; i < n_kvsets; i++) {
         assert(&le->le_link != &tn->tn_kvset_list);
         assert(kvset_get_workid(le->le_kvset) == 0);
@@ -766,9 +827,41 @@ sp3_work(
         w->cw_dgen_hi = kvset_get_dgen(le->le_kvset);
         w->cw_nk += kvset_get_num_kblocks(le->le_kvset);
         w->cw_nv += kvset_get_num_vblocks(le->le_kvset);
+        heat += kvset_get_heat(le->le_kvset);
+        nstaging += kvset_get_vblks_staging(le->le_kvset);
         le = list_prev_entry(le, le_link);
     }
 
+    /* Spilled data takes on the heat of the child that receives it,
+     * compacted data retains the heat of its input kvsets.
+     */
+    if (action == CN_ACTION_SPILL) {
+        for (i = 0; i < tn->tn_tree->ct_cp->cp_fanout; i++) {
+            struct cn_tree_node *child = tn->tn_childv[i];
+
+            w->cw_tempv[i] = child ? sp3_work_temp(thresh, sp3_work_node_heat(child), false)
+                                   : HSE_MPOLICY_TEMP_NONE;
+        }
+    } else {
+        struct mclass_policy *policy = cn_get_mclass_policy(tn->tn_tree->cn);
+
+        w->cw_tempv[0] = sp3_work_temp(thresh, heat, !tn->tn_parent);
+
+        /* A k-compaction leaves the vblocks where they are, so rewrite
+         * them if they are on the wrong media for their heat.
+         */
+        if (action == CN_ACTION_COMPACT_K && cn_node_isleaf(tn) && policy &&
+            mclass_policy_temp_capable(policy, HSE_MPOLICY_DTYPE_VALUE)) {
+            bool hot = w->cw_tempv[0] == HSE_MPOLICY_TEMP_HOT;
+            bool cold = w->cw_tempv[0] == HSE_MPOLICY_TEMP_COLD;
+
+            if ((hot && nstaging < w->cw_nv) || (cold && nstaging > 0)) {
+                action = CN_ACTION_COMPACT_KV;
+                rule = CN_CR_LHEAT;
+            }
+        }
+    }
+
     lchildc = 0;
     ichildc = 0;
     for (i = 0; i < tn->tn_tree->ct_cp->cp_fanout; i++) {
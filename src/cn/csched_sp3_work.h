@@ -23,8 +23,9 @@ enum sp3_work_type {
     wtype_leaf_size,    /* leaf nodes: size */
     wtype_node_len,     /* all nodes: numbrer of kvsets */
     wtype_leaf_scatter, /* leaf nodes: scatter */
+    wtype_leaf_expired, /* leaf nodes: expired values */
 };
-#define wtype_MAX (wtype_leaf_scatter + 1)
+#define wtype_MAX (wtype_leaf_expired + 1)
 
 struct sp3_thresholds {
     u8 rspill_kvsets_min;
@@ -41,6 +42,9 @@ struct sp3_thresholds {
     u8 llen_kvcompc;
     u8 llen_idlec;
     u8 llen_idlem;
+    u64 heat_hot;
+    u64 heat_cold;
+    u8  lexp_pct;
 };
 
 /* rspill and ispill require at least 1 kvset,
@@ -15,16 +15,19 @@
 #include <hse_ikvdb/kvset_builder.h>
 #include <hse_ikvdb/cn.h>
 #include <hse_ikvdb/kvs_rparams.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include <hse_util/alloc.h>
 #include <hse_util/slab.h>
 #include <hse_util/page.h>
 #include <hse_util/assert.h>
 #include <hse_util/bloom_filter.h>
+#include <hse_util/fuse_filter.h>
 #include <hse_util/event_counter.h>
 #include <hse_util/perfc.h>
 #include <hse_util/hlog.h>
 #include <hse_util/log2.h>
+#include <hse_util/minmax.h>
 
 #include "omf.h"
 #include "blk_list.h"
@@ -35,8 +38,6 @@
 
 #include <mpool/mpool.h>
 
-extern struct tbkt sp3_tbkt;
-
 #define KBLOCK_HDR_PAGES 1
 #define KBLOCK_HDR_LEN ((KBLOCK_HDR_PAGES) * (PAGE_SIZE))
 
@@ -94,12 +95,21 @@ struct hash_set {
  * @wbt_pgc:  Number of pages reserved for wbtree.
  * @blm_pgc:  Number of pages reserved for Bloom filter.
  * @bloom_elt_cap: Number of keys Bloom filter can hold at current size
+ * @blm_type:  Filter type (BLOOM_OMF_TYPE_BLOCK or BLOOM_OMF_TYPE_FUSE)
+ * @blm_fpbits: Fingerprint width for fuse filters
+ * @blm_pfx_len: Length of key prefixes added to the Bloom filter (0: none)
+ * @blm_pfx_cnt: Number of distinct prefixes added to the Bloom filter
+ * @blm_pfx:   Most recently added prefix
  * @hash_set:  Hash set to store key hashes. Used to build
  *             Bloom filter at end of kblock construction.
  * @num_keys:  Number of keys in kblock.
  * @num_tombstones:  Number of keys in kblock that have tombstone values.
  * @total_key_bytes: Sum of all key lengths.
  * @total_val_bytes: Sum of all value lengths.
+ * @num_expiry:      Number of values in kblock that have an expiry time.
+ * @expiry_val_bytes: Sum of the lengths of values that have an expiry time.
+ * @expiry_min:      Earliest expiry time of any value in kblock.
+ * @expiry_max:      Latest expiry time of any value in kblock.
  *
  * Description:
  *
@@ -123,6 +133,9 @@ struct hash_set {
  *   Wbtree occupies next wbt_pgc pages.
  *
  *   Bloom tree occupies next blm_pbc pages.
+ *
+ *   The last kblock of a kvset is followed by the hlog, the ptree and
+ *   the range tombstone region.
  */
 struct curr_kblock {
 
@@ -135,6 +148,10 @@ struct curr_kblock {
     u64 total_val_bytes;
     u32 num_keys;
     u32 num_tombstones;
+    u32 num_expiry;
+    u64 expiry_val_bytes;
+    u32 expiry_min;
+    u32 expiry_max;
 
     uint max_size;
     uint max_pgc;
@@ -142,6 +159,11 @@ struct curr_kblock {
     uint wbt_pgc;
 
     uint                   blm_elt_cap;
+    uint                   blm_type;
+    uint                   blm_fpbits;
+    uint                   blm_pfx_len;
+    uint                   blm_pfx_cnt;
+    u8                     blm_pfx[HSE_KVS_MAX_PFXLEN];
     struct hash_set        hash_set;
     struct bf_bithash_desc desc;
 
@@ -168,6 +190,10 @@ free_pgc(struct curr_kblock *kblk)
  * @finished_kblks: list of finished kblocks (written, not committed)
  * @curr: the kblock currently being built
  * @finished: mark builder as finished (end of life)
+ * @rt_buf: range tombstone region image (page aligned, zero padded)
+ * @rt_len: bytes used in @rt_buf
+ * @rt_alloc: size of @rt_buf
+ * @rt_cnt: number of range tombstones in @rt_buf
  */
 struct kblock_builder {
     struct mpool *             ds;
@@ -178,6 +204,7 @@ struct kblock_builder {
     struct hlog *              hlog;
     struct cn_merge_stats *    mstats;
     enum hse_mclass_policy_age agegroup;
+    enum hse_mclass_policy_temp temp;
     struct blk_list            finished_kblks;
     struct curr_kblock         curr;
     bool                       finished;
@@ -187,8 +214,47 @@ struct kblock_builder {
     uint                       pt_max_pgc;
     u64                        seqno_min;
     u64                        seqno_max;
+    u8 *                       rt_buf;
+    size_t                     rt_len;
+    size_t                     rt_alloc;
+    uint                       rt_cnt;
 };
 
+static __always_inline uint
+rt_pgc(struct kblock_builder *bld)
+{
+    return ALIGN(bld->rt_len, PAGE_SIZE) / PAGE_SIZE;
+}
+
+/* Find the smallest start key and the largest end key of all the range
+ * tombstones in the builder.  The key objects refer to the rtomb buffer.
+ */
+static void
+rt_min_max_keys(struct kblock_builder *bld, struct key_obj *min_kobj, struct key_obj *max_kobj)
+{
+    const u8 *p = bld->rt_buf;
+    uint      i;
+
+    for (i = 0; i < bld->rt_cnt; ++i) {
+        const struct kblock_rtomb_omf *omf = (const void *)p;
+        struct key_obj                 start, end;
+        uint                           slen, elen;
+
+        slen = omf_kro_slen(omf);
+        elen = omf_kro_elen(omf);
+        p += sizeof(*omf);
+
+        key2kobj(&start, p, slen);
+        key2kobj(&end, p + slen, elen);
+        p += slen + elen;
+
+        if (i == 0 || key_obj_cmp(&start, min_kobj) < 0)
+            *min_kobj = start;
+        if (i == 0 || key_obj_cmp(&end, max_kobj) > 0)
+            *max_kobj = end;
+    }
+}
+
 /**
  * mblk_blow_chunks() - Split a large mpool_mblock_write request into a
  *                      sequence of smaller requests.
@@ -375,7 +441,7 @@ hash_set_init(struct hash_set *hs)
 }
 
 static merr_t
-hash_set_add(struct hash_set *hs, const struct key_obj *kobj)
+hash_set_add(struct hash_set *hs, u64 hash)
 {
     if (!hs->curr_part) {
         hs->curr_part = malloc(sizeof(*hs->curr_part));
@@ -387,7 +453,7 @@ hash_set_add(struct hash_set *hs, const struct key_obj *kobj)
 
     assert(hs->curr_part->n_hashes < HSP_HASH_MAX_KEYS);
 
-    hs->curr_part->hashvec[hs->curr_part->n_hashes++] = key_obj_hash64(kobj);
+    hs->curr_part->hashvec[hs->curr_part->n_hashes++] = hash;
 
     /* If full, then use next part.  If next is null, allocate new
      * part next time one is added.
@@ -466,6 +532,20 @@ kblock_init(
     kblk->pc = pc;
     kblk->desc = bf_compute_bithash_est(rp->cn_bloom_prob);
 
+    kblk->blm_type = BLOOM_OMF_TYPE_BLOCK;
+    if (cp->cp_kblk_filter) {
+        kblk->blm_type = BLOOM_OMF_TYPE_FUSE;
+        kblk->blm_fpbits = ff_fpbits_est(rp->cn_bloom_prob);
+    }
+
+    /* Prefix entries let prefix cursors skip kblocks (and whole
+     * kvsets) that have no keys under the cursor's prefix.
+     */
+    if (rp->cn_bloom_pfx) {
+        kblk->blm_pfx_len = rp->cn_bloom_pfx_len ?: cp->cp_pfx_len;
+        kblk->blm_pfx_len = min_t(uint, kblk->blm_pfx_len, HSE_KVS_MAX_PFXLEN);
+    }
+
     err = wbb_create(&kblk->wbtree, kblk->wbt_pgc + free_pgc(kblk), &kblk->wbt_pgc);
     if (ev(err))
         return err;
@@ -482,9 +562,14 @@ kblock_reset(struct curr_kblock *kblk)
     kblk->total_val_bytes = 0;
     kblk->num_keys = 0;
     kblk->num_tombstones = 0;
+    kblk->num_expiry = 0;
+    kblk->expiry_val_bytes = 0;
+    kblk->expiry_min = 0;
+    kblk->expiry_max = 0;
 
     kblk->blm_pgc = 0;
     kblk->blm_elt_cap = 0;
+    kblk->blm_pfx_cnt = 0;
     kblk->bloom_len = 0;
 
     hash_set_reset(&kblk->hash_set);
@@ -535,13 +620,32 @@ kblock_add_entry(
 
     if (kblk->rp->cn_bloom_create) {
         size_t tree_sfx_len = kblk->cp->cp_sfx_len;
+        uint   pfx_len = kblk->blm_pfx_len;
+        bool   new_pfx = false;
+
+        /* Keys arrive in sorted order, hence a key's prefix is new to
+         * this kblock iff it differs from that of the previous key.
+         */
+        if (pfx_len && key_obj_len(kobj) >= pfx_len) {
+            u8   pfx[HSE_KVS_MAX_PFXLEN];
+            uint len;
+
+            key_obj_copy(pfx, pfx_len, &len, kobj);
+            new_pfx = (kblk->num_keys == 0 || memcmp(pfx, kblk->blm_pfx, pfx_len));
+            if (new_pfx)
+                memcpy(kblk->blm_pfx, pfx, pfx_len);
+        }
 
         /* Ensure we have enough pages reserved for bloom filters. */
-        if (kblk->num_keys + 1 > kblk->blm_elt_cap) {
+        if (kblk->num_keys + kblk->blm_pfx_cnt + 1 + new_pfx > kblk->blm_elt_cap) {
             if (!free_pgc(kblk))
                 return 0;
             kblk->blm_pgc++;
-            kblk->blm_elt_cap = bf_element_estimate(kblk->desc, kblk->blm_pgc * PAGE_SIZE);
+            if (kblk->blm_type == BLOOM_OMF_TYPE_FUSE)
+                kblk->blm_elt_cap =
+                    ff_element_estimate(kblk->blm_fpbits, kblk->blm_pgc * PAGE_SIZE);
+            else
+                kblk->blm_elt_cap = bf_element_estimate(kblk->desc, kblk->blm_pgc * PAGE_SIZE);
         }
 
         /* Add key's hash to hash_set. Hash only on the soft prefix. */
@@ -552,9 +656,14 @@ kblock_add_entry(
             min_sfx_len = min_t(size_t, tree_sfx_len, ko.ko_sfx_len);
             ko.ko_sfx_len -= min_sfx_len;
             ko.ko_pfx_len -= tree_sfx_len - min_sfx_len;
-            err = hash_set_add(&kblk->hash_set, (const void *)&ko);
+            err = hash_set_add(&kblk->hash_set, key_obj_hash64(&ko));
         } else {
-            err = hash_set_add(&kblk->hash_set, kobj);
+            err = hash_set_add(&kblk->hash_set, key_obj_hash64(kobj));
+        }
+
+        if (!err && new_pfx) {
+            err = hash_set_add(&kblk->hash_set, pfx_obj_hash64(kobj, pfx_len));
+            kblk->blm_pfx_cnt++;
         }
 
         if (ev(err))
@@ -581,9 +690,57 @@ kblock_add_entry(
     kblk->total_val_bytes += stats->tot_vlen;
     kblk->num_tombstones += stats->ntombs;
 
+    if (stats->nexpiry) {
+        if (!kblk->num_expiry || stats->expiry_min < kblk->expiry_min)
+            kblk->expiry_min = stats->expiry_min;
+        if (stats->expiry_max > kblk->expiry_max)
+            kblk->expiry_max = stats->expiry_max;
+
+        kblk->num_expiry += stats->nexpiry;
+        kblk->expiry_val_bytes += stats->expiry_vlen;
+    }
+
     return 0;
 }
 
+/**
+ * _kblock_finish_fuse() - build a binary fuse filter into kblk->bloom
+ * @ff: (output) fuse filter
+ *
+ * The fuse filter is built in one shot from all the key hashes, so the
+ * hash set parts are first gathered into a single vector.
+ */
+static merr_t
+_kblock_finish_fuse(struct curr_kblock *kblk, struct fuse_filter *ff)
+{
+    struct hash_set_part *part;
+    u64 *                 hashv;
+    u32                   hashc;
+    merr_t                err;
+
+    hashc = 0;
+    list_for_each_entry (part, &kblk->hash_set.part_list, part_link)
+        hashc += part->n_hashes;
+
+    hashv = malloc(hashc * sizeof(*hashv));
+    if (ev(!hashv))
+        return merr(ENOMEM);
+
+    hashc = 0;
+    list_for_each_entry (part, &kblk->hash_set.part_list, part_link) {
+        memcpy(hashv + hashc, part->hashvec, part->n_hashes * sizeof(*hashv));
+        hashc += part->n_hashes;
+    }
+
+    memset(kblk->bloom, 0, kblk->bloom_len);
+
+    err = ff_filter_build(ff, kblk->blm_fpbits, hashc, hashv, kblk->bloom, kblk->bloom_len);
+
+    free(hashv);
+
+    return err;
+}
+
 /**
  * _kblock_finish_bloom() - finalize wbtree and Bloom filter regions
  * @blm_hdr: (output) Bloom filter header
@@ -592,7 +749,11 @@ static merr_t
 _kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
 {
     struct bloom_filter   bloom;
+    struct fuse_filter    ff;
     struct hash_set_part *part;
+    uint                  type = BLOOM_OMF_TYPE_BLOCK;
+
+    memset(&ff, 0, sizeof(ff));
 
     if (kblk->num_keys == 0 || kblk->rp->cn_bloom_create == 0) {
         assert(kblk->blm_pgc == 0);
@@ -610,10 +771,30 @@ _kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
             kblk->bloom_alloc_len = kblk->bloom_len;
         }
 
-        memset(kblk->bloom, 0, kblk->bloom_len);
-        bf_filter_init(&bloom, kblk->desc, kblk->num_keys, kblk->bloom, kblk->bloom_len);
-        list_for_each_entry (part, &kblk->hash_set.part_list, part_link) {
-            bf_filter_insert_by_hashv(&bloom, part->hashvec, part->n_hashes);
+        if (kblk->blm_type == BLOOM_OMF_TYPE_FUSE) {
+            merr_t err;
+
+            /* Should the fuse filter fail to build (which is
+             * vanishingly unlikely) fall back to a block bloom of
+             * the same size.  Its false positive rate will be
+             * somewhat worse, but it's still a valid filter.
+             */
+            err = _kblock_finish_fuse(kblk, &ff);
+            if (!err)
+                type = BLOOM_OMF_TYPE_FUSE;
+            else if (merr_errno(err) == ENOMEM)
+                return err;
+        }
+
+        if (type == BLOOM_OMF_TYPE_BLOCK) {
+            memset(kblk->bloom, 0, kblk->bloom_len);
+            bf_filter_init(&bloom, kblk->desc, kblk->num_keys, kblk->bloom, kblk->bloom_len);
+            list_for_each_entry (part, &kblk->hash_set.part_list, part_link) {
+                bf_filter_insert_by_hashv(&bloom, part->hashvec, part->n_hashes);
+            }
+        } else {
+            memset(&bloom, 0, sizeof(bloom));
+            bloom.bf_bitmapsz = ff.ff_datasz;
         }
     }
 
@@ -626,6 +807,13 @@ _kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
     omf_set_bh_bktshift(blm_hdr, bloom.bf_bktshift);
     omf_set_bh_rotl(blm_hdr, bloom.bf_rotl);
     omf_set_bh_n_hashes(blm_hdr, bloom.bf_n_hashes);
+    omf_set_bh_type(blm_hdr, type);
+    omf_set_bh_fpbits(blm_hdr, ff.ff_fpbits);
+    omf_set_bh_seed(blm_hdr, ff.ff_seed);
+    omf_set_bh_seglen(blm_hdr, ff.ff_seglen);
+    omf_set_bh_segcnt(blm_hdr, ff.ff_segcnt);
+    if (kblk->blm_pfx_cnt > 0)
+        omf_set_bh_pfx_len(blm_hdr, kblk->blm_pfx_len);
 
     return 0;
 }
@@ -634,8 +822,11 @@ _kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
  * _kblock_make_header() - prepare kblock omf header for writing
  * @wbt_hdr: (input) Wbtree header
  * @blm_hdr: (input) Bloom filter header
+ * @rt_min:  (input) smallest rtomb start key, NULL if no rtombs
+ * @rt_max:  (input) largest rtomb end key
  *
- * Caller must ensure the kblock is not empty.
+ * Caller must ensure the kblock is not empty (i.e., it contains keys,
+ * ptombs or rtombs).
  *
  * Kblock header layout:
  *
@@ -657,6 +848,10 @@ _kblock_make_header(
     struct wbt_hdr_omf *   pt_hdr,
     uint                   pt_pgc,
     struct bloom_hdr_omf * blm_hdr,
+    struct key_obj *       rt_min,
+    struct key_obj *       rt_max,
+    uint                   rt_pgc,
+    uint                   rt_cnt,
     u64                    seqno_min,
     u64                    seqno_max,
     struct kblock_hdr_omf *hdr)
@@ -670,7 +865,7 @@ _kblock_make_header(
     unsigned char   tmp_kobj_buf[HSE_KVS_KLEN_MAX];
     unsigned int    tmp_kobj_bufsz = sizeof(tmp_kobj_buf);
 
-    assert(kblk->num_keys > 0);
+    assert(kblk->num_keys > 0 || rt_cnt > 0);
 
     memset(hdr, 0, KBLOCK_HDR_LEN);
 
@@ -687,6 +882,10 @@ _kblock_make_header(
     omf_set_kbh_tombs(hdr, kblk->num_tombstones);
     omf_set_kbh_key_bytes(hdr, kblk->total_key_bytes);
     omf_set_kbh_val_bytes(hdr, kblk->total_val_bytes);
+    omf_set_kbh_exp_cnt(hdr, kblk->num_expiry);
+    omf_set_kbh_exp_vlen(hdr, kblk->expiry_val_bytes);
+    omf_set_kbh_exp_min(hdr, kblk->expiry_min);
+    omf_set_kbh_exp_max(hdr, kblk->expiry_max);
 
     /* wbtree header is right after kblock_hdr at an 8-byte boundary */
     off += sizeof(*hdr);
@@ -754,6 +953,16 @@ _kblock_make_header(
         }
     }
 
+    /* An rtomb's end key is exclusive, hence using it as the max key
+     * overstates the key range of the kblock, which is harmless.
+     */
+    if (rt_min) {
+        if (!key_obj_len(min_kobj) || key_obj_cmp(rt_min, min_kobj) < 0)
+            min_kobj = rt_min;
+        if (!key_obj_len(max_kobj) || key_obj_cmp(rt_max, max_kobj) > 0)
+            max_kobj = rt_max;
+    }
+
 #ifndef NDEBUG
     if (omf_wbt_kmd_pgc(wbt_hdr)) {
         uint minkey_len = key_obj_len(min_kobj);
@@ -797,6 +1006,13 @@ _kblock_make_header(
         omf_set_kbh_pt_dlen_pg(hdr, pt_pgc);
     }
 
+    if (rt_cnt) {
+        omf_set_kbh_rt_doff_pg(
+            hdr, KBLOCK_HDR_PAGES + kblk->wbt_pgc + kblk->blm_pgc + HLOG_PGC + pt_pgc);
+        omf_set_kbh_rt_dlen_pg(hdr, rt_pgc);
+        omf_set_kbh_rt_cnt(hdr, rt_cnt);
+    }
+
     omf_set_kbh_min_seqno(hdr, seqno_min);
     omf_set_kbh_max_seqno(hdr, seqno_max);
 
@@ -837,6 +1053,7 @@ kblock_finish(struct kblock_builder *bld, struct wbb *ptree)
     struct wbt_hdr_omf   wbt_hdr = { 0 };
     struct wbt_hdr_omf   pt_hdr = { 0 };
     struct mblock_props  mbprop;
+    struct key_obj       rt_min, rt_max;
 
     struct curr_kblock *   kblk = &bld->curr;
     struct cn_merge_stats *stats = bld->mstats;
@@ -852,6 +1069,7 @@ kblock_finish(struct kblock_builder *bld, struct wbb *ptree)
     merr_t err;
     u64    blkid = 0;
     uint   pt_pgc = 0;
+    uint   rt_cnt = 0;
     u64    tstart = 0;
     u64    kblocksz;
     bool   spare;
@@ -873,6 +1091,8 @@ kblock_finish(struct kblock_builder *bld, struct wbb *ptree)
     iov_max = 3 + 1 + wbb_max_inodec_get(kblk->wbtree) + wbb_kmd_pgc_get(kblk->wbtree);
     if (ptree && wbb_entries(ptree))
         iov_max += 1 + wbb_max_inodec_get(ptree) + wbb_kmd_pgc_get(ptree);
+    if (ptree && bld->rt_cnt)
+        iov_max += 1;
 
     iov = malloc(sizeof(*iov) * iov_max);
     if (ev(!iov))
@@ -928,10 +1148,32 @@ kblock_finish(struct kblock_builder *bld, struct wbb *ptree)
         iov_cnt += i;
     }
 
+    /* Range tombstones go with the ptree in the last kblock */
+    if (ptree && bld->rt_cnt) {
+        rt_cnt = bld->rt_cnt;
+        rt_min_max_keys(bld, &rt_min, &rt_max);
+
+        iov[iov_cnt].iov_base = bld->rt_buf;
+        iov[iov_cnt].iov_len = rt_pgc(bld) * PAGE_SIZE;
+        iov_cnt++;
+    }
+
     /* Format kblock header. */
     kblk->num_keys += ptree ? wbb_entries(ptree) : 0;
     _kblock_make_header(
-        kblk, ptree, &wbt_hdr, &pt_hdr, pt_pgc, &blm_hdr, bld->seqno_min, bld->seqno_max, kblk->kblk_hdr);
+        kblk,
+        ptree,
+        &wbt_hdr,
+        &pt_hdr,
+        pt_pgc,
+        &blm_hdr,
+        rt_cnt ? &rt_min : NULL,
+        &rt_max,
+        rt_cnt ? rt_pgc(bld) : 0,
+        rt_cnt,
+        bld->seqno_min,
+        bld->seqno_max,
+        kblk->kblk_hdr);
 
     assert(iov_cnt <= iov_max);
 
@@ -953,7 +1195,8 @@ kblock_finish(struct kblock_builder *bld, struct wbb *ptree)
         tstart = get_time_ns();
 
     do {
-        mclass = mclass_policy_get_type(mpolicy, bld->agegroup, HSE_MPOLICY_DTYPE_KEY, allocs);
+        mclass = mclass_policy_get_type_temp(
+            mpolicy, bld->agegroup, HSE_MPOLICY_DTYPE_KEY, bld->temp, allocs);
         if (mclass == MP_MED_INVALID) {
             if (!err)
                 err = merr(ev(EINVAL));
@@ -1038,6 +1281,7 @@ kbb_create(struct kblock_builder **builder_out, struct cn *cn, struct perfc_set
     bld->pc = pc;
     bld->flags = flags;
     bld->agegroup = HSE_MPOLICY_AGE_LEAF;
+    bld->temp = HSE_MPOLICY_TEMP_NONE;
 
     err = hlog_create(&bld->hlog, HLOG_PRECISION);
     if (ev(err))
@@ -1077,6 +1321,7 @@ kbb_destroy(struct kblock_builder *bld)
     hlog_destroy(bld->hlog);
     kblock_free(&bld->curr);
     wbb_destroy(bld->ptree);
+    free_aligned(bld->rt_buf);
     abort_mblocks(bld->ds, &bld->finished_kblks);
     blk_list_free(&bld->finished_kblks);
     free(bld);
@@ -1113,6 +1358,50 @@ kbb_add_ptomb(
     return 0;
 }
 
+merr_t
+kbb_add_rtomb(struct kblock_builder *bld, const struct rtomb *rt)
+{
+    struct kblock_rtomb_omf *omf;
+    size_t                   need;
+
+    assert(!bld->finished);
+
+    need = sizeof(*omf) + rt->rt_slen + rt->rt_elen;
+
+    if (bld->rt_len + need > bld->rt_alloc) {
+        size_t sz = ALIGN(max_t(size_t, bld->rt_alloc * 2, bld->rt_len + need), PAGE_SIZE);
+        u8 *   buf;
+
+        /* Leave at least half the kblock for everything else.
+         */
+        if (ev(sz > bld->curr.max_size / 2))
+            return merr(EXFULL);
+
+        buf = alloc_page_aligned(sz);
+        if (ev(!buf))
+            return merr(ENOMEM);
+
+        memset(buf, 0, sz);
+        if (bld->rt_buf)
+            memcpy(buf, bld->rt_buf, bld->rt_len);
+
+        free_aligned(bld->rt_buf);
+        bld->rt_buf = buf;
+        bld->rt_alloc = sz;
+    }
+
+    omf = (void *)(bld->rt_buf + bld->rt_len);
+    omf_set_kro_seq(omf, rt->rt_seq);
+    omf_set_kro_slen(omf, rt->rt_slen);
+    omf_set_kro_elen(omf, rt->rt_elen);
+    memcpy(omf + 1, rt->rt_data, rt->rt_slen + rt->rt_elen);
+
+    bld->rt_len += need;
+    bld->rt_cnt++;
+
+    return 0;
+}
+
 /* Add a key with a vref to kblock. Create new kblock if needed. */
 merr_t
 kbb_add_entry(
@@ -1193,17 +1482,17 @@ kbb_finish(struct kblock_builder *bld, struct blk_list *kblks, u64 seqno_min, u6
     assert(bld->finished_kblks.n_blks == 0 || !kblock_is_empty(&bld->curr));
 
     /* Finish main wbtree. If there's enough space left in the kblock, add
-     * ptree to this kblock. If not, add the ptree to the next kblock.
+     * ptree and rtombs to this kblock. If not, add them to the next kblock.
      */
     if (!kblock_is_empty(&bld->curr)) {
         struct wbb *pt = 0;
         u64         kbsize = (bld->rp->kblock_size_mb << 20);
-        u64         ptsize = (wbb_page_cnt_get(bld->ptree)) * PAGE_SIZE;
+        u64         ptsize = (wbb_page_cnt_get(bld->ptree) + rt_pgc(bld)) * PAGE_SIZE;
         u64         kbused =
             (KBLOCK_HDR_PAGES + HLOG_PGC + bld->curr.blm_pgc + wbb_page_cnt_get(bld->curr.wbtree)) *
             PAGE_SIZE;
 
-        /* Write ptree here if we have enough space */
+        /* Write ptree and rtombs here if we have enough space */
         if ((kbused + ptsize < kbsize)) {
             pt_kblock = false;
             pt = bld->ptree;
@@ -1214,7 +1503,7 @@ kbb_finish(struct kblock_builder *bld, struct blk_list *kblks, u64 seqno_min, u6
             return err;
     }
 
-    if (wbb_entries(bld->ptree) && pt_kblock) {
+    if ((wbb_entries(bld->ptree) || bld->rt_cnt) && pt_kblock) {
         err = kblock_finish(bld, bld->ptree);
         if (ev(err))
             return err;
@@ -1241,6 +1530,12 @@ kbb_get_agegroup(struct kblock_builder *bld)
     return bld->agegroup;
 }
 
+void
+kbb_set_temp(struct kblock_builder *bld, enum hse_mclass_policy_temp temp)
+{
+    bld->temp = temp;
+}
+
 void
 kbb_set_merge_stats(struct kblock_builder *bld, struct cn_merge_stats *stats)
 {
@@ -17,9 +17,11 @@ struct kblock_builder;
 struct blk_list;
 struct kvs_rparams;
 struct cn_merge_stats;
+struct rtomb;
 
 enum mp_media_classp;
 enum hse_mclass_policy_age;
+enum hse_mclass_policy_temp;
 
 struct kbb_key_stats {
     uint nvals;
@@ -30,6 +32,10 @@ struct kbb_key_stats {
     u64  seqno_prev_ptomb;
     u64  c0_vlen;
     u64  c1_vlen;
+    uint nexpiry;
+    u64  expiry_vlen;
+    u32  expiry_min;
+    u32  expiry_max;
 };
 
 /* MTF_MOCK_DECL(kblock_builder) */
@@ -86,6 +92,20 @@ kbb_add_ptomb(
     uint                   kmd_len,
     struct kbb_key_stats * stats);
 
+/**
+ * kbb_add_rtomb() - Add a range tombstone to the kblock builder.
+ * @bld: kblock builder
+ * @rt:  range tombstone
+ *
+ * Range tombstones are buffered until kbb_finish(), which stores them
+ * in the last kblock (along with the ptree).
+ *
+ * Return: EXFULL if the range tombstones would not fit in a kblock.
+ */
+/* MTF_MOCK */
+merr_t
+kbb_add_rtomb(struct kblock_builder *bld, const struct rtomb *rt);
+
 /**
  * kbb_add_entry() - Store a key and a value reference in a kblock.
  * @bld: builder handle
@@ -140,6 +160,9 @@ kbb_set_agegroup(struct kblock_builder *bld, enum hse_mclass_policy_age age);
 enum hse_mclass_policy_age
 kbb_get_agegroup(struct kblock_builder *bld);
 
+void
+kbb_set_temp(struct kblock_builder *bld, enum hse_mclass_policy_temp temp);
+
 void
 kbb_set_merge_stats(struct kblock_builder *bld, struct cn_merge_stats *stats);
 
@@ -15,6 +15,7 @@
 
 #include <hse_ikvdb/kvs_rparams.h>
 #include <hse_ikvdb/tuple.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include <mpool/mpool.h>
 
@@ -60,6 +61,8 @@ kbr_read_wbt_region_desc_mem(void *wbt_hdr, struct wbt_desc *desc)
     desc->wbd_version = wbt_hdr_version(wbt_hdr);
 
     switch (desc->wbd_version) {
+        case WBT_TREE_VERSION8:
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
         case WBT_TREE_VERSION4:
@@ -173,6 +176,91 @@ kbr_read_pt_region_desc(struct kvs_mblk_desc *kblkdesc, struct wbt_desc *desc)
     return err;
 }
 
+merr_t
+kbr_read_rtombs(struct kvs_mblk_desc *kblkdesc, struct rtomb **listp)
+{
+    const struct kblock_rtomb_omf *omf;
+    struct kblock_hdr_omf *        kb_hdr;
+    struct rtomb *                 list, *rt, **tailp;
+    const u8 *                     p, *end;
+    size_t                         sz;
+    uint                           cnt, i;
+    merr_t                         err;
+    void *                         pg;
+    off_t                          pg_idxs[1];
+
+    *listp = NULL;
+
+    pg_idxs[0] = 0;
+    err = mpool_mcache_getpages(kblkdesc->map, 1, kblkdesc->map_idx, pg_idxs, &pg);
+    if (ev(err))
+        return err;
+
+    kb_hdr = pg;
+    if (!kblock_hdr_valid(kb_hdr))
+        return merr(EINVAL);
+
+    if (omf_kbh_version(kb_hdr) <= KBLOCK_HDR_VERSION5)
+        return 0;
+
+    cnt = omf_kbh_rt_cnt(kb_hdr);
+    if (!cnt)
+        return 0;
+
+    p = kblkdesc->map_base + PAGE_SIZE * omf_kbh_rt_doff_pg(kb_hdr);
+    end = p + PAGE_SIZE * omf_kbh_rt_dlen_pg(kb_hdr);
+
+    /* Size the list in a first pass, keeping each rtomb aligned.
+     */
+    sz = 0;
+    for (i = 0; i < cnt; ++i) {
+        uint slen, elen;
+
+        omf = (const void *)p;
+        if (ev(p + sizeof(*omf) > end))
+            return merr(EPROTO);
+
+        slen = omf_kro_slen(omf);
+        elen = omf_kro_elen(omf);
+        p += sizeof(*omf) + slen + elen;
+        if (ev(p > end))
+            return merr(EPROTO);
+
+        sz += ALIGN(rtomb_size(slen, elen), __alignof__(struct rtomb));
+    }
+
+    list = malloc(sz);
+    if (ev(!list))
+        return merr(ENOMEM);
+
+    p = kblkdesc->map_base + PAGE_SIZE * omf_kbh_rt_doff_pg(kb_hdr);
+    rt = list;
+    tailp = &list;
+
+    for (i = 0; i < cnt; ++i) {
+        omf = (const void *)p;
+
+        rt->rt_next = NULL;
+        rt->rt_seq = omf_kro_seq(omf);
+        rt->rt_skidx = 0;
+        rt->rt_slen = omf_kro_slen(omf);
+        rt->rt_elen = omf_kro_elen(omf);
+
+        p += sizeof(*omf);
+        memcpy(rt->rt_data, p, rt->rt_slen + rt->rt_elen);
+        p += rt->rt_slen + rt->rt_elen;
+
+        *tailp = rt;
+        tailp = &rt->rt_next;
+
+        rt = (void *)rt + ALIGN(rtomb_size(rt->rt_slen, rt->rt_elen), __alignof__(struct rtomb));
+    }
+
+    *listp = list;
+
+    return 0;
+}
+
 merr_t
 kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
 {
@@ -215,7 +303,7 @@ kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
      * it's safe to run without blooms, albeit at a big hit to read perf.
      */
     version = omf_bh_version(blm_omf);
-    if (ev(version != BLOOM_OMF_VERSION)) {
+    if (ev(version != BLOOM_OMF_VERSION && version != BLOOM_OMF_VERSION4)) {
         hse_log(
             HSE_ERR "%s: bloom %lx invalid version %u (expected %u)",
             __func__,
@@ -225,6 +313,20 @@ kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
         return 0;
     }
 
+    if (version > BLOOM_OMF_VERSION4) {
+        desc->bd_type = omf_bh_type(blm_omf);
+        if (ev(desc->bd_type != BLOOM_OMF_TYPE_BLOCK && desc->bd_type != BLOOM_OMF_TYPE_FUSE)) {
+            hse_log(HSE_ERR "%s: bloom %lx invalid type %u", __func__, mbid, desc->bd_type);
+            desc->bd_type = 0;
+            return 0;
+        }
+
+        desc->bd_fpbits = omf_bh_fpbits(blm_omf);
+        desc->bd_seglen = omf_bh_seglen(blm_omf);
+        desc->bd_segcnt = omf_bh_segcnt(blm_omf);
+        desc->bd_seed = omf_bh_seed(blm_omf);
+    }
+
     desc->bd_first_page = omf_kbh_blm_doff_pg(hdr);
     desc->bd_n_pages = omf_kbh_blm_dlen_pg(hdr);
 
@@ -233,6 +335,7 @@ kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
     desc->bd_n_hashes = omf_bh_n_hashes(blm_omf);
     desc->bd_rotl = omf_bh_rotl(blm_omf);
     desc->bd_bktmask = (1u << desc->bd_bktshift) - 1;
+    desc->bd_pfx_len = omf_bh_pfx_len(blm_omf);
 
     return 0;
 }
@@ -336,6 +439,18 @@ kbr_read_metrics(struct kvs_mblk_desc *kblkdesc, struct kblk_metrics *metrics)
     metrics->tot_wbt_pages = omf_kbh_wbt_dlen_pg(hdr);
     metrics->tot_blm_pages = omf_kbh_blm_dlen_pg(hdr);
 
+    if (omf_kbh_version(hdr) > KBLOCK_HDR_VERSION6) {
+        metrics->num_expiry = omf_kbh_exp_cnt(hdr);
+        metrics->expiry_val_bytes = omf_kbh_exp_vlen(hdr);
+        metrics->expiry_min = omf_kbh_exp_min(hdr);
+        metrics->expiry_max = omf_kbh_exp_max(hdr);
+    } else {
+        metrics->num_expiry = 0;
+        metrics->expiry_val_bytes = 0;
+        metrics->expiry_min = 0;
+        metrics->expiry_max = 0;
+    }
+
     return 0;
 }
 
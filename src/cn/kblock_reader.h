@@ -15,6 +15,7 @@ struct bloom_desc;
 struct wbt_desc;
 struct kvs_mblk_desc;
 struct kvs_rparams;
+struct rtomb;
 
 struct kblk_metrics {
     u32 num_keys;
@@ -23,6 +24,10 @@ struct kblk_metrics {
     u64 tot_val_bytes;
     u32 tot_wbt_pages;
     u32 tot_blm_pages;
+    u32 num_expiry;
+    u32 expiry_val_bytes;
+    u32 expiry_min;
+    u32 expiry_max;
 };
 
 /**
@@ -87,6 +92,17 @@ kbr_read_pt_region_desc(struct kvs_mblk_desc *kblkdesc, struct wbt_desc *desc);
 merr_t
 kbr_read_seqno_range(struct kvs_mblk_desc *kblkdesc, u64 *seqno_min, u64 *seqno_max);
 
+/**
+ * kbr_read_rtombs() - Read the range tombstones stored in a kblock
+ * @kblkdesc: KVBLOCK_DESC for KBLOCK to read
+ * @listp:    (output) list of rtombs, or NULL if there are none
+ *
+ * The list is allocated in one piece which the caller must release
+ * with free(*listp).
+ */
+merr_t
+kbr_read_rtombs(struct kvs_mblk_desc *kblkdesc, struct rtomb **listp);
+
 void
 kbr_free_blm_pages(struct kvs_mblk_desc *kbd, ulong cn_bloom_lookup, void *blm_pages);
 
@@ -17,9 +17,11 @@
 #include <hse_util/perfc.h>
 #include <hse_util/log2.h>
 #include <hse_util/mman.h>
-#include <hse_util/compression_lz4.h>
+#include <hse_util/compression.h>
 #include <hse_util/vlb.h>
 
+#include <pthread.h>
+
 #include <hse/hse_limits.h>
 #include <hse/kvdb_perfc.h>
 
@@ -56,6 +58,8 @@
 #include "mbset.h"
 #include "cn_tree.h"
 #include "cn_tree_internal.h"
+#include "cn_vcache.h"
+#include "cn_mbio.h"
 
 /*
  * kvset deferred deletes
@@ -309,6 +313,167 @@ kvset_kblk_init(
     return 0;
 }
 
+/* Kvsets with at least this many kblocks search their max fences in
+ * Eytzinger order, which keeps the first few levels of the search in
+ * a handful of cache lines and lets us prefetch ahead of the compares.
+ */
+#define KVSET_FENCE_EYTZ_MIN (32)
+
+static uint
+kvset_fence_eytz(struct kvset_fence *kf, uint i, uint k)
+{
+    if (k <= kf->kf_n) {
+        i = kvset_fence_eytz(kf, i, 2 * k);
+        kf->kf_emax[k] = kf->kf_max[i];
+        kf->kf_eidx[k] = i++;
+        i = kvset_fence_eytz(kf, i, 2 * k + 1);
+    }
+
+    return i;
+}
+
+/**
+ * kvset_fence_init() - build the packed kblock fence index
+ * @ks:     kvset whose kblocks have been initialized
+ * @n:      number of kblocks that contain keys
+ *
+ * Failure to allocate the index is not an error, lookups simply
+ * fall back to searching ks_kblks[] directly.
+ */
+static void
+kvset_fence_init(struct kvset *ks, uint n)
+{
+    struct kvset_fence *kf = &ks->ks_fence;
+    size_t              sz;
+    bool                eytz;
+    uint                i;
+    void *              mem;
+
+    eytz = n >= KVSET_FENCE_EYTZ_MIN;
+
+    sz = sizeof(*kf->kf_min) * n * 2;
+    if (eytz)
+        sz += (sizeof(*kf->kf_emax) + sizeof(*kf->kf_eidx)) * (n + 1);
+
+    mem = alloc_aligned(sz, SMP_CACHE_BYTES);
+    if (ev(!mem))
+        return;
+
+    kf->kf_min = mem;
+    kf->kf_max = kf->kf_min + n;
+    kf->kf_n = n;
+
+    for (i = 0; i < n; ++i) {
+        kf->kf_min[i] = ks->ks_kblks[i].kb_kdisc_min;
+        kf->kf_max[i] = ks->ks_kblks[i].kb_kdisc_max;
+    }
+
+    if (eytz) {
+        kf->kf_emax = kf->kf_max + n;
+        kf->kf_eidx = (void *)(kf->kf_emax + n + 1);
+
+        kvset_fence_eytz(kf, 0, 1);
+    }
+}
+
+/**
+ * kvset_fence_lb() - find the first kblock whose max fence is >= %kdisc
+ * @kf:     fence index
+ * @kdisc:  key discriminator
+ * @rcp:    (output) result of comparing %kdisc to the kblock's max fence
+ *
+ * Return: index of the kblock, or kf->kf_n if %kdisc is larger than
+ * the max fence of every kblock.
+ */
+static uint
+kvset_fence_lb(const struct kvset_fence *kf, const struct key_disc *kdisc, int *rcp)
+{
+    uint lo, hi, mid;
+
+    if (kf->kf_emax) {
+        uint k = 1;
+
+        while (k <= kf->kf_n) {
+            __builtin_prefetch(kf->kf_emax + 4 * k);
+            k = 2 * k + (key_disc_cmp(kf->kf_emax + k, kdisc) < 0);
+        }
+
+        k >>= __builtin_ffs(~k);
+        if (k == 0)
+            return kf->kf_n;
+
+        *rcp = key_disc_cmp(kdisc, kf->kf_emax + k);
+
+        return kf->kf_eidx[k];
+    }
+
+    lo = 0;
+    hi = kf->kf_n;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+
+        if (key_disc_cmp(kf->kf_max + mid, kdisc) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo < kf->kf_n)
+        *rcp = key_disc_cmp(kdisc, kf->kf_max + lo);
+
+    return lo;
+}
+
+/**
+ * kvset_fence_range() - narrow the range of kblocks that might contain a key
+ * @kf:     fence index
+ * @kdisc:  key discriminator
+ * @firstp: (output) first candidate kblock
+ * @lastp:  (output) last candidate kblock (less than *firstp if none)
+ *
+ * Discriminators order keys only up to their first sizeof(struct key_disc)
+ * bytes, so a key whose discriminator equals a fence must still be checked
+ * against the kblock's keys via kblk_plausible().
+ *
+ * Return: true if the key falls strictly between the fences of the
+ * only candidate kblock, in which case it needn't be checked further.
+ */
+static bool
+kvset_fence_range(
+    const struct kvset_fence *kf,
+    const struct key_disc *   kdisc,
+    int *                     firstp,
+    int *                     lastp)
+{
+    int  rcmin, rcmax = 0;
+    uint i, j;
+
+    i = kvset_fence_lb(kf, kdisc, &rcmax);
+
+    *firstp = i;
+    *lastp = i - 1;
+
+    if (i >= kf->kf_n)
+        return false;
+
+    rcmin = key_disc_cmp(kdisc, kf->kf_min + i);
+    if (rcmin < 0)
+        return false; /* key falls between two kblocks */
+
+    /* Subsequent kblocks whose min fence equals the key's
+     * discriminator might also contain the key.
+     */
+    for (j = i + 1; j < kf->kf_n; ++j) {
+        if (key_disc_cmp(kdisc, kf->kf_min + j))
+            break;
+    }
+
+    *lastp = j - 1;
+
+    return rcmin > 0 && rcmax < 0 && j == i + 1;
+}
+
 /**
  * blkid_list_to_vec()
  *
@@ -524,6 +689,8 @@ kvset_create2(
 
     /* initialize atomics */
     atomic_set(&ks->ks_ref, 0);
+    atomic64_set(&ks->ks_reads, 0);
+    atomic64_set(&ks->ks_heat, 0);
     atomic_set(&ks->ks_delete_error, 0);
     atomic_set(&ks->ks_mbset_callbacks, 0);
 
@@ -582,6 +749,13 @@ kvset_create2(
         /* save ptr to last kblock's hlog */
         ks->ks_hlog = hlog;
 
+        /* range tombstones are stored in the last kblock */
+        if (i == n_kblks - 1) {
+            err = kbr_read_rtombs(&kblk->kb_kblk_desc, &ks->ks_rtombs);
+            if (ev(err))
+                goto err_exit;
+        }
+
         /* kvset_stats from kblocks */
         ks->ks_st.kst_kalen += props.mpr_alloc_cap;
         ks->ks_st.kst_kwlen += props.mpr_write_len;
@@ -654,6 +828,15 @@ kvset_create2(
     ks->ks_kdisc_min = ks->ks_kblks[0].kb_kdisc_min;
     ks->ks_kdisc_max = ks->ks_kblks[n_kblks - 1].kb_kdisc_max;
 
+    /* Pack the kblock discriminators into a fence index for kblock
+     * selection, excluding a trailing kblock with only ptombs.
+     */
+    j = n_kblks;
+    if (j > 1 && ks->ks_kblks[j - 1].kb_wbt_desc.wbd_n_pages == 0)
+        --j;
+
+    kvset_fence_init(ks, j);
+
     /* Check to see if all keys in this kvset have a common prefix.
      * If so, then remember it so that we can leverage it to reduce
      * the amount of work required to find keys with common prefixes.
@@ -904,6 +1087,29 @@ _kvset_mbset_destroyed(void *rock, bool mblk_delete_error)
     cn_ref_put(cn);
 }
 
+/* Discard cached values that reside in this kvset's vblocks.
+ */
+static void
+kvset_vcache_invalidate(struct kvset *ks)
+{
+    struct cn_vcache *vcache;
+    u64               mbidv[64];
+    uint              i, j, n;
+
+    vcache = ks->ks_cn_kvdb ? ks->ks_cn_kvdb->cnd_vcache : NULL;
+    n = ks->ks_st.kst_vblks;
+
+    if (!vcache || n == 0)
+        return;
+
+    for (i = 0; i < n; i += j) {
+        for (j = 0; j < NELEM(mbidv) && i + j < n; j++)
+            mbidv[j] = lvx2mbid(ks, i + j);
+
+        cn_vcache_invalidate(vcache, mbidv, j);
+    }
+}
+
 void
 kvset_mark_mblocks_for_delete(struct kvset *ks, bool keepv, u64 txid)
 {
@@ -926,6 +1132,8 @@ kvset_mark_mblocks_for_delete(struct kvset *ks, bool keepv, u64 txid)
     if (ks->ks_deleted == DEL_ALL && ks->ks_vbsetc > 0) {
         uint i;
 
+        kvset_vcache_invalidate(ks);
+
         /* Acquire a reference on cn to prevent cn_close() from
          * completing until after all in-flight mbset destroy
          * operations have completed.  Released in the mbset
@@ -1007,6 +1215,8 @@ _kvset_destroy(struct kvset *ks)
         cndb_txn_ack_d(ks->ks_cndb, ks->ks_delete_txid, ks->ks_tag, ks->ks_cnid);
 
     free((void *)ks->ks_klarge);
+    free_aligned(ks->ks_fence.kf_min);
+    free(ks->ks_rtombs);
 
     if (ks->ks_kvset_sz > kvset_cache[0].sz)
         free_aligned(ks);
@@ -1088,6 +1298,12 @@ kblk_plausible(
     return 0; /* key might be in this kblock */
 }
 
+const struct rtomb *
+kvset_rtombs(struct kvset *ks)
+{
+    return ks->ks_rtombs;
+}
+
 /**
  * kvset_pt_start() - return index of kblock that contains pfx tombstones
  *
@@ -1179,6 +1395,57 @@ kvset_kblk_start(struct kvset *ks, const void *key, int len, bool reverse)
     }
 }
 
+bool
+kvset_pfx_plausible(struct kvset *ks, const void *pfx, uint pfx_len)
+{
+    struct kvs_ktuple kt;
+    struct key_disc   kdisc;
+    uint              hlen = 0;
+    int               i;
+
+    for (i = 0; i < ks->ks_st.kst_kblks; ++i) {
+        struct kvset_kblk *kblk = ks->ks_kblks + i;
+        uint               plen = kblk->kb_blm_desc.bd_pfx_len;
+        bool               hit = true;
+        merr_t             err;
+        int                rc;
+
+        /* Skip the trailing ptree-only kblock, it has no keys. */
+        if (kblk->kb_wbt_desc.wbd_n_pages == 0)
+            continue;
+
+        rc = kblk_plausible(kblk, &kdisc, pfx, -pfx_len, 0);
+        if (rc < 0)
+            break;
+        if (rc > 0)
+            continue;
+
+        /* Without prefix entries (or if the cursor's prefix is too
+         * short to use them) we can't rule this kblock out.
+         */
+        if (!plen || plen > pfx_len || !kblk->kb_blm_desc.bd_n_pages)
+            return true;
+
+        if (plen != hlen) {
+            kvs_ktuple_init(&kt, pfx, plen);
+            hlen = plen;
+        }
+
+        if (kblk->kb_blm_pages) {
+            hit = bloom_reader_buffer_lookup(&kblk->kb_blm_desc, kblk->kb_blm_pages, &kt);
+        } else {
+            err = bloom_reader_mcache_lookup(&kblk->kb_blm_desc, &kblk->kb_kblk_desc, &kt, &hit);
+            if (ev(err))
+                return true;
+        }
+
+        if (hit)
+            return true;
+    }
+
+    return false;
+}
+
 static merr_t
 kblk_get_value_ref(
     struct kvset *         ks,
@@ -1240,34 +1507,33 @@ kvset_ptomb_lookup(
     return 0;
 }
 
-static
-merr_t
-kvset_lookup_vref(
+/**
+ * kvset_lookup_kblk() - find the one kblock that might contain a key
+ * @ks:     kvset to search
+ * @kt:     key to search for
+ * @kdisc:  key discriminator
+ * @lcpp:   (output) longest common prefix of @kt and the kvset's keys
+ * @nkblkp: (output) incremented by the number of kblocks examined
+ *
+ * Return: index of the candidate kblock, or -1 if there is none
+ */
+static int
+kvset_lookup_kblk(
     struct kvset *         ks,
     struct kvs_ktuple *    kt,
     const struct key_disc *kdisc,
-    u64                    seq,
-    enum key_lookup_res *  result,
-    struct kvs_vtuple_ref *vref)
+    int *                  lcpp,
+    uint *                 nkblkp)
 {
-    int    first, last;
-    int    rc, i;
-    int    lcp;
-    merr_t err;
-
-    enum key_lookup_res   pt_result;
-    struct kvs_vtuple_ref pt_vref;
+    int first, last;
+    int rc, i;
+    int lcp;
 
     lcp = 0;
 
     first = 0;
     last = ks->ks_st.kst_kblks - 1;
 
-    pt_result = NOT_FOUND;
-    err = kvset_ptomb_lookup(ks, kt, seq, &pt_result, &pt_vref);
-    if (ev(err))
-        return err;
-
     /* If (kvset->ks_lcp > 0) then all keys in the kvset have a common
      * prefix of at least kvset->ks_lcp bytes.  Here we compute the
      * longest common prefix between the kvset and the target key.
@@ -1287,18 +1553,34 @@ kvset_lookup_vref(
      */
     rc = key_disc_cmp(kdisc, &ks->ks_kdisc_max);
     if (rc > 0)
-        goto done;
+        return -1;
 
     rc = key_disc_cmp(kdisc, &ks->ks_kdisc_min);
     if (rc < 0)
-        goto done;
+        return -1;
 
 search:
+    *lcpp = lcp;
+
     if (last && ks->ks_kblks[last].kb_wbt_desc.wbd_n_pages == 0)
         --last; /* last kblk contains only ptombs. Don't include it */
 
+    /* Narrow the search via the packed fence index, which usually
+     * leaves at most one candidate kblock.  The fences are of no
+     * use if the key shares a long prefix with the kvset's keys.
+     */
+    if (ks->ks_fence.kf_n > 0 && lcp < sizeof(*kdisc)) {
+        assert(ks->ks_fence.kf_n == last + 1);
+
+        if (kvset_fence_range(&ks->ks_fence, kdisc, &first, &last)) {
+            ++*nkblkp;
+            return first;
+        }
+    }
+
     while (first <= last) {
         i = (first + last) / 2;
+        ++*nkblkp;
 
         rc = kblk_plausible(ks->ks_kblks + i, kdisc, kt->kt_data, kt->kt_len, lcp);
         if (rc < 0) {
@@ -1310,21 +1592,82 @@ search:
             continue;
         }
 
-        err = kblk_get_value_ref(ks, i, kt, lcp, seq, result, vref);
-        if (ev(err))
-            return err;
-
-        break;
+        return i;
     }
 
-done:
+    return -1;
+}
+
+/* Merge the results of the prefix and range tombstone searches with the
+ * result of the kblock search for a key.
+ */
+static void
+kvset_lookup_done(
+    struct kvset *         ks,
+    struct kvs_ktuple *    kt,
+    u64                    seq,
+    uint                   nkblk,
+    enum key_lookup_res    pt_result,
+    struct kvs_vtuple_ref *pt_vref,
+    enum key_lookup_res *  result,
+    struct kvs_vtuple_ref *vref)
+{
+    if (nkblk > 0)
+        atomic64_inc(&ks->ks_reads);
+
     if (pt_result == FOUND_PTMB) {
-        if (*result == NOT_FOUND || pt_vref.vr_seq > vref->vr_seq) {
+        if (*result == NOT_FOUND || pt_vref->vr_seq > vref->vr_seq) {
             *result = pt_result;
-            *vref = pt_vref;
+            *vref = *pt_vref;
         }
     }
 
+    if (ks->ks_rtombs) {
+        u64 rt_seq = rtomb_list_seq(ks->ks_rtombs, -1, kt->kt_data, kt->kt_len, seq);
+
+        if (rt_seq && (*result == NOT_FOUND || rt_seq > vref->vr_seq)) {
+            *result = FOUND_TMB;
+            vref->vr_type = vtype_tomb;
+            vref->vr_seq = rt_seq;
+        }
+    }
+}
+
+static
+merr_t
+kvset_lookup_vref(
+    struct kvset *         ks,
+    struct kvs_ktuple *    kt,
+    const struct key_disc *kdisc,
+    u64                    seq,
+    enum key_lookup_res *  result,
+    struct kvs_vtuple_ref *vref,
+    uint *                 nkblkp)
+{
+    int    lcp = 0;
+    int    i;
+    uint   nkblk = 0;
+    merr_t err;
+
+    enum key_lookup_res   pt_result;
+    struct kvs_vtuple_ref pt_vref;
+
+    pt_result = NOT_FOUND;
+    err = kvset_ptomb_lookup(ks, kt, seq, &pt_result, &pt_vref);
+    if (ev(err))
+        return err;
+
+    i = kvset_lookup_kblk(ks, kt, kdisc, &lcp, &nkblk);
+    if (i >= 0) {
+        err = kblk_get_value_ref(ks, i, kt, lcp, seq, result, vref);
+        if (ev(err))
+            return err;
+    }
+
+    *nkblkp += nkblk;
+
+    kvset_lookup_done(ks, kt, seq, nkblk, pt_result, &pt_vref, result, vref);
+
     return 0;
 }
 
@@ -1415,7 +1758,7 @@ kvset_lookup_val_direct(
     if (freeme)
         vlb_free(iov.iov_base, iov.iov_len);
 
-    return 0;
+    return err;
 }
 
 static merr_t
@@ -1424,6 +1767,7 @@ kvset_lookup_val_direct_decompress(
     struct vblock_desc *vbd,
     u16                 vbidx,
     u32                 vboff,
+    uint                codec,
     void               *vbuf,
     uint                copylen,
     uint                omlen,
@@ -1459,7 +1803,7 @@ kvset_lookup_val_direct_decompress(
     } else {
         src = iov.iov_base + (vboff & ~PAGE_MASK);
 
-        err = compress_lz4_ops.cop_decompress(src, omlen, vbuf, copylen, outlenp);
+        err = compress_codec_decompress(codec, src, omlen, vbuf, copylen, outlenp);
     }
 
     if (freeme)
@@ -1473,15 +1817,20 @@ merr_t
 kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *vbuf)
 {
     struct vblock_desc *vbd;
+    struct cn_vcache   *vcache;
     merr_t              err;
     void               *src, *dst;
     uint                omlen, copylen;
+    u64                 mbid, vcoff;
     bool direct;
 
     assert(vref->vr_type == vtype_ival
         || vref->vr_type == vtype_zval
         || vref->vr_type == vtype_val
-        || vref->vr_type == vtype_cval);
+        || vref->vr_type == vtype_cval
+        || vref->vr_type == vtype_ccval);
+
+    vbuf->b_expiry = vref->vr_expiry;
 
     if (unlikely(vref->vr_type == vtype_zval)) {
         vbuf->b_len = 0;
@@ -1491,6 +1840,8 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
     if (vref->vr_type == vtype_ival)
         return kvset_get_immediate_value(vref, vbuf);
 
+    atomic64_inc(&ks->ks_reads);
+
     vbd = lvx2vbd(ks, vref->vb.vr_index);
     assert(vbd);
 
@@ -1505,17 +1856,37 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
     direct = copylen >= ks->ks_vmax
         || (copylen >= ks->ks_vmin && ks->ks_node_level >= ks->ks_vminlvl);
 
+    /* Values that would be read directly from media are cached in DRAM
+     * by (vblock id, offset), uncompressed and only when read in full.
+     */
+    vcache = NULL;
+    mbid = vcoff = 0;
+
+    if (direct && ks->ks_cn_kvdb && ks->ks_cn_kvdb->cnd_vcache) {
+        vcache = ks->ks_cn_kvdb->cnd_vcache;
+        mbid = lvx2mbid(ks, vref->vb.vr_index);
+        vcoff = vbd->vbd_off + vref->vb.vr_off;
+
+        if (cn_vcache_lookup(vcache, mbid, vcoff, dst, copylen))
+            goto done;
+    }
+
     if (vref->vb.vr_complen) {
         uint outlen;
 
         err = 0;
 
-        if (direct)
+        if (direct) {
             err = kvset_lookup_val_direct_decompress(
-                ks, vbd, vref->vb.vr_index, vref->vb.vr_off, dst, copylen, omlen, &outlen);
+                ks, vbd, vref->vb.vr_index, vref->vb.vr_off, vref->vb.vr_codec,
+                dst, copylen, omlen, &outlen);
+            if (!err && vcache && outlen == vref->vb.vr_len)
+                cn_vcache_insert(vcache, mbid, vcoff, dst, outlen);
+        }
 
         if (!direct || err) {
-            err = compress_lz4_ops.cop_decompress(src, omlen, dst, copylen, &outlen);
+            err = compress_codec_decompress(
+                vref->vb.vr_codec, src, omlen, dst, copylen, &outlen);
             if (ev(err))
                 return err;
         }
@@ -1530,8 +1901,11 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
         if (direct) {
             err = kvset_lookup_val_direct(
                 ks, vbd, vref->vb.vr_index, vref->vb.vr_off, vbuf->b_buf, vbuf->b_buf_sz, copylen);
-            if (!ev(err))
+            if (!ev(err)) {
+                if (vcache && copylen == vref->vb.vr_len)
+                    cn_vcache_insert(vcache, mbid, vcoff, dst, copylen);
                 goto done;
+            }
 
             err = 0; /* fall through to memcpy */
         }
@@ -1589,6 +1963,10 @@ kvset_pfx_lookup(
     if (*res == FOUND_PTMB)
         pt_seq = vref.vr_seq;
 
+    err = qctx_rtombs_add(qctx, ks->ks_rtombs, -1, kt->kt_data, kt->kt_len, seq);
+    if (ev(err))
+        return err;
+
     /* Find the relevant wbt and starting kbidx */
     kbidx = kvset_kblk_start(ks, kt->kt_data, -kt->kt_len, 0);
     if (kbidx < 0)
@@ -1672,6 +2050,16 @@ get_more:
 
         if (pt_seq && vseq < pt_seq)
             goto get_more; /* key is hidden behind ptomb; skip */
+
+        /* qctx holds the rtombs of c0, the newer kvsets and this one. */
+        if (qctx->rtombs) {
+            u8   kdata[HSE_KVS_KLEN_MAX];
+            uint klen;
+
+            key_obj_copy(kdata, sizeof(kdata), &klen, &kobj);
+            if (qctx_rtomb_seq(qctx, kdata, klen) > vseq)
+                *res = FOUND_TMB;
+        }
     }
 
     if (!kobj.ko_sfx_len) {
@@ -1747,12 +2135,13 @@ kvset_lookup(
     const struct key_disc *kdisc,
     u64                    seq,
     enum key_lookup_res *  res,
-    struct kvs_buf *       vbuf)
+    struct kvs_buf *       vbuf,
+    uint *                 nkblk)
 {
     struct kvs_vtuple_ref vref;
     merr_t                err;
 
-    err = kvset_lookup_vref(ks, kt, kdisc, seq, res, &vref);
+    err = kvset_lookup_vref(ks, kt, kdisc, seq, res, &vref, nkblk);
     if (ev(err))
         return err;
 
@@ -1762,6 +2151,120 @@ kvset_lookup(
     return kvset_lookup_val(ks, &vref, vbuf);
 }
 
+/* Sort the batch by candidate kblock so that the keys routed to the same
+ * kblock are adjacent.  Batches are small, so insertion sort suffices.
+ */
+static void
+kvset_lookupv_sort(const int *kblkv, u8 *idxv, uint cnt)
+{
+    uint i, j;
+
+    for (i = 1; i < cnt; ++i) {
+        u8 idx = idxv[i];
+
+        for (j = i; j > 0 && kblkv[idxv[j - 1]] > kblkv[idx]; --j)
+            idxv[j] = idxv[j - 1];
+
+        idxv[j] = idx;
+    }
+}
+
+merr_t
+kvset_lookupv(
+    struct kvset *           ks,
+    uint                     reqc,
+    struct kvset_lookup_req *reqv,
+    u64                      seq,
+    uint *                   nkblkp)
+{
+    struct kvs_ktuple *   ktv[KVSET_LOOKUPV_MAX];
+    struct kvs_vtuple_ref vref;
+    bool                  hitv[KVSET_LOOKUPV_MAX];
+    int                   kblkv[KVSET_LOOKUPV_MAX];
+    int                   lcpv[KVSET_LOOKUPV_MAX];
+    uint                  nkblkv[KVSET_LOOKUPV_MAX];
+    u8                    idxv[KVSET_LOOKUPV_MAX];
+    uint                  base, cnt, i, j, k;
+    merr_t                err;
+
+    for (base = 0; base < reqc; base += cnt) {
+        struct kvset_lookup_req *req = reqv + base;
+
+        cnt = min_t(uint, reqc - base, KVSET_LOOKUPV_MAX);
+
+        for (i = 0; i < cnt; ++i) {
+            lcpv[i] = 0;
+            nkblkv[i] = 0;
+            kblkv[i] = kvset_lookup_kblk(ks, req[i].kt, req[i].kdisc, lcpv + i, nkblkv + i);
+            idxv[i] = i;
+        }
+
+        kvset_lookupv_sort(kblkv, idxv, cnt);
+
+        /* Probe each candidate kblock's bloom once for all the keys
+         * routed to it.  Blooms not resident in memory are probed per
+         * key by kblk_get_value_ref().
+         */
+        for (i = 0; i < cnt; i = j) {
+            struct kvset_kblk *kblk;
+            int                kbi = kblkv[idxv[i]];
+
+            for (j = i + 1; j < cnt && kblkv[idxv[j]] == kbi; ++j)
+                ; /* find end of group */
+
+            if (kbi < 0)
+                continue;
+
+            kblk = ks->ks_kblks + kbi;
+            if (!kblk->kb_blm_pages)
+                continue;
+
+            for (k = i; k < j; ++k)
+                ktv[k - i] = req[idxv[k]].kt;
+
+            bloom_reader_buffer_lookupv(
+                &kblk->kb_blm_desc, kblk->kb_blm_pages, j - i, ktv, hitv + i);
+        }
+
+        for (k = 0; k < cnt; ++k) {
+            struct kvset_lookup_req *r = req + idxv[k];
+            struct kvs_vtuple_ref    pt_vref;
+            enum key_lookup_res      pt_result;
+            int                      kbi = kblkv[idxv[k]];
+
+            pt_result = NOT_FOUND;
+            err = kvset_ptomb_lookup(ks, r->kt, seq, &pt_result, &pt_vref);
+            if (ev(err))
+                return err;
+
+            if (kbi >= 0) {
+                struct kvset_kblk *kblk = ks->ks_kblks + kbi;
+                int                lcp = lcpv[idxv[k]];
+
+                if (!kblk->kb_blm_pages)
+                    err = kblk_get_value_ref(ks, kbi, r->kt, lcp, seq, r->res, &vref);
+                else if (hitv[k])
+                    err = wbtr_read_vref(
+                        &kblk->kb_kblk_desc, &kblk->kb_wbt_desc, r->kt, lcp, seq, r->res, &vref);
+                if (ev(err))
+                    return err;
+            }
+
+            *nkblkp += nkblkv[idxv[k]];
+
+            kvset_lookup_done(ks, r->kt, seq, nkblkv[idxv[k]], pt_result, &pt_vref, r->res, &vref);
+
+            if (*r->res == FOUND_VAL) {
+                err = kvset_lookup_val(ks, &vref, r->vbuf);
+                if (ev(err))
+                    return err;
+            }
+        }
+    }
+
+    return 0;
+}
+
 u64
 kvset_get_dgen(struct kvset *ks)
 {
@@ -1872,6 +2375,64 @@ kvset_set_scatter_pct(struct kvset *ks, uint spct)
     ks->ks_scatter_pct = spct;
 }
 
+u64
+kvset_get_heat(struct kvset *ks)
+{
+    return atomic64_read(&ks->ks_heat) + atomic64_read(&ks->ks_reads);
+}
+
+void
+kvset_set_heat(struct kvset *ks, u64 heat)
+{
+    atomic64_set(&ks->ks_heat, heat);
+}
+
+u64
+kvset_get_expired(struct kvset *ks, u32 now)
+{
+    u64 expired = 0;
+    u32 i;
+
+    for (i = 0; i < ks->ks_st.kst_kblks; i++) {
+        const struct kblk_metrics *m = &ks->ks_kblks[i].kb_metrics;
+
+        if (!m->num_expiry || now < m->expiry_min)
+            continue;
+
+        if (now >= m->expiry_max)
+            expired += m->expiry_val_bytes;
+        else
+            expired += (u64)m->expiry_val_bytes * (now - m->expiry_min) /
+                       (m->expiry_max - m->expiry_min + 1);
+    }
+
+    return expired;
+}
+
+void
+kvset_heat_decay(struct kvset *ks)
+{
+    long reads;
+
+    /* Reads that race with the decay are carried over to the next one.
+     */
+    reads = atomic64_read(&ks->ks_reads);
+    atomic64_sub(reads, &ks->ks_reads);
+
+    atomic64_set(&ks->ks_heat, atomic64_read(&ks->ks_heat) / 2 + reads);
+}
+
+uint
+kvset_get_vblks_staging(struct kvset *ks)
+{
+    uint i, n = 0;
+
+    for (i = 0; i < ks->ks_vbsetc; i++)
+        n += mbset_get_nstaging(ks->ks_vbsetv[i]);
+
+    return n;
+}
+
 u32
 kvset_get_num_kblocks(struct kvset *ks)
 {
@@ -1896,6 +2457,23 @@ kvset_get_nth_kblock_id(struct kvset *ks, u32 index)
     return (index < ks->ks_st.kst_kblks ? ks->ks_kblks[index].kb_kblk.bk_blkid : 0);
 }
 
+void
+kvset_get_nth_kblock_fence(
+    struct kvset *ks,
+    u32           index,
+    const void ** minkey,
+    u16 *         minklen,
+    u32 *         nkeys)
+{
+    struct kvset_kblk *kblk = ks->ks_kblks + index;
+
+    assert(index < ks->ks_st.kst_kblks);
+
+    *minkey = kblk->kb_koff_min;
+    *minklen = kblk->kb_klen_min;
+    *nkeys = kblk->kb_metrics.num_keys;
+}
+
 u32
 kvset_get_num_vblocks(struct kvset *ks)
 {
@@ -1967,6 +2545,7 @@ kvset_get_metrics(struct kvset *ks, struct kvset_metrics *m)
     m->num_vblocks = ks->ks_st.kst_vblks;
     m->compc = ks->ks_compc;
     m->vgroups = ks->ks_vgroups;
+    m->heat = kvset_get_heat(ks);
 
     for (i = 0; i < ks->ks_st.kst_kblks; i++) {
         p = ks->ks_kblks + i;
@@ -1997,12 +2576,20 @@ kvset_list_add_tail(struct kvset *ks, struct list_head *head)
 
 struct kv_iterator_ops kvset_iter_ops;
 
-/* async_mbio: for asynchronous mblock i/o */
+/* Iterators that read mblocks issue their reads through their own read
+ * engine, which can keep reads from the kblock, ptomb and vblock readers
+ * in flight at the same time.
+ */
+#define KVSET_MBIO_QDEPTH (8)
+
+/* async_mbio: a reader's mblock read, in flight on the iterator's read
+ * engine.  Completions are processed by the iterator's thread while it
+ * reaps the engine, hence no locking.
+ */
 struct async_mbio {
-    struct cv    cv;
-    struct mutex mutex;
-    int          pending;
-    int          status;
+    struct cn_mbio_req req;
+    bool               pending;
+    merr_t             status;
 };
 
 struct kr_buf {
@@ -2015,10 +2602,9 @@ struct kr_buf {
 
 struct kblk_reader {
 
-    struct work_struct work;
-    struct mpool *     ds;
-    struct async_mbio  mbio;
-    struct perfc_set * pc;
+    struct cn_mbio *  kr_mbio;
+    struct async_mbio mbio;
+    struct perfc_set *pc;
 
     /* io buffers */
     struct kr_buf kr_buf[2];
@@ -2039,7 +2625,12 @@ struct kblk_reader {
         uint  kr_ops;
     } iores;
 
-    u64 kr_mbid;
+    /* node count and last node flag of the read in flight */
+    u16  kr_io_nodec;
+    bool kr_io_last;
+
+    const struct kvs_mblk_desc *kr_mbd;
+
     u16 kr_kblk_cnt;
     u16 kr_nodex;
     u16 kr_nodec;
@@ -2060,18 +2651,16 @@ struct vr_buf {
  * must maintain its own vbidx to handle vblock transitions within a vgroup.
  */
 struct vblk_reader {
-    struct work_struct work;
-    struct async_mbio  mbio;
-    struct mpool *     ds;
-    struct perfc_set * pc;
+    struct async_mbio mbio;
+    struct perfc_set *pc;
     /* index, offset, and length of async mblock read */
     uint vr_io_vbidx;
     uint vr_io_offset;
     uint vr_io_len;
     /* mblock properties */
-    u64  vr_mbid;
-    uint vr_mblk_dstart;
-    uint vr_mblk_dlen;
+    const struct kvs_mblk_desc *vr_mbd;
+    uint                        vr_mblk_dstart;
+    uint                        vr_mblk_dlen;
     /* buffer */
     struct vr_buf vr_buf[2];
     uint          vr_buf_sz;
@@ -2120,6 +2709,8 @@ struct kvset_iterator {
     struct workqueue_struct *vra_wq;
     bool                     reverse;
     bool                     asyncio;
+    bool                     heat;
+    uint                     reads;
     struct iter_meta         wbti_meta;
     struct iter_meta         pti_meta;
 
@@ -2131,9 +2722,9 @@ struct kvset_iterator {
      */
 
     /* reader state */
-    struct kblk_reader       kreader;  /* kb work buffer */
-    struct vblk_reader *     vreaders; /* vb work buffer */
-    struct workqueue_struct *workq;
+    struct kblk_reader  kreader;  /* kb work buffer */
+    struct vblk_reader *vreaders; /* vb work buffer */
+    struct cn_mbio *    mbio;     /* read engine */
 
     struct kblk_reader ptreader; /* kb work buffer for ptombs */
 
@@ -2144,102 +2735,128 @@ struct kvset_iterator {
 
 #define handle_to_kvset_iter(_handle) container_of(_handle, struct kvset_iterator, handle)
 
+/* Cursor reads are tallied locally and added to the kvset's read count
+ * in batches to keep the kvset's cacheline out of the cursor read path.
+ */
+#define KVSET_ITER_READS_FLUSH (256)
+
 static void
 mbio_init(struct async_mbio *io)
 {
-    mutex_init(&io->mutex);
-    cv_init(&io->cv, "kvset_mbio");
-    io->status = 0;
-    io->pending = 0;
+    memset(io, 0, sizeof(*io));
 }
 
 static void
 mbio_arm(struct async_mbio *io)
 {
-    mutex_lock(&io->mutex);
     assert(!io->pending);
-    io->pending = 1;
-    mutex_unlock(&io->mutex);
+    io->pending = true;
 }
 
 static void
 mbio_signal(struct async_mbio *io, merr_t err)
 {
-    mutex_lock(&io->mutex);
     assert(io->pending);
     io->status = err;
-    io->pending = 0;
-    cv_signal(&io->cv);
-    mutex_unlock(&io->mutex);
+    io->pending = false;
 }
 
+/* Reap the engine until the given read completes.  Completions are
+ * reaped in the order the reads were submitted, so reads issued by the
+ * other readers ahead of this one are completed along the way.
+ */
 static merr_t
-mbio_wait(struct async_mbio *io, struct cn_merge_stats_ops *stats)
+mbio_wait(struct cn_mbio *mbio, struct async_mbio *io, struct cn_merge_stats_ops *stats)
 {
-    merr_t err;
-    u64    tstart = 0;
+    u64 tstart = 0;
 
-    mutex_lock(&io->mutex);
     if (stats && io->pending)
         tstart = get_time_ns();
-    while (io->pending)
-        cv_wait(&io->cv, &io->mutex);
+
+    while (io->pending) {
+        if (ev(cn_mbio_reap(mbio, 1) == 0) && io->pending)
+            return merr(EIO);
+    }
+
     if (tstart)
         count_ops(stats, 1, 0, get_time_ns() - tstart);
-    err = io->status;
-    mutex_unlock(&io->mutex);
-    return err;
+
+    return io->status;
+}
+
+/* Submit the reader's request, which completes by calling @cb.
+ */
+static void
+mbio_submit(struct cn_mbio *mbio, struct async_mbio *io, cn_mbio_cb *cb, void *rock)
+{
+    struct cn_mbio_req *req = &io->req;
+    merr_t              err;
+
+    req->mbr_cb = cb;
+    req->mbr_rock = rock;
+    req->mbr_err = 0;
+
+    err = cn_mbio_submit(mbio, &req, 1);
+    if (ev(err))
+        mbio_signal(io, err);
+}
+
+static void
+kblk_read_kmd_done(struct cn_mbio_req *req)
+{
+    struct kblk_reader *kr = req->mbr_rock;
+
+    if (ev(req->mbr_err))
+        goto done;
+
+    perfc_inc(kr->pc, PERFC_RA_CNCOMP_RREQS);
+    perfc_add(kr->pc, PERFC_RA_CNCOMP_RBYTES, req->mbr_iov.iov_len);
+
+    kr->iores.kr_ops = 2;
+    kr->iores.kr_bytes += req->mbr_iov.iov_len;
+
+    /* setup for next read */
+    kr->kr_nodex += kr->iores.kr_nodec;
+    if (kr->asyncio)
+        kr->kr_bufx = !kr->kr_bufx;
+
+done:
+    mbio_signal(&kr->mbio, req->mbr_err);
 }
 
+/* Leaf nodes have been read, read the kmd that corresponds to them.
+ */
 static void
-kvset_iter_kblock_read(struct work_struct *rock)
+kblk_read_nodes_done(struct cn_mbio_req *req)
 {
-    struct kblk_reader *     kr = container_of(rock, struct kblk_reader, work);
+    struct kblk_reader *     kr = req->mbr_rock;
     struct wbt_node_hdr_omf *hdr;
 
     struct iovec   iov;
-    merr_t         err = 0;
+    merr_t         err;
     uint           node_read_cnt;
-    size_t         a, b, kblk_off, rlen;
+    size_t         a, b, kblk_off;
     u32            end_node_kmd_off;
     u32            start_node_kmd_off;
-    bool           last_node;
     struct kr_buf *buf;
 
-    assert(kr->kr_nodex < kr->kr_nodec);
-
-    buf = &kr->kr_buf[kr->kr_bufx];
-
-    /* Read leaf nodes from mblock.  Need buffer space for at
-     * least two nodes as explained below.
-     */
-    assert(buf->node_buf_sz > 2 * PAGE_SIZE);
-    node_read_cnt = kr->kr_nodec - kr->kr_nodex;
-    if (node_read_cnt * PAGE_SIZE > buf->node_buf_sz) {
-        last_node = false;
-        node_read_cnt = buf->node_buf_sz / PAGE_SIZE;
-    } else {
-        last_node = true;
-    }
-
-    iov.iov_base = buf->node_buf;
-    iov.iov_len = node_read_cnt * PAGE_SIZE;
-    kblk_off = (kr->kr_node_start_pg + kr->kr_nodex) * PAGE_SIZE;
-
-    rlen = iov.iov_len;
-    err = mpool_mblock_read(kr->ds, kr->kr_mbid, &iov, 1, kblk_off);
+    err = req->mbr_err;
     if (ev(err))
-        goto done;
+        goto errout;
 
     perfc_inc(kr->pc, PERFC_RA_CNCOMP_RREQS);
-    perfc_add(kr->pc, PERFC_RA_CNCOMP_RBYTES, iov.iov_len);
+    perfc_add(kr->pc, PERFC_RA_CNCOMP_RBYTES, req->mbr_iov.iov_len);
+
+    buf = &kr->kr_buf[kr->kr_bufx];
+    iov = req->mbr_iov;
+    node_read_cnt = kr->kr_io_nodec;
 
     /* figure out kmd range that corresponds to leaf nodes */
     hdr = iov.iov_base;
     assert(omf_wbn_magic(hdr) == WBT_LFE_NODE_MAGIC);
     start_node_kmd_off = omf_wbn_kmd(hdr);
 
-    if (last_node) {
+    if (kr->kr_io_last) {
         end_node_kmd_off = kr->kr_kmd_pgc * PAGE_SIZE;
     } else {
         /* get end of kmd range last node */
@@ -2274,7 +2891,7 @@ kvset_iter_kblock_read(struct work_struct *rock)
         iov.iov_base = vlb_alloc(sz);
         if (ev(!iov.iov_base)) {
             err = merr(ENOMEM);
-            goto done;
+            goto errout;
         }
 
         vlb_free(buf->kmd_buf, buf->kmd_used_sz);
@@ -2287,41 +2904,68 @@ kvset_iter_kblock_read(struct work_struct *rock)
         buf->kmd_used_sz = iov.iov_len;
     }
 
-    rlen += iov.iov_len;
-    err = mpool_mblock_read(kr->ds, kr->kr_mbid, &iov, 1, kblk_off);
-    if (ev(err))
-        goto done;
-
-    perfc_inc(kr->pc, PERFC_RA_CNCOMP_RREQS);
-    perfc_add(kr->pc, PERFC_RA_CNCOMP_RBYTES, iov.iov_len);
-
     /* stash results in consumable form for caller */
-    kr->iores.kr_ops = 2;
-    kr->iores.kr_bytes = rlen;
+    kr->iores.kr_bytes = req->mbr_iov.iov_len;
     kr->iores.kr_nodec = node_read_cnt;
     kr->iores.kr_nodev = buf->node_buf;
     kr->iores.kr_kmd_base = buf->kmd_buf + start_node_kmd_off - a;
     kr->iores.kr_node_kmd_off_adj = start_node_kmd_off;
 
-    /* setup for next read */
-    kr->kr_nodex += kr->iores.kr_nodec;
-    if (kr->asyncio)
-        kr->kr_bufx = !kr->kr_bufx;
+    /* The engine is done with req, reuse it for the kmd read. */
+    req->mbr_off = kblk_off;
+    req->mbr_iov = iov;
 
-done:
+    mbio_submit(kr->kr_mbio, &kr->mbio, kblk_read_kmd_done, kr);
+    return;
+
+errout:
     mbio_signal(&kr->mbio, err);
 }
 
+static void
+kblk_read_nodes(struct kblk_reader *kr)
+{
+    struct cn_mbio_req *req = &kr->mbio.req;
+    struct kr_buf *     buf;
+    uint                node_read_cnt;
+    bool                last_node;
+
+    assert(kr->kr_nodex < kr->kr_nodec);
+
+    buf = &kr->kr_buf[kr->kr_bufx];
+
+    /* Read leaf nodes from mblock.  Need buffer space for at
+     * least two nodes as explained in kblk_read_nodes_done().
+     */
+    assert(buf->node_buf_sz > 2 * PAGE_SIZE);
+    node_read_cnt = kr->kr_nodec - kr->kr_nodex;
+    if (node_read_cnt * PAGE_SIZE > buf->node_buf_sz) {
+        last_node = false;
+        node_read_cnt = buf->node_buf_sz / PAGE_SIZE;
+    } else {
+        last_node = true;
+    }
+
+    kr->kr_io_nodec = node_read_cnt;
+    kr->kr_io_last = last_node;
+
+    req->mbr_mbd = kr->kr_mbd;
+    req->mbr_off = (kr->kr_node_start_pg + kr->kr_nodex) * PAGE_SIZE;
+    req->mbr_iov.iov_base = buf->node_buf;
+    req->mbr_iov.iov_len = node_read_cnt * PAGE_SIZE;
+
+    mbio_submit(kr->kr_mbio, &kr->mbio, kblk_read_nodes_done, kr);
+}
+
 enum read_type { READ_WBT = true, READ_PT = false };
 
 static void
 kblk_start_read(struct kvset_iterator *iter, struct kblk_reader *kr, enum read_type read_type)
 {
-    bool success       __maybe_unused;
     struct kvset_kblk *kblk;
 
     assert(!kr->mbio.pending);
-    assert(iter->workq);
+    assert(iter->mbio);
 
     if (kr->kr_nodex == kr->kr_nodec) {
         struct wbt_desc *wbt;
@@ -2338,7 +2982,7 @@ kblk_start_read(struct kvset_iterator *iter, struct kblk_reader *kr, enum read_t
 
         kr->kr_nodex = 0;
         kr->kr_nodec = wbt->wbd_leaf_cnt;
-        kr->kr_mbid = kblk->kb_kblk.bk_blkid;
+        kr->kr_mbd = &kblk->kb_kblk_desc;
         kr->kr_kmd_pgc = wbt->wbd_kmd_pgc;
         kr->kr_node_start_pg = wbt->wbd_first_page;
         kr->kr_kmd_start_pg = (wbt->wbd_first_page + wbt->wbd_root + 1);
@@ -2353,59 +2997,44 @@ kblk_start_read(struct kvset_iterator *iter, struct kblk_reader *kr, enum read_t
     }
 
     mbio_arm(&kr->mbio);
-    INIT_WORK(&kr->work, kvset_iter_kblock_read);
-    if (iter->asyncio) {
-        success = queue_work(iter->workq, &kr->work);
-        assert(success);
-    } else {
-        kvset_iter_kblock_read(&kr->work);
-    }
+    kblk_read_nodes(kr);
 }
 
 static void
-vr_read_work(struct work_struct *rock)
+vr_read_done(struct cn_mbio_req *req)
 {
-    struct vblk_reader *vr = container_of(rock, struct vblk_reader, work);
-    struct iovec        iov;
-    merr_t              err;
+    struct vblk_reader *vr = req->mbr_rock;
     int                 empty = !vr->vr_active;
-    size_t              vblk_offset;
-
-    iov.iov_base = vr->vr_buf[empty].data;
-    iov.iov_len = vr->vr_io_len;
 
-    /* adjust offset for start of vblock data region */
-    vblk_offset = vr->vr_io_offset + vr->vr_mblk_dstart;
-    err = mpool_mblock_read(vr->ds, vr->vr_mbid, &iov, 1, vblk_offset);
-    if (ev(err))
+    if (ev(req->mbr_err))
         goto done;
 
     perfc_inc(vr->pc, PERFC_RA_CNCOMP_RREQS);
-    perfc_add(vr->pc, PERFC_RA_CNCOMP_RBYTES, iov.iov_len);
+    perfc_add(vr->pc, PERFC_RA_CNCOMP_RBYTES, req->mbr_iov.iov_len);
 
     vr->vr_buf[empty].idx = vr->vr_io_vbidx;
     vr->vr_buf[empty].off = vr->vr_io_offset;
     vr->vr_buf[empty].len = vr->vr_io_len;
 
 done:
-    mbio_signal(&vr->mbio, err);
+    mbio_signal(&vr->mbio, req->mbr_err);
 }
 
 static bool
 vr_start_read(
-    struct vblk_reader *     vr,
-    uint                     vbidx,
-    uint                     vboff,
-    struct workqueue_struct *workq,
-    struct kvset *           ks)
+    struct vblk_reader *vr,
+    uint                vbidx,
+    uint                vboff,
+    struct cn_mbio *    mbio,
+    struct kvset *      ks)
 {
-    bool success __maybe_unused;
+    struct cn_mbio_req *req = &vr->mbio.req;
 
     /* update mblock properties */
     assert(lvx2vbd(ks, vbidx));
     vr->vr_mblk_dstart = lvx2vbd(ks, vbidx)->vbd_off;
     vr->vr_mblk_dlen = lvx2vbd(ks, vbidx)->vbd_len;
-    vr->vr_mbid = lvx2mbid(ks, vbidx);
+    vr->vr_mbd = &lvx2vbd(ks, vbidx)->vbd_mblkdesc;
 
     /* set io fields for async mblock read */
     vr->vr_io_vbidx = vbidx;
@@ -2418,15 +3047,14 @@ vr_start_read(
     if (vr->vr_io_len > vr->vr_buf_sz)
         vr->vr_io_len = vr->vr_buf_sz;
 
-    vr->mbio.pending = 1;
+    /* adjust offset for start of vblock data region */
+    req->mbr_mbd = vr->vr_mbd;
+    req->mbr_off = vr->vr_io_offset + vr->vr_mblk_dstart;
+    req->mbr_iov.iov_base = vr->vr_buf[!vr->vr_active].data;
+    req->mbr_iov.iov_len = vr->vr_io_len;
 
-    INIT_WORK(&vr->work, vr_read_work);
-    if (vr->asyncio) {
-        success = queue_work(workq, &vr->work);
-        assert(success);
-    } else {
-        vr_read_work(&vr->work);
-    }
+    mbio_arm(&vr->mbio);
+    mbio_submit(mbio, &vr->mbio, vr_read_done, vr);
 
     return true;
 }
@@ -2493,7 +3121,7 @@ kvset_iter_enable_mblock_read_cmn(struct kvset_iterator *iter, struct kblk_reade
     kr->asyncio = iter->asyncio;
 
     kr->kr_kblk_cnt = iter->ks->ks_st.kst_kblks;
-    kr->ds = iter->ks->ks_ds;
+    kr->kr_mbio = iter->mbio;
     kr->pc = iter->pc;
 
     mbio_init(&kr->mbio);
@@ -2600,7 +3228,6 @@ kvset_iter_enable_mblock_read(struct kvset_iterator *iter)
             vr->vr_active = 0;
             vr->vr_buf_sz = vr_buf_sz;
 
-            vr->ds = iter->ks->ks_ds;
             vr->pc = iter->pc;
         }
     }
@@ -2629,14 +3256,13 @@ kvset_iter_mblock_read_start(struct kvset_iterator *iter)
     if (iter->ks->ks_st.kst_vblks) {
         struct vblk_reader *vr = &iter->vreaders[0];
 
-        vr->vr_requested = vr_start_read(vr, 0, 0, iter->workq, iter->ks);
+        vr->vr_requested = vr_start_read(vr, 0, 0, iter->mbio, iter->ks);
     }
 }
 
 merr_t
 kvset_iter_create(
     struct kvset *           ks,
-    struct workqueue_struct *io_workq,
     struct workqueue_struct *vra_wq,
     struct perfc_set *       pc,
     enum kvset_iter_flags    flags,
@@ -2647,12 +3273,14 @@ kvset_iter_create(
     bool                   fullscan;
     bool                   reverse;
     bool                   mblock_read;
+    bool                   asyncio;
 
     mblock_read = !(flags & kvset_iter_flag_mcache);
     reverse = flags & kvset_iter_flag_reverse;
     fullscan = flags & kvset_iter_flag_fullscan;
+    asyncio = flags & kvset_iter_flag_asyncio;
 
-    if (ev(reverse && (io_workq || mblock_read)))
+    if (ev(reverse && (asyncio || mblock_read)))
         return merr(EINVAL);
 
     iter = kmem_cache_zalloc(kvset_iter_cache);
@@ -2679,12 +3307,21 @@ kvset_iter_create(
     iter->vra_len = min_t(u32, iter->vra_len, 1024 * 1024);
     iter->vra_wq = vra_wq;
 
-    iter->workq = io_workq;
     iter->last = SRC_NONE;
     iter->pc = pc;
 
+    /* Only cursor reads count toward the kvset's heat, not compaction.
+     */
+    iter->heat = !mblock_read && !fullscan;
+
     if (mblock_read) {
-        iter->asyncio = io_workq ? true : false;
+        iter->asyncio = asyncio;
+
+        if (iter->asyncio) {
+            err = cn_mbio_create(KVSET_MBIO_QDEPTH, NULL, NULL, &iter->mbio);
+            if (ev(err))
+                goto err_exit1;
+        }
 
         err = kvset_iter_enable_mblock_read(iter);
         if (ev(err))
@@ -2705,6 +3342,7 @@ err_exit2:
     kvset_iter_free_buffers(iter, &iter->kreader);
 
 err_exit1:
+    cn_mbio_destroy(iter->mbio);
     kmem_cache_free(kvset_iter_cache, iter);
     return err;
 }
@@ -3195,7 +3833,7 @@ kvset_iter_next_key_read(
             assert(iter->asyncio);
             kr->kr_requested = false;
         }
-        err = mbio_wait(&kr->mbio, ms ? &ms->ms_kblk_read_wait : 0);
+        err = mbio_wait(iter->mbio, &kr->mbio, ms ? &ms->ms_kblk_read_wait : 0);
         if (ev(err))
             return err;
         if (kr->kr_eof) {
@@ -3250,7 +3888,7 @@ kvset_iter_next_wbt_key(struct kv_iterator *handle, const void **kdata, uint *kl
     if (handle->kvi_eof)
         return 0;
 
-    if (iter->workq)
+    if (iter->mbio)
         return kvset_iter_next_key_read(iter, kdata, klen, READ_WBT);
 
     return kvset_iter_next_wbt_key_mcache(iter, kdata, klen);
@@ -3303,7 +3941,7 @@ kvset_iter_next_pt_key(struct kv_iterator *handle, const void **kdata, uint *kle
     if (handle->kvi_eof || iter->pti_meta.eof)
         return 0;
 
-    if (iter->workq)
+    if (iter->mbio)
         return kvset_iter_next_key_read(iter, kdata, klen, READ_PT);
 
     return kvset_iter_next_pt_key_mcache(iter, kdata, klen);
@@ -3363,6 +4001,11 @@ kvset_iter_next_key(struct kv_iterator *handle, struct key_obj *kobj, struct kvs
         fetch_wbti(iter, kobj, vc);
     }
 
+    if (iter->heat && ++iter->reads >= KVSET_ITER_READS_FLUSH) {
+        atomic64_add(iter->reads, &iter->ks->ks_reads);
+        iter->reads = 0;
+    }
+
     vc->off = 0;
     vc->nvals = 0;
     vc->next = 0;
@@ -3380,13 +4023,15 @@ kvset_iter_next_vref(
     uint *                  vboff,
     const void **           vdata,
     uint *                  vlen,
-    uint *                  complen)
+    uint *                  complen,
+    uint *                  codec)
 {
     assert(vc);
     assert(vc->kmd);
 
     *vlen = 0;
     *complen = 0;
+    *codec = 0;
 
     if (!vc->off) {
         assert(vc->nvals == 0);
@@ -3400,7 +4045,7 @@ kvset_iter_next_vref(
     if (vc->next >= vc->nvals)
         return false;
 
-    kmd_type_seq(vc->kmd, &vc->off, vtype, seq);
+    kmd_type_seq_exp(vc->kmd, &vc->off, vtype, seq, &vc->expiry);
     switch (*vtype) {
         case vtype_val:
             kmd_val(vc->kmd, &vc->off, vbidx, vboff, vlen);
@@ -3408,6 +4053,9 @@ kvset_iter_next_vref(
         case vtype_cval:
             kmd_cval(vc->kmd, &vc->off, vbidx, vboff, vlen, complen);
             break;
+        case vtype_ccval:
+            kmd_ccval(vc->kmd, &vc->off, vbidx, vboff, vlen, complen, codec);
+            break;
         case vtype_ival:
             kmd_ival(vc->kmd, &vc->off, vdata, vlen);
             break;
@@ -3420,6 +4068,16 @@ kvset_iter_next_vref(
             break;
     }
 
+    /* An expired value is returned as a tombstone, which compaction
+     * drops once nothing older can be exposed (see kcompact()).
+     */
+    if (kvs_expired(vc->expiry)) {
+        *vtype = vtype_tomb;
+        *vlen = 0;
+        *complen = 0;
+        *codec = 0;
+    }
+
     vc->next++;
     return true;
 }
@@ -3458,7 +4116,7 @@ kvset_iter_get_valptr_read(
     if (vr->vr_requested) {
         assert(vr->asyncio);
         /* wait for previous read to finish */
-        err = mbio_wait(&vr->mbio, ms ? &ms->ms_vblk_read1_wait : 0);
+        err = mbio_wait(iter->mbio, &vr->mbio, ms ? &ms->ms_vblk_read1_wait : 0);
         vr->vr_requested = false;
         if (ev(err))
             return err;
@@ -3481,10 +4139,10 @@ kvset_iter_get_valptr_read(
         ev(1);
     }
 
-    vr->vr_requested = vr_start_read(vr, vbidx, vboff, iter->workq, iter->ks);
+    vr->vr_requested = vr_start_read(vr, vbidx, vboff, iter->mbio, iter->ks);
     assert(vr->vr_requested);
     vr->vr_read_ahead = true;
-    err = mbio_wait(&vr->mbio, ms ? &ms->ms_vblk_read2_wait : 0);
+    err = mbio_wait(iter->mbio, &vr->mbio, ms ? &ms->ms_vblk_read2_wait : 0);
     vr->vr_requested = false;
     if (ev(err))
         return err;
@@ -3545,7 +4203,7 @@ have_data:
             off -= PAGE_SIZE;
         }
 
-        vr->vr_requested = vr_start_read(vr, vbidx, off, iter->workq, iter->ks);
+        vr->vr_requested = vr_start_read(vr, vbidx, off, iter->mbio, iter->ks);
         if (!vr->vr_requested)
             vr->vr_read_ahead = false;
     }
@@ -3591,7 +4249,7 @@ kvset_iter_get_valptr(
 {
     struct kvset_iterator *iter = handle_to_kvset_iter(handle);
 
-    if (iter->workq)
+    if (iter->mbio)
         return kvset_iter_get_valptr_read(iter, vbidx, vboff, vlen, vdata);
 
     *vdata = kvset_iter_get_valptr_mcache(iter, vbidx, vboff, vlen);
@@ -3614,6 +4272,7 @@ kvset_iter_next_val(
         case vtype_val:
             return kvset_iter_get_valptr(handle, vbidx, vboff, *vlen, vdata);
         case vtype_cval:
+        case vtype_ccval:
             return kvset_iter_get_valptr(handle, vbidx, vboff, *complen, vdata);
         case vtype_zval:
             *vdata = 0;
@@ -3664,39 +4323,21 @@ kvset_iter_next_val_direct(
 void
 kvset_iter_release(struct kv_iterator *handle)
 {
-    merr_t                 err;
     struct kvset_iterator *iter;
-    struct vblk_reader *   vr;
-    uint                   i;
 
     if (ev(!handle))
         return;
 
     iter = handle_to_kvset_iter(handle);
 
-    if (iter->workq) {
-        /* Due to read-ahead, it is normal for iterators to be released
-         * while a read is pending.  We must detect that and wait for
-         * pending I/O to complete.
-         */
-        if (iter->kreader.kr_requested) {
-            err = mbio_wait(&iter->kreader.mbio, 0);
-            ev(err);
-        }
-        if (iter->ptreader.kr_requested) {
-            err = mbio_wait(&iter->ptreader.mbio, 0);
-            ev(err);
-        }
-        if (iter->vreaders) {
-            for (i = 0; i < iter->ks->ks_vgroups; i++) {
-                vr = iter->vreaders + i;
-                if (vr->vr_requested) {
-                    err = mbio_wait(&vr->mbio, 0);
-                    ev(err);
-                }
-            }
-        }
-    }
+    /* Due to read-ahead, it is normal for iterators to be released
+     * while reads are in flight.  Destroying the engine waits for
+     * them to complete.
+     */
+    cn_mbio_destroy(iter->mbio);
+
+    if (iter->reads > 0)
+        atomic64_add(iter->reads, &iter->ks->ks_reads);
 
     wbti_destroy(iter->wbti);
     wbti_destroy(iter->pti);
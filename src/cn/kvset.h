@@ -31,6 +31,7 @@ struct mbset;
 struct cn_kvdb;
 struct cn_tree;
 struct cn_merge_stats;
+struct rtomb;
 
 #include "blk_list.h"
 
@@ -45,6 +46,7 @@ enum kvset_iter_flags {
     kvset_iter_flag_mcache = (1u << 0),
     kvset_iter_flag_reverse = (1u << 1),
     kvset_iter_flag_fullscan = (1u << 2),
+    kvset_iter_flag_asyncio = (1u << 3),
 };
 
 /**
@@ -252,6 +254,13 @@ kvset_get_max_key(struct kvset *km, void **key, uint *klen);
 u64
 kvset_ctime(const struct kvset *kvset);
 
+/**
+ * kvset_rtombs() - get the list of range tombstones in a kvset
+ */
+/* MTF_MOCK */
+const struct rtomb *
+kvset_rtombs(struct kvset *kvset);
+
 /* MTF_MOCK */
 int
 kvset_pt_start(struct kvset *kvset);
@@ -272,6 +281,21 @@ kvset_pt_start(struct kvset *kvset);
 int
 kvset_kblk_start(struct kvset *kvset, const void *key, int len, bool reverse);
 
+/**
+ * kvset_pfx_plausible() - determine if a kvset might have keys with a prefix
+ * @kvset:   kvset to search
+ * @pfx:     key prefix
+ * @pfx_len: length of @pfx
+ *
+ * Consults the prefix entries in the Bloom filters of the kblocks whose
+ * key range covers @pfx.  Only ever returns %false if the kvset most
+ * definitely has no keys under @pfx.  Prefix tombstones are not
+ * considered.
+ */
+/* MTF_MOCK */
+bool
+kvset_pfx_plausible(struct kvset *kvset, const void *pfx, uint pfx_len);
+
 /**
  * kvset_lookup() - Search a kvset for a key and return its value
  * @kvset:  kvset to search
@@ -282,7 +306,9 @@ kvset_kblk_start(struct kvset *kvset, const void *key, int len, bool reverse);
  * @vbuf:   (output) value if result==FOUND_VAL
  *                   If vbuf->b_buf is NULL, a buffer large enough to hold the
  *                   value will be allocated.
+ * @nkblk:  (output) incremented by the number of kblocks probed
  */
+/* MTF_MOCK */
 merr_t
 kvset_lookup(
     struct kvset *         kvset,
@@ -290,7 +316,47 @@ kvset_lookup(
     const struct key_disc *kdisc,
     u64                    seq,
     enum key_lookup_res *  res,
-    struct kvs_buf *       vbuf);
+    struct kvs_buf *       vbuf,
+    uint *                 nkblk);
+
+/* Maximum number of keys kvset_lookupv() searches at a time.
+ */
+#define KVSET_LOOKUPV_MAX 64
+
+/**
+ * struct kvset_lookup_req - one key of a kvset_lookupv() batch
+ * @kt:    key to search for
+ * @kdisc: key discriminator
+ * @res:   (output) see kvset_lookup(), must be NOT_FOUND on entry
+ * @vbuf:  (output) see kvset_lookup()
+ */
+struct kvset_lookup_req {
+    struct kvs_ktuple *    kt;
+    const struct key_disc *kdisc;
+    enum key_lookup_res *  res;
+    struct kvs_buf *       vbuf;
+};
+
+/**
+ * kvset_lookupv() - Search a kvset for a batch of keys
+ * @kvset:  kvset to search
+ * @reqc:   number of keys in @reqv
+ * @reqv:   vector of keys and result locations
+ * @seq:    sequence number
+ * @nkblk:  (output) incremented by the number of kblocks probed
+ *
+ * Same as calling kvset_lookup() for each key, except that the keys
+ * routed to the same kblock are checked against its bloom filter in a
+ * single bloom_reader_buffer_lookupv() call.
+ */
+/* MTF_MOCK */
+merr_t
+kvset_lookupv(
+    struct kvset *           kvset,
+    uint                     reqc,
+    struct kvset_lookup_req *reqv,
+    u64                      seq,
+    uint *                   nkblk);
 
 struct query_ctx;
 
@@ -363,6 +429,48 @@ kvset_get_vgroups(struct kvset *km);
 struct cn_tree *
 kvset_get_tree(struct kvset *kvset);
 
+/**
+ * kvset_get_heat() - get the read heat of a kvset
+ * @ks: kvset handle
+ *
+ * Heat counts the gets and cursor reads that reached the kvset's
+ * kblocks or vblocks, halved at each kvset_heat_decay().
+ */
+/* MTF_MOCK */
+u64
+kvset_get_heat(struct kvset *ks);
+
+/* MTF_MOCK */
+void
+kvset_set_heat(struct kvset *ks, u64 heat);
+
+/**
+ * kvset_get_expired() - estimate the bytes of expired values in a kvset
+ * @ks:  kvset handle
+ * @now: current time in seconds since the epoch
+ *
+ * The estimate is derived from the expiry summary in each kblock header
+ * and assumes expiry times are evenly spread between the earliest and
+ * latest expiry times in the kblock.
+ */
+/* MTF_MOCK */
+u64
+kvset_get_expired(struct kvset *ks, u32 now);
+
+/**
+ * kvset_heat_decay() - age the read heat of a kvset
+ * @ks: kvset handle
+ *
+ * Called periodically by the compaction scheduler.
+ */
+/* MTF_MOCK */
+void
+kvset_heat_decay(struct kvset *ks);
+
+/* MTF_MOCK */
+uint
+kvset_get_vblks_staging(struct kvset *ks);
+
 /**
  * kvset_defer_compc() - check to see k-compaction should be deferred
  * @km:        kvset handle
@@ -382,7 +490,6 @@ kvset_defer_compc(struct kvset *km, u64 totkeys);
 /**
  * kvset_iter_create() - Create iterator to traverse all entries in a kvset
  * @kvset:     kvset handle
- * @io_workq:  workqueue to assist with async I/O (see %FLAG_MBREAD)
  * @vra_wq:    workqueue for vblock readahead requests
  * @pc:
  * @flags:     option flags (see below)
@@ -393,12 +500,15 @@ kvset_defer_compc(struct kvset *km, u64 totkeys);
  *     be used with mcache map based iteration.
  *   - %kvset_iter_flag_mcache: If set, use mcache maps to access
  *     mblock data.  If not set, access data with mblock read.
+ *   - %kvset_iter_flag_asyncio: Overlap mblock reads with iteration work.
+ *     Ignored when iterating with mcache maps.
  *
  * Notes:
- *   - @io_workq is ignored when iterating with mcache maps.
- *   - With read-based compaction, if @io_workq is NULL, then mblock reads are
- *     issued synchronously using a single buffer.  If @io_workq is provided,
- *     then double buffering is used to overlap reads with iteration work.
+ *   - With read-based compaction, without %kvset_iter_flag_asyncio mblock
+ *     reads are issued synchronously using a single buffer.  With it, double
+ *     buffering is used and the reads are issued through a read engine owned
+ *     by the iterator (see cn_mbio.h), which keeps the kblock and vblock
+ *     reads in flight while the iterating thread works.
  *   - The iterator is destroyed by calling the iterator's release method, for
  *     example: kv_iter->kvsi_ops->kvsi_release(kv_iter);
  *
@@ -415,7 +525,6 @@ kvset_defer_compc(struct kvset *km, u64 totkeys);
 merr_t
 kvset_iter_create(
     struct kvset *           kvset,
-    struct workqueue_struct *io_workq,
     struct workqueue_struct *vra_wq,
     struct perfc_set *       pc,
     enum kvset_iter_flags    flags,
@@ -478,7 +587,8 @@ kvset_iter_next_vref(
     uint *                  vboff,
     const void **           vdata,
     uint *                  vlen,
-    uint *                  complen);
+    uint *                  complen,
+    uint *                  codec);
 
 /**
  * kvset_keep_vblocks - populate a vblock map from many-to-one
@@ -8,6 +8,7 @@
 #include <hse_ikvdb/key_hash.h>
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/cn.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include <hse/hse_limits.h>
 
@@ -135,6 +136,10 @@ kvset_builder_add_key(struct kvset_builder *self, const struct key_obj *kobj)
     self->key_stats.tot_vlen = 0;
     self->key_stats.seqno_prev = U64_MAX;
     self->key_stats.seqno_prev_ptomb = U64_MAX;
+    self->key_stats.nexpiry = 0;
+    self->key_stats.expiry_vlen = 0;
+    self->key_stats.expiry_min = 0;
+    self->key_stats.expiry_max = 0;
 
     self->main.kmd_used = 0;
     self->sec.kmd_used = 0;
@@ -142,6 +147,26 @@ kvset_builder_add_key(struct kvset_builder *self, const struct key_obj *kobj)
     return ev(err);
 }
 
+/* Track the expiry times and sizes of the values of the current key so that
+ * the kblock header can summarize how much of the kvset will expire and when.
+ */
+static void
+kvset_builder_add_expiry(struct kvset_builder *self, u32 expiry, uint vlen)
+{
+    struct kbb_key_stats *stats = &self->key_stats;
+
+    if (!expiry)
+        return;
+
+    if (!stats->nexpiry || expiry < stats->expiry_min)
+        stats->expiry_min = expiry;
+    if (expiry > stats->expiry_max)
+        stats->expiry_max = expiry;
+
+    stats->nexpiry++;
+    stats->expiry_vlen += vlen;
+}
+
 /**
  * kvset_builder_add_val() - Add a value or a tombstone to a kvset entry.
  * @builder: Kvset builder object.
@@ -151,6 +176,10 @@ kvset_builder_add_key(struct kvset_builder *self, const struct key_obj *kobj)
  * @vlen: Length of uncompressed value.
  * @complen: Length of compressed value if value is compressed. Must
  *           be set to 0 if value is not compressed.
+ * @codec: Id of the codec with which the value was compressed (ignored
+ *         if @complen is 0).
+ * @expiry: Expiry time of the value in seconds since the epoch, or 0 if
+ *          the value does not expire (ignored for tombstones).
  *
  * Notes on compression:
  * - If @complen > 0, then the value is already compressed and will be
@@ -171,7 +200,9 @@ kvset_builder_add_val(
     u64                     seq,
     const void             *vdata,
     uint                    vlen,
-    uint                    complen)
+    uint                    complen,
+    uint                    codec,
+    u32                     expiry)
 {
     merr_t           err;
     u64              seqno_prev;
@@ -188,12 +219,14 @@ kvset_builder_add_val(
         self->key_stats.nptombs++;
         self->last_ptseq = seq;
     } else if (!vdata || vlen == 0) {
-        kmd_add_zval(self->main.kmd, &self->main.kmd_used, seq);
+        kmd_add_zval(self->main.kmd, &self->main.kmd_used, seq, expiry);
+        kvset_builder_add_expiry(self, expiry, 0);
     } else if (complen == 0 && vlen <= CN_SMALL_VALUE_THRESHOLD) {
         /* Do not currently support compressed valus in KMD as an "ival", so
          * complen must be zero.
          */
-        kmd_add_ival(self->main.kmd, &self->main.kmd_used, seq, vdata, vlen);
+        kmd_add_ival(self->main.kmd, &self->main.kmd_used, seq, expiry, vdata, vlen);
+        kvset_builder_add_expiry(self, expiry, vlen);
         self->key_stats.tot_vlen += vlen;
     } else {
 
@@ -214,9 +247,20 @@ kvset_builder_add_val(
         self->key_stats.c0_vlen += omlen;
 
         if (complen)
-            kmd_add_cval(self->main.kmd, &self->main.kmd_used, seq, vbidx, vboff, vlen, complen);
+            kmd_add_cval(
+                self->main.kmd,
+                &self->main.kmd_used,
+                seq,
+                expiry,
+                vbidx,
+                vboff,
+                vlen,
+                complen,
+                codec);
         else
-            kmd_add_val(self->main.kmd, &self->main.kmd_used, seq, vbidx, vboff, vlen);
+            kmd_add_val(self->main.kmd, &self->main.kmd_used, seq, expiry, vbidx, vboff, vlen);
+
+        kvset_builder_add_expiry(self, expiry, omlen);
 
         /* stats (and space amp) use on-media length */
         self->vused += omlen;
@@ -246,7 +290,8 @@ kvset_builder_add_val(
 /**
  * kvset_builder_add_vref() - add a vtype_val or vtype_cval entry its a kvset
  *
- * If @complen > 0, a vtype_cval entry will written to media.
+ * If @complen > 0, a vtype_cval (or vtype_ccval if @codec is not LZ4)
+ * entry will written to media.
  * If @complen == 0, a vtype_val entry will written to media.
  */
 merr_t
@@ -256,7 +301,9 @@ kvset_builder_add_vref(
     uint                    vbidx,
     uint                    vboff,
     uint                    vlen,
-    uint                    complen)
+    uint                    complen,
+    uint                    codec,
+    u32                     expiry)
 {
     uint om_len = complen ? complen : vlen; /* on-media length */
 
@@ -264,9 +311,20 @@ kvset_builder_add_vref(
         return merr(ev(ENOMEM));
 
     if (complen > 0)
-        kmd_add_cval(self->main.kmd, &self->main.kmd_used, seq, vbidx, vboff, vlen, complen);
+        kmd_add_cval(
+            self->main.kmd,
+            &self->main.kmd_used,
+            seq,
+            expiry,
+            vbidx,
+            vboff,
+            vlen,
+            complen,
+            codec);
     else
-        kmd_add_val(self->main.kmd, &self->main.kmd_used, seq, vbidx, vboff, vlen);
+        kmd_add_val(self->main.kmd, &self->main.kmd_used, seq, expiry, vbidx, vboff, vlen);
+
+    kvset_builder_add_expiry(self, expiry, om_len);
 
     self->vused += om_len;
     self->key_stats.tot_vlen += om_len;
@@ -304,6 +362,24 @@ kvset_builder_add_nonval(struct kvset_builder *self, u64 seq, enum kmd_vtype vty
     return 0;
 }
 
+merr_t
+kvset_builder_add_rtomb(struct kvset_builder *self, const struct rtomb *rt)
+{
+    merr_t err;
+
+    if (ev(!rt || !rt->rt_slen || rt->rt_slen > HSE_KVS_KLEN_MAX || rt->rt_elen > HSE_KVS_KLEN_MAX))
+        return merr(EINVAL);
+
+    err = kbb_add_rtomb(self->kbb, rt);
+    if (ev(err))
+        return err;
+
+    self->seqno_max = max_t(u64, self->seqno_max, rt->rt_seq);
+    self->seqno_min = min_t(u64, self->seqno_min, rt->rt_seq);
+
+    return 0;
+}
+
 void
 kvset_builder_destroy(struct kvset_builder *bld)
 {
@@ -410,6 +486,13 @@ kvset_builder_set_agegroup(struct kvset_builder *self, enum hse_mclass_policy_ag
     vbb_set_agegroup(self->vbb, age);
 }
 
+void
+kvset_builder_set_temp(struct kvset_builder *self, enum hse_mclass_policy_temp temp)
+{
+    kbb_set_temp(self->kbb, temp);
+    vbb_set_temp(self->vbb, temp);
+}
+
 void
 kvset_builder_set_merge_stats(struct kvset_builder *self, struct cn_merge_stats *stats)
 {
@@ -438,6 +438,7 @@ wbn_leaf_check(
             u64            seq;
             const void *   ival;
             u32            ivlen;
+            u32            cvbidx, cvboff, cvlen, clen, codec;
 
             kb_info->kmd_idx = j;
 
@@ -454,6 +455,14 @@ wbn_leaf_check(
                         0)
                         err = true;
                     break;
+                case vtype_cval:
+                case vtype_ccval:
+                    if (vtype == vtype_ccval)
+                        kmd_ccval(kb_info->kmd, &off, &cvbidx, &cvboff, &cvlen, &clen, &codec);
+                    else
+                        kmd_cval(kb_info->kmd, &off, &cvbidx, &cvboff, &cvlen, &clen);
+                    kb_metrics->val_bytes += clen;
+                    break;
                 case vtype_tomb:
                     kb_metrics->tombs++;
                     break;
@@ -755,6 +764,8 @@ _kblock_check(struct kb_info *kb_info, struct vb_meta *vb_meta)
 
     wbt_ver = omf_wbt_version(wbt_hdr);
     switch (wbt_ver) {
+        case WBT_TREE_VERSION8:
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             kb_info->wbt_ops.wops_lfe = wbt_lfe;
@@ -783,6 +794,10 @@ _kblock_check(struct kb_info *kb_info, struct vb_meta *vb_meta)
     if (omf_bh_version(blm_hdr) > BLOOM_OMF_VERSION && (++errcnt))
         kb_err(kb_info, "Invalid bloom hdr version");
 
+    if (omf_bh_version(blm_hdr) > BLOOM_OMF_VERSION4 && omf_bh_type(blm_hdr) > BLOOM_OMF_TYPE_FUSE &&
+        (++errcnt))
+        kb_err(kb_info, "Invalid bloom hdr type");
+
     if (errcnt)
         return merr(ev(EILSEQ));
 
@@ -805,6 +820,15 @@ _kblock_check(struct kb_info *kb_info, struct vb_meta *vb_meta)
     kb_info->blm_desc.bd_n_hashes = omf_bh_n_hashes(blm_hdr);
     kb_info->blm_desc.bd_rotl = omf_bh_rotl(blm_hdr);
     kb_info->blm_desc.bd_bktmask = (1u << kb_info->blm_desc.bd_bktshift) - 1;
+    kb_info->blm_desc.bd_pfx_len = omf_bh_pfx_len(blm_hdr);
+
+    if (omf_bh_version(blm_hdr) > BLOOM_OMF_VERSION4) {
+        kb_info->blm_desc.bd_type = omf_bh_type(blm_hdr);
+        kb_info->blm_desc.bd_fpbits = omf_bh_fpbits(blm_hdr);
+        kb_info->blm_desc.bd_seglen = omf_bh_seglen(blm_hdr);
+        kb_info->blm_desc.bd_segcnt = omf_bh_segcnt(blm_hdr);
+        kb_info->blm_desc.bd_seed = omf_bh_seed(blm_hdr);
+    }
 
     kb_info->blm_data = (void *)kb_hdr + pgoff(kb_info->blm_desc.bd_first_page);
 
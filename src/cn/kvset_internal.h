@@ -16,6 +16,7 @@
 #include <hse_ikvdb/tuple.h>
 #include <hse_ikvdb/omf_kmd.h>
 #include <hse_ikvdb/kvset_view.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include <mpool/mpool.h>
 
@@ -53,6 +54,20 @@ struct kvset_kblk {
     struct kvs_block    kb_kblk;    /* blkid and handle */
 };
 
+/* Packed copies of the per-kblock key discriminators, searched during
+ * kblock selection before any kvset_kblk is touched.  kf_min[] and
+ * kf_max[] are in kblock order.  Large kvsets additionally lay out the
+ * max discriminators in Eytzinger order (1-based) in kf_emax[], with
+ * kf_eidx[] mapping each Eytzinger position to its kblock index.
+ */
+struct kvset_fence {
+    struct key_disc *kf_min;
+    struct key_disc *kf_max;
+    struct key_disc *kf_emax;
+    u32 *            kf_eidx;
+    uint             kf_n; /* number of kblocks with keys */
+};
+
 struct kvset {
     struct kvset_list_entry ks_entry; /* kvset list linkage */
 
@@ -88,6 +103,8 @@ struct kvset {
     struct key_disc ks_kdisc_min; /* min key in kvset */
     int             ks_lcp;       /* longest common prefix */
 
+    struct kvset_fence ks_fence; /* kblock min/max discriminators */
+
     const u8 *                ks_klarge; /* large key cache */
     struct mpool_mcache_map **ks_kmapv;
     struct mbset **           ks_vbsetv;
@@ -96,20 +113,24 @@ struct kvset {
     struct cn_work ks_kvset_cn_work;
     u64            ks_delete_txid;
 
+    struct rtomb *ks_rtombs; /* range tombstones (from last kblock) */
+
     const void *ks_maxkey;  /* largest key in kvset */
     const void *ks_minkey;  /* smallest key in kvset */
     u16         ks_maxklen; /* length of largest key */
     u16         ks_minklen; /* length of smallest key */
 
     __aligned(SMP_CACHE_BYTES) atomic_t ks_ref; /* reference count */
-    u32      ks_deleted;                        /* DEL_NONE, DEL_KEEPV, DEL_ALL */
-    atomic_t ks_delete_error;
-    atomic_t ks_mbset_callbacks;
-    bool     ks_mbset_cb_pending;
-    u64      ks_seqno_min;
-    size_t   ks_kvset_sz;
-    u64      ks_ctime;
-    u64      ks_tag;
+    u32        ks_deleted;                      /* DEL_NONE, DEL_KEEPV, DEL_ALL */
+    atomic_t   ks_delete_error;
+    atomic_t   ks_mbset_callbacks;
+    bool       ks_mbset_cb_pending;
+    u64        ks_seqno_min;
+    size_t     ks_kvset_sz;
+    u64        ks_ctime;
+    u64        ks_tag;
+    atomic64_t ks_reads; /* reads since the last heat decay */
+    atomic64_t ks_heat;  /* decayed read count */
 
     __aligned(SMP_CACHE_BYTES) struct kvset_kblk ks_kblks[];
 };
@@ -81,6 +81,7 @@ _mbset_mblk_getprops(struct mbset *self, mbset_udata_init_fn *cb)
 
     self->mbs_alen = 0;
     self->mbs_wlen = 0;
+    self->mbs_nstaging = 0;
 
     for (i = 0; i < self->mbs_idc; i++) {
 
@@ -98,6 +99,7 @@ _mbset_mblk_getprops(struct mbset *self, mbset_udata_init_fn *cb)
 
         self->mbs_alen += props.mpr_alloc_cap;
         self->mbs_wlen += props.mpr_write_len;
+        self->mbs_nstaging += (props.mpr_mclassp == MP_MED_STAGING);
     }
 
     free(argv);
@@ -43,6 +43,7 @@ mbset_udata_init_fn(
  * @mbs_del:  if true, delete mblocks in destructor
  * @mbs_alen: sum of mblock allocated lengths
  * @mbs_wlen: sum of mblock written lengths
+ * @mbs_nstaging: number of mblocks on the staging media class
  *
  * An "mbset" is a set of kblocks (or vblocks) owned by a single kvset and
  * possibly referenced by multiple kvsets (e.g., after k-compaction).
@@ -55,6 +56,7 @@ struct mbset {
     u64                       mbs_mblock_max;
     uint                      mbs_mapc;
     uint                      mbs_idc;
+    uint                      mbs_nstaging;
     struct mpool *            mbs_ds;
     atomic_t                  mbs_ref;
     mbset_callback *          mbs_callback;
@@ -125,6 +127,12 @@ mbset_get_alen(struct mbset *self)
     return self->mbs_alen;
 }
 
+static __always_inline uint
+mbset_get_nstaging(struct mbset *self)
+{
+    return self->mbs_nstaging;
+}
+
 static __always_inline struct mpool_mcache_map *
 mbset_get_map(struct mbset *self, uint blk_num)
 {
@@ -14,7 +14,7 @@
  *
  ****************************************************************/
 
-#define KBLOCK_HDR_VERSION ((u32)5)
+#define KBLOCK_HDR_VERSION ((u32)7)
 #define KBLOCK_HDR_MAGIC ((u32)0xfadedfad)
 
 /* This is currently set to 1350 which is the max key size supported. However,
@@ -24,6 +24,8 @@
 #define HSE_KBLOCK_OMF_KLEN_MAX ((u32)1350)
 
 /* older versions that are still supported */
+#define KBLOCK_HDR_VERSION6 ((u32)6)
+#define KBLOCK_HDR_VERSION5 ((u32)5)
 #define KBLOCK_HDR_VERSION4 ((u32)4)
 #define KBLOCK_HDR_VERSION3 ((u32)3)
 #define KBLOCK_HDR_VERSION2 ((u32)2)
@@ -72,6 +74,18 @@ struct kblock_hdr_omf {
     __le64 kbh_min_seqno;
     __le64 kbh_max_seqno;
 
+    /* range tombstones (version 6 and later) */
+    __le32 kbh_rt_doff_pg;
+    __le32 kbh_rt_dlen_pg;
+    __le32 kbh_rt_cnt;
+    __le32 kbh_rt_rsvd;
+
+    /* values with an expiry time (version 7 and later) */
+    __le32 kbh_exp_cnt;
+    __le32 kbh_exp_vlen;
+    __le32 kbh_exp_min;
+    __le32 kbh_exp_max;
+
 } __packed;
 
 /* Define set/get methods for kblock_hdr_omf */
@@ -107,6 +121,31 @@ OMF_SETGET(struct kblock_hdr_omf, kbh_pt_dlen_pg, 32)
 OMF_SETGET(struct kblock_hdr_omf, kbh_min_seqno, 64)
 OMF_SETGET(struct kblock_hdr_omf, kbh_max_seqno, 64)
 
+OMF_SETGET(struct kblock_hdr_omf, kbh_rt_doff_pg, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_rt_dlen_pg, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_rt_cnt, 32)
+
+OMF_SETGET(struct kblock_hdr_omf, kbh_exp_cnt, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_exp_vlen, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_exp_min, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_exp_max, 32)
+
+/*
+ * Range tombstone region OMF (part of the last kblock of a kvset)
+ *
+ * The region is a packed array of kbh_rt_cnt records, each of which is
+ * a kblock_rtomb_omf followed by the start and end keys.
+ */
+struct kblock_rtomb_omf {
+    __le64 kro_seq;
+    __le16 kro_slen;
+    __le16 kro_elen;
+} __packed;
+
+OMF_SETGET(struct kblock_rtomb_omf, kro_seq, 64)
+OMF_SETGET(struct kblock_rtomb_omf, kro_slen, 16)
+OMF_SETGET(struct kblock_rtomb_omf, kro_elen, 16)
+
 /*****************************************************************
  *
  * Bloom filter header OMF (part of the kblock)
@@ -114,17 +153,33 @@ OMF_SETGET(struct kblock_hdr_omf, kbh_max_seqno, 64)
  ****************************************************************/
 
 #define BLOOM_OMF_MAGIC ((u32)('b' << 24 | 'l' << 16 | 'm' << 8 | 'h'))
-#define BLOOM_OMF_VERSION ((u32)4)
+#define BLOOM_OMF_VERSION BLOOM_OMF_VERSION5
+#define BLOOM_OMF_VERSION4 ((u32)4)
+#define BLOOM_OMF_VERSION5 ((u32)5)
+
+/* Filter types (bh_type).  Version 4 headers have only block blooms
+ * and zero where bh_type now lives.
+ */
+#define BLOOM_OMF_TYPE_BLOCK (0)
+#define BLOOM_OMF_TYPE_FUSE (1)
 
 /**
  * struct bloom_hdr_omf -
  * @bh_magic:           BLOOM_OMF_MAGIC
  * @bh_version:         BLOOM_OMF_VERSION
- * @bh_bktsz:           number of bytes per bucket
+ * @bh_bitmapsz:        size of bitmap (or fingerprint array) in bytes
+ * @bh_modulus:         modulus used to convert first hash to bucket
+ * @bh_bktshift:        log2 of number of bits per bucket
+ * @bh_type:            filter type (BLOOM_OMF_TYPE_*, v5)
+ * @bh_fpbits:          fingerprint width in bits (fuse, v5)
  * @bh_rotl:            hash rotate left amount
  * @bh_n_hashes:        number of hashes per bucket
- * @bh_bitmapsz:        size of bitmap in bytes
- * @bh_modulus:         modulus used to convert first hash to bucket
+ * @bh_pfx_len:         if non-zero, the filter also holds the hash of each
+ *                      distinct bh_pfx_len-byte key prefix (zero in all
+ *                      headers written before prefix entries existed)
+ * @bh_seed:            hash seed (fuse, v5)
+ * @bh_seglen:          segment length (fuse, v5)
+ * @bh_segcnt:          number of segments spanned by first slots (fuse, v5)
  */
 struct bloom_hdr_omf {
     __le32 bh_magic;
@@ -132,11 +187,15 @@ struct bloom_hdr_omf {
     __le32 bh_bitmapsz;
     __le32 bh_modulus;
     __le32 bh_bktshift;
-    __le16 bh_rsvd1;
+    u8     bh_type;
+    u8     bh_fpbits;
     u8     bh_rotl;
     u8     bh_n_hashes;
-    __le32 bh_rsvd2;
+    __le32 bh_pfx_len;
     __le32 bh_rsvd3;
+    __le64 bh_seed;
+    __le32 bh_seglen;
+    __le32 bh_segcnt;
 } __packed;
 
 /* Define set/get methods for bloom_hdr_omf */
@@ -145,13 +204,33 @@ OMF_SETGET(struct bloom_hdr_omf, bh_version, 32)
 OMF_SETGET(struct bloom_hdr_omf, bh_bitmapsz, 32)
 OMF_SETGET(struct bloom_hdr_omf, bh_modulus, 32)
 OMF_SETGET(struct bloom_hdr_omf, bh_bktshift, 32)
+OMF_SETGET(struct bloom_hdr_omf, bh_type, 8)
+OMF_SETGET(struct bloom_hdr_omf, bh_fpbits, 8)
 OMF_SETGET(struct bloom_hdr_omf, bh_rotl, 8)
 OMF_SETGET(struct bloom_hdr_omf, bh_n_hashes, 8)
+OMF_SETGET(struct bloom_hdr_omf, bh_pfx_len, 32)
+OMF_SETGET(struct bloom_hdr_omf, bh_seed, 64)
+OMF_SETGET(struct bloom_hdr_omf, bh_seglen, 32)
+OMF_SETGET(struct bloom_hdr_omf, bh_segcnt, 32)
 
 /*****************************************************************
  *
  * Wanna B-Tree (WBT) On-Media-Format
  *
+ * OMF v8: Leaf nodes carry a dense array of 8-byte big-endian key heads
+ *         (the first eight bytes of each key suffix, zero padded) between
+ *         the leaf node entries and the key suffixes, at the first 8-byte
+ *         aligned offset past the last entry.  This lets a search compare
+ *         heads without touching the keys.  Internal nodes are unchanged.
+ *
+ * OMF v7: Added support for value compression codecs other than LZ4.
+ *         Uses a new value type (vtype_ccval) which carries a codec id
+ *         and affects KMD format.  As with v6, the WBTree header, leaf
+ *         and internal nodes are no different from OMF v5.  The version
+ *         is written into every kblock, not only those with vtype_ccval
+ *         entries, so v6 readers reject all v7 and later kblocks, even
+ *         those whose values are only LZ4 compressed.
+ *
  * OMF v6: Added support for compressed values. Uses a new value type
  *         (vtype_cval) which affects KMD format. Unfortunately,
  *         there is no version field for KMD, so we bump the WBTree
@@ -167,7 +246,9 @@ OMF_SETGET(struct bloom_hdr_omf, bh_n_hashes, 8)
 #define WBT_NODE_SIZE 4096 /* must equal system page size */
 
 #define WBT_TREE_MAGIC ((u32)0x4a3a2a1a)
-#define WBT_TREE_VERSION  WBT_TREE_VERSION6
+#define WBT_TREE_VERSION  WBT_TREE_VERSION8
+#define WBT_TREE_VERSION8 ((u32)8)
+#define WBT_TREE_VERSION7 ((u32)7)
 #define WBT_TREE_VERSION6 ((u32)6)
 #define WBT_TREE_VERSION5 ((u32)5)
 #define WBT_TREE_VERSION4 ((u32)4)
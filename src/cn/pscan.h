@@ -6,13 +6,14 @@
 #ifndef HSE_KVDB_CN_PSCAN_H
 #define HSE_KVDB_CN_PSCAN_H
 
-#include <hse_util/bin_heap.h>
+#include <hse_util/loser_tree.h>
 #include <hse_util/hse_err.h>
 #include <hse_util/inttypes.h>
 #include <hse_util/darray.h>
 #include "cn_metrics.h"
 
 struct cursor_summary;
+struct kvset;
 
 /**
  * struct pscan - allocated prefix scan context, including output buffer
@@ -21,7 +22,7 @@ struct cursor_summary;
  * @itermax:    max elements in iterv[] and esrcv[]
  * @iterv:      kvset iterator vector
  * @esrcv:      element source vector
- * @bin_heap:   how to merge iterators
+ * @lt:         loser tree merging the iterators
  * @cn:         cn this cursor operates upon
  * @buf:        where to store current key + value
  * @pfx:        prefix is saved here
@@ -41,9 +42,12 @@ struct cursor_summary;
  * @pt_set:     if the ptomb in pt_kobj, if there is one, is relevant.
  * @pt_kobj:    ptomb key obj (key in kblk OR pt_buf[] right after cur update)
  * @pt_seq:     ptomb's seqno
+ * @rtksv:      referenced kvsets that contain range tombstones
+ * @rtksc:      number of kvsets in rtksv[]
+ * @rtksmax:    max elements in rtksv[]
  */
 struct pscan {
-    struct bin_heap2 *      bh;
+    struct loser_tree *     lt;
     u32                     iterc;
     u32                     itermax;
     struct kv_iterator **   iterv;
@@ -70,6 +74,10 @@ struct pscan {
     u64            pt_seq;
     unsigned char  pt_buf[HSE_KVS_MAX_PFXLEN];
 
+    struct kvset **rtksv;
+    u32            rtksc;
+    u32            rtksmax;
+
     struct cn_merge_stats stats;
     struct kc_filter *    filter;
     void *                base;
@@ -5,6 +5,7 @@
 
 #include <hse_util/platform.h>
 #include <hse_util/event_counter.h>
+#include <hse_util/loser_tree.h>
 #include <hse_util/slab.h>
 
 #include <hse_ikvdb/kvs_cparams.h>
@@ -31,7 +32,7 @@
 #include "blk_list.h"
 
 /**
- * struct merge_item -- an item in the bin_heap
+ * struct merge_item -- an item produced by a merge source
  */
 struct merge_item {
     struct key_obj         kobj;
@@ -39,6 +40,40 @@ struct merge_item {
     uint                   src;
 };
 
+/**
+ * struct merge_src -- a kvset iterator as a loser tree element source
+ * @ms_es:    element source
+ * @ms_iter:  kvset iterator
+ * @ms_stats: merge stats
+ * @ms_errp:  where to record an iterator error
+ * @ms_src:   source number (lower numbered sources contain newer data)
+ * @ms_next:  index of the next ms_itemv[] to fill
+ * @ms_itemv: loser_tree_pop() advances the source of the item it pops,
+ *            so each source alternates between two items to keep the
+ *            popped item valid until it is copied out
+ */
+struct merge_src {
+    struct element_source  ms_es;
+    struct kv_iterator *   ms_iter;
+    struct cn_merge_stats *ms_stats;
+    merr_t *               ms_errp;
+    uint                   ms_src;
+    uint                   ms_next;
+    struct merge_item      ms_itemv[2];
+};
+
+/**
+ * struct merge_ctx -- k-way merge of kvset iterators
+ * @mc_lt:   loser tree over mc_srcv[]
+ * @mc_err:  first iterator error
+ * @mc_srcv: merge sources
+ */
+struct merge_ctx {
+    struct loser_tree *mc_lt;
+    merr_t             mc_err;
+    struct merge_src   mc_srcv[];
+};
+
 static int
 merge_item_compare(const void *a_blob, const void *b_blob)
 {
@@ -48,7 +83,7 @@ merge_item_compare(const void *a_blob, const void *b_blob)
 
     /* Tie breaker: If keycmp() return 0, the keys are equal, in this case
      * lower numbered merge sources contain newer data and must come out
-     * of the binheap first.
+     * of the merge first.
      */
     rc = key_obj_cmp(&a->kobj, &b->kobj);
     if (rc)
@@ -60,80 +95,122 @@ merge_item_compare(const void *a_blob, const void *b_blob)
     return 0;
 }
 
-static merr_t
-replenish(struct bin_heap *bh, struct kv_iterator **iterv, uint src, struct cn_merge_stats *stats)
+static u64
+merge_item_head(const void *blob)
 {
-    struct kv_iterator *iter = iterv[src];
-    merr_t              err;
-    struct merge_item   item;
+    const struct merge_item *item = blob;
 
-    if (unlikely(iter->kvi_eof))
-        return 0;
+    return key_obj_head64(&item->kobj);
+}
 
-    err = kvset_iter_next_key(iter, &item.kobj, &item.vctx);
-    if (ev(err))
-        return err;
-    if (unlikely(iter->kvi_eof))
-        return 0;
+static bool
+merge_src_next(struct element_source *es, void **element)
+{
+    struct merge_src * ms = container_of(es, struct merge_src, ms_es);
+    struct merge_item *item = ms->ms_itemv + ms->ms_next;
+    merr_t             err;
+
+    if (unlikely(ms->ms_iter->kvi_eof))
+        return false;
+
+    err = kvset_iter_next_key(ms->ms_iter, &item->kobj, &item->vctx);
+    if (ev(err)) {
+        if (!*ms->ms_errp)
+            *ms->ms_errp = err;
+        return false;
+    }
 
-    item.src = src;
+    if (unlikely(ms->ms_iter->kvi_eof))
+        return false;
 
-    err = bin_heap_insert(bh, &item);
-    if (ev(err))
-        return err;
+    item->src = ms->ms_src;
+    ms->ms_next ^= 1;
 
-    stats->ms_keys_in++;
-    stats->ms_key_bytes_in += key_obj_len(&item.kobj);
+    ms->ms_stats->ms_keys_in++;
+    ms->ms_stats->ms_key_bytes_in += key_obj_len(&item->kobj);
 
-    return 0;
+    *element = item;
+
+    return true;
+}
+
+static void
+merge_fini(struct merge_ctx *mc)
+{
+    if (mc) {
+        loser_tree_destroy(mc->mc_lt);
+        free(mc);
+    }
 }
 
 static merr_t
 merge_init(
-    struct bin_heap **     bh_out,
+    struct merge_ctx **    mc_out,
     struct kv_iterator **  iterv,
     u32                    iterc,
     struct cn_merge_stats *stats)
 {
-    u32    i;
-    merr_t err;
+    struct element_source **esv;
+    struct merge_ctx *      mc;
+    size_t                  sz;
+    merr_t                  err;
+    u32                     i;
+
+    sz = sizeof(*mc) + iterc * (sizeof(mc->mc_srcv[0]) + sizeof(*esv));
 
-    err = bin_heap_create(bh_out, iterc, sizeof(struct merge_item), merge_item_compare);
+    mc = calloc(1, sz);
+    if (ev(!mc))
+        return merr(ENOMEM);
+
+    err = loser_tree_create(max_t(u32, iterc, 1), merge_item_compare, merge_item_head, &mc->mc_lt);
     if (ev(err))
-        goto err_exit1;
+        goto err_exit;
 
-    stats->ms_srcs = iterc;
+    esv = (void *)(mc->mc_srcv + iterc);
 
     for (i = 0; i < iterc; i++) {
-        err = replenish(*bh_out, iterv, i, stats);
-        if (ev(err))
-            goto err_exit2;
+        struct merge_src *ms = mc->mc_srcv + i;
+
+        ms->ms_es = es_make(merge_src_next, NULL, NULL);
+        ms->ms_iter = iterv[i];
+        ms->ms_stats = stats;
+        ms->ms_errp = &mc->mc_err;
+        ms->ms_src = i;
+
+        esv[i] = &ms->ms_es;
     }
 
+    stats->ms_srcs = iterc;
+
+    err = loser_tree_prepare(mc->mc_lt, iterc, esv);
+    if (!err)
+        err = mc->mc_err;
+    if (ev(err))
+        goto err_exit;
+
+    *mc_out = mc;
+
     return 0;
 
-err_exit2:
-    bin_heap_destroy(*bh_out);
-err_exit1:
+err_exit:
+    merge_fini(mc);
+
     return err;
 }
 
 /* return true if item returned, false if no more items */
 static __always_inline bool
-get_next_item(
-    struct bin_heap *      bh,
-    struct kv_iterator **  iterv,
-    struct merge_item *    item,
-    struct cn_merge_stats *stats,
-    merr_t *               err_out)
+get_next_item(struct merge_ctx *mc, struct merge_item *item, merr_t *err_out)
 {
-    bool got_item;
+    struct merge_item *top;
+    bool               got_item;
 
-    got_item = bin_heap_get_delete(bh, item);
+    got_item = loser_tree_pop(mc->mc_lt, (void **)&top);
     if (got_item)
-        *err_out = replenish(bh, iterv, item->src, stats);
-    else
-        *err_out = 0;
+        *item = *top;
+
+    *err_out = mc->mc_err;
+
     return got_item;
 }
 
@@ -186,7 +263,7 @@ kv_spill_abort(struct cn_tstate_omf *omf, void *arg)
 static merr_t
 kv_spill(struct cn_compaction_work *w)
 {
-    struct bin_heap *     bh;
+    struct merge_ctx *    mc;
     struct merge_item     curr;
     merr_t                err;
     struct kvset_builder *child;
@@ -194,6 +271,7 @@ kv_spill(struct cn_compaction_work *w)
     u64   hash;
     uint  vlen;
     uint  complen;
+    uint  codec;
     uint  omlen;
     uint  cnum;
     u32   childmask; /* mask: which children get kvpairs */
@@ -214,6 +292,7 @@ kv_spill(struct cn_compaction_work *w)
     struct key_obj pt_kobj = { 0 };
     bool           pt_set = false;
     u64            pt_seq = 0;
+    u64            rt_seq = 0;
     u32            pt_spread; /* mask: which children get ptomb */
 
     uint   seqno_errcnt = 0;
@@ -230,11 +309,11 @@ kv_spill(struct cn_compaction_work *w)
     if (w->cw_prog_interval && w->cw_progress)
         tprog = jiffies;
 
-    err = merge_init(&bh, w->cw_inputv, w->cw_kvset_cnt, &w->cw_stats);
+    err = merge_init(&mc, w->cw_inputv, w->cw_kvset_cnt, &w->cw_stats);
     if (ev(err))
         return err;
 
-    more = get_next_item(bh, w->cw_inputv, &curr, &w->cw_stats, &err);
+    more = get_next_item(mc, &curr, &err);
     if (!more || ev(err))
         goto done;
 
@@ -272,6 +351,8 @@ new_key:
         }
     }
 
+    cn_compact_io_charge(w, false);
+
     /* Caller sets cw_pfx_len appropriately for the current
      * level, so no need to adapt the hash according to the
      * tree level.
@@ -315,6 +396,8 @@ new_key:
     emitted_seq = 0;
     emitted_seq_pt = 0;
 
+    rt_seq = cn_compact_rtomb_seq(w, &curr.kobj);
+
     dbg_prev_seq = 0;
     dbg_prev_src = 0;
     dbg_nvals_this_key = 0;
@@ -335,12 +418,12 @@ get_values:
 
         if (!kvset_iter_next_vref(
                 w->cw_inputv[curr.src], &curr.vctx, &seq, &vtype, &vbidx, &vboff,
-                &vdata, &vlen, &complen))
+                &vdata, &vlen, &complen, &codec))
             break;
 
         if (vtype == vtype_val)
             omlen = vlen;
-        else if (vtype == vtype_cval)
+        else if (vtype == vtype_cval || vtype == vtype_ccval)
             omlen = complen;
         else
             omlen = 0;
@@ -429,6 +512,9 @@ get_values:
             if (pt_set && seq < pt_seq)
                 break; /* drop val */
 
+            if (seq < rt_seq && !HSE_CORE_IS_PTOMB(vdata))
+                break; /* drop val hidden by an rtomb */
+
             if (HSE_CORE_IS_PTOMB(vdata)) {
                 pt_set = true;
                 pt_kobj = curr.kobj;
@@ -458,7 +544,7 @@ get_values:
                     if (w->cw_drop_tombv[i] && bg_val)
                         continue;
 
-                    err = kvset_builder_add_val(w->cw_child[i], seq, vdata, vlen, 0);
+                    err = kvset_builder_add_val(w->cw_child[i], seq, vdata, vlen, 0, 0, 0);
                     if (ev(err))
                         goto done;
 
@@ -470,7 +556,8 @@ get_values:
                 if (w->cw_drop_tombv[cnum] && HSE_CORE_IS_TOMB(vdata) && bg_val)
                     continue; /* skip value */
 
-                err = kvset_builder_add_val(child, seq, vdata, vlen, complen);
+                err = kvset_builder_add_val(
+                    child, seq, vdata, vlen, complen, codec, curr.vctx.expiry);
                 if (ev(err))
                     goto done;
 
@@ -519,7 +606,7 @@ get_values:
     dbg_nvals_this_key = 0;
     dbg_prev_src = curr.src;
 
-    more = get_next_item(bh, w->cw_inputv, &curr, &w->cw_stats, &err);
+    more = get_next_item(mc, &curr, &err);
     if (ev(err))
         goto done;
 
@@ -565,7 +652,7 @@ get_values:
         goto new_key;
 
 done:
-    bin_heap_destroy(bh);
+    merge_fini(mc);
     free_aligned(buf);
 
     /* We must ensure the latest version of the key hash map is persisted
@@ -627,6 +714,7 @@ cn_spill(struct cn_compaction_work *w)
             goto done;
 
         kvset_builder_set_merge_stats(w->cw_child[i], &w->cw_stats);
+        kvset_builder_set_temp(w->cw_child[i], w->cw_tempv[i]);
 
         pnode = w->cw_node;
         if (pnode && w->cw_action == CN_ACTION_SPILL) {
@@ -650,6 +738,14 @@ cn_spill(struct cn_compaction_work *w)
     if (ev(err))
         goto done;
 
+    /* Range tombstones may cover keys in every child.
+     */
+    for (i = 0; i < w->cw_outc; i++) {
+        err = cn_compact_rtombs_add(w, w->cw_child[i], w->cw_drop_tombv[i]);
+        if (ev(err))
+            goto done;
+    }
+
     /* Get each child's output mblocks */
     for (i = 0; i < w->cw_outc; i++) {
         err = kvset_builder_get_mblocks(w->cw_child[i], &w->cw_outv[i]);
@@ -9,6 +9,9 @@
 #include <hse_util/slab.h>
 #include <hse_util/page.h>
 #include <hse_util/bloom_filter.h>
+#include <hse_util/fuse_filter.h>
+
+#include <hse_ikvdb/key_hash.h>
 
 #include "../omf.h"
 #include "../bloom_reader.h"
@@ -96,7 +99,8 @@ read_blooms(struct mtf_test_info *lcl_ti, char *kblock_file)
     mpm_mblock_read(blkid, &blm_hdr, omf_kbh_blm_hoff(&kb_hdr), omf_kbh_blm_hlen(&kb_hdr));
 
     ASSERT_EQ(omf_bh_magic(&blm_hdr), BLOOM_OMF_MAGIC);
-    ASSERT_EQ(omf_bh_version(&blm_hdr), BLOOM_OMF_VERSION);
+    /* The test images predate fuse filters. */
+    ASSERT_EQ(omf_bh_version(&blm_hdr), BLOOM_OMF_VERSION4);
 
     ASSERT_GE(omf_bh_bktshift(&blm_hdr), 9);
     ASSERT_LE(omf_bh_bktshift(&blm_hdr), 16);
@@ -186,4 +190,43 @@ MTF_DEFINE_UTEST_PRE(bloom_reader_test, t_bloom_reader_filter_info, test_prehook
     ASSERT_EQ(modulus, 1234);
 }
 
+MTF_DEFINE_UTEST_PRE(bloom_reader_test, fuse_lookup, test_prehook)
+{
+    struct bloom_desc  desc = {};
+    struct fuse_filter ff;
+    struct kvs_ktuple  ktv[64];
+    struct kvs_ktuple *ktpv[NELEM(ktv)];
+    bool               hitv[NELEM(ktv)];
+    u64                keyv[NELEM(ktv)];
+    u64                hashv[NELEM(ktv)];
+    u8                 data[PAGE_SIZE];
+    merr_t             err;
+    int                i;
+
+    for (i = 0; i < NELEM(ktv); i++) {
+        keyv[i] = i * 7919;
+        hashv[i] = key_hash64(&keyv[i], sizeof(keyv[i]));
+    }
+
+    err = ff_filter_build(&ff, 8, NELEM(hashv), hashv, data, sizeof(data));
+    ASSERT_EQ(0, err);
+
+    desc.bd_type = BLOOM_OMF_TYPE_FUSE;
+    desc.bd_fpbits = ff.ff_fpbits;
+    desc.bd_seglen = ff.ff_seglen;
+    desc.bd_segcnt = ff.ff_segcnt;
+    desc.bd_seed = ff.ff_seed;
+
+    for (i = 0; i < NELEM(ktv); i++) {
+        kvs_ktuple_init(&ktv[i], &keyv[i], sizeof(keyv[i]));
+        ASSERT_TRUE(bloom_reader_buffer_lookup(&desc, data, &ktv[i]));
+        ktpv[i] = &ktv[i];
+    }
+
+    bloom_reader_buffer_lookupv(&desc, data, NELEM(ktv), ktpv, hitv);
+
+    for (i = 0; i < NELEM(ktv); i++)
+        ASSERT_TRUE(hitv[i]);
+}
+
 MTF_END_UTEST_COLLECTION(bloom_reader_test)
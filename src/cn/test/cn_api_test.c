@@ -105,7 +105,7 @@ MTF_DEFINE_UTEST_PRE(cn_api, basic, pre)
     ASSERT_EQ(0, cnid);
 
     (void)cn_get_cancel(cn);
-    (void)cn_get_io_wq(cn);
+    (void)cn_get_tbkt_maint(cn);
     (void)cn_get_sched(cn);
     (void)cn_get_cndb(cn);
     (void)cn_get_perfc(cn, CN_ACTION_COMPACT_K);
@@ -26,6 +26,7 @@
 #include <hse_ikvdb/cn_cursor.h>
 #include <hse_ikvdb/cursor.h>
 #include <hse_ikvdb/kvdb_health.h>
+#include <hse_ikvdb/rtomb.h>
 #include <mpool/mpool.h>
 
 #include "../cn_internal.h"
@@ -559,6 +560,129 @@ MTF_DEFINE_UTEST_PREPOST(cn_cursor, root_4kvsets, pre, post)
     free(cndb.cndb_cbuf);
 }
 
+/* The kvset returned by _kvset_rtombs() holds rtomb_list, others none.
+ */
+static struct kvset *rtomb_kvset;
+static struct rtomb *rtomb_list;
+
+static const struct rtomb *
+_kvset_rtombs(struct kvset *ks)
+{
+    return ks == rtomb_kvset ? rtomb_list : NULL;
+}
+
+static struct rtomb *
+make_rtomb(u32 start, u32 end, u64 seq)
+{
+    struct rtomb *rt;
+
+    rt = calloc(1, rtomb_size(sizeof(start), sizeof(end)));
+    if (rt) {
+        rt->rt_seq = seq;
+        rt->rt_slen = sizeof(start);
+        rt->rt_elen = sizeof(end);
+
+        start = htonl(start);
+        end = htonl(end);
+        memcpy(rt->rt_data, &start, sizeof(start));
+        memcpy(rt->rt_data + sizeof(start), &end, sizeof(end));
+    }
+
+    return rt;
+}
+
+MTF_DEFINE_UTEST_PREPOST(cn_cursor, root_rtomb, pre, post)
+{
+    struct cn *         cn;
+    struct cn_tree *    tree;
+    struct mock_kvset * mk;
+    struct mpool *      ds = (void *)-1;
+    struct kv_iterator *itv[2];
+    merr_t              err;
+    int                 i;
+    struct cndb         cndb;
+    struct cndb_cn      cndbcn = cndb_cn_initializer(3, 0, 0);
+    struct kvs_cparams  cp = {};
+
+    struct kvdb_kvs kk = { 0 };
+    u64             dummy_ikvdb[32] = { 0 };
+
+    /*
+     * The newer kvset holds keys 0x400..0x4ff and an rtomb [0x100, 0x200)
+     * which hides those keys in the older kvset.  All mock values have
+     * seqno 1, the rtomb has seqno 2.
+     */
+    struct nkv_tab make[] = { { 0x400, 0, 0, VMX_S32, KVDATA_BE_KEY, 1 },
+                              { 0x100, 0x400, 0x1400, VMX_S32, KVDATA_BE_KEY, 2 } };
+
+    unsigned char pfx1[] = { 0, 0, 1 };
+    unsigned char pfx2[] = { 0, 0, 2 };
+    unsigned char all[] = { 0, 0 };
+
+    struct nkv_tab vtab[] = {
+        { 0x100,     0,      0, VMX_S32, 0, 0 },
+        /* rtomb hides 0x100..0x1ff */
+        { 0x200, 0x200,  0x200, VMX_S32, 0, 0 },
+        { 0x100, 0x400, 0x1400, VMX_S32, 0, 0 },
+        { 0 },
+    };
+
+    ITV_INIT(itv, 0, make);
+    ITV_INIT(itv, 1, make);
+
+    rtomb_list = make_rtomb(0x100, 0x200, 2);
+    ASSERT_NE(NULL, rtomb_list);
+    rtomb_kvset = ITV_KVSET(itv[1]);
+
+    mapi_inject_unset(mapi_idx_kvset_rtombs);
+    MOCK_SET(kvset, _kvset_rtombs);
+
+    mk = ITV_KVSET_MOCK(itv[1]);
+    mapi_inject(mapi_idx_cn_tree_initial_dgen, mk->dgen);
+    mapi_inject_ptr(mapi_idx_ikvdb_get_csched, NULL);
+
+    err = cndb_init(&cndb, ds, true, 0, CNDB_ENTRIES, 0, 0, &health);
+    ASSERT_EQ(err, 0);
+
+    cndb.cndb_cnc = 1;
+    cndb.cndb_cnv[0] = &cndbcn;
+
+    kk.kk_parent = (void *)&dummy_ikvdb;
+    kk.kk_cparams = &cp;
+    kk.kk_cparams->cp_fanout = 1 << 3;
+
+    err = cn_open(0, ds, &kk, &cndb, 0, &rp, "mp", "kvs", &health, 0, &cn);
+    ASSERT_EQ(err, 0);
+
+    tree = cn_get_tree(cn);
+    ASSERT_NE(tree, NULL);
+
+    for (i = 0; i < NELEM(make); ++i) {
+        err = cn_tree_insert_kvset(tree, ITV_KVSET(itv[i]), 0, 0);
+        ASSERT_EQ(err, 0);
+    }
+
+    verify_cursor(lcl_ti, cn, all, sizeof(all), vtab, 3);
+    verify_cursor(lcl_ti, cn, pfx1, sizeof(pfx1), 0, 0);
+    verify_cursor(lcl_ti, cn, pfx2, sizeof(pfx2), vtab + 1, 1);
+
+    err = cn_close(cn);
+    ASSERT_EQ(err, 0);
+
+    MOCK_UNSET(kvset, _kvset_rtombs);
+    free(rtomb_list);
+    rtomb_list = NULL;
+    rtomb_kvset = NULL;
+
+    for (i = 0; i < NELEM(make); ++i)
+        kvset_iter_release(itv[i]);
+
+    free(cndb.cndb_workv);
+    free(cndb.cndb_keepv);
+    free(cndb.cndb_tagv);
+    free(cndb.cndb_cbuf);
+}
+
 MTF_DEFINE_UTEST_PREPOST(cn_cursor, prefix_tree, pre, post)
 {
     struct cn *         cn;
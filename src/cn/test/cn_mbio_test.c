@@ -0,0 +1,464 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_ut/framework.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/logging.h>
+#include <hse_util/page.h>
+#include <hse_util/xrand.h>
+
+#include "../cn_mbio.h"
+#include "../kvs_mblk_desc.h"
+#include "mock_mpool.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+
+/* The file-backed mblock stand-in is a temporary file holding MBLKC
+ * fixed-size mblocks, each filled with a pattern derived from its id.
+ */
+#define MBLKC (8)
+#define MBLKSZ (256 * 1024)
+#define MBID_BASE (1000)
+
+static int  mbfd = -1;
+static char mbpath[] = "/tmp/cn_mbio_test.XXXXXX";
+
+/* Descriptors of the file-backed mblocks, plus one of an unknown mblock.
+ * They have no mcache map.
+ */
+static struct kvs_mblk_desc mbdv[MBLKC + 1];
+
+static inline u32
+pattern(u64 mbid, off_t off)
+{
+    return (u32)(mbid << 20) ^ (u32)off;
+}
+
+static merr_t
+file_map(void *rock, u64 mbid, int *fdp, off_t *basep)
+{
+    if (mbid < MBID_BASE || mbid >= MBID_BASE + MBLKC)
+        return merr(ENOENT);
+
+    *fdp = *(int *)rock;
+    *basep = (mbid - MBID_BASE) * MBLKSZ;
+
+    return 0;
+}
+
+static void
+read_done(struct cn_mbio_req *req)
+{
+    atomic_t *donecnt = req->mbr_rock;
+
+    atomic_inc(donecnt);
+}
+
+static bool
+verify(const struct cn_mbio_req *req)
+{
+    const u32 *p = req->mbr_iov.iov_base;
+    size_t     i;
+
+    for (i = 0; i < req->mbr_iov.iov_len / sizeof(*p); ++i)
+        if (p[i] != pattern(req->mbr_mbd->mb_id, req->mbr_off + i * sizeof(*p)))
+            return false;
+
+    return true;
+}
+
+int
+test_collection_setup(struct mtf_test_info *info)
+{
+    u32   *buf;
+    size_t i, j;
+
+    mbfd = mkstemp(mbpath);
+    if (mbfd == -1)
+        return -1;
+
+    unlink(mbpath);
+
+    buf = malloc(MBLKSZ);
+    if (!buf)
+        return -1;
+
+    for (i = 0; i < NELEM(mbdv); ++i)
+        mbdv[i].mb_id = MBID_BASE + i;
+
+    for (i = 0; i < MBLKC; ++i) {
+        for (j = 0; j < MBLKSZ / sizeof(*buf); ++j)
+            buf[j] = pattern(MBID_BASE + i, j * sizeof(*buf));
+
+        if (pwrite(mbfd, buf, MBLKSZ, i * MBLKSZ) != MBLKSZ) {
+            free(buf);
+            return -1;
+        }
+    }
+
+    free(buf);
+
+    return 0;
+}
+
+int
+test_collection_teardown(struct mtf_test_info *info)
+{
+    mock_mpool_unset();
+
+    if (mbfd != -1)
+        close(mbfd);
+
+    return 0;
+}
+
+MTF_BEGIN_UTEST_COLLECTION_PREPOST(cn_mbio_test, test_collection_setup, test_collection_teardown);
+
+MTF_DEFINE_UTEST(cn_mbio_test, create_einval)
+{
+    struct cn_mbio *mbio;
+    merr_t          err;
+
+    err = cn_mbio_create(0, file_map, &mbfd, &mbio);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    cn_mbio_destroy(NULL);
+}
+
+MTF_DEFINE_UTEST(cn_mbio_test, file_reads)
+{
+    const uint          reqc = 200, qdepth = 8, batch = 64;
+    struct cn_mbio_req *reqv, *ptrv[batch];
+    struct xrand        xr;
+    struct cn_mbio *    mbio;
+    atomic_t            donecnt;
+    char *              bufs;
+    merr_t              err;
+    uint                i, j;
+
+    err = cn_mbio_create(qdepth, file_map, &mbfd, &mbio);
+    ASSERT_EQ(0, err);
+
+    hse_log(HSE_INFO "io_uring %savailable", cn_mbio_async(mbio) ? "" : "not ");
+
+    reqv = calloc(reqc, sizeof(*reqv));
+    ASSERT_NE(NULL, reqv);
+
+    bufs = alloc_page_aligned(reqc * PAGE_SIZE);
+    ASSERT_NE(NULL, bufs);
+
+    xrand_init(&xr, 42);
+    atomic_set(&donecnt, 0);
+
+    for (i = 0; i < reqc; ++i) {
+        struct cn_mbio_req *req = reqv + i;
+
+        req->mbr_mbd = &mbdv[xrand64(&xr) % MBLKC];
+        req->mbr_off = (xrand64(&xr) % (MBLKSZ / PAGE_SIZE)) * PAGE_SIZE;
+        req->mbr_iov.iov_base = bufs + i * PAGE_SIZE;
+        req->mbr_iov.iov_len = PAGE_SIZE;
+        req->mbr_err = merr(EBUG);
+        req->mbr_cb = read_done;
+        req->mbr_rock = &donecnt;
+    }
+
+    /* Submit in batches larger than the queue depth. */
+    for (i = 0; i < reqc; i += batch) {
+        uint n = min_t(uint, batch, reqc - i);
+
+        for (j = 0; j < n; ++j)
+            ptrv[j] = reqv + i + j;
+
+        err = cn_mbio_submit(mbio, ptrv, n);
+        ASSERT_EQ(0, err);
+        ASSERT_LE(cn_mbio_inflight(mbio), qdepth);
+    }
+
+    while (cn_mbio_inflight(mbio) > 0)
+        cn_mbio_reap(mbio, 1);
+
+    ASSERT_EQ(reqc, atomic_read(&donecnt));
+
+    for (i = 0; i < reqc; ++i) {
+        ASSERT_EQ(0, reqv[i].mbr_err);
+        ASSERT_TRUE(verify(reqv + i));
+    }
+
+    cn_mbio_destroy(mbio);
+    free_aligned(bufs);
+    free(reqv);
+}
+
+MTF_DEFINE_UTEST(cn_mbio_test, registered_buffer)
+{
+    const uint          reqc = 16;
+    struct cn_mbio_req  reqv[reqc], *ptrv[reqc];
+    struct cn_mbio *    mbio;
+    atomic_t            donecnt;
+    char *              bufs, unreg[PAGE_SIZE];
+    merr_t              err;
+    uint                i;
+
+    err = cn_mbio_create(reqc, file_map, &mbfd, &mbio);
+    ASSERT_EQ(0, err);
+
+    bufs = alloc_page_aligned(reqc * PAGE_SIZE);
+    ASSERT_NE(NULL, bufs);
+
+    /* Registration may fail due to RLIMIT_MEMLOCK, which merely disables
+     * fixed-buffer reads.
+     */
+    err = cn_mbio_register(mbio, bufs, reqc * PAGE_SIZE);
+    if (err)
+        hse_log(HSE_NOTICE "buffer registration failed: %d", merr_errno(err));
+
+    atomic_set(&donecnt, 0);
+    memset(reqv, 0, sizeof(reqv));
+
+    /* The last request's buffer lies outside the registered buffer. */
+    for (i = 0; i < reqc; ++i) {
+        reqv[i].mbr_mbd = &mbdv[i % MBLKC];
+        reqv[i].mbr_off = i * PAGE_SIZE;
+        reqv[i].mbr_iov.iov_base = (i < reqc - 1) ? bufs + i * PAGE_SIZE : unreg;
+        reqv[i].mbr_iov.iov_len = PAGE_SIZE;
+        reqv[i].mbr_cb = read_done;
+        reqv[i].mbr_rock = &donecnt;
+        ptrv[i] = reqv + i;
+    }
+
+    err = cn_mbio_submit(mbio, ptrv, reqc);
+    ASSERT_EQ(0, err);
+
+    /* Registration is not allowed while reads are in flight. */
+    if (cn_mbio_inflight(mbio) > 0) {
+        err = cn_mbio_register(mbio, NULL, 0);
+        ASSERT_EQ(EBUSY, merr_errno(err));
+    }
+
+    cn_mbio_reap(mbio, reqc);
+    ASSERT_EQ(0, cn_mbio_inflight(mbio));
+    ASSERT_EQ(reqc, atomic_read(&donecnt));
+
+    for (i = 0; i < reqc; ++i) {
+        ASSERT_EQ(0, reqv[i].mbr_err);
+        ASSERT_TRUE(verify(reqv + i));
+    }
+
+    err = cn_mbio_register(mbio, NULL, 0);
+    ASSERT_EQ(0, err);
+
+    cn_mbio_destroy(mbio);
+    free_aligned(bufs);
+}
+
+MTF_DEFINE_UTEST(cn_mbio_test, read_errors)
+{
+    struct cn_mbio_req reqv[2], *ptrv[2];
+    struct cn_mbio *   mbio;
+    atomic_t           donecnt;
+    char               buf[2][PAGE_SIZE];
+    merr_t             err;
+    uint               i;
+
+    err = cn_mbio_create(4, file_map, &mbfd, &mbio);
+    ASSERT_EQ(0, err);
+
+    atomic_set(&donecnt, 0);
+    memset(reqv, 0, sizeof(reqv));
+
+    /* An unknown mblock, and a read beyond the end of the last mblock. */
+    reqv[0].mbr_mbd = &mbdv[MBLKC];
+    reqv[0].mbr_off = 0;
+    reqv[1].mbr_mbd = &mbdv[MBLKC - 1];
+    reqv[1].mbr_off = MBLKSZ - PAGE_SIZE / 2;
+
+    for (i = 0; i < 2; ++i) {
+        reqv[i].mbr_iov.iov_base = buf[i];
+        reqv[i].mbr_iov.iov_len = PAGE_SIZE;
+        reqv[i].mbr_err = 0;
+        reqv[i].mbr_cb = read_done;
+        reqv[i].mbr_rock = &donecnt;
+        ptrv[i] = reqv + i;
+    }
+
+    err = cn_mbio_submit(mbio, ptrv, 2);
+    ASSERT_EQ(0, err);
+
+    cn_mbio_reap(mbio, 2);
+    ASSERT_EQ(2, atomic_read(&donecnt));
+
+    ASSERT_EQ(ENOENT, merr_errno(reqv[0].mbr_err));
+    ASSERT_EQ(EIO, merr_errno(reqv[1].mbr_err));
+
+    cn_mbio_destroy(mbio);
+}
+
+MTF_DEFINE_UTEST(cn_mbio_test, mpool_unmapped)
+{
+    struct kvs_mblk_desc mbd = {};
+    struct cn_mbio_req   req = {}, *ptr = &req;
+    struct cn_mbio *     mbio;
+    atomic_t             donecnt;
+    char                 wbuf[PAGE_SIZE], rbuf[PAGE_SIZE];
+    merr_t               err;
+
+    mock_mpool_set();
+
+    err = mpm_mblock_alloc(4 * PAGE_SIZE, &mbd.mb_id);
+    ASSERT_EQ(0, err);
+
+    memset(wbuf, 0xa5, sizeof(wbuf));
+    err = mpm_mblock_write(mbd.mb_id, wbuf, PAGE_SIZE, sizeof(wbuf));
+    ASSERT_EQ(0, err);
+
+    err = cn_mbio_create(4, NULL, NULL, &mbio);
+    ASSERT_EQ(0, err);
+    ASSERT_TRUE(cn_mbio_async(mbio));
+
+    atomic_set(&donecnt, 0);
+
+    /* Without an mcache map, reads are serviced synchronously by mpool. */
+    req.mbr_mbd = &mbd;
+    req.mbr_off = PAGE_SIZE;
+    req.mbr_iov.iov_base = rbuf;
+    req.mbr_iov.iov_len = sizeof(rbuf);
+    req.mbr_err = merr(EBUG);
+    req.mbr_cb = read_done;
+    req.mbr_rock = &donecnt;
+
+    err = cn_mbio_submit(mbio, &ptr, 1);
+    ASSERT_EQ(0, err);
+
+    /* Completed at submission time */
+    ASSERT_EQ(1, atomic_read(&donecnt));
+    ASSERT_EQ(0, cn_mbio_inflight(mbio));
+    ASSERT_EQ(0, cn_mbio_reap(mbio, 1));
+
+    ASSERT_EQ(0, req.mbr_err);
+    ASSERT_EQ(0, memcmp(wbuf, rbuf, sizeof(rbuf)));
+
+    cn_mbio_destroy(mbio);
+    mock_mpool_unset();
+}
+
+#define MCACHE_MBLKC (3)
+#define MCACHE_REQC (10)
+
+struct mcache_rock {
+    struct cn_mbio *    mbio;
+    struct cn_mbio_req *reqv;
+    struct cn_mbio_req *chain;
+    uint                donev[MCACHE_REQC + 1];
+    uint                donec;
+};
+
+static void
+mcache_done(struct cn_mbio_req *req)
+{
+    struct mcache_rock *rock = req->mbr_rock;
+
+    rock->donev[rock->donec++] = req - rock->reqv;
+
+    /* Callbacks may submit follow-on reads (e.g., kblock nodes, then kmd). */
+    if (rock->chain) {
+        struct cn_mbio_req *next = rock->chain;
+
+        rock->chain = NULL;
+        cn_mbio_submit(rock->mbio, &next, 1);
+    }
+}
+
+MTF_DEFINE_UTEST(cn_mbio_test, mcache_reads)
+{
+    const uint               qdepth = 4;
+    struct kvs_mblk_desc     mbd[MCACHE_MBLKC] = {};
+    struct cn_mbio_req       reqv[MCACHE_REQC + 1] = {}, *ptrv[MCACHE_REQC];
+    struct mpool_mcache_map *map;
+    struct mcache_rock       rock = {};
+    u64                      mbidv[MCACHE_MBLKC];
+    u32                      buf[MCACHE_REQC + 1][PAGE_SIZE / sizeof(u32)];
+    u32                      wbuf[PAGE_SIZE / sizeof(u32)];
+    merr_t                   err;
+    uint                     i, j, n;
+
+    mock_mpool_set();
+
+    for (i = 0; i < MCACHE_MBLKC; ++i) {
+        err = mpm_mblock_alloc(MCACHE_REQC * PAGE_SIZE, &mbidv[i]);
+        ASSERT_EQ(0, err);
+
+        for (j = 0; j < MCACHE_REQC; ++j) {
+            for (n = 0; n < NELEM(wbuf); ++n)
+                wbuf[n] = pattern(mbidv[i], j * PAGE_SIZE + n * sizeof(u32));
+
+            err = mpm_mblock_write(mbidv[i], wbuf, j * PAGE_SIZE, PAGE_SIZE);
+            ASSERT_EQ(0, err);
+        }
+    }
+
+    err = mpool_mcache_mmap(NULL, MCACHE_MBLKC, mbidv, MPC_VMA_COLD, &map);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < MCACHE_MBLKC; ++i) {
+        mbd[i].map = map;
+        mbd[i].map_idx = i;
+        mbd[i].map_base = mpool_mcache_getbase(map, i);
+        mbd[i].mb_id = mbidv[i];
+        ASSERT_NE(NULL, mbd[i].map_base);
+    }
+
+    err = cn_mbio_create(qdepth, NULL, NULL, &rock.mbio);
+    ASSERT_EQ(0, err);
+    ASSERT_TRUE(cn_mbio_async(rock.mbio));
+
+    /* Request i reads page i, the extra request is chained to the first. */
+    for (i = 0; i < NELEM(reqv); ++i) {
+        reqv[i].mbr_mbd = &mbd[i % MCACHE_MBLKC];
+        reqv[i].mbr_off = (i % MCACHE_REQC) * PAGE_SIZE;
+        reqv[i].mbr_iov.iov_base = buf[i];
+        reqv[i].mbr_iov.iov_len = PAGE_SIZE;
+        reqv[i].mbr_err = merr(EBUG);
+        reqv[i].mbr_cb = mcache_done;
+        reqv[i].mbr_rock = &rock;
+
+        if (i < MCACHE_REQC)
+            ptrv[i] = reqv + i;
+    }
+
+    rock.reqv = reqv;
+    rock.chain = reqv + MCACHE_REQC;
+
+    /* Submitting more than the queue depth reaps the oldest to make room. */
+    err = cn_mbio_submit(rock.mbio, ptrv, MCACHE_REQC);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(qdepth, cn_mbio_inflight(rock.mbio));
+    ASSERT_EQ(MCACHE_REQC - qdepth + 1, rock.donec);
+
+    n = cn_mbio_reap(rock.mbio, 2);
+    ASSERT_EQ(2, n);
+    ASSERT_EQ(qdepth - 2, cn_mbio_inflight(rock.mbio));
+
+    cn_mbio_destroy(rock.mbio);
+    ASSERT_EQ(NELEM(reqv), rock.donec);
+
+    /* Completions are in submission order.  The chained read was queued
+     * by the first completion, at which time reads 1-3 were in flight.
+     */
+    for (i = 0; i < NELEM(reqv); ++i)
+        ASSERT_EQ(i < qdepth ? i : (i == qdepth ? MCACHE_REQC : i - 1), rock.donev[i]);
+
+    for (i = 0; i < NELEM(reqv); ++i) {
+        ASSERT_EQ(0, reqv[i].mbr_err);
+        ASSERT_TRUE(verify(reqv + i));
+    }
+
+    mpool_mcache_munmap(map);
+    mock_mpool_unset();
+}
+
+MTF_END_UTEST_COLLECTION(cn_mbio_test);
@@ -73,6 +73,7 @@ setup_mocks(void)
 
     mapi_inject(mapi_idx_csched_tree_add, 0);
     mapi_inject(mapi_idx_csched_tree_remove, 0);
+    mapi_inject(mapi_idx_csched_tbkt_maint_get, 0);
     mapi_inject(mapi_idx_ikvdb_rdonly, 0);
     mapi_inject(mapi_idx_ikvdb_rdonly, 0);
 }
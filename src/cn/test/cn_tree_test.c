@@ -17,6 +17,8 @@
 #include <hse_ikvdb/cn_node_loc.h>
 #include <hse_ikvdb/kvdb_health.h>
 #include <hse_ikvdb/cn.h>
+#include <hse_ikvdb/query_ctx.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include "../cn_tree.h"
 #include "../cn_tree_iter.h"
@@ -50,6 +52,9 @@ struct fake_kvset {
     u64                     workid;
     struct kvset_stats      stats;
     struct fake_kvset *     next;
+    const char *            key;
+    u64                     vseq;
+    const struct rtomb *    rtombs;
 };
 
 const struct kvset_stats fake_kvset_stats = {
@@ -188,6 +193,51 @@ _kvset_get_max_key(struct kvset *ks, void **key, uint *klen)
     *klen = 3;
 }
 
+/* A fake kvset holds at most one key, which its own rtombs may hide
+ * in the same way kvset_lookup() applies a kvset's range tombstones.
+ */
+static merr_t
+_kvset_lookup(
+    struct kvset *         handle,
+    struct kvs_ktuple *    kt,
+    const struct key_disc *kdisc,
+    u64                    seq,
+    enum key_lookup_res *  res,
+    struct kvs_buf *       vbuf,
+    uint *                 nkblk)
+{
+    struct fake_kvset *kvset = (struct fake_kvset *)handle;
+    u64                rt_seq;
+
+    *res = NOT_FOUND;
+
+    if (kvset->key && kvset->vseq <= seq &&
+        !keycmp(kvset->key, strlen(kvset->key), kt->kt_data, kt->kt_len))
+        *res = FOUND_VAL;
+
+    rt_seq = rtomb_list_seq(kvset->rtombs, -1, kt->kt_data, kt->kt_len, seq);
+    if (rt_seq && (*res == NOT_FOUND || rt_seq > kvset->vseq))
+        *res = FOUND_TMB;
+
+    return 0;
+}
+
+static merr_t
+_kvset_lookupv(
+    struct kvset *           handle,
+    uint                     reqc,
+    struct kvset_lookup_req *reqv,
+    u64                      seq,
+    uint *                   nkblk)
+{
+    uint i;
+
+    for (i = 0; i < reqc; i++)
+        _kvset_lookup(handle, reqv[i].kt, reqv[i].kdisc, seq, reqv[i].res, reqv[i].vbuf, nkblk);
+
+    return 0;
+}
+
 /*----------------------------------------------------------------
  * Mocked kvset iterator
  */
@@ -207,7 +257,6 @@ struct mocked_kvset_iter {
 static merr_t
 _kvset_iter_create(
     struct kvset *           kvset,
-    struct workqueue_struct *workq,
     struct workqueue_struct *vra_wq,
     struct perfc_set *       pc,
     enum kvset_iter_flags    flags,
@@ -281,6 +330,7 @@ struct injections injections[] = {
     { 0, mapi_idx_cn_get_flags },
     { 10, mapi_idx_cn_get_seqno_horizon },
     { 0, mapi_idx_cn_get_cancel },
+    { 0, mapi_idx_cn_get_tbkt_maint },
     { 0, mapi_idx_cn_get_flags },
     { 0, mapi_idx_cn_get_sched },
     { 0, mapi_idx_cn_get_maint_wq },
@@ -575,6 +625,141 @@ MTF_DEFINE_UTEST_PRE(test, t_cn_tree_ingest_update, test_setup)
         fake_kvset_destroy((struct fake_kvset *)kvsetv[i]);
 }
 
+static struct rtomb *
+make_rtomb(const char *start, const char *end, u64 seq)
+{
+    struct rtomb *rt;
+    size_t        slen = strlen(start), elen = strlen(end);
+
+    rt = calloc(1, rtomb_size(slen, elen));
+    if (rt) {
+        rt->rt_seq = seq;
+        rt->rt_slen = slen;
+        rt->rt_elen = elen;
+        memcpy(rt->rt_data, start, slen);
+        memcpy(rt->rt_data + slen, end, elen);
+    }
+
+    return rt;
+}
+
+static enum key_lookup_res
+tree_lookup(struct cn_tree *tree, const char *key, u64 seq)
+{
+    struct query_ctx    qctx = {.qtype = QUERY_GET };
+    struct kvs_ktuple   kt;
+    struct kvs_buf      vbuf;
+    enum key_lookup_res res;
+    char                vdata[16];
+    merr_t              err;
+
+    kvs_ktuple_init(&kt, key, strlen(key));
+    kvs_buf_init(&vbuf, vdata, sizeof(vdata));
+
+    err = cn_tree_lookup(tree, NULL, &kt, seq, &res, &qctx, NULL, &vbuf);
+    if (err)
+        return -1;
+
+    return res;
+}
+
+/*----------------------------------------------------------------
+ * A range tombstone in a newer kvset hides keys in older kvsets.
+ */
+MTF_DEFINE_UTEST_PRE(test, t_cn_tree_lookup_rtomb, test_setup)
+{
+    struct cn_tree *     tree;
+    struct cn_tree_node *node;
+    struct cn_node_loc   loc;
+    struct fake_kvset *  kvsetv[3];
+    struct rtomb *       rt;
+    merr_t               err;
+    uint                 i;
+
+    struct kvs_cparams cp = {
+        .cp_fanout = 1 << 2,
+    };
+
+    MOCK_SET(kvset, _kvset_lookup);
+    MOCK_SET(kvset, _kvset_lookupv);
+
+    err = cn_tree_create(&tree, NULL, 0, &cp, &mock_health, rp);
+    ASSERT_EQ(err, 0);
+
+    rt = make_rtomb("b", "d", 20);
+    ASSERT_NE(NULL, rt);
+
+    /* Oldest first: "b" at seq 10, "a" at seq 15, then the rtomb
+     * [b, d) at seq 20 in the newest kvset.
+     */
+    for (i = 0; i < NELEM(kvsetv); i++) {
+        kvsetv[i] = fake_kvset_create(0, 100 + i);
+        ASSERT_NE(NULL, kvsetv[i]);
+    }
+
+    kvsetv[0]->key = "b";
+    kvsetv[0]->vseq = 10;
+    kvsetv[1]->key = "a";
+    kvsetv[1]->vseq = 15;
+    kvsetv[2]->rtombs = rt;
+
+    for (i = 0; i < NELEM(kvsetv); i++)
+        cn_tree_ingest_update(tree, (struct kvset *)kvsetv[i], 0, 0, 0);
+
+    /* "b" is hidden by the newer rtomb, "a" lies outside its range */
+    ASSERT_EQ(FOUND_TMB, tree_lookup(tree, "b", 100));
+    ASSERT_EQ(FOUND_VAL, tree_lookup(tree, "a", 100));
+    ASSERT_EQ(FOUND_TMB, tree_lookup(tree, "c", 100));
+    ASSERT_EQ(NOT_FOUND, tree_lookup(tree, "d", 100));
+
+    /* A view older than the rtomb still sees "b" */
+    ASSERT_EQ(FOUND_VAL, tree_lookup(tree, "b", 19));
+    ASSERT_EQ(NOT_FOUND, tree_lookup(tree, "c", 19));
+
+    /* A newer value in the rtomb's own kvset is not hidden */
+    kvsetv[2]->key = "c";
+    kvsetv[2]->vseq = 30;
+    ASSERT_EQ(FOUND_VAL, tree_lookup(tree, "c", 100));
+    ASSERT_EQ(FOUND_TMB, tree_lookup(tree, "b", 100));
+
+    /* The batched descent must agree with the single key lookups */
+    {
+        const char *        keyv[] = { "a", "b", "c", "d" };
+        enum key_lookup_res expect[] = { FOUND_VAL, FOUND_TMB, FOUND_VAL, NOT_FOUND };
+        struct kvs_ktuple   ktv[NELEM(keyv)];
+        struct kvs_buf      vbufv[NELEM(keyv)];
+        enum key_lookup_res resv[NELEM(keyv)];
+        char                vdata[NELEM(keyv)][16];
+
+        for (i = 0; i < NELEM(keyv); i++) {
+            kvs_ktuple_init(&ktv[i], keyv[i], strlen(keyv[i]));
+            kvs_buf_init(&vbufv[i], vdata[i], sizeof(vdata[i]));
+            resv[i] = NOT_FOUND;
+        }
+
+        err = cn_tree_lookup_batch(tree, NULL, NELEM(keyv), ktv, 100, resv, vbufv);
+        ASSERT_EQ(0, err);
+
+        for (i = 0; i < NELEM(keyv); i++)
+            ASSERT_EQ(expect[i], resv[i]);
+    }
+
+    loc.node_level = 0;
+    loc.node_offset = 0;
+    node = cn_tree_find_node(tree, &loc);
+    ASSERT_NE(node, NULL);
+
+    INIT_LIST_HEAD(&node->tn_kvset_list);
+    cn_tree_destroy(tree);
+
+    for (i = 0; i < NELEM(kvsetv); i++)
+        fake_kvset_destroy(kvsetv[i]);
+
+    free(rt);
+    MOCK_UNSET(kvset, _kvset_lookupv);
+    MOCK_UNSET(kvset, _kvset_lookup);
+}
+
 /*----------------------------------------------------------------
  * Support for the MY_TEST1 and MY_TEST2 macros below
  */
@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_ut/framework.h>
+
+#include <hse_util/platform.h>
+
+#include "../cn_vcache.h"
+
+#define VLEN (4096)
+
+MTF_BEGIN_UTEST_COLLECTION(cn_vcache_test);
+
+MTF_DEFINE_UTEST(cn_vcache_test, disabled)
+{
+    struct cn_vcache *vc;
+    char              buf[16];
+    merr_t            err;
+
+    err = cn_vcache_create("vctest", 0, &vc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(NULL, vc);
+
+    /* All interfaces must tolerate a disabled (NULL) cache */
+    cn_vcache_insert(vc, 1, 0, "abc", 3);
+    ASSERT_FALSE(cn_vcache_lookup(vc, 1, 0, buf, sizeof(buf)));
+    cn_vcache_invalidate(vc, (u64[]){ 1 }, 1);
+    cn_vcache_destroy(vc);
+}
+
+MTF_DEFINE_UTEST(cn_vcache_test, insert_lookup_invalidate)
+{
+    struct cn_vcache *vc;
+    char              val[VLEN], buf[VLEN];
+    u64               mbidv[] = { 100, 200 };
+    merr_t            err;
+    bool              found;
+    int               i;
+
+    err = cn_vcache_create("vctest", 32 << 20, &vc);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, vc);
+
+    for (i = 0; i < 4; i++) {
+        memset(val, 'a' + i, sizeof(val));
+        cn_vcache_insert(vc, 100 * (1 + i % 2), i * VLEN, val, sizeof(val));
+        cn_vcache_insert(vc, 300, i * VLEN, val, sizeof(val));
+    }
+
+    /* Duplicate inserts are ignored */
+    memset(val, 'z', sizeof(val));
+    cn_vcache_insert(vc, 100, 0, val, sizeof(val));
+
+    found = cn_vcache_lookup(vc, 100, 0, buf, sizeof(buf));
+    ASSERT_TRUE(found);
+    ASSERT_EQ('a', buf[0]);
+    ASSERT_EQ('a', buf[VLEN - 1]);
+
+    /* Partial copy-out */
+    memset(buf, 0, sizeof(buf));
+    found = cn_vcache_lookup(vc, 200, VLEN, buf, 7);
+    ASSERT_TRUE(found);
+    ASSERT_EQ('b', buf[6]);
+    ASSERT_EQ(0, buf[7]);
+
+    found = cn_vcache_lookup(vc, 100, 1, buf, sizeof(buf));
+    ASSERT_FALSE(found);
+
+    cn_vcache_invalidate(vc, mbidv, NELEM(mbidv));
+
+    for (i = 0; i < 4; i++) {
+        found = cn_vcache_lookup(vc, 100 * (1 + i % 2), i * VLEN, buf, sizeof(buf));
+        ASSERT_FALSE(found);
+
+        found = cn_vcache_lookup(vc, 300, i * VLEN, buf, sizeof(buf));
+        ASSERT_TRUE(found);
+        ASSERT_EQ('a' + i, buf[0]);
+    }
+
+    cn_vcache_destroy(vc);
+}
+
+MTF_DEFINE_UTEST(cn_vcache_test, eviction)
+{
+    struct cn_vcache *vc;
+    char              val[VLEN], buf[VLEN];
+    size_t            size = 16 << 20;
+    int               i, hits, n;
+
+    ASSERT_EQ(0, cn_vcache_create("vctest", size, &vc));
+
+    /* Insert four times the cache's capacity and keep one key hot.
+     * The hot key must survive, and most of the cold keys must not.
+     */
+    n = 4 * size / VLEN;
+    memset(val, 'v', sizeof(val));
+
+    cn_vcache_insert(vc, 1, 0, val, sizeof(val));
+
+    for (i = 0; i < n; i++) {
+        cn_vcache_insert(vc, 2, (u64)i * VLEN, val, sizeof(val));
+        ASSERT_TRUE(cn_vcache_lookup(vc, 1, 0, buf, sizeof(buf)));
+    }
+
+    for (hits = i = 0; i < n; i++)
+        hits += cn_vcache_lookup(vc, 2, (u64)i * VLEN, buf, sizeof(buf));
+
+    ASSERT_GT(hits, 0);
+    ASSERT_LT(hits, n / 2);
+
+    cn_vcache_destroy(vc);
+}
+
+/* Invalidation must find a vblock's entries after some of them have been
+ * evicted, and a vblock whose entries are all gone must be able to cache
+ * values again.
+ */
+MTF_DEFINE_UTEST(cn_vcache_test, evict_invalidate)
+{
+    struct cn_vcache *vc;
+    char              val[VLEN], buf[VLEN];
+    size_t            size = 16 << 20;
+    u64               mbid;
+    int               i, n;
+
+    ASSERT_EQ(0, cn_vcache_create("vctest", size, &vc));
+
+    n = 2 * size / VLEN;
+    memset(val, 'v', sizeof(val));
+
+    for (i = 0; i < n; i++)
+        cn_vcache_insert(vc, 10 + i % 8, (u64)i * VLEN, val, sizeof(val));
+
+    for (mbid = 10; mbid < 18; mbid += 2)
+        cn_vcache_invalidate(vc, &mbid, 1);
+
+    for (i = 0; i < n; i++) {
+        bool found = cn_vcache_lookup(vc, 10 + i % 8, (u64)i * VLEN, buf, sizeof(buf));
+
+        if (i % 2 == 0)
+            ASSERT_FALSE(found);
+    }
+
+    mbid = 10;
+    cn_vcache_insert(vc, mbid, 0, val, sizeof(val));
+    ASSERT_TRUE(cn_vcache_lookup(vc, mbid, 0, buf, sizeof(buf)));
+
+    cn_vcache_invalidate(vc, &mbid, 1);
+    ASSERT_FALSE(cn_vcache_lookup(vc, mbid, 0, buf, sizeof(buf)));
+
+    cn_vcache_destroy(vc);
+}
+
+MTF_END_UTEST_COLLECTION(cn_vcache_test);
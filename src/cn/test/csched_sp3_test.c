@@ -345,8 +345,6 @@ mock_init(void)
 
     mock_kvset_set();
 
-    mapi_inject_ptr(mapi_idx_cn_get_io_wq, NULL);
-
     mapi_inject(mapi_idx_cn_ref_get, 0);
     mapi_inject(mapi_idx_cn_ref_put, 0);
 
@@ -66,6 +66,12 @@ mocked_sp_compact_status_get(struct csched_ops *handle, struct hse_kvdb_compact_
 {
 }
 
+static struct tbkt *
+mocked_sp_tbkt_maint_get(struct csched_ops *handle)
+{
+    return (void *)handle;
+}
+
 static merr_t
 mocked_sp_create2(
     struct kvdb_rparams *rp,
@@ -111,6 +117,7 @@ mocked_sp_create(
         (*handle)->cs_throttle_sensor = mocked_sp_throttle_sensor;
         (*handle)->cs_compact_request = mocked_sp_compact_request;
         (*handle)->cs_compact_status_get = mocked_sp_compact_status_get;
+        (*handle)->cs_tbkt_maint_get = mocked_sp_tbkt_maint_get;
     }
 
     return err;
@@ -266,6 +273,7 @@ MTF_DEFINE_UTEST_PRE(test, t_csched_methods, pre_test)
     csched_throttle_sensor(cs, 0);
     csched_compact_request(cs, flags);
     csched_compact_status_get(cs, &status);
+    ASSERT_EQ((void *)cs, csched_tbkt_maint_get(cs));
     csched_notify_ingest(cs, tree, 1234, 1234);
     csched_tree_remove(cs, tree, true);
 
@@ -283,6 +291,7 @@ MTF_DEFINE_UTEST_PRE(test, t_csched_methods, pre_test)
     csched_throttle_sensor(cs, 0);
     csched_compact_request(cs, flags);
     csched_compact_status_get(cs, &status);
+    ASSERT_EQ(NULL, csched_tbkt_maint_get(cs));
     csched_notify_ingest(cs, tree, 1234, 1234);
     csched_tree_remove(cs, tree, true);
 
@@ -294,6 +303,7 @@ MTF_DEFINE_UTEST_PRE(test, t_csched_methods, pre_test)
     csched_throttle_sensor(cs, 0);
     csched_notify_ingest(cs, tree, 1234, 1234);
     csched_tree_remove(cs, tree, true);
+    ASSERT_EQ(NULL, csched_tbkt_maint_get(cs));
 }
 
 MTF_END_UTEST_COLLECTION(test);
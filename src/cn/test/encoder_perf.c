@@ -564,7 +564,7 @@ run_kmd_write_perf(struct kmd_test_stats *s)
 
         s->nvals += count;
         while (count-- > 0)
-            kmd_add_val(mem, &off, seq++, vbidx, vboff, vlen);
+            kmd_add_val(mem, &off, seq++, 0, vbidx, vboff, vlen);
     }
 
     kmd_set_count(mem, &off, 0);
@@ -577,7 +577,7 @@ run_kmd_read_perf(struct kmd_test_stats *s)
     u64            off, seq, rx, rval, exp_seq;
     unsigned       i, count, exp_count;
     enum kmd_vtype vtype;
-    uint           vbidx, vboff, vlen, clen;
+    uint           vbidx, vboff, vlen, clen, codec;
     const void *   vdata;
 
     off = 0;
@@ -615,6 +615,10 @@ run_kmd_read_perf(struct kmd_test_stats *s)
                     kmd_cval(mem, &off, &vbidx, &vboff, &vlen, &clen);
                     s->nvals++;
                     break;
+                case vtype_ccval:
+                    kmd_ccval(mem, &off, &vbidx, &vboff, &vlen, &clen, &codec);
+                    s->nvals++;
+                    break;
                 case vtype_zval:
                     s->nvals++;
                     break;
@@ -676,6 +680,7 @@ run_kmd_tp(struct kmd_test_profile *tp, struct kmd_test_stats *s, bool writing)
                     s->nivals++;
                     break;
                 case vtype_cval:
+                case vtype_ccval:
                 case vtype_val:
                     s->nvals++;
                     break;
@@ -689,16 +694,17 @@ run_kmd_tp(struct kmd_test_profile *tp, struct kmd_test_stats *s, bool writing)
                         kmd_add_ptomb(mem, &off, seq);
                         break;
                     case vtype_zval:
-                        kmd_add_zval(mem, &off, seq);
+                        kmd_add_zval(mem, &off, seq, 0);
                         break;
                     case vtype_ival:
-                        kmd_add_ival(mem, &off, seq, vdata, vlen);
+                        kmd_add_ival(mem, &off, seq, 0, vdata, vlen);
                         break;
                     case vtype_cval:
-                        kmd_add_cval(mem, &off, seq, vbidx, vboff, vlen, clen);
+                    case vtype_ccval:
+                        kmd_add_cval(mem, &off, seq, 0, vbidx, vboff, vlen, clen, 0);
                         break;
                     case vtype_val:
-                        kmd_add_val(mem, &off, seq, vbidx, vboff, vlen);
+                        kmd_add_val(mem, &off, seq, 0, vbidx, vboff, vlen);
                         break;
                 }
             } else {
@@ -708,6 +714,7 @@ run_kmd_tp(struct kmd_test_profile *tp, struct kmd_test_stats *s, bool writing)
                 uint           actual_vboff;
                 uint           actual_vlen;
                 uint           actual_clen;
+                uint           actual_codec;
                 const void *   actual_vdata;
 
                 kmd_type_seq(mem, &off, &actual_vtype, &actual_seq);
@@ -727,6 +734,10 @@ run_kmd_tp(struct kmd_test_profile *tp, struct kmd_test_stats *s, bool writing)
                         assert(actual_vlen == vlen);
                         assert(actual_clen == clen);
                         break;
+                    case vtype_ccval:
+                        kmd_ccval(mem, &off, &actual_vbidx, &actual_vboff, &actual_vlen, &actual_clen, &actual_codec);
+                        assert(actual_vlen == vlen);
+                        break;
                     case vtype_ival:
                         kmd_ival(mem, &off, &actual_vdata, &actual_vlen);
                         assert(actual_vlen == vlen);
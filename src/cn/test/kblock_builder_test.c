@@ -21,7 +21,10 @@
 #include <hse_ikvdb/kvset_builder.h>
 #include <hse_ikvdb/mclass_policy.h>
 
+#include <hse_ikvdb/rtomb.h>
+
 #include "../kblock_builder.h"
+#include "../kblock_reader.h"
 #include "../omf.h"
 #include "../blk_list.h"
 #include "../bloom_reader.h"
@@ -33,6 +36,7 @@
 
 const struct kvs_rparams mocked_rp_default = {
     .cn_bloom_create = 1,
+    .cn_bloom_pfx = 1,
     .kblock_size_mb = 32,
     .vblock_size_mb = 32,
 };
@@ -660,6 +664,109 @@ MTF_DEFINE_UTEST_PRE(test, t_kbb_fill, test_setup)
     }
 }
 
+MTF_DEFINE_UTEST_PRE(test, t_kbb_finish_fuse, test_setup)
+{
+    merr_t                 err = 0;
+    struct kblock_builder *kbb = 0;
+    struct blk_list        blks;
+
+    mocked_cp.cp_kblk_filter = 1;
+
+    err = kbb_create(KBB_CREATE_ARGS);
+    ASSERT_EQ(err, 0);
+
+    /* Span several hash set parts and several filter pages. */
+    err = add_entries(lcl_ti, kbb, 40 * 1000, 8, 0, 9, 0);
+    ASSERT_EQ(err, 0);
+
+    err = kbb_finish(kbb, &blks, 0, 0);
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(blks.n_blks, 1);
+
+    blk_list_free(&blks);
+    kbb_destroy(kbb);
+}
+
+MTF_DEFINE_UTEST_PRE(test, t_kbb_finish_pfx, test_setup)
+{
+    merr_t                 err = 0;
+    struct kblock_builder *kbb = 0;
+    struct blk_list        blks;
+    struct kblock_hdr_omf  kb_hdr;
+    struct bloom_hdr_omf   blm_hdr;
+    struct bloom_desc      desc = {};
+    struct kvs_ktuple      kt;
+    u8 *                   blm;
+    size_t                 blmsz;
+    u64                    blkid;
+
+    mocked_cp.cp_pfx_len = 4;
+
+    err = kbb_create(KBB_CREATE_ARGS);
+    ASSERT_EQ(err, 0);
+
+    /* Every key starts with the same 4-byte prefix (key_buf[0..3]). */
+    err = add_entries(lcl_ti, kbb, 1000, 16, 4, 9, 0);
+    ASSERT_EQ(err, 0);
+
+    err = kbb_finish(kbb, &blks, 0, 0);
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(blks.n_blks, 1);
+
+    blkid = blks.blks[0].bk_blkid;
+
+    err = mpm_mblock_read(blkid, &kb_hdr, 0, sizeof(kb_hdr));
+    ASSERT_EQ(err, 0);
+
+    err = mpm_mblock_read(blkid, &blm_hdr, omf_kbh_blm_hoff(&kb_hdr), sizeof(blm_hdr));
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(4, omf_bh_pfx_len(&blm_hdr));
+
+    desc.bd_modulus = omf_bh_modulus(&blm_hdr);
+    desc.bd_bktshift = omf_bh_bktshift(&blm_hdr);
+    desc.bd_n_hashes = omf_bh_n_hashes(&blm_hdr);
+    desc.bd_rotl = omf_bh_rotl(&blm_hdr);
+    desc.bd_bktmask = (1u << desc.bd_bktshift) - 1;
+
+    blmsz = omf_kbh_blm_dlen_pg(&kb_hdr) * PAGE_SIZE;
+    blm = malloc(blmsz);
+    ASSERT_NE(NULL, blm);
+
+    err = mpm_mblock_read(blkid, blm, omf_kbh_blm_doff_pg(&kb_hdr) * PAGE_SIZE, blmsz);
+    ASSERT_EQ(err, 0);
+
+    kvs_ktuple_init(&kt, key_buf, 4);
+    ASSERT_TRUE(bloom_reader_buffer_lookup(&desc, blm, &kt));
+
+    free(blm);
+    blk_list_free(&blks);
+    kbb_destroy(kbb);
+
+    /* No prefix entries unless enabled. */
+    mocked_rp.cn_bloom_pfx = 0;
+
+    err = kbb_create(KBB_CREATE_ARGS);
+    ASSERT_EQ(err, 0);
+
+    err = add_entries(lcl_ti, kbb, 1000, 16, 4, 9, 0);
+    ASSERT_EQ(err, 0);
+
+    err = kbb_finish(kbb, &blks, 0, 0);
+    ASSERT_EQ(err, 0);
+
+    blkid = blks.blks[0].bk_blkid;
+
+    err = mpm_mblock_read(blkid, &kb_hdr, 0, sizeof(kb_hdr));
+    ASSERT_EQ(err, 0);
+
+    err = mpm_mblock_read(blkid, &blm_hdr, omf_kbh_blm_hoff(&kb_hdr), sizeof(blm_hdr));
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(0, omf_bh_pfx_len(&blm_hdr));
+
+    blk_list_free(&blks);
+    kbb_destroy(kbb);
+}
+
 MTF_DEFINE_UTEST_PRE(test, t_hash_set, test_setup)
 {
     struct kblock_builder *kbb = 0;
@@ -678,4 +785,114 @@ MTF_DEFINE_UTEST_PRE(test, t_hash_set, test_setup)
     kbb_destroy(kbb);
 }
 
+static struct rtomb *
+make_rtomb(const char *start, const char *end, u64 seq)
+{
+    struct rtomb *rt;
+    size_t        slen = strlen(start), elen = strlen(end);
+
+    rt = calloc(1, rtomb_size(slen, elen));
+    if (rt) {
+        rt->rt_seq = seq;
+        rt->rt_slen = slen;
+        rt->rt_elen = elen;
+        memcpy(rt->rt_data, start, slen);
+        memcpy(rt->rt_data + slen, end, elen);
+    }
+
+    return rt;
+}
+
+MTF_DEFINE_UTEST_PRE(test, t_kbb_rtombs, test_setup)
+{
+    struct kblock_builder *  kbb = 0;
+    struct blk_list          blks;
+    struct kvs_mblk_desc     desc;
+    struct mpool_mcache_map *map;
+    struct rtomb *           rtv[2], *list, *rt;
+    merr_t                   err;
+    u64                      blkid;
+    int                      i;
+
+    rtv[0] = make_rtomb("apple", "banana", 7);
+    rtv[1] = make_rtomb("cherry", "date", 9);
+    ASSERT_NE(NULL, rtv[0]);
+    ASSERT_NE(NULL, rtv[1]);
+
+    err = kbb_create(KBB_CREATE_ARGS);
+    ASSERT_EQ(err, 0);
+
+    err = add_entries(lcl_ti, kbb, 100, 16, 0, 9, 0);
+    ASSERT_EQ(err, 0);
+
+    for (i = 0; i < NELEM(rtv); i++) {
+        err = kbb_add_rtomb(kbb, rtv[i]);
+        ASSERT_EQ(err, 0);
+    }
+
+    err = kbb_finish(kbb, &blks, 1, 10);
+    ASSERT_EQ(err, 0);
+    ASSERT_GE(blks.n_blks, 1);
+
+    /* The rtombs are stored in the last kblock. */
+    blkid = blks.blks[blks.n_blks - 1].bk_blkid;
+
+    err = mpool_mcache_mmap((void *)-1, 1, &blkid, MPC_VMA_COLD, &map);
+    ASSERT_EQ(err, 0);
+
+    err = kbr_get_kblock_desc((void *)-1, map, 0, blkid, &desc);
+    ASSERT_EQ(err, 0);
+
+    err = kbr_read_rtombs(&desc, &list);
+    ASSERT_EQ(err, 0);
+    ASSERT_NE(NULL, list);
+
+    for (rt = list, i = 0; rt; rt = rt->rt_next, i++) {
+        ASSERT_LT(i, NELEM(rtv));
+        ASSERT_EQ(rtv[i]->rt_seq, rt->rt_seq);
+        ASSERT_EQ(rtv[i]->rt_slen, rt->rt_slen);
+        ASSERT_EQ(rtv[i]->rt_elen, rt->rt_elen);
+        ASSERT_EQ(0, memcmp(rtv[i]->rt_data, rt->rt_data, rt->rt_slen + rt->rt_elen));
+    }
+    ASSERT_EQ(NELEM(rtv), i);
+
+    ASSERT_TRUE(rtomb_covers(list, "avocado", 7));
+    ASSERT_FALSE(rtomb_covers(list, "banana", 6));
+
+    free(list);
+    mpool_mcache_munmap(map);
+    blk_list_free(&blks);
+    kbb_destroy(kbb);
+
+    /* A kblock without rtombs yields an empty list. */
+    err = kbb_create(KBB_CREATE_ARGS);
+    ASSERT_EQ(err, 0);
+
+    err = add_entries(lcl_ti, kbb, 100, 16, 0, 9, 0);
+    ASSERT_EQ(err, 0);
+
+    err = kbb_finish(kbb, &blks, 1, 10);
+    ASSERT_EQ(err, 0);
+
+    blkid = blks.blks[blks.n_blks - 1].bk_blkid;
+
+    err = mpool_mcache_mmap((void *)-1, 1, &blkid, MPC_VMA_COLD, &map);
+    ASSERT_EQ(err, 0);
+
+    err = kbr_get_kblock_desc((void *)-1, map, 0, blkid, &desc);
+    ASSERT_EQ(err, 0);
+
+    list = (void *)-1;
+    err = kbr_read_rtombs(&desc, &list);
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(NULL, list);
+
+    mpool_mcache_munmap(map);
+    blk_list_free(&blks);
+    kbb_destroy(kbb);
+
+    free(rtv[0]);
+    free(rtv[1]);
+}
+
 MTF_END_UTEST_COLLECTION(test)
@@ -168,7 +168,7 @@ _kvset_builder_add_key(struct kvset_builder *builder, const struct key_obj *kobj
 
 static merr_t
 _kvset_builder_add_vref(struct kvset_builder *self, u64 seq,
-    uint vbidx, uint vboff, uint vlen, uint complen)
+    uint vbidx, uint vboff, uint vlen, uint complen, uint codec, u32 expiry)
 {
     VERIFY_EQ_RET(st.have.nvals, 0, __LINE__);
 
@@ -201,7 +201,9 @@ _kvset_builder_add_val(
     u64                     seq,
     const void *            vdata,
     uint                    vlen,
-    uint                    complen)
+    uint                    complen,
+    uint                    codec,
+    u32                     expiry)
 {
     VERIFY_EQ_RET(st.have.nvals, 0, __LINE__);
 
@@ -620,6 +622,7 @@ pre(struct mtf_test_info *info)
     /* Neuter the following APIs */
     mapi_inject(mapi_idx_cn_tree_get_cn, 0);
     mapi_inject(mapi_idx_kvset_builder_set_agegroup, 0);
+    mapi_inject(mapi_idx_kvset_builder_set_temp, 0);
     mapi_inject(mapi_idx_kvset_builder_set_merge_stats, 0);
 
     return 0;
@@ -121,26 +121,26 @@ MTF_DEFINE_UTEST_PREPOST(test, t_kvset_builder_add_entry1, pre, post)
      * Four flavors for add_val
      */
     /* zlen values: vlen or both vdata and vlen set to 0 */
-    err = kvset_builder_add_val(bld, seq1, 0, 0, 0);
+    err = kvset_builder_add_val(bld, seq1, 0, 0, 0, 0, 0);
     ASSERT_EQ(err, 0);
-    err = kvset_builder_add_val(bld, seq1, vdata1, 0, 0);
+    err = kvset_builder_add_val(bld, seq1, vdata1, 0, 0, 0, 0);
     ASSERT_EQ(err, 0);
     /* tombstone: vlen can be zero or non-zero */
-    err = kvset_builder_add_val(bld, seq1, HSE_CORE_TOMB_REG, 0, 0);
+    err = kvset_builder_add_val(bld, seq1, HSE_CORE_TOMB_REG, 0, 0, 0, 0);
     ASSERT_EQ(err, 0);
-    err = kvset_builder_add_val(bld, seq1, HSE_CORE_TOMB_REG, vlen1, 0);
+    err = kvset_builder_add_val(bld, seq1, HSE_CORE_TOMB_REG, vlen1, 0, 0, 0);
     ASSERT_EQ(err, 0);
     /* pfx tombstone: vlen can be zero or non-zero */
-    err = kvset_builder_add_val(bld, seq1, HSE_CORE_TOMB_PFX, 0, 0);
+    err = kvset_builder_add_val(bld, seq1, HSE_CORE_TOMB_PFX, 0, 0, 0, 0);
     ASSERT_EQ(err, 0);
-    err = kvset_builder_add_val(bld, seq1, HSE_CORE_TOMB_PFX, vlen1, 0);
+    err = kvset_builder_add_val(bld, seq1, HSE_CORE_TOMB_PFX, vlen1, 0, 0, 0);
     ASSERT_EQ(err, 0);
     /* real values */
-    err = kvset_builder_add_val(bld, seq1, vdata1, vlen1, 0);
+    err = kvset_builder_add_val(bld, seq1, vdata1, vlen1, 0, 0, 0);
     ASSERT_EQ(err, 0);
-    err = kvset_builder_add_val(bld, seq2, vdata2, vlen2, 0);
+    err = kvset_builder_add_val(bld, seq2, vdata2, vlen2, 0, 0, 0);
     ASSERT_EQ(err, 0);
-    err = kvset_builder_add_val(bld, seq2, 0, 0, 0);
+    err = kvset_builder_add_val(bld, seq2, 0, 0, 0, 0, 0);
     ASSERT_EQ(err, 0);
 
     /*
@@ -159,7 +159,7 @@ MTF_DEFINE_UTEST_PREPOST(test, t_kvset_builder_add_entry1, pre, post)
     /*
      * One flavor for add_vref
      */
-    err = kvset_builder_add_vref(bld, seq2, 1, 2, 3, 0);
+    err = kvset_builder_add_vref(bld, seq2, 1, 2, 3, 0, 0, 0);
     ASSERT_EQ(err, 0);
 
     /*
@@ -199,7 +199,7 @@ MTF_DEFINE_UTEST_PREPOST(test, t_kvset_builder_add_val_fail1, pre, post)
 
     api = mapi_idx_vbb_add_entry;
     mapi_inject(api, 1234);
-    err = kvset_builder_add_val(bld, seq, value, strlen(value), 0);
+    err = kvset_builder_add_val(bld, seq, value, strlen(value), 0, 0, 0);
     ASSERT_EQ(err, 1234);
 
     mapi_inject_unset(api);
@@ -224,7 +224,7 @@ MTF_DEFINE_UTEST_PREPOST(test, t_reserve_kmd1, pre, post)
 
     /* Add entries to exercise kmd growth */
     for (i = 0; i < 100; i++) {
-        err = kvset_builder_add_vref(bld, seq, vbidx, vboff, vlen, 0);
+        err = kvset_builder_add_vref(bld, seq, vbidx, vboff, vlen, 0, 0, 0);
         ASSERT_EQ(err, 0);
     }
 
@@ -253,7 +253,7 @@ MTF_DEFINE_UTEST_PREPOST(test, t_reserve_kmd2, pre, post)
 
     /* Add entries to kmd, eventually we should get an ENOMEM. */
     for (i = 0; i < 100; i++) {
-        err = kvset_builder_add_vref(bld, seq, vbidx, vboff, vlen, 0);
+        err = kvset_builder_add_vref(bld, seq, vbidx, vboff, vlen, 0, 0, 0);
         if (err)
             break;
     }
@@ -269,7 +269,7 @@ MTF_DEFINE_UTEST_PREPOST(test, t_reserve_kmd2, pre, post)
 
     /* Do it again with kvset_builder_add_val */
     for (i = 0; i < 100; i++) {
-        err = kvset_builder_add_val(bld, seq, "foobar", 6, 0);
+        err = kvset_builder_add_val(bld, seq, "foobar", 6, 0, 0, 0);
         if (err)
             break;
     }
@@ -312,7 +312,7 @@ MTF_DEFINE_UTEST_PREPOST(test, t_kvset_builder_get_mblocks, pre, post)
     ASSERT_EQ(err, 0);
     ASSERT_TRUE(bld);
 
-    err = kvset_builder_add_val(bld, seq, "foobar", 6, 0);
+    err = kvset_builder_add_val(bld, seq, "foobar", 6, 0, 0, 0);
     ASSERT_EQ(err, 0);
 
     key2kobj(&ko, "foobar", 6);
@@ -343,4 +343,58 @@ MTF_DEFINE_UTEST_PREPOST(test, t_kvset_build_destroy, pre, post)
     kvset_builder_destroy(NULL);
 }
 
+MTF_DEFINE_UTEST_PREPOST(test, t_kmd_expiry, pre, post)
+{
+    u8             kmd[4 * KMD_MAX_ENCODED_ENTRY_LEN];
+    size_t         off, off2;
+    enum kmd_vtype vtype;
+    const void *   vdata;
+    uint           vbidx, vboff, vlen;
+    u64            seq;
+    u32            expiry;
+
+    off = 0;
+    kmd_add_zval(kmd, &off, 40, 1000);
+    kmd_add_ival(kmd, &off, 30, 0, "abc", 3);
+    kmd_add_val(kmd, &off, 20, U32_MAX, 1, 2, 3);
+    kmd_add_tomb(kmd, &off, 10);
+
+    off = 0;
+    kmd_type_seq_exp(kmd, &off, &vtype, &seq, &expiry);
+    ASSERT_EQ(vtype_zval, vtype);
+    ASSERT_EQ(40, seq);
+    ASSERT_EQ(1000, expiry);
+
+    kmd_type_seq_exp(kmd, &off, &vtype, &seq, &expiry);
+    ASSERT_EQ(vtype_ival, vtype);
+    ASSERT_EQ(30, seq);
+    ASSERT_EQ(0, expiry);
+    kmd_ival(kmd, &off, &vdata, &vlen);
+    ASSERT_EQ(3, vlen);
+    ASSERT_EQ(0, memcmp(vdata, "abc", 3));
+
+    /* kmd_type_seq() must skip over the expiry time */
+    off2 = off;
+    kmd_type_seq(kmd, &off2, &vtype, &seq);
+    ASSERT_EQ(vtype_val, vtype);
+
+    kmd_type_seq_exp(kmd, &off, &vtype, &seq, &expiry);
+    ASSERT_EQ(off2, off);
+    ASSERT_EQ(20, seq);
+    ASSERT_EQ(U32_MAX, expiry);
+    kmd_val(kmd, &off, &vbidx, &vboff, &vlen);
+    ASSERT_EQ(1, vbidx);
+    ASSERT_EQ(2, vboff);
+    ASSERT_EQ(3, vlen);
+
+    kmd_type_seq_exp(kmd, &off, &vtype, &seq, &expiry);
+    ASSERT_EQ(vtype_tomb, vtype);
+    ASSERT_EQ(10, seq);
+    ASSERT_EQ(0, expiry);
+
+    ASSERT_FALSE(kvs_expired(0));
+    ASSERT_TRUE(kvs_expired(1000));
+    ASSERT_FALSE(kvs_expired(U32_MAX));
+}
+
 MTF_END_UTEST_COLLECTION(test);
@@ -24,6 +24,7 @@
 #include <hse_ikvdb/kvset_builder.h>
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/cn.h>
+#include <hse_ikvdb/rtomb.h>
 
 #include "../cn_tree.h"
 #include "../cn_tree_create.h"
@@ -72,11 +73,14 @@ static struct test_params {
     u64             horizon;
     bool            drop_tombs;
     int             fanout;
+    struct rtomb ** rtombv;
+    int             rtombs_out;
 
     /* Initialized with each mode (spill, kcompact, etc) */
     int pfx_len;
     int next_output_key;
     int next_output_val;
+    int rtombs_added;
 
     /* Initialized when a new ptomb is encountered (spread mode only) */
     int  last_pt_key;
@@ -518,6 +522,55 @@ process_yaml(void)
 
     tp.inp_kvset_nodev = vec;
     tp.inp_kvset_nodec = veclen;
+
+    /* Optional range tombstones, each given as [ kvset, start, end, seq ]
+     * and appended to the given input kvset's list.  rtombs_out is the
+     * number of them expected to be carried into each output kvset.
+     */
+    tp.rtombv = calloc(tp.inp_kvset_nodec + 1, sizeof(*tp.rtombv));
+    my_assert(tp.rtombv);
+    tp.rtombs_out = 0;
+
+    node = ydoc_map_lookup(doc, root_node, "_meta");
+    node2 = ydoc_map_lookup(doc, node, "rtombs_out");
+    if (node2)
+        tp.rtombs_out = ydoc_node_as_int(doc, node2);
+
+    node2 = ydoc_map_lookup(doc, node, "rtombs");
+    if (node2) {
+        int i;
+
+        ydoc_node_as_seq(doc, node2, &vec, &veclen);
+
+        for (i = 0; i < veclen; i++) {
+            yaml_node_item_t *rtv;
+            struct rtomb *    rt, **tailp;
+            const char *      start, *end;
+            int               rtc, slen, elen, idx;
+
+            ydoc_node_as_seq(doc, vec[i], &rtv, &rtc);
+            my_assert(rtc == 4);
+
+            idx = ydoc_node_as_int(doc, rtv[0]);
+            my_assert(idx >= 0 && idx < tp.inp_kvset_nodec);
+
+            start = ydoc_node_as_str(doc, rtv[1], &slen);
+            end = ydoc_node_as_str(doc, rtv[2], &elen);
+
+            rt = calloc(1, rtomb_size(slen, elen));
+            my_assert(rt);
+
+            rt->rt_seq = ydoc_node_as_u64(doc, rtv[3]);
+            rt->rt_slen = slen;
+            rt->rt_elen = elen;
+            memcpy(rt->rt_data, start, slen);
+            memcpy(rt->rt_data + slen, end, elen);
+
+            for (tailp = &tp.rtombv[idx]; *tailp; tailp = &(*tailp)->rt_next)
+                ; /* rtombs are kept in key order, as in a kvset */
+            *tailp = rt;
+        }
+    }
 }
 
 static void
@@ -651,6 +704,14 @@ kvset_get_nth(
  * Handle kvset_builder_add_* functions to get key/value pairs
  * and verify them.
  */
+static merr_t
+_kvset_builder_add_rtomb(struct kvset_builder *self, const struct rtomb *rt)
+{
+    tp.rtombs_added++;
+
+    return 0;
+}
+
 static merr_t
 _kvset_builder_add_key(struct kvset_builder *builder, const struct key_obj *kobj)
 {
@@ -739,6 +800,9 @@ _kvset_builder_add_val_internal(
             case vtype_cval:
                 tag = "c";
                 break;
+            case vtype_ccval:
+                tag = "cc";
+                break;
             case vtype_zval:
                 tag = "z";
                 break;
@@ -792,7 +856,9 @@ _kvset_builder_add_vref(
     uint                  vbidx_kvset_node,
     uint                  vboff_nth_key,
     uint                  vlen_nth_val,
-    uint                  complen)
+    uint                  complen,
+    uint                  codec,
+    u32                   expiry)
 {
     u64            tmp_seq;
     enum kmd_vtype vtype;
@@ -826,7 +892,9 @@ _kvset_builder_add_val(
     u64                     seq,
     const void *            vdata,
     uint                    vlen,
-    uint                    complen)
+    uint                    complen,
+    uint                    codec,
+    u32                     expiry)
 {
     enum kmd_vtype vtype;
 
@@ -916,7 +984,8 @@ _kvset_iter_next_vref(
     uint *                  vboff,
     const void **           vdata,
     uint *                  vlen_out,
-    uint *                  clen_out)
+    uint *                  clen_out,
+    uint *                  codec_out)
 {
     /* Unpack data from kvset_iter_vctx:
      *   vc->kmd   == kvset node
@@ -934,6 +1003,8 @@ _kvset_iter_next_vref(
     const void *lvdata;
     uint        vlen;
 
+    vc->expiry = 0;
+
     eof = -1;
     kvset_get_nth_val(kvset_node, nth_key, nth_val, &eof, seq, vtype, &lvdata, &vlen);
     if (eof)
@@ -959,6 +1030,7 @@ _kvset_iter_next_vref(
             *vlen_out = vlen;
             break;
         case vtype_cval:
+        case vtype_ccval:
             /* not used by this test */
             assert(0);
             break;
@@ -1013,6 +1085,7 @@ _kvset_iter_next_val(
 
     switch (vtype) {
         case vtype_cval:
+        case vtype_ccval:
             /* not used by this test */
             assert(0);
             break;
@@ -1196,6 +1269,7 @@ run_testcase(struct mtf_test_info *lcl_ti, int mode, const char *info)
 
     tp.next_output_key = 0;
     tp.last_pt_key = -1;
+    tp.rtombs_added = 0;
 
     /* Create source kvset iterators (one for each input kvset) */
     iterv = (struct kv_iterator **)calloc(iterc, sizeof(*iterv));
@@ -1243,6 +1317,8 @@ run_testcase(struct mtf_test_info *lcl_ti, int mode, const char *info)
             outputs,
             0);
 
+        w.cw_rtombv = (const struct rtomb **)tp.rtombv;
+
         w.cw_cp = &cp;
 
         err = cn_spill(&w);
@@ -1294,6 +1370,8 @@ run_testcase(struct mtf_test_info *lcl_ti, int mode, const char *info)
             outputs,
             0);
 
+        w.cw_rtombv = (const struct rtomb **)tp.rtombv;
+
         err = cn_spill(&w);
         ASSERT_EQ(err, 0);
 
@@ -1349,6 +1427,8 @@ run_testcase(struct mtf_test_info *lcl_ti, int mode, const char *info)
             outputs,
             0);
 
+        w.cw_rtombv = (const struct rtomb **)tp.rtombv;
+
         err = cn_spill(&w);
 
         if (omf_ts_khm_gen(omf) > 0)
@@ -1397,6 +1477,8 @@ run_testcase(struct mtf_test_info *lcl_ti, int mode, const char *info)
             outputs,
             &vbm);
 
+        w.cw_rtombv = (const struct rtomb **)tp.rtombv;
+
         err = cn_kcompact(&w);
         ASSERT_EQ(err, 0);
 
@@ -1408,6 +1490,9 @@ run_testcase(struct mtf_test_info *lcl_ti, int mode, const char *info)
     /* Check results */
     ASSERT_EQ(tp.next_output_key, tp.out_kvset_nkeys);
 
+    if (mode != MODE_KHASHMAP_ERR)
+        ASSERT_EQ(tp.rtombs_added, tp.rtombs_out * w.cw_outc);
+
     /* Cleanup */
     for (i = 0; i < iterc; i++)
         kv_iterator_release(&iterv[i]);
@@ -1424,6 +1509,19 @@ setup_tcase(struct mtf_test_info *lcl_ti)
 static void
 teardown_tcase(struct mtf_test_info *lcl_ti)
 {
+    int i;
+
+    for (i = 0; i < tp.inp_kvset_nodec; i++) {
+        while (tp.rtombv[i]) {
+            struct rtomb *rt = tp.rtombv[i];
+
+            tp.rtombv[i] = rt->rt_next;
+            free(rt);
+        }
+    }
+    free(tp.rtombv);
+    tp.rtombv = NULL;
+
     yaml_document_delete(&tp.doc);
     memset(&tp.doc, 0, sizeof(tp.doc));
 }
@@ -1550,6 +1648,7 @@ test_prehook(struct mtf_test_info *info)
     MOCK_SET(kvset_builder, _kvset_builder_add_val);
     MOCK_SET(kvset_builder, _kvset_builder_add_nonval);
     MOCK_SET(kvset_builder, _kvset_builder_add_vref);
+    MOCK_SET(kvset_builder, _kvset_builder_add_rtomb);
 
     MOCK_SET(kvset, _kvset_iter_next_key);
     MOCK_SET(kvset, _kvset_iter_next_val);
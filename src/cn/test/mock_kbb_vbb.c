@@ -53,6 +53,7 @@ mock_kbb_set(void)
     mapi_inject(mapi_idx_kbb_add_entry, 0);
     mapi_inject(mapi_idx_kbb_add_entry, 0);
     mapi_inject(mapi_idx_kbb_add_ptomb, 0);
+    mapi_inject(mapi_idx_kbb_add_rtomb, 0);
     mapi_inject(mapi_idx_kbb_finish, 0);
 }
 
@@ -64,6 +65,7 @@ mock_kbb_unset(void)
     mapi_inject_unset(mapi_idx_kbb_destroy);
     mapi_inject_unset(mapi_idx_kbb_add_entry);
     mapi_inject_unset(mapi_idx_kbb_add_ptomb);
+    mapi_inject_unset(mapi_idx_kbb_add_rtomb);
     mapi_inject_unset(mapi_idx_kbb_finish);
 }
 
@@ -119,7 +119,7 @@ _make_common(
     if (err)
         return err;
 
-    err = kvset_iter_create(kvset, NULL, NULL, NULL, 0, kvi);
+    err = kvset_iter_create(kvset, NULL, NULL, 0, kvi);
     if (err) {
         free(kvset);
         return err;
@@ -411,7 +411,6 @@ struct kv_iterator_ops mock_kvset_ops = {
 merr_t
 _kvset_iter_create(
     struct kvset *           kvset,
-    struct workqueue_struct *workq,
     struct workqueue_struct *vra_wq,
     struct perfc_set *       pc,
     enum kvset_iter_flags    flags,
@@ -566,7 +565,8 @@ _kvset_iter_next_vref(
     uint *                  vboff,
     const void **           vdata,
     uint *                  vlen,
-    uint *                  complen)
+    uint *                  complen,
+    uint *                  codec)
 {
     struct mock_kv_iterator *iter = kvi->kvi_context;
     struct kvdata *          entry = iter->kvset->iter_data;
@@ -574,6 +574,8 @@ _kvset_iter_next_vref(
 
     *vlen = 0;
     *complen = 0;
+    *codec = 0;
+    vc->expiry = 0;
 
     /* only one value per key */
     if (vc->next != 0)
@@ -651,7 +653,14 @@ mock_kvset_set(void)
     mock_kvset_unset();
 
     mapi_inject(mapi_idx_kvset_kblk_start, 0);
+    mapi_inject(mapi_idx_kvset_pfx_plausible, true);
+    mapi_inject(mapi_idx_kvset_rtombs, 0);
     mapi_inject(mapi_idx_kvset_get_scatter_score, 10);
+    mapi_inject(mapi_idx_kvset_get_heat, 0);
+    mapi_inject(mapi_idx_kvset_set_heat, 0);
+    mapi_inject(mapi_idx_kvset_heat_decay, 0);
+    mapi_inject(mapi_idx_kvset_get_expired, 0);
+    mapi_inject(mapi_idx_kvset_get_vblks_staging, 0);
 
     MOCK_SET(kvset, _kvset_create);
     MOCK_SET(kvset, _kvset_get_nth_vblock_len);
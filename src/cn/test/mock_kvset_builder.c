@@ -37,6 +37,11 @@ _kvset_builder_set_agegroup(struct kvset_builder *bldr, enum hse_mclass_policy_a
 {
 }
 
+static void
+_kvset_builder_set_temp(struct kvset_builder *bldr, enum hse_mclass_policy_temp temp)
+{
+}
+
 static merr_t
 _kvset_builder_add_key(struct kvset_builder *builder, const struct key_obj *kobj)
 {
@@ -49,7 +54,9 @@ _kvset_builder_add_val(
     u64                     seq,
     const void *            vdata,
     uint                    vlen,
-    uint                    complen)
+    uint                    complen,
+    uint                    codec,
+    u32                     expiry)
 {
     return 0;
 }
@@ -60,9 +67,15 @@ _kvset_builder_add_nonval(struct kvset_builder *self, u64 seq, enum kmd_vtype vt
     return 0;
 }
 
+static merr_t
+_kvset_builder_add_rtomb(struct kvset_builder *self, const struct rtomb *rt)
+{
+    return 0;
+}
+
 static merr_t
 _kvset_builder_add_vref(struct kvset_builder *self, u64 seq,
-    uint vbidx, uint vboff, uint vlen, uint complen)
+    uint vbidx, uint vboff, uint vlen, uint complen, uint codec, u32 expiry)
 {
     return 0;
 }
@@ -86,9 +99,11 @@ mock_kvset_builder_unset(void)
     MOCK_UNSET(kvset_builder, _kvset_builder_add_key);
     MOCK_UNSET(kvset_builder, _kvset_builder_add_val);
     MOCK_UNSET(kvset_builder, _kvset_builder_add_nonval);
+    MOCK_UNSET(kvset_builder, _kvset_builder_add_rtomb);
     MOCK_UNSET(kvset_builder, _kvset_builder_add_vref);
     MOCK_UNSET(kvset_builder, _kvset_builder_get_mblocks);
     MOCK_UNSET(kvset_builder, _kvset_builder_set_agegroup);
+    MOCK_UNSET(kvset_builder, _kvset_builder_set_temp);
     MOCK_UNSET(kvset_builder, _kvset_builder_destroy);
 }
 
@@ -102,8 +117,10 @@ mock_kvset_builder_set(void)
     MOCK_SET(kvset_builder, _kvset_builder_add_key);
     MOCK_SET(kvset_builder, _kvset_builder_add_val);
     MOCK_SET(kvset_builder, _kvset_builder_add_nonval);
+    MOCK_SET(kvset_builder, _kvset_builder_add_rtomb);
     MOCK_SET(kvset_builder, _kvset_builder_add_vref);
     MOCK_SET(kvset_builder, _kvset_builder_get_mblocks);
     MOCK_SET(kvset_builder, _kvset_builder_set_agegroup);
+    MOCK_SET(kvset_builder, _kvset_builder_set_temp);
     MOCK_SET(kvset_builder, _kvset_builder_destroy);
 }
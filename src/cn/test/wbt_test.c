@@ -283,7 +283,7 @@ tree_construct(struct mtf_test_info *lcl_ti, void **tree_out, struct wbt_hdr_omf
         bool           added;
 
         key2kobj(&ko, k->kdata, k->klen);
-        kmd_add_zval(kmd, &kmd_used, 1);
+        kmd_add_zval(kmd, &kmd_used, 1, 0);
         wbb_add_entry(wbb, &ko, 1, kmd, kmd_used, max_pgc, &wbt_pgc, &added);
         ASSERT_TRUE_RET(added, 1);
         kmd_used = 0;
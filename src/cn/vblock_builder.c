@@ -65,7 +65,8 @@ _vblock_start(struct vblock_builder *bld)
         tstart = get_time_ns();
 
     do {
-        mclass = mclass_policy_get_type(mpolicy, bld->agegroup, HSE_MPOLICY_DTYPE_VALUE, allocs);
+        mclass = mclass_policy_get_type_temp(
+            mpolicy, bld->agegroup, HSE_MPOLICY_DTYPE_VALUE, bld->temp, allocs);
         if (mclass == MP_MED_INVALID) {
             if (!err)
                 err = merr(ev(EINVAL));
@@ -216,6 +217,7 @@ vbb_create(
     bld->vgroup = vgroup;
     bld->max_size = rp->vblock_size_mb << 20;
     bld->agegroup = HSE_MPOLICY_AGE_LEAF;
+    bld->temp = HSE_MPOLICY_TEMP_NONE;
 
     bld->wbuf = alloc_page_aligned(WBUF_LEN_MAX);
     if (ev(!bld->wbuf)) {
@@ -349,6 +351,12 @@ vbb_get_agegroup(struct vblock_builder *bld)
     return bld->agegroup;
 }
 
+void
+vbb_set_temp(struct vblock_builder *bld, enum hse_mclass_policy_temp temp)
+{
+    bld->temp = temp;
+}
+
 void
 vbb_set_merge_stats(struct vblock_builder *bld, struct cn_merge_stats *stats)
 {
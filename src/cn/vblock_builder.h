@@ -19,6 +19,7 @@ struct cn_merge_stats;
 
 enum mp_media_classp;
 enum hse_mclass_policy_age;
+enum hse_mclass_policy_temp;
 
 /* MTF_MOCK_DECL(vblock_builder) */
 
@@ -122,6 +123,9 @@ vbb_set_agegroup(struct vblock_builder *bld, enum hse_mclass_policy_age age);
 enum hse_mclass_policy_age
 vbb_get_agegroup(struct vblock_builder *bld);
 
+void
+vbb_set_temp(struct vblock_builder *bld, enum hse_mclass_policy_temp temp);
+
 void
 vbb_set_merge_stats(struct vblock_builder *bld, struct cn_merge_stats *stats);
 
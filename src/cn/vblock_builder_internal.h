@@ -70,6 +70,7 @@ struct vblock_builder {
     struct cn_merge_stats *    mstats;
     struct blk_list            vblk_list;
     enum hse_mclass_policy_age agegroup;
+    enum hse_mclass_policy_temp temp;
     u64                        vsize;
     u64                        blkid;
     uint                       max_size;
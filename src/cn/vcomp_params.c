@@ -8,7 +8,7 @@
 
 #include <hse_util/inttypes.h>
 #include <hse_util/compiler.h>
-#include <hse_util/compression_lz4.h>
+#include <hse_util/compression.h>
 
 static
 bool
@@ -28,21 +28,26 @@ vcomp_param_match(
 bool
 vcomp_param_valid(const struct kvs_rparams *rp)
 {
-    const char *check[] = {
-        VCOMP_PARAM_NONE,
-        VCOMP_PARAM_LZ4,
-    };
-
-    for (int i = 0; i < NELEM(check); i++)
-        if (vcomp_param_match(rp, check[i]))
-            return true;
-    return false;
+    /* A codec that was not included in this build (e.g., zstd when
+     * libzstd was not found) is not a valid setting.
+     */
+    return vcomp_param_match(rp, VCOMP_PARAM_NONE) || vcomp_compress_ops(rp);
 }
 
-struct compress_ops *
+bool
+vcomp_param_level_valid(const struct kvs_rparams *rp)
+{
+    const struct compress_ops *cops = vcomp_compress_ops(rp);
+
+    /* The level is ignored by codecs that do not support levels. */
+    return !cops || !cops->cop_level_max || rp->vcomplvl <= cops->cop_level_max;
+}
+
+const struct compress_ops *
 vcomp_compress_ops(const struct kvs_rparams *rp)
 {
-    if (vcomp_param_match(rp, VCOMP_PARAM_LZ4))
-        return &compress_lz4_ops;
-    return NULL;
+    if (!memchr(rp->value_compression, 0, sizeof(rp->value_compression)))
+        return NULL;
+
+    return compress_codec_lookup(rp->value_compression);
 }
@@ -227,7 +227,8 @@ wbb_entries(struct wbb *wbb)
     return wbb->entries + wbb->cnode_nkeys;
 }
 
-/* Close out the node - Write out node_hdr, prefix, LFEs and key suffixes.
+/* Close out the node - Write out node_hdr, prefix, LFEs, key heads and
+ * key suffixes.
  */
 static void
 wbt_leaf_publish(struct wbb *wbb)
@@ -236,7 +237,9 @@ wbt_leaf_publish(struct wbb *wbb)
 
     size_t              pfx_len = wbb->cnode_pfx_len;
     struct wbt_lfe_omf *entry; /* (out) current key entry ptr */
+    u64 *               headp; /* (out) current key head ptr */
     void *              sfxp;  /* (out) current suffix ptr */
+    void *              hend __maybe_unused; /* end of key heads */
     int                 i;
 
     struct key_stage_entry_leaf *kin = wbb->cnode_key_stage;
@@ -253,6 +256,8 @@ wbt_leaf_publish(struct wbb *wbb)
     }
 
     entry = wbb->cnode + sizeof(*node_hdr) + pfx_len;
+    headp = wbb->cnode + wbt_lfe_heads_off(pfx_len, wbb->cnode_nkeys);
+    hend = headp + wbb->cnode_nkeys;
     sfxp = wbb->cnode + PAGE_SIZE;
 
     for (i = 0; i < wbb->cnode_nkeys; i++) {
@@ -260,7 +265,7 @@ wbt_leaf_publish(struct wbb *wbb)
         uint key_extra = kin->kmd_off < U16_MAX ? 0 : 4;
 
         sfxp -= sfx_len + key_extra;
-        assert((void *)entry < sfxp);
+        assert(hend <= sfxp);
 
         if (key_extra) {
             /* kmdoff is too large for u16 */
@@ -275,6 +280,7 @@ wbt_leaf_publish(struct wbb *wbb)
 
         memcpy(sfxp + key_extra, kin->kdata + pfx_len, sfx_len);
         omf_set_lfe_koff(entry, sfxp - wbb->cnode);
+        *headp++ = cpu_to_be64(wbt_key_head(kin->kdata + pfx_len, sfx_len));
 
         /* Store last key. */
         wbb->wbt_last_kobj.ko_pfx = wbb->cnode + sizeof(*node_hdr);
@@ -360,8 +366,8 @@ wbb_add_entry(
     wbb->cnode_sumlen += klen;
 
     /* Create a new node if space exceeds PAGE_SIZE */
-    space = sizeof(struct wbt_node_hdr_omf) + new_pfx_len +
-            ((wbb->cnode_nkeys + 1) * sizeof(struct wbt_lfe_omf)) + wbb->cnode_sumlen +
+    space = wbt_lfe_heads_off(new_pfx_len, wbb->cnode_nkeys + 1) +
+            ((wbb->cnode_nkeys + 1) * sizeof(u64)) + wbb->cnode_sumlen +
             (sizeof(u32) * wbb->cnode_key_extra_cnt) - ((wbb->cnode_nkeys + 1) * new_pfx_len);
 
     if (space > PAGE_SIZE) {
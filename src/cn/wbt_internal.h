@@ -10,6 +10,8 @@
 
 #include <hse_util/inttypes.h>
 #include <hse_util/byteorder.h>
+#include <hse_util/minmax.h>
+#include <hse_util/page.h>
 
 #include "omf.h"
 
@@ -90,6 +92,40 @@ wbt_ine_key(void *node, struct wbt_ine_omf *ine, const void **kdata, uint *klen)
     *klen = end - start;
 }
 
+/*
+ * Version 8 leaf nodes: same as version 5 plus a key head array
+ */
+
+/* Byte offset of the key head array in a leaf node with the given prefix
+ * length and number of keys.
+ */
+static __always_inline uint
+wbt_lfe_heads_off(uint pfx_len, uint nkeys)
+{
+    uint off = sizeof(struct wbt_node_hdr_omf) + pfx_len + nkeys * sizeof(struct wbt_lfe_omf);
+
+    return ALIGN(off, sizeof(u64));
+}
+
+static __always_inline const u64 *
+wbt_lfe_heads(void *node)
+{
+    return node + wbt_lfe_heads_off(omf_wbn_pfx_len(node), omf_wbn_num_keys(node));
+}
+
+/* First eight bytes of a key (suffix) as a big-endian integer, zero padded.
+ * The heads of two keys compare as the keys do, unless they are equal.
+ */
+static __always_inline u64
+wbt_key_head(const void *kdata, uint klen)
+{
+    u64 head = 0;
+
+    memcpy(&head, kdata, min_t(uint, klen, sizeof(head)));
+
+    return be64_to_cpu(head);
+}
+
 /*
  * Version 4
  */
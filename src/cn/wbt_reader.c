@@ -18,6 +18,7 @@
 #include "kblock_reader.h"
 
 /* omf version specific includes */
+#include "wbt_reader_v6.h"
 #include "wbt_reader_v5.h"
 #include "wbt_reader_v4.h"
 
@@ -39,9 +40,11 @@ wbt_read_kmd_vref(const void *kmd, size_t *off, u64 *seq, struct kvs_vtuple_ref
     uint           vboff = 0;
     uint           vlen = 0;
     uint           complen = 0;
+    uint           codec = 0;
     const void *   vdata = 0;
+    u32            expiry;
 
-    kmd_type_seq(kmd, off, &vtype, seq);
+    kmd_type_seq_exp(kmd, off, &vtype, seq, &expiry);
 
     switch (vtype) {
         case vtype_val:
@@ -56,13 +59,19 @@ wbt_read_kmd_vref(const void *kmd, size_t *off, u64 *seq, struct kvs_vtuple_ref
             vref->vb.vr_complen = 0;
             break;
         case vtype_cval:
-            kmd_cval(kmd, off, &vbidx, &vboff, &vlen, &complen);
+        case vtype_ccval:
+            if (vtype == vtype_ccval)
+                kmd_ccval(kmd, off, &vbidx, &vboff, &vlen, &complen, &codec);
+            else
+                kmd_cval(kmd, off, &vbidx, &vboff, &vlen, &complen);
             /* assert no truncation */
             assert(vbidx <= U16_MAX);
             assert(vboff <= U32_MAX);
             assert(vlen <= U32_MAX);
             assert(complen <= U32_MAX);
+            assert(codec <= U8_MAX);
             vref->vb.vr_index = vbidx;
+            vref->vb.vr_codec = codec;
             vref->vb.vr_off = vboff;
             vref->vb.vr_len = vlen;
             vref->vb.vr_complen = complen;
@@ -80,13 +89,23 @@ wbt_read_kmd_vref(const void *kmd, size_t *off, u64 *seq, struct kvs_vtuple_ref
             break;
     }
 
+    /* An expired value reads as a tombstone so that it still hides
+     * older values of the key.
+     */
+    if (kvs_expired(expiry))
+        vtype = vtype_tomb;
+
     vref->vr_type = vtype;
+    vref->vr_expiry = expiry;
 }
 
 bool
 wbti_seek(struct wbti *self, struct kvs_ktuple *seek)
 {
     switch (self->wbd->wbd_version) {
+        case WBT_TREE_VERSION8:
+            return wbti6_seek(self, seek);
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             return wbti5_seek(self, seek);
@@ -102,6 +121,8 @@ bool
 wbti_next(struct wbti *self, const void **kdata, uint *klen, const void **kmd)
 {
     switch (self->wbd->wbd_version) {
+        case WBT_TREE_VERSION8: /* v6 leaf nodes iterate as v5 */
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             return wbti5_next(self, kdata, klen, kmd);
@@ -123,6 +144,10 @@ wbti_reset(
     bool                  cache)
 {
     switch (desc->wbd_version) {
+        case WBT_TREE_VERSION8:
+            wbti6_reset(self, kbd, desc, seek, reverse, cache);
+            break;
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             wbti5_reset(self, kbd, desc, seek, reverse, cache);
@@ -180,6 +205,8 @@ void
 wbti_prefix(struct wbti *self, const void **pfx, uint *pfx_len)
 {
     switch (self->wbd->wbd_version) {
+        case WBT_TREE_VERSION8:
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             wbt_node_pfx(self->node, pfx, pfx_len);
@@ -202,6 +229,9 @@ wbtr_read_vref(
     struct kvs_vtuple_ref *     vref)
 {
     switch (wbd->wbd_version) {
+        case WBT_TREE_VERSION8:
+            return wbtr6_read_vref(kbd, wbd, kt, lcp, seq, lookup_res, vref);
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
             return wbtr5_read_vref(kbd, wbd, kt, lcp, seq, lookup_res, vref);
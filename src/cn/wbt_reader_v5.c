@@ -37,8 +37,8 @@ wbti_get_page(struct wbti *self, u32 node_idx)
     self->node_idx = node_idx;
 }
 
-static int
-wbtr_seek_page(
+int
+wbtr5_seek_page(
     const struct kvs_mblk_desc *kbd,
     const struct wbt_desc *     wbd,
     const void *                kt_data,
@@ -211,7 +211,7 @@ wbti_seek_fwd(struct wbti *self, struct kvs_ktuple *kt)
     kt_data = kt->kt_data;
     kt_len = abs(kt->kt_len);
 
-    node_num = wbtr_seek_page(kbd, wbd, kt_data, kt_len, 0);
+    node_num = wbtr5_seek_page(kbd, wbd, kt_data, kt_len, 0);
     wbti_get_page(self, node_num);
 
     assert(0 <= node_num && node_num < wbd->wbd_n_pages);
@@ -408,7 +408,7 @@ wbti_seek_rev(struct wbti *self, struct kvs_ktuple *kt)
     if (create)
         kt_len = HSE_KVS_KLEN_MAX;
 
-    node_num = wbtr_seek_page(kbd, wbd, kt_data, kt_len, 0);
+    node_num = wbtr5_seek_page(kbd, wbd, kt_data, kt_len, 0);
     dbg_nrepeat = 0;
 
 repeat:
@@ -694,7 +694,7 @@ wbtr5_read_vref(
 
     assert(kt->kt_len > 0);
 
-    node_num = wbtr_seek_page(kbd, wbd, kt_data, kt_len, 0);
+    node_num = wbtr5_seek_page(kbd, wbd, kt_data, kt_len, 0);
 
     assert(0 <= node_num && node_num < wbd->wbd_n_pages);
     pg = wbd->wbd_first_page + node_num;
@@ -10,6 +10,17 @@
 
 struct wbti;
 
+/* Descend the internal nodes (OMF v5 and later) to the leaf node that may
+ * contain the given key and return its node number.
+ */
+int
+wbtr5_seek_page(
+    const struct kvs_mblk_desc *kbd,
+    const struct wbt_desc *     wbd,
+    const void *                kt_data,
+    uint                        kt_len,
+    uint                        lcp);
+
 bool
 wbti5_seek(struct wbti *self, struct kvs_ktuple *seek);
 
@@ -0,0 +1,537 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/slab.h>
+#include <hse_util/mman.h>
+
+#include <hse/hse_limits.h>
+
+#include <hse_ikvdb/tuple.h>
+#include <hse_ikvdb/omf_kmd.h>
+
+#include "wbt_internal.h"
+#include "omf.h"
+#include "kvs_mblk_desc.h"
+#include "kblock_reader.h"
+
+#include "wbt_reader.h"
+#include "wbt_reader_v5.h"
+#include "wbt_reader_v6.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/* Below this many candidate heads the search switches from bisection to a
+ * linear vector compare.
+ */
+#define WBT6_RANK_WINDOW (16)
+
+typedef int
+wbt6_head_rank_fn(const u64 *headv, int first, int last, u64 head);
+
+/* Return the index of the first head in headv[first..last] that is not less
+ * than @head (last + 1 if none).  The heads are stored big-endian and are in
+ * non-decreasing order.
+ */
+static int
+wbt6_head_rank_generic(const u64 *headv, int first, int last, u64 head)
+{
+    while (first <= last) {
+        int j = (first + last) / 2;
+
+        if (be64_to_cpu(headv[j]) < head)
+            first = j + 1;
+        else
+            last = j - 1;
+    }
+
+    return first;
+}
+
+#if defined(__x86_64__)
+/* AVX2 head rank.  Bisect down to a small window, then byte-swap four heads
+ * at a time and compare them all against @head.  AVX2 only has a signed
+ * 64-bit compare, so both sides are biased by the sign bit.  Since the heads
+ * are sorted, the lanes less than @head form a prefix of each group.
+ */
+__attribute__((target("avx2"))) static int
+wbt6_head_rank_avx2(const u64 *headv, int first, int last, u64 head)
+{
+    const __m256i bswap = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m256i sign = _mm256_set1_epi64x(1ull << 63);
+    __m256i       vhead;
+
+    while (last - first >= WBT6_RANK_WINDOW) {
+        int j = (first + last) / 2;
+
+        if (be64_to_cpu(headv[j]) < head)
+            first = j + 1;
+        else
+            last = j - 1;
+    }
+
+    vhead = _mm256_set1_epi64x(head ^ (1ull << 63));
+
+    for (; first + 3 <= last; first += 4) {
+        __m256i v;
+        int     lt;
+
+        v = _mm256_loadu_si256((const void *)(headv + first));
+        v = _mm256_xor_si256(_mm256_shuffle_epi8(v, bswap), sign);
+
+        lt = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(vhead, v)));
+        if (lt != 0xf)
+            return first + __builtin_ctz(~lt);
+    }
+
+    while (first <= last && be64_to_cpu(headv[first]) < head)
+        ++first;
+
+    return first;
+}
+#endif
+
+static int
+wbt6_head_rank_resolve(const u64 *headv, int first, int last, u64 head);
+
+/* wbt6_head_rank points to the fastest head rank supported by the running
+ * cpu (selected on first use).
+ */
+static wbt6_head_rank_fn *wbt6_head_rank = wbt6_head_rank_resolve;
+
+static int
+wbt6_head_rank_resolve(const u64 *headv, int first, int last, u64 head)
+{
+    wbt6_head_rank_fn *fn = wbt6_head_rank_generic;
+
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        fn = wbt6_head_rank_avx2;
+#endif
+
+    /* Benign race: all threads resolve to the same function. */
+    wbt6_head_rank = fn;
+
+    return fn(headv, first, last, head);
+}
+
+/**
+ * wbt6_lfe_search() - search a leaf node for a key suffix
+ * @node:   leaf node
+ * @kdata:  key suffix (the key less the node prefix)
+ * @klen:   length of @kdata
+ * @found:  (output) true if the key at the returned index equals @kdata
+ *
+ * Return: The index of the first key in the node that is not less than
+ * @kdata, or the number of keys in the node if there is none.
+ *
+ * Only the keys whose heads equal that of @kdata are compared in full, and
+ * those are bisected, so this is usually a single keycmp().
+ */
+static int
+wbt6_lfe_search(void *node, const void *kdata, uint klen, bool *found)
+{
+    const u64 *headv = wbt_lfe_heads(node);
+    u64        head = wbt_key_head(kdata, klen);
+    int        first, last;
+
+    *found = false;
+
+    last = omf_wbn_num_keys(node) - 1;
+    first = wbt6_head_rank(headv, 0, last, head);
+
+    if (first > last || be64_to_cpu(headv[first]) != head)
+        return first;
+
+    /* Limit the full compares to the run of equal heads. */
+    if (head < U64_MAX)
+        last = wbt6_head_rank(headv, first, last, head + 1) - 1;
+
+    while (first <= last) {
+        int                 j = (first + last) / 2;
+        struct wbt_lfe_omf *lfe = wbt_lfe(node, j);
+        const void *        sfx;
+        uint                sfx_len;
+        int                 cmp;
+
+        wbt_lfe_key(node, lfe, &sfx, &sfx_len);
+
+        cmp = keycmp(kdata, klen, sfx, sfx_len);
+        if (cmp < 0) {
+            last = j - 1;
+        } else if (cmp > 0) {
+            first = j + 1;
+        } else {
+            *found = true;
+            return j;
+        }
+    }
+
+    return first;
+}
+
+static void
+wbti_get_page(struct wbti *self, u32 node_idx)
+{
+    size_t mblock_offset;
+
+    assert(node_idx != self->node_idx || self->node == NULL);
+
+    mblock_offset = PAGE_SIZE * (node_idx + self->wbd->wbd_first_page);
+    self->node = (struct wbt_node_hdr_omf *)(self->kbd->map_base + mblock_offset);
+
+    assert(omf_wbn_magic(self->node) == WBT_LFE_NODE_MAGIC);
+
+    self->lfe_idx = -1;
+    self->node_idx = node_idx;
+}
+
+/*
+ * See wbti_seek_fwd() in wbt_reader_v5.c for how the iterator is positioned
+ * after the prefix compare.  Only the search over key suffixes differs.
+ */
+static bool
+wbti_seek_fwd(struct wbti *self, struct kvs_ktuple *kt)
+{
+    struct wbt_node_hdr_omf *node;
+    int                      cmp, node_num;
+    int                      first, lfe_eof;
+    size_t                   pg;
+    const void *             kdata, *kt_data;
+    uint                     klen, kt_len, cmplen;
+    struct wbt_lfe_omf *     lfe;
+    struct kvs_mblk_desc *   kbd = self->kbd;
+    struct wbt_desc *        wbd = self->wbd;
+
+    bool create = kt->kt_len < 0;
+    bool sfx_search;
+    bool found;
+
+    const void *node_pfx;
+    uint        node_pfx_len;
+
+    if (self->node_idx == NODE_EOF)
+        return false;
+
+    kt_data = kt->kt_data;
+    kt_len = abs(kt->kt_len);
+
+    node_num = wbtr5_seek_page(kbd, wbd, kt_data, kt_len, 0);
+    wbti_get_page(self, node_num);
+
+    assert(0 <= node_num && node_num < wbd->wbd_n_pages);
+    pg = wbd->wbd_first_page + node_num;
+    node = kbd->map_base + pg * PAGE_SIZE;
+
+    /* at leaf */
+    assert(omf_wbn_magic(node) == WBT_LFE_NODE_MAGIC);
+
+    first = 0;
+    lfe_eof = omf_wbn_num_keys(node) - 1;
+
+    wbt_node_pfx(node, &node_pfx, &node_pfx_len);
+
+    cmplen = min_t(size_t, node_pfx_len, kt_len);
+    cmp = keycmp(kt->kt_data, cmplen, node_pfx, cmplen);
+
+    if (kt_len < node_pfx_len) {
+        sfx_search = false;
+        if (create)
+            self->lfe_idx = cmp ? lfe_eof : first - 1;
+        else
+            self->lfe_idx = cmp > 0 ? lfe_eof : first - 1;
+    } else {
+        sfx_search = !cmp;
+        self->lfe_idx = lfe_eof;
+        if (!create && cmp < 0)
+            self->lfe_idx = first - 1;
+
+        kt_data += node_pfx_len;
+        kt_len -= node_pfx_len;
+    }
+
+    if (!sfx_search)
+        goto skip_search;
+
+    first = wbt6_lfe_search(node, kt_data, kt_len, &found);
+    if (found) {
+        self->lfe_idx = first - 1;
+        return true;
+    }
+
+    /* We didn't find an exact match, follow edge indicated by 'first'.
+     * If this is a cursor seek then position the cursor to the next key.
+     */
+    if (!create)
+        self->lfe_idx = first - 1;
+
+skip_search:
+
+    if (!create)
+        return true; /* cursor seek */
+
+    /* It wasn't a seek, must be a cursor create.  Compare with
+     * the prefix of the best match to determine if found.
+     */
+    lfe = wbt_lfe(node, first);
+    wbt_lfe_key(node, lfe, &kdata, &klen);
+
+    if (sfx_search) {
+        cmp = keycmp_prefix(kt_data, kt_len, kdata, klen);
+        if (!cmp)
+            self->lfe_idx = first - 1; /* found pfx key */
+    }
+
+    return !cmp;
+}
+
+/*
+ * See wbti_seek_rev() in wbt_reader_v5.c for how the iterator is positioned
+ * after the prefix compare, and why the previous node may need to be checked
+ * during a cursor create.  Only the search over key suffixes differs.
+ */
+static bool
+wbti_seek_rev(struct wbti *self, struct kvs_ktuple *kt)
+{
+    struct wbt_node_hdr_omf *node;
+    int                      cmp, node_num;
+    int                      first, last, lfe_eof;
+    size_t                   pg;
+    const void *             kdata, *kt_data;
+    uint                     klen, kt_len, cmplen;
+    struct wbt_lfe_omf *     lfe;
+    struct kvs_mblk_desc *   kbd = self->kbd;
+    struct wbt_desc *        wbd = self->wbd;
+    bool                     create = kt->kt_len < 0;
+    bool                     sfx_search;
+    bool                     found;
+    const void *             node_pfx;
+    uint                     node_pfx_len;
+
+    if (self->node_idx == NODE_EOF)
+        return false;
+
+    /* Exploit the fact that kt->kt_data is padded with 0xff if this is a
+     * cursor create.
+     */
+    kt_data = kt->kt_data;
+    kt_len = abs(kt->kt_len);
+    if (create)
+        kt_len = HSE_KVS_KLEN_MAX;
+
+    node_num = wbtr5_seek_page(kbd, wbd, kt_data, kt_len, 0);
+
+repeat:
+    wbti_get_page(self, node_num);
+
+    assert(0 <= node_num && node_num < wbd->wbd_n_pages);
+    pg = wbd->wbd_first_page + node_num;
+    node = kbd->map_base + pg * PAGE_SIZE;
+
+    /* at leaf */
+    assert(omf_wbn_magic(node) == WBT_LFE_NODE_MAGIC);
+
+    lfe_eof = first = 0;
+    last = omf_wbn_num_keys(node) - 1;
+
+    wbt_node_pfx(node, &node_pfx, &node_pfx_len);
+    cmplen = min_t(size_t, node_pfx_len, abs(kt->kt_len));
+    cmp = keycmp(kt->kt_data, cmplen, node_pfx, cmplen);
+
+    if (abs(kt->kt_len) < node_pfx_len) {
+        sfx_search = false;
+        if (create)
+            self->lfe_idx = cmp ? lfe_eof : last + 1;
+        else
+            self->lfe_idx = cmp < 0 ? lfe_eof : last + 1;
+    } else {
+        sfx_search = !cmp;
+
+        if (create)
+            self->lfe_idx = cmp ? lfe_eof : last + 1;
+        else
+            self->lfe_idx = cmp < 0 ? lfe_eof : last + 1;
+
+        kt_data += node_pfx_len;
+        kt_len -= node_pfx_len;
+    }
+
+    /* Check previous node if necessary. */
+    if (unlikely(create && cmp < 0 && node_num > 0)) {
+        node_num--;
+        kt_data = kt->kt_data;
+        kt_len = HSE_KVS_KLEN_MAX;
+        goto repeat;
+    }
+
+    if (!sfx_search)
+        goto skip_search;
+
+    first = wbt6_lfe_search(node, kt_data, kt_len, &found);
+    if (found) {
+        self->lfe_idx = first + 1;
+        return true;
+    }
+
+    last = first - 1;
+
+    /* Check previous node if cursor prefix is smaller than the current
+     * node.
+     */
+    if (unlikely(create && !first && node_num > 0)) {
+        node_num--;
+        kt_data = kt->kt_data;
+        kt_len = HSE_KVS_KLEN_MAX;
+        goto repeat;
+    }
+
+skip_search:
+
+    /* We didn't find an exact match, follow edge indicated by 'last'.
+     * If this is a cursor seek then position the cursor to the next key.
+     */
+    if (!create) {
+        if (sfx_search)
+            self->lfe_idx = last + 1;
+
+        return true; /* cursor seek */
+    }
+
+    /* It wasn't a seek, must be a cursor create.  Compare with
+     * the prefix of the best match to determine if found.
+     */
+    lfe = wbt_lfe(node, last);
+    wbt_lfe_key(node, lfe, &kdata, &klen);
+
+    if (sfx_search) {
+        kt_data = kt->kt_data + node_pfx_len;
+        kt_len = abs(kt->kt_len) - node_pfx_len;
+
+        cmp = keycmp_prefix(kt_data, kt_len, kdata, klen);
+        if (!cmp)
+            self->lfe_idx = last + 1; /* found pfx key */
+    }
+
+    return !cmp;
+}
+
+bool
+wbti6_seek(struct wbti *self, struct kvs_ktuple *seek)
+{
+    return self->reverse ? wbti_seek_rev(self, seek) : wbti_seek_fwd(self, seek);
+}
+
+void
+wbti6_reset(
+    struct wbti *         self,
+    struct kvs_mblk_desc *kbd,
+    struct wbt_desc *     desc,
+    struct kvs_ktuple *   seek,
+    bool                  reverse,
+    bool                  cache)
+{
+    /* self is not zeroed out so be sure to initialize all fields.
+     */
+    self->wbd = desc;
+    self->kbd = kbd;
+    self->node = NULL;
+    self->kmd = kbd->map_base + PAGE_SIZE * (self->wbd->wbd_first_page + self->wbd->wbd_root + 1);
+
+    self->node_idx = 0;
+    self->lfe_idx = 0;
+    self->reverse = reverse;
+
+    if (cache)
+        kbr_madvise_wbt_leaf_nodes(kbd, desc, MADV_NORMAL);
+
+    if (seek) {
+        if (!wbti6_seek(self, seek))
+            self->node_idx = NODE_EOF;
+    } else {
+        wbti_get_page(self, reverse ? desc->wbd_leaf_cnt - 1 : 0);
+
+        if (reverse) {
+            self->lfe_idx = omf_wbn_num_keys(self->node);
+            self->node_idx = desc->wbd_leaf + desc->wbd_leaf_cnt - 1;
+        }
+    }
+}
+
+merr_t
+wbtr6_read_vref(
+    const struct kvs_mblk_desc *kbd,
+    const struct wbt_desc *     wbd,
+    const struct kvs_ktuple *   kt,
+    uint                        lcp,
+    u64                         seq,
+    enum key_lookup_res *       lookup_res,
+    struct kvs_vtuple_ref *     vref)
+{
+    struct wbt_node_hdr_omf *node;
+    struct wbt_lfe_omf *     lfe;
+    int                      j, node_num;
+    size_t                   pg, off;
+    const void *             node_pfx;
+    uint                     node_pfx_len;
+    void *                   kmd;
+    u64                      vseq;
+    uint                     nvals;
+    bool                     found;
+
+    assert(kt->kt_len > 0);
+
+    node_num = wbtr5_seek_page(kbd, wbd, kt->kt_data, kt->kt_len, 0);
+
+    assert(0 <= node_num && node_num < wbd->wbd_n_pages);
+    pg = wbd->wbd_first_page + node_num;
+    node = kbd->map_base + pg * PAGE_SIZE;
+
+    /* at leaf */
+    assert(omf_wbn_magic(node) == WBT_LFE_NODE_MAGIC);
+
+    wbt_node_pfx(node, &node_pfx, &node_pfx_len);
+
+    /* Not finding the key is *not* an error. */
+    *lookup_res = NOT_FOUND;
+
+    if (kt->kt_len < node_pfx_len || keycmp(kt->kt_data, node_pfx_len, node_pfx, node_pfx_len))
+        return 0;
+
+    j = wbt6_lfe_search(node, kt->kt_data + node_pfx_len, kt->kt_len - node_pfx_len, &found);
+    if (!found)
+        return 0;
+
+    lfe = wbt_lfe(node, j);
+    kmd = kbd->map_base + PAGE_SIZE * (wbd->wbd_first_page + wbd->wbd_root + 1);
+
+    off = wbt_lfe_kmd(node, lfe);
+    assert(off < wbd->wbd_kmd_pgc * PAGE_SIZE);
+    nvals = kmd_count(kmd, &off);
+    assert(nvals > 0);
+    while (nvals--) {
+        wbt_read_kmd_vref(kmd, &off, &vseq, vref);
+        assert(off <= wbd->wbd_kmd_pgc * PAGE_SIZE);
+        if (seq >= vseq) {
+            vref->vr_seq = vseq;
+            if (vref->vr_type == vtype_tomb)
+                *lookup_res = FOUND_TMB;
+            else if (vref->vr_type == vtype_ptomb)
+                *lookup_res = FOUND_PTMB;
+            else
+                *lookup_res = FOUND_VAL;
+
+            break;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_CN_WBT_READER_v6_H
+#define HSE_KVS_CN_WBT_READER_v6_H
+
+#pragma GCC visibility push(hidden)
+
+struct wbti;
+
+/* The v6 leaf node reader handles wbtrees of OMF v8, whose leaf nodes
+ * carry key heads.  Iteration (wbti5_next) and the internal node descent
+ * (wbtr5_seek_page) are shared with the v5 reader.
+ */
+
+bool
+wbti6_seek(struct wbti *self, struct kvs_ktuple *seek);
+
+void
+wbti6_reset(
+    struct wbti *         self,
+    struct kvs_mblk_desc *kbd,
+    struct wbt_desc *     desc,
+    struct kvs_ktuple *   seek,
+    bool                  reverse,
+    bool                  cache);
+
+merr_t
+wbtr6_read_vref(
+    const struct kvs_mblk_desc *kbd,
+    const struct wbt_desc *     wbd,
+    const struct kvs_ktuple *   kt,
+    uint                        lcp,
+    u64                         seq,
+    enum key_lookup_res *       lookup_res,
+    struct kvs_vtuple_ref *     vref);
+
+#pragma GCC visibility pop
+
+#endif /* HSE_KVS_CN_WBT_READER_v6_H */
@@ -175,6 +175,19 @@ c0_pfx_probe(
 merr_t
 c0_prefix_del(struct c0 *self, struct kvs_ktuple *key, u64 seqno);
 
+/**
+ * c0_range_del() - delete all keys in the range [start, end)
+ * @self:      Instance of struct c0 from which to delete
+ * @start:     first key of the range
+ * @end:       key following the last key of the range
+ * @seqno:     seqno to use for range delete
+ *
+ * Return: 0 on success, otherwise an error
+ */
+/* MTF_MOCK */
+merr_t
+c0_range_del(struct c0 *self, struct kvs_ktuple *start, struct kvs_ktuple *end, u64 seqno);
+
 /**
  * c0_sync() - force ingest of existing c0 data and waits until ingest complete
  * @self:      Instance of struct c0 to flush
@@ -246,6 +259,19 @@ c0_cursor_seek(
 merr_t
 c0_cursor_read(struct c0_cursor *c0cur, struct kvs_kvtuple *kvt, bool *eof);
 
+/**
+ * c0_cursor_rtomb_covers() - check if a key is hidden by a c0 range tombstone
+ * @c0cur:     Instance of struct c0_cursor
+ * @key:       Key
+ * @klen:      Key length
+ *
+ * Every c0 range tombstone visible to the cursor is newer than all the
+ * keys in cN which it covers, so the cursor must hide such keys.
+ */
+/* MTF_MOCK */
+bool
+c0_cursor_rtomb_covers(struct c0_cursor *c0cur, const void *key, u32 klen);
+
 /**
  * c0_cursor_update() - update existing iterators over c0
  * @c0cur:      Instance of struct c0_cursor
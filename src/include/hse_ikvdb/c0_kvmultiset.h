@@ -131,6 +131,18 @@ c0kvms_size(struct c0_kvmultiset *handle);
 size_t
 c0kvms_get_mut_sz(struct c0_kvmultiset *handle);
 
+/**
+ * c0kvms_may_contain() - check the kvms key filter for the given key hash
+ * @mset:  Struct c0_kvmultiset to check
+ * @hash:  Key hash (i.e., kt_hash)
+ *
+ * Return: %false if no key with the given hash has been put or deleted
+ * in any of the kvms' hashed c0kvsets, %true if such a key might exist.
+ * Prefix tombstones are not tracked by the filter.
+ */
+bool
+c0kvms_may_contain(struct c0_kvmultiset *mset, u64 hash);
+
 /**
  * c0kvms_get_hashed_c0kvset() - obtain the c0_kvset at the given index
  * @mset:  Struct c0_kvmultiset to lookup in
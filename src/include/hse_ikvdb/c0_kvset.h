@@ -11,6 +11,9 @@
 #include <hse_util/rcu.h>
 
 #include <hse_ikvdb/kvs.h>
+#include <hse_ikvdb/rtomb.h>
+
+struct c0_filter;
 
 struct c0_kvset {
 };
@@ -129,6 +132,15 @@ c0kvs_alloc(struct c0_kvset *handle, size_t align, size_t sz);
 void
 c0kvs_ingesting_init(struct c0_kvset *handle, atomic_t *ingesting);
 
+/**
+ * c0kvs_filter_init() - attach a key membership filter to a c0kvs
+ * @handle:     c0kvs handle
+ * @filter:     filter to which the hash of each put/del key is added
+ *              (may be NULL)
+ */
+void
+c0kvs_filter_init(struct c0_kvset *handle, struct c0_filter *filter);
+
 /**
  * c0kvs_put() - insert a key/value pair into the struct c0_kvset
  * @set:   Struct c0_kvset to insert the key/value into
@@ -186,6 +198,39 @@ c0kvs_prefix_del(
     const struct kvs_ktuple *key,
     const uintptr_t          seqno);
 
+/**
+ * c0kvs_range_del() - insert a range tombstone
+ * @set:   Struct c0_kvset to insert the range tombstone into
+ * @skidx: index of the kvs
+ * @start: first key of the range
+ * @end:   key following the last key of the range (i.e., not deleted)
+ * @seqno: seqno to use for range delete
+ *
+ * The range tombstone hides all keys k in the kvs such that
+ * start <= k < end which were put before the range delete.
+ * Range tombstones are not kept in the bonsai tree, but rather
+ * in a list that is retrieved via c0kvs_rtombs().
+ *
+ * Return: 0 on success, ENOMEM if the kvset is full
+ */
+merr_t
+c0kvs_range_del(
+    struct c0_kvset *        set,
+    u16                      skidx,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end,
+    const uintptr_t          seqno);
+
+/**
+ * c0kvs_rtombs() - return the list of range tombstones in a c0kvset
+ * @set:   Struct c0_kvset
+ *
+ * The list is ordered newest to oldest and may be traversed without
+ * locks for as long as the caller holds a reference on the kvms.
+ */
+struct rtomb *
+c0kvs_rtombs(struct c0_kvset *set);
+
 /**
  * c0kvs_get_rcu() - given a key, retrieve a value from a struct c0_kvset
  * @handle:     Struct c0_kvset to search
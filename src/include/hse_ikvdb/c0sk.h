@@ -200,6 +200,25 @@ c0sk_pfx_probe(
 merr_t
 c0sk_prefix_del(struct c0sk *self, u16 skidx, const struct kvs_ktuple *key, u64 seq);
 
+/**
+ * c0sk_range_del() - delete all keys in the range [start, end)
+ * @self:      Instance of struct c0sk from which to delete
+ * @skidx:     Structured key index
+ * @start:     First key of the range
+ * @end:       Key following the last key of the range
+ * @seq:       Sequence number for insertion
+ *
+ * Return: 0 on success, otherwise an error
+ */
+/* MTF_MOCK */
+merr_t
+c0sk_range_del(
+    struct c0sk *            self,
+    u16                      skidx,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end,
+    u64                      seq);
+
 /**
  * c0sk_rparams() - Get a ptr to c0sk kvdb rparams
  * @self:       Instance of struct c0sk
@@ -306,6 +325,17 @@ c0sk_cursor_seek(
 merr_t
 c0sk_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof);
 
+/**
+ * c0sk_cursor_rtomb_covers() - check if a key is covered by a range tombstone
+ * @c0cur:      The existing cursor.
+ * @key:        key
+ * @klen:       key length
+ *
+ * Return: true if a range tombstone visible to the cursor covers the key
+ */
+bool
+c0sk_cursor_rtomb_covers(struct c0_cursor *cur, const void *key, u32 klen);
+
 /**
  * c0sk_cursor_update() - update existing iterators over c0
  * @c0cur:      The existing cursor.
@@ -56,6 +56,18 @@ c0skm_flush(struct c0sk *self);
 merr_t
 c0skm_sync(struct c0sk *self);
 
+/**
+ * c0skm_sync_op() - Wait for a single operation to be persisted in c1
+ * @self:       Instance of struct c0sk
+ *
+ * Same as c0skm_sync(), but accounted separately in perfc.  Intended
+ * to be called after the mutation is visible in c0.  Concurrent callers
+ * share a single c1 ingest.
+ */
+/* MTF_MOCK */
+merr_t
+c0skm_sync_op(struct c0sk *self);
+
 /**
  * c0skm_set_tseqno() - Set the last committed transaction seq. no.
  * @handle: c0sk handle
@@ -48,6 +48,16 @@ enum c1_ingest_type {
     C1_INGEST_SYNC,
 };
 
+/* Type of a c1 value record.  These values are stored on media in
+ * c1vt_tomb.  A C1_VTYPE_RTOMB record is a range tombstone whose key
+ * is the start of the range and whose value is the end of the range.
+ */
+enum c1_vtype {
+    C1_VTYPE_VAL = 0,
+    C1_VTYPE_TOMB = 1,
+    C1_VTYPE_RTOMB = 2,
+};
+
 struct c1_kvinfo {
     u64 ck_kcnt;
     u64 ck_vcnt;
@@ -331,10 +341,11 @@ c1_vtuple_alloc(struct c1_kvcache *cc, struct c1_vtuple **cvt);
  * @vlen:
  * @seqno:
  * @data:
- * @tomb:
+ * @vtype:  enum c1_vtype
+ * @expiry: expiry time (see kvs_expired()), zero if none
  */
 void
-c1_vtuple_init(struct c1_vtuple *cvt, u64 vlen, u64 seqno, void *data, bool tomb);
+c1_vtuple_init(struct c1_vtuple *cvt, u64 vlen, u64 seqno, void *data, u32 vtype, u32 expiry);
 
 /**
  * c1_is_clean -
@@ -66,6 +66,26 @@ ikvdb_c1_replay_del(
     struct kvs_ktuple *     kt,
     struct kvs_vtuple *     vt);
 
+/**
+ * ikvdb_c1_replay_range_del() - Replay handler for kvdb range deletes
+ * @ikdb:   kvdb handle
+ * @replay: Opaque structure represeting all kvses inside kvdb
+ * @seqno:  Sequence number saved in c1
+ * @cnid:   Unique CNID representing a kvs in kvdb
+ * @os:     kvdb_opspec structure
+ * @start:  start of the range (inclusive)
+ * @end:    end of the range (exclusive)
+ */
+merr_t
+ikvdb_c1_replay_range_del(
+    struct ikvdb *          ikdb,
+    struct ikvdb_c1_replay *replay,
+    u64                     seqno,
+    u64                     cnid,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     start,
+    struct kvs_ktuple *     end);
+
 /**
  * ikvdb_c1_set_seqno() - Set kvdb seqno post reply
  * @replay: Opaque structure represeting all kvses inside kvdb
@@ -18,6 +18,7 @@
 /* MTF_MOCK_DECL(cn) */
 
 #define CN_CFLAG_CAPPED (1 << 0)
+#define CN_CFLAG_FUSE (1 << 1) /* kblocks use binary fuse filters */
 
 struct cn;
 struct cn_kvdb;
@@ -29,6 +30,7 @@ struct kvset_mblocks;
 struct kvdb_kvs;
 struct sts;
 struct mclass_policy;
+struct tbkt;
 enum cn_action;
 enum mp_media_classp;
 
@@ -120,6 +122,23 @@ cn_get(
     enum key_lookup_res *res,
     struct kvs_buf *     vbuf);
 
+/**
+ * cn_get_batch() - search cn for a batch of keys
+ *
+ * Only keys whose result in @resv is %NOT_FOUND on entry are searched,
+ * which lets callers pass keys already resolved by c0 without compacting
+ * their vectors.
+ */
+/* MTF_MOCK */
+merr_t
+cn_get_batch(
+    struct cn *          cn,
+    u32                  cnt,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv);
+
 struct query_ctx;
 
 merr_t
@@ -186,10 +205,6 @@ cn_ref_put(struct cn *cn);
 u64
 cn_hash_get(const struct cn *cn);
 
-/* MTF_MOCK */
-struct workqueue_struct *
-cn_get_io_wq(struct cn *cn);
-
 /* MTF_MOCK */
 struct workqueue_struct *
 cn_get_maint_wq(struct cn *cn);
@@ -202,6 +217,10 @@ cn_get_sched(struct cn *cn);
 atomic_t *
 cn_get_cancel(struct cn *cn);
 
+/* MTF_MOCK */
+struct tbkt *
+cn_get_tbkt_maint(struct cn *cn);
+
 /* MTF_MOCK */
 struct perfc_set *
 cn_get_perfc(struct cn *cn, enum cn_action action);
@@ -214,6 +233,10 @@ cn_pc_capped_get(struct cn *cn);
 struct perfc_set *
 cn_pc_mclass_get(struct cn *cn);
 
+/* MTF_MOCK */
+struct perfc_set *
+cn_pc_lookup_get(struct cn *cn);
+
 /* MTF_MOCK */
 struct kvs_cparams *
 cn_get_cparams(const struct cn *handle);
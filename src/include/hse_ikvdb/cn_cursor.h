@@ -52,6 +52,32 @@ cn_cursor_destroy(void *cursor);
 merr_t
 cn_cursor_active_kvsets(void *cursor, u32 *active, u32 *total);
 
+/**
+ * cn_cursor_split() - choose keys that divide a cn into ranges of similar size
+ * @cn:       cn handle
+ * @prefix:   consider only keys with this prefix (may be NULL)
+ * @pfx_len:  length of @prefix
+ * @splitmax: maximum number of split keys to choose
+ * @keybuf:   buffer of @splitmax * HSE_KVS_KLEN_MAX bytes, the nth split
+ *            key is stored at offset n * HSE_KVS_KLEN_MAX
+ * @klenv:    vector of @splitmax split key lengths
+ * @splitcp:  (output) number of split keys chosen
+ *
+ * Split keys are chosen from the kblock fence keys (i.e., the smallest key
+ * of each kblock) weighted by kblock key count, and strictly increase.
+ * Fewer than @splitmax keys are chosen if the cn has too few kblocks.
+ */
+/* MTF_MOCK */
+merr_t
+cn_cursor_split(
+    struct cn * cn,
+    const void *prefix,
+    u32         pfx_len,
+    uint        splitmax,
+    void *      keybuf,
+    u32 *       klenv,
+    uint *      splitcp);
+
 #if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
 #include "cn_cursor_ut.h"
 #endif /* HSE_UNIT_TEST_MODE */
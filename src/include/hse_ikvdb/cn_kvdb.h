@@ -9,6 +9,9 @@
 #include <hse_util/atomic.h>
 #include <hse_util/hse_err.h>
 
+struct kvdb_rparams;
+struct cn_vcache;
+
 /* MTF_MOCK_DECL(cn_kvdb) */
 
 /**
@@ -17,17 +20,20 @@
  * @cnd_vblk_cnt:  number of cn vblocks in kvdb
  * @cnd_kblk_size: sum of on-media sizes of all cn kblocks in kvdb (bytes)
  * @cnd_vblk_size: sum of on-media sizes of all cn vblocks in kvdb (bytes)
+ * @cnd_vcache:    cache of values read directly from vblocks (may be NULL)
  */
 struct cn_kvdb {
     atomic64_t cnd_kblk_cnt;
     atomic64_t cnd_vblk_cnt;
     atomic64_t cnd_kblk_size;
     atomic64_t cnd_vblk_size;
+
+    struct cn_vcache *cnd_vcache;
 };
 
 /* MTF_MOCK */
 merr_t
-cn_kvdb_create(struct cn_kvdb **h);
+cn_kvdb_create(const char *mpname, const struct kvdb_rparams *rp, struct cn_kvdb **h);
 
 /* MTF_MOCK */
 void
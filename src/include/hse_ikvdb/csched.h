@@ -21,6 +21,7 @@ struct cn_samp_stats;
 struct mpool;
 struct hse_kvdb_compact_status;
 struct kvdb_health;
+struct tbkt;
 
 /**
  * enum csched_policy - compaction scheduler policy
@@ -76,6 +77,17 @@ csched_compact_request(struct csched *handle, int flags);
 void
 csched_compact_status_get(struct csched *handle, struct hse_kvdb_compact_status *status);
 
+/**
+ * csched_tbkt_maint_get() - get the token bucket that meters compaction I/O
+ * @handle: scheduler handle
+ *
+ * Return: token bucket to be charged with the bytes read and written by
+ * compaction jobs, or NULL if the scheduler doesn't govern compaction I/O.
+ */
+/* MTF_MOCK */
+struct tbkt *
+csched_tbkt_maint_get(struct csched *handle);
+
 #if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
 #include "csched_ut.h"
 #endif /* HSE_UNIT_TEST_MODE */
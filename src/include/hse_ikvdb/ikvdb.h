@@ -15,6 +15,7 @@
 #include <hse_ikvdb/diag_kvdb.h>
 
 #include <hse_util/inttypes.h>
+#include <hse_util/atomic.h>
 #include <hse_util/hse_err.h>
 #include <hse_util/perfc.h>
 #include <hse_util/workqueue.h>
@@ -38,6 +39,7 @@ struct c0sk;
 struct cndb;
 struct kvdb_diag_kvs_list;
 struct c1;
+struct kvdb_ctxn_set;
 
 struct kvs;
 
@@ -221,6 +223,18 @@ ikvdb_get_c0sk(struct ikvdb *kvdb, struct c0sk **out);
 void
 ikvdb_get_c1(struct ikvdb *handle, struct c1 **out);
 
+/**
+ * ikvdb_get_ctxn_set() - get a handle to the kvdb's transaction set
+ */
+struct kvdb_ctxn_set *
+ikvdb_get_ctxn_set(struct ikvdb *handle);
+
+/**
+ * ikvdb_get_seqno_addr() - get the address of the kvdb's current seqno
+ */
+atomic64_t *
+ikvdb_get_seqno_addr(struct ikvdb *handle);
+
 /**
  * ikvdb_get_sched() - get a handle to the associated scheduler
  */
@@ -323,6 +337,19 @@ ikvdb_kvs_get(
     enum key_lookup_res *   res,
     struct kvs_buf *        vbuf);
 
+/**
+ * ikvdb_kvs_get_batch() - search for a batch of keys within the KVS. All keys
+ * are looked up against the same view of the KVS.
+ */
+merr_t
+ikvdb_kvs_get_batch(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    u32                     cnt,
+    struct kvs_ktuple *     ktv,
+    enum key_lookup_res *   resv,
+    struct kvs_buf *        vbufv);
+
 /**
  * ikvdb_kvs_del() - remove the supplied key and associated value from the KVS
  * indexed by opspec->kop_index.
@@ -354,6 +381,18 @@ ikvdb_kvs_prefix_delete(
     struct kvs_ktuple *     kt,
     size_t *                kvs_pfx_len);
 
+/**
+ * ikvdb_kvs_range_delete() - remove all key/value pairs with keys in the
+ * range [start, end) from the KVS.  Not supported within transactions.
+ */
+/* MTF_MOCK */
+merr_t
+ikvdb_kvs_range_delete(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    struct kvs_ktuple *     start,
+    struct kvs_ktuple *     end);
+
 /**
  * ikvdb_sync() - flush data in all of the KVSes to stable media.
  */
@@ -426,6 +465,21 @@ ikvdb_kvs_cursor_create(
     size_t                  pfx_len,
     struct hse_kvs_cursor **cursor);
 
+/**
+ * ikvdb_kvs_cursor_partition() - create up to @cursormax cursors over
+ * disjoint, contiguous key ranges of a KVS, all with the same view.
+ * See hse_kvs_cursor_partition_exp().
+ */
+merr_t
+ikvdb_kvs_cursor_partition(
+    struct hse_kvs *        kvs,
+    struct hse_kvdb_opspec *opspec,
+    const void *            prefix,
+    size_t                  pfx_len,
+    unsigned int            cursormax,
+    struct hse_kvs_cursor **cursorv,
+    unsigned int *          cursorcp);
+
 /**
  * ikvdb_kvs_cursor_update() - incorporate updates since cursor created
  */
@@ -460,6 +514,21 @@ ikvdb_kvs_cursor_read(
     size_t *                val_len,
     bool *                  eof);
 
+/**
+ * ikvdb_kvs_cursor_read_batch() - pack as many key/value pairs from the
+ * cursor as fit into @buf, see hse_kvs_cursor_read_batch()
+ */
+merr_t
+ikvdb_kvs_cursor_read_batch(
+    struct hse_kvs_cursor * cursor,
+    struct hse_kvdb_opspec *opspec,
+    uint                    flags,
+    void *                  buf,
+    size_t                  buf_sz,
+    uint *                  count,
+    size_t *                buf_used,
+    bool *                  eof);
+
 /**
  * ikvdb_kvs_cursor_destroy() - allow the caller to indicate that is is done
  * with the scan and release the associated cursor
@@ -572,6 +641,12 @@ kvdb_kop_is_priority(const struct hse_kvdb_opspec *os)
     return os && (os->kop_flags & HSE_KVDB_KOP_FLAG_PRIORITY);
 }
 
+static __always_inline bool
+kvdb_kop_is_sync(const struct hse_kvdb_opspec *os)
+{
+    return os && (os->kop_flags & HSE_KVDB_KOP_FLAG_SYNC);
+}
+
 static __always_inline bool
 kvdb_kop_is_txn(const struct hse_kvdb_opspec *os)
 {
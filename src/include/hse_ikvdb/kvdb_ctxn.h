@@ -86,6 +86,19 @@ kvdb_ctxn_get_state(struct kvdb_ctxn *txn);
 merr_t
 kvdb_ctxn_get_view_seqno(struct kvdb_ctxn *txn, u64 *view_seqno);
 
+/**
+ * kvdb_ctxn_set_sync() - make the commit of the transaction synchronous
+ * @txn: transaction handle
+ *
+ * Set when a put or delete in the transaction requests synchronous
+ * durability, cleared by kvdb_ctxn_begin().
+ */
+void
+kvdb_ctxn_set_sync(struct kvdb_ctxn *txn);
+
+bool
+kvdb_ctxn_get_sync(struct kvdb_ctxn *txn);
+
 bool
 kvdb_ctxn_lock_inherit(
     u64                      start_seq,
@@ -152,6 +165,16 @@ kvdb_ctxn_set_create(struct kvdb_ctxn_set **handle_out, u64 txn_timeout, u64 mse
 void
 kvdb_ctxn_set_wait_commits(struct kvdb_ctxn_set *handle);
 
+/**
+ * kvdb_ctxn_set_commit_sn() - get the commit seqno of the latest commit
+ * @handle: kvdb ctxn set
+ *
+ * The result includes all commits with a seqno at or below a view
+ * established prior to calling kvdb_ctxn_set_wait_commits().
+ */
+u64
+kvdb_ctxn_set_commit_sn(struct kvdb_ctxn_set *handle);
+
 void
 kvdb_ctxn_set_destroy(struct kvdb_ctxn_set *handle);
 
@@ -22,6 +22,7 @@
  * @txn_wkth_delay:        delay (msecs) to invoke transaction worker thread
  * @cndb_entries:     max number of entries CNDB's in memory structures. Note
  *                    that this does not affect the MDC's size.
+ * @cn_vcache_sz:     size (bytes) of the cN value cache (0: disabled)
  * @pct_bandwidth:    qos, %  mpoolbandwidth for the kvdb
  * @iotag2vq:         qos, association iotags to mpool qos virtual queues.
  * @vq_w:             qos, virtual queues weights
@@ -65,6 +66,12 @@ struct kvdb_rparams {
     unsigned long csched_leaf_comp_params;
     unsigned long csched_leaf_len_params;
     unsigned long csched_node_min_ttl;
+    unsigned long csched_heat_hot;
+    unsigned long csched_heat_cold;
+    unsigned long csched_expired_pct;
+    unsigned long csched_gov_lat_ns;
+    unsigned long csched_gov_rate_min;
+    unsigned long csched_gov_rate_max;
 
     unsigned long dur_enable;
     unsigned long dur_intvl_ms;
@@ -91,8 +98,10 @@ struct kvdb_rparams {
     unsigned long log_squelch_ns;
     unsigned long txn_wkth_delay;
     unsigned int  cndb_entries;
+    unsigned long cn_vcache_sz;
     unsigned int  c0_maint_threads;
     unsigned int  c0_ingest_threads;
+    unsigned int  c0_ingest_kvs_threads;
     unsigned int  c0_mutex_pool_sz;
 
     unsigned int  keylock_entries;
@@ -93,6 +93,16 @@ ikvs_get(
     enum key_lookup_res *   res,
     struct kvs_buf *        vbuf);
 
+merr_t
+ikvs_get_batch(
+    struct ikvs *           ikvs,
+    struct hse_kvdb_opspec *os,
+    u32                     cnt,
+    struct kvs_ktuple *     ktv,
+    u64                     seqno,
+    enum key_lookup_res *   resv,
+    struct kvs_buf *        vbufv);
+
 merr_t
 ikvs_del(struct ikvs *ikvs, struct hse_kvdb_opspec *os, struct kvs_ktuple *key, u64 seqno);
 
@@ -109,6 +119,14 @@ ikvs_pfx_probe(
 merr_t
 ikvs_prefix_del(struct ikvs *ikvs, struct hse_kvdb_opspec *os, struct kvs_ktuple *key, u64 seqno);
 
+merr_t
+ikvs_range_del(
+    struct ikvs *           ikvs,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     start,
+    struct kvs_ktuple *     end,
+    u64                     seqno);
+
 u16
 ikvs_index(struct ikvs *ikvs);
 
@@ -145,6 +163,16 @@ ikvs_cursor_update(struct hse_kvs_cursor *cursor, u64 seqno);
 merr_t
 ikvs_cursor_read(struct hse_kvs_cursor *cursor, struct kvs_kvtuple *kvt, bool *eof);
 
+merr_t
+ikvs_cursor_read_batch(
+    struct hse_kvs_cursor *cursor,
+    uint                   flags,
+    void *                 buf,
+    size_t                 buf_sz,
+    uint *                 count,
+    size_t *               buf_used,
+    bool *                 eof);
+
 void
 ikvs_cursor_tombspan_check(struct hse_kvs_cursor *handle);
 
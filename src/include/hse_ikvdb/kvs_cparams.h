@@ -24,6 +24,7 @@ struct kvs_cparams {
     unsigned int  cp_pfx_pivot;
     unsigned int  cp_kvs_ext01;
     unsigned int  cp_sfx_len;
+    unsigned int  cp_kblk_filter;
     unsigned long cp_cpmagic;
 };
 
@@ -29,6 +29,7 @@
  */
 struct kvs_rparams {
     unsigned long kvs_debug;
+    unsigned long kvs_gcache_sz;
     unsigned long c0_cursor_ttl;
     unsigned long cn_cursor_ttl;
 
@@ -64,6 +65,8 @@ struct kvs_rparams {
     unsigned long cn_bloom_prob;
     unsigned long cn_bloom_capped;
     unsigned long cn_bloom_preload;
+    unsigned long cn_bloom_pfx;
+    unsigned long cn_bloom_pfx_len;
 
     unsigned long cn_verify;
     unsigned long cn_kcachesz;
@@ -76,7 +79,7 @@ struct kvs_rparams {
     unsigned long c1_vblock_size_mb;
     unsigned long c1_vblock_cappct;
 
-    unsigned long cn_io_threads;
+    unsigned long cn_open_threads;
     unsigned long cn_close_wait;
     unsigned long cn_diag_mode;
 
@@ -89,6 +92,7 @@ struct kvs_rparams {
     char mclass_policy[HSE_MPOLICY_NAME_LEN_MAX];
 
     unsigned long vcompmin;
+    unsigned long vcomplvl;
     char value_compression[VCOMP_PARAM_STR_SZ];
 
     unsigned long rpmagic;
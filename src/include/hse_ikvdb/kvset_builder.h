@@ -21,6 +21,7 @@ struct kvset_builder;
 struct kvs_rparams;
 struct perfc_set;
 struct cn_merge_stats;
+struct rtomb;
 
 #define KVSET_BUILDER_FLAGS_NONE    (0)
 #define KVSET_BUILDER_FLAGS_SPARE   (1u << 0)
@@ -58,7 +59,7 @@ kvset_builder_get_mblocks(struct kvset_builder *builder, struct kvset_mblocks *m
  *
  *   for (i = 0; !err && i < nvals; i++) {
  *       assert(i == 0 || seq[i] > seq[i-1]);
- *       err = kvset_builder_add_val(bld, seq[i], vdata[i], vlen[i]);
+ *       err = kvset_builder_add_val(bld, seq[i], vdata[i], vlen[i], 0, 0, 0);
  *   }
  *   err = kvset_builder_add_key(bld, kobj);
  *
@@ -79,7 +80,9 @@ kvset_builder_add_val(
     u64                     seq,
     const void *            vdata,
     uint                    vlen,
-    uint                    complen);
+    uint                    complen,
+    uint                    codec,
+    u32                     expiry);
 
 /* MTF_MOCK */
 merr_t
@@ -89,12 +92,26 @@ kvset_builder_add_vref(
     uint                    vbidx,
     uint                    vboff,
     uint                    vlen,
-    uint                    complen);
+    uint                    complen,
+    uint                    codec,
+    u32                     expiry);
 
 /* MTF_MOCK */
 merr_t
 kvset_builder_add_nonval(struct kvset_builder *self, u64 seq, enum kmd_vtype vtype);
 
+/**
+ * kvset_builder_add_rtomb() - add a range tombstone to the kvset
+ * @self: kvset builder
+ * @rt:   range tombstone (rt_skidx and rt_next are ignored)
+ *
+ * Range tombstones may be added at any time before the kvset builder
+ * is finished, they are stored in the last kblock of the kvset.
+ */
+/* MTF_MOCK */
+merr_t
+kvset_builder_add_rtomb(struct kvset_builder *self, const struct rtomb *rt);
+
 /* MTF_MOCK */
 void
 kvset_builder_destroy(struct kvset_builder *builder);
@@ -107,6 +124,10 @@ kvset_mblocks_destroy(struct kvset_mblocks *kvset);
 void
 kvset_builder_set_agegroup(struct kvset_builder *self, enum hse_mclass_policy_age age);
 
+/* MTF_MOCK */
+void
+kvset_builder_set_temp(struct kvset_builder *self, enum hse_mclass_policy_temp temp);
+
 /* MTF_MOCK */
 void
 kvset_builder_set_merge_stats(struct kvset_builder *self, struct cn_merge_stats *stats);
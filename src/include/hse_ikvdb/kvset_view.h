@@ -24,6 +24,7 @@ struct kvset_metrics {
     u32 tot_blm_pages;
     u16 compc;
     u32 vgroups;
+    u64 heat;
 };
 
 /* MTF_MOCK_DECL(kvset_view) */
@@ -60,6 +61,19 @@ kvset_get_nth_kblock_id(struct kvset *kvset, u32 index);
 u64
 kvset_get_nth_vblock_id(struct kvset *kvset, u32 index);
 
+/**
+ * kvset_get_nth_kblock_fence() - Get the smallest key and the number of
+ * keys of the nth kblock in kvset
+ */
+/* MTF_MOCK */
+void
+kvset_get_nth_kblock_fence(
+    struct kvset *kvset,
+    u32           index,
+    const void ** minkey,
+    u16 *         minklen,
+    u32 *         nkeys);
+
 /* MTF_MOCK */
 u64
 kvset_get_dgen(struct kvset *kvset);
@@ -12,6 +12,8 @@
 #define HSE_C0_CCACHE_SZ_MAX (1024 * 1024 * 1024 * 16ul)
 #define HSE_C0_CCACHE_TRIMSZ (HSE_C0_CHEAP_SZ_MIN * 4)
 
+#define HSE_CN_VCACHE_SZ_DFLT (1024 * 1024 * 256ul)
+
 #define HSE_C0_BNODE_SLAB_SZ (PAGE_SIZE * 4)
 
 #define HSE_C0_INGEST_WIDTH_MIN (8)
@@ -24,6 +26,9 @@
 #define HSE_C0_INGEST_THREADS_DFLT (3)
 #define HSE_C0_INGEST_THREADS_MAX (8)
 
+#define HSE_C0_INGEST_KVS_THREADS_DFLT (4)
+#define HSE_C0_INGEST_KVS_THREADS_MAX (16)
+
 #define HSE_C0_MAINT_THREADS_DFLT (5)
 #define HSE_C0_MAINT_THREADS_MAX (32)
 
@@ -30,6 +30,15 @@ enum hse_mclass_policy_media {
     HSE_MPOLICY_MEDIA_INVALID = HSE_MPOLICY_MEDIA_CNT,
 };
 
+/* Read heat of the data being written, as judged by the compaction
+ * scheduler (see mclass_policy_get_type_temp()).
+ */
+enum hse_mclass_policy_temp {
+    HSE_MPOLICY_TEMP_NONE,
+    HSE_MPOLICY_TEMP_HOT,
+    HSE_MPOLICY_TEMP_COLD,
+};
+
 /* Max mclass policy name length */
 #define HSE_MPOLICY_NAME_LEN_MAX 32
 
@@ -78,6 +87,36 @@ mclass_policy_init_from_string(struct mclass_policy *policy, const char *key, co
 enum mp_media_classp
 mclass_policy_get_type(struct mclass_policy *policy, u8 agegroup, u8 datatype, u8 iteration);
 
+/**
+ * mclass_policy_temp_capable() - can data placement follow read heat
+ * @datatype: data type (see hse_mclass_policy_dtype)
+ *
+ * True if the policy places @datatype on both media classes for some
+ * age group.
+ */
+bool
+mclass_policy_temp_capable(struct mclass_policy *policy, u8 datatype);
+
+/**
+ * mclass_policy_get_type_temp() - get the media type to use for the
+ *                                 <agegroup,datatype,temp,trial#>
+ * @agegroup: age group (see hse_mclass_policy_age)
+ * @datatype: data type (see hse_mclass_policy_dtype)
+ * @temp:     read heat (see hse_mclass_policy_temp)
+ * @iteration: number of tries. Retries happen on alloc failures.
+ *
+ * Hot data prefers staging and cold data prefers capacity, but only if
+ * mclass_policy_temp_capable().  Otherwise, and for HSE_MPOLICY_TEMP_NONE,
+ * this is equivalent to mclass_policy_get_type().
+ */
+enum mp_media_classp
+mclass_policy_get_type_temp(
+    struct mclass_policy *policy,
+    u8                    agegroup,
+    u8                    datatype,
+    u8                    temp,
+    u8                    iteration);
+
 /*
  * The following are used by the YAML parser to validate the media
  * class policy fields and encode a policy as a value.
@@ -17,18 +17,24 @@
  *   ------  --------    --- --- ---  -----
  *   vtype   u8           1   1   1
  *   seqno   hg64         2   2   8   sequence number
+ *   expiry  u32          4   4   4   present only if vtype has
+ *                                    KMD_VTYPE_EXPIRY set
  *   vboff   u32          4   4   4   not present for tombs
  *   vbidx   hg16_32k     1   1   2   not present for tombs
  *   vlen    hg32_1024m   1   1   4   not present for tombs
  *   clen    hg32_1024m   1   1   4   not present for tombs and
  *                                    non-compressed values
+ *   codec   u8           1   1   1   present only for vtype_ccval
  *
  * Per-entry overhead:
  *
  *     Min  Typical  Max
  *      3      3      9     A key with 1 tombstone entry
  *      9      9     19     A key with a non-zero length value
- *     10     10     23     A compressed key
+ *     10     10     23     A compressed key (LZ4)
+ *     11     11     24     A compressed key (other codecs)
+ *
+ * Values put with a TTL add 4 bytes for the expiry time.
  *
  * KMD List:
  *
@@ -47,8 +53,8 @@
  *    kmd_set_count(mem, &off, count);
  *    kmd_add_tomb(mem, &off, seq);
  *    kmd_add_ptomb(mem, &off, seq);
- *    kmd_add_ival(mem, &off, seq, vbase, vlen);
- *    kmd_add_val(mem, &off, seq, vbidx, vboff, vlen);
+ *    kmd_add_ival(mem, &off, seq, 0, vbase, vlen);
+ *    kmd_add_val(mem, &off, seq, 0, vbidx, vboff, vlen);
  *    assert(off <= memsize);
  *
  * Unpack example:
@@ -64,6 +70,10 @@
  *    }
  *
  * Notes:
+ *   - Values put with a TTL set KMD_VTYPE_EXPIRY in the vtype byte and
+ *     store their absolute expiry time (seconds since the epoch) after
+ *     the seqno.  Entries without a TTL are encoded exactly as before,
+ *     so existing kblocks remain readable and need no conversion.
  *   - Vblock offfsets are not encoded because the vast majority of offsets in
  *     a large vblock will exceed 16MB and thus require 4-bytes to encode
  *     anyhow.
@@ -71,7 +81,7 @@
 
 #define KMD_MAX_COUNT HG32_1024M_MAX
 
-#define KMD_MAX_ENCODED_ENTRY_LEN 23
+#define KMD_MAX_ENCODED_ENTRY_LEN 28
 #define KMD_MAX_ENCODED_COUNT_LEN 4
 
 enum kmd_vtype {
@@ -80,9 +90,13 @@ enum kmd_vtype {
     vtype_tomb = 2,  /* tombstone               */
     vtype_ptomb = 3, /* prefix tombstone        */
     vtype_ival = 4,  /* immediate (short) value */
-    vtype_cval = 5   /* LZ4 compressed value */
+    vtype_cval = 5,  /* LZ4 compressed value    */
+    vtype_ccval = 6  /* compressed value w/codec id */
 };
 
+/* Flag in the vtype byte, indicates an expiry time follows the seqno */
+#define KMD_VTYPE_EXPIRY 0x80
+
 static inline uint
 kmd_storage_max(uint count)
 {
@@ -96,6 +110,18 @@ kmd_set_count(void *kmd, size_t *off, uint count)
     encode_hg32_1024m(kmd, off, count);
 }
 
+static inline void
+kmd_add_type_seq(void *kmd, size_t *off, enum kmd_vtype vtype, u64 seq, u32 expiry)
+{
+    ((u8 *)kmd)[*off] = expiry ? (vtype | KMD_VTYPE_EXPIRY) : vtype;
+    *off += 1;
+    encode_hg64(kmd, off, seq);
+    if (expiry) {
+        *(u32 *)(kmd + *off) = cpu_to_be32(expiry);
+        *off += 4;
+    }
+}
+
 static inline void
 kmd_add_tomb(void *kmd, size_t *off, u64 seq)
 {
@@ -113,19 +139,15 @@ kmd_add_ptomb(void *kmd, size_t *off, u64 seq)
 }
 
 static inline void
-kmd_add_zval(void *kmd, size_t *off, u64 seq)
+kmd_add_zval(void *kmd, size_t *off, u64 seq, u32 expiry)
 {
-    ((u8 *)kmd)[*off] = vtype_zval;
-    *off += 1;
-    encode_hg64(kmd, off, seq);
+    kmd_add_type_seq(kmd, off, vtype_zval, seq, expiry);
 }
 
 static inline void
-kmd_add_ival(void *kmd, size_t *off, u64 seq, const void *vdata, u8 vlen)
+kmd_add_ival(void *kmd, size_t *off, u64 seq, u32 expiry, const void *vdata, u8 vlen)
 {
-    ((u8 *)kmd)[*off] = vtype_ival;
-    *off += 1;
-    encode_hg64(kmd, off, seq);
+    kmd_add_type_seq(kmd, off, vtype_ival, seq, expiry);
     ((u8 *)kmd)[*off] = vlen;
     *off += 1;
     memcpy(((u8 *)kmd) + *off, vdata, vlen);
@@ -133,28 +155,43 @@ kmd_add_ival(void *kmd, size_t *off, u64 seq, const void *vdata, u8 vlen)
 }
 
 static inline void
-kmd_add_val(void *kmd, size_t *off, u64 seq, uint vbidx, uint vboff, uint vlen)
+kmd_add_val(void *kmd, size_t *off, u64 seq, u32 expiry, uint vbidx, uint vboff, uint vlen)
 {
-    ((u8 *)kmd)[*off] = vtype_val;
-    *off += 1;
-    encode_hg64(kmd, off, seq);
+    kmd_add_type_seq(kmd, off, vtype_val, seq, expiry);
     encode_hg16_32k(kmd, off, vbidx);
     *(u32 *)(kmd + *off) = cpu_to_be32(vboff);
     *off += 4;
     encode_hg32_1024m(kmd, off, vlen);
 }
 
+/* LZ4 compressed values are stored as vtype_cval (i.e., without a codec id)
+ * such that their KMD encoding is unchanged from WBT v6.  Note that the
+ * kblock as a whole is still unreadable by v6 readers, which reject the
+ * newer WBT version in its header (see omf.h).
+ */
 static inline void
-kmd_add_cval(void *kmd, size_t *off, u64 seq, uint vbidx, uint vboff, uint vlen, uint complen)
+kmd_add_cval(
+    void *  kmd,
+    size_t *off,
+    u64     seq,
+    u32     expiry,
+    uint    vbidx,
+    uint    vboff,
+    uint    vlen,
+    uint    complen,
+    uint    codec)
 {
-    ((u8 *)kmd)[*off] = vtype_cval;
-    *off += 1;
-    encode_hg64(kmd, off, seq);
+    kmd_add_type_seq(kmd, off, codec ? vtype_ccval : vtype_cval, seq, expiry);
     encode_hg16_32k(kmd, off, vbidx);
     *(u32 *)(kmd + *off) = cpu_to_be32(vboff);
     *off += 4;
     encode_hg32_1024m(kmd, off, vlen);
     encode_hg32_1024m(kmd, off, complen);
+    if (codec) {
+        assert(codec <= U8_MAX);
+        ((u8 *)kmd)[*off] = codec;
+        *off += 1;
+    }
 }
 
 static inline uint
@@ -164,11 +201,27 @@ kmd_count(const void *kmd, size_t *off)
 }
 
 static inline void
-kmd_type_seq(const void *kmd, size_t *off, enum kmd_vtype *vtype, u64 *seq)
+kmd_type_seq_exp(const void *kmd, size_t *off, enum kmd_vtype *vtype, u64 *seq, u32 *expiry)
 {
-    *vtype = ((const u8 *)kmd)[*off];
+    u8 vt = ((const u8 *)kmd)[*off];
+
     *off += 1;
+    *vtype = vt & ~KMD_VTYPE_EXPIRY;
     *seq = decode_hg64(kmd, off);
+    *expiry = 0;
+
+    if (vt & KMD_VTYPE_EXPIRY) {
+        *expiry = be32_to_cpu(*(const u32 *)(kmd + *off));
+        *off += 4;
+    }
+}
+
+static inline void
+kmd_type_seq(const void *kmd, size_t *off, enum kmd_vtype *vtype, u64 *seq)
+{
+    u32 expiry;
+
+    kmd_type_seq_exp(kmd, off, vtype, seq, &expiry);
 }
 
 static inline void
@@ -190,6 +243,21 @@ kmd_cval(const void *kmd, size_t *off, uint *vbidx, uint *vboff, uint *vlen, uin
     *complen = decode_hg32_1024m(kmd, off);
 }
 
+static inline void
+kmd_ccval(
+    const void *kmd,
+    size_t *    off,
+    uint *      vbidx,
+    uint *      vboff,
+    uint *      vlen,
+    uint *      complen,
+    uint *      codec)
+{
+    kmd_cval(kmd, off, vbidx, vboff, vlen, complen);
+    *codec = ((const u8 *)kmd)[*off];
+    *off += 1;
+}
+
 static inline void
 kmd_ival(const void *kmd, size_t *off, const void **vbase, uint *vlen)
 {
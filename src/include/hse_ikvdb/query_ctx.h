@@ -14,6 +14,8 @@
 
 extern pthread_key_t tomb_thread_key;
 
+struct rtomb;
+
 enum query_type {
     QUERY_GET = 0,
     QUERY_PROBE_PFX,
@@ -40,6 +42,8 @@ struct tomb_elem {
  * @pos:       current position in the memory region backing tomb elems
  * @ntombs:    number of tombstones encountered in current query
  * @seen:      number of unique keys seen
+ * @rtombs:    range tombstones that overlap the probed prefix, collected
+ *             from each layer (c0 kvms, cN kvset) before its keys are probed
  */
 struct query_ctx {
     enum query_type qtype;
@@ -48,6 +52,7 @@ struct query_ctx {
     int            pos;
     uint           ntombs;
     int            seen;
+    struct rtomb * rtombs;
     struct rb_root tomb_tree[TT_WIDTH];
 };
 
@@ -57,6 +62,32 @@ qctx_tomb_insert(struct query_ctx *qctx, const void *sfx, size_t sfx_len);
 bool
 qctx_tomb_seen(struct query_ctx *qctx, const void *sfx, size_t sfx_len);
 
+/**
+ * qctx_rtombs_add() - remember the rtombs in a list that overlap a prefix
+ * @qctx:    query context
+ * @head:    list of rtombs (c0 or cN)
+ * @skidx:   kvs index, or -1 to match rtombs from any kvs
+ * @pfx:     probed prefix
+ * @pfx_len: length of @pfx
+ * @view:    ignore rtombs with seqno greater than view
+ */
+merr_t
+qctx_rtombs_add(
+    struct query_ctx *  qctx,
+    const struct rtomb *head,
+    int                 skidx,
+    const void *        pfx,
+    size_t              pfx_len,
+    u64                 view);
+
+/**
+ * qctx_rtomb_seq() - seqno of the newest remembered rtomb covering a key
+ *
+ * Return: the rtomb's seqno, or zero if no remembered rtomb covers the key.
+ */
+u64
+qctx_rtomb_seq(struct query_ctx *qctx, const void *key, size_t klen);
+
 void
 qctx_te_mem_reset(void);
 
@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_CORE_RTOMB_H
+#define HSE_CORE_RTOMB_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/keycmp.h>
+#include <hse_util/minmax.h>
+
+/*
+ * A range tombstone (rtomb) hides all keys k such that start <= k < end
+ * whose seqno is less than that of the rtomb.  Range tombstones are
+ * expected to be few in number, hence they are kept in simple singly
+ * linked lists (newest first in c0, in key order in cN) which readers
+ * search linearly.
+ *
+ * In c0 the list hangs off the ptomb c0kvset of each kvms, where it is
+ * appended to under the c0kvset lock and read locklessly (entries are
+ * immutable once published).  Each rtomb is also linked onto the c0kvset's
+ * current non-tx mutation list so that c1 logs it along with the keys.
+ * In cN each kvset loads the rtombs stored in its last kblock into a
+ * private list when the kvset is created.
+ */
+
+/**
+ * struct rtomb - range tombstone
+ * @rt_next:  next rtomb in list
+ * @rt_mnext: next rtomb in the c0 mutation list (not used in cN)
+ * @rt_seq:   ordinal seqno of the range delete
+ * @rt_skidx: index of the kvs in c0 (not used in cN)
+ * @rt_slen:  length of the start key
+ * @rt_elen:  length of the end key
+ * @rt_data:  start key followed immediately by the end key
+ */
+struct rtomb {
+    struct rtomb *rt_next;
+    struct rtomb *rt_mnext;
+    u64           rt_seq;
+    u16           rt_skidx;
+    u16           rt_slen;
+    u16           rt_elen;
+    u8            rt_data[];
+};
+
+static inline size_t
+rtomb_size(u32 slen, u32 elen)
+{
+    return sizeof(struct rtomb) + slen + elen;
+}
+
+static inline const void *
+rtomb_start(const struct rtomb *rt)
+{
+    return rt->rt_data;
+}
+
+static inline const void *
+rtomb_end(const struct rtomb *rt)
+{
+    return rt->rt_data + rt->rt_slen;
+}
+
+/**
+ * rtomb_covers() - true if key lies within [start, end) of the rtomb
+ */
+static inline bool
+rtomb_covers(const struct rtomb *rt, const void *key, u32 klen)
+{
+    return keycmp(rtomb_start(rt), rt->rt_slen, key, klen) <= 0 &&
+           keycmp(key, klen, rtomb_end(rt), rt->rt_elen) < 0;
+}
+
+/**
+ * rtomb_overlaps_pfx() - true if the rtomb may hide a key with the given prefix
+ */
+static inline bool
+rtomb_overlaps_pfx(const struct rtomb *rt, const void *pfx, u32 pfx_len)
+{
+    u32 len = min_t(u32, rt->rt_slen, pfx_len);
+
+    return memcmp(rtomb_start(rt), pfx, len) <= 0 &&
+           keycmp(rtomb_end(rt), rt->rt_elen, pfx, pfx_len) > 0;
+}
+
+/**
+ * rtomb_list_seq() - find the newest rtomb in a list that covers a key
+ * @head:  list of rtombs
+ * @skidx: kvs index, or -1 to match rtombs from any kvs
+ * @key:   key
+ * @klen:  key length
+ * @view:  ignore rtombs with seqno greater than view
+ *
+ * Return: the seqno of the newest visible rtomb which covers the key,
+ * or zero if there is none.
+ */
+static inline u64
+rtomb_list_seq(const struct rtomb *head, int skidx, const void *key, u32 klen, u64 view)
+{
+    const struct rtomb *rt;
+    u64                 seq = 0;
+
+    for (rt = head; rt; rt = rt->rt_next) {
+        if (rt->rt_seq > view || rt->rt_seq <= seq)
+            continue;
+
+        if (skidx >= 0 && rt->rt_skidx != skidx)
+            continue;
+
+        if (rtomb_covers(rt, key, klen))
+            seq = rt->rt_seq;
+    }
+
+    return seq;
+}
+
+#endif
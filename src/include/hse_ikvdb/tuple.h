@@ -10,6 +10,7 @@
 #include <hse_util/hse_err.h>
 #include <hse_util/key_util.h>
 #include <hse_util/seqno.h>
+#include <hse_util/time.h>
 
 #include <hse_ikvdb/key_hash.h>
 #include <hse_ikvdb/omf_kmd.h>
@@ -39,8 +40,9 @@ struct kvs_ktuple {
 
 /**
  * struct kvs_vtuple - a container for carrying a value
- * @vt_data: ptr to the value in-core memory or a special tomb value
- * @vt_xlen: opaque encoded length
+ * @vt_data:   ptr to the value in-core memory or a special tomb value
+ * @vt_xlen:   opaque encoded length
+ * @vt_expiry: expiry time (see kvs_expired()), zero if none
  *
  * Always use kvs_vtuple_vlen() to learn the in-core length of a value.
  * If it returns zero then @kt_data likely is not a valid pointer but
@@ -49,12 +51,16 @@ struct kvs_ktuple {
 struct kvs_vtuple {
     void *vt_data;
     u64   vt_xlen;
+    u32   vt_expiry;
 };
 
+/* @b_expiry is set by gets that find a value to the value's expiry time.
+ */
 struct kvs_buf {
     void *b_buf;
     u32   b_buf_sz;
     u32   b_len;
+    u32   b_expiry;
 };
 
 struct kvs_kvtuple {
@@ -67,6 +73,7 @@ struct kvs_vtuple_ref {
     union {
         struct {
             u16 vr_index;
+            u8  vr_codec;
             u32 vr_off;
             u32 vr_len;
             u32 vr_complen;
@@ -77,8 +84,23 @@ struct kvs_vtuple_ref {
         } vi;
     };
     u64 vr_seq;
+    u32 vr_expiry;
 };
 
+/**
+ * kvs_expired() - check whether a value's expiry time has passed
+ * @expiry: expiry time in seconds since the epoch, zero if none
+ *
+ * Values put with a TTL carry an absolute expiry time.  Once it has
+ * passed the value reads as a tombstone: it hides older values of
+ * the key and is itself reclaimed by compaction.
+ */
+static inline bool
+kvs_expired(u32 expiry)
+{
+    return expiry && expiry <= (u32)(ktime_get_real() / USEC_PER_SEC);
+}
+
 static inline void
 kvs_ktuple_init(struct kvs_ktuple *kt, const void *key, s32 key_len)
 {
@@ -110,27 +132,31 @@ kvs_vtuple_init(struct kvs_vtuple *vt, void *val, u64 xlen)
 {
     vt->vt_data = val;
     vt->vt_xlen = xlen;
+    vt->vt_expiry = 0;
 }
 
 /**
  * kvs_vtuple_cinit() - initialize a compressed value tuple
  * @vt:   the vtuple to initialize
  * @val:  pointer to compressed in-core value
- * @vlen: the uncompressed value length
- * @clen: the compressed value length
+ * @vlen:  the uncompressed value length
+ * @clen:  the compressed value length
+ * @codec: the compression codec id (see enum compress_codec)
  *
  * A compressed value length should always be greater than zero
  * and less than the uncompressed value length.  The val pointer
  * should always be a valid memory pointer, not a tomb encoding.
  */
 static inline void
-kvs_vtuple_cinit(struct kvs_vtuple *vt, void *val, uint vlen, uint clen)
+kvs_vtuple_cinit(struct kvs_vtuple *vt, void *val, uint vlen, uint clen, uint codec)
 {
     assert(!(HSE_CORE_IS_TOMB(val) && HSE_CORE_IS_PTOMB(val)));
-    assert(clen > 0 && clen < vlen);
+    assert(clen > 0 && clen < vlen && clen <= 0xffffff);
+    assert(codec <= 0xff);
 
     vt->vt_data = val;
-    vt->vt_xlen = ((u64)clen << 32) | vlen;
+    vt->vt_xlen = ((u64)codec << 56) | ((u64)clen << 32) | vlen;
+    vt->vt_expiry = 0;
 }
 
 /**
@@ -143,7 +169,7 @@ kvs_vtuple_cinit(struct kvs_vtuple *vt, void *val, uint vlen, uint clen)
 static __always_inline uint
 kvs_vtuple_vlen(const struct kvs_vtuple *vt)
 {
-    uint clen = vt->vt_xlen >> 32;
+    uint clen = (vt->vt_xlen >> 32) & 0xfffffful;
     uint vlen = vt->vt_xlen & 0xfffffffful;
 
     return clen ?: vlen;
@@ -152,7 +178,13 @@ kvs_vtuple_vlen(const struct kvs_vtuple *vt)
 static __always_inline uint
 kvs_vtuple_clen(const struct kvs_vtuple *vt)
 {
-    return vt->vt_xlen >> 32;
+    return (vt->vt_xlen >> 32) & 0xfffffful;
+}
+
+static __always_inline uint
+kvs_vtuple_codec(const struct kvs_vtuple *vt)
+{
+    return vt->vt_xlen >> 56;
 }
 
 static inline void
@@ -161,5 +193,6 @@ kvs_buf_init(struct kvs_buf *vbuf, void *buf, u32 buf_size)
     vbuf->b_buf = buf;
     vbuf->b_buf_sz = buf_size;
     vbuf->b_len = 0;
+    vbuf->b_expiry = 0;
 }
 #endif
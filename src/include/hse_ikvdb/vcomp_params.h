@@ -10,8 +10,9 @@
 
 #define VCOMP_PARAM_NONE    "none"
 #define VCOMP_PARAM_LZ4     "lz4"
+#define VCOMP_PARAM_ZSTD    "zstd"
 
-#define VCOMP_PARAM_SUPPORTED  VCOMP_PARAM_NONE " " VCOMP_PARAM_LZ4
+#define VCOMP_PARAM_SUPPORTED  VCOMP_PARAM_NONE " " VCOMP_PARAM_LZ4 " " VCOMP_PARAM_ZSTD
 #define VCOMP_PARAM_STR_SZ 8
 
 struct kvs_rparams;
@@ -20,7 +21,12 @@ struct compress_ops;
 bool
 vcomp_param_valid(const struct kvs_rparams *rp);
 
-struct compress_ops *
+/* Returns false if vcomplvl exceeds the maximum level of the selected codec.
+ */
+bool
+vcomp_param_level_valid(const struct kvs_rparams *rp);
+
+const struct compress_ops *
 vcomp_compress_ops(const struct kvs_rparams *rp);
 
 #endif
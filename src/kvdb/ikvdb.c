@@ -22,6 +22,7 @@
 #include <hse_ikvdb/cn.h>
 #include <hse_ikvdb/cn_kvdb.h>
 #include <hse_ikvdb/cn_perfc.h>
+#include <hse_ikvdb/cn_cursor.h>
 #include <hse_ikvdb/ctxn_perfc.h>
 #include <hse_ikvdb/kvdb_perfc.h>
 #include <hse_ikvdb/cndb.h>
@@ -54,9 +55,10 @@
 #include <hse_util/log2.h>
 #include <hse_util/atomic.h>
 #include <hse_util/vlb.h>
-#include <hse_util/compression_lz4.h>
+#include <hse_util/compression.h>
 #include <hse_util/token_bucket.h>
 #include <hse_util/xrand.h>
+#include <hse_util/keycmp.h>
 
 #include <3rdparty/xxhash.h>
 #include <3rdparty/cJSON.h>
@@ -593,6 +595,37 @@ ikvdb_c1_replay_del(
     return ikvs_prefix_del(kk->kk_ikvs, os, kt, HSE_ORDNL_TO_SQNREF(seqno));
 }
 
+merr_t
+ikvdb_c1_replay_range_del(
+    struct ikvdb *          ikdb,
+    struct ikvdb_c1_replay *replay,
+    u64                     seqno,
+    u64                     cnid,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     start,
+    struct kvs_ktuple *     end)
+{
+    struct hse_kvs * kvs;
+    struct kvdb_kvs *kk;
+
+    if (!ikdb)
+        return 0;
+
+    kvs = ikvdb_c1_replay_get_kvs(replay, cnid);
+    if (!kvs) {
+        hse_log(
+            HSE_WARNING "%s: dropping range del %lu for invalid kvs cnid %lu",
+            __func__,
+            (ulong)seqno,
+            (ulong)cnid);
+        return 0;
+    }
+
+    kk = (struct kvdb_kvs *)kvs;
+
+    return ikvs_range_del(kk->kk_ikvs, os, start, end, HSE_ORDNL_TO_SQNREF(seqno));
+}
+
 void
 ikvdb_perfc_alloc(struct ikvdb_impl *self)
 {
@@ -1275,6 +1308,9 @@ ikvdb_low_mem_adjust(struct ikvdb_impl *self)
     if (rp->c0_ingest_threads == dflt.c0_ingest_threads)
         rp->c0_ingest_threads = min_t(u64, scale, HSE_C0_INGEST_THREADS_DFLT);
 
+    if (rp->c0_ingest_kvs_threads == dflt.c0_ingest_kvs_threads)
+        rp->c0_ingest_kvs_threads = min_t(u64, scale, HSE_C0_INGEST_KVS_THREADS_DFLT);
+
     if (rp->c0_mutex_pool_sz == dflt.c0_mutex_pool_sz)
         rp->c0_mutex_pool_sz = 5;
 
@@ -1290,6 +1326,9 @@ ikvdb_low_mem_adjust(struct ikvdb_impl *self)
     if (rp->txn_ingest_delay == dflt.txn_ingest_delay)
         rp->txn_ingest_delay = 0;
 
+    if (rp->cn_vcache_sz == dflt.cn_vcache_sz)
+        rp->cn_vcache_sz = min_t(u64, 1024 * 1024 * 16UL * scale, HSE_CN_VCACHE_SZ_DFLT);
+
     c0kvs_reinit(rp->c0_heap_cache_sz_max);
 }
 
@@ -1425,7 +1464,7 @@ ikvdb_open(
         goto err1;
     }
 
-    err = cn_kvdb_create(&self->ikdb_cn_kvdb);
+    err = cn_kvdb_create(self->ikdb_mpname, &self->ikdb_rp, &self->ikdb_cn_kvdb);
     if (err) {
         hse_elog(HSE_ERR "cannot open %s: @@e", err, mp_name);
         goto err1;
@@ -1539,6 +1578,18 @@ ikvdb_get_c1(struct ikvdb *handle, struct c1 **out)
     *out = self->ikdb_c1;
 }
 
+struct kvdb_ctxn_set *
+ikvdb_get_ctxn_set(struct ikvdb *handle)
+{
+    return handle ? ikvdb_h2r(handle)->ikdb_ctxn_set : 0;
+}
+
+atomic64_t *
+ikvdb_get_seqno_addr(struct ikvdb *handle)
+{
+    return handle ? &ikvdb_h2r(handle)->ikdb_seqno : 0;
+}
+
 struct csched *
 ikvdb_get_csched(struct ikvdb *handle)
 {
@@ -1888,7 +1939,8 @@ ikvdb_kvs_open(
     if (cops) {
         assert(cops->cop_compress && cops->cop_estimate);
 
-        kvs->kk_vcompress = cops->cop_compress;
+        kvs->kk_vcomp = cops;
+        kvs->kk_vcomplvl = rp.vcomplvl;
         kvs->kk_vcompmin = max_t(uint, CN_SMALL_VALUE_THRESHOLD, rp.vcompmin);
 
         kvs->kk_vcompbnd = cops->cop_estimate(NULL, tls_vbufsz);
@@ -2120,6 +2172,23 @@ ikvdb_throttle2(struct ikvdb_impl *self, u64 bytes)
     }
 }
 
+/* Make a put or delete that specified HSE_KVDB_KOP_FLAG_SYNC durable.
+ * Transactional mutations are made durable by the commit instead.
+ */
+static merr_t
+ikvdb_kop_sync(struct ikvdb_impl *self, struct hse_kvdb_opspec *os)
+{
+    if (kvdb_kop_is_txn(os)) {
+        kvdb_ctxn_set_sync(kvdb_ctxn_h2h(os->kop_txn));
+        return 0;
+    }
+
+    if (!self->ikdb_c1)
+        return ikvdb_sync_int(self);
+
+    return c0skm_sync_op(self->ikdb_c0sk);
+}
+
 merr_t
 ikvdb_kvs_put(
     struct hse_kvs *         handle,
@@ -2167,10 +2236,12 @@ ikvdb_kvs_put(
         }
 
         if (vbuf) {
-            err = kk->kk_vcompress(vt->vt_data, vlen, vbuf, vbufsz, &clen);
+            err = kk->kk_vcomp->cop_compress(
+                vt->vt_data, vlen, vbuf, vbufsz, &clen, kk->kk_vcomplvl);
 
             if (!err && clen < vlen) {
-                kvs_vtuple_cinit(&vtbuf, vbuf, vlen, clen);
+                kvs_vtuple_cinit(&vtbuf, vbuf, vlen, clen, kk->kk_vcomp->cop_codec);
+                vtbuf.vt_expiry = vt->vt_expiry;
                 vt = &vtbuf;
                 vlen = clen;
             }
@@ -2189,6 +2260,12 @@ ikvdb_kvs_put(
         return err;
     }
 
+    if (kvdb_kop_is_sync(os)) {
+        err = ikvdb_kop_sync(parent, os);
+        if (ev(err))
+            return err;
+    }
+
     if (start > 0) {
         if (!(parent->ikdb_tb_dbg & THROTTLE_DEBUG_TB_OLD))
             ikvdb_throttle2(parent, kt->kt_len + (clen ? clen : vlen));
@@ -2264,6 +2341,36 @@ ikvdb_kvs_get(
     return ikvs_get(kk->kk_ikvs, os, kt, view_seqno, res, vbuf);
 }
 
+merr_t
+ikvdb_kvs_get_batch(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    u32                     cnt,
+    struct kvs_ktuple *     ktv,
+    enum key_lookup_res *   resv,
+    struct kvs_buf *        vbufv)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *p;
+    u64                view_seqno;
+
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    p = kk->kk_parent;
+
+    /* Establish one view for the entire batch, see ikvdb_kvs_get().
+     */
+    if (kvdb_kop_is_txn(os)) {
+        view_seqno = 0;
+    } else {
+        view_seqno = atomic64_read(&p->ikdb_seqno);
+        kvdb_ctxn_set_wait_commits(p->ikdb_ctxn_set);
+    }
+
+    return ikvs_get_batch(kk->kk_ikvs, os, cnt, ktv, view_seqno, resv, vbufv);
+}
+
 merr_t
 ikvdb_kvs_del(struct hse_kvs *handle, struct hse_kvdb_opspec *os, struct kvs_ktuple *kt)
 {
@@ -2291,6 +2398,12 @@ ikvdb_kvs_del(struct hse_kvs *handle, struct hse_kvdb_opspec *os, struct kvs_ktu
     if (ev(err))
         return err;
 
+    if (kvdb_kop_is_sync(os)) {
+        err = ikvdb_kop_sync(parent, os);
+        if (ev(err))
+            return err;
+    }
+
     return 0;
 }
 
@@ -2334,6 +2447,54 @@ ikvdb_kvs_prefix_delete(
     if (ev(err))
         return err;
 
+    if (kvdb_kop_is_sync(os)) {
+        err = ikvdb_kop_sync(parent, os);
+        if (ev(err))
+            return err;
+    }
+
+    return 0;
+}
+
+merr_t
+ikvdb_kvs_range_delete(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     start,
+    struct kvs_ktuple *     end)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *parent;
+    merr_t             err;
+
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    parent = kk->kk_parent;
+    if (ev(parent->ikdb_rdonly))
+        return merr(EROFS);
+
+    if (ev(!start->kt_data || !end->kt_data))
+        return merr(EINVAL);
+
+    /* An empty range deletes nothing. */
+    if (keycmp(start->kt_data, start->kt_len, end->kt_data, end->kt_len) >= 0)
+        return 0;
+
+    /* As with a prefix delete, the range tombstone is given a seqno
+     * higher than that of all current keys so that it hides only
+     * the keys which were put before it.
+     */
+    err = ikvs_range_del(kk->kk_ikvs, os, start, end, HSE_SQNREF_SINGLE);
+    if (ev(err))
+        return err;
+
+    if (kvdb_kop_is_sync(os)) {
+        err = ikvdb_kop_sync(parent, os);
+        if (ev(err))
+            return err;
+    }
+
     return 0;
 }
 
@@ -2502,6 +2663,56 @@ cursor_unbind_txn(struct hse_kvs_cursor *cur)
     return 0;
 }
 
+/*
+ * Allocate a cursor and initialize its handle.  The cursor is neither
+ * registered nor initialized, see ikvdb_kvs_cursor_create().
+ */
+static merr_t
+ikvdb_kvs_cursor_alloc(
+    struct kvdb_kvs *       kk,
+    struct hse_kvdb_opspec *os,
+    const void *            prefix,
+    size_t                  pfx_len,
+    bool                    reverse,
+    u64                     vseq,
+    struct hse_kvs_cursor **cursorp)
+{
+    struct ikvdb_impl *    ikvdb = kk->kk_parent;
+    struct hse_kvs_cursor *cur;
+    unsigned int           cursor_cnt;
+
+    cursor_cnt = atomic_read(&ikvdb->ikdb_curcnt);
+    if (ev(cursor_cnt >= ikvdb->ikdb_curcnt_max)) {
+        hse_log(
+            HSE_WARNING "Number of open cursors (%u) has exceeded "
+                        "the max allowed cursors (%u)",
+            cursor_cnt,
+            ikvdb->ikdb_curcnt_max);
+        return merr(ECANCELED);
+    }
+
+    cur = ikvs_cursor_alloc(kk->kk_ikvs, prefix, pfx_len, reverse);
+    if (ev(!cur))
+        return merr(ENOMEM);
+
+    cur->kc_pkvsl_pc = ikvs_perfc_pkvsl(kk->kk_ikvs);
+
+    /* if we have a transaction at all, use its view seqno... */
+    cur->kc_seq = vseq;
+    cur->kc_flags = os ? os->kop_flags : 0;
+    cur->kc_cursor_cnt = &ikvdb->ikdb_curcnt;
+    atomic_inc(cur->kc_cursor_cnt);
+    perfc_inc(&kvdb_metrics_pc, PERFC_BA_KVDBMETRICS_CURCNT);
+
+    cur->kc_kvs = kk;
+    cur->kc_gen = 0;
+    cur->kc_bind = 0;
+
+    *cursorp = cur;
+
+    return 0;
+}
+
 merr_t
 ikvdb_kvs_cursor_create(
     struct hse_kvs *        handle,
@@ -2517,7 +2728,6 @@ ikvdb_kvs_cursor_create(
     struct hse_kvs_cursor *cur = 0;
     int                    reverse;
     merr_t                 err;
-    unsigned int           cursor_cnt;
     u64                    vseq, tstart;
     struct perfc_set *     pkvsl_pc;
 
@@ -2527,15 +2737,6 @@ ikvdb_kvs_cursor_create(
     tstart = perfc_lat_start(pkvsl_pc);
 
     reverse = false;
-    cursor_cnt = atomic_read(&ikvdb->ikdb_curcnt);
-    if (ev(cursor_cnt >= ikvdb->ikdb_curcnt_max)) {
-        hse_log(
-            HSE_WARNING "Number of open cursors (%u) has exceeded "
-                        "the max allowed cursors (%u)",
-            cursor_cnt,
-            ikvdb->ikdb_curcnt_max);
-        return merr(ECANCELED);
-    }
 
     /*
      * There are 3 types of cursors:
@@ -2580,22 +2781,9 @@ ikvdb_kvs_cursor_create(
      *  - initialize cursor
      * The failure path must unregister the cursor from kk_cursors.
      */
-    cur = ikvs_cursor_alloc(kk->kk_ikvs, prefix, pfx_len, reverse);
-    if (ev(!cur))
-        return merr(ENOMEM);
-
-    cur->kc_pkvsl_pc = pkvsl_pc;
-
-    /* if we have a transaction at all, use its view seqno... */
-    cur->kc_seq = vseq;
-    cur->kc_flags = os ? os->kop_flags : 0;
-    cur->kc_cursor_cnt = &ikvdb->ikdb_curcnt;
-    atomic_inc(cur->kc_cursor_cnt);
-    perfc_inc(&kvdb_metrics_pc, PERFC_BA_KVDBMETRICS_CURCNT);
-
-    cur->kc_kvs = kk;
-    cur->kc_gen = 0;
-    cur->kc_bind = 0;
+    err = ikvdb_kvs_cursor_alloc(kk, os, prefix, pfx_len, reverse, vseq, &cur);
+    if (ev(err))
+        return err;
 
     /* Temporarily lock a view until this cursor gets refs on cn kvsets. */
     cursor_reserve_seqno(cur);
@@ -2628,6 +2816,152 @@ ikvdb_kvs_cursor_create(
     return err;
 }
 
+/*
+ * Store in @buf the greatest key less than @key (where 0 < @klen <=
+ * HSE_KVS_KLEN_MAX), which bounds a half-open range by an inclusive seek
+ * limit.  Given that keys are at most HSE_KVS_KLEN_MAX bytes, the
+ * predecessor of a key whose last byte is non-zero is the key with its
+ * last byte decremented, padded with 0xff to HSE_KVS_KLEN_MAX bytes.
+ */
+static size_t
+cursor_limit_pred(const void *key, size_t klen, u8 *buf)
+{
+    memcpy(buf, key, klen);
+
+    if (buf[klen - 1] == 0)
+        return klen - 1;
+
+    buf[klen - 1]--;
+    memset(buf + klen, 0xff, HSE_KVS_KLEN_MAX - klen);
+
+    return HSE_KVS_KLEN_MAX;
+}
+
+merr_t
+ikvdb_kvs_cursor_partition(
+    struct hse_kvs *        handle,
+    struct hse_kvdb_opspec *os,
+    const void *            prefix,
+    size_t                  pfx_len,
+    unsigned int            cursormax,
+    struct hse_kvs_cursor **cursorv,
+    unsigned int *          cursorcp)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *ikvdb = kk->kk_parent;
+    struct kvdb_ctxn * ctxn = 0;
+    u32                klenv[HSE_KVS_CURSOR_PARTS_MAX];
+    u8 *               keybuf, *limit;
+    uint               splitc, cursorc, i;
+    u64                vseq;
+    merr_t             err;
+
+    *cursorcp = 0;
+
+    if (ev(cursormax < 1 || cursormax > HSE_KVS_CURSOR_PARTS_MAX))
+        return merr(EINVAL);
+
+    memset(cursorv, 0, cursormax * sizeof(*cursorv));
+
+    /* Partitions are bounded by seek limits, which reverse cursors do
+     * not support, and cannot follow the lifecycle of a transaction.
+     */
+    if (os) {
+        if (ev(kvdb_kop_is_reverse(os) || kvdb_kop_is_bind_txn(os)))
+            return merr(EINVAL);
+        if (os->kop_txn)
+            ctxn = kvdb_ctxn_h2h(os->kop_txn);
+    }
+
+    vseq = HSE_SQNREF_UNDEFINED;
+    if (ctxn) {
+        err = kvdb_ctxn_get_view_seqno(ctxn, &vseq);
+        if (ev(err))
+            return err;
+    }
+
+    /* Room for cursormax - 1 split keys plus one seek limit. */
+    keybuf = malloc(cursormax * HSE_KVS_KLEN_MAX);
+    if (ev(!keybuf))
+        return merr(ENOMEM);
+
+    limit = keybuf + (cursormax - 1) * HSE_KVS_KLEN_MAX;
+
+    err = cn_cursor_split(
+        kvs_cn(kk->kk_ikvs), prefix, pfx_len, cursormax - 1, keybuf, klenv, &splitc);
+    if (ev(err))
+        goto errout;
+
+    /* A split key of "\0" would leave the first range empty. */
+    if (splitc > 0 && klenv[0] == 1 && keybuf[0] == 0) {
+        --splitc;
+        memmove(keybuf, keybuf + HSE_KVS_KLEN_MAX, splitc * HSE_KVS_KLEN_MAX);
+        memmove(klenv, klenv + 1, splitc * sizeof(*klenv));
+    }
+
+    cursorc = splitc + 1;
+
+    err = ikvdb_kvs_cursor_alloc(kk, os, prefix, pfx_len, false, vseq, cursorv);
+    if (ev(err))
+        goto errout;
+
+    /* All the partitions share the view of the first cursor, which
+     * remains reserved until they all have refs on cn kvsets.
+     */
+    cursor_reserve_seqno(cursorv[0]);
+    err = ikvs_cursor_init(cursorv[0]);
+
+    for (i = 1; i < cursorc && !err; i++) {
+        vseq = cursorv[0]->kc_seq;
+
+        err = ikvdb_kvs_cursor_alloc(kk, os, prefix, pfx_len, false, vseq, cursorv + i);
+        if (!err)
+            err = ikvs_cursor_init(cursorv[i]);
+    }
+    cursor_release_seqno(cursorv[0]);
+
+    if (ev(err))
+        goto errout;
+
+    kvdb_ctxn_set_wait_commits(ikvdb->ikdb_ctxn_set);
+
+    /* Position the nth cursor at the (n-1)th split key, limited to
+     * keys less than the nth split key.
+     */
+    for (i = 0; i < cursorc; i++) {
+        const void *start = NULL;
+        size_t      startlen = 0, limlen = 0;
+
+        if (i > 0) {
+            start = keybuf + (i - 1) * HSE_KVS_KLEN_MAX;
+            startlen = klenv[i - 1];
+        }
+
+        if (i < splitc)
+            limlen = cursor_limit_pred(keybuf + i * HSE_KVS_KLEN_MAX, klenv[i], limit);
+
+        err = ikvdb_kvs_cursor_seek(
+            cursorv[i], NULL, start, startlen, limlen ? limit : NULL, limlen, NULL);
+        if (ev(err))
+            goto errout;
+    }
+
+    *cursorcp = cursorc;
+    free(keybuf);
+
+    return 0;
+
+errout:
+    for (i = 0; i < cursormax && cursorv[i]; i++) {
+        ikvdb_kvs_cursor_destroy(cursorv[i]);
+        cursorv[i] = NULL;
+    }
+
+    free(keybuf);
+
+    return err;
+}
+
 merr_t
 ikvdb_kvs_cursor_update(struct hse_kvs_cursor *cur, struct hse_kvdb_opspec *os)
 {
@@ -2861,6 +3195,53 @@ ikvdb_kvs_cursor_read(
     return 0;
 }
 
+merr_t
+ikvdb_kvs_cursor_read_batch(
+    struct hse_kvs_cursor * cur,
+    struct hse_kvdb_opspec *os,
+    uint                    flags,
+    void *                  buf,
+    size_t                  buf_sz,
+    uint *                  count,
+    size_t *                buf_used,
+    bool *                  eof)
+{
+    merr_t err;
+    u64    tstart;
+
+    tstart = perfc_lat_start(cur->kc_pkvsl_pc);
+
+    *count = 0;
+    *buf_used = 0;
+
+    if (ev(kvdb_kop_is_txn(os)))
+        return merr(EINVAL);
+
+    if (ev(cur->kc_err)) {
+        if (ev(merr_errno(cur->kc_err) != EAGAIN))
+            return cur->kc_err;
+
+        cur->kc_err = ikvs_cursor_update(cur, cur->kc_seq);
+        if (ev(cur->kc_err))
+            return cur->kc_err;
+    }
+
+    /* A bound txn is checked once per batch rather than once per pair */
+    if (cur->kc_bind) {
+        cur->kc_err = cursor_refresh(cur);
+        if (ev(cur->kc_err))
+            return cur->kc_err;
+    }
+
+    err = ikvs_cursor_read_batch(cur, flags, buf, buf_sz, count, buf_used, eof);
+    if (ev(err))
+        return err;
+
+    perfc_lat_record(cur->kc_pkvsl_pc, PERFC_LT_PKVSL_KVS_CURSOR_READ_BATCH, tstart);
+
+    return 0;
+}
+
 merr_t
 ikvdb_kvs_cursor_destroy(struct hse_kvs_cursor *cur)
 {
@@ -3045,17 +3426,27 @@ merr_t
 ikvdb_txn_commit(struct ikvdb *handle, struct hse_kvdb_txn *txn)
 {
     struct ikvdb_impl *self = ikvdb_h2r(handle);
+    struct kvdb_ctxn * ctxn = kvdb_ctxn_h2h(txn);
     merr_t             err;
     u64                lstart;
+    bool               sync;
 
     lstart = perfc_lat_startu(&self->ikdb_ctxn_op, PERFC_LT_CTXNOP_COMMIT);
     perfc_inc(&self->ikdb_ctxn_op, PERFC_RA_CTXNOP_COMMIT);
 
-    err = kvdb_ctxn_commit(kvdb_ctxn_h2h(txn));
+    sync = kvdb_ctxn_get_sync(ctxn);
+
+    err = kvdb_ctxn_commit(ctxn);
 
     perfc_dec(&self->ikdb_ctxn_op, PERFC_BA_CTXNOP_ACTIVE);
     perfc_lat_record(&self->ikdb_ctxn_op, PERFC_LT_CTXNOP_COMMIT, lstart);
 
+    /* The commit seqno is published to c0skm by kvdb_ctxn_commit(),
+     * hence a sync started after the commit includes the transaction.
+     */
+    if (!err && sync)
+        err = ikvdb_kop_sync(self, NULL);
+
     return err;
 }
 
@@ -3361,7 +3752,8 @@ ikvdb_kvs_import(struct work_struct *work)
  *            "kvcnt":        1000000000,
  *            "pfx_len":      0,
  *            "fanout":       8,
- *            "kvs_ext01":    0
+ *            "kvs_ext01":    0,
+ *            "kblk_filter":  0
  *      }]
  * }
  */
@@ -3378,6 +3770,7 @@ ikvdb_import_toc(
     cJSON *     TOC;
     cJSON *     kvsv_json;
     cJSON *     kvs_json;
+    cJSON *     item;
     int         ver;
     int         i, cnt;
     char *      name;
@@ -3538,6 +3931,16 @@ ikvdb_import_toc(
         err = hse_params_set(kvsi[i].kvsi_params, "kvs.kvs_ext01", val_buf);
         if (ev(err))
             goto errout;
+
+        /* Absent from TOCs written before kblock filter types existed.
+         */
+        item = cJSON_GetObjectItem(kvs_json, "kblk_filter");
+        if (item) {
+            snprintf(val_buf, sizeof(val_buf), "%d", item->valueint);
+            err = hse_params_set(kvsi[i].kvsi_params, "kvs.kblk_filter", val_buf);
+            if (ev(err))
+                goto errout;
+        }
     }
 
 errout:
@@ -3843,6 +4246,7 @@ ikvdb_export_toc(
         cJSON_AddNumberToObject(kvs, "pfx_pivot", kvs_cparams[i].cp_pfx_pivot);
         cJSON_AddNumberToObject(kvs, "fanout", kvs_cparams[i].cp_fanout);
         cJSON_AddNumberToObject(kvs, "kvs_ext01", kvs_cparams[i].cp_kvs_ext01);
+        cJSON_AddNumberToObject(kvs, "kblk_filter", kvs_cparams[i].cp_kblk_filter);
         cJSON_AddItemToArray(KVSs, kvs);
     }
 
@@ -4003,6 +4407,8 @@ ikvdb_export(struct ikvdb *handle, struct kvdb_cparams *kvdb_cparams, const char
         kvs_cparams[i].cp_fanout = ((struct kvdb_kvs *)kvs)->kk_cparams->cp_fanout;
         kvs_cparams[i].cp_kvs_ext01 =
             (((struct kvdb_kvs *)kvs)->kk_flags & CN_CFLAG_CAPPED) ? 1 : 0;
+        kvs_cparams[i].cp_kblk_filter =
+            (((struct kvdb_kvs *)kvs)->kk_flags & CN_CFLAG_FUSE) ? 1 : 0;
 
         err = ikvdb_kvs_cursor_create(kvs, &opspec, NULL, 0, &cur);
         if (err) {
@@ -53,6 +53,7 @@ struct kvdb_ctxn_set_impl {
 
     atomic64_t ktn_tseqno_head __aligned(SMP_CACHE_BYTES * 2);
     atomic64_t ktn_tseqno_tail __aligned(SMP_CACHE_BYTES * 2);
+    atomic64_t ktn_commit_sn __aligned(SMP_CACHE_BYTES * 2);
 
     struct mutex ktn_list_mutex __aligned(SMP_CACHE_BYTES * 2);
     struct cds_list_head ktn_alloc_list;
@@ -194,6 +195,7 @@ kvdb_ctxn_alloc(
     ctxn->ctxn_kvdb_seq_addr = kvdb_seqno_addr;
     ctxn->ctxn_tseqno_head = &kvdb_ctxn_set->ktn_tseqno_head;
     ctxn->ctxn_tseqno_tail = &kvdb_ctxn_set->ktn_tseqno_tail;
+    ctxn->ctxn_commit_sn = &kvdb_ctxn_set->ktn_commit_sn;
     ctxn->ctxn_ingest_width = HSE_C0_INGEST_WIDTH_DFLT;
     ctxn->ctxn_ingest_delay = HSE_C0_INGEST_DELAY_DFLT;
     ctxn->ctxn_heap_sz = HSE_C0_CHEAP_SZ_DFLT;
@@ -262,6 +264,14 @@ kvdb_ctxn_set_wait_commits(struct kvdb_ctxn_set *handle)
         cpu_relax();
 }
 
+u64
+kvdb_ctxn_set_commit_sn(struct kvdb_ctxn_set *handle)
+{
+    struct kvdb_ctxn_set_impl *kvdb_ctxn_set = kvdb_ctxn_set_h2r(handle);
+
+    return atomic64_read(&kvdb_ctxn_set->ktn_commit_sn);
+}
+
 void
 kvdb_ctxn_free(struct kvdb_ctxn *handle)
 {
@@ -354,6 +364,7 @@ kvdb_ctxn_begin(struct kvdb_ctxn *handle)
     kvdb_ctxn_set_wait_commits(ctxn->ctxn_kvdb_ctxn_set);
 
     ctxn->ctxn_can_insert = 0;
+    ctxn->ctxn_sync = 0;
     ctxn->ctxn_seqref = HSE_SQNREF_UNDEFINED;
 
     /* KVS Cursors need an always-consistent kvms state. */
@@ -749,6 +760,11 @@ retry:
         *priv = ref;
 
     c0skm_set_tseqno(ctxn->ctxn_c0sk, commit_sn);
+
+    /* Commits leave this section in commit_sn order, hence a reader
+     * that has waited on ongoing commits sees the latest commit_sn.
+     */
+    atomic64_set(ctxn->ctxn_commit_sn, commit_sn);
     atomic64_inc_rel(ctxn->ctxn_tseqno_tail);
 
     locks = ctxn->ctxn_locks_handle;
@@ -826,6 +842,22 @@ kvdb_ctxn_get_view_seqno(struct kvdb_ctxn *handle, u64 *view_seqno)
     return 0;
 }
 
+void
+kvdb_ctxn_set_sync(struct kvdb_ctxn *handle)
+{
+    struct kvdb_ctxn_impl *ctxn = kvdb_ctxn_h2r(handle);
+
+    ctxn->ctxn_sync = 1;
+}
+
+bool
+kvdb_ctxn_get_sync(struct kvdb_ctxn *handle)
+{
+    struct kvdb_ctxn_impl *ctxn = kvdb_ctxn_h2r(handle);
+
+    return ctxn->ctxn_sync;
+}
+
 struct c0_kvmultiset *
 kvdb_ctxn_get_kvms(struct kvdb_ctxn *handle)
 {
@@ -1157,6 +1189,7 @@ kvdb_ctxn_set_create(struct kvdb_ctxn_set **handle_out, u64 txn_timeout_ms, u64
 
     atomic64_set(&ktn->ktn_tseqno_head, 0);
     atomic64_set(&ktn->ktn_tseqno_tail, 0);
+    atomic64_set(&ktn->ktn_commit_sn, 0);
     atomic_set(&ktn->ktn_reading, 0);
     ktn->ktn_queued = false;
     ktn->ktn_txn_timeout = txn_timeout_ms;
@@ -28,6 +28,7 @@
  * @ctxn_threads:             number of threads active in the transaction
  * @ctxn_locks_cursor_sz:
  * @ctxn_can_insert:
+ * @ctxn_sync:                commit must wait for c1 durability
  * @ctxn_cursor_alloc:
  */
 struct kvdb_ctxn_impl {
@@ -35,6 +36,7 @@ struct kvdb_ctxn_impl {
     atomic_t                ctxn_lock;
     u8                      ctxn_can_insert;
     u8                      ctxn_cursors_max;
+    u8                      ctxn_sync;
     uintptr_t               ctxn_seqref;
     struct kvdb_keylock *   ctxn_kvdb_keylock;
     struct kvdb_ctxn_locks *ctxn_locks_handle;
@@ -48,6 +50,7 @@ struct kvdb_ctxn_impl {
     atomic64_t *          ctxn_kvdb_seq_addr;
     atomic64_t *          ctxn_tseqno_head;
     atomic64_t *          ctxn_tseqno_tail;
+    atomic64_t *          ctxn_commit_sn;
 
     u32 ctxn_ingest_width;
     u32 ctxn_ingest_delay;
@@ -14,20 +14,19 @@
 #include <hse_util/rcu.h>
 #include <hse_util/page.h>
 #include <hse_util/cursor_heap.h>
+#include <hse_util/log2.h>
 
 #include <hse/kvdb_perfc.h>
 
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/kvdb_ctxn.h>
 
-#include <3rdparty/rbtree.h>
-
 #define MTF_MOCK_IMPL_kvdb_keylock
 
 #include "kvdb_keylock.h"
 
 #define KVDB_DLOCK_MAX 8 /* Must be power-of-2 */
-#define KVDB_LOCKS_SZ (16 * 1024 - SMP_CACHE_BYTES)
+#define KVDB_LOCKS_ENTRYMAX 1024 /* Must be power-of-2 */
 
 struct kvdb_keylock {
 };
@@ -52,7 +51,6 @@ struct kvdb_dlock {
  * @kl_dlockv:             vector of deferred lock objects
  * @kl_num_tables:         number of keylock tables
  * @kl_num_entries:        max number of entries (across all tables)
- * @kl_entries_per_txn:    number of entries that can be locked by a txn
  * @kl_perfc_set:
  * @kl_keylock:            vector of ptrs to keylock objects
  */
@@ -61,7 +59,6 @@ struct kvdb_keylock_impl {
     struct kvdb_dlock   kl_dlockv[KVDB_DLOCK_MAX];
 
     u64              kl_num_entries;
-    u32              kl_entries_per_txn;
     u32              kl_num_tables;
     struct perfc_set kl_perfc_set;
     struct keylock * kl_keylock[];
@@ -74,19 +71,17 @@ struct kvdb_ctxn_locks {
     container_of(handle, struct kvdb_ctxn_locks_impl, ctxn_locks_handle)
 
 /**
- * struct ctxn_locks_tree_entry -
- * @lte_node:
- * @lte_hash:
+ * struct ctxn_locks_entry - a write lock held by a transaction
+ * @lte_hash:       hash of the locked key (48 bits, as in struct keylock_entry)
  * @lte_tindex:     index into kl_keylock[]
- * @lte_inherited:
- * @lte_kfree:      node not from entryv[], must be freed via free
+ * @lte_inherited:  lock was inherited from an expired transaction
+ * @lte_busy:       slot is in use (an all-zero entry is an empty slot)
  */
-struct ctxn_locks_tree_entry {
-    struct rb_node lte_node;
-    u64            lte_hash : 48;
-    u64            lte_tindex : 10;
-    u64            lte_inherited : 1;
-    u64            lte_kfree : 1;
+struct ctxn_locks_entry {
+    u64 lte_hash : 48;
+    u64 lte_tindex : 10;
+    u64 lte_inherited : 1;
+    u64 lte_busy : 1;
 };
 
 #define LTE_TINDEX_MAX (1u << 10)
@@ -97,11 +92,15 @@ struct ctxn_locks_tree_entry {
  * @ctxn_locks_link:         element to link onto the deferred_locks list
  * @ctxn_locks_magic:        used to detect use-after-free
  * @ctxn_locks_end_seqno:    end seqno of the transaction
- * @ctxn_locks_tree:         root of RB tree containing write locks
+ * @ctxn_locks_tab:          open addressing hash set of write locks
+ * @ctxn_locks_shift:        64 - log2(number of slots in ctxn_locks_tab[])
  * @ctxn_locks_cnt:          number of write locks in this container
- * @ctxn_locks_entryc:       current number of entries from entryv[] in use
- * @ctxn_locks_entrymax:     max number of entries in entryv[]
- * @ctxn_locks_entryv:       small entry cache
+ * @ctxn_locks_entryv:       initial (embedded) hash set
+ *
+ * The write locks are kept in a linear probing hash set which starts out
+ * as ctxn_locks_entryv[] and doubles (into a heap allocation) whenever it
+ * becomes more than 3/4 full, so the number of locks a transaction may
+ * acquire is bounded only by the capacity of the kvdb keylock tables.
  */
 struct kvdb_ctxn_locks_impl {
     struct kvdb_ctxn_locks ctxn_locks_handle;
@@ -109,18 +108,108 @@ struct kvdb_ctxn_locks_impl {
     volatile u64           ctxn_locks_end_seqno;
     uintptr_t              ctxn_locks_magic;
 
-    __aligned(SMP_CACHE_BYTES) struct rb_root ctxn_locks_tree;
+    __aligned(SMP_CACHE_BYTES) struct ctxn_locks_entry *ctxn_locks_tab;
+    u32 ctxn_locks_shift;
     u32 ctxn_locks_cnt;
-    u32 ctxn_locks_entryc;
-    u32 ctxn_locks_entrymax;
 
-    struct ctxn_locks_tree_entry ctxn_locks_entryv[];
+    struct ctxn_locks_entry ctxn_locks_entryv[];
 };
 
-_Static_assert(sizeof(struct kvdb_ctxn_locks_impl) < KVDB_LOCKS_SZ, "KVDB_LOCKS_SZ too small");
+#define KVDB_LOCKS_SZ \
+    (sizeof(struct kvdb_ctxn_locks_impl) + KVDB_LOCKS_ENTRYMAX * sizeof(struct ctxn_locks_entry))
+
+#define KVDB_LOCKS_SHIFT (64 - ilog2(KVDB_LOCKS_ENTRYMAX))
+
+static inline u32
+ctxn_locks_slots(const struct kvdb_ctxn_locks_impl *locks)
+{
+    return 1u << (64 - locks->ctxn_locks_shift);
+}
+
+static inline u32
+ctxn_locks_home(u64 hash, u32 shift)
+{
+    return (hash * 0x9e3779b97f4a7c15ul) >> shift;
+}
+
+/* Return the slot that holds the given hash, or the empty slot at
+ * which it would be inserted.
+ */
+static u32
+ctxn_locks_find(const struct kvdb_ctxn_locks_impl *locks, u64 hash)
+{
+    const struct ctxn_locks_entry *tab = locks->ctxn_locks_tab;
+    u32                            mask = ctxn_locks_slots(locks) - 1;
+    u32                            i;
+
+    i = ctxn_locks_home(hash, locks->ctxn_locks_shift);
+
+    while (tab[i].lte_busy && tab[i].lte_hash != hash)
+        i = (i + 1) & mask;
+
+    return i;
+}
+
+/* Double the size of the hash set.  The embedded entryv[] is never
+ * freed, it is reinstated by kvdb_keylock_release_locks().
+ */
+static merr_t
+ctxn_locks_grow(struct kvdb_ctxn_locks_impl *locks)
+{
+    struct ctxn_locks_entry *oldtab = locks->ctxn_locks_tab;
+    u32                      oldslots = ctxn_locks_slots(locks);
+    u32                      i;
+
+    locks->ctxn_locks_tab = malloc(oldslots * 2 * sizeof(*oldtab));
+    if (ev(!locks->ctxn_locks_tab)) {
+        locks->ctxn_locks_tab = oldtab;
+        return merr(ENOMEM);
+    }
+
+    memset(locks->ctxn_locks_tab, 0, oldslots * 2 * sizeof(*oldtab));
+    locks->ctxn_locks_shift--;
+
+    for (i = 0; i < oldslots; ++i) {
+        if (oldtab[i].lte_busy)
+            locks->ctxn_locks_tab[ctxn_locks_find(locks, oldtab[i].lte_hash)] = oldtab[i];
+    }
+
+    if (oldtab != locks->ctxn_locks_entryv)
+        free(oldtab);
+    else
+        memset(oldtab, 0, oldslots * sizeof(*oldtab));
+
+    return 0;
+}
+
+/* Remove the entry at the given slot, shifting subsequent entries of
+ * its probe sequence backward such that no lookup crosses an empty slot
+ * (i.e., deletion without tombstones, Knuth Vol. 3, Algorithm R).
+ */
+static void
+ctxn_locks_remove(struct kvdb_ctxn_locks_impl *locks, u32 i)
+{
+    struct ctxn_locks_entry *tab = locks->ctxn_locks_tab;
+    u32                      mask = ctxn_locks_slots(locks) - 1;
+    u32                      j, k;
+
+    for (j = i;;) {
+        memset(tab + i, 0, sizeof(tab[i]));
+
+        do {
+            j = (j + 1) & mask;
+            if (!tab[j].lte_busy)
+                return;
+
+            k = ctxn_locks_home(tab[j].lte_hash, locks->ctxn_locks_shift);
+        } while ((i <= j) ? (i < k && k <= j) : (i < k || k <= j));
+
+        tab[i] = tab[j];
+        i = j;
+    }
+}
 
 static struct kmem_cache *kvdb_ctxn_locks_cache;
-static struct kmem_cache *kvdb_ctxn_entry_cache;
 static atomic_t           kvdb_ctxn_locks_init_ref;
 
 merr_t
@@ -146,7 +235,6 @@ kvdb_keylock_create(struct kvdb_keylock **handle_out, u32 num_tables, u64 num_en
     memset(klock, 0, sz);
     num_entries = clamp_t(u64, num_entries, 1, KLE_PLEN_MAX);
     klock->kl_num_entries = num_tables * num_entries;
-    klock->kl_entries_per_txn = klock->kl_num_entries / 4;
     klock->kl_num_tables = num_tables;
     memset(&klock->kl_perfc_set, 0, sizeof(klock->kl_perfc_set));
 
@@ -282,49 +370,38 @@ kvdb_keylock_insert_locks(struct kvdb_ctxn_locks *handle, u64 end_seqno, void *c
 void
 kvdb_keylock_prune_own_locks(struct kvdb_keylock *kl_handle, struct kvdb_ctxn_locks *locks_handle)
 {
-    struct kvdb_keylock_impl *    klock;
-    struct kvdb_ctxn_locks_impl * locks;
-    struct ctxn_locks_tree_entry *entry;
-    struct ctxn_locks_tree_entry *next;
-    struct rb_root *              tree;
-    void *                        freeme;
-    u64                           cnt;
+    struct kvdb_keylock_impl *   klock;
+    struct kvdb_ctxn_locks_impl *locks;
+    struct ctxn_locks_entry *    tab;
+    u32                          slots, i;
 
     klock = kvdb_keylock_h2r(kl_handle);
     locks = kvdb_ctxn_locks_h2r(locks_handle);
 
-    tree = &locks->ctxn_locks_tree;
-    cnt = locks->ctxn_locks_cnt;
-    freeme = NULL;
+    tab = locks->ctxn_locks_tab;
+    slots = ctxn_locks_slots(locks);
 
-    rbtree_postorder_for_each_entry_safe(entry, next, tree, lte_node)
-    {
-        u32 idx = entry->lte_tindex;
+    /* A removal may shift an as yet unvisited entry into slot i,
+     * so slot i must be examined again after each removal.
+     */
+    for (i = 0; i < slots && locks->ctxn_locks_cnt > 0;) {
+        struct ctxn_locks_entry *entry = tab + i;
 
-        if (entry->lte_inherited)
+        if (!entry->lte_busy || entry->lte_inherited) {
+            ++i;
             continue;
+        }
 
         keylock_unlock(
-            klock->kl_keylock[idx], entry->lte_hash, (struct keylock_cb_rock *)locks_handle);
-
-        rb_erase(&entry->lte_node, tree);
-
-        if (entry->lte_kfree) {
-            *(void **)entry = freeme;
-            freeme = entry;
-        }
+            klock->kl_keylock[entry->lte_tindex],
+            entry->lte_hash,
+            (struct keylock_cb_rock *)locks_handle);
 
-        assert(cnt > 0);
-        cnt--;
-    }
+        ctxn_locks_remove(locks, i);
 
-    while (freeme) {
-        entry = freeme;
-        freeme = *(void **)entry;
-        kmem_cache_free(kvdb_ctxn_entry_cache, entry);
+        assert(locks->ctxn_locks_cnt > 0);
+        locks->ctxn_locks_cnt--;
     }
-
-    locks->ctxn_locks_cnt = cnt;
 }
 
 /**
@@ -403,7 +480,7 @@ kvdb_keylock_expire(struct kvdb_keylock *handle, u64 min_view_sn)
 
 /**
  * kvdb_keylock_release_locks() - unlock all the locks acquired by a
- * transaction and destroy the associated tree.
+ * transaction and empty the associated hash set.
  *
  * This function is called with no locks held, but inside of an RCU
  * read-side critical section.
@@ -414,47 +491,42 @@ kvdb_keylock_expire(struct kvdb_keylock *handle, u64 min_view_sn)
 void
 kvdb_keylock_release_locks(struct kvdb_keylock *kl_handle, struct kvdb_ctxn_locks *locks_handle)
 {
-    struct kvdb_keylock_impl *    klock;
-    struct kvdb_ctxn_locks_impl * locks;
-    struct ctxn_locks_tree_entry *entry;
-    struct ctxn_locks_tree_entry *next;
-    struct rb_root *              tree;
-    void *                        freeme;
-
-    int cnt __maybe_unused;
+    struct kvdb_keylock_impl *   klock;
+    struct kvdb_ctxn_locks_impl *locks;
+    struct ctxn_locks_entry *    tab;
+    u32                          slots, i;
+    u32                          cnt;
 
     klock = kvdb_keylock_h2r(kl_handle);
     locks = kvdb_ctxn_locks_h2r(locks_handle);
 
-    tree = &locks->ctxn_locks_tree;
+    tab = locks->ctxn_locks_tab;
+    slots = ctxn_locks_slots(locks);
     cnt = locks->ctxn_locks_cnt;
-    freeme = NULL;
 
-    rbtree_postorder_for_each_entry_safe(entry, next, tree, lte_node)
-    {
-        u32 idx = entry->lte_tindex;
+    for (i = 0; i < slots && cnt > 0; ++i) {
+        struct ctxn_locks_entry *entry = tab + i;
 
-        assert(cnt-- > 0);
+        if (!entry->lte_busy)
+            continue;
 
         keylock_unlock(
-            klock->kl_keylock[idx], entry->lte_hash, (struct keylock_cb_rock *)locks_handle);
-
-        if (entry->lte_kfree) {
-            *(void **)entry = freeme;
-            freeme = entry;
-        }
-    }
+            klock->kl_keylock[entry->lte_tindex],
+            entry->lte_hash,
+            (struct keylock_cb_rock *)locks_handle);
 
-    while (freeme) {
-        entry = freeme;
-        freeme = *(void **)entry;
-        kmem_cache_free(kvdb_ctxn_entry_cache, entry);
+        memset(entry, 0, sizeof(*entry));
+        cnt--;
     }
 
     assert(cnt == 0);
     locks->ctxn_locks_cnt = 0;
-    locks->ctxn_locks_entryc = 0;
-    locks->ctxn_locks_tree = RB_ROOT;
+
+    if (tab != locks->ctxn_locks_entryv) {
+        free(tab);
+        locks->ctxn_locks_tab = locks->ctxn_locks_entryv;
+        locks->ctxn_locks_shift = KVDB_LOCKS_SHIFT;
+    }
 }
 
 /**
@@ -473,15 +545,12 @@ kvdb_keylock_lock(
     u64                     hash,
     u64                     start_seq)
 {
-    struct kvdb_keylock_impl *    klock;
-    struct kvdb_ctxn_locks_impl * ctxn_locks;
-    struct rb_node **             link;
-    struct rb_node *              parent;
-    struct ctxn_locks_tree_entry *entry;
-    merr_t                        err;
-    u32                           tindex;
-    u32                           entryc;
-    bool                          inherited;
+    struct kvdb_keylock_impl *   klock;
+    struct kvdb_ctxn_locks_impl *ctxn_locks;
+    struct ctxn_locks_entry *    entry;
+    merr_t                       err;
+    u32                          tindex;
+    bool                         inherited;
 
     assert(hash);
 
@@ -491,29 +560,11 @@ kvdb_keylock_lock(
     hash = (hash << 16) >> 16;
     tindex = hash % klock->kl_num_tables;
 
-    link = &ctxn_locks->ctxn_locks_tree.rb_node;
-    parent = NULL;
-    entry = NULL;
-
-    /* [HSE_REVISIT] The write lock container is currently an RB tree. A
-     * hash table might be better.
-     */
-
-    /* Traverse the write lock container to check if the lock exists. */
-    while (*link) {
-        parent = *link;
-        entry = rb_entry(parent, struct ctxn_locks_tree_entry, lte_node);
-
-        if (hash < entry->lte_hash)
-            link = &(*link)->rb_left;
-        else if (hash > entry->lte_hash)
-            link = &(*link)->rb_right;
-        else
-            break;
-    }
+    /* Check the write lock container to see if the lock exists. */
+    entry = ctxn_locks->ctxn_locks_tab + ctxn_locks_find(ctxn_locks, hash);
 
     /* The lock was previously acquired by this transaction. */
-    if (*link) {
+    if (entry->lte_busy) {
         assert(
             keylock_lock(
                 klock->kl_keylock[tindex],
@@ -527,30 +578,15 @@ kvdb_keylock_lock(
         return 0;
     }
 
-    /*
-     * [HSE_REVISIT]
-     * The transaction has exceeded the limit on the max number of locks
-     * it can acquire.
+    /* Make room for the entry beforehand since if we inherit ownership
+     * we cannot fail.
      */
-    if (ev(ctxn_locks->ctxn_locks_cnt > klock->kl_entries_per_txn))
-        return merr(E2BIG);
-
-    /* Pre-allocate space for the entry since if we inherit ownership we
-     * cannot fail.  We first try to allocate from the ctxn_locks entry
-     * cache, and fall back on kmalloc if the cache is empty.
-     */
-    entryc = ctxn_locks->ctxn_locks_entryc;
-
-    if (likely(entryc < ctxn_locks->ctxn_locks_entrymax)) {
-        entry = ctxn_locks->ctxn_locks_entryv + entryc;
-        ctxn_locks->ctxn_locks_entryc++;
-        entry->lte_kfree = false;
-    } else {
-        entry = kmem_cache_alloc(kvdb_ctxn_entry_cache);
-        if (ev(!entry))
-            return merr(ENOMEM);
+    if (unlikely(ctxn_locks->ctxn_locks_cnt + 1 > ctxn_locks_slots(ctxn_locks) / 4 * 3)) {
+        err = ctxn_locks_grow(ctxn_locks);
+        if (ev(err))
+            return err;
 
-        entry->lte_kfree = true;
+        entry = ctxn_locks->ctxn_locks_tab + ctxn_locks_find(ctxn_locks, hash);
     }
 
     /* Attempt to acquire the lock since it wasn't found in the
@@ -567,18 +603,11 @@ kvdb_keylock_lock(
         entry->lte_hash = hash;
         entry->lte_tindex = tindex;
         entry->lte_inherited = inherited;
-
-        rb_link_node(&entry->lte_node, parent, link);
-        rb_insert_color(&entry->lte_node, &ctxn_locks->ctxn_locks_tree);
+        entry->lte_busy = true;
 
         ctxn_locks->ctxn_locks_cnt++;
     } else {
         perfc_inc(&klock->kl_perfc_set, PERFC_RA_CTXNOP_LOCK_FAILED);
-
-        if (entry->lte_kfree)
-            kmem_cache_free(kvdb_ctxn_entry_cache, entry);
-        else
-            ctxn_locks->ctxn_locks_entryc--;
     }
 
     return err;
@@ -588,15 +617,10 @@ static void
 kvdb_ctxn_locks_ctor(void *arg)
 {
     struct kvdb_ctxn_locks_impl *impl = arg;
-    size_t                       implsz;
-
-    implsz = offsetof(struct kvdb_ctxn_locks_impl, ctxn_locks_entryv);
-    implsz = ALIGN(implsz, 32);
-    assert(sizeof(*impl) >= implsz);
 
-    memset(impl, 0, implsz);
-    impl->ctxn_locks_entrymax = KVDB_LOCKS_SZ - implsz;
-    impl->ctxn_locks_entrymax /= sizeof(impl->ctxn_locks_entryv[0]);
+    memset(impl, 0, KVDB_LOCKS_SZ);
+    impl->ctxn_locks_tab = impl->ctxn_locks_entryv;
+    impl->ctxn_locks_shift = KVDB_LOCKS_SHIFT;
     impl->ctxn_locks_magic = ~(uintptr_t)impl;
 }
 
@@ -617,8 +641,7 @@ kvdb_ctxn_locks_create(struct kvdb_ctxn_locks **locksp)
      */
     impl->ctxn_locks_magic = (uintptr_t)impl;
     impl->ctxn_locks_end_seqno = U64_MAX;
-    impl->ctxn_locks_tree = RB_ROOT;
-    impl->ctxn_locks_entryc = 0;
+    assert(impl->ctxn_locks_tab == impl->ctxn_locks_entryv);
 
     *locksp = &impl->ctxn_locks_handle;
     return 0;
@@ -634,6 +657,14 @@ kvdb_ctxn_locks_destroy(struct kvdb_ctxn_locks *handle)
     assert(impl->ctxn_locks_magic == (uintptr_t)impl);
     assert(impl->ctxn_locks_cnt == 0);
 
+    /* The hash set may have grown even if all its locks were pruned.
+     */
+    if (impl->ctxn_locks_tab != impl->ctxn_locks_entryv) {
+        free(impl->ctxn_locks_tab);
+        impl->ctxn_locks_tab = impl->ctxn_locks_entryv;
+        impl->ctxn_locks_shift = KVDB_LOCKS_SHIFT;
+    }
+
     impl->ctxn_locks_magic = ~(uintptr_t)impl;
 
     kmem_cache_free(kvdb_ctxn_locks_cache, impl);
@@ -660,8 +691,7 @@ kvdb_ctxn_locks_end_seqno(struct kvdb_ctxn_locks *handle)
 void
 kvdb_ctxn_locks_init(void)
 {
-    struct ctxn_locks_tree_entry *entry;
-    struct kmem_cache *           zone;
+    struct kmem_cache *zone;
 
     if (atomic_inc_return(&kvdb_ctxn_locks_init_ref) > 1)
         return;
@@ -670,10 +700,6 @@ kvdb_ctxn_locks_init(void)
         "kvdb_ctxn_locks", KVDB_LOCKS_SZ, 0, SLAB_HWCACHE_ALIGN, kvdb_ctxn_locks_ctor);
     kvdb_ctxn_locks_cache = zone;
     assert(zone); /* [HSE_REVISIT] */
-
-    zone = kmem_cache_create("kvdb_ctxn_entry", sizeof(*entry), 0, 0, NULL);
-    kvdb_ctxn_entry_cache = zone;
-    assert(zone); /* [HSE_REVISIT] */
 }
 
 void
@@ -684,9 +710,6 @@ kvdb_ctxn_locks_fini(void)
 
     kmem_cache_destroy(kvdb_ctxn_locks_cache);
     kvdb_ctxn_locks_cache = NULL;
-
-    kmem_cache_destroy(kvdb_ctxn_entry_cache);
-    kvdb_ctxn_entry_cache = NULL;
 }
 
 #if defined(HSE_UNIT_TEST_MODE) && HSE_UNIT_TEST_MODE == 1
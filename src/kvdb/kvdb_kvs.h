@@ -27,7 +27,8 @@ struct kk_cursors_mtx {
  * @kk_parent:       pointer to parent kvdb_impl instance.
  * @kk_vcompmin:     value length above which compression is considered
  * @kk_vcompbnd:     compression output buffer size estimate for tls_vbuf[]
- * @kk_vcompress:    ptr to value compression function
+ * @kk_vcomp:        value compression codec (NULL if compression disabled)
+ * @kk_vcomplvl:     value compression level (zero for the codec's default)
  * @kk_cnid:         id of the cn associated with kvdb.
  * @kk_cparams:      cn's create-time parameters.
  * @kk_flags:        flags for cn.
@@ -47,10 +48,11 @@ struct kvdb_kvs {
     atomic64_t             *kk_seqno;
     atomic64_t             *kk_seqno_cur;
     struct ikvdb_impl      *kk_parent;
-    u32                     kk_vcompmin;
-    u32                     kk_vcompbnd;
-    compress_op_compress_t *kk_vcompress;
-    u64                     kk_cnid;
+    u32                        kk_vcompmin;
+    u32                        kk_vcompbnd;
+    const struct compress_ops *kk_vcomp;
+    int                        kk_vcomplvl;
+    u64                        kk_cnid;
     struct kvs_cparams     *kk_cparams;
     u32                     kk_flags;
     atomic_t                kk_refcnt;
@@ -286,6 +286,7 @@ print_unit(
     u64                  ntombs,
     u64                  klen,
     u64                  vlen,
+    u64                  heat,
     int                  nkvsets,
     int                  nkblks,
     int                  nvblks,
@@ -301,6 +302,7 @@ print_unit(
     }
     yaml2fd(fd, yaml_field_fmt, yc, "klen", "%lu", klen);
     yaml2fd(fd, yaml_field_fmt, yc, "vlen", "%lu", vlen);
+    yaml2fd(fd, yaml_field_fmt, yc, "heat", "%lu", heat);
 
     if (nkvsets >= 0) /* do not print these fields for kvsets */
         yaml2fd(fd, yaml_field_fmt, yc, "nkvsets", "%d", nkvsets);
@@ -348,6 +350,7 @@ print_elem(
                 m->num_tombstones,
                 m->tot_key_bytes,
                 m->tot_val_bytes,
+                m->heat,
                 -1,
                 ctx->num_kblks,
                 ctx->num_vblks,
@@ -383,6 +386,7 @@ print_elem(
                 m->num_tombstones,
                 m->tot_key_bytes,
                 m->tot_val_bytes,
+                m->heat,
                 ctx->kvset_idx,
                 ctx->node_kblks,
                 ctx->node_vblks,
@@ -446,6 +450,7 @@ print_tree(struct ctx *ctx, struct cn_node_loc *loc, struct kvset *kvset)
     ctx->node.num_vblocks += km.num_vblocks;
     ctx->node.tot_key_bytes += km.tot_key_bytes;
     ctx->node.tot_val_bytes += km.tot_val_bytes;
+    ctx->node.heat += km.heat;
 
     ctx->total.num_keys += km.num_keys;
     ctx->total.num_tombstones += km.num_tombstones;
@@ -453,6 +458,7 @@ print_tree(struct ctx *ctx, struct cn_node_loc *loc, struct kvset *kvset)
     ctx->total.num_vblocks += km.num_vblocks;
     ctx->total.tot_key_bytes += km.tot_key_bytes;
     ctx->total.tot_val_bytes += km.tot_val_bytes;
+    ctx->total.heat += km.heat;
 
     print_elem("kvset", ctx, &km, loc, kvset);
 
@@ -515,6 +521,7 @@ kvs_rest_query_tree(struct kvdb_kvs *kvs, struct yaml_context *yc, int fd, bool
         m->num_tombstones,
         m->tot_key_bytes,
         m->tot_val_bytes,
+        m->heat,
         ctx.tot_kvsets,
         ctx.tot_kblks,
         ctx.tot_vblks,
@@ -77,6 +77,12 @@ kvdb_rparams_defaults(void)
         .csched_leaf_comp_params = 0,
         .csched_leaf_len_params = 0,
         .csched_node_min_ttl = 17,
+        .csched_heat_hot = 4096,
+        .csched_heat_cold = 0,
+        .csched_expired_pct = 25,
+        .csched_gov_lat_ns = 0,
+        .csched_gov_rate_min = 32ul << 20,
+        .csched_gov_rate_max = 2ul << 30,
 
         .dur_enable = 1,
         .dur_intvl_ms = 500,
@@ -103,8 +109,10 @@ kvdb_rparams_defaults(void)
         .log_squelch_ns = HSE_LOG_SQUELCH_NS_DEFAULT,
         .txn_wkth_delay = 1000 * 60,
         .cndb_entries = 0,
+        .cn_vcache_sz = HSE_CN_VCACHE_SZ_DFLT,
         .c0_maint_threads = HSE_C0_MAINT_THREADS_DFLT,
         .c0_ingest_threads = HSE_C0_INGEST_THREADS_DFLT,
+        .c0_ingest_kvs_threads = HSE_C0_INGEST_KVS_THREADS_DFLT,
 
         .keylock_entries = 19997,
         .keylock_tables = 293,
@@ -149,6 +157,12 @@ static struct param_inst   kvdb_rp_table[] = {
     KVDB_PARAM_EXP(csched_leaf_comp_params, "leaf compact params [poppct,min,max]"),
     KVDB_PARAM_EXP(csched_leaf_len_params, "leaf length params [idlem,idlec,kvcompc,min,max]"),
     KVDB_PARAM_EXP(csched_node_min_ttl, "Min. time-to-live for cN nodes (secs)"),
+    KVDB_PARAM_EXP(csched_heat_hot, "csched read heat above which data prefers staging"),
+    KVDB_PARAM_EXP(csched_heat_cold, "csched read heat below which data prefers capacity"),
+    KVDB_PARAM_EXP(csched_expired_pct, "csched expired pct. that triggers leaf compaction"),
+    KVDB_PARAM_EXP(csched_gov_lat_ns, "csched target p99 cN get latency (ns, 0: no io governor)"),
+    KVDB_PARAM_EXP(csched_gov_rate_min, "csched min compaction io budget (bytes/sec)"),
+    KVDB_PARAM_EXP(csched_gov_rate_max, "csched max compaction io budget (bytes/sec)"),
 
     KVDB_PARAM_EXP(dur_enable, "0: disable durability, 1:enable durability"),
     KVDB_PARAM(dur_intvl_ms, "durability lag in ms"),
@@ -176,8 +190,10 @@ static struct param_inst   kvdb_rp_table[] = {
         cndb_entries,
         "number of entries in cndb's in-core "
         "representation (0: let system choose)"),
+    KVDB_PARAM_EXP(cn_vcache_sz, "cN value cache size (bytes, 0: disable)"),
     KVDB_PARAM_U32_EXP(c0_maint_threads, "max number of maintenance threads"),
     KVDB_PARAM_U32_EXP(c0_ingest_threads, "max number of c0 ingest threads"),
+    KVDB_PARAM_U32_EXP(c0_ingest_kvs_threads, "max threads per c0 ingest (1: serial)"),
     KVDB_PARAM_U32_EXP(c0_mutex_pool_sz, "max locks in c0 ingest sync pool"),
 
     KVDB_PARAM_U32_EXP(keylock_entries, "number of keylock entries in a table"),
@@ -207,6 +223,12 @@ static char const *const kvdb_rp_writable[] = {
     "csched_ispill_params",
     "csched_leaf_comp_params",
     "csched_leaf_len_params",
+    "csched_heat_hot",
+    "csched_heat_cold",
+    "csched_expired_pct",
+    "csched_gov_lat_ns",
+    "csched_gov_rate_min",
+    "csched_gov_rate_max",
     "csched_debug_mask",
 };
 
@@ -264,3 +264,46 @@ mclass_policy_get_type(struct mclass_policy *policy, u8 age, u8 dtype, u8 retrie
 
     return MP_MED_INVALID;
 }
+
+static bool
+mclass_policy_uses(struct mclass_policy *policy, u8 dtype, u8 mtype)
+{
+    int age, i;
+
+    for (age = 0; age < HSE_MPOLICY_AGE_CNT; age++)
+        for (i = 0; i < HSE_MPOLICY_MEDIA_CNT; i++)
+            if (policy->mc_table[age][dtype][i] == mtype)
+                return true;
+
+    return false;
+}
+
+bool
+mclass_policy_temp_capable(struct mclass_policy *policy, u8 dtype)
+{
+    if (dtype >= HSE_MPOLICY_DTYPE_CNT)
+        return false;
+
+    /* Only move data between media classes the policy already uses
+     * for this data type, e.g., never onto staging for capacity_only.
+     */
+    return mclass_policy_uses(policy, dtype, HSE_MPOLICY_MEDIA_STAGING) &&
+           mclass_policy_uses(policy, dtype, HSE_MPOLICY_MEDIA_CAPACITY);
+}
+
+enum mp_media_classp
+mclass_policy_get_type_temp(struct mclass_policy *policy, u8 age, u8 dtype, u8 temp, u8 retries)
+{
+    bool hot;
+
+    if (temp == HSE_MPOLICY_TEMP_NONE || retries >= HSE_MPOLICY_MEDIA_CNT ||
+        !mclass_policy_temp_capable(policy, dtype))
+        return mclass_policy_get_type(policy, age, dtype, retries);
+
+    hot = (temp == HSE_MPOLICY_TEMP_HOT);
+
+    if (retries == 0)
+        return hot ? MP_MED_STAGING : MP_MED_CAPACITY;
+
+    return hot ? MP_MED_CAPACITY : MP_MED_STAGING;
+}
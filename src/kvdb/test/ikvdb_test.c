@@ -621,6 +621,84 @@ MTF_DEFINE_UTEST_PREPOST(ikvdb_test, txn_del_test, test_pre, test_post)
     hse_params_destroy(params);
 }
 
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, get_batch_test, test_pre, test_post)
+{
+    struct ikvdb *         h = NULL;
+    struct hse_kvs *       kvs_h = NULL;
+    const char *           mpool = "mpool";
+    const char *           kvs = "kvs";
+    struct hse_params *    params;
+    merr_t                 err;
+    struct mpool *         ds = (struct mpool *)-1;
+    struct hse_kvdb_opspec opspec;
+    struct kvs_ktuple      ktv[4];
+    struct kvs_vtuple      vt;
+    struct kvs_buf         vbufv[4];
+    char                   kbuf[4][16];
+    char                   buf[4][100];
+    enum key_lookup_res    resv[4];
+    int                    i;
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    /* we want a valid c0/c0sk here */
+    mock_c0_unset();
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open(mpool, ds, params, &h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_make(h, kvs, NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, kvs, 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvs_h);
+
+    /* Put keys 0, 1 and 3; key 2 is left missing.
+     */
+    for (i = 0; i < 4; ++i) {
+        snprintf(kbuf[i], sizeof(kbuf[i]), "key-%d", i);
+        kvs_vtuple_init(&vt, kbuf[i], strlen(kbuf[i]));
+
+        if (i != 2) {
+            kvs_ktuple_init(&ktv[i], kbuf[i], strlen(kbuf[i]));
+            err = ikvdb_kvs_put(kvs_h, &opspec, &ktv[i], &vt);
+            ASSERT_EQ(0, err);
+        }
+
+        kvs_ktuple_init_nohash(&ktv[i], kbuf[i], strlen(kbuf[i]));
+        kvs_buf_init(&vbufv[i], buf[i], sizeof(buf[i]));
+    }
+
+    err = ikvdb_kvs_get_batch(kvs_h, &opspec, 4, ktv, resv, vbufv);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < 4; ++i) {
+        if (i == 2) {
+            ASSERT_EQ(NOT_FOUND, resv[i]);
+            continue;
+        }
+
+        ASSERT_EQ(FOUND_VAL, resv[i]);
+        ASSERT_EQ(strlen(kbuf[i]), vbufv[i].b_len);
+        ASSERT_EQ(0, memcmp(kbuf[i], buf[i], vbufv[i].b_len));
+    }
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
 struct tx_info {
     struct ikvdb *  kvdb;
     struct hse_kvs *kvs;
@@ -1012,6 +1090,275 @@ MTF_DEFINE_UTEST_PREPOST(ikvdb_test, cursor_1, test_pre_c0, test_post_c0)
     hse_params_destroy(params);
 }
 
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, cursor_read_batch, test_pre_c0, test_post_c0)
+{
+    struct ikvdb *                   h = NULL;
+    struct hse_kvs *                 kvs_h = NULL;
+    const char *                     mpool = "mpool";
+    const char *                     kvs = "kvs";
+    struct mpool *                   ds = (struct mpool *)-1;
+    struct hse_params *              params;
+    struct hse_kvdb_opspec           opspec;
+    struct hse_kvs_cursor *          cur;
+    const struct hse_kvs_cursor_rec *rec;
+    struct kvs_ktuple                kt = { 0 };
+    struct kvs_vtuple                vt = { 0 };
+    u64                              buf[32];
+    size_t                           used;
+    merr_t                           err;
+    bool                             eof;
+    uint                             count;
+    int                              i, j;
+
+    const char *sorted[] = { "AA", "AAA", "AABB", "AABC", "AB", "ABAA", "ABC", "AC" };
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open(mpool, ds, params, &h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_make(h, kvs, NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, kvs, 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+
+    for (i = NELEM(sorted) - 1; i >= 0; --i) {
+        kvs_ktuple_init(&kt, sorted[i], strlen(sorted[i]));
+        kvs_vtuple_init(&vt, (void *)sorted[i], strlen(sorted[i]));
+
+        err = ikvdb_kvs_put(kvs_h, &opspec, &kt, &vt);
+        ASSERT_EQ(0, err);
+    }
+
+    err = ikvdb_kvs_cursor_create(kvs_h, &opspec, 0, 0, &cur);
+    ASSERT_EQ(0, err);
+
+    /* A buffer too small for the first pair reports the size it needs. */
+    err = ikvdb_kvs_cursor_read_batch(cur, 0, 0, buf, 8, &count, &used, &eof);
+    ASSERT_EQ(0, err);
+    ASSERT_FALSE(eof);
+    ASSERT_EQ(0, count);
+    ASSERT_EQ(HSE_KVS_CURSOR_REC_SIZE(2, 2), used);
+
+    /* Each pair needs 16 bytes, so the fifth one must wait for the next read. */
+    err = ikvdb_kvs_cursor_read_batch(cur, 0, 0, buf, 72, &count, &used, &eof);
+    ASSERT_EQ(0, err);
+    ASSERT_FALSE(eof);
+    ASSERT_EQ(4, count);
+    ASSERT_EQ(64, used);
+
+    rec = (void *)buf;
+    for (i = 0; i < count; ++i) {
+        ASSERT_EQ(strlen(sorted[i]), rec->kcr_klen);
+        ASSERT_EQ(strlen(sorted[i]), rec->kcr_vlen);
+        ASSERT_EQ(0, memcmp(HSE_KVS_CURSOR_REC_KEY(rec), sorted[i], rec->kcr_klen));
+        ASSERT_EQ(0, memcmp(HSE_KVS_CURSOR_REC_VAL(rec), sorted[i], rec->kcr_vlen));
+        rec = HSE_KVS_CURSOR_REC_NEXT(rec, rec->kcr_vlen);
+    }
+
+    err = ikvdb_kvs_cursor_read_batch(cur, 0, 0, buf, sizeof(buf), &count, &used, &eof);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(NELEM(sorted) - 4, count);
+
+    rec = (void *)buf;
+    for (i = 4; i < NELEM(sorted); ++i) {
+        ASSERT_EQ(strlen(sorted[i]), rec->kcr_klen);
+        ASSERT_EQ(0, memcmp(HSE_KVS_CURSOR_REC_KEY(rec), sorted[i], rec->kcr_klen));
+        rec = HSE_KVS_CURSOR_REC_NEXT(rec, rec->kcr_vlen);
+    }
+
+    err = ikvdb_kvs_cursor_read_batch(cur, 0, 0, buf, sizeof(buf), &count, &used, &eof);
+    ASSERT_EQ(0, err);
+    ASSERT_TRUE(eof);
+    ASSERT_EQ(0, count);
+    ASSERT_EQ(0, used);
+
+    err = ikvdb_kvs_cursor_destroy(cur);
+    ASSERT_EQ(0, err);
+
+    /* Values are omitted in the key-only and value-length-only modes. */
+    for (j = 0; j < 2; ++j) {
+        uint flags = j ? HSE_KVS_CURSOR_READ_VLEN_ONLY : HSE_KVS_CURSOR_READ_KEYS_ONLY;
+
+        err = ikvdb_kvs_cursor_create(kvs_h, &opspec, 0, 0, &cur);
+        ASSERT_EQ(0, err);
+
+        err = ikvdb_kvs_cursor_read_batch(cur, 0, flags, buf, sizeof(buf), &count, &used, &eof);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(NELEM(sorted), count);
+        ASSERT_EQ(NELEM(sorted) * 16, used);
+
+        rec = (void *)buf;
+        for (i = 0; i < count; ++i) {
+            ASSERT_EQ(strlen(sorted[i]), rec->kcr_klen);
+            ASSERT_EQ(j ? strlen(sorted[i]) : 0, rec->kcr_vlen);
+            ASSERT_EQ(0, memcmp(HSE_KVS_CURSOR_REC_KEY(rec), sorted[i], rec->kcr_klen));
+            rec = HSE_KVS_CURSOR_REC_NEXT(rec, 0);
+        }
+
+        err = ikvdb_kvs_cursor_destroy(cur);
+        ASSERT_EQ(0, err);
+    }
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
+static const char *splitv[] = { "AB", "ABC" };
+
+static merr_t
+_cn_cursor_split(
+    struct cn * cn,
+    const void *prefix,
+    u32         pfx_len,
+    uint        splitmax,
+    void *      keybuf,
+    u32 *       klenv,
+    uint *      splitcp)
+{
+    uint i;
+
+    for (i = 0; i < NELEM(splitv) && i < splitmax; ++i) {
+        klenv[i] = strlen(splitv[i]);
+        memcpy(keybuf + i * HSE_KVS_KLEN_MAX, splitv[i], klenv[i]);
+    }
+
+    *splitcp = i;
+
+    return 0;
+}
+
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, cursor_partition, test_pre_c0, test_post_c0)
+{
+    struct ikvdb *         h = NULL;
+    struct hse_kvs *       kvs_h = NULL;
+    const char *           mpool = "mpool";
+    const char *           kvs = "kvs";
+    struct mpool *         ds = (struct mpool *)-1;
+    struct hse_params *    params;
+    struct hse_kvdb_opspec opspec;
+    struct hse_kvs_cursor *curv[HSE_KVS_CURSOR_PARTS_MAX];
+    struct kvs_ktuple      kt = { 0 };
+    struct kvs_vtuple      vt = { 0 };
+    const void *           key, *val;
+    size_t                 klen, vlen;
+    merr_t                 err;
+    bool                   eof;
+    uint                   curc, i, j, n;
+
+    const char *keyv[] = { "AABC", "AC", "AA", "AABB", "ABAA", "AB", "ABC", "AAA" };
+    const char *sorted[] = { "AA", "AAA", "AABB", "AABC", "AB", "ABAA", "ABC", "AC" };
+    const uint  partv[] = { 0, 4, 6, 8 }; /* first sorted[] index of each range */
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open(mpool, ds, params, &h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_make(h, kvs, NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, kvs, 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < NELEM(keyv); ++i) {
+        kvs_ktuple_init(&kt, keyv[i], strlen(keyv[i]));
+        kvs_vtuple_init(&vt, (void *)keyv[i], strlen(keyv[i]));
+
+        err = ikvdb_kvs_put(kvs_h, &opspec, &kt, &vt);
+        ASSERT_EQ(0, err);
+    }
+
+    err = ikvdb_kvs_cursor_partition(kvs_h, &opspec, 0, 0, 0, curv, &curc);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    err = ikvdb_kvs_cursor_partition(
+        kvs_h, &opspec, 0, 0, HSE_KVS_CURSOR_PARTS_MAX + 1, curv, &curc);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    opspec.kop_flags = HSE_KVDB_KOP_FLAG_REVERSE;
+    err = ikvdb_kvs_cursor_partition(kvs_h, &opspec, 0, 0, 4, curv, &curc);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+    opspec.kop_flags = 0;
+
+    /* Without split keys there is a single range. */
+    err = ikvdb_kvs_cursor_partition(kvs_h, &opspec, 0, 0, 4, curv, &curc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(1, curc);
+    ASSERT_EQ(NULL, curv[1]);
+
+    for (n = 0;; ++n) {
+        err = ikvdb_kvs_cursor_read(curv[0], 0, &key, &klen, &val, &vlen, &eof);
+        ASSERT_EQ(0, err);
+        if (eof)
+            break;
+    }
+    ASSERT_EQ(NELEM(sorted), n);
+
+    err = ikvdb_kvs_cursor_destroy(curv[0]);
+    ASSERT_EQ(0, err);
+
+    /* Each range ends just before the next one begins. */
+    MOCK_SET(cn_cursor, _cn_cursor_split);
+
+    err = ikvdb_kvs_cursor_partition(kvs_h, &opspec, 0, 0, 4, curv, &curc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(NELEM(splitv) + 1, curc);
+
+    for (i = 0; i < curc; ++i) {
+        for (j = partv[i];; ++j) {
+            err = ikvdb_kvs_cursor_read(curv[i], 0, &key, &klen, &val, &vlen, &eof);
+            ASSERT_EQ(0, err);
+            if (eof)
+                break;
+
+            ASSERT_LT(j, partv[i + 1]);
+            ASSERT_EQ(strlen(sorted[j]), klen);
+            ASSERT_EQ(0, memcmp(key, sorted[j], klen));
+        }
+        ASSERT_EQ(partv[i + 1], j);
+    }
+
+    for (i = 0; i < curc; ++i) {
+        err = ikvdb_kvs_cursor_destroy(curv[i]);
+        ASSERT_EQ(0, err);
+    }
+
+    /* Fewer split keys are requested for fewer cursors. */
+    err = ikvdb_kvs_cursor_partition(kvs_h, &opspec, 0, 0, 2, curv, &curc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(2, curc);
+
+    for (i = 0; i < curc; ++i) {
+        err = ikvdb_kvs_cursor_destroy(curv[i]);
+        ASSERT_EQ(0, err);
+    }
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
 MTF_DEFINE_UTEST_PREPOST(ikvdb_test, cursor_tx, test_pre_c0, test_post_c0)
 {
     struct ikvdb *         h = NULL;
@@ -1671,6 +2018,112 @@ MTF_DEFINE_UTEST_PREPOST(ikvdb_test, kvdb_sync_test, test_pre, test_post)
     hse_params_destroy(params);
 }
 
+/* Pretend the kvdb was created with c1 so that ikvdb_open() attaches one.
+ */
+static merr_t
+sync_op_kvdb_log_replay(
+    struct kvdb_log *log,
+    u64 *            cndblog_oid1,
+    u64 *            cndblog_oid2,
+    u64 *            c1_oid1,
+    u64 *            c1_oid2)
+{
+    *c1_oid1 = 1;
+    *c1_oid2 = 2;
+
+    return 0;
+}
+
+static merr_t
+sync_op_c1_open(
+    struct mpool *       ds,
+    int                  rdonly,
+    u64                  oid1,
+    u64                  oid2,
+    u64                  cningestid,
+    const char *         mpname,
+    struct kvdb_rparams *rparams,
+    struct ikvdb *       ikvdb,
+    struct c0sk *        c0sk,
+    struct kvdb_health * health,
+    struct c1 **         out)
+{
+    *out = (struct c1 *)-1;
+
+    return 0;
+}
+
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, kop_sync_test, test_pre, test_post)
+{
+    struct mpool *         ds = (struct mpool *)-1;
+    struct ikvdb *         h = NULL;
+    struct hse_kvs *       kvs_h = NULL;
+    struct hse_params *    params;
+    struct hse_kvdb_opspec opspec;
+    struct kvs_ktuple      kt, kt2;
+    struct kvs_vtuple      vt;
+    merr_t                 err;
+
+    MOCK_SET_FN(kvdb_log, kvdb_log_replay, sync_op_kvdb_log_replay);
+    MOCK_SET_FN(c1, c1_open, sync_op_c1_open);
+
+    hse_params_create(&params);
+
+    err = hse_params_set(params, "kvdb.c0_diag_mode", "1");
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_open("mpool", ds, params, &h);
+    mock_kvdb_log_set();
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_make(h, "kvs", NULL);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, "kvs", 0, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+
+    kvs_ktuple_init(&kt, "key", 3);
+    kvs_ktuple_init(&kt2, "kez", 3);
+    kvs_vtuple_init(&vt, "data", 4);
+
+    HSE_KVDB_OPSPEC_INIT(&opspec);
+
+    /* Without the flag a put must not wait on c1. */
+    mapi_calls_clear(mapi_idx_c0skm_sync_op);
+    err = ikvdb_kvs_put(kvs_h, &opspec, &kt, &vt);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, mapi_calls(mapi_idx_c0skm_sync_op));
+
+    opspec.kop_flags = HSE_KVDB_KOP_FLAG_SYNC;
+
+    err = ikvdb_kvs_put(kvs_h, &opspec, &kt, &vt);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(1, mapi_calls(mapi_idx_c0skm_sync_op));
+
+    err = ikvdb_kvs_del(kvs_h, &opspec, &kt);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(2, mapi_calls(mapi_idx_c0skm_sync_op));
+
+    err = ikvdb_kvs_range_delete(kvs_h, &opspec, &kt, &kt2);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(3, mapi_calls(mapi_idx_c0skm_sync_op));
+
+    /* A failed c1 sync must be reported to the caller. */
+    mapi_inject(mapi_idx_c0skm_sync_op, merr(EIO));
+    err = ikvdb_kvs_put(kvs_h, &opspec, &kt, &vt);
+    ASSERT_EQ(EIO, merr_errno(err));
+    mapi_inject(mapi_idx_c0skm_sync_op, 0);
+
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+
+    hse_params_destroy(params);
+}
+
 struct thread_info {
     struct ikvdb *  h;
     atomic_t *      num_opens;
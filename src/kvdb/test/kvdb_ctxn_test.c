@@ -646,6 +646,49 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_ctxn_test, get_view_seqno, mapi_pre, mapi_post)
     kvdb_keylock_destroy(klock);
 }
 
+MTF_DEFINE_UTEST_PREPOST(kvdb_ctxn_test, sync_flag, mapi_pre, mapi_post)
+{
+    struct kvdb_ctxn *      handle;
+    struct active_ctxn_set *acs;
+    struct kvdb_keylock *   klock;
+    merr_t                  err;
+    atomic64_t              kvdb_seq;
+
+    err = kvdb_keylock_create(&klock, 16, 65536);
+    ASSERT_EQ(0, err);
+
+    atomic64_set(&kvdb_seq, 117UL);
+
+    err = active_ctxn_set_create(&acs, &kvdb_seq);
+    ASSERT_EQ(0, err);
+
+    err = kvdb_ctxn_set_create(&kvdb_ctxn_set, tn_timeout, tn_delay);
+    ASSERT_EQ(0, err);
+
+    handle = kvdb_ctxn_alloc(klock, &kvdb_seq, kvdb_ctxn_set, acs, NULL);
+    ASSERT_NE(NULL, handle);
+
+    err = kvdb_ctxn_begin(handle);
+    ASSERT_EQ(0, err);
+    ASSERT_FALSE(kvdb_ctxn_get_sync(handle));
+
+    kvdb_ctxn_set_sync(handle);
+    ASSERT_TRUE(kvdb_ctxn_get_sync(handle));
+    kvdb_ctxn_abort(handle);
+
+    /* A new transaction must not inherit the previous one's flag */
+    err = kvdb_ctxn_begin(handle);
+    ASSERT_EQ(0, err);
+    ASSERT_FALSE(kvdb_ctxn_get_sync(handle));
+    kvdb_ctxn_abort(handle);
+
+    kvdb_ctxn_free(handle);
+    kvdb_ctxn_set_destroy(kvdb_ctxn_set);
+
+    active_ctxn_set_destroy(acs);
+    kvdb_keylock_destroy(klock);
+}
+
 MTF_DEFINE_UTEST_PREPOST(kvdb_ctxn_test, get_state, mapi_pre, mapi_post)
 {
     struct kvdb_ctxn *      handle;
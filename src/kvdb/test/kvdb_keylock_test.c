@@ -12,6 +12,7 @@
 #include <hse_util/slab.h>
 #include <hse_util/keylock.h>
 #include <hse_util/rcu.h>
+#include <hse_util/timing.h>
 
 #include <hse_ikvdb/limits.h>
 #include <pthread.h>
@@ -27,6 +28,9 @@
 
 atomic64_t kvdb_seq;
 
+void
+end_ctxn(bool commit, u64 *end_seqno);
+
 int
 mapi_pre(struct mtf_test_info *ti)
 {
@@ -126,7 +130,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_keylock_test, kvdb_ctxn_locks_alloc, mapi_pre, map
 
 MTF_DEFINE_UTEST_PREPOST(kvdb_keylock_test, keylock_lock_one_ctxn, mapi_pre, mapi_post)
 {
-    int                     i = 0;
+    int                     i = 0, j;
     const int               num_keys = 500;
     struct kvdb_keylock *   klock_handle;
     struct kvdb_ctxn_locks *locks_handle;
@@ -185,31 +189,34 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_keylock_test, keylock_lock_one_ctxn, mapi_pre, map
     ASSERT_EQ(err, 0);
     ASSERT_NE(0, locks_handle);
 
-    for (i = 0; i < num_keys; i++) {
-        const int entrymax = 600; /* larger than ctxn_lock_entrymax */
-
-        /* Fail RB tree node allocation every 13th iteration. This
-         * attempt to lock the key must fail. */
+    for (i = 0, j = 0; i < num_keys * 4; i++) {
+        /* Fail the next allocation on every iteration, which must fail
+         * each attempt to lock a key that requires the container of
+         * write locks to grow. */
         hash = magic | i;
 
-        if (i % 13 == 0 && i > entrymax)
-            mapi_inject_once_ptr(mapi_idx_malloc, 1, NULL);
+        mapi_inject_once_ptr(mapi_idx_malloc, 1, NULL);
 
         err = kvdb_keylock_lock(klock_handle, locks_handle, hash, 0);
-
-        if (i % 13 || entrymax > i) {
-            ASSERT_EQ(err, 0);
-        } else {
+        if (err) {
             ASSERT_EQ(ENOMEM, merr_errno(err));
+            ++j;
 
-            /* Validate that the key was unlocked and the
+            /* Validate that the key was not locked and the
              * second attempt to lock it succeeds.
              */
+            mapi_inject_unset(mapi_idx_malloc);
+
             err = kvdb_keylock_lock(klock_handle, locks_handle, hash, 0);
             ASSERT_EQ(err, 0);
         }
     }
 
+    mapi_inject_unset(mapi_idx_malloc);
+
+    ASSERT_GT(j, 0);
+    ASSERT_EQ(num_keys * 4, kvdb_ctxn_locks_count(locks_handle));
+
     kvdb_keylock_release_locks(klock_handle, locks_handle);
     kvdb_ctxn_locks_destroy(locks_handle);
     kvdb_keylock_destroy(klock_handle);
@@ -232,16 +239,146 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_keylock_test, keylock_lock_ctxn_max, mapi_pre, map
     ASSERT_EQ(err, 0);
     ASSERT_NE(0, locks_handle);
 
-    /* Insert unique keys. */
+    /* Insert unique keys.  A transaction may lock as many keys as fit in
+     * the keylock tables (16 tables of 1024 entries, into which these
+     * hashes distribute evenly).
+     */
     for (i = 0; i <= num_keys + 100; i++) {
         err = kvdb_keylock_lock(klock_handle, locks_handle, magic | i, 0);
-        if (i > num_keys / 4)
-            ASSERT_EQ(E2BIG, merr_errno(err));
+        if (i >= num_keys)
+            ASSERT_EQ(ECANCELED, merr_errno(err));
         else
             ASSERT_EQ(err, 0);
     }
 
+    ASSERT_EQ(num_keys, kvdb_ctxn_locks_count(locks_handle));
+
+    /* Locks already held must still be found. */
+    for (i = 0; i < num_keys; i += 7) {
+        err = kvdb_keylock_lock(klock_handle, locks_handle, magic | i, 0);
+        ASSERT_EQ(err, 0);
+    }
+
+    ASSERT_EQ(num_keys, kvdb_ctxn_locks_count(locks_handle));
+
     kvdb_keylock_release_locks(klock_handle, locks_handle);
+    ASSERT_EQ(0, kvdb_ctxn_locks_count(locks_handle));
+
+    kvdb_ctxn_locks_destroy(locks_handle);
+    kvdb_keylock_destroy(klock_handle);
+}
+
+MTF_DEFINE_UTEST_PREPOST(kvdb_keylock_test, keylock_prune_own_locks, mapi_pre, mapi_post)
+{
+    const int               num_keys = 4096;
+    struct kvdb_keylock *   klock_handle;
+    struct kvdb_ctxn_locks *locks_handle[2];
+    merr_t                  err;
+    u64                     magic = 0x12345678UL << 32;
+    u64                     end_seqno;
+    void *                  cookie;
+    int                     i;
+
+    atomic64_set(&kvdb_seq, 1000);
+
+    err = kvdb_keylock_create(&klock_handle, 16, 65536);
+    ASSERT_EQ(0, err);
+
+    err = kvdb_ctxn_locks_create(&locks_handle[0]);
+    ASSERT_EQ(0, err);
+
+    err = kvdb_ctxn_locks_create(&locks_handle[1]);
+    ASSERT_EQ(0, err);
+
+    /* The first transaction locks the odd keys and commits.
+     */
+    for (i = 1; i < num_keys; i += 2) {
+        err = kvdb_keylock_lock(klock_handle, locks_handle[0], magic | i, 0);
+        ASSERT_EQ(0, err);
+    }
+
+    kvdb_keylock_list_lock(klock_handle, &cookie);
+    end_ctxn(true, &end_seqno);
+    kvdb_keylock_queue_locks(locks_handle[0], end_seqno, cookie);
+    kvdb_keylock_list_unlock(cookie);
+
+    /* The second transaction starts after the first one ended, so it
+     * inherits the odd keys and locks the even keys.
+     */
+    for (i = 0; i < num_keys; i++) {
+        err = kvdb_keylock_lock(klock_handle, locks_handle[1], magic | i, end_seqno + 1);
+        ASSERT_EQ(0, err);
+    }
+
+    ASSERT_EQ(num_keys, kvdb_ctxn_locks_count(locks_handle[1]));
+
+    /* Aborting releases only the locks the transaction didn't inherit,
+     * and the inherited locks must remain findable.
+     */
+    kvdb_keylock_prune_own_locks(klock_handle, locks_handle[1]);
+    ASSERT_EQ(num_keys / 2, kvdb_ctxn_locks_count(locks_handle[1]));
+
+    for (i = 1; i < num_keys; i += 2) {
+        err = kvdb_keylock_lock(klock_handle, locks_handle[1], magic | i, end_seqno + 1);
+        ASSERT_EQ(0, err);
+    }
+
+    ASSERT_EQ(num_keys / 2, kvdb_ctxn_locks_count(locks_handle[1]));
+
+    kvdb_keylock_release_locks(klock_handle, locks_handle[1]);
+    kvdb_ctxn_locks_destroy(locks_handle[1]);
+    kvdb_keylock_destroy(klock_handle);
+}
+
+MTF_DEFINE_UTEST_PREPOST(kvdb_keylock_test, keylock_lock_perf, mapi_pre, mapi_post)
+{
+    const int               num_keys = 256 * 1024;
+    const int               iters = 4;
+    struct kvdb_keylock *   klock_handle;
+    struct kvdb_ctxn_locks *locks_handle;
+    u64                     tlock, trelock, trelease, t;
+    merr_t                  err;
+    int                     i, j;
+
+    err = kvdb_keylock_create(&klock_handle, 16, 65536);
+    ASSERT_EQ(0, err);
+
+    err = kvdb_ctxn_locks_create(&locks_handle);
+    ASSERT_EQ(0, err);
+
+    tlock = trelock = trelease = 0;
+
+    for (j = 0; j < iters; j++) {
+        t = get_time_ns();
+        for (i = 0; i < num_keys; i++) {
+            err = kvdb_keylock_lock(klock_handle, locks_handle, (i + 1) * 0x9e3779b97f4a7c15ul, 0);
+            ASSERT_EQ(0, err);
+        }
+        tlock += get_time_ns() - t;
+
+        /* Puts of keys already locked by the transaction. */
+        t = get_time_ns();
+        for (i = 0; i < num_keys; i++) {
+            err = kvdb_keylock_lock(klock_handle, locks_handle, (i + 1) * 0x9e3779b97f4a7c15ul, 0);
+            ASSERT_EQ(0, err);
+        }
+        trelock += get_time_ns() - t;
+
+        ASSERT_EQ(num_keys, kvdb_ctxn_locks_count(locks_handle));
+
+        t = get_time_ns();
+        kvdb_keylock_release_locks(klock_handle, locks_handle);
+        trelease += get_time_ns() - t;
+    }
+
+    printf(
+        "%s: %d keys/txn: lock %lu ns/key, relock %lu ns/key, release %lu ns/key\n",
+        __func__,
+        num_keys,
+        tlock / (iters * num_keys),
+        trelock / (iters * num_keys),
+        trelease / (iters * num_keys));
+
     kvdb_ctxn_locks_destroy(locks_handle);
     kvdb_keylock_destroy(klock_handle);
 }
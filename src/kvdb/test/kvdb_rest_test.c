@@ -115,6 +115,7 @@ _kvset_get_metrics(struct kvset *kvset, struct kvset_metrics *metrics)
     metrics->tot_val_bytes = 8000000;
     metrics->compc = 0;
     metrics->vgroups = 1;
+    metrics->heat = 100;
 }
 
 struct kvs_cparams cp;
@@ -349,6 +350,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, print_tree_test, test_pre, test_post)
                       "    vgroups: 1\n"
                       "    klen: 4000000\n"
                       "    vlen: 8000000\n"
+                      "    heat: 100\n"
                       "    nkblks: 1\n"
                       "    nvblks: 1\n"
                       "    kblks:\n"
@@ -361,6 +363,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, print_tree_test, test_pre, test_post)
                       "    ntombs: 0\n"
                       "    klen: 4000000\n"
                       "    vlen: 8000000\n"
+                      "    heat: 100\n"
                       "    nkvsets: 1\n"
                       "    nkblks: 1\n"
                       "    nvblks: 1\n"
@@ -373,6 +376,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, print_tree_test, test_pre, test_post)
                       "  ntombs: 0\n"
                       "  klen: 4000000\n"
                       "  vlen: 8000000\n"
+                      "  heat: 100\n"
                       "  nkvsets: 1\n"
                       "  nkblks: 1\n"
                       "  nvblks: 1\n"
@@ -413,6 +417,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, empty_root_test, test_pre, test_post)
                       "    ntombs: 0\n"
                       "    klen: 0\n"
                       "    vlen: 0\n"
+                      "    heat: 0\n"
                       "    nkvsets: 0\n"
                       "    nkblks: 0\n"
                       "    nvblks: 0\n"
@@ -428,6 +433,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, empty_root_test, test_pre, test_post)
                       "    vgroups: 1\n"
                       "    klen: 4000000\n"
                       "    vlen: 8000000\n"
+                      "    heat: 100\n"
                       "    nkblks: 1\n"
                       "    nvblks: 1\n"
                       "    kblks:\n"
@@ -440,6 +446,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, empty_root_test, test_pre, test_post)
                       "    ntombs: 0\n"
                       "    klen: 4000000\n"
                       "    vlen: 8000000\n"
+                      "    heat: 100\n"
                       "    nkvsets: 1\n"
                       "    nkblks: 1\n"
                       "    nvblks: 1\n"
@@ -452,6 +459,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, empty_root_test, test_pre, test_post)
                       "  ntombs: 0\n"
                       "  klen: 4000000\n"
                       "  vlen: 8000000\n"
+                      "  heat: 100\n"
                       "  nkvsets: 1\n"
                       "  nkblks: 1\n"
                       "  nvblks: 1\n"
@@ -503,6 +511,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, list_without_blkids, test_pre, test_post)
                       "    ntombs: 0\n"
                       "    klen: 0\n"
                       "    vlen: 0\n"
+                      "    heat: 0\n"
                       "    nkvsets: 0\n"
                       "    nkblks: 0\n"
                       "    nvblks: 0\n"
@@ -518,6 +527,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, list_without_blkids, test_pre, test_post)
                       "    vgroups: 1\n"
                       "    klen: 4000000\n"
                       "    vlen: 8000000\n"
+                      "    heat: 100\n"
                       "    nkblks: 1\n"
                       "    nvblks: 1\n"
                       "  - index: 1\n"
@@ -528,6 +538,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, list_without_blkids, test_pre, test_post)
                       "    vgroups: 1\n"
                       "    klen: 4000000\n"
                       "    vlen: 8000000\n"
+                      "    heat: 100\n"
                       "    nkblks: 1\n"
                       "    nvblks: 1\n"
                       "  info:\n"
@@ -536,6 +547,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, list_without_blkids, test_pre, test_post)
                       "    ntombs: 0\n"
                       "    klen: 8000000\n"
                       "    vlen: 16000000\n"
+                      "    heat: 200\n"
                       "    nkvsets: 2\n"
                       "    nkblks: 2\n"
                       "    nvblks: 2\n"
@@ -548,6 +560,7 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_rest, list_without_blkids, test_pre, test_post)
                       "  ntombs: 0\n"
                       "  klen: 8000000\n"
                       "  vlen: 16000000\n"
+                      "  heat: 200\n"
                       "  nkvsets: 2\n"
                       "  nkblks: 2\n"
                       "  nvblks: 2\n"
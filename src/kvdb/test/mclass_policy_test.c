@@ -148,4 +148,50 @@ MTF_DEFINE_UTEST_PRE(mclass_policy_test, mclass_policy_default, general_pre)
     hse_params_destroy(params);
 }
 
+MTF_DEFINE_UTEST_PRE(mclass_policy_test, mclass_policy_temp, general_pre)
+{
+    struct mclass_policy policy;
+    int                  i, j, k;
+
+    /* staging_max_capacity - only leaf values use capacity.
+     */
+    for (i = 0; i < HSE_MPOLICY_AGE_CNT; i++)
+        for (j = 0; j < HSE_MPOLICY_DTYPE_CNT; j++) {
+            policy.mc_table[i][j][0] = HSE_MPOLICY_MEDIA_STAGING;
+            policy.mc_table[i][j][1] = HSE_MPOLICY_MEDIA_INVALID;
+        }
+    policy.mc_table[HSE_MPOLICY_AGE_LEAF][HSE_MPOLICY_DTYPE_VALUE][0] = HSE_MPOLICY_MEDIA_CAPACITY;
+
+    /* No temperature, or keys (which only use staging), follow the policy */
+    for (i = 0; i < HSE_MPOLICY_AGE_CNT; i++)
+        for (k = 0; k < HSE_MPOLICY_MEDIA_CNT; k++) {
+            ASSERT_EQ(
+                mclass_policy_get_type(&policy, i, HSE_MPOLICY_DTYPE_VALUE, k),
+                mclass_policy_get_type_temp(
+                    &policy, i, HSE_MPOLICY_DTYPE_VALUE, HSE_MPOLICY_TEMP_NONE, k));
+            ASSERT_EQ(
+                mclass_policy_get_type(&policy, i, HSE_MPOLICY_DTYPE_KEY, k),
+                mclass_policy_get_type_temp(
+                    &policy, i, HSE_MPOLICY_DTYPE_KEY, HSE_MPOLICY_TEMP_COLD, k));
+        }
+
+    /* Hot leaf values are promoted, cold root values are demoted */
+    ASSERT_EQ(
+        MP_MED_STAGING,
+        mclass_policy_get_type_temp(
+            &policy, HSE_MPOLICY_AGE_LEAF, HSE_MPOLICY_DTYPE_VALUE, HSE_MPOLICY_TEMP_HOT, 0));
+    ASSERT_EQ(
+        MP_MED_CAPACITY,
+        mclass_policy_get_type_temp(
+            &policy, HSE_MPOLICY_AGE_LEAF, HSE_MPOLICY_DTYPE_VALUE, HSE_MPOLICY_TEMP_HOT, 1));
+    ASSERT_EQ(
+        MP_MED_CAPACITY,
+        mclass_policy_get_type_temp(
+            &policy, HSE_MPOLICY_AGE_ROOT, HSE_MPOLICY_DTYPE_VALUE, HSE_MPOLICY_TEMP_COLD, 0));
+    ASSERT_EQ(
+        MP_MED_STAGING,
+        mclass_policy_get_type_temp(
+            &policy, HSE_MPOLICY_AGE_ROOT, HSE_MPOLICY_DTYPE_VALUE, HSE_MPOLICY_TEMP_COLD, 1));
+}
+
 MTF_END_UTEST_COLLECTION(mclass_policy_test);
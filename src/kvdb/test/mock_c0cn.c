@@ -222,6 +222,12 @@ _c0_cursor_read(struct c0_cursor *cur, struct kvs_kvtuple *kvt, bool *eof)
     return 0;
 }
 
+static bool
+_c0_cursor_rtomb_covers(struct c0_cursor *cur, const void *key, u32 klen)
+{
+    return false;
+}
+
 static merr_t
 _c0_cursor_seek(
     struct c0_cursor * cur,
@@ -305,6 +311,18 @@ _cn_get(
     return 0;
 }
 
+static merr_t
+_cn_get_batch(
+    struct cn *          handle,
+    u32                  cnt,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv)
+{
+    return 0;
+}
+
 static merr_t
 _c0_del(struct c0 *handle, struct kvs_ktuple *kt, const uintptr_t seqno)
 {
@@ -539,6 +557,21 @@ _cn_cursor_active_kvsets(void *cursor, u32 *active, u32 *total)
     return 0;
 }
 
+static merr_t
+_cn_cursor_split(
+    struct cn * cn,
+    const void *prefix,
+    u32         pfx_len,
+    uint        splitmax,
+    void *      keybuf,
+    u32 *       klenv,
+    uint *      splitcp)
+{
+    *splitcp = 0;
+
+    return 0;
+}
+
 static merr_t
 _kvdb_log_replay(
     struct kvdb_log *log,
@@ -591,6 +624,7 @@ mock_cn_set()
     MOCK_SET(cn, _cn_open);
     MOCK_SET(cn, _cn_close);
     MOCK_SET(cn, _cn_get);
+    MOCK_SET(cn, _cn_get_batch);
     MOCK_SET(cn, _cn_ref_get);
     MOCK_SET(cn, _cn_ref_put);
     MOCK_SET(cn, _cn_hash_get);
@@ -603,6 +637,7 @@ mock_cn_set()
     MOCK_SET(cn_cursor, _cn_cursor_seek);
     MOCK_SET(cn_cursor, _cn_cursor_destroy);
     MOCK_SET(cn_cursor, _cn_cursor_active_kvsets);
+    MOCK_SET(cn_cursor, _cn_cursor_split);
 }
 
 void
@@ -618,6 +653,7 @@ mock_cn_unset()
     MOCK_UNSET(cn, _cn_open);
     MOCK_UNSET(cn, _cn_close);
     MOCK_UNSET(cn, _cn_get);
+    MOCK_UNSET(cn, _cn_get_batch);
     MOCK_UNSET(cn, _cn_ref_get);
     MOCK_UNSET(cn, _cn_ref_put);
     MOCK_UNSET(cn, _cn_hash_get);
@@ -630,6 +666,7 @@ mock_cn_unset()
     MOCK_UNSET(cn_cursor, _cn_cursor_seek);
     MOCK_UNSET(cn_cursor, _cn_cursor_destroy);
     MOCK_UNSET(cn_cursor, _cn_cursor_active_kvsets);
+    MOCK_UNSET(cn_cursor, _cn_cursor_split);
 }
 
 void
@@ -646,6 +683,7 @@ mock_c0_set()
     MOCK_SET(c0, _c0_cursor_update);
     MOCK_SET(c0, _c0_cursor_bind_txn);
     MOCK_SET(c0, _c0_cursor_read);
+    MOCK_SET(c0, _c0_cursor_rtomb_covers);
     MOCK_SET(c0, _c0_cursor_seek);
     MOCK_SET(c0, _c0_cursor_save);
     MOCK_SET(c0, _c0_cursor_restore);
@@ -667,6 +705,7 @@ mock_c0_unset()
     MOCK_UNSET(c0, _c0_cursor_bind_txn);
     MOCK_UNSET(c0, _c0_cursor_seek);
     MOCK_UNSET(c0, _c0_cursor_read);
+    MOCK_UNSET(c0, _c0_cursor_rtomb_covers);
     MOCK_UNSET(c0, _c0_cursor_save);
     MOCK_UNSET(c0, _c0_cursor_restore);
     MOCK_UNSET(c0, _c0_cursor_destroy);
@@ -144,6 +144,7 @@ void
 mock_c0skm_set(void)
 {
     mapi_inject(mapi_idx_c0skm_sync, 0);
+    mapi_inject(mapi_idx_c0skm_sync_op, 0);
     mapi_inject(mapi_idx_c0skm_open, 0);
     mapi_inject(mapi_idx_c0skm_close, 0);
 }
@@ -152,6 +153,7 @@ void
 mock_c0skm_unset(void)
 {
     mapi_inject_unset(mapi_idx_c0skm_sync);
+    mapi_inject_unset(mapi_idx_c0skm_sync_op);
     mapi_inject_unset(mapi_idx_c0skm_open);
     mapi_inject_unset(mapi_idx_c0skm_close);
 }
@@ -162,6 +164,12 @@ _c0skm_sync(struct c0sk *c0sk)
     return 0;
 }
 
+merr_t
+_c0skm_sync_op(struct c0sk *c0sk)
+{
+    return 0;
+}
+
 merr_t
 _c0skm_open(struct c0sk *c0sk, struct kvdb_rparams *rp, struct c1 *c1_handle, const char *mpname)
 {
@@ -177,6 +185,7 @@ merr_t
 create_mock_c0skm(struct c0sk *c0sk)
 {
     MOCK_SET(c0skm, _c0skm_sync);
+    MOCK_SET(c0skm, _c0skm_sync_op);
     MOCK_SET(c0skm, _c0skm_open);
     MOCK_SET(c0skm, _c0skm_close);
 
@@ -34,6 +34,7 @@
 #include <hse_ikvdb/cursor.h>
 
 #include "kvs_params.h"
+#include "kvs_gcache.h"
 
 struct mpool;
 
@@ -72,6 +73,10 @@ struct ikvs {
     struct perfc_set ikv_cc_pc;
     struct perfc_set ikv_cd_pc;
 
+    struct kvs_gcache *   ikv_gcache;
+    struct kvdb_ctxn_set *ikv_ctxn_set;
+    atomic64_t *          ikv_seqno;
+
     struct kvs_rparams ikv_rp;
 
     const char *ikv_kvs_name;
@@ -144,10 +149,12 @@ NE_CHECK(kvs_cd_perfc_op, PERFC_EN_CD, "cursor dist perfc ops table/enum mismatc
 struct perfc_name kvs_pkvsl_perfc_op[] = {
     NE(PERFC_LT_PKVSL_KVS_PUT, 3, "kvs_put latency", "kvs_put_lat", 7),
     NE(PERFC_LT_PKVSL_KVS_GET, 3, "kvs_get latency", "kvs_get_lat", 7),
+    NE(PERFC_LT_PKVSL_KVS_GET_BATCH, 3, "kvs_get_batch latency", "kvs_get_batch_lat", 7),
     NE(PERFC_LT_PKVSL_KVS_DEL, 3, "kvs_delete latency", "kvs_del_lat", 7),
 
     NE(PERFC_LT_PKVSL_KVS_PFX_PROBE, 3, "kvs_prefix_probe latency", "kvs_pfx_probe_lat"),
     NE(PERFC_LT_PKVSL_KVS_PFX_DEL, 3, "kvs_prefix_delete latency", "kvs_pfx_del_lat"),
+    NE(PERFC_LT_PKVSL_KVS_RANGE_DEL, 3, "kvs_range_delete latency", "kvs_range_del_lat"),
 
     NE(PERFC_LT_PKVSL_KVS_CURSOR_CREATE, 3, "kvs_cursor_create latency", "kvs_cursor_create_lat"),
     NE(PERFC_LT_PKVSL_KVS_CURSOR_UPDATE, 3, "kvs_cursor_update latency", "kvs_cursor_update_lat"),
@@ -160,6 +167,10 @@ struct perfc_name kvs_pkvsl_perfc_op[] = {
        3,
        "kvs_cursor_read reverse latency",
        "kvs_cursor_readrev_lat"),
+    NE(PERFC_LT_PKVSL_KVS_CURSOR_READ_BATCH,
+       3,
+       "kvs_cursor_read_batch latency",
+       "kvs_cursor_read_batch_lat"),
     NE(PERFC_LT_PKVSL_KVS_CURSOR_DESTROY,
        3,
        "kvs_cursor_destroy latency",
@@ -434,6 +445,15 @@ kvs_open(
 
     ikvdb_get_c1(kvdb, &ikvs->ikv_c1);
 
+    ikvs->ikv_ctxn_set = ikvdb_get_ctxn_set(kvdb);
+    ikvs->ikv_seqno = ikvdb_get_seqno_addr(kvdb);
+
+    if (ikvs->ikv_ctxn_set && ikvs->ikv_seqno) {
+        err = kvs_gcache_create(mp_name, kvs_name, ikvs->ikv_rp.kvs_gcache_sz, &ikvs->ikv_gcache);
+        if (ev(err))
+            goto err_exit;
+    }
+
     err = kvs_rparams_add_to_dt(mp_name, kvs_name, &ikvs->ikv_rp);
     if (ev(err))
         hse_log(HSE_WARNING "Unable to add run-time parameters"
@@ -521,6 +541,33 @@ ikvs_perfc_pkvsl(struct ikvs *ikvs)
     return NULL;
 }
 
+/* The get cache is keyed by the whole key, whereas the hash of a key
+ * in a suffixed kvs excludes the suffix.
+ */
+static __always_inline void
+ikvs_gcache_ktuple(struct ikvs *kvs, const struct kvs_ktuple *kt, struct kvs_ktuple *gkt)
+{
+    *gkt = *kt;
+
+    if (kvs->ikv_sfx_len)
+        gkt->kt_hash = key_hash64(kt->kt_data, kt->kt_len);
+}
+
+/* Transactional mutations needn't invalidate the get cache as entries
+ * are not used across a commit (see kvs_gcache_lookup()).
+ */
+static void
+ikvs_gcache_invalidate(struct ikvs *kvs, const struct kvs_ktuple *kt)
+{
+    struct kvs_ktuple gkt;
+
+    if (!kvs->ikv_gcache)
+        return;
+
+    ikvs_gcache_ktuple(kvs, kt, &gkt);
+    kvs_gcache_invalidate(kvs->ikv_gcache, &gkt, atomic64_read(kvs->ikv_seqno));
+}
+
 merr_t
 ikvs_put(
     struct ikvs *            kvs,
@@ -557,10 +604,13 @@ ikvs_put(
         return merr(EINVAL);
     }
 
-    if (unlikely(os && os->kop_txn))
+    if (unlikely(os && os->kop_txn)) {
         err = kvdb_ctxn_put(kvdb_ctxn_h2h(os->kop_txn), c0, kt, vt);
-    else
+    } else {
         err = c0_put(c0, kt, vt, seqno);
+        if (!err)
+            ikvs_gcache_invalidate(kvs, kt);
+    }
 
     perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_PUT, tstart);
 
@@ -579,10 +629,12 @@ ikvs_get(
     struct perfc_set *pkvsl_pc = ikvs_perfc_pkvsl(kvs);
     struct c0 *       c0 = kvs->ikv_c0;
     struct cn *       cn = kvs->ikv_cn;
-    struct kvdb_ctxn *ctxn;
-    size_t            hashlen;
-    u64               tstart;
-    merr_t            err;
+    struct kvs_gcache *gcache;
+    struct kvdb_ctxn * ctxn;
+    struct kvs_ktuple  gkt;
+    size_t             hashlen;
+    u64                tstart, gen;
+    merr_t             err;
 
     tstart = perfc_lat_start(pkvsl_pc);
 
@@ -591,6 +643,23 @@ ikvs_get(
 
     ctxn = (os && os->kop_txn) ? kvdb_ctxn_h2h(os->kop_txn) : 0;
 
+    /* Only non-transactional gets use the get cache, as a transaction's
+     * view includes its own uncommitted mutations.
+     */
+    gcache = ctxn ? NULL : kvs->ikv_gcache;
+    gen = 0;
+
+    if (gcache) {
+        u64 commit_sn = kvdb_ctxn_set_commit_sn(kvs->ikv_ctxn_set);
+
+        ikvs_gcache_ktuple(kvs, kt, &gkt);
+
+        if (kvs_gcache_lookup(gcache, &gkt, seqno, commit_sn, res, vbuf, &gen)) {
+            perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_GET, tstart);
+            return 0;
+        }
+    }
+
     if (!ctxn)
         err = c0_get(c0, kt, seqno, 0, res, vbuf);
     else
@@ -606,11 +675,76 @@ ikvs_get(
         err = cn_get(cn, kt, seqno, res, vbuf);
     }
 
+    if (gcache && !err)
+        kvs_gcache_insert(gcache, &gkt, seqno, gen, *res, vbuf);
+
     perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_GET, tstart);
 
     return err;
 }
 
+merr_t
+ikvs_get_batch(
+    struct ikvs *           kvs,
+    struct hse_kvdb_opspec *os,
+    u32                     cnt,
+    struct kvs_ktuple *     ktv,
+    u64                     seqno,
+    enum key_lookup_res *   resv,
+    struct kvs_buf *        vbufv)
+{
+    struct perfc_set *pkvsl_pc = ikvs_perfc_pkvsl(kvs);
+    struct c0 *       c0 = kvs->ikv_c0;
+    struct cn *       cn = kvs->ikv_cn;
+    struct kvdb_ctxn *ctxn;
+    u32               i, nmiss;
+    u64               tstart;
+    merr_t            err;
+
+    tstart = perfc_lat_start(pkvsl_pc);
+
+    ctxn = (os && os->kop_txn) ? kvdb_ctxn_h2h(os->kop_txn) : 0;
+
+    /* c0 is searched key by key.  Keys not resolved by c0 are then
+     * handed to cn as a single batch so that the tree is descended
+     * once for all of them.
+     */
+    nmiss = 0;
+
+    for (i = 0; i < cnt; ++i) {
+        struct kvs_ktuple *kt = ktv + i;
+
+        kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len - kvs->ikv_sfx_len);
+
+        if (!ctxn)
+            err = c0_get(c0, kt, seqno, 0, resv + i, vbufv + i);
+        else
+            err = kvdb_ctxn_get(ctxn, c0, cn, kt, resv + i, vbufv + i);
+
+        if (ev(err))
+            return err;
+
+        if (resv[i] == NOT_FOUND)
+            ++nmiss;
+    }
+
+    if (nmiss > 0) {
+        if (ctxn) {
+            err = kvdb_ctxn_get_view_seqno(ctxn, &seqno);
+            if (ev(err))
+                return err;
+        }
+
+        err = cn_get_batch(cn, cnt, ktv, seqno, resv, vbufv);
+        if (ev(err))
+            return err;
+    }
+
+    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_GET_BATCH, tstart);
+
+    return 0;
+}
+
 merr_t
 ikvs_del(struct ikvs *kvs, struct hse_kvdb_opspec *os, struct kvs_ktuple *kt, u64 seqno)
 {
@@ -644,10 +778,13 @@ ikvs_del(struct ikvs *kvs, struct hse_kvdb_opspec *os, struct kvs_ktuple *kt, u6
     if (os && os->kop_txn)
         ctxn = kvdb_ctxn_h2h(os->kop_txn);
 
-    if (!ctxn)
+    if (!ctxn) {
         err = c0_del(c0, kt, seqno);
-    else
+        if (!err)
+            ikvs_gcache_invalidate(kvs, kt);
+    } else {
         err = kvdb_ctxn_del(ctxn, c0, kt);
+    }
 
     perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_DEL, tstart);
 
@@ -670,16 +807,48 @@ ikvs_prefix_del(struct ikvs *kvs, struct hse_kvdb_opspec *os, struct kvs_ktuple
     if (os && os->kop_txn)
         ctxn = kvdb_ctxn_h2h(os->kop_txn);
 
-    if (!ctxn)
+    if (!ctxn) {
         err = c0_prefix_del(kvs->ikv_c0, kt, seqno);
-    else
+        if (!err && kvs->ikv_gcache)
+            kvs_gcache_purge(kvs->ikv_gcache, atomic64_read(kvs->ikv_seqno));
+    } else {
         err = kvdb_ctxn_prefix_del(ctxn, kvs->ikv_c0, kt);
+    }
 
     perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_PFX_DEL, tstart);
 
     return ev(err);
 }
 
+merr_t
+ikvs_range_del(
+    struct ikvs *           kvs,
+    struct hse_kvdb_opspec *os,
+    struct kvs_ktuple *     start,
+    struct kvs_ktuple *     end,
+    u64                     seqno)
+{
+    struct perfc_set *pkvsl_pc = ikvs_perfc_pkvsl(kvs);
+    u64               tstart;
+    merr_t            err;
+
+    /* Range tombstones are not (yet) supported by the transaction
+     * merge path, see c0sk_merge_impl().
+     */
+    if (ev(os && os->kop_txn))
+        return merr(ENOTSUP);
+
+    tstart = perfc_lat_start(pkvsl_pc);
+
+    err = c0_range_del(kvs->ikv_c0, start, end, seqno);
+    if (!err && kvs->ikv_gcache)
+        kvs_gcache_purge(kvs->ikv_gcache, atomic64_read(kvs->ikv_seqno));
+
+    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_RANGE_DEL, tstart);
+
+    return ev(err);
+}
+
 /*-  Prefix Probe -----------------------------------------------------*/
 
 merr_t
@@ -711,6 +880,7 @@ ikvs_pfx_probe(
 
     qctx.qtype = QUERY_PROBE_PFX;
     qctx.pos = qctx.ntombs = qctx.seen = 0;
+    qctx.rtombs = NULL;
 
     for (i = 0; i < TT_WIDTH; i++)
         qctx.tomb_tree[i] = RB_ROOT;
@@ -1995,6 +2165,11 @@ repeat:
 
         if (ev(merr_errno(err) == EAGAIN))
             perfc_inc(cc_pc, PERFC_BA_CC_EAGAIN_CN);
+
+        /* Keys in cN are older than every range tombstone in c0. */
+        if (!err && !eof && cursor->kci_c0cur &&
+            c0_cursor_rtomb_covers(cursor->kci_c0cur, key, klen))
+            goto repeat;
     }
 
     /* If we needed to seek, toss read key if it matches last and kci_toss is true */
@@ -2138,12 +2313,15 @@ ikvs_cursor_replenish(struct kvs_cursor_impl *cursor, bool *eofp)
     return 0;
 }
 
-merr_t
-ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *eofp)
+/*
+ * Merge the c0 and cn cursors to produce the next tuple.  On success and
+ * !eof, @oreadyp is the ready state before the tuple was consumed, which
+ * a caller may restore to return the same tuple from the next read.
+ */
+static merr_t
+ikvs_cursor_next(struct kvs_cursor_impl *cursor, struct kvs_kvtuple *kvt, bool *eofp, int *oreadyp)
 {
-    struct kvs_cursor_impl *cursor = (void *)handle;
-    int                     oready;
-    int                     rc;
+    int rc;
 
     if (ev(cursor->kci_err)) {
         if (ev(merr_errno(cursor->kci_err) != EAGAIN))
@@ -2177,7 +2355,7 @@ ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *e
     }
 
     cursor->kci_summary.util++;
-    oready = cursor->kci_ready;
+    *oreadyp = cursor->kci_ready;
 
     /*
      * If this cursor tracks a tombspan, note the key we need to seek the cn
@@ -2225,6 +2403,20 @@ ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *e
 
     *kvt = *cursor->kci_last;
 
+    return 0;
+}
+
+merr_t
+ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *eofp)
+{
+    struct kvs_cursor_impl *cursor = (void *)handle;
+    int                     oready;
+    merr_t                  err;
+
+    err = ikvs_cursor_next(cursor, kvt, eofp, &oready);
+    if (err || *eofp)
+        return err;
+
     /* see comments in seek; do not change data state if peek */
     if (cursor->kci_peek) {
         cursor->kci_peek = 0;
@@ -2234,6 +2426,70 @@ ikvs_cursor_read(struct hse_kvs_cursor *handle, struct kvs_kvtuple *kvt, bool *e
     return 0;
 }
 
+merr_t
+ikvs_cursor_read_batch(
+    struct hse_kvs_cursor *handle,
+    uint                   flags,
+    void *                 buf,
+    size_t                 buf_sz,
+    uint *                 countp,
+    size_t *               usedp,
+    bool *                 eofp)
+{
+    struct kvs_cursor_impl *cursor = (void *)handle;
+    struct kvs_kvtuple      kvt;
+    size_t                  used = 0;
+    uint                    count = 0;
+    bool                    novals;
+    merr_t                  err;
+
+    novals = flags & (HSE_KVS_CURSOR_READ_KEYS_ONLY | HSE_KVS_CURSOR_READ_VLEN_ONLY);
+
+    while (1) {
+        struct hse_kvs_cursor_rec *rec;
+        size_t                     recsz;
+        uint                       vlen;
+        int                        oready;
+
+        err = ikvs_cursor_next(cursor, &kvt, eofp, &oready);
+        if (ev(err) || *eofp)
+            break;
+
+        vlen = kvs_vtuple_vlen(&kvt.kvt_value);
+        recsz = HSE_KVS_CURSOR_REC_SIZE(kvt.kvt_key.kt_len, novals ? 0 : vlen);
+
+        if (recsz > buf_sz - used) {
+            /*
+             * Put the tuple back as seek does after its peek, so that
+             * the next read returns it and an update does not toss it.
+             */
+            cursor->kci_ready = oready;
+            cursor->kci_toss = 0;
+            cursor->kci_summary.util--;
+
+            if (count == 0)
+                used = recsz;
+            break;
+        }
+
+        rec = buf + used;
+        rec->kcr_klen = kvt.kvt_key.kt_len;
+        rec->kcr_vlen = (flags & HSE_KVS_CURSOR_READ_KEYS_ONLY) ? 0 : vlen;
+
+        memcpy(rec + 1, kvt.kvt_key.kt_data, kvt.kvt_key.kt_len);
+        if (!novals)
+            memcpy((char *)(rec + 1) + kvt.kvt_key.kt_len, kvt.kvt_value.vt_data, vlen);
+
+        used += recsz;
+        ++count;
+    }
+
+    *countp = count;
+    *usedp = used;
+
+    return err;
+}
+
 #undef bit_on
 
 static merr_t
@@ -2300,6 +2556,8 @@ kvs_destroy(struct ikvs *kvs)
         mutex_destroy(&kvs->ikv_curcachev[i].cca_lock);
     free_aligned(kvs->ikv_curcache_bktmem);
 
+    kvs_gcache_destroy(kvs->ikv_gcache);
+
     free((void *)kvs->ikv_mpool_name);
     free((void *)kvs->ikv_kvs_name);
     free_aligned(kvs);
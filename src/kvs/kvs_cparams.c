@@ -30,6 +30,10 @@ static struct param_inst  kvs_cp_table[] = {
         "first level to spill with full hash (0=root)"),
     PARAM_INST_U32_EXP(kvs_cp_ref.cp_kvs_ext01, "kvs_ext01", "kvs_ext01"),
     PARAM_INST_U32(kvs_cp_ref.cp_sfx_len, "sfx_len", "Key suffix length"),
+    PARAM_INST_U32_EXP(
+        kvs_cp_ref.cp_kblk_filter,
+        "kblk_filter",
+        "kblock filter type (0=block bloom, 1=binary fuse)"),
     PARAM_INST_END
 };
 
@@ -52,6 +56,7 @@ kvs_cparams_defaults(void)
                                   .cp_pfx_len = 0,
                                   .cp_pfx_pivot = 2, /* only used when pfx_len > 0 */
                                   .cp_kvs_ext01 = 0,
+                                  .cp_kblk_filter = 0,
                                   .cp_cpmagic = CPARAMS_MAGIC };
 
     return params;
@@ -140,6 +145,13 @@ kvs_cparams_validate(struct kvs_cparams *cparams)
         return EINVAL;
     }
 
+    if (cparams->cp_kblk_filter > 1) {
+        hse_log(
+            HSE_ERR "Invalid KVS kblock filter type (%u), must be 0 or 1",
+            cparams->cp_kblk_filter);
+        return EINVAL;
+    }
+
     return 0;
 }
 
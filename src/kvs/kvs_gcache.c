@@ -0,0 +1,477 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse/kvdb_perfc.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/atomic.h>
+#include <hse_util/data_tree.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/list.h>
+#include <hse_util/log2.h>
+#include <hse_util/minmax.h>
+#include <hse_util/perfc.h>
+#include <hse_util/spinlock.h>
+#include <hse_util/string.h>
+
+#include <hse_ikvdb/ikvdb.h>
+
+#include "kvs_gcache.h"
+
+/*
+ * The get cache is split into a fixed number of shards, each with its
+ * own lock, hash table, byte budget, and CLOCK ring, in the same manner
+ * as the cN value cache (see cn_vcache.c).  Entries are reference counted
+ * so that values are copied out without holding the shard lock.
+ *
+ * Each shard also maintains:
+ *
+ * gcs_gen:     Incremented by every invalidation.  A lookup that misses
+ *              returns the generation and the subsequent insert is
+ *              discarded if the generation has changed, as the result
+ *              may predate the mutation that caused the invalidation.
+ *
+ * gcs_inval_sn: The highest kvdb seqno observed by an invalidation.  A
+ *              get whose view was established before a mutation may not
+ *              see the mutation even though its lookup started after the
+ *              invalidation, so an insert is discarded if its view seqno
+ *              is below gcs_inval_sn.
+ */
+
+#define KVS_GCACHE_SHARDS_SHIFT  (4)
+#define KVS_GCACHE_SHARDS        (1u << KVS_GCACHE_SHARDS_SHIFT)
+#define KVS_GCACHE_SHARD_SZ_MIN  (256 * 1024)
+#define KVS_GCACHE_AVG_ENTSZ     (256)
+
+struct kvs_gcache_ent {
+    struct kvs_gcache_ent *gce_hnext;
+    struct list_head       gce_clink;
+    u64                    gce_hash;
+    u64                    gce_seqno;
+    atomic_t               gce_refcnt;
+    u32                    gce_klen;
+    u32                    gce_vlen;
+    u32                    gce_expiry;
+    u8                     gce_res;
+    bool                   gce_ref;
+    char                   gce_data[];
+};
+
+struct kvs_gcache_shard {
+    spinlock_t              gcs_lock;
+    size_t                  gcs_size;
+    size_t                  gcs_size_max;
+    u64                     gcs_gen;
+    u64                     gcs_inval_sn;
+    struct list_head        gcs_clock;
+    u64                     gcs_bktmask;
+    struct kvs_gcache_ent **gcs_bktv;
+} __aligned(SMP_CACHE_BYTES);
+
+struct kvs_gcache {
+    size_t                  gc_ent_max;
+    struct perfc_set        gc_pc;
+    struct kvs_gcache_shard gc_shardv[KVS_GCACHE_SHARDS];
+};
+
+struct perfc_name kvs_gcache_perfc[] = {
+    NE(PERFC_RA_KVSGCACHE_HIT, 2, "get cache hits", "c_hit(/s)"),
+    NE(PERFC_RA_KVSGCACHE_NHIT, 2, "get cache negative hits", "c_nhit(/s)"),
+    NE(PERFC_RA_KVSGCACHE_MISS, 2, "get cache misses", "c_mis(/s)"),
+    NE(PERFC_RA_KVSGCACHE_INSERT, 3, "get cache inserts", "c_ins(/s)"),
+    NE(PERFC_RA_KVSGCACHE_RACE, 3, "get cache inserts lost to mutations", "c_race(/s)"),
+    NE(PERFC_RA_KVSGCACHE_INVAL, 3, "get cache invalidations", "c_inval(/s)"),
+    NE(PERFC_RA_KVSGCACHE_EVICT, 3, "get cache evictions", "c_evict(/s)"),
+    NE(PERFC_BA_KVSGCACHE_SIZE, 3, "get cache size", "size(b)"),
+};
+
+NE_CHECK(kvs_gcache_perfc, PERFC_EN_KVSGCACHE, "kvs_gcache_perfc table/enum mismatch");
+
+static __always_inline struct kvs_gcache_shard *
+kvs_gcache_hash2shard(struct kvs_gcache *gc, u64 hash)
+{
+    return gc->gc_shardv + (hash >> (64 - KVS_GCACHE_SHARDS_SHIFT));
+}
+
+static __always_inline size_t
+kvs_gcache_ent_size(const struct kvs_gcache_ent *ent)
+{
+    return sizeof(*ent) + ent->gce_klen + ent->gce_vlen;
+}
+
+static __always_inline bool
+kvs_gcache_ent_match(const struct kvs_gcache_ent *ent, const struct kvs_ktuple *kt)
+{
+    return ent->gce_hash == kt->kt_hash && ent->gce_klen == kt->kt_len &&
+           !memcmp(ent->gce_data, kt->kt_data, kt->kt_len);
+}
+
+static void
+kvs_gcache_ent_put(struct kvs_gcache_ent *ent)
+{
+    if (atomic_dec_return(&ent->gce_refcnt) == 0)
+        free(ent);
+}
+
+/* Unlink the given entry from its hash chain and clock ring and move it
+ * to the given reap list.  Caller must hold the shard lock.
+ */
+static void
+kvs_gcache_unlink(
+    struct kvs_gcache *      gc,
+    struct kvs_gcache_shard *shard,
+    struct kvs_gcache_ent *  ent,
+    struct list_head *       reap)
+{
+    struct kvs_gcache_ent **pp;
+
+    pp = shard->gcs_bktv + (ent->gce_hash & shard->gcs_bktmask);
+
+    while (*pp != ent)
+        pp = &(*pp)->gce_hnext;
+
+    *pp = ent->gce_hnext;
+    list_del(&ent->gce_clink);
+    list_add_tail(&ent->gce_clink, reap);
+
+    shard->gcs_size -= kvs_gcache_ent_size(ent);
+    perfc_sub(&gc->gc_pc, PERFC_BA_KVSGCACHE_SIZE, kvs_gcache_ent_size(ent));
+}
+
+/* Advance the clock hand until an unreferenced entry is found and evict it
+ * onto the given reap list.  Caller must hold the shard lock.
+ */
+static void
+kvs_gcache_evict(struct kvs_gcache *gc, struct kvs_gcache_shard *shard, struct list_head *reap)
+{
+    struct kvs_gcache_ent *ent;
+
+    while ((ent = list_first_entry_or_null(&shard->gcs_clock, typeof(*ent), gce_clink))) {
+        if (ent->gce_ref) {
+            ent->gce_ref = false;
+            list_del(&ent->gce_clink);
+            list_add_tail(&ent->gce_clink, &shard->gcs_clock);
+            continue;
+        }
+
+        kvs_gcache_unlink(gc, shard, ent, reap);
+        perfc_inc(&gc->gc_pc, PERFC_RA_KVSGCACHE_EVICT);
+        break;
+    }
+}
+
+static void
+kvs_gcache_reap(struct list_head *reap)
+{
+    struct kvs_gcache_ent *ent, *next;
+
+    list_for_each_entry_safe(ent, next, reap, gce_clink)
+        kvs_gcache_ent_put(ent);
+}
+
+bool
+kvs_gcache_lookup(
+    struct kvs_gcache *      gc,
+    const struct kvs_ktuple *kt,
+    u64                      seqno,
+    u64                      commit_sn,
+    enum key_lookup_res *    res,
+    struct kvs_buf *         vbuf,
+    u64 *                    genp)
+{
+    struct kvs_gcache_shard *shard;
+    struct kvs_gcache_ent *  ent;
+    uint                     copylen;
+
+    if (!gc)
+        return false;
+
+    shard = kvs_gcache_hash2shard(gc, kt->kt_hash);
+
+    spin_lock(&shard->gcs_lock);
+    *genp = shard->gcs_gen;
+
+    for (ent = shard->gcs_bktv[kt->kt_hash & shard->gcs_bktmask]; ent; ent = ent->gce_hnext) {
+        if (kvs_gcache_ent_match(ent, kt))
+            break;
+    }
+
+    /* The entry is usable only if no transaction has committed between
+     * the entry's view and ours, and if it doesn't come from the future.
+     */
+    if (ent && (ent->gce_seqno > seqno || commit_sn > ent->gce_seqno))
+        ent = NULL;
+
+    /* An expired value must be looked up again, as it now reads as a
+     * tombstone.
+     */
+    if (ent && kvs_expired(ent->gce_expiry))
+        ent = NULL;
+
+    if (ent) {
+        ent->gce_ref = true;
+        atomic_inc(&ent->gce_refcnt);
+    }
+    spin_unlock(&shard->gcs_lock);
+
+    if (!ent) {
+        perfc_inc(&gc->gc_pc, PERFC_RA_KVSGCACHE_MISS);
+        return false;
+    }
+
+    *res = ent->gce_res;
+
+    if (*res == FOUND_VAL) {
+        vbuf->b_len = ent->gce_vlen;
+        vbuf->b_expiry = ent->gce_expiry;
+
+        copylen = min_t(uint, ent->gce_vlen, vbuf->b_buf_sz);
+        if (copylen > 0 && vbuf->b_buf)
+            memcpy(vbuf->b_buf, ent->gce_data + ent->gce_klen, copylen);
+
+        perfc_inc(&gc->gc_pc, PERFC_RA_KVSGCACHE_HIT);
+    } else {
+        perfc_inc(&gc->gc_pc, PERFC_RA_KVSGCACHE_NHIT);
+    }
+
+    kvs_gcache_ent_put(ent);
+
+    return true;
+}
+
+void
+kvs_gcache_insert(
+    struct kvs_gcache *      gc,
+    const struct kvs_ktuple *kt,
+    u64                      seqno,
+    u64                      gen,
+    enum key_lookup_res      res,
+    const struct kvs_buf *   vbuf)
+{
+    struct kvs_gcache_shard *shard;
+    struct kvs_gcache_ent *  ent, *dup, **pp;
+    struct list_head         reap;
+    uint                     vlen = 0;
+
+    if (!gc || res == FOUND_MULTIPLE)
+        return;
+
+    if (res == FOUND_VAL) {
+        vlen = vbuf->b_len;
+
+        /* Cache only values that were retrieved in full.
+         */
+        if (vlen > vbuf->b_buf_sz || (vlen > 0 && !vbuf->b_buf))
+            return;
+    }
+
+    if (sizeof(*ent) + kt->kt_len + vlen > gc->gc_ent_max)
+        return;
+
+    ent = malloc(sizeof(*ent) + kt->kt_len + vlen);
+    if (ev(!ent))
+        return;
+
+    ent->gce_hnext = NULL;
+    ent->gce_hash = kt->kt_hash;
+    ent->gce_seqno = seqno;
+    ent->gce_klen = kt->kt_len;
+    ent->gce_vlen = vlen;
+    ent->gce_expiry = res == FOUND_VAL ? vbuf->b_expiry : 0;
+    ent->gce_res = res;
+    ent->gce_ref = false;
+    atomic_set(&ent->gce_refcnt, 1);
+    memcpy(ent->gce_data, kt->kt_data, kt->kt_len);
+    if (vlen > 0)
+        memcpy(ent->gce_data + kt->kt_len, vbuf->b_buf, vlen);
+
+    shard = kvs_gcache_hash2shard(gc, kt->kt_hash);
+    pp = shard->gcs_bktv + (kt->kt_hash & shard->gcs_bktmask);
+
+    INIT_LIST_HEAD(&reap);
+
+    spin_lock(&shard->gcs_lock);
+    if (shard->gcs_gen != gen || seqno < shard->gcs_inval_sn) {
+        spin_unlock(&shard->gcs_lock);
+        perfc_inc(&gc->gc_pc, PERFC_RA_KVSGCACHE_RACE);
+        free(ent);
+        return;
+    }
+
+    for (dup = *pp; dup; dup = dup->gce_hnext) {
+        if (kvs_gcache_ent_match(dup, kt))
+            break;
+    }
+
+    /* Replace an existing entry only if ours is from a newer view.
+     */
+    if (dup && dup->gce_seqno < seqno) {
+        kvs_gcache_unlink(gc, shard, dup, &reap);
+        dup = NULL;
+    }
+
+    if (!dup) {
+        while (shard->gcs_size + kvs_gcache_ent_size(ent) > shard->gcs_size_max &&
+               !list_empty(&shard->gcs_clock))
+            kvs_gcache_evict(gc, shard, &reap);
+
+        ent->gce_hnext = *pp;
+        *pp = ent;
+        list_add_tail(&ent->gce_clink, &shard->gcs_clock);
+
+        shard->gcs_size += kvs_gcache_ent_size(ent);
+        perfc_add(&gc->gc_pc, PERFC_BA_KVSGCACHE_SIZE, kvs_gcache_ent_size(ent));
+        perfc_inc(&gc->gc_pc, PERFC_RA_KVSGCACHE_INSERT);
+        ent = NULL;
+    }
+    spin_unlock(&shard->gcs_lock);
+
+    kvs_gcache_reap(&reap);
+    free(ent);
+}
+
+void
+kvs_gcache_invalidate(struct kvs_gcache *gc, const struct kvs_ktuple *kt, u64 seqno)
+{
+    struct kvs_gcache_shard *shard;
+    struct kvs_gcache_ent *  ent;
+    struct list_head         reap;
+
+    if (!gc)
+        return;
+
+    shard = kvs_gcache_hash2shard(gc, kt->kt_hash);
+
+    INIT_LIST_HEAD(&reap);
+
+    spin_lock(&shard->gcs_lock);
+    shard->gcs_gen++;
+    shard->gcs_inval_sn = max_t(u64, shard->gcs_inval_sn, seqno);
+
+    for (ent = shard->gcs_bktv[kt->kt_hash & shard->gcs_bktmask]; ent; ent = ent->gce_hnext) {
+        if (kvs_gcache_ent_match(ent, kt)) {
+            kvs_gcache_unlink(gc, shard, ent, &reap);
+            break;
+        }
+    }
+    spin_unlock(&shard->gcs_lock);
+
+    kvs_gcache_reap(&reap);
+
+    perfc_inc(&gc->gc_pc, PERFC_RA_KVSGCACHE_INVAL);
+}
+
+void
+kvs_gcache_purge(struct kvs_gcache *gc, u64 seqno)
+{
+    struct kvs_gcache_ent *ent, *next;
+    struct list_head       reap;
+    uint                   i;
+
+    if (!gc)
+        return;
+
+    for (i = 0; i < KVS_GCACHE_SHARDS; i++) {
+        struct kvs_gcache_shard *shard = gc->gc_shardv + i;
+
+        INIT_LIST_HEAD(&reap);
+
+        spin_lock(&shard->gcs_lock);
+        shard->gcs_gen++;
+        shard->gcs_inval_sn = max_t(u64, shard->gcs_inval_sn, seqno);
+
+        list_for_each_entry_safe(ent, next, &shard->gcs_clock, gce_clink)
+            kvs_gcache_unlink(gc, shard, ent, &reap);
+        spin_unlock(&shard->gcs_lock);
+
+        kvs_gcache_reap(&reap);
+    }
+
+    perfc_inc(&gc->gc_pc, PERFC_RA_KVSGCACHE_INVAL);
+}
+
+merr_t
+kvs_gcache_create(
+    const char *        mp_name,
+    const char *        kvs_name,
+    size_t              size,
+    struct kvs_gcache **gcp)
+{
+    struct kvs_gcache *gc;
+    char               name[DT_PATH_COMP_ELEMENT_LEN];
+    size_t             shardsz, bktc;
+    uint               i;
+
+    *gcp = NULL;
+
+    if (size == 0)
+        return 0;
+
+    shardsz = max_t(size_t, size / KVS_GCACHE_SHARDS, KVS_GCACHE_SHARD_SZ_MIN);
+    bktc = roundup_pow_of_two(max_t(size_t, shardsz / KVS_GCACHE_AVG_ENTSZ, 64));
+
+    gc = alloc_aligned(sizeof(*gc), SMP_CACHE_BYTES);
+    if (ev(!gc))
+        return merr(ENOMEM);
+
+    memset(gc, 0, sizeof(*gc));
+
+    /* Don't let a single entry consume more than a fraction of a shard.
+     */
+    gc->gc_ent_max = shardsz / 8;
+
+    for (i = 0; i < KVS_GCACHE_SHARDS; i++) {
+        struct kvs_gcache_shard *shard = gc->gc_shardv + i;
+
+        shard->gcs_bktv = calloc(bktc, sizeof(*shard->gcs_bktv));
+        if (ev(!shard->gcs_bktv)) {
+            kvs_gcache_destroy(gc);
+            return merr(ENOMEM);
+        }
+
+        spin_lock_init(&shard->gcs_lock);
+        INIT_LIST_HEAD(&shard->gcs_clock);
+        shard->gcs_size_max = shardsz;
+        shard->gcs_bktmask = bktc - 1;
+    }
+
+    /* Not considered fatal if perfc fails */
+    snprintf(name, sizeof(name), "%s%s%s", mp_name, IKVDB_SUB_NAME_SEP, kvs_name);
+
+    perfc_ctrseti_alloc(
+        COMPNAME, name, kvs_gcache_perfc, PERFC_EN_KVSGCACHE, "gcache", &gc->gc_pc);
+
+    *gcp = gc;
+
+    return 0;
+}
+
+void
+kvs_gcache_destroy(struct kvs_gcache *gc)
+{
+    struct kvs_gcache_ent *ent, *next;
+    uint                   i;
+
+    if (!gc)
+        return;
+
+    for (i = 0; i < KVS_GCACHE_SHARDS; i++) {
+        struct kvs_gcache_shard *shard = gc->gc_shardv + i;
+
+        if (!shard->gcs_bktv)
+            continue;
+
+        list_for_each_entry_safe(ent, next, &shard->gcs_clock, gce_clink) {
+            assert(atomic_read(&ent->gce_refcnt) == 1);
+            free(ent);
+        }
+
+        free(shard->gcs_bktv);
+    }
+
+    perfc_ctrseti_free(&gc->gc_pc);
+    free_aligned(gc);
+}
@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_KVS_GCACHE_H
+#define HSE_KVS_KVS_GCACHE_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+
+#include <hse_ikvdb/tuple.h>
+
+struct kvs_gcache;
+
+/**
+ * kvs_gcache_create() - create a per-kvs point lookup result cache
+ * @mp_name:  mpool name (used to name the perf counter set)
+ * @kvs_name: kvs name (used to name the perf counter set)
+ * @size:     maximum number of bytes to cache (0 disables the cache)
+ * @gcp:      (output) cache handle, or NULL if disabled
+ *
+ * The get cache retains the results of non-transactional point gets,
+ * both values and negative results (not found or tombstone), keyed by
+ * the full key.  Each entry records the view seqno at which its result
+ * was obtained:
+ *
+ * - An entry may be used by a get whose view is at or above the entry's
+ *   seqno provided no transaction has committed since the entry's seqno
+ *   (see kvs_gcache_lookup()).
+ * - Non-transactional mutations invalidate the entries they affect
+ *   after the mutation is visible (see kvs_gcache_invalidate() and
+ *   kvs_gcache_purge()).
+ * - A fill is discarded if its shard was invalidated while the lookup
+ *   was in flight, or if the fill's view predates the invalidation.
+ * - A cached value whose expiry time (vbuf->b_expiry) has passed is
+ *   treated as a miss.
+ */
+merr_t
+kvs_gcache_create(
+    const char *        mp_name,
+    const char *        kvs_name,
+    size_t              size,
+    struct kvs_gcache **gcp);
+
+void
+kvs_gcache_destroy(struct kvs_gcache *gc);
+
+/**
+ * kvs_gcache_lookup() - retrieve a cached get result
+ * @gc:        cache handle (may be NULL)
+ * @kt:        key (kt_hash must be the hash of the full key)
+ * @seqno:     view seqno of the get
+ * @commit_sn: seqno of the most recent transaction commit
+ * @res:       (output) lookup result
+ * @vbuf:      (output) value, copied out as by c0_get() and cn_get()
+ * @genp:      (output) shard generation, to be passed to
+ *             kvs_gcache_insert() if the lookup misses
+ *
+ * Return: true if the result was served from the cache.
+ */
+bool
+kvs_gcache_lookup(
+    struct kvs_gcache *      gc,
+    const struct kvs_ktuple *kt,
+    u64                      seqno,
+    u64                      commit_sn,
+    enum key_lookup_res *    res,
+    struct kvs_buf *         vbuf,
+    u64 *                    genp);
+
+/**
+ * kvs_gcache_insert() - cache the result of a get that missed
+ * @gc:    cache handle (may be NULL)
+ * @kt:    key (kt_hash must be the hash of the full key)
+ * @seqno: view seqno at which the result was obtained
+ * @gen:   shard generation returned by kvs_gcache_lookup()
+ * @res:   lookup result
+ * @vbuf:  value buffer filled in by the lookup
+ *
+ * Insertion is best effort.  Found values are cached only if the lookup
+ * retrieved the whole value.
+ */
+void
+kvs_gcache_insert(
+    struct kvs_gcache *      gc,
+    const struct kvs_ktuple *kt,
+    u64                      seqno,
+    u64                      gen,
+    enum key_lookup_res      res,
+    const struct kvs_buf *   vbuf);
+
+/**
+ * kvs_gcache_invalidate() - discard the entry for a mutated key
+ * @gc:    cache handle (may be NULL)
+ * @kt:    key (kt_hash must be the hash of the full key)
+ * @seqno: current kvdb seqno, read after the mutation became visible
+ */
+void
+kvs_gcache_invalidate(struct kvs_gcache *gc, const struct kvs_ktuple *kt, u64 seqno);
+
+/**
+ * kvs_gcache_purge() - discard all entries (e.g., after a prefix delete)
+ * @gc:    cache handle (may be NULL)
+ * @seqno: current kvdb seqno, read after the mutation became visible
+ */
+void
+kvs_gcache_purge(struct kvs_gcache *gc, u64 seqno);
+
+#endif
@@ -11,6 +11,8 @@
 #include <hse_util/param.h>
 #include <hse_util/rest_api.h>
 
+#include <hse/hse_limits.h>
+
 #include <hse_ikvdb/kvs_rparams.h>
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/c0_kvset.h>
@@ -42,6 +44,7 @@ kvs_rparams_defaults(void)
 {
     struct kvs_rparams k = {
         .kvs_debug = 0,
+        .kvs_gcache_sz = 0,
 
         .cn_maint_disable = 0,
         .cn_diag_mode = 0,
@@ -50,6 +53,8 @@ kvs_rparams_defaults(void)
         .cn_bloom_prob = 10000,
         .cn_bloom_capped = 0,
         .cn_bloom_preload = 0,
+        .cn_bloom_pfx = 1,
+        .cn_bloom_pfx_len = 0,
 
         .cn_node_size_lo = 20 * 1024,
         .cn_node_size_hi = 28 * 1024,
@@ -83,7 +88,7 @@ kvs_rparams_defaults(void)
 #endif
 
         .cn_compaction_debug = 0,
-        .cn_io_threads = 13,
+        .cn_open_threads = 8,
         .cn_maint_delay = 100,
         .cn_close_wait = 0,
 
@@ -107,6 +112,7 @@ kvs_rparams_defaults(void)
         .mclass_policy = "capacity_only",
 
         .vcompmin = CN_SMALL_VALUE_THRESHOLD,
+        .vcomplvl = 0,
         .value_compression = VCOMP_PARAM_NONE,
 
         .rpmagic = RPARAMS_MAGIC,
@@ -118,6 +124,7 @@ kvs_rparams_defaults(void)
 static struct kvs_rparams kvs_rp_ref;
 static struct param_inst  kvs_rp_table[] = {
     KVS_PARAM_EXP(kvs_debug, "enable kvs debugging"),
+    KVS_PARAM_EXP(kvs_gcache_sz, "get result cache size (bytes, 0:disabled)"),
 
     KVS_PARAM_EXP(c0_cursor_ttl, "cached c0 cursor time-to-live (ms)"),
 
@@ -167,10 +174,12 @@ static struct param_inst  kvs_rp_table[] = {
     KVS_PARAM_EXP(cn_bloom_prob, "bloom create probability"),
     KVS_PARAM_EXP(cn_bloom_capped, "bloom create probability (capped kvs)"),
     KVS_PARAM_EXP(cn_bloom_preload, "preload mcache bloom filters"),
+    KVS_PARAM_EXP(cn_bloom_pfx, "add key prefixes to bloom filters"),
+    KVS_PARAM_EXP(cn_bloom_pfx_len, "bloom key prefix length (0:kvs pfx_len)"),
 
     KVS_PARAM_EXP(cn_compaction_debug, "cn compaction debug flags"),
     KVS_PARAM_EXP(cn_maint_delay, "ms of delay between checks when idle"),
-    KVS_PARAM_EXP(cn_io_threads, "number of cn mblock i/o threads"),
+    KVS_PARAM_EXP(cn_open_threads, "max threads creating kvsets at open (1 is serial)"),
     KVS_PARAM_EXP(
         cn_close_wait,
         "force close to wait until all active"
@@ -196,7 +205,8 @@ static struct param_inst  kvs_rp_table[] = {
     KVS_PARAM_STR(mclass_policy, "media class policy name"),
 
     KVS_PARAM_EXP(vcompmin, "value length above which compression is considered"),
-    KVS_PARAM_STR(value_compression, "value compression algorithm (lz4 or none)"),
+    KVS_PARAM_EXP(vcomplvl, "value compression level (0 for codec default)"),
+    KVS_PARAM_STR(value_compression, "value compression algorithm (lz4, zstd or none)"),
 
     PARAM_INST_END
 };
@@ -299,6 +309,14 @@ kvs_rparams_validate(struct kvs_rparams *params)
         return merr(EINVAL);
     }
 
+    if (params->cn_bloom_pfx_len > HSE_KVS_MAX_PFXLEN) {
+        hse_log(
+            HSE_ERR "cn_bloom_pfx_len(%lu) cannot be greater than %u",
+            (ulong)params->cn_bloom_pfx_len,
+            HSE_KVS_MAX_PFXLEN);
+        return merr(EINVAL);
+    }
+
     if (params->cn_maint_delay < 20) {
         hse_log(HSE_ERR "cn_maint_delay must be greater than 20ms");
         return merr(EINVAL);
@@ -353,6 +371,11 @@ kvs_rparams_validate(struct kvs_rparams *params)
         return merr(EINVAL);
     }
 
+    if (!vcomp_param_level_valid(params)) {
+        hse_log(HSE_ERR "invalid setting %lu for vcomplvl", params->vcomplvl);
+        return merr(EINVAL);
+    }
+
     return 0;
 }
 
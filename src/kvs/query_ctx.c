@@ -12,6 +12,7 @@
 #include <hse_util/event_counter.h>
 
 #include <hse_ikvdb/query_ctx.h>
+#include <hse_ikvdb/rtomb.h>
 
 pthread_key_t tomb_thread_key;
 
@@ -51,11 +52,10 @@ qctx_thread_dtor(void *mem)
     free(tem);
 }
 
-static struct tomb_elem *
-alloc_tomb_mem(struct query_ctx *qctx, size_t bytes)
+static void *
+alloc_tomb_mem(struct query_ctx *qctx, size_t sz)
 {
-    struct tomb_elem *  te;
-    size_t              sz = sizeof(*te) + bytes;
+    void *              te;
     struct te_mem *     ptr;
     struct te_page_hdr *hdr;
     unsigned int        min_offset = (sizeof(*hdr) + 0x0f) & (~0x0e);
@@ -178,7 +178,7 @@ qctx_tomb_insert(struct query_ctx *qctx, const void *sfx, size_t sfx_len)
     } else {
         struct tomb_elem *te;
 
-        te = alloc_tomb_mem(qctx, sfx_len);
+        te = alloc_tomb_mem(qctx, sizeof(*te) + sfx_len);
         if (ev(!te))
             return merr(ENOMEM);
 
@@ -230,6 +230,58 @@ qctx_tomb_seen(struct query_ctx *qctx, const void *sfx, size_t sfx_len)
     return false;
 }
 
+merr_t
+qctx_rtombs_add(
+    struct query_ctx *  qctx,
+    const struct rtomb *head,
+    int                 skidx,
+    const void *        pfx,
+    size_t              pfx_len,
+    u64                 view)
+{
+    const struct rtomb *rt;
+
+    /* The rtombs are copied out of c0/cN, as the c0 lists may be freed
+     * once the probe leaves the rcu read-side critical section.  They
+     * share the per-thread page pool with the tomb elems.
+     */
+    for (rt = head; rt; rt = rt->rt_next) {
+        struct rtomb *copy;
+        size_t        sz;
+
+        if (rt->rt_seq > view)
+            continue;
+
+        if (skidx >= 0 && rt->rt_skidx != skidx)
+            continue;
+
+        if (!rtomb_overlaps_pfx(rt, pfx, pfx_len))
+            continue;
+
+        sz = rtomb_size(rt->rt_slen, rt->rt_elen);
+
+        copy = alloc_tomb_mem(qctx, sz);
+        if (ev(!copy))
+            return merr(ENOMEM);
+
+        memcpy(copy, rt, sz);
+        copy->rt_mnext = NULL;
+        copy->rt_next = qctx->rtombs;
+        qctx->rtombs = copy;
+    }
+
+    return 0;
+}
+
+u64
+qctx_rtomb_seq(struct query_ctx *qctx, const void *key, size_t klen)
+{
+    if (!qctx->rtombs)
+        return 0;
+
+    return rtomb_list_seq(qctx->rtombs, -1, key, klen, U64_MAX);
+}
+
 merr_t
 qctx_te_mem_init(void)
 {
@@ -0,0 +1,247 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_ut/framework.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/hash.h>
+
+#include "../kvs_gcache.h"
+
+static void
+ktuple_init(struct kvs_ktuple *kt, const char *key)
+{
+    kvs_ktuple_init_nohash(kt, key, strlen(key));
+    kt->kt_hash = hse_hash64(kt->kt_data, kt->kt_len);
+}
+
+MTF_BEGIN_UTEST_COLLECTION(kvs_gcache_test);
+
+MTF_DEFINE_UTEST(kvs_gcache_test, disabled)
+{
+    struct kvs_gcache * gc;
+    struct kvs_ktuple   kt;
+    struct kvs_buf      vbuf;
+    enum key_lookup_res res;
+    char                buf[16];
+    merr_t              err;
+    u64                 gen;
+
+    err = kvs_gcache_create("gctest", "kvs", 0, &gc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(NULL, gc);
+
+    ktuple_init(&kt, "abc");
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
+
+    /* All interfaces must tolerate a disabled (NULL) cache */
+    kvs_gcache_insert(gc, &kt, 1, 0, NOT_FOUND, &vbuf);
+    ASSERT_FALSE(kvs_gcache_lookup(gc, &kt, 1, 0, &res, &vbuf, &gen));
+    kvs_gcache_invalidate(gc, &kt, 1);
+    kvs_gcache_purge(gc, 1);
+    kvs_gcache_destroy(gc);
+}
+
+MTF_DEFINE_UTEST(kvs_gcache_test, insert_lookup)
+{
+    struct kvs_gcache * gc;
+    struct kvs_ktuple   kt, nkt;
+    struct kvs_buf      vbuf;
+    enum key_lookup_res res;
+    char                val[64], buf[64];
+    merr_t              err;
+    u64                 gen;
+    bool                hit;
+
+    err = kvs_gcache_create("gctest", "kvs", 4 << 20, &gc);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, gc);
+
+    ktuple_init(&kt, "key");
+    ktuple_init(&nkt, "nokey");
+    memset(val, 'v', sizeof(val));
+
+    hit = kvs_gcache_lookup(gc, &kt, 10, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+
+    kvs_buf_init(&vbuf, val, sizeof(val));
+    vbuf.b_len = sizeof(val);
+    kvs_gcache_insert(gc, &kt, 10, gen, FOUND_VAL, &vbuf);
+
+    hit = kvs_gcache_lookup(gc, &nkt, 10, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+    kvs_gcache_insert(gc, &nkt, 10, gen, NOT_FOUND, &vbuf);
+
+    /* Positive hit, full and truncated copy out */
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
+    hit = kvs_gcache_lookup(gc, &kt, 12, 0, &res, &vbuf, &gen);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(FOUND_VAL, res);
+    ASSERT_EQ(sizeof(val), vbuf.b_len);
+    ASSERT_EQ(0, memcmp(val, buf, sizeof(val)));
+
+    kvs_buf_init(&vbuf, buf, 8);
+    hit = kvs_gcache_lookup(gc, &kt, 12, 0, &res, &vbuf, &gen);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(sizeof(val), vbuf.b_len);
+
+    /* Negative hit */
+    hit = kvs_gcache_lookup(gc, &nkt, 10, 0, &res, &vbuf, &gen);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(NOT_FOUND, res);
+
+    /* Views older than the entry, or after a commit, must miss */
+    hit = kvs_gcache_lookup(gc, &kt, 9, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+    hit = kvs_gcache_lookup(gc, &kt, 12, 11, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+
+    /* A truncated value must not be cached */
+    kvs_gcache_invalidate(gc, &kt, 10);
+    hit = kvs_gcache_lookup(gc, &kt, 12, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+
+    kvs_buf_init(&vbuf, val, 8);
+    vbuf.b_len = sizeof(val);
+    kvs_gcache_insert(gc, &kt, 12, gen, FOUND_VAL, &vbuf);
+    hit = kvs_gcache_lookup(gc, &kt, 12, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+
+    /* Purge discards everything */
+    hit = kvs_gcache_lookup(gc, &nkt, 12, 0, &res, &vbuf, &gen);
+    ASSERT_TRUE(hit);
+    kvs_gcache_purge(gc, 12);
+    hit = kvs_gcache_lookup(gc, &nkt, 12, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+
+    kvs_gcache_destroy(gc);
+}
+
+MTF_DEFINE_UTEST(kvs_gcache_test, insert_races)
+{
+    struct kvs_gcache * gc;
+    struct kvs_ktuple   kt;
+    struct kvs_buf      vbuf;
+    enum key_lookup_res res;
+    merr_t              err;
+    u64                 gen;
+    bool                hit;
+
+    err = kvs_gcache_create("gctest", "kvs", 4 << 20, &gc);
+    ASSERT_EQ(0, err);
+
+    ktuple_init(&kt, "key");
+    kvs_buf_init(&vbuf, NULL, 0);
+
+    /* An invalidation while the lookup is in flight voids the fill */
+    hit = kvs_gcache_lookup(gc, &kt, 10, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+    kvs_gcache_invalidate(gc, &kt, 10);
+    kvs_gcache_insert(gc, &kt, 10, gen, NOT_FOUND, &vbuf);
+    hit = kvs_gcache_lookup(gc, &kt, 10, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+
+    /* As does a view that predates an invalidation */
+    kvs_gcache_invalidate(gc, &kt, 20);
+    hit = kvs_gcache_lookup(gc, &kt, 15, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+    kvs_gcache_insert(gc, &kt, 15, gen, NOT_FOUND, &vbuf);
+    hit = kvs_gcache_lookup(gc, &kt, 20, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+
+    kvs_gcache_insert(gc, &kt, 20, gen, FOUND_TMB, &vbuf);
+    hit = kvs_gcache_lookup(gc, &kt, 20, 0, &res, &vbuf, &gen);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(FOUND_TMB, res);
+
+    kvs_gcache_destroy(gc);
+}
+
+MTF_DEFINE_UTEST(kvs_gcache_test, expiry)
+{
+    struct kvs_gcache * gc;
+    struct kvs_ktuple   kt;
+    struct kvs_buf      vbuf;
+    enum key_lookup_res res;
+    char                val[16];
+    merr_t              err;
+    u64                 gen;
+    bool                hit;
+
+    err = kvs_gcache_create("gctest", "kvs", 4 << 20, &gc);
+    ASSERT_EQ(0, err);
+
+    ktuple_init(&kt, "key");
+    memset(val, 'v', sizeof(val));
+
+    /* A value that has not expired yet is served from the cache */
+    kvs_gcache_lookup(gc, &kt, 10, 0, &res, &vbuf, &gen);
+    kvs_buf_init(&vbuf, val, sizeof(val));
+    vbuf.b_len = sizeof(val);
+    vbuf.b_expiry = U32_MAX;
+    kvs_gcache_insert(gc, &kt, 10, gen, FOUND_VAL, &vbuf);
+
+    kvs_buf_init(&vbuf, NULL, 0);
+    hit = kvs_gcache_lookup(gc, &kt, 10, 0, &res, &vbuf, &gen);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(FOUND_VAL, res);
+    ASSERT_EQ(U32_MAX, vbuf.b_expiry);
+
+    /* An expired value misses */
+    kvs_gcache_invalidate(gc, &kt, 10);
+    kvs_gcache_lookup(gc, &kt, 11, 0, &res, &vbuf, &gen);
+    kvs_buf_init(&vbuf, val, sizeof(val));
+    vbuf.b_len = sizeof(val);
+    vbuf.b_expiry = 1;
+    kvs_gcache_insert(gc, &kt, 11, gen, FOUND_VAL, &vbuf);
+
+    hit = kvs_gcache_lookup(gc, &kt, 11, 0, &res, &vbuf, &gen);
+    ASSERT_FALSE(hit);
+
+    kvs_gcache_destroy(gc);
+}
+
+MTF_DEFINE_UTEST(kvs_gcache_test, evict)
+{
+    struct kvs_gcache * gc;
+    struct kvs_ktuple   kt;
+    struct kvs_buf      vbuf;
+    enum key_lookup_res res;
+    char                key[32], val[4096];
+    merr_t              err;
+    u64                 gen;
+    int                 i, hits;
+
+    err = kvs_gcache_create("gctest", "kvs", 4 << 20, &gc);
+    ASSERT_EQ(0, err);
+
+    memset(val, 'v', sizeof(val));
+
+    for (i = 0; i < 4096; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        ktuple_init(&kt, key);
+
+        kvs_gcache_lookup(gc, &kt, 1, 0, &res, &vbuf, &gen);
+        kvs_buf_init(&vbuf, val, sizeof(val));
+        vbuf.b_len = sizeof(val);
+        kvs_gcache_insert(gc, &kt, 1, gen, FOUND_VAL, &vbuf);
+    }
+
+    /* 16MiB of values were inserted into a 4MiB cache */
+    for (i = hits = 0; i < 4096; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        ktuple_init(&kt, key);
+
+        kvs_buf_init(&vbuf, NULL, 0);
+        hits += kvs_gcache_lookup(gc, &kt, 1, 0, &res, &vbuf, &gen);
+    }
+
+    ASSERT_GT(hits, 0);
+    ASSERT_LE(hits, (4 << 20) / sizeof(val));
+
+    kvs_gcache_destroy(gc);
+}
+
+MTF_END_UTEST_COLLECTION(kvs_gcache_test)
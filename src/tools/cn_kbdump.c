@@ -207,6 +207,19 @@ print_kblk(struct blk *blk)
         omf_kbh_blm_hlen(p),
         omf_kbh_blm_doff_pg(p),
         omf_kbh_blm_dlen_pg(p));
+    if (omf_kbh_version(p) > KBLOCK_HDR_VERSION5)
+        printf(
+            "    rt: data_pg %d %d  cnt %d\n",
+            omf_kbh_rt_doff_pg(p),
+            omf_kbh_rt_dlen_pg(p),
+            omf_kbh_rt_cnt(p));
+    if (omf_kbh_version(p) > KBLOCK_HDR_VERSION6)
+        printf(
+            "    exp: cnt %u vlen %u min %u max %u\n",
+            omf_kbh_exp_cnt(p),
+            omf_kbh_exp_vlen(p),
+            omf_kbh_exp_min(p),
+            omf_kbh_exp_max(p));
     printf("    kmd: start_pg %u\n", omf_kbh_wbt_doff_pg(p) + omf_wbt_root(wbt_hdr) + 1);
     printf(
         "    keymin: off %u len %u key %s\n",
@@ -270,6 +283,21 @@ print_blm(struct blk *blk)
 
     hdr = off2addr(blk->buf, omf_kbh_blm_hoff(kblk));
 
+    if (omf_bh_version(hdr) > BLOOM_OMF_VERSION4 && omf_bh_type(hdr) == BLOOM_OMF_TYPE_FUSE) {
+        printf(
+            "    blmhdr: magic 0x%08x  ver %u  fuse  fpbits %u  seglen %u  segcnt %u"
+            "  seed 0x%lx  datasz %u  pfx_len %u\n",
+            omf_bh_magic(hdr),
+            omf_bh_version(hdr),
+            omf_bh_fpbits(hdr),
+            omf_bh_seglen(hdr),
+            omf_bh_segcnt(hdr),
+            (ulong)omf_bh_seed(hdr),
+            omf_bh_bitmapsz(hdr),
+            omf_bh_pfx_len(hdr));
+        return;
+    }
+
     bktsz = (1u << omf_bh_bktshift(hdr)) >> BYTE_SHIFT;
     if (bh_bktsz > 0)
         bktsz = bh_bktsz;
@@ -277,14 +305,15 @@ print_blm(struct blk *blk)
 
     printf(
         "    blmhdr: magic 0x%08x  ver %u"
-        "  bktsz %lu  rotl %u  hashes %u  bitmapsz %u  modulus %u\n",
+        "  bktsz %lu  rotl %u  hashes %u  bitmapsz %u  modulus %u  pfx_len %u\n",
         omf_bh_magic(hdr),
         omf_bh_version(hdr),
         bktsz,
         omf_bh_rotl(hdr),
         omf_bh_n_hashes(hdr),
         omf_bh_bitmapsz(hdr),
-        omf_bh_modulus(hdr));
+        omf_bh_modulus(hdr),
+        omf_bh_pfx_len(hdr));
 
     doff = omf_kbh_blm_doff_pg(kblk) * PAGE_SIZE;
     dlen = omf_kbh_blm_dlen_pg(kblk) * PAGE_SIZE;
@@ -419,7 +448,7 @@ static bool
 val_get_next(void *kmd, size_t *off, struct kmd_vref *vref)
 {
     const void *vdata;
-    u32         vlen;
+    u32         vlen, codec;
 
     vref->vbidx = vref->vboff = vref->vlen = 0;
 
@@ -441,6 +470,24 @@ val_get_next(void *kmd, size_t *off, struct kmd_vref *vref)
                 vref->vboff,
                 vref->vlen);
             break;
+        case vtype_cval:
+        case vtype_ccval:
+            /* vref->vlen is the on-media (compressed) length */
+            codec = 0;
+            if (vref->vtype == vtype_ccval)
+                kmd_ccval(kmd, off, &vref->vbidx, &vref->vboff, &vlen, &vref->vlen, &codec);
+            else
+                kmd_cval(kmd, off, &vref->vbidx, &vref->vboff, &vlen, &vref->vlen);
+            snprintf(
+                vref->vinfo,
+                sizeof(vref->vinfo),
+                "type=cv %u/%u/%u ulen %u codec %u",
+                vref->vbidx,
+                vref->vboff,
+                vref->vlen,
+                vlen,
+                codec);
+            break;
         case vtype_ival:
             kmd_ival(kmd, off, &vdata, &vlen);
             snprintf(vref->vinfo, sizeof(vref->vinfo), "type=iv %u", vlen);
@@ -663,6 +710,8 @@ void
 print_wbt(void *wbt_hdr, void *kblk, bool ptomb)
 {
     switch (wbt_hdr_version(wbt_hdr)) {
+        case WBT_TREE_VERSION8:
+        case WBT_TREE_VERSION7:
         case WBT_TREE_VERSION6:
         case WBT_TREE_VERSION5:
         case WBT_TREE_VERSION4:
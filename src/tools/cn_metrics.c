@@ -310,6 +310,7 @@ rollup(struct rollup *from, struct rollup *to)
     to->km.tot_wbt_pages += from->km.tot_wbt_pages;
     to->km.tot_blm_pages += from->km.tot_blm_pages;
     to->km.tot_blm_pages += from->km.tot_blm_pages;
+    to->km.heat += from->km.heat;
 
     to->loc.node_level = max(to->loc.node_level, from->loc.node_level);
     to->loc.node_offset = max(to->loc.node_offset, from->loc.node_offset);
@@ -349,20 +350,21 @@ print_ids(
         printf(" ...");
 }
 
-const char *hdrv[] = { "H",       "Loc",     "Dgen",   "Keys",   "Tombs",
-                       "AvgKlen", "AvgVlen", "KbAlen", "VbAlen", "KbWlen%",
-                       "VbWlen%", "VbUlen%", "Comps",  "Kbs",    "Vbs" };
+const char *hdrv[] = { "H",       "Loc",     "Dgen",    "Keys",    "Tombs",
+                       "AvgKlen", "AvgVlen", "KbAlen",  "VbAlen",  "Heat",
+                       "KbWlen%", "VbWlen%", "VbUlen%", "Comps",   "Kbs",
+                       "Vbs" };
 
-#define FMT_HDR                \
-    "%s %-12s %5s "            \
-    "%*s %*s %*s %*s %*s %*s " \
-    "%7s %7s %7s "             \
+#define FMT_HDR                    \
+    "%s %-12s %5s "                \
+    "%*s %*s %*s %*s %*s %*s %*s " \
+    "%7s %7s %7s "                 \
     "%5s %4s %4s"
 
-#define FMT_ROW                \
-    "%s %-12s %5lu "           \
-    "%*s %*s %*s %*s %*s %*s " \
-    "%7.1f %7.1f %7.1f "       \
+#define FMT_ROW                    \
+    "%s %-12s %5lu "               \
+    "%*s %*s %*s %*s %*s %*s %*s " \
+    "%7.1f %7.1f %7.1f "           \
     "%5u %4u %4u%s"
 
 #define BN(_buf, _val) bn64((_buf), sizeof((_buf)), opt.bnfmt, (_val))
@@ -383,6 +385,8 @@ print_row(char *tag, struct rollup *r, uint index, char *sep)
     char avg_klen[BIGNUM_BUFSZ];
     char avg_vlen[BIGNUM_BUFSZ];
 
+    char heat[BIGNUM_BUFSZ];
+
     sprintf(locbuf, opt.loc_fmt, r->loc.node_level, r->loc.node_offset, index);
 
     BN(nkeys, r->ks.kst_keys);
@@ -394,6 +398,8 @@ print_row(char *tag, struct rollup *r, uint index, char *sep)
     BN(avg_klen, DIVZ(r->km.tot_key_bytes, r->km.num_keys));
     BN(avg_vlen, DIVZ(r->km.tot_val_bytes, r->km.num_keys));
 
+    BN(heat, r->km.heat);
+
     printf(
         FMT_ROW,
         tag,
@@ -411,6 +417,8 @@ print_row(char *tag, struct rollup *r, uint index, char *sep)
         kalen,
         opt.bnfw,
         valen,
+        opt.bnfw,
+        heat,
         DIVZ(100.0 * r->ks.kst_kwlen, r->ks.kst_kalen),
         DIVZ(100.0 * r->ks.kst_vwlen, r->ks.kst_valen),
         DIVZ(100.0 * r->ks.kst_vulen, r->ks.kst_valen),
@@ -440,12 +448,14 @@ print_hdr(void)
         hdrv[7],
         opt.bnfw,
         hdrv[8],
+        opt.bnfw,
         hdrv[9],
         hdrv[10],
         hdrv[11],
         hdrv[12],
         hdrv[13],
         hdrv[14],
+        hdrv[15],
         (opt.nodes_only ? "" : " KblockIDs  / VblockIDs"));
 }
 
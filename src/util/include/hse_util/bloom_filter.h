@@ -107,19 +107,22 @@ bf_hash2bit(u64 *hashp, u32 rotl, u32 mask)
 }
 
 /**
- * bf_lookup() - check to see if hash is in bloom bucket
+ * bf_lookup_scalar() - check to see if hash is in bloom bucket
  * @hash:       hash used to select the bucket
  * @bitmap:     base byte address of the bucket
  * @n:          number of hashes to check
  * @rotl:       number of bits to rotate left
  * @mask:       bloom bucket bit mask
  *
+ * Portable reference implementation of bf_lookup(), tests one bit
+ * per iteration.
+ *
  * Return:
  *     Returns %true if all n hashes have bits set in the bucket,
  *     otherwise returns %false.
  */
 static __always_inline bool
-bf_lookup(u64 hash, const u8 *bitmap, s32 n, u32 rotl, u32 mask)
+bf_lookup_scalar(u64 hash, const u8 *bitmap, s32 n, u32 rotl, u32 mask)
 {
     while (n-- > 0 && hse_bitmap_test32(bitmap, bf_hash2bit(&hash, rotl, mask)))
         ;
@@ -127,6 +130,62 @@ bf_lookup(u64 hash, const u8 *bitmap, s32 n, u32 rotl, u32 mask)
     return (n < 0);
 }
 
+typedef bool
+bf_lookup_fn(u64 hash, const u8 *bitmap, s32 n, u32 rotl, u32 mask);
+
+/* bf_lookup_impl points to the fastest bucket probe supported by the
+ * running cpu (selected on first use).
+ */
+extern bf_lookup_fn *bf_lookup_impl;
+
+/**
+ * bf_lookup() - check to see if hash is in bloom bucket
+ * @hash:       hash used to select the bucket
+ * @bitmap:     base byte address of the bucket
+ * @n:          number of hashes to check
+ * @rotl:       number of bits to rotate left
+ * @mask:       bloom bucket bit mask
+ *
+ * Same semantics as bf_lookup_scalar(), but may compute and test
+ * several bit positions at once using vector instructions.
+ *
+ * Return:
+ *     Returns %true if all n hashes have bits set in the bucket,
+ *     otherwise returns %false.
+ */
+static __always_inline bool
+bf_lookup(u64 hash, const u8 *bitmap, s32 n, u32 rotl, u32 mask)
+{
+    return bf_lookup_impl(hash, bitmap, n, rotl, mask);
+}
+
+/**
+ * bf_lookupv() - check a vector of hashes against one bloom filter
+ * @bitmap:     base byte address of the bloom filter
+ * @modulus:    bit-to-bucket modulus
+ * @bktshift:   number of bits per bucket
+ * @n:          number of hashes to check
+ * @rotl:       number of bits to rotate left
+ * @mask:       bloom bucket bit mask
+ * @hashc:      number of hashes in @hashv
+ * @hashv:      vector of hashes to check
+ * @hitv:       (output) hitv[i] is set to the result for hashv[i]
+ *
+ * Prefetches all the buckets before probing any of them so that the
+ * cache misses overlap rather than serialize.
+ */
+void
+bf_lookupv(
+    const u8 * bitmap,
+    u32        modulus,
+    u32        bktshift,
+    s32        n,
+    u32        rotl,
+    u32        mask,
+    u32        hashc,
+    const u64 *hashv,
+    bool *     hitv);
+
 /**
  * bf_populate() - populate a bloom bucket with given %hash
  * @hash:       hash used to select the bucket
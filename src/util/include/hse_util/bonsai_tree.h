@@ -17,6 +17,7 @@
 #include <hse_util/cursor_heap.h>
 #include <hse_util/hse_err.h>
 #include <hse_util/slist.h>
+#include <hse_util/spinlock.h>
 #include <hse_util/rcu.h>
 
 #pragma GCC visibility push(hidden)
@@ -63,6 +64,7 @@ struct bonsai_skey {
  * @bv_seqnoref:  sequence number reference
  * @bv_priv:      client's private value
  * @bv_flags:     flags, used by the client
+ * @bv_expiry:    expiry time, used by the client
  * @bv_xlen:      opaque encoded value length
  * @bv_valuep:    ptr to value
  * @bv_value:     value data
@@ -71,8 +73,9 @@ struct bonsai_skey {
  * list and the free list at the same time.
  *
  * Note that the value length (@bv_xlen) is an opaque encoding of compressed
- * and uncompressed value lengths so one must use the bonsai_val_*len()
- * functions to decode it.
+ * and uncompressed value lengths and of the compression codec id, so one
+ * must use the bonsai_val_*len() and bonsai_val_codec() functions to
+ * decode it.
  */
 struct bonsai_val {
     struct bonsai_val *bv_next;
@@ -80,6 +83,7 @@ struct bonsai_val {
     uintptr_t          bv_seqnoref;
     atomic64_t         bv_priv;
     unsigned int       bv_flags;
+    u32                bv_expiry;
     u64                bv_xlen;
     void              *bv_valuep;
     char               bv_value[];
@@ -111,7 +115,21 @@ bonsai_val_ulen(const struct bonsai_val *bv)
 static __always_inline uint
 bonsai_val_clen(const struct bonsai_val *bv)
 {
-    return bv->bv_xlen >> 32;
+    return (bv->bv_xlen >> 32) & 0xfffffful;
+}
+
+/**
+ * bonsai_val_codec() - return value compression codec id
+ * @bv: ptr to a bonsai val
+ *
+ * bonsai_val_codec() returns the id of the codec with which the given
+ * bonsai value was compressed (see enum compress_codec).  The result
+ * is meaningless if the value is not compressed.
+ */
+static __always_inline uint
+bonsai_val_codec(const struct bonsai_val *bv)
+{
+    return bv->bv_xlen >> 56;
 }
 
 /**
@@ -132,6 +150,7 @@ bonsai_val_vlen(const struct bonsai_val *bv)
  * @bsv_val:      pointer to value data
  * @bsv_xlen:     opaque encoded value length
  * @bsv_seqnoref: sequence number reference
+ * @bsv_expiry:   expiry time, zero if none (see bn_sval_init())
  *
  * Note that the value length (@bsv_xlen) is an opaque encoding of compressed
  * and uncompressed value lengths so one must use the bonsai_sval_vlen()
@@ -141,6 +160,7 @@ struct bonsai_sval {
     void     *bsv_val;
     u64       bsv_xlen;
     uintptr_t bsv_seqnoref;
+    u32       bsv_expiry;
 };
 
 /**
@@ -153,7 +173,7 @@ struct bonsai_sval {
 static __always_inline uint
 bonsai_sval_vlen(const struct bonsai_sval *bsv)
 {
-    uint clen = bsv->bsv_xlen >> 32;
+    uint clen = (bsv->bsv_xlen >> 32) & 0xfffffful;
     uint vlen = bsv->bsv_xlen & 0xfffffffful;
 
     return clen ?: vlen;
@@ -166,7 +186,7 @@ bonsai_sval_vlen(const struct bonsai_sval *bsv)
  * struct bonsai_kv - bonsai tree key/value node
  * @bkv_key_imm:
  * @bkv_flags:
- * @bkv_refcnt:
+ * @bkv_lock:     serializes updates to the bkv_values list
  * @bkv_values:
  * @bkv_prev:
  * @bkv_next:
@@ -177,10 +197,14 @@ bonsai_sval_vlen(const struct bonsai_sval *bsv)
  * @bkv_key:
  *
  * A bonsai_kv includes the key and a list of bonsai_val objects.
+ * The value list of a key already in the tree may be updated by
+ * bn_update() concurrently with bn_insert_or_replace(), so all
+ * updates to it are made with %bkv_lock held.
  */
 struct bonsai_kv {
     struct key_immediate   bkv_key_imm;
     u16                    bkv_flags;
+    spinlock_t             bkv_lock;
     struct bonsai_val *    bkv_values;
     struct bonsai_kv *     bkv_prev;
     struct bonsai_kv *     bkv_next;
@@ -341,6 +365,74 @@ bn_insert_or_replace(
     const struct bonsai_sval *sval,
     const bool                is_tomb);
 
+/**
+ * bn_update() - Adds a value to a key that is already in the tree
+ * @tree: bonsai tree instance
+ * @skey: bonsai_skey instance containing the key and its related info
+ * @sval: bonsai_sval instance containing the value and its related info
+ * @is_tomb: is the value a regular tombstone
+ *
+ * Unlike bn_insert_or_replace(), bn_update() does not modify the shape
+ * of the tree and need not be serialized against other updates:  It
+ * finds the key via RCU and invokes the client callback with only the
+ * key's %bkv_lock held.  Hence it may be called concurrently with other
+ * calls to bn_update() and with one caller of bn_insert_or_replace()
+ * or bn_insert_kv().
+ *
+ * - Caller must hold rcu_read_lock() across this call.
+ * - All allocations from the tree's cheap must be made concurrently safe
+ *   (see cheap_memalign_concurrent()).
+ *
+ * Return: 0 upon success, ENOENT if the key is not in the tree or if it
+ * cannot be updated without bn_insert_or_replace() (e.g., because a put
+ * would invalidate a tomb span), ENOMEM if the value cannot be allocated.
+ */
+merr_t
+bn_update(
+    struct bonsai_root *      tree,
+    const struct bonsai_skey *skey,
+    const struct bonsai_sval *sval,
+    bool                      is_tomb);
+
+/**
+ * bn_kv_alloc() - Copies a key and its first value for bn_insert_kv()
+ * @tree: bonsai tree instance
+ * @skey: bonsai_skey instance containing the key and its related info
+ * @sval: bonsai_sval instance containing the value and its related info
+ * @kvp:  (output) the new bonsai_kv, not yet in the tree
+ *
+ * Copying a key and its value needn't be serialized against updates to
+ * the tree, so a caller that serializes inserts may do it before taking
+ * its lock, leaving only the link and rebalance to bn_insert_kv().
+ *
+ * - All allocations from the tree's cheap must be made concurrently safe
+ *   (see cheap_memalign_concurrent()).
+ *
+ * Return: 0 upon success, ENOMEM otherwise
+ */
+merr_t
+bn_kv_alloc(
+    struct bonsai_root *      tree,
+    const struct bonsai_skey *skey,
+    const struct bonsai_sval *sval,
+    struct bonsai_kv **       kvp);
+
+/**
+ * bn_insert_kv() - Inserts a key copied by bn_kv_alloc() into the tree
+ * @tree:    bonsai tree instance
+ * @kv:      key and value from bn_kv_alloc()
+ * @is_tomb: is the value a regular tombstone
+ *
+ * Same as bn_insert_or_replace(), and serialized in the same way, for
+ * a key and value that have already been copied.  If the key was
+ * inserted after @kv was allocated, @kv's value is added to the key in
+ * the tree and @kv itself is abandoned to the cheap.
+ *
+ * Return: 0 upon success, ENOMEM otherwise
+ */
+merr_t
+bn_insert_kv(struct bonsai_root *tree, struct bonsai_kv *kv, bool is_tomb);
+
 /**
  * bn_find() - Searches for a given key in the node
  * @tree: bonsai tree instance
@@ -467,6 +559,7 @@ bn_sval_init(void *val, u64 xlen, uintptr_t seqnoref, struct bonsai_sval *sval)
     sval->bsv_val = val;
     sval->bsv_xlen = xlen;
     sval->bsv_seqnoref = seqnoref;
+    sval->bsv_expiry = 0;
 }
 
 static inline s32
@@ -478,6 +571,18 @@ bn_kv_cmp(const void *lhs, const void *rhs)
     return key_full_cmp(&l->bkv_key_imm, l->bkv_key, &r->bkv_key_imm, r->bkv_key);
 }
 
+/* Key head consistent with bn_kv_cmp() for merging with a loser tree.
+ * The first word of the key immediate holds the skidx and the first
+ * bytes of the key in an integer comparable form.
+ */
+static inline u64
+bn_kv_head(const void *kv)
+{
+    const struct bonsai_kv *bkv = kv;
+
+    return bkv->bkv_key_imm.ki_data[0];
+}
+
 /*
  * Max heap comparator with a caveat: A ptomb sorts before all keys w/ matching
  * prefix.
@@ -8,6 +8,23 @@
 #include <hse_util/hse_err.h>
 #include <hse_util/inttypes.h>
 
+/**
+ * enum compress_codec - value compression codec identifiers
+ *
+ * The codec id is persisted with each compressed value (in the c0/c1
+ * encoded value length and in kvset KMD), so ids must never be reused
+ * or renumbered.  LZ4 is zero such that values compressed prior to the
+ * introduction of codec ids decode as LZ4.
+ */
+enum compress_codec {
+    COMPRESS_CODEC_LZ4 = 0,
+    COMPRESS_CODEC_ZSTD = 1,
+};
+
+#define COMPRESS_CODEC_MAX  (2)
+
+struct compress_dict;
+
 typedef uint compress_op_estimate_t(
     const void *data,
     uint        len);
@@ -17,7 +34,8 @@ typedef merr_t compress_op_compress_t(
     uint        src_len,
     void       *dst,
     uint        dst_capacity,
-    uint       *dst_len);
+    uint       *dst_len,
+    int         level);
 
 typedef merr_t compress_op_decompress_t(
     const void *src,
@@ -26,10 +44,108 @@ typedef merr_t compress_op_decompress_t(
     uint        dst_capacity,
     uint       *dst_len);
 
+typedef merr_t compress_op_dict_train_t(
+    const void   *samples,
+    const size_t *samplev,
+    uint          samplec,
+    void         *dict,
+    uint          dict_capacity,
+    uint         *dict_len);
+
+typedef merr_t compress_op_dict_create_t(
+    const void            *dict,
+    uint                   dict_len,
+    int                    level,
+    struct compress_dict **dictp);
+
+typedef void compress_op_dict_destroy_t(
+    struct compress_dict *dict);
+
+typedef merr_t compress_op_compress_dict_t(
+    const struct compress_dict *dict,
+    const void                 *src,
+    uint                        src_len,
+    void                       *dst,
+    uint                        dst_capacity,
+    uint                       *dst_len);
+
+typedef merr_t compress_op_decompress_dict_t(
+    const struct compress_dict *dict,
+    const void                 *src,
+    uint                        src_len,
+    void                       *dst,
+    uint                        dst_capacity,
+    uint                       *dst_len);
+
+/**
+ * struct compress_ops - value compression codec
+ * @cop_name:            codec name (as given by the value_compression rparam)
+ * @cop_codec:           codec id (see enum compress_codec)
+ * @cop_level_max:       maximum compression level (zero if levels unsupported)
+ * @cop_estimate:        worst-case compressed length of @len bytes
+ * @cop_compress:        compress, @level zero selects the codec's default
+ * @cop_decompress:      decompress up to @dst_capacity bytes (partial ok)
+ * @cop_dict_train:      train a dictionary from concatenated samples
+ * @cop_dict_create:     digest a trained dictionary for use at @level
+ * @cop_dict_destroy:    release a digested dictionary
+ * @cop_compress_dict:   compress with a digested dictionary
+ * @cop_decompress_dict: decompress with a digested dictionary
+ *
+ * The dictionary methods are optional and are NULL if the codec
+ * does not support dictionaries.
+ */
 struct compress_ops {
-    compress_op_estimate_t   *cop_estimate;
-    compress_op_compress_t   *cop_compress;
-    compress_op_decompress_t *cop_decompress;
+    const char                    *cop_name;
+    enum compress_codec            cop_codec;
+    int                            cop_level_max;
+    compress_op_estimate_t        *cop_estimate;
+    compress_op_compress_t        *cop_compress;
+    compress_op_decompress_t      *cop_decompress;
+    compress_op_dict_train_t      *cop_dict_train;
+    compress_op_dict_create_t     *cop_dict_create;
+    compress_op_dict_destroy_t    *cop_dict_destroy;
+    compress_op_compress_dict_t   *cop_compress_dict;
+    compress_op_decompress_dict_t *cop_decompress_dict;
 };
 
+/**
+ * compress_codec_ops() - get the ops for the given codec id
+ * @codec: codec id
+ *
+ * Return: ptr to the codec's ops, or NULL if the codec id is unknown
+ * or the codec was not included in this build.
+ */
+const struct compress_ops *
+compress_codec_ops(uint codec);
+
+/**
+ * compress_codec_lookup() - get the ops for the given codec name
+ * @name: codec name (e.g., "lz4", "zstd")
+ *
+ * Return: ptr to the codec's ops, or NULL if there is no such codec.
+ */
+const struct compress_ops *
+compress_codec_lookup(const char *name);
+
+/**
+ * compress_codec_decompress() - decompress a value by codec id
+ * @codec:        codec id with which the value was compressed
+ * @src:          compressed data
+ * @src_len:      length of compressed data
+ * @dst:          output buffer
+ * @dst_capacity: output buffer size
+ * @dst_len:      (output) number of bytes written to @dst
+ *
+ * Return: ENOTSUP if the codec is not available in this build,
+ * otherwise the result of the codec's decompress method.
+ */
+merr_t
+compress_codec_decompress(
+    uint        codec,
+    const void *src,
+    uint        src_len,
+    void       *dst,
+    uint        dst_capacity,
+    uint       *dst_len);
+
 #endif
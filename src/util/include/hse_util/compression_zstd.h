@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2020 Micron Technology, Inc.  All rights reserved.
+ */
+#ifndef HSE_UTIL_COMPRESS_ZSTD_H
+#define HSE_UTIL_COMPRESS_ZSTD_H
+
+#include <hse_util/compression.h>
+
+/* zstd is optional, HAVE_ZSTD is defined if libzstd was found at
+ * configuration time.
+ */
+#ifdef HAVE_ZSTD
+extern struct compress_ops compress_zstd_ops;
+#endif
+
+#endif
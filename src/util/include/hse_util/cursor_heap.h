@@ -135,6 +135,37 @@ cheap_free(struct cheap *h, void *addr);
 void *
 cheap_memalign(struct cheap *h, size_t alignment, size_t size);
 
+/**
+ * cheap_memalign_concurrent() - allocate aligned storage from a shared cheap
+ * @h:          the cheap from which to allocate
+ * @alignment:  the desired alignement
+ * @size:       size in bytes of the desired allocation
+ *
+ * Same as cheap_memalign(), except that the cursor is advanced atomically
+ * so that any number of threads may allocate concurrently from the same
+ * cheap.  Such allocations must not race with any other function that
+ * modifies the cheap, and they cannot be released by cheap_free().
+ *
+ * Return: Returns a pointer to the allocated memory if successful,
+ * otherwise returns NULL.
+ */
+void *
+cheap_memalign_concurrent(struct cheap *h, size_t alignment, size_t size);
+
+/**
+ * cheap_malloc_concurrent() - allocate space from a shared cheap
+ * @h:      the cheap from which to allocate
+ * @size:   size in bytes of the desired allocation
+ *
+ * Same as cheap_malloc(), but may be called concurrently (see
+ * cheap_memalign_concurrent()).
+ */
+static inline void *
+cheap_malloc_concurrent(struct cheap *h, size_t size)
+{
+    return cheap_memalign_concurrent(h, h->alignment, size);
+}
+
 /**
  * cheap_used() - return number of bytes used
  * @h:  ptr to a cheap
@@ -0,0 +1,182 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_PLATFORM_FUSE_FILTER_H
+#define HSE_PLATFORM_FUSE_FILTER_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/compiler.h>
+#include <hse_util/byteorder.h>
+#include <hse_util/hse_err.h>
+
+/* A 3-wise binary fuse filter (Graf & Lemire, "Binary Fuse Filters: Fast
+ * and Smaller Than Xor Filters").  The filter is an array of fpbits-wide
+ * fingerprints, bit packed, divided into segments of a power-of-two
+ * length.  Each key maps to one slot in each of three consecutive
+ * segments, and the filter is built such that the xor of those three
+ * slots yields the key's fingerprint.
+ *
+ * The false positive rate is 2^-fpbits at a cost of about 1.125 * fpbits
+ * bits per key for large key counts (slightly more for small ones), and
+ * a lookup touches at most three cache lines.
+ *
+ * Fingerprints are stored little-endian and are read with unaligned
+ * 32-bit loads, hence the filter data is padded by FF_DATA_PAD bytes.
+ */
+#define FF_FPBITS_MIN (1)
+#define FF_FPBITS_MAX (24)
+#define FF_SEGLEN_MAX (1u << 18)
+#define FF_DATA_PAD (3)
+
+struct fuse_filter {
+    u8 *ff_data;
+    u64 ff_seed;
+    u32 ff_seglen;
+    u32 ff_segcnt;
+    u32 ff_fpbits;
+    u32 ff_datasz;
+};
+
+static __always_inline u64
+ff_mix(u64 h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+
+    return h;
+}
+
+static __always_inline u32
+ff_fingerprint(u64 hash, u32 fpbits)
+{
+    return (u32)(hash ^ (hash >> 32)) & ((1u << fpbits) - 1);
+}
+
+/**
+ * ff_hash2pos() - compute the three slots of a (mixed) hash
+ * @hash:       hash returned by ff_mix()
+ * @seglen:     segment length (power of two)
+ * @segcnt:     number of segments in which the first slot may fall
+ * @posv:       (output) slot indices
+ */
+static __always_inline void
+ff_hash2pos(u64 hash, u32 seglen, u32 segcnt, u32 *posv)
+{
+    u32 mask = seglen - 1;
+    u32 h0;
+
+    h0 = (u32)(((unsigned __int128)hash * ((u64)segcnt * seglen)) >> 64);
+
+    posv[0] = h0;
+    posv[1] = (h0 + seglen) ^ ((u32)(hash >> 18) & mask);
+    posv[2] = (h0 + 2 * seglen) ^ ((u32)hash & mask);
+}
+
+static __always_inline u32
+ff_fp_get(const u8 *data, u32 idx, u32 fpbits)
+{
+    u64 bit = (u64)idx * fpbits;
+    u32 word;
+
+    memcpy(&word, data + (bit >> 3), sizeof(word));
+
+    return (le32_to_cpu(word) >> (bit & 7)) & ((1u << fpbits) - 1);
+}
+
+/**
+ * ff_lookup() - check to see if a key hash is in a fuse filter
+ * @data:       base address of the fingerprint array
+ * @seed:       filter seed
+ * @seglen:     segment length
+ * @segcnt:     number of segments in which the first slot may fall
+ * @fpbits:     fingerprint width in bits
+ * @hash:       key hash
+ *
+ * Return:
+ *     Returns %true if the key might be in the filter, %false if it
+ *     most definitely is not.
+ */
+static __always_inline bool
+ff_lookup(const u8 *data, u64 seed, u32 seglen, u32 segcnt, u32 fpbits, u64 hash)
+{
+    u32 posv[3];
+    u32 fp;
+
+    hash = ff_mix(hash + seed);
+    fp = ff_fingerprint(hash, fpbits);
+
+    ff_hash2pos(hash, seglen, segcnt, posv);
+
+    fp ^= ff_fp_get(data, posv[0], fpbits);
+    fp ^= ff_fp_get(data, posv[1], fpbits);
+    fp ^= ff_fp_get(data, posv[2], fpbits);
+
+    return fp == 0;
+}
+
+/**
+ * ff_lookupv() - check a vector of hashes against one fuse filter
+ * @ff:         fuse filter (only the geometry and ff_data are used)
+ * @hashc:      number of hashes in @hashv
+ * @hashv:      vector of key hashes
+ * @hitv:       (output) hitv[i] is set to the result for hashv[i]
+ *
+ * Prefetches the slots of several hashes before probing any of them
+ * so that the cache misses overlap rather than serialize.
+ */
+void
+ff_lookupv(const struct fuse_filter *ff, u32 hashc, const u64 *hashv, bool *hitv);
+
+/**
+ * ff_fpbits_est() - fingerprint width for a false positive probability
+ * @probability:  desired false positive probability times 1000000
+ */
+u32
+ff_fpbits_est(u32 probability);
+
+/**
+ * ff_size_estimate() - size in bytes of a filter for %nkeys keys
+ * @fpbits:     fingerprint width in bits
+ * @nkeys:      number of keys
+ */
+size_t
+ff_size_estimate(u32 fpbits, u32 nkeys);
+
+/**
+ * ff_element_estimate() - number of keys a filter of %size bytes can hold
+ * @fpbits:     fingerprint width in bits
+ * @size:       filter size in bytes
+ */
+u32
+ff_element_estimate(u32 fpbits, size_t size);
+
+/**
+ * ff_filter_build() - build a fuse filter from a vector of key hashes
+ * @ff:         (output) fuse filter
+ * @fpbits:     fingerprint width in bits
+ * @hashc:      number of hashes in @hashv
+ * @hashv:      vector of key hashes (may contain duplicates, may be
+ *              reordered)
+ * @storage:    buffer for the fingerprint array
+ * @storage_sz: size of @storage in bytes
+ *
+ * Return:
+ *     %ENOSPC if @storage is too small, %ENOMEM if scratch space could
+ *     not be allocated, or %EAGAIN in the (vanishingly unlikely) event
+ *     that no seed yields a valid filter.
+ */
+merr_t
+ff_filter_build(
+    struct fuse_filter *ff,
+    u32                 fpbits,
+    u32                 hashc,
+    u64 *               hashv,
+    u8 *                storage,
+    size_t              storage_sz);
+
+#endif
@@ -9,6 +9,7 @@
 #include <hse_util/inttypes.h>
 #include <hse_util/minmax.h>
 #include <hse_util/assert.h>
+#include <hse_util/byteorder.h>
 
 #pragma GCC visibility push(hidden)
 
@@ -298,6 +299,30 @@ key_obj_cmp(const struct key_obj *ko1, const struct key_obj *ko2)
     return key_obj_ncmp(ko1, ko2, UINT_MAX);
 }
 
+/**
+ * key_obj_head64() - get the first eight bytes of a key as an integer
+ * @ko: key object
+ *
+ * Keys shorter than eight bytes are zero padded, such that if
+ * key_obj_head64(ko1) < key_obj_head64(ko2) then key_obj_cmp(ko1, ko2) < 0.
+ * Equal heads imply nothing about the order of the keys.
+ */
+static __always_inline u64
+key_obj_head64(const struct key_obj *ko)
+{
+    u64  head = 0;
+    uint n;
+
+    n = min_t(uint, ko->ko_pfx_len, sizeof(head));
+    if (n)
+        memcpy(&head, ko->ko_pfx, n);
+
+    if (n < sizeof(head) && ko->ko_sfx_len)
+        memcpy((u8 *)&head + n, ko->ko_sfx, min_t(uint, ko->ko_sfx_len, sizeof(head) - n));
+
+    return be64_to_cpu(head);
+}
+
 /*
  * Return value:
  *   0            : ko_pfx is a prefix of ko_key.
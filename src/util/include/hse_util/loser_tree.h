@@ -0,0 +1,117 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_PLATFORM_LOSER_TREE_H
+#define HSE_PLATFORM_LOSER_TREE_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+#include <hse_util/element_source.h>
+
+#pragma GCC visibility push(hidden)
+
+/*
+ * A loser tree (tournament tree) merges the ordered streams of up to
+ * max_width element sources.  Each internal node of the tree records
+ * the loser of the match played at that node, and node zero records
+ * the overall winner.  Replacing the winner requires replaying only
+ * the matches on the path from its leaf to the root, i.e., log2(k)
+ * comparisons, whereas a binary heap needs up to 2*log2(k).
+ *
+ * The caller may also supply a head function which returns an unsigned
+ * integer such that head(a) < head(b) implies cmp(a, b) < 0 (e.g., the
+ * first eight bytes of a key in big-endian order).  The head of each
+ * source's current element is cached in its leaf, and the comparator is
+ * called only to decide matches between elements with equal heads.
+ *
+ * Elements which compare equal are returned in the order of their
+ * sources in the vector given to loser_tree_prepare().  As with
+ * bin_heap2, sources which have no elements are dropped and es_sort
+ * of each remaining source is set to its index among the remaining
+ * sources.
+ */
+
+/* Must return a negative value if a is to be returned before b.
+ */
+typedef int
+loser_tree_cmp_fn(const void *a, const void *b);
+
+typedef u64
+loser_tree_head_fn(const void *elt);
+
+struct loser_tree_leaf {
+    u64                    ltl_head;
+    void *                 ltl_data;
+    struct element_source *ltl_es;
+};
+
+/**
+ * struct loser_tree -
+ * @lt_width:     number of sources not yet exhausted
+ * @lt_leafc:     number of leaves (sources given to prepare)
+ * @lt_max_width: max number of leaves
+ * @lt_cmp:       element comparator
+ * @lt_head:      element head function (may be NULL)
+ * @lt_nodev:     lt_nodev[0] is the winner, lt_nodev[1..leafc-1] are losers
+ * @lt_leafv:     leaves
+ */
+struct loser_tree {
+    u32                    lt_width;
+    u32                    lt_leafc;
+    u32                    lt_max_width;
+    loser_tree_cmp_fn *    lt_cmp;
+    loser_tree_head_fn *   lt_head;
+    u32 *                  lt_nodev;
+    struct loser_tree_leaf lt_leafv[];
+};
+
+merr_t
+loser_tree_create(
+    u32                  max_width,
+    loser_tree_cmp_fn *  cmp,
+    loser_tree_head_fn * head,
+    struct loser_tree ** lt_out);
+
+void
+loser_tree_destroy(struct loser_tree *lt);
+
+merr_t
+loser_tree_prepare(struct loser_tree *lt, u32 width, struct element_source *es[]);
+
+/**
+ * loser_tree_pop() - remove the winner and advance its source
+ * @lt:   loser tree
+ * @item: (output) the winning element
+ *
+ * The winner's source is advanced before returning, hence the caller
+ * must not rely on the popped element remaining valid if the source
+ * reuses its element buffer (see element_source_get_next()).
+ *
+ * Return: false if all the sources are exhausted
+ */
+bool
+loser_tree_pop(struct loser_tree *lt, void **item);
+
+static __always_inline bool
+loser_tree_peek(struct loser_tree *lt, void **item)
+{
+    if (lt->lt_width == 0) {
+        *item = 0;
+        return false;
+    }
+
+    *item = lt->lt_leafv[lt->lt_nodev[0]].ltl_data;
+    return true;
+}
+
+static inline u32
+loser_tree_width(struct loser_tree *lt)
+{
+    return lt ? lt->lt_width : 0;
+}
+
+#pragma GCC visibility pop
+
+#endif
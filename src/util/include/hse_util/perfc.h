@@ -590,6 +590,23 @@ perfc_lat_record_impl(struct perfc_dis *dis, u64 sample);
 void
 perfc_dis_record_impl(struct perfc_dis *dis, u64 sample);
 
+/**
+ * perfc_dis_hits() - read the per-bucket hit counts of a dis/lat counter
+ * @pcs:      counter set ptr
+ * @cidx:     counter index
+ * @hitv:     (output) hits per bucket, PERFC_IVL_MAX + 1 entries
+ * @boundv:   (output) bucket bounds, PERFC_IVL_MAX entries
+ *
+ * Bucket %i counts the samples in [boundv[i - 1], boundv[i]), the last
+ * bucket is unbounded.  Hit counts accumulate until the counter is
+ * cleared, so callers interested in recent activity should difference
+ * successive reads.
+ *
+ * Return: number of buckets in hitv[], or 0 if the counter is not enabled.
+ */
+u32
+perfc_dis_hits(struct perfc_set *pcs, u32 cidx, u64 *hitv, u64 *boundv);
+
 #define perfc_rec_lat perfc_lat_record
 #define perfc_rec_sample perfc_dis_record
 
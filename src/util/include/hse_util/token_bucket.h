@@ -44,6 +44,16 @@ tbkt_burst_get(struct tbkt *self);
 u64
 tbkt_rate_get(struct tbkt *self);
 
+/**
+ * tbkt_debt_get() - return the number of tokens owed by the bucket
+ *
+ * Return: 0 if the bucket has credit, otherwise the debt that must be
+ * repaid (at the current rate) before a request can proceed without delay.
+ */
+/* MTF_MOCK */
+u64
+tbkt_debt_get(struct tbkt *self);
+
 /* MTF_MOCK */
 void
 tbkt_adjust(struct tbkt *self, u64 burst, u64 rate);
@@ -22,6 +22,18 @@
 #define WQ_MAX_ACTIVE (128)
 #define WQ_DFL_ACTIVE (WQ_MAX_ACTIVE / 8)
 
+/*
+ * alloc_workqueue() flags:
+ *
+ * WQ_SHARDED   Split the pending list into one shard per worker thread,
+ *              each with its own lock.  Idle workers steal work from the
+ *              other shards and park on a futex rather than a condvar.
+ *              This greatly reduces lock contention on queues to which
+ *              many threads enqueue short work items, but work is no
+ *              longer dispatched in strict FIFO order.
+ */
+#define WQ_SHARDED (0x0001u)
+
 struct work_struct;
 struct workqueue_struct;
 
@@ -65,7 +77,7 @@ struct wq_barrier {
 struct workqueue_struct *
 alloc_workqueue(
     const char * fmt,        /* fmt string for name workqueue */
-    unsigned int flags,      /* ignored */
+    unsigned int flags,      /* WQ_* flags */
     int          max_active, /* number of threads servicing queue */
     ...                      /* fmt string arguments */
     ) __printf(1, 4);
@@ -6,8 +6,13 @@
 #include <hse_util/bitmap.h>
 #include <hse_util/bloom_filter.h>
 #include <hse_util/logging.h>
+#include <hse_util/minmax.h>
 #include <hse_util/page.h>
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #include "bf_size2bits.i"
 
 struct bf_prob_range {
@@ -175,3 +180,106 @@ bf_filter_insert_by_hashv(struct bloom_filter *bf, u64 *keyv, u32 keyc)
     for (i = 0; i < keyc; ++i)
         bf_populate(bf, keyv[i]);
 }
+
+#if defined(__x86_64__)
+/* AVX2 bucket probe.  The nth hash used by bf_hash2bit() is simply the
+ * original hash rotated left by (n * rotl) mod 64, so we can compute four
+ * bit positions at a time with variable shifts, gather the 64-bit words
+ * that contain them, and test all four bits with a single vptest.  Lanes
+ * beyond @n are masked out of the test.  Buckets are at least 64 bytes and
+ * are naturally aligned, so all gathered words lie within the bucket.
+ */
+__attribute__((target("avx2"))) static bool
+bf_lookup_avx2(u64 hash, const u8 *bitmap, s32 n, u32 rotl, u32 mask)
+{
+    const __m256i lanes = _mm256_set_epi64x(3, 2, 1, 0);
+    const __m256i vhash = _mm256_set1_epi64x(hash);
+    const __m256i vmask = _mm256_set1_epi64x(mask);
+    const __m256i v63 = _mm256_set1_epi64x(63);
+    const __m256i v64 = _mm256_set1_epi64x(64);
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i step = _mm256_set1_epi64x((4 * rotl) & 63);
+    __m256i       rot;
+    s32           i;
+
+    rot = _mm256_mul_epu32(lanes, _mm256_set1_epi64x(rotl));
+    rot = _mm256_and_si256(rot, v63);
+
+    for (i = 0; i < n; i += 4) {
+        __m256i bits, words, bitv, live;
+
+        bits = _mm256_or_si256(
+            _mm256_sllv_epi64(vhash, rot), _mm256_srlv_epi64(vhash, _mm256_sub_epi64(v64, rot)));
+        bits = _mm256_and_si256(bits, vmask);
+
+        words = _mm256_i64gather_epi64((const long long *)bitmap, _mm256_srli_epi64(bits, 6), 8);
+
+        live = _mm256_cmpgt_epi64(_mm256_set1_epi64x(n - i), lanes);
+        bitv = _mm256_sllv_epi64(one, _mm256_and_si256(bits, v63));
+        bitv = _mm256_and_si256(bitv, live);
+
+        if (!_mm256_testc_si256(words, bitv))
+            return false;
+
+        rot = _mm256_and_si256(_mm256_add_epi64(rot, step), v63);
+    }
+
+    return true;
+}
+#endif
+
+static bool
+bf_lookup_generic(u64 hash, const u8 *bitmap, s32 n, u32 rotl, u32 mask)
+{
+    return bf_lookup_scalar(hash, bitmap, n, rotl, mask);
+}
+
+static bool
+bf_lookup_resolve(u64 hash, const u8 *bitmap, s32 n, u32 rotl, u32 mask)
+{
+    bf_lookup_fn *fn = bf_lookup_generic;
+
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        fn = bf_lookup_avx2;
+#endif
+
+    /* Benign race: all threads resolve to the same function. */
+    bf_lookup_impl = fn;
+
+    return fn(hash, bitmap, n, rotl, mask);
+}
+
+bf_lookup_fn *bf_lookup_impl = bf_lookup_resolve;
+
+#define BF_LOOKUPV_PREFETCH (16)
+
+void
+bf_lookupv(
+    const u8 * bitmap,
+    u32        modulus,
+    u32        bktshift,
+    s32        n,
+    u32        rotl,
+    u32        mask,
+    u32        hashc,
+    const u64 *hashv,
+    bool *     hitv)
+{
+    size_t bktv[BF_LOOKUPV_PREFETCH];
+    u32    i, j, cnt;
+
+    for (i = 0; i < hashc; i += cnt) {
+        cnt = min_t(u32, hashc - i, BF_LOOKUPV_PREFETCH);
+
+        for (j = 0; j < cnt; ++j) {
+            bktv[j] = bf_hash2bkt(hashv[i + j], modulus, bktshift);
+            __builtin_prefetch(bitmap + bktv[j]);
+        }
+
+        for (j = 0; j < cnt; ++j)
+            hitv[i + j] = bf_lookup(hashv[i + j], bitmap + bktv[j], n, rotl, mask);
+    }
+}
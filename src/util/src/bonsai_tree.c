@@ -15,6 +15,7 @@ bn_ior_replace(
     struct bonsai_root *      tree,
     struct bonsai_node *      node,
     const struct bonsai_sval *sval,
+    struct bonsai_kv *        newkv,
     u32                       flags)
 {
     struct bonsai_val *  v;
@@ -27,14 +28,17 @@ bn_ior_replace(
         node->bn_kv->bkv_tomb = NULL;
     }
 
-    v = bn_val_alloc(tree, sval);
+    /* A key copied by bn_kv_alloc() contributes only its value. */
+    v = newkv ? newkv->bkv_values : bn_val_alloc(tree, sval);
     if (!v)
         return NULL;
 
     SET_IOR_REPORADD(code);
     oldv = NULL;
 
+    spin_lock(&node->bn_kv->bkv_lock);
     tree->br_client.bc_iorcb(tree->br_client.bc_rock, &code, node->bn_kv, v, &oldv);
+    spin_unlock(&node->bn_kv->bkv_lock);
 
     return node;
 }
@@ -45,6 +49,7 @@ bn_ior_insert(
     const struct key_immediate *key_imm,
     const void                 *key,
     const struct bonsai_sval   *sval,
+    struct bonsai_kv           *newkv,
     struct bonsai_kv           *parent,
     u32                         flags)
 {
@@ -52,7 +57,10 @@ bn_ior_insert(
     struct bonsai_node *node;
     enum bonsai_ior_code code;
 
-    node = bn_node_alloc(tree, key_imm, key, sval);
+    if (newkv)
+        node = bn_node_alloc_kv(tree, newkv);
+    else
+        node = bn_node_alloc(tree, key_imm, key, sval);
     if (!node)
         return NULL;
 
@@ -125,6 +133,7 @@ bn_ior_impl(
     const struct key_immediate *key_imm,
     const void                 *key,
     const struct bonsai_sval   *sval,
+    struct bonsai_kv           *newkv,
     struct bonsai_kv           *parent,
     u32                         flags)
 {
@@ -163,9 +172,9 @@ bn_ior_impl(
     }
 
     if (node)
-        node = bn_ior_replace(tree, node, sval, flags);
+        node = bn_ior_replace(tree, node, sval, newkv, flags);
     else
-        node = bn_ior_insert(tree, key_imm, key, sval, parent, flags);
+        node = bn_ior_insert(tree, key_imm, key, sval, newkv, parent, flags);
 
     if (!node)
         return NULL;
@@ -357,7 +366,37 @@ bn_insert_or_replace(
     flags = is_tomb ? BN_INSERT_FLAG_TOMB : 0;
 
     newroot = bn_ior_impl(tree, oldroot, &skey->bsk_key_imm, skey->bsk_key,
-                          sval, &tree->br_kv, flags);
+                          sval, NULL, &tree->br_kv, flags);
+    if (!newroot)
+        return merr(ENOMEM);
+
+    bn_update_root_node(tree, oldroot, newroot);
+
+    return 0;
+}
+
+merr_t
+bn_kv_alloc(
+    struct bonsai_root *      tree,
+    const struct bonsai_skey *skey,
+    const struct bonsai_sval *sval,
+    struct bonsai_kv **       kvp)
+{
+    return bn_kv_init(tree, &skey->bsk_key_imm, skey->bsk_key, sval, kvp);
+}
+
+merr_t
+bn_insert_kv(struct bonsai_root *tree, struct bonsai_kv *kv, bool is_tomb)
+{
+    struct bonsai_node *oldroot;
+    struct bonsai_node *newroot;
+    u32                 flags;
+
+    oldroot = tree->br_root;
+    flags = is_tomb ? BN_INSERT_FLAG_TOMB : 0;
+
+    newroot = bn_ior_impl(tree, oldroot, &kv->bkv_key_imm, kv->bkv_key,
+                          NULL, kv, &tree->br_kv, flags);
     if (!newroot)
         return merr(ENOMEM);
 
@@ -366,6 +405,43 @@ bn_insert_or_replace(
     return 0;
 }
 
+merr_t
+bn_update(
+    struct bonsai_root *      tree,
+    const struct bonsai_skey *skey,
+    const struct bonsai_sval *sval,
+    bool                      is_tomb)
+{
+    enum bonsai_ior_code code;
+    struct bonsai_val *  v, *oldv;
+    struct bonsai_kv *   kv;
+
+    kv = bn_find_impl(tree, skey, B_MATCH_EQ);
+    if (!kv)
+        return merr(ENOENT);
+
+    /* A put into a tomb span must invalidate the span, which requires
+     * serialization with insertions that might extend it.  Note that
+     * once cleared, the bkv_tomb field of a key in the tree is never
+     * set again.
+     */
+    if (!is_tomb && rcu_dereference(kv->bkv_tomb))
+        return merr(ENOENT);
+
+    v = bn_val_alloc(tree, sval);
+    if (!v)
+        return merr(ENOMEM);
+
+    SET_IOR_REPORADD(code);
+    oldv = NULL;
+
+    spin_lock(&kv->bkv_lock);
+    tree->br_client.bc_iorcb(tree->br_client.bc_rock, &code, kv, v, &oldv);
+    spin_unlock(&kv->bkv_lock);
+
+    return 0;
+}
+
 bool
 bn_find(struct bonsai_root *tree, const struct bonsai_skey *skey, struct bonsai_kv **kv)
 {
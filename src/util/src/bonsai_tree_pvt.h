@@ -42,6 +42,36 @@ bn_node_alloc(
     const void *                key,
     const struct bonsai_sval *  sval);
 
+/**
+ * bn_node_alloc_kv() - allocate a leaf node for a key from bn_kv_init()
+ * @tree: bonsai tree instance
+ * @kv:   key and its values
+ *
+ * Return: the new node, or NULL if out of memory
+ */
+struct bonsai_node *
+bn_node_alloc_kv(struct bonsai_root *tree, struct bonsai_kv *kv);
+
+/**
+ * bn_kv_init() - allocate and initialize a key and its first value
+ * @tree:    bonsai tree instance
+ * @key_imm: key immediate
+ * @key:     key
+ * @sval:    first value
+ * @kv_out:  (output) the new key
+ *
+ * Allocates only via the tree's cheap, never from the node slab.
+ *
+ * Return: 0 upon success, ENOMEM otherwise
+ */
+merr_t
+bn_kv_init(
+    struct bonsai_root *        tree,
+    const struct key_immediate *key_imm,
+    const void *                key,
+    const struct bonsai_sval *  sval,
+    struct bonsai_kv **         kv_out);
+
 /**
  * bn_val_alloc() -
  * @tree:    bonsai tree instance
@@ -10,7 +10,7 @@
 static inline void *
 bn_alloc(struct bonsai_root *tree, size_t sz)
 {
-    return cheap_malloc(tree->br_client.bc_cheap, sz);
+    return cheap_malloc_concurrent(tree->br_client.bc_cheap, sz);
 }
 
 static inline void *
@@ -28,7 +28,8 @@ bn_node_alloc_impl(struct bonsai_root *tree)
 
         slabsz = client->bc_slab_sz;
 
-        mem = cheap_memalign(client->bc_cheap, __alignof(struct bonsai_node), slabsz);
+        mem = cheap_memalign_concurrent(
+            client->bc_cheap, __alignof(struct bonsai_node), slabsz);
         if (ev(!mem))
             return NULL;
 
@@ -57,6 +58,7 @@ bn_val_alloc(struct bonsai_root *tree, const struct bonsai_sval *sval)
     v->bv_free = NULL;
     v->bv_seqnoref = sval->bsv_seqnoref;
     v->bv_flags = 0;
+    v->bv_expiry = sval->bsv_expiry;
     v->bv_xlen = sval->bsv_xlen;
     v->bv_valuep = sval->bsv_val;
     atomic64_set(&v->bv_priv, 0);
@@ -67,7 +69,7 @@ bn_val_alloc(struct bonsai_root *tree, const struct bonsai_sval *sval)
     return v;
 }
 
-static inline merr_t
+merr_t
 bn_kv_init(
     struct bonsai_root *        tree,
     const struct key_immediate *key_imm,
@@ -99,6 +101,7 @@ bn_kv_init(
     INIT_S_LIST_HEAD(&kv->bkv_txpend);
 
     kv->bkv_flags = 0;
+    spin_lock_init(&kv->bkv_lock);
     kv->bkv_key_imm = *key_imm;
     memcpy(kv->bkv_key, key, key_imm_klen(key_imm));
 
@@ -137,6 +140,18 @@ bn_node_make(
     return node;
 }
 
+struct bonsai_node *
+bn_node_alloc_kv(struct bonsai_root *tree, struct bonsai_kv *kv)
+{
+    struct bonsai_node *node;
+
+    node = bn_node_make(tree, NULL, NULL, kv, &kv->bkv_key_imm);
+    if (node)
+        bn_height_update(node);
+
+    return node;
+}
+
 struct bonsai_node *
 bn_node_alloc(
     struct bonsai_root *        tree,
@@ -144,8 +159,7 @@ bn_node_alloc(
     const void *                key,
     const struct bonsai_sval *  sval)
 {
-    struct bonsai_node *node;
-    struct bonsai_kv *  kv;
+    struct bonsai_kv *kv;
 
     merr_t err;
 
@@ -154,11 +168,7 @@ bn_node_alloc(
     if (err)
         return NULL;
 
-    node = bn_node_make(tree, NULL, NULL, kv, key_imm);
-    if (node)
-        bn_height_update(node);
-
-    return node;
+    return bn_node_alloc_kv(tree, kv);
 }
 
 struct bonsai_node *
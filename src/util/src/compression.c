@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/compression.h>
+#include <hse_util/compression_lz4.h>
+#include <hse_util/compression_zstd.h>
+
+static const struct compress_ops *compress_codecv[COMPRESS_CODEC_MAX] __read_mostly = {
+    [COMPRESS_CODEC_LZ4] = &compress_lz4_ops,
+#ifdef HAVE_ZSTD
+    [COMPRESS_CODEC_ZSTD] = &compress_zstd_ops,
+#endif
+};
+
+const struct compress_ops *
+compress_codec_ops(uint codec)
+{
+    return (codec < NELEM(compress_codecv)) ? compress_codecv[codec] : NULL;
+}
+
+const struct compress_ops *
+compress_codec_lookup(const char *name)
+{
+    int i;
+
+    for (i = 0; i < NELEM(compress_codecv); i++) {
+        if (compress_codecv[i] && !strcmp(name, compress_codecv[i]->cop_name))
+            return compress_codecv[i];
+    }
+
+    return NULL;
+}
+
+merr_t
+compress_codec_decompress(
+    uint        codec,
+    const void *src,
+    uint        src_len,
+    void       *dst,
+    uint        dst_capacity,
+    uint       *dst_len)
+{
+    const struct compress_ops *cops;
+
+    cops = compress_codec_ops(codec);
+    if (ev(!cops)) {
+        hse_log(HSE_ERR "%s: value compressed with unsupported codec %u", __func__, codec);
+        return merr(ENOTSUP);
+    }
+
+    return cops->cop_decompress(src, src_len, dst, dst_capacity, dst_len);
+}
@@ -34,7 +34,8 @@ compress_lz4_compress(
     uint        src_len,
     void       *dst,
     uint        dst_capacity,
-    uint       *dst_len)
+    uint       *dst_len,
+    int         level)
 {
     int len;
 
@@ -97,6 +98,9 @@ compress_lz4_decompress(
 }
 
 struct compress_ops compress_lz4_ops __read_mostly = {
+    .cop_name       = "lz4",
+    .cop_codec      = COMPRESS_CODEC_LZ4,
+    .cop_level_max  = 0,
     .cop_estimate   = compress_lz4_estimate,
     .cop_compress   = compress_lz4_compress,
     .cop_decompress = compress_lz4_decompress,
@@ -0,0 +1,371 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/assert.h>
+#include <hse_util/alloc.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/logging.h>
+#include <hse_util/minmax.h>
+#include <hse_util/compression_zstd.h>
+
+#include <pthread.h>
+
+#include <zstd.h>
+#include <zdict.h>
+
+#if ZSTD_VERSION_NUMBER < (10000 + 400 + 0)
+#error "Need zstd 1.4.0 or higher"
+#endif
+
+/* Levels above 19 require very large windows and are of no use
+ * for values of at most HSE_KVS_VLEN_MAX bytes.
+ */
+#define COMPRESS_ZSTD_LEVEL_MAX (19)
+
+struct compress_dict {
+    ZSTD_CDict *cd_cdict;
+    ZSTD_DDict *cd_ddict;
+};
+
+/* zstd contexts are expensive to create but cheap to reuse, so each thread
+ * lazily creates one compression and one decompression context which are
+ * freed when the thread exits.
+ */
+struct compress_zstd_tls {
+    ZSTD_CCtx *zt_cctx;
+    ZSTD_DCtx *zt_dctx;
+};
+
+static pthread_once_t compress_zstd_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  compress_zstd_key;
+static bool           compress_zstd_key_valid;
+
+static void
+compress_zstd_tls_free(void *arg)
+{
+    struct compress_zstd_tls *tls = arg;
+
+    ZSTD_freeCCtx(tls->zt_cctx);
+    ZSTD_freeDCtx(tls->zt_dctx);
+    free(tls);
+}
+
+static void
+compress_zstd_key_create(void)
+{
+    compress_zstd_key_valid = !pthread_key_create(&compress_zstd_key, compress_zstd_tls_free);
+}
+
+static struct compress_zstd_tls *
+compress_zstd_tls(void)
+{
+    struct compress_zstd_tls *tls;
+
+    pthread_once(&compress_zstd_once, compress_zstd_key_create);
+    if (ev(!compress_zstd_key_valid))
+        return NULL;
+
+    tls = pthread_getspecific(compress_zstd_key);
+    if (!tls) {
+        tls = calloc(1, sizeof(*tls));
+        if (ev(!tls))
+            return NULL;
+
+        if (ev(pthread_setspecific(compress_zstd_key, tls))) {
+            free(tls);
+            return NULL;
+        }
+    }
+
+    return tls;
+}
+
+static ZSTD_CCtx *
+compress_zstd_cctx(void)
+{
+    struct compress_zstd_tls *tls = compress_zstd_tls();
+
+    if (tls && !tls->zt_cctx)
+        tls->zt_cctx = ZSTD_createCCtx();
+
+    return tls ? tls->zt_cctx : NULL;
+}
+
+static ZSTD_DCtx *
+compress_zstd_dctx(void)
+{
+    struct compress_zstd_tls *tls = compress_zstd_tls();
+
+    if (tls && !tls->zt_dctx)
+        tls->zt_dctx = ZSTD_createDCtx();
+
+    return tls ? tls->zt_dctx : NULL;
+}
+
+static
+uint
+compress_zstd_estimate(
+    const void *data,
+    uint        len)
+{
+    if (!len)
+        return 0;
+
+    return (uint)ZSTD_compressBound(len);
+}
+
+static
+merr_t
+compress_zstd_result(size_t rc, uint *dst_len)
+{
+    if (ZSTD_isError(rc)) {
+        *dst_len = 0;
+        return merr(EFBIG);
+    }
+
+    *dst_len = rc;
+
+    return 0;
+}
+
+static
+merr_t
+compress_zstd_compress(
+    const void *src,
+    uint        src_len,
+    void       *dst,
+    uint        dst_capacity,
+    uint       *dst_len,
+    int         level)
+{
+    ZSTD_CCtx *cctx;
+
+    assert(src && dst && dst_len);
+    assert(src_len && dst_capacity);
+
+    cctx = compress_zstd_cctx();
+    if (ev(!cctx))
+        return merr(ENOMEM);
+
+    /* Level zero selects zstd's default level. */
+    level = min_t(int, level, COMPRESS_ZSTD_LEVEL_MAX);
+
+    return compress_zstd_result(
+        ZSTD_compressCCtx(cctx, dst, dst_capacity, src, src_len, level), dst_len);
+}
+
+/* Decompress as much of the value as fits in dst.  Callers frequently
+ * supply a buffer smaller than the value (e.g., to read a value prefix),
+ * which the single-shot API does not support, so in that case we use
+ * the streaming API and stop when the output buffer is full.
+ */
+static
+merr_t
+compress_zstd_decompress_impl(
+    const ZSTD_DDict *ddict,
+    const void       *src,
+    uint              src_len,
+    void             *dst,
+    uint              dst_capacity,
+    uint             *dst_len)
+{
+    ZSTD_inBuffer      in = { src, src_len, 0 };
+    ZSTD_outBuffer     out = { dst, dst_capacity, 0 };
+    unsigned long long ulen;
+    ZSTD_DCtx *        dctx;
+    size_t             rc = 0;
+    bool               truncated = false;
+
+    assert(src && dst && dst_len);
+    assert(src_len && dst_capacity);
+
+    dctx = compress_zstd_dctx();
+    if (ev(!dctx))
+        return merr(ENOMEM);
+
+    ulen = ZSTD_getFrameContentSize(src, src_len);
+
+    if (ulen <= dst_capacity) {
+        if (ddict)
+            rc = ZSTD_decompress_usingDDict(dctx, dst, dst_capacity, src, src_len, ddict);
+        else
+            rc = ZSTD_decompressDCtx(dctx, dst, dst_capacity, src, src_len);
+
+        if (ZSTD_isError(rc))
+            goto errout;
+
+        *dst_len = rc;
+
+        return 0;
+    }
+
+    ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+    ZSTD_DCtx_refDDict(dctx, ddict);
+
+    while (out.pos < out.size) {
+        size_t inpos = in.pos, outpos = out.pos;
+
+        rc = ZSTD_decompressStream(dctx, &out, &in);
+        if (ZSTD_isError(rc))
+            break;
+
+        if (rc == 0)
+            break; /* frame complete */
+
+        /* No progress implies a truncated frame.
+         */
+        if (in.pos == inpos && out.pos == outpos) {
+            truncated = true;
+            break;
+        }
+    }
+
+    ZSTD_DCtx_refDDict(dctx, NULL);
+
+    if (ZSTD_isError(rc) || truncated)
+        goto errout;
+
+    *dst_len = out.pos;
+
+    return 0;
+
+errout:
+    hse_log(HSE_ERR "%s: slen %u, cap %u, src %p, dst %p: %s",
+            __func__, src_len, dst_capacity, src, dst,
+            ZSTD_isError(rc) ? ZSTD_getErrorName(rc) : "truncated frame");
+
+    return merr(EFBIG);
+}
+
+static
+merr_t
+compress_zstd_decompress(
+    const void *src,
+    uint        src_len,
+    void       *dst,
+    uint        dst_capacity,
+    uint       *dst_len)
+{
+    return compress_zstd_decompress_impl(NULL, src, src_len, dst, dst_capacity, dst_len);
+}
+
+static
+merr_t
+compress_zstd_dict_train(
+    const void   *samples,
+    const size_t *samplev,
+    uint          samplec,
+    void         *dict,
+    uint          dict_capacity,
+    uint         *dict_len)
+{
+    size_t rc;
+
+    rc = ZDICT_trainFromBuffer(dict, dict_capacity, samples, samplev, samplec);
+    if (ZDICT_isError(rc)) {
+        hse_log(HSE_WARNING "%s: samples %u, cap %u: %s",
+                __func__, samplec, dict_capacity, ZDICT_getErrorName(rc));
+        return merr(EINVAL);
+    }
+
+    *dict_len = rc;
+
+    return 0;
+}
+
+static
+void
+compress_zstd_dict_destroy(struct compress_dict *dict)
+{
+    if (!dict)
+        return;
+
+    ZSTD_freeCDict(dict->cd_cdict);
+    ZSTD_freeDDict(dict->cd_ddict);
+    free(dict);
+}
+
+static
+merr_t
+compress_zstd_dict_create(
+    const void            *buf,
+    uint                   buf_len,
+    int                    level,
+    struct compress_dict **dictp)
+{
+    struct compress_dict *dict;
+
+    dict = calloc(1, sizeof(*dict));
+    if (ev(!dict))
+        return merr(ENOMEM);
+
+    level = min_t(int, level, COMPRESS_ZSTD_LEVEL_MAX);
+
+    dict->cd_cdict = ZSTD_createCDict(buf, buf_len, level ?: ZSTD_CLEVEL_DEFAULT);
+    dict->cd_ddict = ZSTD_createDDict(buf, buf_len);
+
+    if (ev(!dict->cd_cdict || !dict->cd_ddict)) {
+        compress_zstd_dict_destroy(dict);
+        return merr(ENOMEM);
+    }
+
+    *dictp = dict;
+
+    return 0;
+}
+
+static
+merr_t
+compress_zstd_compress_dict(
+    const struct compress_dict *dict,
+    const void                 *src,
+    uint                        src_len,
+    void                       *dst,
+    uint                        dst_capacity,
+    uint                       *dst_len)
+{
+    ZSTD_CCtx *cctx;
+
+    assert(dict && src && dst && dst_len);
+    assert(src_len && dst_capacity);
+
+    cctx = compress_zstd_cctx();
+    if (ev(!cctx))
+        return merr(ENOMEM);
+
+    return compress_zstd_result(
+        ZSTD_compress_usingCDict(cctx, dst, dst_capacity, src, src_len, dict->cd_cdict), dst_len);
+}
+
+static
+merr_t
+compress_zstd_decompress_dict(
+    const struct compress_dict *dict,
+    const void                 *src,
+    uint                        src_len,
+    void                       *dst,
+    uint                        dst_capacity,
+    uint                       *dst_len)
+{
+    assert(dict);
+
+    return compress_zstd_decompress_impl(
+        dict->cd_ddict, src, src_len, dst, dst_capacity, dst_len);
+}
+
+struct compress_ops compress_zstd_ops __read_mostly = {
+    .cop_name            = "zstd",
+    .cop_codec           = COMPRESS_CODEC_ZSTD,
+    .cop_level_max       = COMPRESS_ZSTD_LEVEL_MAX,
+    .cop_estimate        = compress_zstd_estimate,
+    .cop_compress        = compress_zstd_compress,
+    .cop_decompress      = compress_zstd_decompress,
+    .cop_dict_train      = compress_zstd_dict_train,
+    .cop_dict_create     = compress_zstd_dict_create,
+    .cop_dict_destroy    = compress_zstd_dict_destroy,
+    .cop_compress_dict   = compress_zstd_compress_dict,
+    .cop_decompress_dict = compress_zstd_decompress_dict,
+};
@@ -154,6 +154,32 @@ cheap_malloc(struct cheap *h, size_t size)
     return cheap_memalign_impl(h, h->alignment, size);
 }
 
+void *
+cheap_memalign_concurrent(struct cheap *h, size_t alignment, size_t size)
+{
+    u64 oldp, allocp;
+
+    if (ev(alignment & (alignment - 1)))
+        return NULL;
+
+    assert(h->magic == (uintptr_t)h);
+
+    if (ev(size > h->size))
+        return NULL;
+
+    oldp = __atomic_load_n(&h->cursorp, __ATOMIC_RELAXED);
+
+    do {
+        allocp = ALIGN(oldp, alignment);
+
+        if ((allocp - h->base + size) > h->size)
+            return NULL;
+    } while (!__atomic_compare_exchange_n(
+        &h->cursorp, &oldp, allocp + size, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    return (void *)allocp;
+}
+
 void
 cheap_free(struct cheap *h, void *addr)
 {
@@ -0,0 +1,401 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <math.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/minmax.h>
+#include <hse_util/fuse_filter.h>
+
+/* Number of seeds to try before giving up on building a filter.  With
+ * the sizing below a seed fails with probability well under 1%.
+ */
+#define FF_BUILD_TRIES (64)
+
+#define FF_LOOKUPV_PREFETCH (16)
+
+struct ff_geometry {
+    u32 seglen;
+    u32 segcnt;
+    u32 slots;
+};
+
+static void
+ff_geometry(u32 nkeys, struct ff_geometry *geo)
+{
+    double factor;
+    u64    cap;
+    u32    shift;
+
+    if (nkeys < 2) {
+        geo->seglen = 4;
+        geo->segcnt = 1;
+        geo->slots = 3 * geo->seglen;
+        return;
+    }
+
+    /* Segment length and size factor as recommended by the authors
+     * for 3-wise filters.
+     */
+    shift = log(nkeys) / log(3.33) + 2.25;
+    geo->seglen = min_t(u32, 1u << shift, FF_SEGLEN_MAX);
+
+    factor = max_t(double, 1.125, 0.875 + 0.25 * log(1000000.0) / log(nkeys));
+    cap = round(nkeys * factor);
+
+    geo->segcnt = (cap + geo->seglen - 1) / geo->seglen;
+    geo->segcnt = (geo->segcnt > 2) ? geo->segcnt - 2 : 1;
+    geo->slots = (geo->segcnt + 2) * geo->seglen;
+}
+
+static size_t
+ff_datasz(u32 slots, u32 fpbits)
+{
+    return ((u64)slots * fpbits + 7) / 8 + FF_DATA_PAD;
+}
+
+u32
+ff_fpbits_est(u32 probability)
+{
+    u32 fpbits = FF_FPBITS_MIN;
+
+    /* Smallest fingerprint such that 2^-fpbits <= probability / 1000000.
+     */
+    while (fpbits < FF_FPBITS_MAX && ((u64)probability << fpbits) < 1000000)
+        ++fpbits;
+
+    return fpbits;
+}
+
+size_t
+ff_size_estimate(u32 fpbits, u32 nkeys)
+{
+    struct ff_geometry geo;
+
+    ff_geometry(nkeys, &geo);
+
+    return ff_datasz(geo.slots, fpbits);
+}
+
+u32
+ff_element_estimate(u32 fpbits, size_t size)
+{
+    u32 lo, hi, mid;
+
+    lo = 0;
+    hi = min_t(u64, (size * 8) / fpbits, U32_MAX);
+
+    while (lo < hi) {
+        mid = hi - (hi - lo) / 2;
+
+        if (ff_size_estimate(fpbits, mid) > size)
+            hi = mid - 1;
+        else
+            lo = mid;
+    }
+
+    return lo;
+}
+
+static void
+ff_fp_put(u8 *data, u32 idx, u32 fpbits, u32 fp)
+{
+    u64 bit = (u64)idx * fpbits;
+    u32 mask = ((1u << fpbits) - 1) << (bit & 7);
+    u32 word;
+
+    memcpy(&word, data + (bit >> 3), sizeof(word));
+    word = le32_to_cpu(word);
+    word = (word & ~mask) | (fp << (bit & 7));
+    word = cpu_to_le32(word);
+    memcpy(data + (bit >> 3), &word, sizeof(word));
+}
+
+static u64
+ff_splitmix64(u64 *state)
+{
+    u64 z = (*state += 0x9e3779b97f4a7c15ull);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+
+    return z ^ (z >> 31);
+}
+
+static int
+ff_hash_cmp(const void *lhs, const void *rhs)
+{
+    u64 l = *(const u64 *)lhs;
+    u64 r = *(const u64 *)rhs;
+
+    return (l > r) - (l < r);
+}
+
+static u32
+ff_hash_dedup(u64 *hashv, u32 hashc)
+{
+    u32 i, j;
+
+    if (hashc < 2)
+        return hashc;
+
+    qsort(hashv, hashc, sizeof(*hashv), ff_hash_cmp);
+
+    for (i = 1, j = 0; i < hashc; ++i) {
+        if (hashv[i] != hashv[j])
+            hashv[++j] = hashv[i];
+    }
+
+    return j + 1;
+}
+
+static __always_inline u8
+ff_mod3(u8 x)
+{
+    return x > 2 ? x - 3 : x;
+}
+
+/* The build follows the reference implementation: hashes are first
+ * distributed roughly by segment for locality, then each slot tracks the
+ * count and xor of the hashes that map to it (with the low two bits of
+ * the count recording which of its three slots the last hash landed in).
+ * Slots with exactly one hash are peeled repeatedly, after which the
+ * fingerprints are assigned in reverse peel order.
+ */
+merr_t
+ff_filter_build(
+    struct fuse_filter *ff,
+    u32                 fpbits,
+    u32                 hashc,
+    u64 *               hashv,
+    u8 *                storage,
+    size_t              storage_sz)
+{
+    struct ff_geometry geo;
+    u64 *              order, *t2hash;
+    u32 *              alone, *startv;
+    u8 *               t2count, *revh;
+    u64                rng, blkmask;
+    u32                blkbits, qsize, stacksize, dups, i;
+    merr_t             err;
+    int                tries;
+
+    if (ev(fpbits < FF_FPBITS_MIN || fpbits > FF_FPBITS_MAX))
+        return merr(EINVAL);
+
+    ff_geometry(hashc, &geo);
+
+    memset(ff, 0, sizeof(*ff));
+    ff->ff_data = storage;
+    ff->ff_seglen = geo.seglen;
+    ff->ff_segcnt = geo.segcnt;
+    ff->ff_fpbits = fpbits;
+    ff->ff_datasz = ff_datasz(geo.slots, fpbits);
+
+    if (ev(ff->ff_datasz > storage_sz))
+        return merr(ENOSPC);
+
+    memset(storage, 0, ff->ff_datasz);
+
+    for (blkbits = 1; (1u << blkbits) < geo.segcnt; ++blkbits)
+        ; /* one distribution block per segment */
+
+    blkmask = (1u << blkbits) - 1;
+
+    order = calloc(hashc + 1, sizeof(*order));
+    t2hash = calloc(geo.slots, sizeof(*t2hash));
+    alone = malloc(geo.slots * sizeof(*alone));
+    t2count = calloc(geo.slots, sizeof(*t2count));
+    revh = malloc(hashc + 1);
+    startv = malloc((1u << blkbits) * sizeof(*startv));
+
+    err = merr(ENOMEM);
+    if (ev(!order || !t2hash || !alone || !t2count || !revh || !startv))
+        goto errout;
+
+    rng = 0x726b2b9d438b9d4dull;
+    order[hashc] = 1;
+
+    for (tries = 0; tries < FF_BUILD_TRIES; ++tries) {
+        bool overflow = false;
+
+        ff->ff_seed = ff_splitmix64(&rng);
+
+        for (i = 0; i <= blkmask; ++i)
+            startv[i] = ((u64)i * hashc) >> blkbits;
+
+        for (i = 0; i < hashc; ++i) {
+            u64 hash = ff_mix(hashv[i] + ff->ff_seed);
+            u64 blk = hash >> (64 - blkbits);
+
+            while (order[startv[blk]] != 0)
+                blk = (blk + 1) & blkmask;
+
+            order[startv[blk]++] = hash;
+        }
+
+        dups = 0;
+
+        for (i = 0; i < hashc; ++i) {
+            u64 hash = order[i];
+            u32 h[3];
+
+            ff_hash2pos(hash, geo.seglen, geo.segcnt, h);
+
+            t2count[h[0]] += 4;
+            t2hash[h[0]] ^= hash;
+            t2count[h[1]] += 4;
+            t2count[h[1]] ^= 1;
+            t2hash[h[1]] ^= hash;
+            t2count[h[2]] += 4;
+            t2count[h[2]] ^= 2;
+            t2hash[h[2]] ^= hash;
+
+            /* A duplicate hash cancels out its twin in all three
+             * slots, so back it out again.
+             */
+            if ((t2hash[h[0]] & t2hash[h[1]] & t2hash[h[2]]) == 0) {
+                if ((t2hash[h[0]] == 0 && t2count[h[0]] == 8) ||
+                    (t2hash[h[1]] == 0 && t2count[h[1]] == 8) ||
+                    (t2hash[h[2]] == 0 && t2count[h[2]] == 8)) {
+                    ++dups;
+                    t2count[h[0]] -= 4;
+                    t2hash[h[0]] ^= hash;
+                    t2count[h[1]] -= 4;
+                    t2count[h[1]] ^= 1;
+                    t2hash[h[1]] ^= hash;
+                    t2count[h[2]] -= 4;
+                    t2count[h[2]] ^= 2;
+                    t2hash[h[2]] ^= hash;
+                }
+            }
+
+            if (t2count[h[0]] < 4 || t2count[h[1]] < 4 || t2count[h[2]] < 4)
+                overflow = true;
+        }
+
+        stacksize = 0;
+
+        if (!overflow) {
+            qsize = 0;
+            for (i = 0; i < geo.slots; ++i) {
+                alone[qsize] = i;
+                qsize += (t2count[i] >> 2) == 1;
+            }
+
+            while (qsize > 0) {
+                u32 idx = alone[--qsize];
+                u32 h[5], other;
+                u64 hash;
+                u8  found;
+
+                if ((t2count[idx] >> 2) != 1)
+                    continue;
+
+                hash = t2hash[idx];
+                found = t2count[idx] & 3;
+
+                ff_hash2pos(hash, geo.seglen, geo.segcnt, h);
+                h[3] = h[0];
+                h[4] = h[1];
+
+                revh[stacksize] = found;
+                order[stacksize++] = hash;
+
+                other = h[found + 1];
+                alone[qsize] = other;
+                qsize += (t2count[other] >> 2) == 2;
+                t2count[other] -= 4;
+                t2count[other] ^= ff_mod3(found + 1);
+                t2hash[other] ^= hash;
+
+                other = h[found + 2];
+                alone[qsize] = other;
+                qsize += (t2count[other] >> 2) == 2;
+                t2count[other] -= 4;
+                t2count[other] ^= ff_mod3(found + 2);
+                t2hash[other] ^= hash;
+            }
+
+            if (stacksize + dups == hashc)
+                break;
+
+            if (dups > 0)
+                hashc = ff_hash_dedup(hashv, hashc);
+        }
+
+        memset(order, 0, sizeof(*order) * hashc);
+        order[hashc] = 1;
+        memset(t2count, 0, sizeof(*t2count) * geo.slots);
+        memset(t2hash, 0, sizeof(*t2hash) * geo.slots);
+    }
+
+    err = merr(EAGAIN);
+    if (ev(tries >= FF_BUILD_TRIES))
+        goto errout;
+
+    /* Assign fingerprints in reverse peel order such that the slot
+     * in which each hash was peeled is the last of its three to be
+     * assigned.
+     */
+    for (i = stacksize; i-- > 0;) {
+        u64 hash = order[i];
+        u32 h[5], fp;
+        u8  found = revh[i];
+
+        ff_hash2pos(hash, geo.seglen, geo.segcnt, h);
+        h[3] = h[0];
+        h[4] = h[1];
+
+        fp = ff_fingerprint(hash, fpbits);
+        fp ^= ff_fp_get(storage, h[found + 1], fpbits);
+        fp ^= ff_fp_get(storage, h[found + 2], fpbits);
+
+        ff_fp_put(storage, h[found], fpbits, fp);
+    }
+
+    err = 0;
+
+errout:
+    free(startv);
+    free(revh);
+    free(t2count);
+    free(alone);
+    free(t2hash);
+    free(order);
+
+    return err;
+}
+
+void
+ff_lookupv(const struct fuse_filter *ff, u32 hashc, const u64 *hashv, bool *hitv)
+{
+    u64 mixv[FF_LOOKUPV_PREFETCH];
+    u32 posv[FF_LOOKUPV_PREFETCH][3];
+    u32 fpbits = ff->ff_fpbits;
+    u32 i, j, k, cnt;
+
+    for (i = 0; i < hashc; i += cnt) {
+        cnt = min_t(u32, hashc - i, FF_LOOKUPV_PREFETCH);
+
+        for (j = 0; j < cnt; ++j) {
+            mixv[j] = ff_mix(hashv[i + j] + ff->ff_seed);
+            ff_hash2pos(mixv[j], ff->ff_seglen, ff->ff_segcnt, posv[j]);
+
+            for (k = 0; k < 3; ++k)
+                __builtin_prefetch(ff->ff_data + (((u64)posv[j][k] * fpbits) >> 3));
+        }
+
+        for (j = 0; j < cnt; ++j) {
+            u32 fp = ff_fingerprint(mixv[j], fpbits);
+
+            for (k = 0; k < 3; ++k)
+                fp ^= ff_fp_get(ff->ff_data, posv[j][k], fpbits);
+
+            hitv[i + j] = (fp == 0);
+        }
+    }
+}
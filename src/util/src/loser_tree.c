@@ -0,0 +1,198 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/loser_tree.h>
+
+/*
+ * The tree is implicit: With k leaves, leaf i is at position k + i,
+ * internal nodes are at positions 1 through k - 1, and the parent of
+ * the node at position p is at position p / 2.  This works for any k,
+ * not just powers of two.  Exhausted sources have NULL ltl_data and
+ * lose every match.
+ */
+
+/* Return true if leaf a beats (i.e., is to be returned before) leaf b.
+ */
+static __always_inline bool
+lt_beats(const struct loser_tree *lt, u32 a, u32 b)
+{
+    const struct loser_tree_leaf *la = lt->lt_leafv + a;
+    const struct loser_tree_leaf *lb = lt->lt_leafv + b;
+    int                           rc;
+
+    if (unlikely(!lb->ltl_data))
+        return la->ltl_data || a < b;
+
+    if (unlikely(!la->ltl_data))
+        return false;
+
+    if (la->ltl_head != lb->ltl_head)
+        return la->ltl_head < lb->ltl_head;
+
+    rc = lt->lt_cmp(la->ltl_data, lb->ltl_data);
+
+    return rc ? rc < 0 : a < b;
+}
+
+static __always_inline void
+lt_leaf_set(struct loser_tree *lt, struct loser_tree_leaf *leaf, void *elt)
+{
+    leaf->ltl_data = elt;
+    leaf->ltl_head = lt->lt_head ? lt->lt_head(elt) : 0;
+}
+
+/* Play all the matches bottom-up.  lt_nodev[leafc..2*leafc-1] is used
+ * to hold the winners of the internal nodes while building.
+ */
+static void
+lt_build(struct loser_tree *lt)
+{
+    u32 *nodev = lt->lt_nodev;
+    u32 *winv = nodev + lt->lt_max_width;
+    u32  k = lt->lt_leafc;
+    u32  p;
+
+    if (k < 2) {
+        nodev[0] = 0;
+        return;
+    }
+
+    for (p = k - 1; p > 0; --p) {
+        u32 l = 2 * p, r = 2 * p + 1;
+        u32 a, b;
+
+        a = (l >= k) ? l - k : winv[l];
+        b = (r >= k) ? r - k : winv[r];
+
+        if (lt_beats(lt, a, b)) {
+            winv[p] = a;
+            nodev[p] = b;
+        } else {
+            winv[p] = b;
+            nodev[p] = a;
+        }
+    }
+
+    nodev[0] = winv[1];
+}
+
+/* Replay the matches from leaf w to the root after w's element changed.
+ */
+static __always_inline void
+lt_replay(struct loser_tree *lt, u32 w)
+{
+    u32 *nodev = lt->lt_nodev;
+    u32  p;
+
+    for (p = (w + lt->lt_leafc) / 2; p > 0; p /= 2) {
+        if (lt_beats(lt, nodev[p], w)) {
+            u32 tmp = nodev[p];
+
+            nodev[p] = w;
+            w = tmp;
+        }
+    }
+
+    nodev[0] = w;
+}
+
+merr_t
+loser_tree_create(
+    u32                  max_width,
+    loser_tree_cmp_fn *  cmp,
+    loser_tree_head_fn * head,
+    struct loser_tree ** lt_out)
+{
+    struct loser_tree *lt;
+    size_t             sz;
+
+    if (ev(!lt_out || !cmp || max_width == 0))
+        return merr(EINVAL);
+
+    sz = sizeof(*lt) + max_width * sizeof(lt->lt_leafv[0]);
+    sz += 2 * max_width * sizeof(lt->lt_nodev[0]);
+
+    lt = alloc_aligned(sz, SMP_CACHE_BYTES);
+    if (ev(!lt))
+        return merr(ENOMEM);
+
+    memset(lt, 0, sizeof(*lt));
+    lt->lt_cmp = cmp;
+    lt->lt_head = head;
+    lt->lt_max_width = max_width;
+    lt->lt_nodev = (u32 *)(lt->lt_leafv + max_width);
+
+    *lt_out = lt;
+
+    return 0;
+}
+
+void
+loser_tree_destroy(struct loser_tree *lt)
+{
+    free_aligned(lt);
+}
+
+merr_t
+loser_tree_prepare(struct loser_tree *lt, u32 width, struct element_source *es[])
+{
+    u32 i, j;
+
+    if (ev(width > lt->lt_max_width))
+        return merr(EOVERFLOW);
+
+    for (i = 0, j = 0; i < width; ++i) {
+        void *elt;
+
+        if (es[i] && es[i]->es_get_next(es[i], &elt)) {
+            lt->lt_leafv[j].ltl_es = es[i];
+            lt_leaf_set(lt, lt->lt_leafv + j, elt);
+            es[i]->es_sort = j;
+            ++j;
+        }
+    }
+
+    lt->lt_leafc = j;
+    lt->lt_width = j;
+
+    lt_build(lt);
+
+    return 0;
+}
+
+bool
+loser_tree_pop(struct loser_tree *lt, void **item)
+{
+    struct loser_tree_leaf *leaf;
+    struct element_source * es;
+    void *                  elt;
+    u32                     w;
+
+    if (lt->lt_width == 0) {
+        *item = 0;
+        return false;
+    }
+
+    w = lt->lt_nodev[0];
+    leaf = lt->lt_leafv + w;
+    es = leaf->ltl_es;
+
+    *item = leaf->ltl_data;
+
+    if (es->es_get_next(es, &elt)) {
+        lt_leaf_set(lt, leaf, elt);
+    } else {
+        leaf->ltl_data = NULL;
+        if (--lt->lt_width == 0)
+            return true;
+    }
+
+    lt_replay(lt, w);
+
+    return true;
+}
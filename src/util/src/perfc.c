@@ -1021,6 +1021,41 @@ perfc_dis_record_impl(struct perfc_dis *dis, u64 sample)
         perfc_latdis_record(dis, sample);
 }
 
+u32
+perfc_dis_hits(struct perfc_set *pcs, u32 cidx, u64 *hitv, u64 *boundv)
+{
+    const struct perfc_ivl *ivl;
+    struct perfc_seti *     pcsi;
+    struct perfc_dis *      dis;
+    u32                     i, j;
+
+    pcsi = perfc_ison(pcs, cidx);
+    if (!pcsi)
+        return 0;
+
+    dis = &pcsi->pcs_ctrv[cidx].dis;
+    if (ev(dis->pdi_hdr.pch_type != PERFC_TYPE_DI && dis->pdi_hdr.pch_type != PERFC_TYPE_LT))
+        return 0;
+
+    ivl = dis->pdi_ivl;
+
+    for (i = 0; i < ivl->ivl_cnt + 1; ++i) {
+        struct perfc_bkt *bkt = dis->pdi_hdr.pch_bktv + i;
+
+        hitv[i] = 0;
+
+        for (j = 0; j < PERFC_GRP_MAX; ++j) {
+            hitv[i] += atomic64_read(&bkt->pcb_hits);
+            bkt += PERFC_IVL_MAX + 1;
+        }
+
+        if (i < ivl->ivl_cnt)
+            boundv[i] = ivl->ivl_bound[i];
+    }
+
+    return ivl->ivl_cnt + 1;
+}
+
 int
 perfc_cleanup(const char *component)
 {
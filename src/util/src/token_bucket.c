@@ -167,6 +167,20 @@ tbkt_rate_get(struct tbkt *self)
     return self->tb_rate;
 }
 
+u64
+tbkt_debt_get(struct tbkt *self)
+{
+    u64 amount;
+    bool debt;
+
+    spin_lock(&self->tb_lock);
+    tbkti_refill(self);
+    debt = tbkti_status(self, &amount);
+    spin_unlock(&self->tb_lock);
+
+    return debt ? amount : 0;
+}
+
 /* Returns the number of nanoseconds the caller should
  * delay to respect the rate limit.
  */
@@ -6,7 +6,11 @@
 #define _GNU_SOURCE /* for pthread_setname_np() */
 
 #include <hse_util/assert.h>
+#include <hse_util/alloc.h>
+#include <hse_util/atomic.h>
+#include <hse_util/barrier.h>
 #include <hse_util/mutex.h>
+#include <hse_util/spinlock.h>
 #include <hse_util/condvar.h>
 #include <hse_util/minmax.h>
 #include <hse_util/page.h>
@@ -15,6 +19,9 @@
 
 #include <signal.h>
 #include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 /**
  * struct wq_priv - worker thread private data
@@ -28,6 +35,27 @@ struct wq_priv {
     pthread_t wqp_tid;
 };
 
+/**
+ * struct wq_shard - pending list shard of a WQ_SHARDED workqueue
+ * @ws_lock:     lock to protect ws_pending
+ * @ws_cnt:      number of work items (excluding barriers) on ws_pending
+ * @ws_running:  number of work items taken from this shard still running
+ * @ws_pending:  list of work to be dispatched ASAP
+ *
+ * Work is assigned to a shard by hashing its address so that the
+ * pending check in queue_work() and the removal by a worker are always
+ * serialized by the same lock.  Delayed work is kept on wq_delayed,
+ * but its pending check and its list insertions and removals are also
+ * made under its shard's lock such that queue_work() and the delayed
+ * work API cannot both find the work idle and enqueue it twice.
+ */
+struct wq_shard {
+    spinlock_t       ws_lock;
+    atomic_t         ws_cnt;
+    atomic_t         ws_running;
+    struct list_head ws_pending;
+} __aligned(SMP_CACHE_BYTES);
+
 /**
  * struct workqueue_struct - per-workqueue private data
  * @wq_lock:        lock to protect workqueue data
@@ -40,6 +68,11 @@ struct wq_priv {
  * @wq_barid:       barrier ID generator
  * @wq_tdmax:       max number of worker threads
  * @wq_delayed:     list of work to be dispatched in the future
+ * @wq_shardc:      number of pending list shards (WQ_SHARDED only)
+ * @wq_shardv:      vector of pending list shards (WQ_SHARDED only)
+ * @wq_nidle:       number of parked or parking workers (WQ_SHARDED only)
+ * @wq_parkseq:     futex on which idle workers park (WQ_SHARDED only)
+ * @wq_flushers:    number of threads in flush_workqueue() (WQ_SHARDED only)
  * @wq_name:        workqueue name (see pthread_setname_np())
  * @wq_base:        base of workqueue memory allocation for free()
  * @wq_priv:        flexible array of worker thread private data structs
@@ -55,6 +88,11 @@ struct workqueue_struct {
     uint             wq_barid;
     int              wq_tdmax;
     struct list_head wq_delayed;
+    int              wq_shardc;
+    struct wq_shard *wq_shardv;
+    atomic_t         wq_nidle;
+    atomic_t         wq_parkseq;
+    atomic_t         wq_flushers;
     char             wq_name[16];
     void *           wq_base;
     struct wq_priv   wq_priv[];
@@ -66,6 +104,14 @@ static void
 flush_barrier(struct work_struct *work);
 static void *
 worker_thread(void *arg);
+static bool
+queue_work_sharded(struct workqueue_struct *wq, struct work_struct *work);
+static void
+flush_workqueue_sharded(struct workqueue_struct *wq);
+static void
+worker_sharded(struct workqueue_struct *wq, struct wq_priv *priv);
+static void
+wq_wake_all(struct workqueue_struct *wq);
 
 struct workqueue_struct *
 alloc_workqueue(const char *fmt, unsigned int flags, int max_active, ...)
@@ -101,6 +147,28 @@ alloc_workqueue(const char *fmt, unsigned int flags, int max_active, ...)
     INIT_LIST_HEAD(&wq->wq_pending);
     INIT_LIST_HEAD(&wq->wq_delayed);
 
+    if (flags & WQ_SHARDED) {
+        wq->wq_shardv = alloc_aligned(max_active * sizeof(*wq->wq_shardv), SMP_CACHE_BYTES);
+        if (ev(!wq->wq_shardv)) {
+            cv_destroy(&wq->wq_barrier);
+            cv_destroy(&wq->wq_idle);
+            mutex_destroy(&wq->wq_lock);
+            free(base);
+            return NULL;
+        }
+
+        for (i = 0; i < max_active; i++) {
+            struct wq_shard *ws = wq->wq_shardv + i;
+
+            spin_lock_init(&ws->ws_lock);
+            atomic_set(&ws->ws_cnt, 0);
+            atomic_set(&ws->ws_running, 0);
+            INIT_LIST_HEAD(&ws->ws_pending);
+        }
+
+        wq->wq_shardc = max_active;
+    }
+
     wq->wq_tdmax = max_active;
     wq->wq_tdcnt = max_active;
     wq->wq_refcnt = max_active;
@@ -124,6 +192,48 @@ alloc_workqueue(const char *fmt, unsigned int flags, int max_active, ...)
     return wq;
 }
 
+static __always_inline void
+wq_futex_wait(atomic_t *futex, int val)
+{
+    syscall(SYS_futex, &futex->counter, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static __always_inline void
+wq_futex_wake(atomic_t *futex, int nwake)
+{
+    syscall(SYS_futex, &futex->counter, FUTEX_WAKE_PRIVATE, nwake, NULL, NULL, 0);
+}
+
+/**
+ * wq_wake_one() - awaken one parked worker of a sharded workqueue
+ * @wq:     ptr to workqueue
+ *
+ * The caller must have already appended work to a shard.  The barrier
+ * pairs with the one in worker_sharded() such that either we see the
+ * parking worker's wq_nidle increment or it sees our work.
+ */
+static __always_inline void
+wq_wake_one(struct workqueue_struct *wq)
+{
+    smp_mb();
+
+    if (atomic_read(&wq->wq_nidle) > 0) {
+        atomic_inc(&wq->wq_parkseq);
+        wq_futex_wake(&wq->wq_parkseq, 1);
+    }
+}
+
+static void
+wq_wake_all(struct workqueue_struct *wq)
+{
+    if (!wq->wq_shardv)
+        return;
+
+    smp_mb();
+    atomic_inc(&wq->wq_parkseq);
+    wq_futex_wake(&wq->wq_parkseq, INT_MAX);
+}
+
 void
 destroy_workqueue(struct workqueue_struct *wq)
 {
@@ -143,6 +253,7 @@ destroy_workqueue(struct workqueue_struct *wq)
      */
     wq->wq_shutdown = 1;
     cv_broadcast(&wq->wq_idle);
+    wq_wake_all(wq);
 
     while (wq->wq_refcnt > 0)
         cv_timedwait(&wq->wq_idle, &wq->wq_lock, 1);
@@ -156,6 +267,7 @@ destroy_workqueue(struct workqueue_struct *wq)
     cv_destroy(&wq->wq_idle);
     mutex_destroy(&wq->wq_lock);
 
+    free_aligned(wq->wq_shardv);
     free(wq->wq_base);
 }
 
@@ -171,6 +283,54 @@ workqueue_first(struct workqueue_struct *wq)
     return list_first_entry_or_null(&wq->wq_pending, struct work_struct, entry);
 }
 
+static __always_inline struct wq_shard *
+wq_shard(struct workqueue_struct *wq, const struct work_struct *work)
+{
+    u64 hash = (uintptr_t)work * 0x9e3779b97f4a7c15ull;
+
+    return wq->wq_shardv + (hash >> 32) % wq->wq_shardc;
+}
+
+/* Lock the shard to which work belongs, if the workqueue is sharded.
+ * Callers that also need wq_lock must acquire it first.
+ */
+static __always_inline struct wq_shard *
+wq_shard_lock(struct workqueue_struct *wq, const struct work_struct *work)
+{
+    struct wq_shard *ws;
+
+    if (!wq->wq_shardv)
+        return NULL;
+
+    ws = wq_shard(wq, work);
+    spin_lock(&ws->ws_lock);
+
+    return ws;
+}
+
+static __always_inline void
+wq_shard_unlock(struct wq_shard *ws)
+{
+    if (ws)
+        spin_unlock(&ws->ws_lock);
+}
+
+/* Append work to a shard.  The caller must hold ws_lock.
+ */
+static __always_inline bool
+wq_shard_enqueue(struct wq_shard *ws, struct work_struct *work)
+{
+    bool enqueued;
+
+    enqueued = !work_pending(work);
+    if (enqueued) {
+        list_add_tail(&work->entry, &ws->ws_pending);
+        atomic_inc(&ws->ws_cnt);
+    }
+
+    return enqueued;
+}
+
 #pragma push_macro("queue_work_locked")
 #undef queue_work_locked
 
@@ -204,6 +364,87 @@ flush_barrier(struct work_struct *work)
     abort();
 }
 
+/* Return true once each of the given barriers is at the head of its shard
+ * and all the work previously taken from that shard has completed.
+ */
+static bool
+flush_sharded_done(struct workqueue_struct *wq, struct wq_barrier *barv)
+{
+    bool done = true;
+    int  i;
+
+    for (i = 0; i < wq->wq_shardc && done; i++) {
+        struct wq_shard *ws = wq->wq_shardv + i;
+
+        spin_lock(&ws->ws_lock);
+        done = ws->ws_pending.next == &barv[i].wqb_work.entry;
+        spin_unlock(&ws->ws_lock);
+
+        done = done && atomic_read(&ws->ws_running) == 0;
+    }
+
+    return done;
+}
+
+/**
+ * flush_workqueue_sharded() - flush a WQ_SHARDED workqueue
+ * @wq:     ptr to workqueue
+ *
+ * Append a barrier to each shard.  A barrier at the head of a shard
+ * prevents workers from taking work from that shard, so once all our
+ * barriers have reached the heads of their shards and no work taken
+ * from any shard is still running, all work queued ahead of the
+ * barriers has completed.
+ */
+static void
+flush_workqueue_sharded(struct workqueue_struct *wq)
+{
+    struct wq_barrier barv[WQ_MAX_ACTIVE];
+    int               i;
+
+    mutex_lock(&wq->wq_lock);
+    ++wq->wq_refcnt;
+    atomic_inc(&wq->wq_flushers);
+
+    ++wq->wq_barid;
+
+    for (i = 0; i < wq->wq_shardc; i++) {
+        struct wq_shard *ws = wq->wq_shardv + i;
+
+        INIT_WORK(&barv[i].wqb_work, flush_barrier);
+        barv[i].wqb_barid = wq->wq_barid;
+        barv[i].wqb_visitors = 0;
+
+        spin_lock(&ws->ws_lock);
+        list_add_tail(&barv[i].wqb_work.entry, &ws->ws_pending);
+        spin_unlock(&ws->ws_lock);
+    }
+
+    /* Workers signal wq_barrier when a shard's running count drops to
+     * zero, but we might miss it so don't wait for too long.
+     */
+    while (!flush_sharded_done(wq, barv))
+        cv_timedwait(&wq->wq_barrier, &wq->wq_lock, 1);
+
+    for (i = 0; i < wq->wq_shardc; i++) {
+        struct wq_shard *ws = wq->wq_shardv + i;
+
+        spin_lock(&ws->ws_lock);
+        list_del_init(&barv[i].wqb_work.entry);
+        spin_unlock(&ws->ws_lock);
+    }
+
+    /* Other flushers' barriers may now be at the heads of their shards.
+     */
+    cv_broadcast(&wq->wq_barrier);
+
+    atomic_dec(&wq->wq_flushers);
+    --wq->wq_refcnt;
+    mutex_unlock(&wq->wq_lock);
+
+    wq_wake_all(wq);
+}
+
 /**
  * flush_workqueue() - enqueue a barrier and wait for it to complete
  * @wq:     ptr to workqueue
@@ -221,6 +462,11 @@ flush_workqueue(struct workqueue_struct *wq)
     if (ev(!wq))
         return;
 
+    if (wq->wq_shardv) {
+        flush_workqueue_sharded(wq);
+        return;
+    }
+
     INIT_WORK(&barrier.wqb_work, flush_barrier);
 
     mutex_lock(&wq->wq_lock);
@@ -244,6 +490,130 @@ flush_workqueue(struct workqueue_struct *wq)
     mutex_unlock(&wq->wq_lock);
 }
 
+/**
+ * wq_shard_dequeue() - take the next work item from a sharded workqueue
+ * @wq:     ptr to workqueue
+ * @home:   index of the caller's home shard
+ * @wsp:    (output) shard from which the work was taken
+ *
+ * Try the caller's home shard first, then try to steal from the other
+ * shards without waiting on their locks.  Only if that fails due to
+ * lock contention do we rescan waiting on each lock, such that a NULL
+ * return means there was no work available when we looked.
+ */
+static struct work_struct *
+wq_shard_dequeue(struct workqueue_struct *wq, int home, struct wq_shard **wsp)
+{
+    struct work_struct *work;
+    bool                contended = false;
+    int                 pass, i;
+
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0; i < wq->wq_shardc; i++) {
+            struct wq_shard *ws = wq->wq_shardv + (home + i) % wq->wq_shardc;
+
+            if (atomic_read(&ws->ws_cnt) == 0)
+                continue;
+
+            if (i == 0 || pass > 0) {
+                spin_lock(&ws->ws_lock);
+            } else if (!spin_trylock(&ws->ws_lock)) {
+                contended = true;
+                continue;
+            }
+
+            work = list_first_entry_or_null(&ws->ws_pending, struct work_struct, entry);
+            if (work && work->func != flush_barrier) {
+                list_del_init(&work->entry);
+                atomic_dec(&ws->ws_cnt);
+                atomic_inc(&ws->ws_running);
+                spin_unlock(&ws->ws_lock);
+
+                *wsp = ws;
+                return work;
+            }
+
+            spin_unlock(&ws->ws_lock);
+        }
+
+        if (!contended)
+            break;
+    }
+
+    return NULL;
+}
+
+static bool
+wq_shards_empty(struct workqueue_struct *wq)
+{
+    bool empty = true;
+    int  i;
+
+    for (i = 0; i < wq->wq_shardc && empty; i++) {
+        struct wq_shard *ws = wq->wq_shardv + i;
+
+        spin_lock(&ws->ws_lock);
+        empty = list_empty(&ws->ws_pending);
+        spin_unlock(&ws->ws_lock);
+    }
+
+    return empty;
+}
+
+/**
+ * worker_sharded() - WQ_SHARDED workqueue worker main loop
+ * @wq:     ptr to workqueue
+ * @priv:   ptr to thread private structure
+ *
+ * Returns once the workqueue is shut down and all shards are empty.
+ */
+static void
+worker_sharded(struct workqueue_struct *wq, struct wq_priv *priv)
+{
+    struct work_struct *work;
+    struct wq_shard *   ws;
+    int                 seq;
+
+    while (1) {
+        work = wq_shard_dequeue(wq, priv->wqp_id, &ws);
+        if (!work) {
+
+            /* Announce our intent to park, then rescan so that we
+             * cannot miss work queued by a producer who didn't see
+             * our wq_nidle increment (see wq_wake_one()).
+             */
+            seq = atomic_read(&wq->wq_parkseq);
+            atomic_inc(&wq->wq_nidle);
+            smp_mb();
+
+            work = wq_shard_dequeue(wq, priv->wqp_id, &ws);
+            if (!work) {
+                if (wq->wq_shutdown && wq_shards_empty(wq)) {
+                    atomic_dec(&wq->wq_nidle);
+                    break;
+                }
+
+                wq_futex_wait(&wq->wq_parkseq, seq);
+            }
+
+            atomic_dec(&wq->wq_nidle);
+
+            if (!work)
+                continue;
+        }
+
+        work->func(work);
+
+        /* Awaken flushers waiting for this shard to quiesce.
+         */
+        if (atomic_dec_return(&ws->ws_running) == 0 && atomic_read(&wq->wq_flushers) > 0) {
+            mutex_lock(&wq->wq_lock);
+            cv_broadcast(&wq->wq_barrier);
+            mutex_unlock(&wq->wq_lock);
+        }
+    }
+}
+
 /**
  * worker_thread() - thread pool worker main function
  * @arg:   ptr to thread private structure
@@ -273,6 +643,12 @@ worker_thread(void *arg)
 
     pthread_setname_np(priv->wqp_tid, wq->wq_name);
 
+    if (wq->wq_shardv) {
+        worker_sharded(wq, priv);
+        mutex_lock(&wq->wq_lock);
+        goto exit;
+    }
+
     mutex_lock(&wq->wq_lock);
 
     while (1) {
@@ -320,6 +696,7 @@ worker_thread(void *arg)
         cv_broadcast(&wq->wq_barrier);
     }
 
+exit:
     --wq->wq_tdcnt;
     --wq->wq_refcnt;
     cv_signal(&wq->wq_idle);
@@ -332,11 +709,30 @@ worker_thread(void *arg)
  * Add work to a workqueue.  Return false if work was already on a
  * queue, true otherwise.
  */
+static bool
+queue_work_sharded(struct workqueue_struct *wq, struct work_struct *work)
+{
+    struct wq_shard *ws;
+    bool             enqueued;
+
+    ws = wq_shard_lock(wq, work);
+    enqueued = wq_shard_enqueue(ws, work);
+    wq_shard_unlock(ws);
+
+    if (enqueued)
+        wq_wake_one(wq);
+
+    return enqueued;
+}
+
 bool
 queue_work(struct workqueue_struct *wq, struct work_struct *work)
 {
     bool enqueued;
 
+    if (wq->wq_shardv)
+        return queue_work_sharded(wq, work);
+
     mutex_lock(&wq->wq_lock);
     enqueued = queue_work_locked(wq, work);
     if (enqueued)
@@ -357,32 +753,47 @@ delayed_work_timer_fn(unsigned long data)
 {
     struct workqueue_struct *wq;
     struct delayed_work *    dwork;
-    bool                     enqueued;
+    struct wq_shard *        ws;
+    bool                     enqueued = false;
     bool                     pending;
 
     dwork = (struct delayed_work *)data;
     wq = dwork->wq;
 
+    /* Move the work from wq_delayed to its shard without dropping the
+     * shard lock so that a concurrent queue_work() sees it pending.
+     */
     mutex_lock(&wq->wq_lock);
+    ws = wq_shard_lock(wq, &dwork->work);
     pending = work_pending(&dwork->work);
     if (pending) {
         list_del_init(&dwork->work.entry);
-        enqueued = queue_work_locked(dwork->wq, &dwork->work);
-        if (enqueued)
-            cv_signal(&wq->wq_idle);
+
+        if (ws) {
+            enqueued = wq_shard_enqueue(ws, &dwork->work);
+        } else {
+            enqueued = queue_work_locked(dwork->wq, &dwork->work);
+            if (enqueued)
+                cv_signal(&wq->wq_idle);
+        }
 
         assert(enqueued);
     }
+    wq_shard_unlock(ws);
 
     assert(pending);
     mutex_unlock(&wq->wq_lock);
+
+    if (ws && enqueued)
+        wq_wake_one(wq);
 }
 
 bool
 queue_delayed_work(struct workqueue_struct *wq, struct delayed_work *dwork, unsigned long delay)
 {
-    bool pending;
-    u64  expires;
+    struct wq_shard *ws;
+    bool             pending;
+    u64              expires;
 
     /* Linux uses WARN_ON_ONCE() for these checks rather than assert().
      */
@@ -392,12 +803,14 @@ queue_delayed_work(struct workqueue_struct *wq, struct delayed_work *dwork, unsi
     expires = nsecs_to_jiffies(get_time_ns()) + delay;
 
     mutex_lock(&wq->wq_lock);
+    ws = wq_shard_lock(wq, &dwork->work);
     pending = work_pending(&dwork->work);
     if (!pending) {
         list_add_tail(&dwork->work.entry, &wq->wq_delayed);
         dwork->timer.expires = expires;
         dwork->wq = wq;
     }
+    wq_shard_unlock(ws);
     mutex_unlock(&wq->wq_lock);
 
     /* For simplicity, we deviate from the Linux implementation here
@@ -413,15 +826,18 @@ bool
 cancel_delayed_work(struct delayed_work *dwork)
 {
     struct workqueue_struct *wq = dwork->wq;
+    struct wq_shard *        ws;
     bool                     pending;
 
     mutex_lock(&wq->wq_lock);
+    ws = wq_shard_lock(wq, &dwork->work);
     pending = work_pending(&dwork->work);
     if (pending) {
         pending = del_timer(&dwork->timer);
         if (pending)
             list_del_init(&dwork->work.entry);
     }
+    wq_shard_unlock(ws);
     mutex_unlock(&wq->wq_lock);
 
     return pending;
@@ -486,6 +902,13 @@ workqueue_dump(struct workqueue_struct *wq)
         hse_log(HSE_ERR "%s(%p) %s", __func__, wq, buf);
     }
 
+    for (i = 0; i < wq->wq_shardc; ++i) {
+        struct wq_shard *ws = wq->wq_shardv + i;
+
+        hse_log(HSE_ERR "%s(%p)  shard %3d, cnt %d, running %d",
+                __func__, wq, i, atomic_read(&ws->ws_cnt), atomic_read(&ws->ws_running));
+    }
+
     i = 0;
     list_for_each_entry (d, &wq->wq_delayed, work.entry) {
         n = snprintf(
@@ -139,6 +139,58 @@ MTF_DEFINE_UTEST(bloom_filter_basic, BasicInsert)
     }
 }
 
+MTF_DEFINE_UTEST(bloom_filter_basic, LookupImpl)
+{
+    const size_t sz = PAGE_SIZE * 4;
+    u64          hashv[64];
+    bool         hitv[NELEM(hashv)];
+    u8 *         bits;
+    u32          shift, rotl, i;
+    s32          n;
+
+    bits = alloc_aligned(sz, PAGE_SIZE);
+    ASSERT_NE(NULL, bits);
+
+    /* Compare the dispatched probe against the reference scalar probe
+     * over partially populated buckets, for all supported bucket sizes,
+     * a range of rotations, and hash counts that are not multiples of
+     * the vector width.
+     */
+    for (i = 0; i < sz; ++i)
+        bits[i] = hse_hash64(&i, sizeof(i)) | hse_hash64(&i, 1);
+
+    for (shift = 9; shift <= 15; ++shift) {
+        u32 mask = (1u << shift) - 1;
+
+        for (rotl = 1; rotl < 64; rotl += 5) {
+            for (n = 0; n <= 16; ++n) {
+                for (i = 0; i < 128; ++i) {
+                    u64       hash = hse_hash64(&i, sizeof(i)) + rotl;
+                    const u8 *bkt = bits + bf_hash2bkt(hash, sz * CHAR_BIT, shift);
+
+                    ASSERT_EQ(
+                        bf_lookup_scalar(hash, bkt, n, rotl, mask),
+                        bf_lookup(hash, bkt, n, rotl, mask));
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < NELEM(hashv); ++i)
+        hashv[i] = hse_hash64(&i, sizeof(i));
+
+    bf_lookupv(bits, sz * CHAR_BIT, BF_BKTSHIFT, 7, BF_ROTL, (1u << BF_BKTSHIFT) - 1,
+               NELEM(hashv), hashv, hitv);
+
+    for (i = 0; i < NELEM(hashv); ++i) {
+        const u8 *bkt = bits + bf_hash2bkt(hashv[i], sz * CHAR_BIT, BF_BKTSHIFT);
+
+        ASSERT_EQ(bf_lookup_scalar(hashv[i], bkt, 7, BF_ROTL, (1u << BF_BKTSHIFT) - 1), hitv[i]);
+    }
+
+    free_aligned(bits);
+}
+
 MTF_DEFINE_UTEST(bloom_filter_basic, RepeatableBasic)
 {
     const char *buf1 = "The cow jumped over the moon";
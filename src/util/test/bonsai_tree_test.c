@@ -17,6 +17,7 @@
 #include <hse_util/bonsai_tree.h>
 #include <hse_util/platform.h>
 #include <hse_util/keycmp.h>
+#include <hse_util/byteorder.h>
 #include <hse_util/seqno.h>
 
 #include "../src/bonsai_tree_pvt.h"
@@ -1448,6 +1449,100 @@ bonsai_update_test(enum bonsai_alloc_mode allocm, struct mtf_test_info *lcl_ti)
     cheap = NULL;
 }
 
+/* Insert keys copied by bn_kv_alloc(), including a second copy of each
+ * key (as when two threads race to insert the same key), then verify
+ * that each key appears once with both of its values.
+ */
+void
+bonsai_insert_kv_test(enum bonsai_alloc_mode allocm, struct mtf_test_info *lcl_ti)
+{
+    const int           LEN = 1000;
+    struct bonsai_root *tree;
+    struct bonsai_skey  skey = { 0 };
+    struct bonsai_sval  sval = { 0 };
+    struct bonsai_kv *  kv;
+    struct bonsai_kv *  curr;
+    struct bonsai_val * v;
+    u64                 key, value;
+    merr_t              err;
+    bool                found;
+    int                 i, j, cnt;
+
+    init_tree(&tree, allocm);
+
+    for (j = 0; j < 2; ++j) {
+        for (i = 0; i < LEN; ++i) {
+            key = cpu_to_be64(i);
+            value = i + j * LEN;
+
+            bn_skey_init(&key, sizeof(key), 0, &skey);
+            bn_sval_init(&value, sizeof(value), HSE_ORDNL_TO_SQNREF(j), &sval);
+
+            kv = NULL;
+            err = bn_kv_alloc(tree, &skey, &sval, &kv);
+            ASSERT_EQ(0, err);
+            ASSERT_NE(NULL, kv);
+
+            rcu_read_lock();
+            err = bn_insert_kv(tree, kv, false);
+            rcu_read_unlock();
+            ASSERT_EQ(0, err);
+        }
+    }
+
+    key = cpu_to_be64(LEN);
+    bn_skey_init(&key, sizeof(key), 0, &skey);
+    bn_sval_init(HSE_CORE_TOMB_REG, 0, HSE_ORDNL_TO_SQNREF(2), &sval);
+
+    err = bn_kv_alloc(tree, &skey, &sval, &kv);
+    ASSERT_EQ(0, err);
+
+    rcu_read_lock();
+    err = bn_insert_kv(tree, kv, true);
+    rcu_read_unlock();
+    ASSERT_EQ(0, err);
+
+    rcu_read_lock();
+    cnt = 0;
+    curr = rcu_dereference(tree->br_kv.bkv_next);
+    while (curr != &tree->br_kv) {
+        ++cnt;
+        curr = rcu_dereference(curr->bkv_next);
+    }
+    ASSERT_EQ(LEN + 1, cnt);
+
+    for (i = 0; i < LEN; ++i) {
+        key = cpu_to_be64(i);
+        bn_skey_init(&key, sizeof(key), 0, &skey);
+
+        found = bn_find(tree, &skey, &kv);
+        ASSERT_EQ(true, found);
+
+        for (j = 0; j < 2; ++j) {
+            v = findValue(kv, j, 0);
+            ASSERT_NE(NULL, v);
+            ASSERT_EQ(j, HSE_SQNREF_TO_ORDNL(v->bv_seqnoref));
+            memcpy(&value, v->bv_value, sizeof(value));
+            ASSERT_EQ(i + j * LEN, value);
+        }
+    }
+
+    key = cpu_to_be64(LEN);
+    bn_skey_init(&key, sizeof(key), 0, &skey);
+
+    found = bn_find(tree, &skey, &kv);
+    ASSERT_EQ(true, found);
+
+    v = findValue(kv, 2, 0);
+    ASSERT_NE(NULL, v);
+    ASSERT_EQ(HSE_CORE_TOMB_REG, v->bv_valuep);
+    rcu_read_unlock();
+
+    bn_destroy(tree);
+    cheap_destroy(cheap);
+    cheap = NULL;
+}
+
 void
 bonsai_original_test(enum bonsai_alloc_mode allocm, struct mtf_test_info *lcl_ti)
 {
@@ -1612,6 +1707,11 @@ MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, update, no_fail_pre, no_fail_post)
     bonsai_update_test(HSE_ALLOC_CURSOR, lcl_ti);
 }
 
+MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, insert_kv, no_fail_pre, no_fail_post)
+{
+    bonsai_insert_kv_test(HSE_ALLOC_CURSOR, lcl_ti);
+}
+
 MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, original, no_fail_pre, no_fail_post)
 {
     bonsai_original_test(HSE_ALLOC_CURSOR, lcl_ti);
@@ -13,6 +13,7 @@
 #include <fcntl.h>
 #include <uuid/uuid.h>
 #include <sys/mman.h>
+#include <pthread.h>
 
 #include <hse_ut/framework.h>
 
@@ -296,6 +297,92 @@ MTF_DEFINE_UTEST(cheap_test, cheap_test_memalign)
     cheap_destroy(h);
 }
 
+struct cheap_concurrent_arg {
+    struct cheap *h;
+    size_t        sz;
+    int           cnt;
+    int           id;
+    void **       ptrv;
+};
+
+static void *
+cheap_concurrent_main(void *rock)
+{
+    struct cheap_concurrent_arg *arg = rock;
+    int                          i;
+
+    for (i = 0; i < arg->cnt; ++i) {
+        void *p = cheap_memalign_concurrent(arg->h, 16, arg->sz);
+
+        if (p)
+            memset(p, arg->id, arg->sz);
+        arg->ptrv[i] = p;
+    }
+
+    return NULL;
+}
+
+/* Verify cheap_memalign_concurrent() never hands out overlapping ranges. */
+MTF_DEFINE_UTEST(cheap_test, cheap_test_concurrent)
+{
+    struct cheap_concurrent_arg argv[8];
+    pthread_t                   tidv[8];
+    const int                   cnt = 4096;
+    const size_t                sz = 48;
+    struct cheap *              h;
+    size_t                      used;
+    int                         i, j, k, rc;
+
+    h = cheap_create(8, 64 << 20);
+    ASSERT_NE(NULL, h);
+
+    used = cheap_used(h);
+
+    for (i = 0; i < NELEM(argv); ++i) {
+        argv[i].h = h;
+        argv[i].sz = sz;
+        argv[i].cnt = cnt;
+        argv[i].id = i + 1;
+        argv[i].ptrv = calloc(cnt, sizeof(void *));
+        ASSERT_NE(NULL, argv[i].ptrv);
+
+        rc = pthread_create(tidv + i, NULL, cheap_concurrent_main, argv + i);
+        ASSERT_EQ(0, rc);
+    }
+
+    for (i = 0; i < NELEM(argv); ++i) {
+        rc = pthread_join(tidv[i], NULL);
+        ASSERT_EQ(0, rc);
+    }
+
+    /* Each allocation must still hold the pattern written by its owner.
+     */
+    for (i = 0; i < NELEM(argv); ++i) {
+        for (j = 0; j < cnt; ++j) {
+            u8 *p = argv[i].ptrv[j];
+
+            ASSERT_NE(NULL, p);
+            ASSERT_TRUE(IS_ALIGNED((uintptr_t)p, 16));
+
+            for (k = 0; k < sz; ++k)
+                ASSERT_EQ(argv[i].id, p[k]);
+        }
+
+        free(argv[i].ptrv);
+    }
+
+    ASSERT_GE(cheap_used(h) - used, NELEM(argv) * cnt * sz);
+
+    /* Allocations that don't fit must fail without moving the cursor.
+     */
+    used = cheap_used(h);
+    ASSERT_EQ(NULL, cheap_memalign_concurrent(h, 16, cheap_avail(h) + 1));
+    ASSERT_EQ(NULL, cheap_memalign_concurrent(h, 3, 8));
+    ASSERT_EQ(used, cheap_used(h));
+
+    cheap_destroy(h);
+}
+
 /* Verify cheap_free() works as expected. */
 MTF_DEFINE_UTEST(cheap_test, cheap_test_free)
 {
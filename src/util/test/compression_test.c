@@ -5,6 +5,8 @@
 
 #include <hse_util/platform.h>
 #include <hse_util/compression_lz4.h>
+#include <hse_util/compression_zstd.h>
+#include <hse_util/xrand.h>
 
 #include <hse_ut/framework.h>
 
@@ -37,7 +39,7 @@ MTF_DEFINE_UTEST(compression_test, compress)
 
     /* Compress the full source buffer, output to cbuf...
      */
-    err = compress_lz4_ops.cop_compress(src, srcsz, cbuf, cbufsz, &cbuflen);
+    err = compress_lz4_ops.cop_compress(src, srcsz, cbuf, cbufsz, &cbuflen, 0);
     if (err)
         hse_elog(HSE_ERR "%s: srcsz %zu, cbufsz %zu, cbuflen %u: @@e",
                  err, __func__, srcsz, cbufsz, cbuflen);
@@ -77,7 +79,7 @@ MTF_DEFINE_UTEST(compression_test, compress)
     for (i = 0; i < 32; ++i) {
         srcsz = 512 + 8 - i;
 
-        err = compress_lz4_ops.cop_compress(src + i, srcsz, cbuf + i, cbufsz - i, &cbuflen);
+        err = compress_lz4_ops.cop_compress(src + i, srcsz, cbuf + i, cbufsz - i, &cbuflen, 0);
         if (err)
             hse_elog(HSE_ERR "%s: srcsz %zu, cbufsz %zu, cbuflen %u: @@e",
                      err, __func__, srcsz, cbufsz - i, cbuflen);
@@ -133,7 +135,7 @@ MTF_DEFINE_UTEST(compression_test, mongo)
 
     /* Compress the full source buffer, output to cbuf...
      */
-    err = compress_lz4_ops.cop_compress(srcv, srcsz, cbuf, cbufsz, &cbuflen);
+    err = compress_lz4_ops.cop_compress(srcv, srcsz, cbuf, cbufsz, &cbuflen, 0);
     if (err)
         hse_elog(HSE_ERR "%s: srcsz %zu, cbufsz %zu, cbuflen %u: @@e",
                  err, __func__, srcsz, cbufsz, cbuflen);
@@ -162,5 +164,216 @@ MTF_DEFINE_UTEST(compression_test, mongo)
     free(cbuf);
 }
 
+MTF_DEFINE_UTEST(compression_test, registry)
+{
+    const struct compress_ops *cops;
+
+    cops = compress_codec_ops(COMPRESS_CODEC_LZ4);
+    ASSERT_EQ(&compress_lz4_ops, cops);
+    ASSERT_EQ(cops, compress_codec_lookup("lz4"));
+    ASSERT_EQ(COMPRESS_CODEC_LZ4, cops->cop_codec);
+
+    ASSERT_EQ(NULL, compress_codec_ops(COMPRESS_CODEC_MAX));
+    ASSERT_EQ(NULL, compress_codec_lookup("none"));
+    ASSERT_EQ(NULL, compress_codec_lookup("snappy"));
+
+#ifdef HAVE_ZSTD
+    cops = compress_codec_ops(COMPRESS_CODEC_ZSTD);
+    ASSERT_EQ(&compress_zstd_ops, cops);
+    ASSERT_EQ(cops, compress_codec_lookup("zstd"));
+    ASSERT_EQ(COMPRESS_CODEC_ZSTD, cops->cop_codec);
+    ASSERT_GT(cops->cop_level_max, 0);
+#else
+    ASSERT_EQ(NULL, compress_codec_ops(COMPRESS_CODEC_ZSTD));
+    ASSERT_EQ(NULL, compress_codec_lookup("zstd"));
+#endif
+}
+
+MTF_DEFINE_UTEST(compression_test, codec_unsupported)
+{
+    char   buf[16];
+    uint   len;
+    merr_t err;
+
+    err = compress_codec_decompress(COMPRESS_CODEC_MAX, buf, sizeof(buf), buf, sizeof(buf), &len);
+    ASSERT_EQ(ENOTSUP, merr_errno(err));
+}
+
+/* Generate a small JSON document resembling a typical application value.
+ * Field names repeat across documents whereas field values mostly do not,
+ * which is the case for which a trained dictionary helps the most.
+ */
+static uint
+json_value(struct xrand *xr, char *buf, size_t bufsz)
+{
+    static const char *statev[] = { "active", "suspended", "closed", "pending" };
+    int n;
+
+    n = snprintf(buf, bufsz,
+                 "{\"id\":%lu,\"user\":\"user%06lu\",\"email\":\"user%06lu@example.com\","
+                 "\"state\":\"%s\",\"balance\":%lu.%02lu,\"created\":\"2020-%02lu-%02luT%02lu:%02lu:00Z\","
+                 "\"tags\":[\"t%lu\",\"t%lu\"]}",
+                 xrand64(xr) % 100000000, xrand64(xr) % 1000000, xrand64(xr) % 1000000,
+                 statev[xrand64(xr) % NELEM(statev)], xrand64(xr) % 100000, xrand64(xr) % 100,
+                 xrand64(xr) % 12 + 1, xrand64(xr) % 28 + 1, xrand64(xr) % 24, xrand64(xr) % 60,
+                 xrand64(xr) % 64, xrand64(xr) % 64);
+
+    return min_t(uint, n, bufsz - 1);
+}
+
+#define NVALS   (8192)
+#define VALSZ   (256)
+
+struct json_corpus {
+    char   *jc_buf;
+    size_t  jc_lenv[NVALS];
+    size_t  jc_total;
+};
+
+static int
+json_corpus_init(struct json_corpus *jc)
+{
+    struct xrand xr;
+    int          i;
+
+    jc->jc_buf = malloc(NVALS * VALSZ);
+    if (!jc->jc_buf)
+        return ENOMEM;
+
+    xrand_init(&xr, 1234);
+    jc->jc_total = 0;
+
+    for (i = 0; i < NVALS; ++i) {
+        jc->jc_lenv[i] = json_value(&xr, jc->jc_buf + jc->jc_total, VALSZ);
+        jc->jc_total += jc->jc_lenv[i];
+    }
+
+    return 0;
+}
+
+/* Compress and decompress each value of the corpus individually, as
+ * is done by ikvdb_kvs_put() and kvset_lookup_val(), and report the
+ * aggregate compression ratio and decode throughput.
+ */
+static int
+json_bench(
+    const char                 *name,
+    const struct compress_ops  *cops,
+    const struct compress_dict *dict,
+    int                         level,
+    struct json_corpus         *jc)
+{
+    char   *cbuf, dbuf[VALSZ];
+    uint   *clenv, dlen;
+    size_t  ctotal, off, cbufsz;
+    u64     tstart, tstop;
+    merr_t  err = 0;
+    int     i, pass;
+
+    cbufsz = cops->cop_estimate(NULL, VALSZ);
+    cbuf = malloc(NVALS * cbufsz);
+    clenv = malloc(NVALS * sizeof(*clenv));
+    if (!cbuf || !clenv) {
+        free(cbuf);
+        free(clenv);
+        return ENOMEM;
+    }
+
+    for (i = 0, off = 0, ctotal = 0; i < NVALS; off += jc->jc_lenv[i++]) {
+        if (dict)
+            err = cops->cop_compress_dict(
+                dict, jc->jc_buf + off, jc->jc_lenv[i], cbuf + i * cbufsz, cbufsz, &clenv[i]);
+        else
+            err = cops->cop_compress(
+                jc->jc_buf + off, jc->jc_lenv[i], cbuf + i * cbufsz, cbufsz, &clenv[i], level);
+        if (err)
+            goto errout;
+
+        ctotal += clenv[i];
+    }
+
+    tstart = get_time_ns();
+
+    for (pass = 0; pass < 8; ++pass) {
+        for (i = 0, off = 0; i < NVALS; off += jc->jc_lenv[i++]) {
+            if (dict)
+                err = cops->cop_decompress_dict(
+                    dict, cbuf + i * cbufsz, clenv[i], dbuf, sizeof(dbuf), &dlen);
+            else
+                err = cops->cop_decompress(cbuf + i * cbufsz, clenv[i], dbuf, sizeof(dbuf), &dlen);
+            if (err)
+                goto errout;
+
+            if (dlen != jc->jc_lenv[i] || memcmp(dbuf, jc->jc_buf + off, dlen)) {
+                err = merr(EINVAL);
+                goto errout;
+            }
+        }
+    }
+
+    tstop = get_time_ns();
+
+    hse_log(HSE_NOTICE "%-12s level %2d: %zu -> %zu bytes, ratio %.2f, decode %.1f MB/s",
+            name, level, jc->jc_total, ctotal, (double)jc->jc_total / ctotal,
+            (pass * jc->jc_total * 1000.0) / (tstop - tstart + 1));
+
+errout:
+    free(clenv);
+    free(cbuf);
+
+    return merr_errno(err);
+}
+
+MTF_DEFINE_UTEST(compression_test, json_ratio_throughput)
+{
+    struct json_corpus jc;
+    int                rc;
+
+    rc = json_corpus_init(&jc);
+    ASSERT_EQ(0, rc);
+
+    rc = json_bench("lz4", &compress_lz4_ops, NULL, 0, &jc);
+    ASSERT_EQ(0, rc);
+
+#ifdef HAVE_ZSTD
+    {
+        const struct compress_ops *cops = &compress_zstd_ops;
+        struct compress_dict *     dict;
+        char *                     dictbuf;
+        uint                       dictlen;
+        merr_t                     err;
+        int                        level;
+
+        for (level = 1; level <= cops->cop_level_max; level += 6) {
+            rc = json_bench("zstd", cops, NULL, level, &jc);
+            ASSERT_EQ(0, rc);
+        }
+
+        /* Train on the first quarter of the corpus, then compress the
+         * entire corpus with the trained dictionary.
+         */
+        dictbuf = malloc(16 * 1024);
+        ASSERT_NE(NULL, dictbuf);
+
+        err = cops->cop_dict_train(jc.jc_buf, jc.jc_lenv, NVALS / 4, dictbuf, 16 * 1024, &dictlen);
+        ASSERT_EQ(0, err);
+        ASSERT_GT(dictlen, 0);
+
+        for (level = 1; level <= cops->cop_level_max; level += 6) {
+            err = cops->cop_dict_create(dictbuf, dictlen, level, &dict);
+            ASSERT_EQ(0, err);
+
+            rc = json_bench("zstd+dict", cops, dict, level, &jc);
+            ASSERT_EQ(0, rc);
+
+            cops->cop_dict_destroy(dict);
+        }
+
+        free(dictbuf);
+    }
+#endif
+
+    free(jc.jc_buf);
+}
 
 MTF_END_UTEST_COLLECTION(compression_test)
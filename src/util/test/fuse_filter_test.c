@@ -0,0 +1,142 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2015-2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_ut/framework.h>
+
+#include <hse_util/fuse_filter.h>
+#include <hse_util/hse_err.h>
+#include <hse_util/hash.h>
+
+static u64
+test_hash(u64 i)
+{
+    return hse_hash64(&i, sizeof(i));
+}
+
+MTF_BEGIN_UTEST_COLLECTION(fuse_filter_basic);
+
+MTF_DEFINE_UTEST(fuse_filter_basic, Estimates)
+{
+    u32 fpbits, nkeys, last;
+
+    ASSERT_EQ(FF_FPBITS_MIN, ff_fpbits_est(1000000));
+    ASSERT_EQ(7, ff_fpbits_est(10000));
+    ASSERT_EQ(14, ff_fpbits_est(100));
+    ASSERT_EQ(FF_FPBITS_MAX, ff_fpbits_est(0));
+
+    for (fpbits = FF_FPBITS_MIN; fpbits <= 16; ++fpbits) {
+        last = 0;
+
+        for (nkeys = 1; nkeys < 1000000; nkeys = nkeys * 3 + 1) {
+            size_t sz = ff_size_estimate(fpbits, nkeys);
+
+            ASSERT_GE(ff_element_estimate(fpbits, sz), nkeys);
+            ASSERT_GT(sz, last);
+            last = sz;
+        }
+    }
+}
+
+MTF_DEFINE_UTEST(fuse_filter_basic, NoFalseNegatives)
+{
+    const u32          nkeys = 100000;
+    struct fuse_filter ff;
+    u64 *              hashv;
+    u8 *               data;
+    size_t             sz;
+    merr_t             err;
+    u32                i;
+
+    hashv = malloc(nkeys * sizeof(*hashv));
+    ASSERT_NE(NULL, hashv);
+
+    /* Every tenth hash is a duplicate of its predecessor, as happens
+     * when kblock keys share a soft prefix.
+     */
+    for (i = 0; i < nkeys; ++i)
+        hashv[i] = test_hash((i % 10 == 9) ? i - 1 : i);
+
+    sz = ff_size_estimate(8, nkeys);
+    data = malloc(sz);
+    ASSERT_NE(NULL, data);
+
+    err = ff_filter_build(&ff, 8, nkeys, hashv, data, sz);
+    ASSERT_EQ(0, err);
+    ASSERT_LE(ff.ff_datasz, sz);
+
+    for (i = 0; i < nkeys; ++i) {
+        u64 hash = test_hash(i - (i % 10 == 9));
+
+        ASSERT_TRUE(
+            ff_lookup(ff.ff_data, ff.ff_seed, ff.ff_seglen, ff.ff_segcnt, ff.ff_fpbits, hash));
+    }
+
+    free(data);
+    free(hashv);
+}
+
+MTF_DEFINE_UTEST(fuse_filter_basic, FalsePositiveRate)
+{
+    const u32          nkeys = 50000;
+    const u32          nprobes = 200000;
+    struct fuse_filter ff;
+    u64 *              hashv;
+    bool *             hitv;
+    u8 *               data;
+    size_t             sz;
+    merr_t             err;
+    u32                i, fp;
+
+    hashv = malloc(nprobes * sizeof(*hashv));
+    hitv = malloc(nprobes * sizeof(*hitv));
+    ASSERT_NE(NULL, hashv);
+    ASSERT_NE(NULL, hitv);
+
+    for (i = 0; i < nkeys; ++i)
+        hashv[i] = test_hash(i);
+
+    sz = ff_size_estimate(7, nkeys);
+    data = malloc(sz);
+    ASSERT_NE(NULL, data);
+
+    err = ff_filter_build(&ff, 7, nkeys, hashv, data, sz);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < nprobes; ++i)
+        hashv[i] = test_hash(nkeys + i);
+
+    ff_lookupv(&ff, nprobes, hashv, hitv);
+
+    for (i = fp = 0; i < nprobes; ++i)
+        fp += hitv[i];
+
+    /* Expect 1/128 (about 1560 of 200000), allow for some slop.
+     */
+    ASSERT_LT(fp, nprobes / 100);
+
+    free(data);
+    free(hitv);
+    free(hashv);
+}
+
+MTF_DEFINE_UTEST(fuse_filter_basic, NoSpace)
+{
+    struct fuse_filter ff;
+    u64                hashv[1000];
+    u8                 data[64];
+    merr_t             err;
+    u32                i;
+
+    for (i = 0; i < NELEM(hashv); ++i)
+        hashv[i] = test_hash(i);
+
+    err = ff_filter_build(&ff, 8, NELEM(hashv), hashv, data, sizeof(data));
+    ASSERT_EQ(ENOSPC, merr_errno(err));
+
+    err = ff_filter_build(&ff, FF_FPBITS_MAX + 1, NELEM(hashv), hashv, data, sizeof(data));
+    ASSERT_EQ(EINVAL, merr_errno(err));
+}
+
+MTF_END_UTEST_COLLECTION(fuse_filter_basic)
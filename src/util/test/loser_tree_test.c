@@ -0,0 +1,339 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2020 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_ut/framework.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/logging.h>
+#include <hse_util/bin_heap.h>
+#include <hse_util/loser_tree.h>
+#include <hse_util/key_util.h>
+#include <hse_util/xrand.h>
+
+#include "sample_element_source.h"
+
+static int
+u32_cmp(const void *a, const void *b)
+{
+    const u32 a_val = *(const u32 *)a;
+    const u32 b_val = *(const u32 *)b;
+
+    return (a_val > b_val) - (a_val < b_val);
+}
+
+static u64
+u32_head(const void *a)
+{
+    return *(const u32 *)a;
+}
+
+/* Compare only the low 24 bits, the high 8 bits identify the source.
+ */
+static int
+ks_cmp(const void *a, const void *b)
+{
+    const u32 *a_val = a;
+    const u32 *b_val = b;
+
+    return (*a_val & 0xffffff) - (*b_val & 0xffffff);
+}
+
+#define getval(x) (*(x)&0xffffff)
+#define getsrc(x) (*(x) >> 24)
+
+MTF_BEGIN_UTEST_COLLECTION(loser_tree_test);
+
+MTF_DEFINE_UTEST(loser_tree_test, create)
+{
+    struct loser_tree *lt;
+    merr_t             err;
+    void *             item;
+
+    err = loser_tree_create(0, u32_cmp, NULL, &lt);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    err = loser_tree_create(4, NULL, NULL, &lt);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    err = loser_tree_create(4, u32_cmp, NULL, &lt);
+    ASSERT_EQ(0, err);
+
+    err = loser_tree_prepare(lt, 5, NULL);
+    ASSERT_EQ(EOVERFLOW, merr_errno(err));
+
+    err = loser_tree_prepare(lt, 0, NULL);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, loser_tree_width(lt));
+    ASSERT_FALSE(loser_tree_peek(lt, &item));
+    ASSERT_FALSE(loser_tree_pop(lt, &item));
+    ASSERT_EQ(NULL, item);
+
+    loser_tree_destroy(lt);
+    loser_tree_destroy(NULL);
+}
+
+MTF_DEFINE_UTEST(loser_tree_test, sorted)
+{
+    const u32 maxwidth = 33;
+
+    struct sample_es *     es[maxwidth];
+    struct element_source *handles[maxwidth];
+    struct loser_tree *    lt;
+    merr_t                 err;
+    u32                    width, i, cnt, last, *item;
+    int                    pass;
+
+    for (pass = 0; pass < 2; ++pass) {
+        for (width = 1; width <= maxwidth; width += 4) {
+            err = loser_tree_create(width, u32_cmp, pass ? u32_head : NULL, &lt);
+            ASSERT_EQ(0, err);
+
+            for (i = 0; i < width; ++i) {
+                err = sample_es_create(&es[i], 1000 + i, SES_RANDOM);
+                ASSERT_EQ(0, err);
+                sample_es_sort(es[i]);
+                handles[i] = sample_es_get_es_handle(es[i]);
+            }
+
+            err = loser_tree_prepare(lt, width, handles);
+            ASSERT_EQ(0, err);
+            ASSERT_EQ(width, loser_tree_width(lt));
+
+            cnt = last = 0;
+            while (loser_tree_pop(lt, (void **)&item)) {
+                ASSERT_LE(last, *item);
+                last = *item;
+                ++cnt;
+            }
+
+            ASSERT_EQ(width * 1000 + width * (width - 1) / 2, cnt);
+            ASSERT_EQ(0, loser_tree_width(lt));
+
+            for (i = 0; i < width; ++i)
+                sample_es_destroy(es[i]);
+
+            loser_tree_destroy(lt);
+        }
+    }
+}
+
+MTF_DEFINE_UTEST(loser_tree_test, dups)
+{
+    const u32 width = 5;
+
+    struct sample_es *     es[width];
+    struct element_source *handles[width + 1];
+    struct loser_tree *    lt;
+    u32 *                  item, *dup;
+    merr_t                 err;
+    u32                    i, last, src;
+
+    /* Identical keys in each source, differing srcids.  Include a NULL
+     * source which must be skipped.
+     */
+    for (i = 0; i < width; ++i) {
+        err = sample_es_create_srcid(&es[i], 1123, 0, i, SES_LINEAR);
+        ASSERT_EQ(0, err);
+        handles[i + (i > 1)] = sample_es_get_es_handle(es[i]);
+    }
+    handles[2] = NULL;
+
+    err = loser_tree_create(width + 1, ks_cmp, NULL, &lt);
+    ASSERT_EQ(0, err);
+
+    err = loser_tree_prepare(lt, width + 1, handles);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(width, loser_tree_width(lt));
+
+    for (i = 0; i < width; ++i)
+        ASSERT_EQ(i, sample_es_get_es_handle(es[i])->es_sort);
+
+    last = U32_MAX;
+    while (loser_tree_pop(lt, (void **)&item)) {
+        ASSERT_EQ(0, getsrc(item));
+        ASSERT_TRUE(last == U32_MAX || last < getval(item));
+        last = getval(item);
+
+        /* Duplicates must come out in source order. */
+        src = 0;
+        while (loser_tree_peek(lt, (void **)&dup)) {
+            if (getval(dup) != last)
+                break;
+            ASSERT_EQ(src + 1, getsrc(dup));
+            src = getsrc(dup);
+            loser_tree_pop(lt, (void **)&dup);
+        }
+        ASSERT_EQ(width - 1, src);
+    }
+
+    ASSERT_EQ(1122, last);
+
+    loser_tree_destroy(lt);
+
+    for (i = 0; i < width; ++i)
+        sample_es_destroy(es[i]);
+}
+
+/* Key source for the merge benchmark: an array of sorted keys with a
+ * common prefix, as is typical of a kvset.
+ */
+#define BENCH_KLEN  (24)
+
+struct key_es {
+    struct element_source kes_es;
+    struct key_obj        kes_kobj;
+    char *                kes_keys;
+    u32                   kes_cnt;
+    u32                   kes_idx;
+};
+
+static bool
+key_es_next(struct element_source *es, void **item)
+{
+    struct key_es *kes = container_of(es, struct key_es, kes_es);
+
+    if (kes->kes_idx >= kes->kes_cnt)
+        return false;
+
+    kes->kes_kobj.ko_sfx = kes->kes_keys + kes->kes_idx++ * BENCH_KLEN;
+    *item = &kes->kes_kobj;
+
+    return true;
+}
+
+static ulong bench_ncmp;
+
+static int
+bench_cmp(const void *a, const void *b)
+{
+    ++bench_ncmp;
+    return key_obj_cmp(a, b);
+}
+
+static u64
+bench_head(const void *a)
+{
+    return key_obj_head64(a);
+}
+
+static int
+key_cmp(const void *a, const void *b)
+{
+    return memcmp(a, b, BENCH_KLEN);
+}
+
+static void
+key_es_rewind(struct key_es *kesv, u32 width)
+{
+    u32 i;
+
+    for (i = 0; i < width; ++i)
+        kesv[i].kes_idx = 0;
+}
+
+/* Merge width sources of sorted random keys with bin_heap2, with a loser
+ * tree, and with a loser tree with cached key heads, and report the time
+ * per element and comparator calls per element for each.
+ */
+MTF_DEFINE_UTEST(loser_tree_test, bench)
+{
+    const u32 maxwidth = 64, total = 1u << 20;
+
+    struct element_source *esv[maxwidth];
+    struct key_es          kesv[maxwidth];
+    struct xrand           xr;
+    u32                    width, i, j, cnt;
+
+    xrand_init(&xr, 42);
+
+    for (width = 2; width <= maxwidth; width *= 2) {
+        struct bin_heap2  *bh;
+        struct loser_tree *lt;
+        ulong              ns[3], ncmp[3];
+        merr_t             err;
+        void *             item;
+        u64                t;
+        int                m;
+
+        cnt = total / width;
+
+        for (i = 0; i < width; ++i) {
+            struct key_es *kes = kesv + i;
+
+            kes->kes_keys = malloc(cnt * BENCH_KLEN);
+            ASSERT_NE(NULL, kes->kes_keys);
+
+            /* Keys share a 4-byte prefix, the next 8 bytes are random.
+             */
+            for (j = 0; j < cnt; ++j) {
+                char *key = kes->kes_keys + j * BENCH_KLEN;
+                u64   r = xrand64(&xr);
+
+                memcpy(key, "tbl0", 4);
+                memcpy(key + 4, &r, sizeof(r));
+                memset(key + 12, 'x', BENCH_KLEN - 12);
+            }
+
+            qsort(kes->kes_keys, cnt, BENCH_KLEN, key_cmp);
+
+            kes->kes_es = es_make(key_es_next, NULL, NULL);
+            kes->kes_kobj.ko_pfx = NULL;
+            kes->kes_kobj.ko_pfx_len = 0;
+            kes->kes_kobj.ko_sfx_len = BENCH_KLEN;
+            kes->kes_cnt = cnt;
+            esv[i] = &kes->kes_es;
+        }
+
+        for (m = 0; m < 3; ++m) {
+            key_es_rewind(kesv, width);
+            bench_ncmp = 0;
+            j = 0;
+
+            if (m == 0) {
+                err = bin_heap2_create(width, bench_cmp, &bh);
+                ASSERT_EQ(0, err);
+
+                t = get_time_ns();
+                bin_heap2_prepare(bh, width, esv);
+                while (bin_heap2_pop(bh, &item))
+                    ++j;
+                t = get_time_ns() - t;
+
+                bin_heap2_destroy(bh);
+            } else {
+                err = loser_tree_create(width, bench_cmp, m > 1 ? bench_head : NULL, &lt);
+                ASSERT_EQ(0, err);
+
+                t = get_time_ns();
+                loser_tree_prepare(lt, width, esv);
+                while (loser_tree_pop(lt, &item))
+                    ++j;
+                t = get_time_ns() - t;
+
+                loser_tree_destroy(lt);
+            }
+
+            ASSERT_EQ(cnt * width, j);
+
+            ns[m] = t;
+            ncmp[m] = bench_ncmp;
+        }
+
+        hse_log(HSE_NOTICE "%s: width %2u: bin_heap2 %4lu ns %5.2f cmp, "
+                "loser_tree %4lu ns %5.2f cmp, +head %4lu ns %5.2f cmp (per element)",
+                __func__, width,
+                ns[0] / j, (double)ncmp[0] / j,
+                ns[1] / j, (double)ncmp[1] / j,
+                ns[2] / j, (double)ncmp[2] / j);
+
+        ASSERT_LE(ncmp[1], ncmp[0]);
+        ASSERT_LE(ncmp[2], ncmp[1]);
+
+        for (i = 0; i < width; ++i)
+            free(kesv[i].kes_keys);
+    }
+}
+
+MTF_END_UTEST_COLLECTION(loser_tree_test)
@@ -385,4 +385,50 @@ MTF_DEFINE_UTEST(perfc, perfc_rollup)
     perfc_ctrseti_free(&perfc_rollup_pc);
 }
 
+MTF_DEFINE_UTEST(perfc, perfc_dis_hits_test)
+{
+    enum perfc_dis_sidx {
+        PERFC_DI_DITEST_VAL,
+        PERFC_BA_DITEST_VAL,
+        PERFC_EN_DITEST
+    };
+    struct perfc_name perfc_dis_op[] = {
+        NE(PERFC_DI_DITEST_VAL, 1, "ditest_val", "ditest_val"),
+        NE(PERFC_BA_DITEST_VAL, 1, "ditest_ba", "ditest_ba"),
+    };
+
+    struct perfc_set perfc_dis_pc;
+    u64              hitv[PERFC_IVL_MAX + 1];
+    u64              boundv[PERFC_IVL_MAX];
+    u64              sum;
+    merr_t           err;
+    u32              bktc, i;
+
+    err = perfc_ctrseti_alloc(
+        COMPNAME, "dishits", perfc_dis_op, PERFC_EN_DITEST, "set", &perfc_dis_pc);
+    ASSERT_EQ(err, 0);
+
+    bktc = perfc_dis_hits(&perfc_dis_pc, PERFC_BA_DITEST_VAL, hitv, boundv);
+    ASSERT_EQ(0, bktc);
+
+    for (i = 0; i < 1000; ++i)
+        perfc_dis_record(&perfc_dis_pc, PERFC_DI_DITEST_VAL, i);
+
+    bktc = perfc_dis_hits(&perfc_dis_pc, PERFC_DI_DITEST_VAL, hitv, boundv);
+    ASSERT_GT(bktc, 1);
+    ASSERT_LE(bktc, PERFC_IVL_MAX + 1);
+
+    for (i = sum = 0; i < bktc; ++i) {
+        sum += hitv[i];
+        if (i > 0 && i < bktc - 1)
+            ASSERT_GT(boundv[i], boundv[i - 1]);
+    }
+    ASSERT_EQ(1000, sum);
+
+    perfc_ctrseti_free(&perfc_dis_pc);
+
+    bktc = perfc_dis_hits(NULL, PERFC_DI_DITEST_VAL, hitv, boundv);
+    ASSERT_EQ(0, bktc);
+}
+
 MTF_END_UTEST_COLLECTION(perfc)
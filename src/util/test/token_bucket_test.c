@@ -125,4 +125,30 @@ MTF_DEFINE_UTEST(test, t_token_bucket)
     }
 }
 
+MTF_DEFINE_UTEST(test, t_token_bucket_debt)
+{
+    struct tbkt tb;
+    u64         debt;
+
+    /* Unlimited buckets never accrue debt */
+    tbkt_init(&tb, 0, 0);
+    ASSERT_EQ(0, tbkt_request(&tb, 1 * G));
+    ASSERT_EQ(0, tbkt_debt_get(&tb));
+
+    tbkt_init(&tb, 1 * M, 1 * M);
+    ASSERT_EQ(0, tbkt_request(&tb, 1 * M));
+    ASSERT_EQ(0, tbkt_debt_get(&tb));
+
+    /* A second burst puts the bucket in debt, which the refill
+     * (at most a few ticks worth here) only slightly reduces.
+     */
+    ASSERT_NE(0, tbkt_request(&tb, 1 * M));
+    debt = tbkt_debt_get(&tb);
+    ASSERT_LE(debt, 1 * M);
+    ASSERT_GT(debt, 1 * M / 2);
+
+    tbkt_adjust(&tb, 1 * M, 0);
+    ASSERT_EQ(0, tbkt_request(&tb, 1 * M));
+}
+
 MTF_END_UTEST_COLLECTION(test);
@@ -915,4 +915,304 @@ MTF_DEFINE_UTEST(workqueue_test, requeue)
     free(workv);
 }
 
+/* Run the chained work, flush, and requeue scenarios on a sharded
+ * workqueue.
+ */
+MTF_DEFINE_UTEST(workqueue_test, sharded_run)
+{
+    struct workqueue_struct *wq;
+    struct work_struct *     workv;
+    struct wait_work *       waitv;
+    struct mywork *          w;
+    const int                workmax = 64;
+    int                      i, j, expected;
+    bool                     b;
+
+    wq = alloc_workqueue("test", WQ_SHARDED, 7);
+    ASSERT_TRUE(wq);
+
+    /* Chained work requeues itself from its own callback.
+     */
+    atomic_set(&counter, 0);
+    expected = 0;
+
+    for (i = 0; i < workmax; i++) {
+        w = calloc(1, sizeof(*w));
+        ASSERT_TRUE(w != NULL);
+
+        w->wqueue = wq;
+        w->id = i;
+        w->chain = i;
+        expected += w->chain + 1;
+
+        INIT_WORK(&w->wstruct, myworker);
+        b = queue_work(wq, &w->wstruct);
+        ASSERT_TRUE(b);
+    }
+
+    for (i = 0; i < 10000 && atomic_read(&counter) < expected; ++i)
+        usleep(1000);
+    ASSERT_EQ(expected, atomic_read(&counter));
+
+    /* All work queued before the flush must complete before it returns.
+     */
+    workv = calloc(workmax, sizeof(*workv));
+    ASSERT_TRUE(workv != NULL);
+
+    atomic_set(&counter, 0);
+
+    for (i = 0; i < workmax; i++) {
+        INIT_WORK(&workv[i], sleep_and_count);
+        b = queue_work(wq, &workv[i]);
+        ASSERT_TRUE(b);
+    }
+
+    flush_workqueue(wq);
+    ASSERT_EQ(workmax, atomic_read(&counter));
+
+    /* Work cannot be requeued while it is pending.
+     */
+    waitv = calloc(workmax, sizeof(*waitv));
+    ASSERT_TRUE(waitv != NULL);
+
+    atomic_set(&counter, 0);
+
+    for (i = 0; i < workmax; i++) {
+        waitv[i].wait_counter = 1;
+        INIT_WORK(&waitv[i].work, wait_worker);
+
+        b = queue_work(wq, &waitv[i].work);
+        ASSERT_TRUE(b);
+    }
+
+    /* At most 7 items can be running, the rest must be pending.
+     */
+    for (i = 0, j = 0; i < workmax; i++)
+        j += !queue_work(wq, &waitv[i].work);
+    ASSERT_GE(j, workmax - 7);
+
+    atomic_set(&counter, 1);
+    flush_workqueue(wq);
+
+    destroy_workqueue(wq);
+    free(waitv);
+    free(workv);
+}
+
+/* Concurrent flushes of a sharded workqueue with delayed work trickling
+ * in (see flush_party).
+ */
+MTF_DEFINE_UTEST(workqueue_test, sharded_flush_party)
+{
+    struct mywork *workv;
+    const int      workmax = 1000;
+    const int      itermax = 8;
+    const int      tdmax = 13;
+    pthread_t      tdv[tdmax];
+    int            i, j;
+    int            rc;
+
+    workv = calloc(workmax, sizeof(*workv));
+    ASSERT_TRUE(workv != NULL);
+
+    for (i = 0; i < itermax; ++i) {
+        struct workqueue_struct *wq;
+
+        atomic_set(&counter, workmax);
+
+        wq = alloc_workqueue(__func__, WQ_SHARDED, 4 * i + 1);
+        ASSERT_TRUE(wq);
+
+        for (j = 0; j < tdmax; ++j) {
+            rc = pthread_create(tdv + j, NULL, flush_party_main, wq);
+            ASSERT_EQ(0, rc);
+        }
+
+        for (j = 0; j < workmax; ++j) {
+            struct mywork *w = workv + j;
+
+            INIT_DELAYED_WORK(&w->dwstruct, flush_party_cb);
+            queue_delayed_work(wq, &w->dwstruct, usecs_to_jiffies(j * 133));
+        }
+
+        for (j = 0; j < tdmax; ++j)
+            (void)pthread_join(tdv[j], NULL);
+
+        destroy_workqueue(wq);
+    }
+
+    free(workv);
+}
+
+struct race_arg {
+    struct workqueue_struct *ra_wq;
+    struct delayed_work *    ra_dwork;
+    atomic_t *               ra_queued;
+    bool                     ra_delayed;
+};
+
+static void
+race_cb(struct work_struct *work)
+{
+    atomic_inc(&counter);
+}
+
+static void *
+race_main(void *arg)
+{
+    struct race_arg *ra = arg;
+    bool             b;
+    int              i;
+
+    for (i = 0; i < 20000; i++) {
+        if (ra->ra_delayed)
+            b = queue_delayed_work(ra->ra_wq, ra->ra_dwork, 0);
+        else
+            b = queue_work(ra->ra_wq, &ra->ra_dwork->work);
+
+        if (b)
+            atomic_inc(ra->ra_queued);
+    }
+
+    return NULL;
+}
+
+/* Queue the same work item on a sharded workqueue both directly and as
+ * delayed work from several threads.  Each successful enqueue must run
+ * exactly once.
+ */
+MTF_DEFINE_UTEST(workqueue_test, sharded_delayed_race)
+{
+    struct workqueue_struct *wq;
+    struct delayed_work      dwork;
+    struct race_arg          argv[4];
+    pthread_t                tdv[4];
+    atomic_t                 queued;
+    int                      i, rc;
+
+    wq = alloc_workqueue(__func__, WQ_SHARDED, 3);
+    ASSERT_TRUE(wq);
+
+    atomic_set(&counter, 0);
+    atomic_set(&queued, 0);
+    INIT_DELAYED_WORK(&dwork, race_cb);
+
+    for (i = 0; i < 4; i++) {
+        argv[i].ra_wq = wq;
+        argv[i].ra_dwork = &dwork;
+        argv[i].ra_queued = &queued;
+        argv[i].ra_delayed = i & 1;
+
+        rc = pthread_create(tdv + i, NULL, race_main, argv + i);
+        ASSERT_EQ(0, rc);
+    }
+
+    for (i = 0; i < 4; i++)
+        (void)pthread_join(tdv[i], NULL);
+
+    /* Wait for the last delayed enqueue's timer to fire.
+     */
+    for (i = 0; i < 1000 && atomic_read(&counter) < atomic_read(&queued); ++i) {
+        flush_workqueue(wq);
+        usleep(1000);
+    }
+
+    ASSERT_EQ(atomic_read(&queued), atomic_read(&counter));
+
+    destroy_workqueue(wq);
+}
+
+#define BENCH_PRODUCERS  (8)
+#define BENCH_WORKC      (64)
+#define BENCH_ROUNDS     (2000)
+
+struct bench_producer {
+    struct workqueue_struct *bp_wq;
+    atomic_t *               bp_go;
+    struct work_struct       bp_workv[BENCH_WORKC];
+};
+
+static void
+bench_cb(struct work_struct *work)
+{
+    atomic_inc(&counter);
+}
+
+static void *
+bench_producer_main(void *arg)
+{
+    struct bench_producer *bp = arg;
+    int                    r, i;
+
+    while (!atomic_read(bp->bp_go))
+        cpu_relax();
+
+    /* Requeue each work item as soon as it is no longer pending.
+     */
+    for (r = 0; r < BENCH_ROUNDS; r++) {
+        for (i = 0; i < BENCH_WORKC; i++) {
+            while (!queue_work(bp->bp_wq, &bp->bp_workv[i]))
+                cpu_relax();
+        }
+    }
+
+    return NULL;
+}
+
+/* Measure dispatch throughput of short work items queued by many
+ * producers, with and without WQ_SHARDED.
+ */
+MTF_DEFINE_UTEST(workqueue_test, bench)
+{
+    struct bench_producer *bpv;
+    pthread_t              tdv[BENCH_PRODUCERS];
+    const int              total = BENCH_PRODUCERS * BENCH_WORKC * BENCH_ROUNDS;
+    u64                    ns[2];
+    atomic_t               go;
+    int                    m, i, j, rc;
+
+    bpv = calloc(BENCH_PRODUCERS, sizeof(*bpv));
+    ASSERT_TRUE(bpv != NULL);
+
+    for (m = 0; m < 2; m++) {
+        struct workqueue_struct *wq;
+        u64                      t;
+
+        wq = alloc_workqueue("bench", m ? WQ_SHARDED : 0, 8);
+        ASSERT_TRUE(wq);
+
+        atomic_set(&counter, 0);
+        atomic_set(&go, 0);
+
+        for (i = 0; i < BENCH_PRODUCERS; i++) {
+            bpv[i].bp_wq = wq;
+            bpv[i].bp_go = &go;
+
+            for (j = 0; j < BENCH_WORKC; j++)
+                INIT_WORK(&bpv[i].bp_workv[j], bench_cb);
+
+            rc = pthread_create(tdv + i, NULL, bench_producer_main, bpv + i);
+            ASSERT_EQ(0, rc);
+        }
+
+        t = get_time_ns();
+        atomic_set(&go, 1);
+
+        for (i = 0; i < BENCH_PRODUCERS; i++)
+            (void)pthread_join(tdv[i], NULL);
+
+        flush_workqueue(wq);
+        ns[m] = get_time_ns() - t;
+
+        ASSERT_EQ(total, atomic_read(&counter));
+
+        destroy_workqueue(wq);
+    }
+
+    hse_log(HSE_NOTICE "%s: %d producers, %d items: default %lu ns/item, sharded %lu ns/item",
+            __func__, BENCH_PRODUCERS, total, ns[0] / total, ns[1] / total);
+
+    free(bpv);
+}
+
 MTF_END_UTEST_COLLECTION(workqueue_test)